@@ -0,0 +1,48 @@
+namespace Screener.Abstractions.Capture;
+
+/// <summary>
+/// Per-input capture statistics: where time goes between the driver callback and the
+/// downstream consumers, and how many frames were lost along the way.
+/// </summary>
+public record CaptureStatistics
+{
+    public long FramesCaptured { get; init; }
+    public long FramesFailed { get; init; }
+    public long FramesCorrupt { get; init; }
+    public long FramesPartial { get; init; }
+    public long FramesDelivered { get; init; }
+    public long BytesCopied { get; init; }
+    public string AccessPath { get; init; } = "";
+    public long AccessPathChanges { get; init; }
+
+    /// <summary>Driver callback entry to the start of the frame copy.</summary>
+    public LatencyHistogram CallbackToCopy { get; init; } = new();
+
+    /// <summary>Duration of the frame copy out of the driver buffer.</summary>
+    public LatencyHistogram Copy { get; init; } = new();
+
+    /// <summary>Time between consecutive driver callbacks.</summary>
+    public LatencyHistogram FrameInterval { get; init; } = new();
+
+    /// <summary>Time spent acquiring a free capture ring slot.</summary>
+    public LatencyHistogram RingSlotWait { get; init; } = new();
+
+    /// <summary>Frames dropped because every ring slot was leased by a consumer.</summary>
+    public long FramesDroppedRingFull { get; init; }
+
+    /// <summary>Time spent in VideoFrameReceived handlers.</summary>
+    public LatencyHistogram Downstream { get; init; } = new();
+
+    /// <summary>Copy throughput in MB/s (bytes copied over time spent copying).</summary>
+    public double CopyThroughputMBps => Copy.TotalMicroseconds > 0 ? BytesCopied / (double)Copy.TotalMicroseconds : 0;
+
+    /// <summary>Fraction of copies that produced a corrupt or partial frame.</summary>
+    public double CorruptFrameRate
+    {
+        get
+        {
+            var total = FramesCaptured + FramesFailed + FramesCorrupt + FramesPartial;
+            return total > 0 ? (double)(FramesCorrupt + FramesPartial) / total : 0;
+        }
+    }
+}
@@ -1,3 +1,5 @@
+using System.Buffers;
+
 namespace Screener.Abstractions.Capture;
 
 /// <summary>
@@ -57,6 +59,26 @@ public interface ICaptureDevice : IDisposable
     /// </summary>
     VideoConnector SelectedConnector { get; set; }
 
+    /// <summary>
+    /// Capture-path counters and latency histograms, or null if the device does not collect them.
+    /// </summary>
+    CaptureStatistics? Statistics => null;
+
+    /// <summary>
+    /// Ask the device to produce a downsampled luma plane of this size with each frame
+    /// (<see cref="VideoFrameEventArgs.AnalysisLuma"/>), ideally during the frame copy.
+    /// Zero disables it. Devices that cannot do so ignore the request.
+    /// </summary>
+    void SetAnalysisLumaSize(int width, int height) { }
+
+    /// <summary>
+    /// Ask the device to build the 1/divisor level (2, 4 or 8) of a box-filtered preview
+    /// pyramid with each frame (<see cref="VideoFrameEventArgs.Pyramid"/>), once for all
+    /// consumers. Dispose the result to unsubscribe. Devices that cannot build one return a
+    /// subscription that does nothing.
+    /// </summary>
+    IDisposable SubscribePreviewLevel(int divisor) => NoSubscription.Instance;
+
     /// <summary>
     /// Fired when a video frame is received.
     /// </summary>
@@ -84,6 +106,13 @@ public interface ICaptureDevice : IDisposable
     /// Stop capturing.
     /// </summary>
     Task StopCaptureAsync();
+
+    private sealed class NoSubscription : IDisposable
+    {
+        public static readonly NoSubscription Instance = new();
+
+        public void Dispose() { }
+    }
 }
 
 /// <summary>
@@ -163,18 +192,90 @@ public enum PixelFormat
 
 public class VideoFrameEventArgs : EventArgs
 {
+    /// <summary>
+    /// Frame bytes. May be a capture ring slot that the device reuses a few frames after the
+    /// handler returns: handlers that read it later (after an await or on another thread)
+    /// should hold a <see cref="TryLease"/> until they are done, or use <see cref="Retain"/>.
+    /// </summary>
     public required ReadOnlyMemory<byte> FrameData { get; init; }
     public required VideoMode Mode { get; init; }
     public required TimeSpan Timestamp { get; init; }
     public required long FrameNumber { get; init; }
+
+    /// <summary>Ring sequence number of the slot holding FrameData (0 if not ring-backed).</summary>
+    public long Sequence { get; init; }
+
+    /// <summary>Ring that owns FrameData, or null if the data is not reused.</summary>
+    public IFrameLeaseSource? LeaseSource { get; init; }
+
+    /// <summary>
+    /// Keep FrameData from being overwritten until the returned lease is disposed.
+    /// Returns null if the frame is not ring-backed or its slot has already been reused.
+    /// </summary>
+    public IDisposable? TryLease() => LeaseSource?.TryLease(Sequence);
+
+    /// <summary>
+    /// Keep the frame readable after an await: a lease on its slot when one is free, otherwise
+    /// a pooled copy taken now, while the handler still owns the buffer. Ring slots can be
+    /// native memory that is freed (NDI) rather than reused once the last lease ends, so a
+    /// handler that fails to lease must never read FrameData later. Read data until the
+    /// returned handle is disposed.
+    /// </summary>
+    public IDisposable? Retain(out ReadOnlyMemory<byte> data)
+    {
+        data = FrameData;
+        if (LeaseSource == null)
+            return null;
+
+        var lease = LeaseSource.TryLease(Sequence);
+        if (lease != null)
+            return lease;
+
+        var copy = ArrayPool<byte>.Shared.Rent(FrameData.Length);
+        FrameData.Span.CopyTo(copy);
+        data = copy.AsMemory(0, FrameData.Length);
+        return new PooledFrameCopy(copy);
+    }
+
+    private sealed class PooledFrameCopy(byte[] buffer) : IDisposable
+    {
+        private byte[]? _buffer = buffer;
+
+        public void Dispose()
+        {
+            var buffer = Interlocked.Exchange(ref _buffer, null);
+            if (buffer != null)
+                ArrayPool<byte>.Shared.Return(buffer);
+        }
+    }
+
+    /// <summary>
+    /// Nearest-neighbour luma plane of this frame at the size requested with
+    /// <see cref="ICaptureDevice.SetAnalysisLumaSize"/>, or null if the device has none.
+    /// Lives in the same ring slot as FrameData and is covered by the same lease.
+    /// </summary>
+    public LumaPlane? AnalysisLuma { get; init; }
+
+    /// <summary>
+    /// Downscaled copies of this frame for the levels subscribed with
+    /// <see cref="ICaptureDevice.SubscribePreviewLevel"/>, or null if there are none.
+    /// Lives in the same ring slot as FrameData and is covered by the same lease.
+    /// </summary>
+    public IPreviewPyramid? Pyramid { get; init; }
 }
 
 public class AudioSamplesEventArgs : EventArgs
 {
+    /// <summary>
+    /// Interleaved samples. Devices may reuse the buffer once the handler returns, so copy
+    /// the samples to keep them.
+    /// </summary>
     public required ReadOnlyMemory<byte> SampleData { get; init; }
     public required int SampleRate { get; init; }
     public required int Channels { get; init; }
     public required int BitsPerSample { get; init; }
+
+    /// <summary>Stream time of the first sample, on the same clock as the device's video frames.</summary>
     public required TimeSpan Timestamp { get; init; }
 }
 
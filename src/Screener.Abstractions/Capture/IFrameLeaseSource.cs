@@ -0,0 +1,13 @@
+namespace Screener.Abstractions.Capture;
+
+/// <summary>
+/// A buffer ring that lets consumers pin a published frame while they read it.
+/// </summary>
+public interface IFrameLeaseSource
+{
+    /// <summary>
+    /// Lease the slot holding the given sequence number. Returns null if the slot has been
+    /// (or is being) rewritten with a newer frame.
+    /// </summary>
+    IDisposable? TryLease(long sequence);
+}
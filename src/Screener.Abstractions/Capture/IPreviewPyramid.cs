@@ -0,0 +1,19 @@
+namespace Screener.Abstractions.Capture;
+
+/// <summary>
+/// Box-filtered 8-bit UYVY copies of a frame at 1/2, 1/4 and 1/8 size, built by the device
+/// for the levels its consumers subscribed to.
+/// </summary>
+public interface IPreviewPyramid
+{
+    int SourceWidth { get; }
+    int SourceHeight { get; }
+
+    /// <summary>Levels present: 1 = 1/2 only, 3 = down to 1/8.</summary>
+    int Levels { get; }
+
+    /// <summary>
+    /// The 1/divisor level (2, 4 or 8), or null if it was not built for this frame.
+    /// </summary>
+    VideoFrame? GetLevel(int divisor);
+}
@@ -0,0 +1,38 @@
+namespace Screener.Abstractions.Capture;
+
+/// <summary>
+/// Power-of-two latency histogram: bucket 0 counts samples under 16 us, bucket i counts
+/// [16 &lt;&lt; (i-1), 16 &lt;&lt; i) us, and the last bucket everything above.
+/// </summary>
+public record LatencyHistogram
+{
+    public const int BucketCount = 16;
+
+    public IReadOnlyList<long> Buckets { get; init; } = new long[BucketCount];
+    public long Count { get; init; }
+    public long TotalMicroseconds { get; init; }
+    public long MaxMicroseconds { get; init; }
+
+    public double AverageMicroseconds => Count > 0 ? (double)TotalMicroseconds / Count : 0;
+
+    /// <summary>Exclusive upper bound of a bucket in microseconds (the last bucket is unbounded).</summary>
+    public static long BucketUpperBoundMicroseconds(int bucket) => 16L << bucket;
+
+    /// <summary>
+    /// Upper bound of the bucket containing the given quantile (0..1), capped at the maximum sample.
+    /// </summary>
+    public long PercentileMicroseconds(double quantile)
+    {
+        if (Count == 0) return 0;
+
+        var target = (long)Math.Ceiling(Count * Math.Clamp(quantile, 0, 1));
+        long seen = 0;
+        for (int i = 0; i < Buckets.Count; i++)
+        {
+            seen += Buckets[i];
+            if (seen >= target && seen > 0)
+                return Math.Min(BucketUpperBoundMicroseconds(i), MaxMicroseconds);
+        }
+        return MaxMicroseconds;
+    }
+}
@@ -0,0 +1,6 @@
+namespace Screener.Abstractions.Capture;
+
+/// <summary>
+/// Width x height bytes of 8-bit luma, one byte per pixel, no padding.
+/// </summary>
+public record LumaPlane(ReadOnlyMemory<byte> Data, int Width, int Height);
@@ -0,0 +1,58 @@
+namespace Screener.Abstractions.Clipping;
+
+/// <summary>
+/// Rolling window of a recording's compressed output (MPEG-TS), indexed by keyframe, so clips
+/// can be stream-copied out of memory instead of re-reading the recording file.
+/// </summary>
+public interface IReplayBuffer
+{
+    /// <summary>How far back the buffer aims to keep (memory permitting).</summary>
+    TimeSpan Window { get; }
+
+    /// <summary>Recording position of the oldest buffered keyframe, null while empty.</summary>
+    TimeSpan? OldestPosition { get; }
+
+    /// <summary>Recording position of the newest buffered packet, null while empty.</summary>
+    TimeSpan? NewestPosition { get; }
+
+    /// <summary>
+    /// Append transport stream bytes as the encoder produces them (any chunking).
+    /// </summary>
+    void Append(ReadOnlySpan<byte> transportStream);
+
+    /// <summary>
+    /// Mark out the GOPs covering [inPoint, outPoint], starting at the keyframe at or before
+    /// inPoint; their bytes are read when the snapshot is copied. Null when the range has
+    /// already been evicted or nothing is buffered.
+    /// </summary>
+    ReplaySnapshot? Snapshot(TimeSpan inPoint, TimeSpan outPoint);
+}
+
+/// <summary>
+/// Self-contained MPEG-TS (PAT/PMT first) for a range of a recording, streamed out of the
+/// buffer by <see cref="CopyToAsync"/> instead of being copied into one array up front.
+/// </summary>
+public abstract class ReplaySnapshot
+{
+    protected ReplaySnapshot(TimeSpan start, TimeSpan end, long length)
+    {
+        Start = start;
+        End = end;
+        Length = length;
+    }
+
+    /// <summary>Recording position of the first (key)frame.</summary>
+    public TimeSpan Start { get; }
+
+    /// <summary>Recording position of the last packet.</summary>
+    public TimeSpan End { get; }
+
+    /// <summary>Bytes <see cref="CopyToAsync"/> writes, PAT/PMT included.</summary>
+    public long Length { get; }
+
+    /// <summary>
+    /// Write the range to a stream. Throws <see cref="IOException"/> if the buffer has
+    /// overwritten part of it by the time it is read.
+    /// </summary>
+    public abstract Task CopyToAsync(Stream destination, CancellationToken ct = default);
+}
@@ -1,4 +1,5 @@
 using Screener.Abstractions.Capture;
+using Screener.Abstractions.Clipping;
 
 namespace Screener.Abstractions.Encoding;
 
@@ -32,13 +33,19 @@ public interface IEncodingPipeline : IAsyncDisposable
     /// </summary>
     event EventHandler<EncodingErrorEventArgs>? Error;
 
+    /// <summary>
+    /// Fired when the encoder falls behind and frames are refused because its queue is full.
+    /// </summary>
+    event EventHandler<EncodingBackpressureEventArgs>? Backpressure;
+
     /// <summary>
     /// Initialize the pipeline with the given configuration.
     /// </summary>
     Task InitializeAsync(EncodingConfiguration config, CancellationToken ct = default);
 
     /// <summary>
-    /// Write a video frame to the encoder.
+    /// Write a video frame to the encoder. Returns false if the frame was not accepted, either
+    /// because the encoder is behind (see <see cref="Backpressure"/>) or the write failed.
     /// </summary>
     Task<bool> WriteVideoFrameAsync(ReadOnlyMemory<byte> frame, TimeSpan pts, CancellationToken ct = default);
 
@@ -69,7 +76,55 @@ public record EncodingConfiguration(
     AudioFormat AudioFormat,
     EncodingPreset Preset,
     HardwareAcceleration HwAccel = HardwareAcceleration.Auto,
-    bool UseFragmentedMp4 = true);
+    bool UseFragmentedMp4 = true,
+    IVideoOverlay? Overlay = null,
+    VideoTransport Transport = VideoTransport.NamedPipe,
+    EncoderEngine Engine = EncoderEngine.Auto,
+    IReplayBuffer? Replay = null);
+
+/// <summary>
+/// Which encoder implementation runs the session.
+/// </summary>
+public enum EncoderEngine
+{
+    /// <summary>In-process when the codec and pixel format allow it, FFmpeg otherwise.</summary>
+    Auto,
+
+    /// <summary>External FFmpeg process.</summary>
+    Ffmpeg,
+
+    /// <summary>In-process hardware encoder in the native DLL (H.264/HEVC only).</summary>
+    Native
+}
+
+/// <summary>
+/// How raw frames reach the FFmpeg process.
+/// </summary>
+public enum VideoTransport
+{
+    /// <summary>FFmpeg's stdin (anonymous pipe with small kernel buffers).</summary>
+    StandardInput,
+
+    /// <summary>Overlapped named pipe sized for several frames.</summary>
+    NamedPipe
+}
+
+/// <summary>
+/// Burns graphics (logo bug, lower third) into frames on their way to the encoder.
+/// </summary>
+public interface IVideoOverlay
+{
+    /// <summary>
+    /// Whether the overlay can be composited onto frames of this mode; the pipeline encodes
+    /// clean frames otherwise.
+    /// </summary>
+    bool Supports(VideoMode mode);
+
+    /// <summary>
+    /// Composite the current overlay onto frame in place. Called from the encoding thread.
+    /// </summary>
+    void Apply(Span<byte> frame, int rowBytes, VideoMode mode);
+}
 
 public record AudioFormat(
     int SampleRate,
@@ -125,6 +180,15 @@ public record EncodingStatistics
     public double AverageFrameRate { get; init; }
     public double AverageBitrateMbps { get; init; }
     public int DroppedFrames { get; init; }
+
+    /// <summary>Frames refused because the encoder queue stayed full (not counted in DroppedFrames).</summary>
+    public int BackpressureDroppedFrames { get; init; }
+
+    /// <summary>Frames that had to wait for queue space but were still encoded.</summary>
+    public int StalledFrames { get; init; }
+
+    public int QueuedFrames { get; init; }
+    public int PeakQueuedFrames { get; init; }
 }
 
 public class EncodingProgressEventArgs : EventArgs
@@ -135,6 +199,13 @@ public class EncodingProgressEventArgs : EventArgs
     public required long FileSizeBytes { get; init; }
 }
 
+public class EncodingBackpressureEventArgs : EventArgs
+{
+    public required int QueuedFrames { get; init; }
+    public required int QueueCapacity { get; init; }
+    public required int DroppedFrames { get; init; }
+}
+
 public class EncodingErrorEventArgs : EventArgs
 {
     public required string Message { get; init; }
@@ -0,0 +1,95 @@
+using System.Text.Json;
+using System.Text.Json.Serialization;
+using Screener.Abstractions.Capture;
+using Screener.Abstractions.Encoding;
+
+namespace Screener.Abstractions.Output;
+
+/// <summary>
+/// One rung of the encode ladder: a resolution and bitrate the program feed is encoded at
+/// once, with the compressed packets shared by every output routed to it.
+/// </summary>
+/// <param name="Name">Key outputs use to route to this rendition (e.g. "program", "stream").</param>
+/// <param name="GopFrames">Keyframe interval; 0 = two seconds.</param>
+/// <param name="Targets">
+/// Extra FFmpeg tee-muxer slaves fed from this rendition whenever it is encoded, e.g.
+/// <c>[f=flv]rtmp://host/app/key</c> or <c>[f=mp4:movflags=+frag_keyframe+empty_moov]D:\program.mp4</c>.
+/// </param>
+public sealed record EncodeRendition(
+    string Name,
+    int Width,
+    int Height,
+    int BitrateKbps,
+    VideoCodec Codec = VideoCodec.H264,
+    int GopFrames = 0,
+    IReadOnlyList<string>? Targets = null)
+{
+    private static readonly JsonSerializerOptions JsonOptions = new()
+    {
+        PropertyNameCaseInsensitive = true,
+        Converters = { new JsonStringEnumConverter() }
+    };
+
+    /// <summary>
+    /// Parse the ladder stored in settings (a JSON array of renditions). Invalid JSON or
+    /// renditions without a name or size are skipped rather than failing output start.
+    /// </summary>
+    public static IReadOnlyList<EncodeRendition> ParseLadder(string? json)
+    {
+        if (string.IsNullOrWhiteSpace(json))
+            return Array.Empty<EncodeRendition>();
+
+        try
+        {
+            var ladder = JsonSerializer.Deserialize<List<EncodeRendition>>(json, JsonOptions);
+            return ladder?
+                .Where(r => !string.IsNullOrWhiteSpace(r.Name) && r.Width > 0 && r.Height > 0 && r.BitrateKbps > 0)
+                .ToArray() ?? Array.Empty<EncodeRendition>();
+        }
+        catch (JsonException)
+        {
+            return Array.Empty<EncodeRendition>();
+        }
+    }
+}
+
+/// <summary>
+/// Where an output wants a rendition's packets muxed: an FFmpeg muxer name and URL.
+/// </summary>
+/// <param name="Options">Extra tee slave options, colon separated (e.g. "mpegts_flags=resend_headers").</param>
+public sealed record TeeTarget(string Rendition, string Format, string Url, string? Options = null);
+
+/// <summary>
+/// An output that can be fed compressed packets from a shared rendition instead of encoding
+/// raw frames itself. While <see cref="TeeTarget"/> is set it gets no raw frames.
+/// </summary>
+public interface ITeeOutput : IOutputService
+{
+    /// <summary>
+    /// Muxer target for the running session, or null when this output encodes its own frames.
+    /// </summary>
+    TeeTarget? TeeTarget { get; }
+}
+
+/// <summary>
+/// Encodes the program feed once per rendition and tees the packets to every target.
+/// </summary>
+public interface IEncodeTee : IAsyncDisposable
+{
+    bool IsRunning { get; }
+    long FramesPushed { get; }
+    long DroppedFrames { get; }
+
+    /// <summary>
+    /// Start (or restart, if already running) encoding the given renditions. Each target names
+    /// one of them; renditions no target refers to and that have no static targets are not encoded.
+    /// </summary>
+    Task StartAsync(VideoMode mode, IReadOnlyList<EncodeRendition> ladder, IReadOnlyList<TeeTarget> targets, CancellationToken ct = default);
+
+    /// <summary>
+    /// Queue one raw program frame. False if it was dropped because the encoder is behind.
+    /// </summary>
+    Task<bool> PushFrameAsync(ReadOnlyMemory<byte> frameData, TimeSpan timestamp, CancellationToken ct = default);
+
+    Task StopAsync(CancellationToken ct = default);
+}
@@ -65,7 +65,9 @@ public record RecordingOptions(
     string? Name = null,
     TimeSpan? MaxDuration = null,
     long? MaxFileSizeMb = null,
-    List<InputConfiguration>? Inputs = null);
+    List<InputConfiguration>? Inputs = null,
+    TimeSpan? ReplayWindow = null,
+    bool RawIsoInputs = false);
 
 /// <summary>
 /// Configuration for a single recording input.
@@ -81,6 +83,11 @@ public record InputConfiguration(
     /// Gets the suffix to append to filenames for this input.
     /// </summary>
     public string FilenameSuffix => $"_input{InputIndex + 1}";
+
+    /// <summary>
+    /// Graphics burned into this input's recording as it is encoded (null for a clean feed).
+    /// </summary>
+    public IVideoOverlay? Overlay { get; init; }
 }
 
 public class RecordingSession
@@ -112,6 +119,11 @@ public class InputRecordingSession
     public long FramesRecorded { get; set; }
     public int DroppedFrames { get; set; }
     public bool HasSignal { get; set; } = true;
+
+    /// <summary>
+    /// True when <see cref="InputConfiguration.Overlay"/> is being burned into the file.
+    /// </summary>
+    public bool HasOverlay { get; init; }
 }
 
 public record ClipMarker(
@@ -0,0 +1,203 @@
+#include "BenchFrames.h"
+
+#include <malloc.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <new>
+
+BenchBuffer::BenchBuffer(size_t size) : size(size)
+{
+    data = (unsigned char*)_aligned_malloc(size, 4096);
+    if (data == nullptr)
+        throw std::bad_alloc();
+}
+
+BenchBuffer::BenchBuffer(BenchBuffer&& other) noexcept : data(other.data), size(other.size)
+{
+    other.data = nullptr;
+    other.size = 0;
+}
+
+BenchBuffer& BenchBuffer::operator=(BenchBuffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        _aligned_free(data);
+        data = other.data;
+        size = other.size;
+        other.data = nullptr;
+        other.size = 0;
+    }
+    return *this;
+}
+
+BenchBuffer::~BenchBuffer()
+{
+    _aligned_free(data);
+}
+
+int BenchRowBytes(BenchFormat format, int width)
+{
+    return format == BenchFormatV210 ? (width + 47) / 48 * 128 : width * 2;
+}
+
+const char* BenchFormatName(BenchFormat format)
+{
+    return format == BenchFormatV210 ? "v210" : "uyvy";
+}
+
+// ----------------------------------------------------------------------------
+// Synthetic frames
+// ----------------------------------------------------------------------------
+
+struct Yuv
+{
+    int y, u, v;    // 10-bit studio range
+};
+
+// 75% colour bars, BT.709
+static const Yuv Bars[8] =
+{
+    { 721, 512, 512 }, { 674, 176, 543 }, { 581, 589, 176 }, { 534, 253, 207 },
+    { 251, 771, 817 }, { 204, 435, 848 }, { 111, 848, 481 }, { 64, 512, 512 }
+};
+
+static inline uint32_t NextNoise(uint32_t* state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+// One row of 10-bit samples: the bars, a white block that moves with the frame index, and
+// a little luma noise so consecutive frames never compare equal
+static void SynthesizeRow(Yuv* row, int width, int height, int y, int frame, int count, uint32_t* noise)
+{
+    int block = height / 8;
+    int blockLeft = (int)((long long)(width - block) * frame / (count > 1 ? count - 1 : 1));
+    int blockTop = height / 2 - block / 2;
+    bool blockRow = y >= blockTop && y < blockTop + block;
+
+    for (int x = 0; x < width; x++)
+    {
+        Yuv p = Bars[x * 8 / width];
+        if (blockRow && x >= blockLeft && x < blockLeft + block)
+            p = { 940, 512, 512 };
+
+        int luma = p.y + (int)(NextNoise(noise) & 15) - 8;
+        p.y = luma < 64 ? 64 : luma > 940 ? 940 : luma;
+        row[x] = p;
+    }
+}
+
+static void PackUyvyRow(unsigned char* dst, const Yuv* row, int width)
+{
+    for (int x = 0; x + 1 < width; x += 2)
+    {
+        dst[x * 2 + 0] = (unsigned char)(row[x].u >> 2);
+        dst[x * 2 + 1] = (unsigned char)(row[x].y >> 2);
+        dst[x * 2 + 2] = (unsigned char)(row[x].v >> 2);
+        dst[x * 2 + 3] = (unsigned char)(row[x + 1].y >> 2);
+    }
+}
+
+static inline uint32_t V210Word(int a, int b, int c)
+{
+    return (uint32_t)a | ((uint32_t)b << 10) | ((uint32_t)c << 20);
+}
+
+// Pixels past the width in the last group are padded with black
+static void PackV210Row(unsigned char* dst, const Yuv* row, int width, int rowBytes)
+{
+    const Yuv black = { 64, 512, 512 };
+    uint32_t* out = (uint32_t*)dst;
+
+    for (int x = 0; x < width; x += 6)
+    {
+        Yuv p[6];
+        for (int i = 0; i < 6; i++)
+            p[i] = x + i < width ? row[x + i] : black;
+
+        *out++ = V210Word(p[0].u, p[0].y, p[0].v);
+        *out++ = V210Word(p[1].y, p[2].u, p[2].y);
+        *out++ = V210Word(p[2].v, p[3].y, p[4].u);
+        *out++ = V210Word(p[4].y, p[4].v, p[5].y);
+    }
+
+    unsigned char* end = (unsigned char*)out;
+    memset(end, 0, rowBytes - (end - dst));
+}
+
+void MakeSyntheticFrames(BenchFrameSet* set, BenchFormat format, int width, int height, int count)
+{
+    set->format = format;
+    set->width = width;
+    set->height = height;
+    set->rowBytes = BenchRowBytes(format, width);
+    set->origin = "synthetic";
+    set->frames.clear();
+
+    std::vector<Yuv> row(width);
+    uint32_t noise = 0x9E3779B9u;
+
+    for (int f = 0; f < count; f++)
+    {
+        BenchBuffer frame(set->FrameSize());
+        for (int y = 0; y < height; y++)
+        {
+            SynthesizeRow(row.data(), width, height, y, f, count, &noise);
+            unsigned char* dst = frame.data + (size_t)y * set->rowBytes;
+            if (format == BenchFormatV210)
+                PackV210Row(dst, row.data(), width, set->rowBytes);
+            else
+                PackUyvyRow(dst, row.data(), width);
+        }
+        set->frames.push_back(std::move(frame));
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Replay
+// ----------------------------------------------------------------------------
+
+bool LoadReplayFrames(BenchFrameSet* set, const char* path, BenchFormat format, int width, int height,
+                      int maxFrames, std::string* error)
+{
+    set->format = format;
+    set->width = width;
+    set->height = height;
+    set->rowBytes = BenchRowBytes(format, width);
+    set->origin = path;
+    set->frames.clear();
+
+    FILE* file = nullptr;
+    if (fopen_s(&file, path, "rb") != 0 || file == nullptr)
+    {
+        *error = std::string("cannot open ") + path;
+        return false;
+    }
+
+    const size_t frameSize = set->FrameSize();
+    while ((int)set->frames.size() < maxFrames)
+    {
+        BenchBuffer frame(frameSize);
+        if (fread(frame.data, 1, frameSize, file) != frameSize)
+            break;
+        set->frames.push_back(std::move(frame));
+    }
+    fclose(file);
+
+    if (set->frames.empty())
+    {
+        char message[256];
+        snprintf(message, sizeof(message), "%s holds no whole %dx%d %s frame (%zu bytes)",
+                 path, width, height, BenchFormatName(format), frameSize);
+        *error = message;
+        return false;
+    }
+    return true;
+}
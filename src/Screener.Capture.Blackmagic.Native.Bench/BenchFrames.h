@@ -0,0 +1,54 @@
+#pragma once
+
+// Source frames for the native benchmark: either replayed from a raw capture dump or
+// generated (colour bars with a moving block and noise, so SAD and the corruption check
+// see frames that change like real video).
+
+#include <string>
+#include <vector>
+
+enum BenchFormat
+{
+    BenchFormatUyvy = 0,    // 8-bit 4:2:2, rows of width * 2 bytes
+    BenchFormatV210 = 1     // 10-bit 4:2:2, rows padded to 48-pixel (128-byte) groups
+};
+
+// Page-aligned like a DMA buffer
+struct BenchBuffer
+{
+    unsigned char* data = nullptr;
+    size_t size = 0;
+
+    BenchBuffer() = default;
+    explicit BenchBuffer(size_t size);
+    BenchBuffer(BenchBuffer&& other) noexcept;
+    BenchBuffer& operator=(BenchBuffer&& other) noexcept;
+    BenchBuffer(const BenchBuffer&) = delete;
+    BenchBuffer& operator=(const BenchBuffer&) = delete;
+    ~BenchBuffer();
+};
+
+struct BenchFrameSet
+{
+    BenchFormat format = BenchFormatUyvy;
+    int width = 0;
+    int height = 0;
+    int rowBytes = 0;
+    std::string origin;             // "synthetic" or the dump path
+    std::vector<BenchBuffer> frames;
+
+    size_t FrameSize() const { return (size_t)rowBytes * height; }
+};
+
+int BenchRowBytes(BenchFormat format, int width);
+
+const char* BenchFormatName(BenchFormat format);
+
+// Generate count distinct frames
+void MakeSyntheticFrames(BenchFrameSet* set, BenchFormat format, int width, int height, int count);
+
+// Load up to maxFrames frames from a dump of back-to-back raw frames (rowBytes * height each,
+// no header), e.g. ffmpeg -f rawvideo -pix_fmt uyvy422 or a v210 capture written slot by slot.
+// Returns: false with *error set if the file cannot be read or holds no whole frame
+bool LoadReplayFrames(BenchFrameSet* set, const char* path, BenchFormat format, int width, int height,
+                      int maxFrames, std::string* error);
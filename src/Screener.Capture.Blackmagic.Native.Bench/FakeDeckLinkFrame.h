@@ -0,0 +1,97 @@
+#pragma once
+
+// Stand-in for a captured IDeckLinkVideoInputFrame, laid out like the SDK 15.3 interfaces the
+// native helper calls through: IDeckLinkVideoFrame ([3] GetWidth .. [7] GetFlags) and, through
+// QueryInterface, IDeckLinkVideoBuffer ([3] GetBytes, [4] StartAccess, [5] EndAccess).
+// The replayed frame bytes take the place of the DMA buffer, so the session copies run their
+// real VideoBuffer path. Lifetime is owned by the caller; AddRef/Release do not count.
+
+#include <Windows.h>
+#include <Unknwn.h>
+
+// Same GUIDs as DeckLinkFrameHelper.cpp (from DeckLinkAPI.idl, SDK 15.3)
+static const GUID IID_FakeDeckLinkVideoBuffer =
+{ 0xCCB4B64A, 0x5C86, 0x4E02, { 0xB7, 0x78, 0x88, 0x5D, 0x35, 0x27, 0x09, 0xFE } };
+static const GUID IID_FakeDeckLinkVideoFrame =
+{ 0x6502091C, 0x615F, 0x4F51, { 0xBA, 0xF6, 0x45, 0xC4, 0x25, 0x6D, 0xD5, 0xB0 } };
+static const GUID IID_FakeDeckLinkVideoInputFrame =
+{ 0xC9ADD3D2, 0xBE52, 0x488D, { 0xAB, 0x2D, 0x7F, 0xDE, 0xF7, 0xAF, 0x0C, 0x95 } };
+
+// BMDPixelFormat values
+static const unsigned int FakePixelFormat8BitYUV = 0x32767579;    // '2vuy'
+static const unsigned int FakePixelFormat10BitYUV = 0x76323130;   // 'v210'
+
+struct FakeDeckLinkFrame : IUnknown
+{
+    FakeDeckLinkFrame(void* bytes, long width, long height, long rowBytes, unsigned int pixelFormat)
+        : buffer(this, bytes), width(width), height(height), rowBytes(rowBytes), pixelFormat(pixelFormat)
+    {
+    }
+
+    // The buffer interface points back at its frame
+    FakeDeckLinkFrame(const FakeDeckLinkFrame&) = delete;
+    FakeDeckLinkFrame& operator=(const FakeDeckLinkFrame&) = delete;
+
+    // IUnknown
+    HRESULT STDMETHODCALLTYPE QueryInterface(REFIID iid, void** object) override
+    {
+        if (object == nullptr)
+            return E_POINTER;
+
+        if (IsEqualGUID(iid, IID_IUnknown) || IsEqualGUID(iid, IID_FakeDeckLinkVideoFrame) ||
+            IsEqualGUID(iid, IID_FakeDeckLinkVideoInputFrame))
+            *object = static_cast<IUnknown*>(this);
+        else if (IsEqualGUID(iid, IID_FakeDeckLinkVideoBuffer))
+            *object = static_cast<IUnknown*>(&buffer);
+        else
+        {
+            *object = nullptr;
+            return E_NOINTERFACE;
+        }
+        return S_OK;
+    }
+
+    ULONG STDMETHODCALLTYPE AddRef() override { return 1; }
+    ULONG STDMETHODCALLTYPE Release() override { return 1; }
+
+    // IDeckLinkVideoFrame, in vtable order
+    virtual long STDMETHODCALLTYPE GetWidth() { return width; }
+    virtual long STDMETHODCALLTYPE GetHeight() { return height; }
+    virtual long STDMETHODCALLTYPE GetRowBytes() { return rowBytes; }
+    virtual unsigned int STDMETHODCALLTYPE GetPixelFormat() { return pixelFormat; }
+    virtual unsigned int STDMETHODCALLTYPE GetFlags() { return 0; }
+
+    struct VideoBuffer : IUnknown
+    {
+        VideoBuffer(FakeDeckLinkFrame* frame, void* bytes) : frame(frame), bytes(bytes) {}
+
+        HRESULT STDMETHODCALLTYPE QueryInterface(REFIID iid, void** object) override
+        {
+            return frame->QueryInterface(iid, object);
+        }
+
+        ULONG STDMETHODCALLTYPE AddRef() override { return 1; }
+        ULONG STDMETHODCALLTYPE Release() override { return 1; }
+
+        // IDeckLinkVideoBuffer, in vtable order
+        virtual HRESULT STDMETHODCALLTYPE GetBytes(void** result)
+        {
+            if (result == nullptr)
+                return E_POINTER;
+            *result = bytes;
+            return S_OK;
+        }
+
+        virtual HRESULT STDMETHODCALLTYPE StartAccess(unsigned int) { return S_OK; }
+        virtual HRESULT STDMETHODCALLTYPE EndAccess(unsigned int) { return S_OK; }
+
+        FakeDeckLinkFrame* frame;
+        void* bytes;
+    };
+
+    VideoBuffer buffer;
+    long width;
+    long height;
+    long rowBytes;
+    unsigned int pixelFormat;
+};
@@ -0,0 +1,476 @@
+// Throughput and latency benchmark for the native capture helper and media kernels, to catch
+// regressions from a DeckLink SDK update or a kernel change before they reach a capture rig.
+//
+//   Screener.Capture.Blackmagic.Native.Bench [options]
+//     --replay <file>          replay a raw frame dump (back-to-back frames, no header)
+//     --format uyvy|v210       pixel format (default: both; required with --replay)
+//     --size 1080p|2160p|WxH   frame size (default: 1080p and 2160p; required with --replay)
+//     --frames <n>             frames to rotate through (default 8)
+//     --threads <n>            run on 1, 2, 4 .. n threads (default: logical processors)
+//     --iterations <n>         timed calls per thread (default 100)
+//     --copy-pool <n>          SetDeckLinkCopyThreads before the run (default: left as loaded)
+//     --filter <text>          only kernels whose name contains text
+//     --csv                    comma-separated output for diffing between builds
+//
+// Each thread runs its own instance of the kernel into its own destination, as each input's
+// capture callback does. fps and GB/s are frames and frame bytes handled per second of wall
+// time across all threads (the corruption check and luma extraction sample a frame rather than
+// read all of it); p50/p99 are per-call latencies across all threads. Copies go through a stand-in
+// DeckLink frame (FakeDeckLinkFrame.h), so they time the real session VideoBuffer path.
+
+#include "BenchFrames.h"
+#include "FakeDeckLinkFrame.h"
+#include "DeckLinkFrameHelper.h"
+#include "MediaKernels.h"
+
+#include <Windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Auto-cut analysis plane (AutoCutConfiguration defaults)
+static const int LumaWidth = 120;
+static const int LumaHeight = 68;
+
+// ----------------------------------------------------------------------------
+// Kernels
+// ----------------------------------------------------------------------------
+
+// Read-only inputs shared by every thread
+struct BenchContext
+{
+    const BenchFrameSet* set;
+    std::vector<std::unique_ptr<FakeDeckLinkFrame>> fakes;  // one stand-in per source frame
+    BenchBuffer bgra[2];                    // dissolve/fade sources, converted from frames 0 and 1
+};
+
+// Per-thread destinations, allocated before the timed run
+struct BenchThread
+{
+    BenchBuffer out;        // frame copy, BGRA, NV12/P010 or blend output
+    BenchBuffer luma[2];    // current and previous analysis plane
+    void* session = nullptr;
+
+    explicit BenchThread(const BenchFrameSet& set)
+        : out(std::max(set.FrameSize(), (size_t)set.width * set.height * 4)),
+          luma{ BenchBuffer(LumaWidth * LumaHeight), BenchBuffer(LumaWidth * LumaHeight) }
+    {
+        memset(luma[0].data, 0, luma[0].size);
+        memset(luma[1].data, 0, luma[1].size);
+        session = CreateDeckLinkCaptureSession();
+    }
+
+    ~BenchThread()
+    {
+        if (session != nullptr)
+            DestroyDeckLinkCaptureSession(session);
+    }
+};
+
+// Returns 0 when the call did what it should, non-zero otherwise
+typedef int (*BenchRunFunc)(BenchThread& t, const BenchContext& c, int frame);
+typedef size_t (*BenchBytesFunc)(const BenchFrameSet& set);
+
+struct BenchKernel
+{
+    const char* name;
+    bool uyvy;
+    bool v210;
+    BenchBytesFunc bytes;
+    BenchRunFunc run;
+};
+
+static size_t FrameBytes(const BenchFrameSet& set) { return set.FrameSize(); }
+static size_t BgraBytes(const BenchFrameSet& set) { return (size_t)set.width * set.height * 4; }
+static size_t TwoBgraBytes(const BenchFrameSet& set) { return 2 * BgraBytes(set); }
+
+static int RunCopy(BenchThread& t, const BenchContext& c, int frame)
+{
+    FakeDeckLinkFrame* fake = c.fakes[frame].get();
+    return CopyDeckLinkSessionFrame(t.session, fake, t.out.data, (int)c.set->FrameSize()) == 1 ? 0 : -1;
+}
+
+static int RunCopyWithLuma(BenchThread& t, const BenchContext& c, int frame)
+{
+    FakeDeckLinkFrame* fake = c.fakes[frame].get();
+    int lumaWritten = 0;
+    int result = CopyDeckLinkSessionFrameWithLuma(t.session, fake, nullptr, t.out.data, (int)c.set->FrameSize(),
+                                                  t.luma[0].data, LumaWidth, LumaHeight, &lumaWritten);
+    return result == 1 && lumaWritten == 1 ? 0 : -1;
+}
+
+static int RunDetectCorrupt(BenchThread&, const BenchContext& c, int frame)
+{
+    const BenchFrameSet& s = *c.set;
+    return DetectCorruptBGRA(s.frames[frame].data, (int)s.FrameSize(), s.width, s.height, s.rowBytes) >= 0 ? 0 : -1;
+}
+
+static int RunToBgra(BenchThread& t, const BenchContext& c, int frame)
+{
+    const BenchFrameSet& s = *c.set;
+    if (s.format == BenchFormatV210)
+        return ConvertV210ToBGRA(s.frames[frame].data, s.rowBytes, t.out.data, s.width * 4, s.width, s.height, ColorMatrixBt709);
+    return ConvertUYVYToBGRA(s.frames[frame].data, s.rowBytes, t.out.data, s.width * 4, s.width, s.height, ColorMatrixBt709);
+}
+
+static int RunToNv12(BenchThread& t, const BenchContext& c, int frame)
+{
+    const BenchFrameSet& s = *c.set;
+    unsigned char* uv = t.out.data + (size_t)s.width * s.height;
+    return ConvertUYVYToNV12(s.frames[frame].data, s.rowBytes, t.out.data, s.width, uv, s.width, s.width, s.height);
+}
+
+static int RunToP010(BenchThread& t, const BenchContext& c, int frame)
+{
+    const BenchFrameSet& s = *c.set;
+    unsigned char* uv = t.out.data + (size_t)s.width * 2 * s.height;
+    return ConvertV210ToP010(s.frames[frame].data, s.rowBytes, t.out.data, s.width * 2, uv, s.width * 2, s.width, s.height);
+}
+
+// Extract this frame's plane and compare it with the one before, as the motion detector does
+static int RunLumaSad(BenchThread& t, const BenchContext& c, int frame)
+{
+    const BenchFrameSet& s = *c.set;
+    int format = s.format == BenchFormatV210 ? LumaFormatV210 : LumaFormatUyvy;
+    long long sad = 0;
+    int result = ExtractLumaSad(s.frames[frame].data, (int)s.FrameSize(), s.rowBytes, s.width, s.height, format,
+                                t.luma[frame & 1].data, LumaWidth, LumaHeight, t.luma[(frame & 1) ^ 1].data,
+                                0, 0, LumaWidth, LumaHeight, &sad);
+    return result;
+}
+
+static int RunDissolve(BenchThread& t, const BenchContext& c, int frame)
+{
+    return BlendFrames(c.bgra[0].data, c.bgra[1].data, t.out.data, (int)BgraBytes(*c.set), 64 + (frame & 127));
+}
+
+static int RunFade(BenchThread& t, const BenchContext& c, int frame)
+{
+    return FadeFrame(c.bgra[frame & 1].data, t.out.data, (int)BgraBytes(*c.set), 64 + (frame & 127), 0xFF000000);
+}
+
+static const BenchKernel Kernels[] =
+{
+    { "copy",      true,  true,  FrameBytes,   RunCopy },
+    { "copy+luma", true,  true,  FrameBytes,   RunCopyWithLuma },
+    { "corrupt",   true,  false, FrameBytes,   RunDetectCorrupt },
+    { "to-bgra",   true,  true,  FrameBytes,   RunToBgra },
+    { "to-nv12",   true,  false, FrameBytes,   RunToNv12 },
+    { "to-p010",   false, true,  FrameBytes,   RunToP010 },
+    { "luma-sad",  true,  true,  FrameBytes,   RunLumaSad },
+    { "dissolve",  true,  true,  TwoBgraBytes, RunDissolve },
+    { "fade",      true,  true,  BgraBytes,    RunFade },
+};
+
+// ----------------------------------------------------------------------------
+// Runner
+// ----------------------------------------------------------------------------
+
+struct BenchResult
+{
+    bool ok;
+    double fps;
+    double gbps;
+    double p50Us;
+    double p99Us;
+};
+
+static bool PrepareContext(BenchContext* context, const BenchFrameSet& set)
+{
+    context->set = &set;
+    context->fakes.clear();
+
+    unsigned int pixelFormat = set.format == BenchFormatV210 ? FakePixelFormat10BitYUV : FakePixelFormat8BitYUV;
+    for (const BenchBuffer& frame : set.frames)
+        context->fakes.push_back(std::make_unique<FakeDeckLinkFrame>(frame.data, set.width, set.height, set.rowBytes, pixelFormat));
+
+    for (int i = 0; i < 2; i++)
+    {
+        const BenchBuffer& frame = set.frames[i % set.frames.size()];
+        context->bgra[i] = BenchBuffer(BgraBytes(set));
+        int result = set.format == BenchFormatV210
+            ? ConvertV210ToBGRA(frame.data, set.rowBytes, context->bgra[i].data, set.width * 4, set.width, set.height, ColorMatrixBt709)
+            : ConvertUYVYToBGRA(frame.data, set.rowBytes, context->bgra[i].data, set.width * 4, set.width, set.height, ColorMatrixBt709);
+        if (result != 0)
+            return false;
+    }
+    return true;
+}
+
+static BenchResult RunKernel(const BenchKernel& kernel, const BenchContext& context, int threads, int iterations)
+{
+    const int frames = (int)context.set->frames.size();
+    const int warmup = std::max(frames, 4);
+
+    std::vector<std::unique_ptr<BenchThread>> state;
+    for (int t = 0; t < threads; t++)
+        state.push_back(std::make_unique<BenchThread>(*context.set));
+
+    std::vector<std::vector<long long>> ticks(threads);
+    std::atomic<int> ready(0);
+    std::atomic<bool> go(false);
+    std::atomic<bool> failed(false);
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < threads; t++)
+    {
+        workers.emplace_back([&, t]
+        {
+            BenchThread& thread = *state[t];
+            std::vector<long long>& samples = ticks[t];
+            samples.reserve(iterations);
+
+            // Warm-up pass: faults the destination in and resolves the session's access path
+            for (int i = 0; i < warmup; i++)
+            {
+                if (kernel.run(thread, context, (i + t) % frames) != 0)
+                    failed = true;
+            }
+
+            ready++;
+            while (!go.load(std::memory_order_acquire))
+                std::this_thread::yield();
+
+            // Threads start on different frames, like inputs with their own capture buffers
+            for (int i = 0; i < iterations; i++)
+            {
+                LARGE_INTEGER before, after;
+                QueryPerformanceCounter(&before);
+                int result = kernel.run(thread, context, (i + t) % frames);
+                QueryPerformanceCounter(&after);
+
+                if (result != 0)
+                    failed = true;
+                samples.push_back(after.QuadPart - before.QuadPart);
+            }
+        });
+    }
+
+    while (ready.load() < threads)
+        std::this_thread::yield();
+
+    LARGE_INTEGER frequency, start, end;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&start);
+    go.store(true, std::memory_order_release);
+    for (std::thread& worker : workers)
+        worker.join();
+    QueryPerformanceCounter(&end);
+
+    std::vector<long long> all;
+    for (const std::vector<long long>& samples : ticks)
+        all.insert(all.end(), samples.begin(), samples.end());
+    std::sort(all.begin(), all.end());
+
+    const double usPerTick = 1e6 / (double)frequency.QuadPart;
+    const double seconds = (double)(end.QuadPart - start.QuadPart) / (double)frequency.QuadPart;
+    const double bytes = (double)kernel.bytes(*context.set) * iterations * threads;
+
+    BenchResult result = {};
+    result.ok = !failed;
+    result.fps = seconds > 0 ? (double)iterations * threads / seconds : 0;
+    result.gbps = seconds > 0 ? bytes / seconds / 1e9 : 0;
+    result.p50Us = all[all.size() / 2] * usPerTick;
+    result.p99Us = all[std::min(all.size() - 1, all.size() * 99 / 100)] * usPerTick;
+    return result;
+}
+
+// ----------------------------------------------------------------------------
+// Command line
+// ----------------------------------------------------------------------------
+
+struct BenchSize
+{
+    int width;
+    int height;
+};
+
+struct BenchOptions
+{
+    const char* replay = nullptr;
+    std::vector<BenchFormat> formats;
+    std::vector<BenchSize> sizes;
+    int frames = 8;
+    int threads = 0;
+    int iterations = 100;
+    int copyPool = 0;
+    const char* filter = nullptr;
+    bool csv = false;
+};
+
+static bool ParseSize(const char* text, BenchSize* size)
+{
+    if (strcmp(text, "1080p") == 0)
+        *size = { 1920, 1080 };
+    else if (strcmp(text, "2160p") == 0)
+        *size = { 3840, 2160 };
+    else if (sscanf_s(text, "%dx%d", &size->width, &size->height) != 2)
+        return false;
+    return size->width >= 2 && (size->width & 1) == 0 && size->height > 0;
+}
+
+static void PrintUsage()
+{
+    fprintf(stderr,
+        "usage: Screener.Capture.Blackmagic.Native.Bench [--replay <file> --format uyvy|v210 --size 1080p|2160p|WxH]\n"
+        "       [--frames n] [--threads n] [--iterations n] [--copy-pool n] [--filter text] [--csv]\n");
+}
+
+static bool ParseOptions(int argc, char** argv, BenchOptions* options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if (strcmp(arg, "--csv") == 0)
+        {
+            options->csv = true;
+            continue;
+        }
+        if (value == nullptr)
+            return false;
+        i++;
+
+        if (strcmp(arg, "--replay") == 0)
+            options->replay = value;
+        else if (strcmp(arg, "--format") == 0)
+        {
+            if (strcmp(value, "uyvy") == 0)
+                options->formats.push_back(BenchFormatUyvy);
+            else if (strcmp(value, "v210") == 0)
+                options->formats.push_back(BenchFormatV210);
+            else
+                return false;
+        }
+        else if (strcmp(arg, "--size") == 0)
+        {
+            BenchSize size;
+            if (!ParseSize(value, &size))
+                return false;
+            options->sizes.push_back(size);
+        }
+        else if (strcmp(arg, "--frames") == 0)
+            options->frames = atoi(value);
+        else if (strcmp(arg, "--threads") == 0)
+            options->threads = atoi(value);
+        else if (strcmp(arg, "--iterations") == 0)
+            options->iterations = atoi(value);
+        else if (strcmp(arg, "--copy-pool") == 0)
+            options->copyPool = atoi(value);
+        else if (strcmp(arg, "--filter") == 0)
+            options->filter = value;
+        else
+            return false;
+    }
+
+    if (options->replay != nullptr && (options->formats.size() != 1 || options->sizes.size() != 1))
+        return false;
+    if (options->formats.empty())
+        options->formats = { BenchFormatUyvy, BenchFormatV210 };
+    if (options->sizes.empty())
+        options->sizes = { { 1920, 1080 }, { 3840, 2160 } };
+    if (options->threads <= 0)
+        options->threads = std::max(1, (int)std::thread::hardware_concurrency());
+
+    return options->frames > 0 && options->iterations > 0 && options->copyPool >= 0;
+}
+
+// 1, 2, 4 .. up to and including max
+static std::vector<int> ThreadCounts(int max)
+{
+    std::vector<int> counts;
+    for (int n = 1; n < max; n *= 2)
+        counts.push_back(n);
+    counts.push_back(max);
+    return counts;
+}
+
+int main(int argc, char** argv)
+{
+    BenchOptions options;
+    if (!ParseOptions(argc, argv, &options))
+    {
+        PrintUsage();
+        return 2;
+    }
+
+    if (options.copyPool > 0)
+        SetDeckLinkCopyThreads(options.copyPool, 0);
+
+    std::vector<int> threadCounts = ThreadCounts(options.threads);
+    int failures = 0;
+
+    if (options.csv)
+        printf("kernel,format,width,height,threads,fps,gbps,p50_us,p99_us,status\n");
+    else
+        printf("media kernels: SIMD level %d, copy kernel %d\n\n%-10s %-6s %-10s %7s %9s %8s %9s %9s\n",
+               GetMediaKernelLevel(), GetDeckLinkCopyKernel(), "kernel", "format", "size", "threads", "fps", "GB/s", "p50 us", "p99 us");
+
+    for (BenchFormat format : options.formats)
+    {
+        for (const BenchSize& size : options.sizes)
+        {
+            BenchFrameSet set;
+            if (options.replay != nullptr)
+            {
+                std::string error;
+                if (!LoadReplayFrames(&set, options.replay, format, size.width, size.height, options.frames, &error))
+                {
+                    fprintf(stderr, "%s\n", error.c_str());
+                    return 1;
+                }
+            }
+            else
+            {
+                MakeSyntheticFrames(&set, format, size.width, size.height, options.frames);
+            }
+
+            BenchContext context;
+            if (!PrepareContext(&context, set))
+            {
+                fprintf(stderr, "%dx%d %s: frames could not be converted to BGRA\n", size.width, size.height, BenchFormatName(format));
+                return 1;
+            }
+
+            if (!options.csv)
+                printf("-- %s, %zu frame(s)\n", set.origin.c_str(), set.frames.size());
+
+            for (const BenchKernel& kernel : Kernels)
+            {
+                if (!(format == BenchFormatV210 ? kernel.v210 : kernel.uyvy))
+                    continue;
+                if (options.filter != nullptr && strstr(kernel.name, options.filter) == nullptr)
+                    continue;
+
+                for (int threads : threadCounts)
+                {
+                    BenchResult result = RunKernel(kernel, context, threads, options.iterations);
+                    if (!result.ok)
+                        failures++;
+
+                    char sizeText[32];
+                    snprintf(sizeText, sizeof(sizeText), "%dx%d", set.width, set.height);
+
+                    if (options.csv)
+                        printf("%s,%s,%d,%d,%d,%.1f,%.3f,%.1f,%.1f,%s\n", kernel.name, BenchFormatName(format),
+                               set.width, set.height, threads, result.fps, result.gbps, result.p50Us, result.p99Us,
+                               result.ok ? "ok" : "failed");
+                    else
+                        printf("%-10s %-6s %-10s %7d %9.0f %8.2f %9.1f %9.1f%s\n", kernel.name, BenchFormatName(format),
+                               sizeText, threads, result.fps, result.gbps, result.p50Us, result.p99Us,
+                               result.ok ? "" : "  FAILED");
+                    fflush(stdout);
+                }
+            }
+        }
+    }
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,177 @@
+#define DECKLINK_NATIVE_EXPORTS
+#include "MediaKernels.h"
+#include "CpuFeatures.h"
+
+#include <immintrin.h>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+// Sample s of an interleaved stream belongs to channel s % channels, so in a run of
+// lcm(channels, 8) samples every eight-sample vector lane always holds the same channel.
+// The AVX2 path keeps one accumulator per vector of the run (in registers, one vector at a
+// time across the window) and folds lanes into channels once per window.
+
+static const int MaxAudioChannels = 64;
+static const int MaxRunSamples = MaxAudioChannels * 8;     // lcm(channels, 8) <= channels * 8
+
+static int Gcd(int a, int b)
+{
+    while (b != 0)
+    {
+        int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+template <int Bits>
+static inline float LoadSample(const unsigned char* src, size_t index)
+{
+    if (Bits == 16)
+        return (float)((const int16_t*)src)[index];
+    return (float)((const int32_t*)src)[index];
+}
+
+template <int Bits>
+static inline __m256 LoadSamples(const unsigned char* src, size_t index)
+{
+    if (Bits == 16)
+        return _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(src + index * 2))));
+    return _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(src + index * 4)));
+}
+
+// Sum of squares and |peak| per channel over frames starting at a frame boundary
+template <int Bits>
+static void WindowScalar(const unsigned char* src, size_t first, int frames, int channels,
+                         float* windowSum, float* peak)
+{
+    for (int f = 0; f < frames; f++)
+    {
+        size_t base = first + (size_t)f * channels;
+        for (int c = 0; c < channels; c++)
+        {
+            float v = LoadSample<Bits>(src, base + c);
+            windowSum[c] += v * v;
+            float a = fabsf(v);
+            if (a > peak[c])
+                peak[c] = a;
+        }
+    }
+}
+
+// Same over runs whole runs of vectorsPerRun vectors, into per-lane sums and peaks
+template <int Bits>
+static void WindowAvx2(const unsigned char* src, size_t first, int runs, int vectorsPerRun,
+                       float* laneSum, float* lanePeak)
+{
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    const size_t stride = (size_t)vectorsPerRun * 8;
+
+    for (int k = 0; k < vectorsPerRun; k++)
+    {
+        __m256 sum = _mm256_setzero_ps();
+        __m256 peak = _mm256_loadu_ps(lanePeak + k * 8);
+        size_t index = first + (size_t)k * 8;
+
+        for (int r = 0; r < runs; r++, index += stride)
+        {
+            __m256 v = LoadSamples<Bits>(src, index);
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(v, v));
+            peak = _mm256_max_ps(peak, _mm256_andnot_ps(signMask, v));
+        }
+
+        _mm256_storeu_ps(laneSum + k * 8, sum);
+        _mm256_storeu_ps(lanePeak + k * 8, peak);
+    }
+}
+
+template <int Bits>
+static void MeasureLevels(const unsigned char* src, int frames, int channels, int windowFrames,
+                          double* total, double* windowMax, float* peak)
+{
+    const int runSamples = channels / Gcd(channels, 8) * 8;
+    const int runFrames = runSamples / channels;
+    const int vectorsPerRun = runSamples / 8;
+    const int window = (windowFrames + runFrames - 1) / runFrames * runFrames;
+    const bool avx2 = GetSimdLevel() >= SimdLevelAvx2;
+
+    alignas(32) float laneSum[MaxRunSamples];
+    alignas(32) float lanePeak[MaxRunSamples];
+    float windowSum[MaxAudioChannels];
+    memset(lanePeak, 0, sizeof(float) * runSamples);
+
+    for (int start = 0; start < frames; start += window)
+    {
+        int count = frames - start < window ? frames - start : window;
+        size_t first = (size_t)start * channels;
+        memset(windowSum, 0, sizeof(float) * channels);
+
+        if (avx2 && count == window)
+        {
+            WindowAvx2<Bits>(src, first, count / runFrames, vectorsPerRun, laneSum, lanePeak);
+            for (int j = 0; j < runSamples; j++)
+                windowSum[j % channels] += laneSum[j];
+        }
+        else
+        {
+            WindowScalar<Bits>(src, first, count, channels, windowSum, peak);
+        }
+
+        for (int c = 0; c < channels; c++)
+        {
+            total[c] += windowSum[c];
+            double mean = (double)windowSum[c] / count;
+            if (mean > windowMax[c])
+                windowMax[c] = mean;
+        }
+    }
+
+    if (avx2)
+        _mm256_zeroupper();
+
+    for (int j = 0; j < runSamples; j++)
+    {
+        if (lanePeak[j] > peak[j % channels])
+            peak[j % channels] = lanePeak[j];
+    }
+}
+
+extern "C" {
+
+MEDIA_KERNELS_API int MeasureAudioLevels(const void* samples, int length, int channels, int bitsPerSample,
+                                         int windowFrames, float* rms, float* peak, float* onset)
+{
+    if ((samples == nullptr && length != 0) || length < 0 || channels <= 0 || channels > MaxAudioChannels ||
+        (bitsPerSample != 16 && bitsPerSample != 32) || windowFrames <= 0)
+        return -1;
+
+    int frames = length / (channels * (bitsPerSample / 8));
+    double total[MaxAudioChannels] = {};
+    double windowMax[MaxAudioChannels] = {};
+    float rawPeak[MaxAudioChannels] = {};
+
+    if (frames > 0)
+    {
+        if (bitsPerSample == 16)
+            MeasureLevels<16>((const unsigned char*)samples, frames, channels, windowFrames, total, windowMax, rawPeak);
+        else
+            MeasureLevels<32>((const unsigned char*)samples, frames, channels, windowFrames, total, windowMax, rawPeak);
+    }
+
+    const double fullScale = bitsPerSample == 16 ? 32768.0 : 2147483648.0;
+    for (int c = 0; c < channels; c++)
+    {
+        double mean = frames > 0 ? total[c] / frames : 0.0;
+        if (rms != nullptr)
+            rms[c] = (float)(sqrt(mean) / fullScale);
+        if (peak != nullptr)
+            peak[c] = (float)(rawPeak[c] / fullScale);
+        if (onset != nullptr)
+            onset[c] = mean > 0.0 ? (float)(windowMax[c] / mean) : 0.0f;
+    }
+    return 0;
+}
+
+}
@@ -0,0 +1,1027 @@
+#define DECKLINK_NATIVE_EXPORTS
+#include "MediaKernels.h"
+#include "CpuFeatures.h"
+
+#include <immintrin.h>
+#include <stdint.h>
+#include <string.h>
+
+// ---------------------------------------------------------------------------
+// Coefficients (8-bit fixed point, studio range)
+// ---------------------------------------------------------------------------
+
+template <int Matrix> struct YuvCoefficients;
+
+// BT.601: same integer coefficients as the UI's YuvConversion lookup tables
+template <> struct YuvCoefficients<ColorMatrixBt601>
+{
+    // YUV -> RGB
+    static const int Y = 298, Rv = 409, Gu = -100, Gv = -208, Bu = 516;
+    // RGB -> YUV
+    static const int Yr = 66, Yg = 129, Yb = 25;
+    static const int Ur = -38, Ug = -74, Ub = 112;
+    static const int Vr = 112, Vg = -94, Vb = -18;
+};
+
+template <> struct YuvCoefficients<ColorMatrixBt709>
+{
+    static const int Y = 298, Rv = 459, Gu = -55, Gv = -136, Bu = 541;
+    static const int Yr = 47, Yg = 157, Yb = 16;
+    static const int Ur = -26, Ug = -87, Ub = 112;
+    static const int Vr = 112, Vg = -102, Vb = -10;
+};
+
+// Pack two 16-bit coefficients into each dword for _mm256_madd_epi16
+static inline __m256i PairCoefficients(int lo, int hi)
+{
+    return _mm256_set1_epi32((int)(((unsigned)hi << 16) | ((unsigned)lo & 0xFFFF)));
+}
+
+static inline unsigned char ClampByte(int v)
+{
+    return (unsigned char)(v < 0 ? 0 : v > 255 ? 255 : v);
+}
+
+// Rows are converted in chunks through small stack buffers (multiple of 48 pixels
+// so a chunk always covers whole v210 blocks)
+static const int ChunkPixels = 1536;
+
+// ---------------------------------------------------------------------------
+// UYVY -> BGRA
+// ---------------------------------------------------------------------------
+
+template <int Matrix>
+static void UyvyToBgraRowScalar(const unsigned char* src, unsigned char* dst, int width)
+{
+    typedef YuvCoefficients<Matrix> C;
+
+    for (int x = 0; x + 1 < width; x += 2)
+    {
+        int u = src[0] - 128;
+        int y0 = src[1] - 16;
+        int v = src[2] - 128;
+        int y1 = src[3] - 16;
+
+        int c0 = y0 < 0 ? 0 : C::Y * y0;
+        int c1 = y1 < 0 ? 0 : C::Y * y1;
+        int r = C::Rv * v + 128;
+        int g = C::Gu * u + C::Gv * v + 128;
+        int b = C::Bu * u + 128;
+
+        dst[0] = ClampByte((c0 + b) >> 8);
+        dst[1] = ClampByte((c0 + g) >> 8);
+        dst[2] = ClampByte((c0 + r) >> 8);
+        dst[3] = 255;
+        dst[4] = ClampByte((c1 + b) >> 8);
+        dst[5] = ClampByte((c1 + g) >> 8);
+        dst[6] = ClampByte((c1 + r) >> 8);
+        dst[7] = 255;
+
+        src += 4;
+        dst += 8;
+    }
+}
+
+// 16 pixels (32 bytes UYVY -> 64 bytes BGRA) per iteration. All arithmetic is
+// in-lane, so each 128-bit lane carries 8 pixels through unchanged and the two
+// halves are only recombined on the final store.
+template <int Matrix>
+static void UyvyToBgraRowAvx2(const unsigned char* src, unsigned char* dst, int width)
+{
+    typedef YuvCoefficients<Matrix> C;
+
+    const __m256i shufY = _mm256_setr_epi8(
+        1, -1, 3, -1, 5, -1, 7, -1, 9, -1, 11, -1, 13, -1, 15, -1,
+        1, -1, 3, -1, 5, -1, 7, -1, 9, -1, 11, -1, 13, -1, 15, -1);
+    const __m256i shufU = _mm256_setr_epi8(
+        0, -1, 0, -1, 4, -1, 4, -1, 8, -1, 8, -1, 12, -1, 12, -1,
+        0, -1, 0, -1, 4, -1, 4, -1, 8, -1, 8, -1, 12, -1, 12, -1);
+    const __m256i shufV = _mm256_setr_epi8(
+        2, -1, 2, -1, 6, -1, 6, -1, 10, -1, 10, -1, 14, -1, 14, -1,
+        2, -1, 2, -1, 6, -1, 6, -1, 10, -1, 10, -1, 14, -1, 14, -1);
+
+    const __m256i lumaOffset = _mm256_set1_epi16(16);
+    const __m256i chromaOffset = _mm256_set1_epi16(128);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi16(1);
+    const __m256i round = _mm256_set1_epi32(128);
+    const __m256i alpha = _mm256_set1_epi8(-1);
+
+    // (y, v) . (Y, Rv), (y, u) . (Y, Bu), (y, u) . (Y, Gu) + (v, 1) . (Gv, 128)
+    const __m256i coefR = PairCoefficients(C::Y, C::Rv);
+    const __m256i coefB = PairCoefficients(C::Y, C::Bu);
+    const __m256i coefGyu = PairCoefficients(C::Y, C::Gu);
+    const __m256i coefGv = PairCoefficients(C::Gv, 128);
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        __m256i in = _mm256_loadu_si256((const __m256i*)(src + x * 2));
+
+        __m256i y = _mm256_max_epi16(_mm256_sub_epi16(_mm256_shuffle_epi8(in, shufY), lumaOffset), zero);
+        __m256i u = _mm256_sub_epi16(_mm256_shuffle_epi8(in, shufU), chromaOffset);
+        __m256i v = _mm256_sub_epi16(_mm256_shuffle_epi8(in, shufV), chromaOffset);
+
+        __m256i yvLo = _mm256_unpacklo_epi16(y, v), yvHi = _mm256_unpackhi_epi16(y, v);
+        __m256i yuLo = _mm256_unpacklo_epi16(y, u), yuHi = _mm256_unpackhi_epi16(y, u);
+        __m256i v1Lo = _mm256_unpacklo_epi16(v, one), v1Hi = _mm256_unpackhi_epi16(v, one);
+
+        __m256i rLo = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yvLo, coefR), round), 8);
+        __m256i rHi = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yvHi, coefR), round), 8);
+        __m256i bLo = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yuLo, coefB), round), 8);
+        __m256i bHi = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yuHi, coefB), round), 8);
+        __m256i gLo = _mm256_srai_epi32(_mm256_add_epi32(
+            _mm256_madd_epi16(yuLo, coefGyu), _mm256_madd_epi16(v1Lo, coefGv)), 8);
+        __m256i gHi = _mm256_srai_epi32(_mm256_add_epi32(
+            _mm256_madd_epi16(yuHi, coefGyu), _mm256_madd_epi16(v1Hi, coefGv)), 8);
+
+        __m256i r16 = _mm256_packs_epi32(rLo, rHi);
+        __m256i g16 = _mm256_packs_epi32(gLo, gHi);
+        __m256i b16 = _mm256_packs_epi32(bLo, bHi);
+
+        __m256i r8 = _mm256_packus_epi16(r16, r16);
+        __m256i g8 = _mm256_packus_epi16(g16, g16);
+        __m256i b8 = _mm256_packus_epi16(b16, b16);
+
+        __m256i bg = _mm256_unpacklo_epi8(b8, g8);
+        __m256i ra = _mm256_unpacklo_epi8(r8, alpha);
+        __m256i bgraLo = _mm256_unpacklo_epi16(bg, ra);
+        __m256i bgraHi = _mm256_unpackhi_epi16(bg, ra);
+
+        _mm256_storeu_si256((__m256i*)(dst + x * 4), _mm256_permute2x128_si256(bgraLo, bgraHi, 0x20));
+        _mm256_storeu_si256((__m256i*)(dst + x * 4 + 32), _mm256_permute2x128_si256(bgraLo, bgraHi, 0x31));
+    }
+
+    _mm256_zeroupper();
+    UyvyToBgraRowScalar<Matrix>(src + x * 2, dst + x * 4, width - x);
+}
+
+template <int Matrix>
+static void UyvyToBgraRow(const unsigned char* src, unsigned char* dst, int width, bool avx2)
+{
+    if (avx2)
+        UyvyToBgraRowAvx2<Matrix>(src, dst, width);
+    else
+        UyvyToBgraRowScalar<Matrix>(src, dst, width);
+}
+
+template <int Matrix>
+static void UyvyToBgra(const unsigned char* src, int srcPitch, unsigned char* dst, int dstPitch,
+                       int width, int height)
+{
+    bool avx2 = GetSimdLevel() >= SimdLevelAvx2;
+    for (int y = 0; y < height; y++)
+        UyvyToBgraRow<Matrix>(src + (size_t)y * srcPitch, dst + (size_t)y * dstPitch, width, avx2);
+}
+
+// Decimate a UYVY row by divisor (nearest sample: U/Y0/V from the first group of
+// each output pair, Y1 from the group at divisor/2), matching the preview's managed path
+static void DecimateUyvyRow(const unsigned char* src, uint32_t* dst, int dstPairs, int divisor)
+{
+    const uint32_t* groups = (const uint32_t*)src;
+    int half = divisor / 2;
+    for (int p = 0; p < dstPairs; p++)
+    {
+        uint32_t g0 = groups[p * divisor];
+        uint32_t g1 = groups[p * divisor + half];
+        dst[p] = (g0 & 0x00FFFFFF) | ((g1 & 0x0000FF00) << 16);
+    }
+}
+
+template <int Matrix>
+static void UyvyToBgraScaled(const unsigned char* src, int srcPitch, unsigned char* dst, int dstPitch,
+                             int dstWidth, int dstHeight, int divisor)
+{
+    bool avx2 = GetSimdLevel() >= SimdLevelAvx2;
+    alignas(32) uint32_t decimated[ChunkPixels / 2];
+
+    for (int y = 0; y < dstHeight; y++)
+    {
+        const unsigned char* srcRow = src + (size_t)y * divisor * srcPitch;
+        unsigned char* dstRow = dst + (size_t)y * dstPitch;
+
+        for (int x = 0; x < dstWidth; x += ChunkPixels)
+        {
+            int chunk = dstWidth - x < ChunkPixels ? dstWidth - x : ChunkPixels;
+            DecimateUyvyRow(srcRow + (size_t)x * divisor * 2, decimated, chunk / 2, divisor);
+            UyvyToBgraRow<Matrix>((const unsigned char*)decimated, dstRow + x * 4, chunk, avx2);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// BGRA -> UYVY
+// ---------------------------------------------------------------------------
+
+template <int Matrix>
+static void BgraToUyvyRowScalar(const unsigned char* src, unsigned char* dst, int width)
+{
+    typedef YuvCoefficients<Matrix> C;
+
+    for (int x = 0; x + 1 < width; x += 2)
+    {
+        int b0 = src[0], g0 = src[1], r0 = src[2];
+        int b1 = src[4], g1 = src[5], r1 = src[6];
+
+        int y0 = ((C::Yr * r0 + C::Yg * g0 + C::Yb * b0 + 128) >> 8) + 16;
+        int y1 = ((C::Yr * r1 + C::Yg * g1 + C::Yb * b1 + 128) >> 8) + 16;
+
+        // Chroma from the pair average
+        int r = (r0 + r1) >> 1;
+        int g = (g0 + g1) >> 1;
+        int b = (b0 + b1) >> 1;
+
+        dst[0] = ClampByte(((C::Ur * r + C::Ug * g + C::Ub * b + 128) >> 8) + 128);
+        dst[1] = ClampByte(y0);
+        dst[2] = ClampByte(((C::Vr * r + C::Vg * g + C::Vb * b + 128) >> 8) + 128);
+        dst[3] = ClampByte(y1);
+
+        src += 8;
+        dst += 4;
+    }
+}
+
+// 16 pixels (64 bytes BGRA -> 32 bytes UYVY) per iteration
+template <int Matrix>
+static void BgraToUyvyRowAvx2(const unsigned char* src, unsigned char* dst, int width)
+{
+    typedef YuvCoefficients<Matrix> C;
+
+    // Per lane: gather B, G, R, A of 4 pixels into consecutive dwords
+    const __m256i shufPlanar = _mm256_setr_epi8(
+        0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15,
+        0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+    const __m256i permPlanar = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+    const __m256i round = _mm256_set1_epi16(128);
+    const __m256i lumaOffset = _mm256_set1_epi16(16);
+    const __m256i chromaOffset = _mm256_set1_epi16(128);
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        // q = [B0-7 | G0-7 | R0-7 | A0-7] for 8 pixels each
+        __m256i q0 = _mm256_permutevar8x32_epi32(
+            _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(src + x * 4)), shufPlanar), permPlanar);
+        __m256i q1 = _mm256_permutevar8x32_epi32(
+            _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(src + x * 4 + 32)), shufPlanar), permPlanar);
+
+        __m128i q0Lo = _mm256_castsi256_si128(q0), q0Hi = _mm256_extracti128_si256(q0, 1);
+        __m128i q1Lo = _mm256_castsi256_si128(q1), q1Hi = _mm256_extracti128_si256(q1, 1);
+
+        __m256i b = _mm256_cvtepu8_epi16(_mm_unpacklo_epi64(q0Lo, q1Lo));
+        __m256i g = _mm256_cvtepu8_epi16(_mm_unpackhi_epi64(q0Lo, q1Lo));
+        __m256i r = _mm256_cvtepu8_epi16(_mm_unpacklo_epi64(q0Hi, q1Hi));
+
+        // Luma: all terms are non-negative and the sum fits in 16 bits unsigned
+        __m256i y = _mm256_mullo_epi16(r, _mm256_set1_epi16(C::Yr));
+        y = _mm256_add_epi16(y, _mm256_mullo_epi16(g, _mm256_set1_epi16(C::Yg)));
+        y = _mm256_add_epi16(y, _mm256_mullo_epi16(b, _mm256_set1_epi16(C::Yb)));
+        y = _mm256_add_epi16(_mm256_srli_epi16(_mm256_add_epi16(y, round), 8), lumaOffset);
+
+        // Pair averages: per lane, elements 0-3 hold the 4 pairs of that lane's 8 pixels
+        __m256i rp = _mm256_srli_epi16(_mm256_hadd_epi16(r, r), 1);
+        __m256i gp = _mm256_srli_epi16(_mm256_hadd_epi16(g, g), 1);
+        __m256i bp = _mm256_srli_epi16(_mm256_hadd_epi16(b, b), 1);
+
+        // Chroma sums stay within +-28560, so signed 16-bit is exact
+        __m256i u = _mm256_mullo_epi16(rp, _mm256_set1_epi16(C::Ur));
+        u = _mm256_add_epi16(u, _mm256_mullo_epi16(gp, _mm256_set1_epi16(C::Ug)));
+        u = _mm256_add_epi16(u, _mm256_mullo_epi16(bp, _mm256_set1_epi16(C::Ub)));
+        u = _mm256_add_epi16(_mm256_srai_epi16(_mm256_add_epi16(u, round), 8), chromaOffset);
+
+        __m256i v = _mm256_mullo_epi16(rp, _mm256_set1_epi16(C::Vr));
+        v = _mm256_add_epi16(v, _mm256_mullo_epi16(gp, _mm256_set1_epi16(C::Vg)));
+        v = _mm256_add_epi16(v, _mm256_mullo_epi16(bp, _mm256_set1_epi16(C::Vb)));
+        v = _mm256_add_epi16(_mm256_srai_epi16(_mm256_add_epi16(v, round), 8), chromaOffset);
+
+        __m256i uv = _mm256_unpacklo_epi16(u, v);
+        __m256i lo = _mm256_unpacklo_epi16(uv, y);
+        __m256i hi = _mm256_unpackhi_epi16(uv, y);
+
+        _mm256_storeu_si256((__m256i*)(dst + x * 2), _mm256_packus_epi16(lo, hi));
+    }
+
+    _mm256_zeroupper();
+    BgraToUyvyRowScalar<Matrix>(src + x * 4, dst + x * 2, width - x);
+}
+
+template <int Matrix>
+static void BgraToUyvy(const unsigned char* src, int srcPitch, unsigned char* dst, int dstPitch,
+                       int width, int height)
+{
+    bool avx2 = GetSimdLevel() >= SimdLevelAvx2;
+    for (int y = 0; y < height; y++)
+    {
+        const unsigned char* s = src + (size_t)y * srcPitch;
+        unsigned char* d = dst + (size_t)y * dstPitch;
+        if (avx2)
+            BgraToUyvyRowAvx2<Matrix>(s, d, width);
+        else
+            BgraToUyvyRowScalar<Matrix>(s, d, width);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// UYVY -> NV12
+// ---------------------------------------------------------------------------
+
+// Split one UYVY row into luma and chroma; chroma is averaged with the next row
+// when rowB is non-null (4:2:2 -> 4:2:0)
+static void UyvyToNv12RowScalar(const unsigned char* rowA, const unsigned char* rowB,
+                                unsigned char* dstY0, unsigned char* dstY1, unsigned char* dstUV, int width)
+{
+    for (int x = 0; x + 1 < width; x += 2)
+    {
+        const unsigned char* a = rowA + x * 2;
+        dstY0[x] = a[1];
+        dstY0[x + 1] = a[3];
+
+        if (rowB != nullptr)
+        {
+            const unsigned char* b = rowB + x * 2;
+            dstY1[x] = b[1];
+            dstY1[x + 1] = b[3];
+            dstUV[x] = (unsigned char)((a[0] + b[0] + 1) >> 1);
+            dstUV[x + 1] = (unsigned char)((a[2] + b[2] + 1) >> 1);
+        }
+        else
+        {
+            dstUV[x] = a[0];
+            dstUV[x + 1] = a[2];
+        }
+    }
+}
+
+static void UyvyToNv12RowAvx2(const unsigned char* rowA, const unsigned char* rowB,
+                              unsigned char* dstY0, unsigned char* dstY1, unsigned char* dstUV, int width)
+{
+    const __m256i lowBytes = _mm256_set1_epi16(0x00FF);
+
+    int x = 0;
+    if (rowB != nullptr)
+    {
+        for (; x + 32 <= width; x += 32)
+        {
+            __m256i a0 = _mm256_loadu_si256((const __m256i*)(rowA + x * 2));
+            __m256i a1 = _mm256_loadu_si256((const __m256i*)(rowA + x * 2 + 32));
+            __m256i b0 = _mm256_loadu_si256((const __m256i*)(rowB + x * 2));
+            __m256i b1 = _mm256_loadu_si256((const __m256i*)(rowB + x * 2 + 32));
+
+            // packus works in-lane, so fix the qword order afterwards
+            __m256i yA = _mm256_permute4x64_epi64(
+                _mm256_packus_epi16(_mm256_srli_epi16(a0, 8), _mm256_srli_epi16(a1, 8)), 0xD8);
+            __m256i yB = _mm256_permute4x64_epi64(
+                _mm256_packus_epi16(_mm256_srli_epi16(b0, 8), _mm256_srli_epi16(b1, 8)), 0xD8);
+            __m256i cA = _mm256_permute4x64_epi64(
+                _mm256_packus_epi16(_mm256_and_si256(a0, lowBytes), _mm256_and_si256(a1, lowBytes)), 0xD8);
+            __m256i cB = _mm256_permute4x64_epi64(
+                _mm256_packus_epi16(_mm256_and_si256(b0, lowBytes), _mm256_and_si256(b1, lowBytes)), 0xD8);
+
+            _mm256_storeu_si256((__m256i*)(dstY0 + x), yA);
+            _mm256_storeu_si256((__m256i*)(dstY1 + x), yB);
+            _mm256_storeu_si256((__m256i*)(dstUV + x), _mm256_avg_epu8(cA, cB));
+        }
+    }
+    else
+    {
+        for (; x + 32 <= width; x += 32)
+        {
+            __m256i a0 = _mm256_loadu_si256((const __m256i*)(rowA + x * 2));
+            __m256i a1 = _mm256_loadu_si256((const __m256i*)(rowA + x * 2 + 32));
+
+            __m256i yA = _mm256_permute4x64_epi64(
+                _mm256_packus_epi16(_mm256_srli_epi16(a0, 8), _mm256_srli_epi16(a1, 8)), 0xD8);
+            __m256i cA = _mm256_permute4x64_epi64(
+                _mm256_packus_epi16(_mm256_and_si256(a0, lowBytes), _mm256_and_si256(a1, lowBytes)), 0xD8);
+
+            _mm256_storeu_si256((__m256i*)(dstY0 + x), yA);
+            _mm256_storeu_si256((__m256i*)(dstUV + x), cA);
+        }
+    }
+
+    _mm256_zeroupper();
+    UyvyToNv12RowScalar(rowA + x * 2, rowB ? rowB + x * 2 : nullptr,
+                        dstY0 + x, dstY1 + x, dstUV + x, width - x);
+}
+
+static void UyvyToNv12(const unsigned char* src, int srcPitch,
+                       unsigned char* dstY, int dstYPitch, unsigned char* dstUV, int dstUVPitch,
+                       int width, int height)
+{
+    bool avx2 = GetSimdLevel() >= SimdLevelAvx2;
+    for (int y = 0; y < height; y += 2)
+    {
+        const unsigned char* rowA = src + (size_t)y * srcPitch;
+        const unsigned char* rowB = (y + 1 < height) ? rowA + srcPitch : nullptr;
+        unsigned char* y0 = dstY + (size_t)y * dstYPitch;
+        unsigned char* y1 = y0 + dstYPitch;
+        unsigned char* uv = dstUV + (size_t)(y / 2) * dstUVPitch;
+
+        if (avx2)
+            UyvyToNv12RowAvx2(rowA, rowB, y0, y1, uv, width);
+        else
+            UyvyToNv12RowScalar(rowA, rowB, y0, y1, uv, width);
+    }
+}
+
+// UYVY -> NV12 at 1/divisor resolution. Unlike the BGRA preview decimation this box
+// filters: each halving averages a 2x2 block of luma and the four chroma samples under
+// each output pair, so a downscaled encode does not alias.
+
+static void HalveUyvyRowsScalar(const unsigned char* rowA, const unsigned char* rowB,
+                                unsigned char* dst, int dstWidth)
+{
+    for (int p = 0; p < dstWidth / 2; p++)
+    {
+        const unsigned char* a = rowA + p * 8;
+        const unsigned char* b = rowB + p * 8;
+        unsigned char v[8];
+        for (int i = 0; i < 8; i++)
+            v[i] = (unsigned char)((a[i] + b[i] + 1) >> 1);
+
+        unsigned char* d = dst + p * 4;
+        d[0] = (unsigned char)((v[0] + v[4] + 1) >> 1);    // U0 U1
+        d[1] = (unsigned char)((v[1] + v[3] + 1) >> 1);    // Y0 Y1
+        d[2] = (unsigned char)((v[2] + v[6] + 1) >> 1);    // V0 V1
+        d[3] = (unsigned char)((v[5] + v[7] + 1) >> 1);    // Y2 Y3
+    }
+}
+
+static void HalveUyvyRowsAvx2(const unsigned char* rowA, const unsigned char* rowB,
+                              unsigned char* dst, int dstWidth)
+{
+    // Per 8-byte group U0 Y0 V0 Y1 U1 Y2 V1 Y3: average bytes {0,4} {1,3} {2,6} {5,7}
+    const __m256i pickA = _mm256_setr_epi8(
+        0, 1, 2, 5, 8, 9, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1,
+        0, 1, 2, 5, 8, 9, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m256i pickB = _mm256_setr_epi8(
+        4, 3, 6, 7, 12, 11, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1,
+        4, 3, 6, 7, 12, 11, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1);
+
+    int pairs = dstWidth / 2;
+    int p = 0;
+    for (; p + 4 <= pairs; p += 4)
+    {
+        __m256i v = _mm256_avg_epu8(_mm256_loadu_si256((const __m256i*)(rowA + p * 8)),
+                                    _mm256_loadu_si256((const __m256i*)(rowB + p * 8)));
+        __m256i h = _mm256_avg_epu8(_mm256_shuffle_epi8(v, pickA), _mm256_shuffle_epi8(v, pickB));
+
+        // Each lane produced 8 bytes in its low qword
+        _mm_storeu_si128((__m128i*)(dst + p * 4), _mm256_castsi256_si128(_mm256_permute4x64_epi64(h, 0x08)));
+    }
+
+    _mm256_zeroupper();
+    HalveUyvyRowsScalar(rowA + p * 8, rowB + p * 8, dst + p * 4, (pairs - p) * 2);
+}
+
+static void HalveUyvyRows(const unsigned char* rowA, const unsigned char* rowB,
+                          unsigned char* dst, int dstWidth, bool avx2)
+{
+    if (avx2)
+        HalveUyvyRowsAvx2(rowA, rowB, dst, dstWidth);
+    else
+        HalveUyvyRowsScalar(rowA, rowB, dst, dstWidth);
+}
+
+// One output-size UYVY row (pixels [x, x + width) of output row y) from divisor source rows
+static void ScaleUyvyRow(const unsigned char* src, int srcPitch, int y, int x, int width, int divisor,
+                         unsigned char* dst, unsigned char* scratchA, unsigned char* scratchB, bool avx2)
+{
+    const unsigned char* row = src + (size_t)y * divisor * srcPitch + (size_t)x * divisor * 2;
+    if (divisor == 2)
+    {
+        HalveUyvyRows(row, row + srcPitch, dst, width, avx2);
+        return;
+    }
+
+    HalveUyvyRows(row, row + srcPitch, scratchA, width * 2, avx2);
+    HalveUyvyRows(row + (size_t)srcPitch * 2, row + (size_t)srcPitch * 3, scratchB, width * 2, avx2);
+    HalveUyvyRows(scratchA, scratchB, dst, width, avx2);
+}
+
+static void UyvyToNv12Scaled(const unsigned char* src, int srcPitch,
+                             unsigned char* dstY, int dstYPitch, unsigned char* dstUV, int dstUVPitch,
+                             int dstWidth, int dstHeight, int divisor)
+{
+    bool avx2 = GetSimdLevel() >= SimdLevelAvx2;
+    alignas(32) unsigned char scaled[2][ChunkPixels * 2];
+    alignas(32) unsigned char scratch[2][ChunkPixels * 4];
+
+    for (int y = 0; y < dstHeight; y += 2)
+    {
+        bool pair = y + 1 < dstHeight;
+        unsigned char* y0 = dstY + (size_t)y * dstYPitch;
+        unsigned char* y1 = y0 + dstYPitch;
+        unsigned char* uv = dstUV + (size_t)(y / 2) * dstUVPitch;
+
+        for (int x = 0; x < dstWidth; x += ChunkPixels)
+        {
+            int chunk = dstWidth - x < ChunkPixels ? dstWidth - x : ChunkPixels;
+            ScaleUyvyRow(src, srcPitch, y, x, chunk, divisor, scaled[0], scratch[0], scratch[1], avx2);
+            if (pair)
+                ScaleUyvyRow(src, srcPitch, y + 1, x, chunk, divisor, scaled[1], scratch[0], scratch[1], avx2);
+
+            const unsigned char* rowB = pair ? scaled[1] : nullptr;
+            if (avx2)
+                UyvyToNv12RowAvx2(scaled[0], rowB, y0 + x, y1 + x, uv + x, chunk);
+            else
+                UyvyToNv12RowScalar(scaled[0], rowB, y0 + x, y1 + x, uv + x, chunk);
+        }
+    }
+}
+
+// One preview pyramid level: each output sample averages a 2x2 source block
+static void HalveUyvy(const unsigned char* src, int srcPitch, unsigned char* dst, int dstPitch,
+                      int dstWidth, int dstHeight)
+{
+    bool avx2 = GetSimdLevel() >= SimdLevelAvx2;
+    for (int y = 0; y < dstHeight; y++)
+    {
+        const unsigned char* row = src + (size_t)y * 2 * srcPitch;
+        HalveUyvyRows(row, row + srcPitch, dst + (size_t)y * dstPitch, dstWidth, avx2);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// NV12 -> UYVY
+// ---------------------------------------------------------------------------
+
+// 4:2:0 -> 4:2:2 for decoded frames. A 4:2:0 chroma row sits between its two luma rows,
+// so each output row takes 3/4 of the nearest chroma row and 1/4 of the next nearest
+// (computed as avg(near, avg(near, far))).
+static void Nv12ToUyvyRowScalar(const unsigned char* srcY, const unsigned char* uvNear,
+                                const unsigned char* uvFar, unsigned char* dst, int width)
+{
+    for (int x = 0; x + 1 < width; x += 2)
+    {
+        unsigned char* d = dst + x * 2;
+        d[0] = (unsigned char)((uvNear[x] + ((uvNear[x] + uvFar[x] + 1) >> 1) + 1) >> 1);
+        d[1] = srcY[x];
+        d[2] = (unsigned char)((uvNear[x + 1] + ((uvNear[x + 1] + uvFar[x + 1] + 1) >> 1) + 1) >> 1);
+        d[3] = srcY[x + 1];
+    }
+}
+
+static void Nv12ToUyvyRowAvx2(const unsigned char* srcY, const unsigned char* uvNear,
+                              const unsigned char* uvFar, unsigned char* dst, int width)
+{
+    int x = 0;
+    for (; x + 32 <= width; x += 32)
+    {
+        __m256i y = _mm256_loadu_si256((const __m256i*)(srcY + x));
+        __m256i n = _mm256_loadu_si256((const __m256i*)(uvNear + x));
+        __m256i f = _mm256_loadu_si256((const __m256i*)(uvFar + x));
+        __m256i uv = _mm256_avg_epu8(n, _mm256_avg_epu8(n, f));
+
+        // unpack works in-lane: lo = pixels 0-7 | 16-23, hi = pixels 8-15 | 24-31
+        __m256i lo = _mm256_unpacklo_epi8(uv, y);
+        __m256i hi = _mm256_unpackhi_epi8(uv, y);
+        _mm256_storeu_si256((__m256i*)(dst + x * 2), _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i*)(dst + x * 2 + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+
+    _mm256_zeroupper();
+    Nv12ToUyvyRowScalar(srcY + x, uvNear + x, uvFar + x, dst + x * 2, width - x);
+}
+
+static void Nv12ToUyvy(const unsigned char* srcY, int srcYPitch, const unsigned char* srcUV, int srcUVPitch,
+                       unsigned char* dst, int dstPitch, int width, int height)
+{
+    bool avx2 = GetSimdLevel() >= SimdLevelAvx2;
+    int chromaRows = (height + 1) / 2;
+    for (int y = 0; y < height; y++)
+    {
+        int near = y / 2;
+        int far = (y & 1) ? near + 1 : near - 1;
+        if (far < 0) far = 0;
+        if (far >= chromaRows) far = chromaRows - 1;
+
+        const unsigned char* rowY = srcY + (size_t)y * srcYPitch;
+        const unsigned char* uvNear = srcUV + (size_t)near * srcUVPitch;
+        const unsigned char* uvFar = srcUV + (size_t)far * srcUVPitch;
+        unsigned char* d = dst + (size_t)y * dstPitch;
+
+        if (avx2)
+            Nv12ToUyvyRowAvx2(rowY, uvNear, uvFar, d, width);
+        else
+            Nv12ToUyvyRowScalar(rowY, uvNear, uvFar, d, width);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// v210
+// ---------------------------------------------------------------------------
+
+// v210 packs 6 pixels into four little-endian 32-bit words, three 10-bit samples
+// per word. Read in order the samples are Cb Y Cr Y Cb Y ..., i.e. the same U Y V Y
+// order as UYVY, so unpacking yields a 16-bit "UYVY" row that the 8-bit kernels reuse.
+
+static void UnpackV210Scalar(const uint32_t* src, uint16_t* dst, int blocks)
+{
+    for (int i = 0; i < blocks; i++)
+    {
+        for (int w = 0; w < 4; w++)
+        {
+            uint32_t word = src[w];
+            dst[w * 3 + 0] = (uint16_t)(word & 0x3FF);
+            dst[w * 3 + 1] = (uint16_t)((word >> 10) & 0x3FF);
+            dst[w * 3 + 2] = (uint16_t)((word >> 20) & 0x3FF);
+        }
+        src += 4;
+        dst += 12;
+    }
+}
+
+// Two blocks (8 words -> 24 samples) per iteration
+static void UnpackV210Avx2(const uint32_t* src, uint16_t* dst, int blocks)
+{
+    const __m256i idxA = _mm256_setr_epi32(0, 0, 0, 1, 1, 1, 2, 2);
+    const __m256i idxB = _mm256_setr_epi32(2, 3, 3, 3, 4, 4, 4, 5);
+    const __m256i idxC = _mm256_setr_epi32(5, 5, 6, 6, 6, 7, 7, 7);
+    const __m256i shA = _mm256_setr_epi32(0, 10, 20, 0, 10, 20, 0, 10);
+    const __m256i shB = _mm256_setr_epi32(20, 0, 10, 20, 0, 10, 20, 0);
+    const __m256i shC = _mm256_setr_epi32(10, 20, 0, 10, 20, 0, 10, 20);
+    const __m256i mask = _mm256_set1_epi32(0x3FF);
+
+    int i = 0;
+    for (; i + 2 <= blocks; i += 2)
+    {
+        __m256i words = _mm256_loadu_si256((const __m256i*)src);
+
+        __m256i a = _mm256_and_si256(_mm256_srlv_epi32(_mm256_permutevar8x32_epi32(words, idxA), shA), mask);
+        __m256i b = _mm256_and_si256(_mm256_srlv_epi32(_mm256_permutevar8x32_epi32(words, idxB), shB), mask);
+        __m256i c = _mm256_and_si256(_mm256_srlv_epi32(_mm256_permutevar8x32_epi32(words, idxC), shC), mask);
+
+        __m256i ab = _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b), 0xD8);
+        __m256i cc = _mm256_permute4x64_epi64(_mm256_packus_epi32(c, c), 0xD8);
+
+        _mm256_storeu_si256((__m256i*)dst, ab);
+        _mm_storeu_si128((__m128i*)(dst + 16), _mm256_castsi256_si128(cc));
+
+        src += 8;
+        dst += 24;
+    }
+
+    _mm256_zeroupper();
+    UnpackV210Scalar(src, dst, blocks - i);
+}
+
+static void UnpackV210(const unsigned char* src, uint16_t* dst, int pixels, bool avx2)
+{
+    int blocks = (pixels + 5) / 6;
+    if (avx2)
+        UnpackV210Avx2((const uint32_t*)src, dst, blocks);
+    else
+        UnpackV210Scalar((const uint32_t*)src, dst, blocks);
+}
+
+// Byte offset of the given pixel in a v210 row (pixel must be a multiple of 6)
+static inline size_t V210ByteOffset(int pixel)
+{
+    return (size_t)(pixel / 6) * 16;
+}
+
+static void Narrow10To8(const uint16_t* src, unsigned char* dst, int count, bool avx2)
+{
+    int i = 0;
+    if (avx2)
+    {
+        const __m256i round = _mm256_set1_epi16(2);
+        for (; i + 32 <= count; i += 32)
+        {
+            __m256i a = _mm256_srli_epi16(_mm256_add_epi16(_mm256_loadu_si256((const __m256i*)(src + i)), round), 2);
+            __m256i b = _mm256_srli_epi16(_mm256_add_epi16(_mm256_loadu_si256((const __m256i*)(src + i + 16)), round), 2);
+            _mm256_storeu_si256((__m256i*)(dst + i), _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8));
+        }
+        _mm256_zeroupper();
+    }
+
+    for (; i < count; i++)
+    {
+        int v = (src[i] + 2) >> 2;
+        dst[i] = (unsigned char)(v > 255 ? 255 : v);
+    }
+}
+
+template <int Matrix>
+static void V210ToBgra(const unsigned char* src, int srcPitch, unsigned char* dst, int dstPitch,
+                       int width, int height)
+{
+    bool avx2 = GetSimdLevel() >= SimdLevelAvx2;
+    alignas(32) uint16_t samples[ChunkPixels * 2];
+    alignas(32) unsigned char uyvy[ChunkPixels * 2];
+
+    for (int y = 0; y < height; y++)
+    {
+        const unsigned char* srcRow = src + (size_t)y * srcPitch;
+        unsigned char* dstRow = dst + (size_t)y * dstPitch;
+
+        for (int x = 0; x < width; x += ChunkPixels)
+        {
+            int chunk = width - x < ChunkPixels ? width - x : ChunkPixels;
+            UnpackV210(srcRow + V210ByteOffset(x), samples, chunk, avx2);
+            Narrow10To8(samples, uyvy, chunk * 2, avx2);
+            UyvyToBgraRow<Matrix>(uyvy, dstRow + x * 4, chunk, avx2);
+        }
+    }
+}
+
+// Preview path: unpack and narrow ChunkPixels source pixels at a time, then reuse the
+// UYVY decimation so the output matches UyvyToBgraScaled on the equivalent 8-bit frame
+template <int Matrix>
+static void V210ToBgraScaled(const unsigned char* src, int srcPitch, unsigned char* dst, int dstPitch,
+                             int dstWidth, int dstHeight, int divisor)
+{
+    bool avx2 = GetSimdLevel() >= SimdLevelAvx2;
+    alignas(32) uint16_t samples[ChunkPixels * 2];
+    alignas(32) unsigned char uyvy[ChunkPixels * 2];
+    alignas(32) uint32_t decimated[ChunkPixels / 2];
+    const int dstChunkPixels = ChunkPixels / divisor;
+
+    for (int y = 0; y < dstHeight; y++)
+    {
+        const unsigned char* srcRow = src + (size_t)y * divisor * srcPitch;
+        unsigned char* dstRow = dst + (size_t)y * dstPitch;
+
+        for (int x = 0; x < dstWidth; x += dstChunkPixels)
+        {
+            int chunk = dstWidth - x < dstChunkPixels ? dstWidth - x : dstChunkPixels;
+            int srcPixels = chunk * divisor;
+            UnpackV210(srcRow + V210ByteOffset(x * divisor), samples, srcPixels, avx2);
+            Narrow10To8(samples, uyvy, srcPixels * 2, avx2);
+            DecimateUyvyRow(uyvy, decimated, chunk / 2, divisor);
+            UyvyToBgraRow<Matrix>((const unsigned char*)decimated, dstRow + x * 4, chunk, avx2);
+        }
+    }
+}
+
+// P010: 16-bit little-endian samples with the 10-bit value in the high bits
+static void SamplesToP010Scalar(const uint16_t* a, const uint16_t* b,
+                                uint16_t* dstY0, uint16_t* dstY1, uint16_t* dstUV, int width)
+{
+    for (int x = 0; x + 1 < width; x += 2)
+    {
+        const uint16_t* sa = a + x * 2;
+        dstY0[x] = (uint16_t)(sa[1] << 6);
+        dstY0[x + 1] = (uint16_t)(sa[3] << 6);
+
+        if (b != nullptr)
+        {
+            const uint16_t* sb = b + x * 2;
+            dstY1[x] = (uint16_t)(sb[1] << 6);
+            dstY1[x + 1] = (uint16_t)(sb[3] << 6);
+            dstUV[x] = (uint16_t)(((sa[0] + sb[0] + 1) >> 1) << 6);
+            dstUV[x + 1] = (uint16_t)(((sa[2] + sb[2] + 1) >> 1) << 6);
+        }
+        else
+        {
+            dstUV[x] = (uint16_t)(sa[0] << 6);
+            dstUV[x + 1] = (uint16_t)(sa[2] << 6);
+        }
+    }
+}
+
+static void SamplesToP010Avx2(const uint16_t* a, const uint16_t* b,
+                              uint16_t* dstY0, uint16_t* dstY1, uint16_t* dstUV, int width)
+{
+    const __m256i lowWords = _mm256_set1_epi32(0xFFFF);
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        __m256i a0 = _mm256_loadu_si256((const __m256i*)(a + x * 2));
+        __m256i a1 = _mm256_loadu_si256((const __m256i*)(a + x * 2 + 16));
+
+        __m256i yA = _mm256_permute4x64_epi64(
+            _mm256_packus_epi32(_mm256_srli_epi32(a0, 16), _mm256_srli_epi32(a1, 16)), 0xD8);
+        __m256i cA = _mm256_permute4x64_epi64(
+            _mm256_packus_epi32(_mm256_and_si256(a0, lowWords), _mm256_and_si256(a1, lowWords)), 0xD8);
+
+        _mm256_storeu_si256((__m256i*)(dstY0 + x), _mm256_slli_epi16(yA, 6));
+
+        if (b != nullptr)
+        {
+            __m256i b0 = _mm256_loadu_si256((const __m256i*)(b + x * 2));
+            __m256i b1 = _mm256_loadu_si256((const __m256i*)(b + x * 2 + 16));
+
+            __m256i yB = _mm256_permute4x64_epi64(
+                _mm256_packus_epi32(_mm256_srli_epi32(b0, 16), _mm256_srli_epi32(b1, 16)), 0xD8);
+            __m256i cB = _mm256_permute4x64_epi64(
+                _mm256_packus_epi32(_mm256_and_si256(b0, lowWords), _mm256_and_si256(b1, lowWords)), 0xD8);
+
+            _mm256_storeu_si256((__m256i*)(dstY1 + x), _mm256_slli_epi16(yB, 6));
+            cA = _mm256_avg_epu16(cA, cB);
+        }
+
+        _mm256_storeu_si256((__m256i*)(dstUV + x), _mm256_slli_epi16(cA, 6));
+    }
+
+    _mm256_zeroupper();
+    SamplesToP010Scalar(a + x * 2, b ? b + x * 2 : nullptr, dstY0 + x, dstY1 + x, dstUV + x, width - x);
+}
+
+static void V210ToP010(const unsigned char* src, int srcPitch,
+                       unsigned char* dstY, int dstYPitch, unsigned char* dstUV, int dstUVPitch,
+                       int width, int height)
+{
+    bool avx2 = GetSimdLevel() >= SimdLevelAvx2;
+    alignas(32) uint16_t samplesA[ChunkPixels * 2];
+    alignas(32) uint16_t samplesB[ChunkPixels * 2];
+
+    for (int y = 0; y < height; y += 2)
+    {
+        const unsigned char* rowA = src + (size_t)y * srcPitch;
+        const unsigned char* rowB = (y + 1 < height) ? rowA + srcPitch : nullptr;
+        unsigned char* y0 = dstY + (size_t)y * dstYPitch;
+        unsigned char* y1 = y0 + dstYPitch;
+        unsigned char* uv = dstUV + (size_t)(y / 2) * dstUVPitch;
+
+        for (int x = 0; x < width; x += ChunkPixels)
+        {
+            int chunk = width - x < ChunkPixels ? width - x : ChunkPixels;
+            UnpackV210(rowA + V210ByteOffset(x), samplesA, chunk, avx2);
+            if (rowB != nullptr)
+                UnpackV210(rowB + V210ByteOffset(x), samplesB, chunk, avx2);
+
+            uint16_t* outY0 = (uint16_t*)y0 + x;
+            uint16_t* outY1 = (uint16_t*)y1 + x;
+            uint16_t* outUV = (uint16_t*)uv + x;
+            const uint16_t* b = rowB ? samplesB : nullptr;
+
+            if (avx2)
+                SamplesToP010Avx2(samplesA, b, outY0, outY1, outUV, chunk);
+            else
+                SamplesToP010Scalar(samplesA, b, outY0, outY1, outUV, chunk);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Exports
+// ---------------------------------------------------------------------------
+
+static bool ValidPackedArgs(const void* src, int srcPitch, const void* dst, int dstPitch,
+                            int width, int height, int srcBytesPerPixel, int dstBytesPerPixel)
+{
+    return src != nullptr && dst != nullptr && width >= 2 && (width & 1) == 0 && height > 0 &&
+           srcPitch >= width * srcBytesPerPixel && dstPitch >= width * dstBytesPerPixel;
+}
+
+// Minimum v210 row pitch: rows are padded to 48-pixel (128-byte) groups, which also
+// guarantees the unpacker's whole-block reads stay inside the row
+static inline int V210MinPitch(int width)
+{
+    return ((width + 47) / 48) * 128;
+}
+
+extern "C" {
+
+MEDIA_KERNELS_API int ConvertUYVYToBGRA(const void* src, int srcPitch, void* dst, int dstPitch,
+                                        int width, int height, int matrix)
+{
+    if (!ValidPackedArgs(src, srcPitch, dst, dstPitch, width, height, 2, 4))
+        return -1;
+
+    const unsigned char* s = (const unsigned char*)src;
+    unsigned char* d = (unsigned char*)dst;
+    if (matrix == ColorMatrixBt709)
+        UyvyToBgra<ColorMatrixBt709>(s, srcPitch, d, dstPitch, width, height);
+    else
+        UyvyToBgra<ColorMatrixBt601>(s, srcPitch, d, dstPitch, width, height);
+    return 0;
+}
+
+MEDIA_KERNELS_API int ConvertUYVYToBGRAScaled(const void* src, int srcPitch, void* dst, int dstPitch,
+                                              int dstWidth, int dstHeight, int divisor, int matrix)
+{
+    if (divisor != 2 && divisor != 4)
+        return -1;
+    if (!ValidPackedArgs(src, srcPitch, dst, dstPitch, dstWidth, dstHeight, 2 * divisor, 4))
+        return -1;
+
+    const unsigned char* s = (const unsigned char*)src;
+    unsigned char* d = (unsigned char*)dst;
+    if (matrix == ColorMatrixBt709)
+        UyvyToBgraScaled<ColorMatrixBt709>(s, srcPitch, d, dstPitch, dstWidth, dstHeight, divisor);
+    else
+        UyvyToBgraScaled<ColorMatrixBt601>(s, srcPitch, d, dstPitch, dstWidth, dstHeight, divisor);
+    return 0;
+}
+
+MEDIA_KERNELS_API int ConvertBGRAToUYVY(const void* src, int srcPitch, void* dst, int dstPitch,
+                                        int width, int height, int matrix)
+{
+    if (!ValidPackedArgs(src, srcPitch, dst, dstPitch, width, height, 4, 2))
+        return -1;
+
+    const unsigned char* s = (const unsigned char*)src;
+    unsigned char* d = (unsigned char*)dst;
+    if (matrix == ColorMatrixBt709)
+        BgraToUyvy<ColorMatrixBt709>(s, srcPitch, d, dstPitch, width, height);
+    else
+        BgraToUyvy<ColorMatrixBt601>(s, srcPitch, d, dstPitch, width, height);
+    return 0;
+}
+
+MEDIA_KERNELS_API int ConvertUYVYToNV12(const void* src, int srcPitch,
+                                        void* dstY, int dstYPitch, void* dstUV, int dstUVPitch,
+                                        int width, int height)
+{
+    if (!ValidPackedArgs(src, srcPitch, dstY, dstYPitch, width, height, 2, 1) ||
+        dstUV == nullptr || dstUVPitch < width)
+        return -1;
+
+    UyvyToNv12((const unsigned char*)src, srcPitch,
+               (unsigned char*)dstY, dstYPitch, (unsigned char*)dstUV, dstUVPitch, width, height);
+    return 0;
+}
+
+MEDIA_KERNELS_API int ConvertUYVYToNV12Scaled(const void* src, int srcPitch,
+                                              void* dstY, int dstYPitch, void* dstUV, int dstUVPitch,
+                                              int dstWidth, int dstHeight, int divisor)
+{
+    if (divisor != 1 && divisor != 2 && divisor != 4)
+        return -1;
+    if (!ValidPackedArgs(src, srcPitch, dstY, dstYPitch, dstWidth, dstHeight, 2 * divisor, 1) ||
+        dstUV == nullptr || dstUVPitch < dstWidth)
+        return -1;
+
+    if (divisor == 1)
+        UyvyToNv12((const unsigned char*)src, srcPitch,
+                   (unsigned char*)dstY, dstYPitch, (unsigned char*)dstUV, dstUVPitch, dstWidth, dstHeight);
+    else
+        UyvyToNv12Scaled((const unsigned char*)src, srcPitch,
+                         (unsigned char*)dstY, dstYPitch, (unsigned char*)dstUV, dstUVPitch, dstWidth, dstHeight, divisor);
+    return 0;
+}
+
+MEDIA_KERNELS_API int DownscaleUYVYHalf(const void* src, int srcPitch, void* dst, int dstPitch,
+                                        int dstWidth, int dstHeight)
+{
+    if (!ValidPackedArgs(src, srcPitch, dst, dstPitch, dstWidth, dstHeight, 4, 2))
+        return -1;
+
+    HalveUyvy((const unsigned char*)src, srcPitch, (unsigned char*)dst, dstPitch, dstWidth, dstHeight);
+    return 0;
+}
+
+MEDIA_KERNELS_API int ConvertNV12ToUYVY(const void* srcY, int srcYPitch, const void* srcUV, int srcUVPitch,
+                                        void* dst, int dstPitch, int width, int height)
+{
+    if (!ValidPackedArgs(srcY, srcYPitch, dst, dstPitch, width, height, 1, 2) ||
+        srcUV == nullptr || srcUVPitch < width)
+        return -1;
+
+    Nv12ToUyvy((const unsigned char*)srcY, srcYPitch, (const unsigned char*)srcUV, srcUVPitch,
+               (unsigned char*)dst, dstPitch, width, height);
+    return 0;
+}
+
+MEDIA_KERNELS_API int ConvertV210ToBGRA(const void* src, int srcPitch, void* dst, int dstPitch,
+                                        int width, int height, int matrix)
+{
+    if (!ValidPackedArgs(src, srcPitch, dst, dstPitch, width, height, 0, 4) || srcPitch < V210MinPitch(width))
+        return -1;
+
+    const unsigned char* s = (const unsigned char*)src;
+    unsigned char* d = (unsigned char*)dst;
+    if (matrix == ColorMatrixBt709)
+        V210ToBgra<ColorMatrixBt709>(s, srcPitch, d, dstPitch, width, height);
+    else
+        V210ToBgra<ColorMatrixBt601>(s, srcPitch, d, dstPitch, width, height);
+    return 0;
+}
+
+MEDIA_KERNELS_API int ConvertV210ToBGRAScaled(const void* src, int srcPitch, void* dst, int dstPitch,
+                                              int dstWidth, int dstHeight, int divisor, int matrix)
+{
+    if (divisor != 2 && divisor != 4)
+        return -1;
+    if (!ValidPackedArgs(src, srcPitch, dst, dstPitch, dstWidth, dstHeight, 0, 4) ||
+        srcPitch < V210MinPitch(dstWidth * divisor))
+        return -1;
+
+    const unsigned char* s = (const unsigned char*)src;
+    unsigned char* d = (unsigned char*)dst;
+    if (matrix == ColorMatrixBt709)
+        V210ToBgraScaled<ColorMatrixBt709>(s, srcPitch, d, dstPitch, dstWidth, dstHeight, divisor);
+    else
+        V210ToBgraScaled<ColorMatrixBt601>(s, srcPitch, d, dstPitch, dstWidth, dstHeight, divisor);
+    return 0;
+}
+
+MEDIA_KERNELS_API int ConvertV210ToP010(const void* src, int srcPitch,
+                                        void* dstY, int dstYPitch, void* dstUV, int dstUVPitch,
+                                        int width, int height)
+{
+    if (!ValidPackedArgs(src, srcPitch, dstY, dstYPitch, width, height, 0, 2) ||
+        srcPitch < V210MinPitch(width) || dstUV == nullptr || dstUVPitch < width * 2)
+        return -1;
+
+    V210ToP010((const unsigned char*)src, srcPitch,
+               (unsigned char*)dstY, dstYPitch, (unsigned char*)dstUV, dstUVPitch, width, height);
+    return 0;
+}
+
+}
@@ -0,0 +1,46 @@
+#include "CpuFeatures.h"
+
+#include <intrin.h>
+#include <immintrin.h>
+
+static int DetectSimdLevel()
+{
+    int info[4] = {0};
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+
+    __cpuid(info, 1);
+    bool hasSse41 = (info[2] & (1 << 19)) != 0;
+    bool hasOsxsave = (info[2] & (1 << 27)) != 0;
+    bool hasAvx = (info[2] & (1 << 28)) != 0;
+
+    bool osYmm = false;
+    bool osZmm = false;
+    if (hasOsxsave && hasAvx)
+    {
+        unsigned long long xcr0 = _xgetbv(0);
+        osYmm = (xcr0 & 0x6) == 0x6;      // XMM + YMM state
+        osZmm = (xcr0 & 0xE6) == 0xE6;    // + opmask, ZMM_Hi256, Hi16_ZMM
+    }
+
+    bool hasAvx2 = false;
+    bool hasAvx512 = false;
+    if (maxLeaf >= 7)
+    {
+        __cpuidex(info, 7, 0);
+        hasAvx2 = (info[1] & (1 << 5)) != 0;
+        hasAvx512 = (info[1] & (1 << 16)) != 0 &&   // AVX512F
+                    (info[1] & (1 << 30)) != 0;     // AVX512BW
+    }
+
+    if (hasAvx512 && hasAvx2 && osZmm) return SimdLevelAvx512;
+    if (hasAvx2 && osYmm) return SimdLevelAvx2;
+    if (hasSse41) return SimdLevelSse41;
+    return SimdLevelScalar;
+}
+
+int GetSimdLevel()
+{
+    static const int level = DetectSimdLevel();
+    return level;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+// SIMD level shared by all runtime-dispatched kernels in this DLL
+enum SimdLevel
+{
+    SimdLevelScalar = 0,
+    SimdLevelSse41 = 1,
+    SimdLevelAvx2 = 2,
+    SimdLevelAvx512 = 3     // AVX-512 F + BW
+};
+
+// Returns the highest SimdLevel supported by both the CPU and the OS (detected once)
+int GetSimdLevel();
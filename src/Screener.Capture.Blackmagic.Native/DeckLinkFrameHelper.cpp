@@ -1,32 +1,17 @@
 #define DECKLINK_NATIVE_EXPORTS
 #include "DeckLinkFrameHelper.h"
+#include "FrameAnalysis.h"
+#include "FrameCopy.h"
+#include "CpuFeatures.h"
+#include "MediaKernels.h"
+#include "TraceLog.h"
 
 #include <Windows.h>
 #include <Unknwn.h>
 #include <string.h>
 #include <stdio.h>
 #include <math.h>
-
-// Debug logging helper
-static FILE* g_logFile = nullptr;
-
-static void DebugLog(const char* format, ...)
-{
-    char buffer[512];
-    va_list args;
-    va_start(args, format);
-    vsnprintf(buffer, sizeof(buffer), format, args);
-    va_end(args);
-    OutputDebugStringA(buffer);
-
-    // Open, write, close each time to allow reading the log while app runs
-    FILE* logFile = nullptr;
-    if (fopen_s(&logFile, "C:\\screener\\native_debug.log", "a") == 0 && logFile != nullptr)
-    {
-        fprintf(logFile, "%s", buffer);
-        fclose(logFile);
-    }
-}
+#include <new>
 
 // IDeckLinkVideoBuffer interface GUID (SDK 15.3 - from DeckLinkAPI.idl)
 // {CCB4B64A-5C86-4E02-B778-885D352709FE}
@@ -64,127 +49,259 @@ enum BMDBufferAccessMode
 // [4] StartAccess
 // [5] EndAccess
 
-// Helper for Welford's online variance calculation
-static void UpdateStats(unsigned char v, double* mean, double* m2, int i)
+// Frame geometry as reported by the IDeckLinkVideoFrame vtable
+struct FrameGeometry
 {
-    double x = (double)v;
-    double delta = x - *mean;
-    *mean += delta / (i + 1);
-    double delta2 = x - *mean;
-    *m2 += delta * delta2;
-}
-
-// Detect if buffer contains corrupt BGRA data instead of UYVY
-// Returns true if the data looks like BGRA (corrupt), false if it looks like valid UYVY
-static bool LooksLikeCorruptBGRA(unsigned char* p, int width, int height, int rowBytes)
-{
-    // Sample ~2048 pixels worth of 4-byte groups
-    const int samples = 2048;
-    int widthBytes = width * 2; // UYVY: 2 bytes per pixel
-
-    int c0FF = 0, c1FF = 0, c2FF = 0, c3FF = 0;
-    double m0 = 0, m1 = 0, m2 = 0, m3 = 0;
-    double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    long width;
+    long height;
+    long rowBytes;
+    unsigned int pixelFormat;
+};
 
-    // Pick lines spread out; avoid only one row
-    for (int i = 0; i < samples; i++)
-    {
-        int y = (i * 131) % height;                 // pseudo-spread
-        int x = ((i * 337) % (widthBytes - 4));     // byte offset
-        x &= ~3;                                    // align to 4 bytes
+// 10-bit capture format (BMDPixelFormat 'v210'); anything else is treated as 8-bit UYVY ('2vuy')
+static const unsigned int PixelFormat10BitYUV = 0x76323130;
 
-        int offset = y * rowBytes + x;
-        unsigned char b0 = p[offset + 0];
-        unsigned char b1 = p[offset + 1];
-        unsigned char b2 = p[offset + 2];
-        unsigned char b3 = p[offset + 3];
+// Byte offset of pixel x within a row. v210 packs 6 pixels into each 16-byte group,
+// so the offset is rounded down to the start of the group containing x.
+static long PixelByteOffset(const FrameGeometry& g, long x)
+{
+    if (g.pixelFormat == PixelFormat10BitYUV)
+        return (x / 6) * 16;
+    return x * 2;
+}
 
-        if (b0 == 0xFF) c0FF++;
-        if (b1 == 0xFF) c1FF++;
-        if (b2 == 0xFF) c2FF++;
-        if (b3 == 0xFF) c3FF++;
+// Bytes of video per row (v210 rows are padded to a multiple of 128 bytes);
+// anything beyond this up to rowBytes is HANC
+static long ActiveRowBytes(const FrameGeometry& g)
+{
+    if (g.pixelFormat == PixelFormat10BitYUV)
+        return ((g.width + 47) / 48) * 128;
+    return g.width * 2;
+}
 
-        // online mean/variance per lane (Welford)
-        UpdateStats(b0, &m0, &s0, i);
-        UpdateStats(b1, &m1, &s1, i);
-        UpdateStats(b2, &m2, &s2, i);
-        UpdateStats(b3, &m3, &s3, i);
-    }
+// True if the 4 bytes at p are video black in the frame's pixel format. In v210 the
+// first word of a black group is 00 02 01 20, the same bytes as an ANC header in UYVY.
+static bool IsBlackWord(const unsigned char* p, unsigned int pixelFormat)
+{
+    if (pixelFormat == PixelFormat10BitYUV)
+        return p[0] == 0x00 && p[1] == 0x02 && p[2] == 0x01 && p[3] == 0x20;
+    return p[0] == 0x80 && p[1] == 0x10 && p[2] == 0x80 && p[3] == 0x10;
+}
 
-    double p0 = (double)c0FF / samples;
-    double p1 = (double)c1FF / samples;
-    double p2 = (double)c2FF / samples;
-    double p3 = (double)c3FF / samples;
+// Fill a region with video black in the frame's pixel format
+static void FillBlack(unsigned char* dst, int size, unsigned int pixelFormat)
+{
+    // UYVY: U=128 Y=16 V=128 Y=16. v210: Cb/Cr=512, Y=64 packed as alternating
+    // words 0x20010200 (Cb Y Cr) and 0x04080040 (Y Cb Y), little-endian.
+    static const unsigned char uyvyBlack[8] = { 0x80, 0x10, 0x80, 0x10, 0x80, 0x10, 0x80, 0x10 };
+    static const unsigned char v210Black[8] = { 0x00, 0x02, 0x01, 0x20, 0x40, 0x00, 0x08, 0x04 };
+    const unsigned char* pattern = (pixelFormat == PixelFormat10BitYUV) ? v210Black : uyvyBlack;
+
+    for (int i = 0; i < size; i++)
+        dst[i] = pattern[i & 7];
+}
 
-    double maxOther = (p0 > p1) ? p0 : p1;
-    if (p2 > maxOther) maxOther = p2;
-    double alphaBias = p3 - maxOther;
+// Per-input capture session state. Created once when an input starts so the
+// resolved buffer-access path and frame geometry survive across frames.
+struct DeckLinkCaptureSession
+{
+    int accessPath;         // DeckLinkAccessPath value that last produced a frame
+    FrameGeometry geometry; // Cached geometry (valid when hasGeometry is true)
+    bool hasGeometry;
+    DeckLinkCropRegion requestedCrop; // Crop as passed by the caller (valid when hasCrop is true)
+    DeckLinkCropRegion crop;          // Same, with skipRows resolved once VANC detection has run
+    bool hasCrop;
+    DeckLinkCaptureStats stats;
+    long long callbackTime;           // QPC time of the current frame's callback (0 = not marked)
+    long long lastCallbackTime;       // QPC time of the previous frame's callback
+};
 
-    double var0 = s0 / (samples - 1);
-    double var1 = s1 / (samples - 1);
-    double var2 = s2 / (samples - 1);
-    double var3 = s3 / (samples - 1);
+static long long TicksToMicros(long long ticks)
+{
+    static LARGE_INTEGER frequency = {};
+    if (frequency.QuadPart == 0)
+        QueryPerformanceFrequency(&frequency);
+    return ticks / frequency.QuadPart * 1000000 + ticks % frequency.QuadPart * 1000000 / frequency.QuadPart;
+}
 
-    double varY = var1 + var3;
-    double varUV = var0 + var2;
+static void RecordLatency(DeckLinkLatencyHistogram* h, long long ticks)
+{
+    unsigned long long us = ticks > 0 ? (unsigned long long)TicksToMicros(ticks) : 0;
+    int bucket = 0;
+    while (bucket < DECKLINK_LATENCY_BUCKETS - 1 && us >= (16ULL << bucket))
+        bucket++;
+
+    h->buckets[bucket]++;
+    h->count++;
+    h->totalUs += us;
+    if (us > h->maxUs)
+        h->maxUs = us;
+}
 
-    // In BGRA, byte 3 (alpha) is typically 0xFF with low variance
-    // In UYVY, all bytes have similar variance patterns
-    bool suspiciousAlpha = (p3 > 0.20 && alphaBias > 0.10) || (p3 > 0.35);
-    bool suspiciousVariance = (var3 < 50.0 && p3 > 0.10) || (varY < varUV * 0.8);
+static void RecordCopy(DeckLinkCaptureSession* session, int result, int bufferSize,
+                       long long copyStart, long long copyEnd)
+{
+    DeckLinkCaptureStats& stats = session->stats;
+    switch (result)
+    {
+    case 1:
+        stats.framesGood++;
+        stats.bytesCopied += bufferSize;
+        if (session->accessPath >= 0 && session->accessPath < 4)
+            stats.framesByPath[session->accessPath]++;
+        break;
+    case -1: stats.framesCorrupt++; break;
+    case -2: stats.framesPartial++; break;
+    default: stats.framesFailed++; break;
+    }
 
-    return suspiciousAlpha || suspiciousVariance;
+    stats.accessPath = session->accessPath;
+    RecordLatency(&stats.copy, copyEnd - copyStart);
+    if (session->callbackTime != 0)
+    {
+        RecordLatency(&stats.callbackToCopy, copyStart - session->callbackTime);
+        session->callbackTime = 0;
+    }
 }
 
-extern "C" {
+// Rows scanned from the top of the frame when detecting VANC
+static const long MaxVancRows = 120;
 
-DECKLINK_API int CopyDeckLinkFrameBytes(void* framePtr, void* buffer, int bufferSize)
+// Resolved copy for one frame: `rows` rows of rowBytes read from src + srcOffset at
+// srcPitch, written tightly packed, then fillBytes of black. An uncropped copy is a
+// single contiguous row.
+struct CopyRegion
 {
-    if (framePtr == nullptr || buffer == nullptr || bufferSize <= 0)
-        return 0;
-
-    IUnknown* unknown = reinterpret_cast<IUnknown*>(framePtr);
+    long srcOffset;
+    long srcPitch;
+    long rowBytes;
+    long rows;
+    long fillBytes;
+    long dstPitch;   // pitch of the destination as a frame (for logging and validation)
+};
 
-    // Validate the COM pointer is valid by querying IUnknown
-    IUnknown* testUnk = nullptr;
-    HRESULT hrTest = unknown->QueryInterface(IID_IUnknown, (void**)&testUnk);
+// Count the rows at the top of the frame that carry ANC packets (or nothing) instead
+// of picture. Reads the DMA buffer, so the caller must be inside __try.
+static long DetectVancRows(const unsigned char* src, const FrameGeometry& g, long skipBytes)
+{
+    // v210 black starts with the same bytes as an ANC header, so VANC cannot be
+    // told apart from a black picture
+    if (g.pixelFormat == PixelFormat10BitYUV)
+        return 0;
 
-    static bool loggedValidation = false;
-    if (!loggedValidation)
+    long maxRows = g.height < MaxVancRows ? g.height : MaxVancRows;
+    for (long row = 0; row < maxRows; row++)
     {
-        DebugLog("[DeckLinkNative] COM validation: unknown=%p, QI(IUnknown) hr=0x%08X, ptr=%p\n", unknown, hrTest, testUnk);
-        loggedValidation = true;
+        const unsigned char* p = src + row * g.rowBytes + skipBytes;
+        bool isAnc = p[0] == 0x00 && p[1] == 0x02 && p[2] == 0x01 && p[3] == 0x20;
+        bool isZero = p[0] == 0x00 && p[1] == 0x00 && p[2] == 0x00 && p[3] == 0x00;
+        if (!isAnc && !isZero)
+            return row;
     }
+    return maxRows;
+}
 
-    if (FAILED(hrTest) || testUnk == nullptr)
+static long CropRowBytes(const FrameGeometry& g, const DeckLinkCropRegion& crop)
+{
+    return crop.rowBytes > 0 ? crop.rowBytes : g.rowBytes - crop.skipBytes;
+}
+
+// Work out what to copy for this frame. crop may be null (copy the whole frame);
+// a pending VANC detection (skipRows < 0) is resolved here and stored back into crop.
+// Reads the DMA buffer when detecting, so the caller must be inside __try.
+static bool ResolveCopyRegion(const unsigned char* src, const FrameGeometry& g, DeckLinkCropRegion* crop,
+                              int bufferSize, CopyRegion* r)
+{
+    if (crop == nullptr)
     {
-        DebugLog("[DeckLinkNative] Invalid COM pointer: QueryInterface(IID_IUnknown) failed hr=0x%08X\n", hrTest);
-        return 0;
+        long frameSize = g.rowBytes * g.height;
+        long size = bufferSize < frameSize ? bufferSize : frameSize;
+        *r = { 0, size, size, 1, 0, g.rowBytes };
+        return size > 0;
     }
-    testUnk->Release();
 
-    // Also try QI for IDeckLinkVideoFrame to verify we have the right interface
-    IUnknown* testVF = nullptr;
-    HRESULT hrVF = unknown->QueryInterface(IID_IDeckLinkVideoFrame, (void**)&testVF);
-    static bool loggedVF = false;
-    if (!loggedVF)
+    long rowBytes = CropRowBytes(g, *crop);
+    if (crop->skipBytes < 0 || rowBytes <= 0 || crop->skipBytes + rowBytes > g.rowBytes ||
+        rowBytes * g.height > bufferSize)
+        return false;
+
+    if (crop->skipRows < 0)
     {
-        DebugLog("[DeckLinkNative] QI(IDeckLinkVideoFrame) hr=0x%08X, ptr=%p\n", hrVF, testVF);
-        loggedVF = true;
+        crop->skipRows = (int)DetectVancRows(src, g, crop->skipBytes);
+        TRACE(TraceLevelInfo, "[DeckLinkNative] Crop: %d VANC rows, skip %d bytes/row, %d active bytes/row (%dx%d, rowBytes=%d)\n",
+            crop->skipRows, crop->skipBytes, rowBytes, g.width, g.height, g.rowBytes);
     }
-    if (testVF) testVF->Release();
 
-    // Try QI for IDeckLinkVideoInputFrame (the actual type from callbacks)
-    IUnknown* testVIF = nullptr;
-    HRESULT hrVIF = unknown->QueryInterface(IID_IDeckLinkVideoInputFrame, (void**)&testVIF);
-    static bool loggedVIF = false;
-    if (!loggedVIF)
+    if (crop->skipRows >= g.height)
+        return false;
+
+    r->srcOffset = crop->skipRows * g.rowBytes + crop->skipBytes;
+    r->srcPitch = g.rowBytes;
+    r->rowBytes = rowBytes;
+    r->rows = g.height - crop->skipRows;
+    r->fillBytes = crop->skipRows * rowBytes;
+    r->dstPitch = rowBytes;
+    return true;
+}
+
+// Optional side output of a copy: the detectors' downsampled luma plane
+struct LumaTarget
+{
+    unsigned char* plane;   // width * height bytes
+    int width;
+    int height;
+    bool written;           // set once the plane holds this frame's luma
+};
+
+// Sample the luma plane from the source rows just copied, while they are still cache
+// resident, so the detectors never read the 4 MB slot again. The plane matches what
+// FrameAnalyzer would extract from the destination, black-filled bottom rows included.
+static void SampleCopiedLuma(const unsigned char* src, const CopyRegion& r, const FrameGeometry& g, LumaTarget* luma)
+{
+    // Uncropped copies are one contiguous run of whole source rows
+    long pitch = r.rows == 1 ? g.rowBytes : r.srcPitch;
+    long rowBytes = r.rows == 1 ? g.rowBytes : r.rowBytes;
+    long validRows = r.rows == 1 ? r.rowBytes / g.rowBytes : r.rows;
+    if (rowBytes < ActiveRowBytes(g) || validRows <= 0)
+        return;
+
+    int format = g.pixelFormat == PixelFormat10BitYUV ? LumaFormatV210 : LumaFormatUyvy;
+    luma->written = ExtractLumaPlane(src + r.srcOffset, pitch, g.width, g.height, validRows,
+                                     format, luma->plane, luma->width, luma->height);
+}
+
+// Copy a resolved region in one pass, filling in luma (may be null) on success.
+// Faults on the caller's thread propagate.
+static bool CopyRegionRows(void* buffer, const unsigned char* src, const CopyRegion& r, const FrameGeometry& g,
+                           LumaTarget* luma)
+{
+    unsigned char* dst = (unsigned char*)buffer;
+    bool ok = (r.rows == 1)
+        ? FrameCopy(dst, src + r.srcOffset, r.rowBytes)
+        : FrameCopyRows(dst, src + r.srcOffset, r.srcPitch, r.rowBytes, r.rows);
+
+    if (r.fillBytes > 0)
+        FillBlack(dst + r.rows * r.rowBytes, (int)r.fillBytes, g.pixelFormat);
+
+    if (ok && luma != nullptr)
+        SampleCopiedLuma(src, r, g, luma);
+    return ok;
+}
+
+static const char* AccessPathName(int path)
+{
+    switch (path)
     {
-        DebugLog("[DeckLinkNative] QI(IDeckLinkVideoInputFrame) hr=0x%08X, ptr=%p\n", hrVIF, testVIF);
-        loggedVIF = true;
+    case DeckLinkAccessPathVideoBuffer: return "VideoBuffer";
+    case DeckLinkAccessPathLegacy:      return "Legacy v14.2.1";
+    case DeckLinkAccessPathOffset280:   return "Offset-280";
+    default:                            return "Unknown";
     }
-    if (testVIF) testVIF->Release();
+}
 
+// Read width/height/rowBytes/pixelFormat from the IDeckLinkVideoFrame vtable
+static bool ReadFrameGeometry(IUnknown* unknown, FrameGeometry* geometry)
+{
     // Get frame dimensions from vtable (IDeckLinkVideoFrame interface)
     void** vtable = *(void***)unknown;
 
@@ -195,166 +312,177 @@ DECKLINK_API int CopyDeckLinkFrameBytes(void* framePtr, void* buffer, int buffer
     GetLongFunc getRowBytes = (GetLongFunc)vtable[5];
     GetPixelFormatFunc getPixelFormat = (GetPixelFormatFunc)vtable[6];
 
-    long width = 0, height = 0, rowBytes = 0;
-    unsigned int pixelFormat = 0;
     __try
     {
-        width = getWidth(unknown);
-        height = getHeight(unknown);
-        rowBytes = getRowBytes(unknown);
-        pixelFormat = getPixelFormat(unknown);
+        geometry->width = getWidth(unknown);
+        geometry->height = getHeight(unknown);
+        geometry->rowBytes = getRowBytes(unknown);
+        geometry->pixelFormat = getPixelFormat(unknown);
+        return true;
     }
     __except(EXCEPTION_EXECUTE_HANDLER)
     {
-        DebugLog("[DeckLinkNative] Failed to get frame dimensions\n");
-        return 0;
+        TRACE(TraceLevelWarning, "[DeckLinkNative] Failed to get frame dimensions\n");
+        return false;
     }
+}
 
-    // SDK 15.3 IDeckLinkVideoFrame vtable (GetBytes was REMOVED in SDK 14.3):
-    //   [3]=GetWidth, [4]=GetHeight, [5]=GetRowBytes, [6]=GetPixelFormat,
-    //   [7]=GetFlags, [8]=GetTimecode, [9]=GetAncillaryData
-    // GetBytes is now only available via:
-    //   1. IDeckLinkVideoBuffer interface (QI) - GetBytes at vtable[3]
-    //   2. Legacy IDeckLinkVideoInputFrame_v14_2_1 (QI) - GetBytes at vtable[8]
-    //   3. Offset-280 fallback (raw DMA pointer, fragile)
-
-    // Try to get IDeckLinkVideoBuffer interface (SDK 12.0+)
+// Path 1: IDeckLinkVideoBuffer (SDK 12.0+). Returns 1 on success, 0 otherwise.
+static int CopyViaVideoBuffer(IUnknown* unknown, const FrameGeometry& g, DeckLinkCropRegion* crop,
+                              void* buffer, int bufferSize, LumaTarget* luma)
+{
     IUnknown* videoBuffer = nullptr;
     HRESULT hr = unknown->QueryInterface(IID_IDeckLinkVideoBuffer, (void**)&videoBuffer);
 
     static bool loggedQI = false;
     if (!loggedQI)
     {
-        DebugLog("[DeckLinkNative] QueryInterface(IDeckLinkVideoBuffer): hr=0x%08X, ptr=%p, unknown=%p\n", hr, videoBuffer, unknown);
+        TRACE(TraceLevelInfo, "[DeckLinkNative] QueryInterface(IDeckLinkVideoBuffer): hr=0x%08X, ptr=%p, unknown=%p\n", hr, videoBuffer, unknown);
         loggedQI = true;
     }
 
-    if (SUCCEEDED(hr) && videoBuffer != nullptr)
-    {
-        DebugLog("[DeckLinkNative] Got IDeckLinkVideoBuffer interface\n");
+    if (FAILED(hr) || videoBuffer == nullptr)
+        return 0;
 
-        void** vbVtable = *(void***)videoBuffer;
+    void** vbVtable = *(void***)videoBuffer;
 
-        // SDK 15.3 vtable layout: [3]=GetBytes, [4]=StartAccess, [5]=EndAccess
-        typedef HRESULT (STDMETHODCALLTYPE *GetBytesFunc)(void* pThis, void** buffer);
-        typedef HRESULT (STDMETHODCALLTYPE *StartAccessFunc)(void* pThis, unsigned int accessMode);
-        typedef HRESULT (STDMETHODCALLTYPE *EndAccessFunc)(void* pThis, unsigned int accessMode);
+    // SDK 15.3 vtable layout: [3]=GetBytes, [4]=StartAccess, [5]=EndAccess
+    typedef HRESULT (STDMETHODCALLTYPE *GetBytesFunc)(void* pThis, void** buffer);
+    typedef HRESULT (STDMETHODCALLTYPE *StartAccessFunc)(void* pThis, unsigned int accessMode);
+    typedef HRESULT (STDMETHODCALLTYPE *EndAccessFunc)(void* pThis, unsigned int accessMode);
 
-        GetBytesFunc getBytes = (GetBytesFunc)vbVtable[3];
-        StartAccessFunc startAccess = (StartAccessFunc)vbVtable[4];
-        EndAccessFunc endAccess = (EndAccessFunc)vbVtable[5];
+    GetBytesFunc getBytes = (GetBytesFunc)vbVtable[3];
+    StartAccessFunc startAccess = (StartAccessFunc)vbVtable[4];
+    EndAccessFunc endAccess = (EndAccessFunc)vbVtable[5];
 
-        void* srcPtr = nullptr;
-        int result = 0;
+    void* srcPtr = nullptr;
+    int result = 0;
 
-        __try
+    __try
+    {
+        hr = startAccess(videoBuffer, bmdBufferAccessRead);
+        if (SUCCEEDED(hr))
         {
-            hr = startAccess(videoBuffer, bmdBufferAccessRead);
-            if (SUCCEEDED(hr))
+            hr = getBytes(videoBuffer, &srcPtr);
+            CopyRegion region;
+            if (SUCCEEDED(hr) && srcPtr != nullptr &&
+                ResolveCopyRegion((const unsigned char*)srcPtr, g, crop, bufferSize, &region))
             {
-                hr = getBytes(videoBuffer, &srcPtr);
-                if (SUCCEEDED(hr) && srcPtr != nullptr)
-                {
-                    int copySize = (bufferSize < rowBytes * height) ? bufferSize : (rowBytes * height);
-                    memcpy(buffer, srcPtr, copySize);
+                long copySize = region.rowBytes * region.rows;
+                if (CopyRegionRows(buffer, (const unsigned char*)srcPtr, region, g, luma))
                     result = 1;
 
-                    static int frameCount = 0;
-                    frameCount++;
-                    if (frameCount <= 5 || frameCount % 100 == 0)
-                    {
-                        unsigned char* b = (unsigned char*)buffer;
-                        int midOffset = (height / 2) * rowBytes + (width / 2) * 2;
-                        DebugLog("[DeckLinkNative] Frame %d (VideoBuffer): %dx%d, copied %d, first: %02X %02X %02X %02X, mid: %02X %02X %02X %02X\n",
-                            frameCount, width, height, copySize,
-                            b[0], b[1], b[2], b[3],
-                            b[midOffset], b[midOffset+1], b[midOffset+2], b[midOffset+3]);
-                    }
-                }
-                else
+                static int frameCount = 0;
+                frameCount++;
+                if (result == 1 && (frameCount <= 5 || frameCount % 100 == 0))
                 {
-                    DebugLog("[DeckLinkNative] VideoBuffer GetBytes failed: hr=0x%08X, ptr=%p\n", hr, srcPtr);
+                    unsigned char* b = (unsigned char*)buffer;
+                    long midOffset = (g.height / 2) * region.dstPitch + PixelByteOffset(g, g.width / 2);
+                    TRACE(TraceLevelInfo, "[DeckLinkNative] Frame %d (VideoBuffer): %dx%d, copied %d, first: %02X %02X %02X %02X, mid: %02X %02X %02X %02X\n",
+                        frameCount, g.width, g.height, copySize,
+                        b[0], b[1], b[2], b[3],
+                        b[midOffset], b[midOffset+1], b[midOffset+2], b[midOffset+3]);
                 }
-
-                endAccess(videoBuffer, bmdBufferAccessRead);
             }
             else
             {
-                DebugLog("[DeckLinkNative] VideoBuffer StartAccess failed: hr=0x%08X\n", hr);
+                TRACE(TraceLevelWarning, "[DeckLinkNative] VideoBuffer GetBytes failed: hr=0x%08X, ptr=%p\n", hr, srcPtr);
             }
+
+            endAccess(videoBuffer, bmdBufferAccessRead);
         }
-        __except(EXCEPTION_EXECUTE_HANDLER)
+        else
         {
-            DebugLog("[DeckLinkNative] Exception in VideoBuffer access\n");
+            TRACE(TraceLevelWarning, "[DeckLinkNative] VideoBuffer StartAccess failed: hr=0x%08X\n", hr);
         }
-
-        videoBuffer->Release();
-        if (result == 1) return result;
-        // If VideoBuffer path failed, fall through to legacy/offset paths
+    }
+    __except(EXCEPTION_EXECUTE_HANDLER)
+    {
+        TRACE(TraceLevelWarning, "[DeckLinkNative] Exception in VideoBuffer access\n");
     }
 
-    // Try legacy IDeckLinkVideoInputFrame_v14_2_1 which still has GetBytes at vtable[8]
-    // This is the approach FFmpeg uses for SDK 14.3+ compatibility
+    videoBuffer->Release();
+    return result;
+}
+
+// Path 2: legacy IDeckLinkVideoInputFrame_v14_2_1 which still has GetBytes at vtable[8].
+// This is the approach FFmpeg uses for SDK 14.3+ compatibility. Returns 1 on success, 0 otherwise.
+static int CopyViaLegacyFrame(IUnknown* unknown, const FrameGeometry& g, DeckLinkCropRegion* crop,
+                              void* buffer, int bufferSize, LumaTarget* luma)
+{
     IUnknown* legacyFrame = nullptr;
     HRESULT hrLegacy = unknown->QueryInterface(IID_IDeckLinkVideoInputFrame_v14_2_1, (void**)&legacyFrame);
 
     static bool loggedLegacy = false;
     if (!loggedLegacy)
     {
-        DebugLog("[DeckLinkNative] QI(IDeckLinkVideoInputFrame_v14_2_1): hr=0x%08X, ptr=%p\n", hrLegacy, legacyFrame);
+        TRACE(TraceLevelInfo, "[DeckLinkNative] QI(IDeckLinkVideoInputFrame_v14_2_1): hr=0x%08X, ptr=%p\n", hrLegacy, legacyFrame);
         loggedLegacy = true;
     }
 
-    if (SUCCEEDED(hrLegacy) && legacyFrame != nullptr)
-    {
-        void** legacyVtable = *(void***)legacyFrame;
+    if (FAILED(hrLegacy) || legacyFrame == nullptr)
+        return 0;
+
+    void** legacyVtable = *(void***)legacyFrame;
 
-        // v14_2_1 vtable: [0-2]=IUnknown, [3-7]=IDeckLinkVideoFrame_v14_2_1
-        // (GetWidth/GetHeight/GetRowBytes/GetPixelFormat/GetFlags), [8]=GetBytes
-        typedef HRESULT (STDMETHODCALLTYPE *GetBytesFunc)(void* pThis, void** buffer);
-        GetBytesFunc getBytes = (GetBytesFunc)legacyVtable[8];
+    // v14_2_1 vtable: [0-2]=IUnknown, [3-7]=IDeckLinkVideoFrame_v14_2_1
+    // (GetWidth/GetHeight/GetRowBytes/GetPixelFormat/GetFlags), [8]=GetBytes
+    typedef HRESULT (STDMETHODCALLTYPE *GetBytesFunc)(void* pThis, void** buffer);
+    GetBytesFunc getBytes = (GetBytesFunc)legacyVtable[8];
 
-        void* srcPtr = nullptr;
-        int result = 0;
+    void* srcPtr = nullptr;
+    int result = 0;
 
-        __try
+    __try
+    {
+        HRESULT hrGB = getBytes(legacyFrame, &srcPtr);
+        CopyRegion region;
+        if (SUCCEEDED(hrGB) && srcPtr != nullptr &&
+            ResolveCopyRegion((const unsigned char*)srcPtr, g, crop, bufferSize, &region))
         {
-            HRESULT hrGB = getBytes(legacyFrame, &srcPtr);
-            if (SUCCEEDED(hrGB) && srcPtr != nullptr)
-            {
-                int copySize = (bufferSize < rowBytes * height) ? bufferSize : (rowBytes * height);
-                memcpy(buffer, srcPtr, copySize);
+            long copySize = region.rowBytes * region.rows;
+            if (CopyRegionRows(buffer, (const unsigned char*)srcPtr, region, g, luma))
                 result = 1;
 
-                static int legacyOkCount = 0;
-                legacyOkCount++;
-                if (legacyOkCount <= 5 || legacyOkCount % 100 == 0)
-                {
-                    unsigned char* b = (unsigned char*)buffer;
-                    int midOffset = (height / 2) * rowBytes + (width / 2) * 2;
-                    DebugLog("[DeckLinkNative] Frame %d (Legacy v14.2.1 GetBytes): %dx%d, copied %d, first: %02X %02X %02X %02X, mid: %02X %02X %02X %02X\n",
-                        legacyOkCount, width, height, copySize,
-                        b[0], b[1], b[2], b[3],
-                        b[midOffset], b[midOffset+1], b[midOffset+2], b[midOffset+3]);
-                }
-            }
-            else
+            static int legacyOkCount = 0;
+            legacyOkCount++;
+            if (result == 1 && (legacyOkCount <= 5 || legacyOkCount % 100 == 0))
             {
-                DebugLog("[DeckLinkNative] Legacy GetBytes failed: hr=0x%08X, ptr=%p\n", hrGB, srcPtr);
+                unsigned char* b = (unsigned char*)buffer;
+                long midOffset = (g.height / 2) * region.dstPitch + PixelByteOffset(g, g.width / 2);
+                TRACE(TraceLevelInfo, "[DeckLinkNative] Frame %d (Legacy v14.2.1 GetBytes): %dx%d, copied %d, first: %02X %02X %02X %02X, mid: %02X %02X %02X %02X\n",
+                    legacyOkCount, g.width, g.height, copySize,
+                    b[0], b[1], b[2], b[3],
+                    b[midOffset], b[midOffset+1], b[midOffset+2], b[midOffset+3]);
             }
         }
-        __except(EXCEPTION_EXECUTE_HANDLER)
+        else
         {
-            DebugLog("[DeckLinkNative] Exception in legacy GetBytes\n");
+            TRACE(TraceLevelWarning, "[DeckLinkNative] Legacy GetBytes failed: hr=0x%08X, ptr=%p\n", hrGB, srcPtr);
         }
-
-        legacyFrame->Release();
-        if (result == 1) return result;
+    }
+    __except(EXCEPTION_EXECUTE_HANDLER)
+    {
+        TRACE(TraceLevelWarning, "[DeckLinkNative] Exception in legacy GetBytes\n");
     }
 
-    // Last resort: Direct buffer access via offset 280 in the DeckLink frame object.
-    // This offset consistently returns valid frame structure (ANC at top, video below).
-    // When there's no signal, the video area shows BLACK (80 10 80 10).
+    legacyFrame->Release();
+    return result;
+}
+
+// Path 3 (last resort): direct buffer access via offset 280 in the DeckLink frame object.
+// This offset consistently returns valid frame structure (ANC at top, video below).
+// When there's no signal, the video area shows BLACK (80 10 80 10, or 00 02 01 20 in v210).
+// The ANC rows are dropped here when the caller passes a crop region.
+// Returns 1 = good frame, 0 = not enough data, -1 = data looks corrupt (BGRA-like),
+// -2 = only part of the frame was readable (cropped copies only; see CopyDeckLinkSessionFrameCropped).
+static int CopyViaOffset280(IUnknown* unknown, const FrameGeometry& g, DeckLinkCropRegion* crop,
+                            void* buffer, int bufferSize, LumaTarget* luma)
+{
+    const long width = g.width;
+    const long height = g.height;
+    const long rowBytes = g.rowBytes;
+    const unsigned int pixelFormat = g.pixelFormat;
 
     unknown->AddRef();
 
@@ -364,7 +492,7 @@ DECKLINK_API int CopyDeckLinkFrameBytes(void* framePtr, void* buffer, int buffer
 
     static bool loggedOnce = false;
     if (!loggedOnce) {
-        DebugLog("[DeckLinkNative] Using offset %d for buffer access. Dimensions: %dx%d, rowBytes=%d\n",
+        TRACE(TraceLevelInfo, "[DeckLinkNative] Using offset %d for buffer access. Dimensions: %dx%d, rowBytes=%d\n",
             usedOffset, width, height, rowBytes);
         loggedOnce = true;
     }
@@ -384,52 +512,72 @@ DECKLINK_API int CopyDeckLinkFrameBytes(void* framePtr, void* buffer, int buffer
 
     unsigned char* src = (unsigned char*)ptr;
     unsigned char* dst = (unsigned char*)buffer;
-    int bytesCopied = 0;
+    long bytesCopied = 0;
 
-    // Skip VANC row detection - it causes delays and exceptions
-    // Copy as fast as possible, C# will handle VANC row skipping
+    // When cropping, VANC detection runs once per session (inside the __try) and the
+    // ANC rows and HANC bytes are never copied
     const int chunkSize = 65536;
 
+    CopyRegion region = {};
+    bool resolved = false;
+    bool fullCopyOk = false;
     __try
     {
-        memcpy(dst, src, bufferSize);
-        bytesCopied = bufferSize;
+        resolved = ResolveCopyRegion(src, g, crop, bufferSize, &region);
+        fullCopyOk = resolved && CopyRegionRows(dst, src, region, g, luma);
     }
     __except(EXCEPTION_EXECUTE_HANDLER)
     {
-        // Fallback: copy in smaller chunks
-        for (int pos = 0; pos < bufferSize; pos += chunkSize)
+        fullCopyOk = false;
+    }
+
+    if (!resolved)
+    {
+        unknown->Release();
+        return 0;
+    }
+
+    const long totalBytes = region.rowBytes * region.rows;
+    if (fullCopyOk)
+    {
+        bytesCopied = totalBytes;
+    }
+    else
+    {
+        // Fallback: copy each row in smaller chunks
+        for (long row = 0; row < region.rows; row++)
         {
-            int thisChunk = (pos + chunkSize <= bufferSize) ? chunkSize : (bufferSize - pos);
-            __try
+            unsigned char* dstRow = dst + row * region.rowBytes;
+            const unsigned char* srcRow = src + region.srcOffset + row * region.srcPitch;
+            for (long pos = 0; pos < region.rowBytes; pos += chunkSize)
             {
-                memcpy(dst + pos, src + pos, thisChunk);
-                bytesCopied += thisChunk;
-            }
-            __except(EXCEPTION_EXECUTE_HANDLER)
-            {
-                // Fill with black in UYVY format: U=128, Y=16, V=128, Y=16
-                // Pattern: 0x80 0x10 0x80 0x10 (repeating)
-                unsigned char* fillPtr = dst + pos;
-                for (int i = 0; i < thisChunk; i += 4)
+                int thisChunk = (int)((pos + chunkSize <= region.rowBytes) ? chunkSize : (region.rowBytes - pos));
+                __try
                 {
-                    fillPtr[i] = 0x80;     // U (neutral)
-                    fillPtr[i + 1] = 0x10; // Y (black)
-                    fillPtr[i + 2] = 0x80; // V (neutral)
-                    fillPtr[i + 3] = 0x10; // Y (black)
+                    FrameCopyStreaming(dstRow + pos, srcRow + pos, thisChunk);
+                    bytesCopied += thisChunk;
+                }
+                __except(EXCEPTION_EXECUTE_HANDLER)
+                {
+                    // Unreadable chunk: fill with black so it shows as no-signal rather than garbage
+                    FillBlack(dstRow + pos, thisChunk, pixelFormat);
                 }
             }
         }
+        if (region.fillBytes > 0)
+            FillBlack(dst + totalBytes, (int)region.fillBytes, pixelFormat);
     }
 
     static int legacyFrameCount = 0;
     legacyFrameCount++;
 
-    // Check if the copied data looks like corrupt BGRA instead of valid UYVY
+    // Check if the copied data looks like corrupt BGRA instead of valid UYVY.
+    // The classifier only understands 8-bit UYVY, so v210 frames are not checked.
     bool isCorrupt = false;
-    if (bytesCopied > bufferSize / 2)
+    if (bytesCopied > totalBytes / 2 && pixelFormat != PixelFormat10BitYUV)
     {
-        isCorrupt = LooksLikeCorruptBGRA(dst, width, height, rowBytes);
+        long checkWidth = crop != nullptr ? region.dstPitch / 2 : width;
+        isCorrupt = DetectCorruptBGRA(dst, bufferSize, checkWidth, height, region.dstPitch) == 1;
     }
 
     // Log every frame for first 10, then every 100th, with full geometry info
@@ -444,53 +592,60 @@ DECKLINK_API int CopyDeckLinkFrameBytes(void* framePtr, void* buffer, int buffer
         fcc[2] = (char)((pixelFormat >> 16) & 0xFF);
         fcc[3] = (char)((pixelFormat >> 24) & 0xFF);
 
-        DebugLog("[DeckLinkNative] Frame %d: w=%d h=%d rowBytes=%d pixFmt=0x%08X('%s') ptr=%p corrupt=%d\n",
+        TRACE(TraceLevelInfo, "[DeckLinkNative] Frame %d: w=%d h=%d rowBytes=%d pixFmt=0x%08X('%s') ptr=%p corrupt=%d\n",
             legacyFrameCount, width, height, rowBytes, pixelFormat, fcc, ptr, isCorrupt ? 1 : 0);
 
+        // The dump reads the destination, which is tightly packed when cropped
+        const long dumpPitch = region.dstPitch;
+        const long dumpSize = totalBytes;
+
         // Dump bytes at different offsets to help diagnose pointer start position
         // User requested: bytes at p+0, p+rowBytes, p+2*rowBytes, p-16, p+16
-        DebugLog("  ptr+0:       %02X %02X %02X %02X %02X %02X %02X %02X  %02X %02X %02X %02X %02X %02X %02X %02X\n",
+        TRACE(TraceLevelVerbose, "  ptr+0:       %02X %02X %02X %02X %02X %02X %02X %02X  %02X %02X %02X %02X %02X %02X %02X %02X\n",
             b[0], b[1], b[2], b[3], b[4], b[5], b[6], b[7],
             b[8], b[9], b[10], b[11], b[12], b[13], b[14], b[15]);
-        DebugLog("  ptr+rowBytes: %02X %02X %02X %02X %02X %02X %02X %02X  %02X %02X %02X %02X %02X %02X %02X %02X\n",
-            b[rowBytes+0], b[rowBytes+1], b[rowBytes+2], b[rowBytes+3],
-            b[rowBytes+4], b[rowBytes+5], b[rowBytes+6], b[rowBytes+7],
-            b[rowBytes+8], b[rowBytes+9], b[rowBytes+10], b[rowBytes+11],
-            b[rowBytes+12], b[rowBytes+13], b[rowBytes+14], b[rowBytes+15]);
-        DebugLog("  ptr+2*rowBytes: %02X %02X %02X %02X %02X %02X %02X %02X  %02X %02X %02X %02X %02X %02X %02X %02X\n",
-            b[2*rowBytes+0], b[2*rowBytes+1], b[2*rowBytes+2], b[2*rowBytes+3],
-            b[2*rowBytes+4], b[2*rowBytes+5], b[2*rowBytes+6], b[2*rowBytes+7],
-            b[2*rowBytes+8], b[2*rowBytes+9], b[2*rowBytes+10], b[2*rowBytes+11],
-            b[2*rowBytes+12], b[2*rowBytes+13], b[2*rowBytes+14], b[2*rowBytes+15]);
-
-        // Check UYVY phase: try decoding with offsets 0,1,2,3 and show first pixel RGB values
-        DebugLog("  UYVY phase check (first pixel at different offsets):\n");
-        for (int phase = 0; phase < 4; phase++)
+        TRACE(TraceLevelVerbose, "  ptr+rowBytes: %02X %02X %02X %02X %02X %02X %02X %02X  %02X %02X %02X %02X %02X %02X %02X %02X\n",
+            b[dumpPitch+0], b[dumpPitch+1], b[dumpPitch+2], b[dumpPitch+3],
+            b[dumpPitch+4], b[dumpPitch+5], b[dumpPitch+6], b[dumpPitch+7],
+            b[dumpPitch+8], b[dumpPitch+9], b[dumpPitch+10], b[dumpPitch+11],
+            b[dumpPitch+12], b[dumpPitch+13], b[dumpPitch+14], b[dumpPitch+15]);
+        TRACE(TraceLevelVerbose, "  ptr+2*rowBytes: %02X %02X %02X %02X %02X %02X %02X %02X  %02X %02X %02X %02X %02X %02X %02X %02X\n",
+            b[2*dumpPitch+0], b[2*dumpPitch+1], b[2*dumpPitch+2], b[2*dumpPitch+3],
+            b[2*dumpPitch+4], b[2*dumpPitch+5], b[2*dumpPitch+6], b[2*dumpPitch+7],
+            b[2*dumpPitch+8], b[2*dumpPitch+9], b[2*dumpPitch+10], b[2*dumpPitch+11],
+            b[2*dumpPitch+12], b[2*dumpPitch+13], b[2*dumpPitch+14], b[2*dumpPitch+15]);
+
+        // Check UYVY phase (8-bit only): try decoding with offsets 0,1,2,3 and show first pixel RGB values
+        if (pixelFormat != PixelFormat10BitYUV)
         {
-            unsigned char u = b[phase + 0];
-            unsigned char y0 = b[phase + 1];
-            unsigned char v = b[phase + 2];
-            unsigned char y1 = b[phase + 3];
-            int r = (int)(y0 + 1.402 * (v - 128));
-            int g = (int)(y0 - 0.344 * (u - 128) - 0.714 * (v - 128));
-            int bl = (int)(y0 + 1.772 * (u - 128));
-            if (r < 0) r = 0; if (r > 255) r = 255;
-            if (g < 0) g = 0; if (g > 255) g = 255;
-            if (bl < 0) bl = 0; if (bl > 255) bl = 255;
-            DebugLog("    phase %d: U=%3d Y0=%3d V=%3d Y1=%3d -> RGB(%3d,%3d,%3d)\n",
-                phase, u, y0, v, y1, r, g, bl);
+            TRACE(TraceLevelVerbose, "  UYVY phase check (first pixel at different offsets):\n");
+            for (int phase = 0; phase < 4; phase++)
+            {
+                unsigned char u = b[phase + 0];
+                unsigned char y0 = b[phase + 1];
+                unsigned char v = b[phase + 2];
+                unsigned char y1 = b[phase + 3];
+                int r = (int)(y0 + 1.402 * (v - 128));
+                int g = (int)(y0 - 0.344 * (u - 128) - 0.714 * (v - 128));
+                int bl = (int)(y0 + 1.772 * (u - 128));
+                if (r < 0) r = 0; if (r > 255) r = 255;
+                if (g < 0) g = 0; if (g > 255) g = 255;
+                if (bl < 0) bl = 0; if (bl > 255) bl = 255;
+                TRACE(TraceLevelVerbose, "    phase %d: U=%3d Y0=%3d V=%3d Y1=%3d -> RGB(%3d,%3d,%3d)\n",
+                    phase, u, y0, v, y1, r, g, bl);
+            }
         }
 
         // Detailed scan to understand buffer structure
         // The 1/4 screen shift (480 pixels = 960 bytes) suggests HANC at row start
-        DebugLog("  Detailed row scan (looking for video content and HANC boundary):\n");
+        TRACE(TraceLevelVerbose, "  Detailed row scan (looking for video content and HANC boundary):\n");
 
         // Calculate expected HANC offset for HD-SDI
-        // 1920 active pixels * 2 bytes/pixel = 3840 bytes of active video per row
-        // If rowBytes > 3840, there's horizontal blanking
-        int expectedActiveVideo = width * 2;  // 3840 for 1920 width
+        // 1920 active pixels = 3840 bytes of UYVY or 5120 bytes of v210 per row
+        // If rowBytes is larger, there's horizontal blanking
+        int expectedActiveVideo = ActiveRowBytes(g);
         int potentialHancOffset = rowBytes - expectedActiveVideo;  // Should be 0 if no HANC
-        DebugLog("    rowBytes=%d, expected active=%d, HANC offset=%d\n",
+        TRACE(TraceLevelVerbose, "    rowBytes=%d, expected active=%d, HANC offset=%d\n",
             rowBytes, expectedActiveVideo, potentialHancOffset);
 
         // Scan multiple rows, checking the entire row horizontally
@@ -498,21 +653,21 @@ DECKLINK_API int CopyDeckLinkFrameBytes(void* framePtr, void* buffer, int buffer
         for (int i = 0; i < sizeof(rowsToScan)/sizeof(rowsToScan[0]); i++)
         {
             int rowNum = rowsToScan[i];
-            int rowOffset = rowNum * rowBytes;
-            if (rowOffset + rowBytes >= bufferSize) break;
+            int rowOffset = rowNum * dumpPitch;
+            if (rowOffset + dumpPitch >= dumpSize) break;
 
             // Scan the row in 64-byte steps to find transition points
             int lastType = -1;  // -1=unknown, 0=ANC, 1=BLK, 2=VIDEO
             int transitionOffset = -1;
 
-            for (int byteOff = 0; byteOff < rowBytes - 8; byteOff += 64)
+            for (int byteOff = 0; byteOff < dumpPitch - 8; byteOff += 64)
             {
                 int off = rowOffset + byteOff;
                 unsigned char b0 = b[off], b1 = b[off+1], b2 = b[off+2], b3 = b[off+3];
 
                 int type = 2;  // default: video
-                if (b0 == 0x00 && b1 == 0x02 && b2 == 0x01 && b3 == 0x20) type = 0;  // ANC
-                else if (b0 == 0x80 && b1 == 0x10 && b2 == 0x80 && b3 == 0x10) type = 1;  // BLACK
+                if (IsBlackWord(b + off, pixelFormat)) type = 1;  // BLACK
+                else if (b0 == 0x00 && b1 == 0x02 && b2 == 0x01 && b3 == 0x20) type = 0;  // ANC
                 else if (b0 == 0x00 && b1 == 0x00 && b2 == 0x00 && b3 == 0x00) type = 0;  // zero=ANC-like
 
                 if (lastType != -1 && type != lastType && transitionOffset < 0)
@@ -526,9 +681,9 @@ DECKLINK_API int CopyDeckLinkFrameBytes(void* framePtr, void* buffer, int buffer
             int off = rowOffset;
             unsigned char* at0 = b + rowOffset;
             unsigned char* at960 = b + rowOffset + 960;
-            unsigned char* atEnd = b + rowOffset + rowBytes - 8;
+            unsigned char* atEnd = b + rowOffset + dumpPitch - 8;
 
-            DebugLog("    row%4d: @0=%02X%02X%02X%02X @960=%02X%02X%02X%02X @end=%02X%02X%02X%02X trans@%d\n",
+            TRACE(TraceLevelVerbose, "    row%4d: @0=%02X%02X%02X%02X @960=%02X%02X%02X%02X @end=%02X%02X%02X%02X trans@%d\n",
                 rowNum,
                 at0[0], at0[1], at0[2], at0[3],
                 at960[0], at960[1], at960[2], at960[3],
@@ -539,20 +694,20 @@ DECKLINK_API int CopyDeckLinkFrameBytes(void* framePtr, void* buffer, int buffer
         // Special: detailed byte-by-byte scan of row 540 to find exact video start
         if (height >= 540)
         {
-            int midRowOffset = 540 * rowBytes;
-            DebugLog("  Row 540 byte-level scan (first 1024 bytes):\n");
-            for (int byteOff = 0; byteOff < 1024 && midRowOffset + byteOff + 4 < bufferSize; byteOff += 32)
+            int midRowOffset = 540 * dumpPitch;
+            TRACE(TraceLevelVerbose, "  Row 540 byte-level scan (first 1024 bytes):\n");
+            for (int byteOff = 0; byteOff < 1024 && midRowOffset + byteOff + 4 < dumpSize; byteOff += 32)
             {
                 int off = midRowOffset + byteOff;
                 unsigned char b0 = b[off], b1 = b[off+1], b2 = b[off+2], b3 = b[off+3];
-                bool isAnc = (b0 == 0x00 && b1 == 0x02 && b2 == 0x01 && b3 == 0x20);
-                bool isBlk = (b0 == 0x80 && b1 == 0x10 && b2 == 0x80 && b3 == 0x10);
+                bool isBlk = IsBlackWord(b + off, pixelFormat);
+                bool isAnc = !isBlk && (b0 == 0x00 && b1 == 0x02 && b2 == 0x01 && b3 == 0x20);
                 bool isZero = (b0 == 0x00 && b1 == 0x00 && b2 == 0x00 && b3 == 0x00);
                 const char* type = isAnc ? "ANC" : (isBlk ? "BLK" : (isZero ? "ZER" : "???"));
                 // Only log if not black (to reduce output)
                 if (!isBlk || byteOff < 128 || byteOff > 896)
                 {
-                    DebugLog("      +%4d: %02X %02X %02X %02X [%s]\n", byteOff, b0, b1, b2, b3, type);
+                    TRACE(TraceLevelVerbose, "      +%4d: %02X %02X %02X %02X [%s]\n", byteOff, b0, b1, b2, b3, type);
                 }
             }
         }
@@ -561,13 +716,346 @@ DECKLINK_API int CopyDeckLinkFrameBytes(void* framePtr, void* buffer, int buffer
     unknown->Release();
 
     // Return 1 only if we got most of the data AND it's not corrupt BGRA
-    if (bytesCopied <= bufferSize / 2)
+    if (bytesCopied <= totalBytes / 2)
         return 0;  // Not enough data copied
     if (isCorrupt)
         return -1; // Data looks corrupt (BGRA-like), C# should use cached frame
+    if (crop != nullptr && bytesCopied < totalBytes)
+        return -2; // Black-filled holes; C# should use cached frame
     return 1;      // Good frame
 }
 
+// Try each access path in order and report which one produced the frame
+static int ProbeAndCopy(IUnknown* unknown, const FrameGeometry& g, DeckLinkCropRegion* crop,
+                        void* buffer, int bufferSize, LumaTarget* luma, int* resolvedPath)
+{
+    // SDK 15.3 IDeckLinkVideoFrame vtable (GetBytes was REMOVED in SDK 14.3):
+    //   [3]=GetWidth, [4]=GetHeight, [5]=GetRowBytes, [6]=GetPixelFormat,
+    //   [7]=GetFlags, [8]=GetTimecode, [9]=GetAncillaryData
+    // GetBytes is now only available via:
+    //   1. IDeckLinkVideoBuffer interface (QI) - GetBytes at vtable[3]
+    //   2. Legacy IDeckLinkVideoInputFrame_v14_2_1 (QI) - GetBytes at vtable[8]
+    //   3. Offset-280 fallback (raw DMA pointer, fragile)
+    *resolvedPath = DeckLinkAccessPathUnknown;
+
+    if (CopyViaVideoBuffer(unknown, g, crop, buffer, bufferSize, luma) == 1)
+    {
+        *resolvedPath = DeckLinkAccessPathVideoBuffer;
+        return 1;
+    }
+
+    if (CopyViaLegacyFrame(unknown, g, crop, buffer, bufferSize, luma) == 1)
+    {
+        *resolvedPath = DeckLinkAccessPathLegacy;
+        return 1;
+    }
+
+    int result = CopyViaOffset280(unknown, g, crop, buffer, bufferSize, luma);
+    if (result != 0)
+        *resolvedPath = DeckLinkAccessPathOffset280;
+    return result;
+}
+
+// Copy one frame without a session: validate the COM pointer, read the geometry and probe
+static int CopyFrameBytes(void* framePtr, DeckLinkCropRegion* crop, void* buffer, int bufferSize)
+{
+    if (framePtr == nullptr || buffer == nullptr || bufferSize <= 0)
+        return 0;
+
+    IUnknown* unknown = reinterpret_cast<IUnknown*>(framePtr);
+
+    // Validate the COM pointer is valid by querying IUnknown
+    IUnknown* testUnk = nullptr;
+    HRESULT hrTest = unknown->QueryInterface(IID_IUnknown, (void**)&testUnk);
+
+    static bool loggedValidation = false;
+    if (!loggedValidation)
+    {
+        TRACE(TraceLevelInfo, "[DeckLinkNative] COM validation: unknown=%p, QI(IUnknown) hr=0x%08X, ptr=%p\n", unknown, hrTest, testUnk);
+        loggedValidation = true;
+    }
+
+    if (FAILED(hrTest) || testUnk == nullptr)
+    {
+        TRACE(TraceLevelWarning, "[DeckLinkNative] Invalid COM pointer: QueryInterface(IID_IUnknown) failed hr=0x%08X\n", hrTest);
+        return 0;
+    }
+    testUnk->Release();
+
+    // Also try QI for IDeckLinkVideoFrame to verify we have the right interface
+    IUnknown* testVF = nullptr;
+    HRESULT hrVF = unknown->QueryInterface(IID_IDeckLinkVideoFrame, (void**)&testVF);
+    static bool loggedVF = false;
+    if (!loggedVF)
+    {
+        TRACE(TraceLevelInfo, "[DeckLinkNative] QI(IDeckLinkVideoFrame) hr=0x%08X, ptr=%p\n", hrVF, testVF);
+        loggedVF = true;
+    }
+    if (testVF) testVF->Release();
+
+    // Try QI for IDeckLinkVideoInputFrame (the actual type from callbacks)
+    IUnknown* testVIF = nullptr;
+    HRESULT hrVIF = unknown->QueryInterface(IID_IDeckLinkVideoInputFrame, (void**)&testVIF);
+    static bool loggedVIF = false;
+    if (!loggedVIF)
+    {
+        TRACE(TraceLevelInfo, "[DeckLinkNative] QI(IDeckLinkVideoInputFrame) hr=0x%08X, ptr=%p\n", hrVIF, testVIF);
+        loggedVIF = true;
+    }
+    if (testVIF) testVIF->Release();
+
+    FrameGeometry geometry = {};
+    if (!ReadFrameGeometry(unknown, &geometry))
+        return 0;
+
+    int resolvedPath = DeckLinkAccessPathUnknown;
+    return ProbeAndCopy(unknown, geometry, crop, buffer, bufferSize, nullptr, &resolvedPath);
+}
+
+// Copy one frame through a session. requestedCrop may be null for a whole-frame copy,
+// luma null when no analysis plane is wanted.
+static int CopySessionFrame(DeckLinkCaptureSession* session, void* framePtr, const DeckLinkCropRegion* requestedCrop,
+                            void* buffer, int bufferSize, LumaTarget* luma)
+{
+    if (framePtr == nullptr || buffer == nullptr || bufferSize <= 0)
+        return 0;
+
+    IUnknown* unknown = reinterpret_cast<IUnknown*>(framePtr);
+
+    // A new crop request starts over, including VANC detection and the geometry its frame
+    // size was checked against
+    if (requestedCrop != nullptr &&
+        (!session->hasCrop || memcmp(requestedCrop, &session->requestedCrop, sizeof(DeckLinkCropRegion)) != 0))
+    {
+        session->requestedCrop = *requestedCrop;
+        session->crop = *requestedCrop;
+        session->hasCrop = true;
+        session->geometry = {};
+        session->hasGeometry = false;
+    }
+
+    // Geometry is re-read only after a reset or when the caller's frame size
+    // no longer matches (signal format changed without an explicit reset)
+    const FrameGeometry& cached = session->geometry;
+    long expectedSize = requestedCrop != nullptr
+        ? CropRowBytes(cached, session->crop) * cached.height
+        : cached.rowBytes * cached.height;
+    if (!session->hasGeometry || expectedSize != bufferSize)
+    {
+        if (!ReadFrameGeometry(unknown, &session->geometry))
+        {
+            session->hasGeometry = false;
+            return 0;
+        }
+        session->hasGeometry = true;
+        session->crop.skipRows = session->requestedCrop.skipRows;
+    }
+
+    const FrameGeometry& g = session->geometry;
+    DeckLinkCropRegion* crop = requestedCrop != nullptr ? &session->crop : nullptr;
+    int result = 0;
+
+    switch (session->accessPath)
+    {
+    case DeckLinkAccessPathVideoBuffer:
+        result = CopyViaVideoBuffer(unknown, g, crop, buffer, bufferSize, luma);
+        break;
+    case DeckLinkAccessPathLegacy:
+        result = CopyViaLegacyFrame(unknown, g, crop, buffer, bufferSize, luma);
+        break;
+    case DeckLinkAccessPathOffset280:
+        result = CopyViaOffset280(unknown, g, crop, buffer, bufferSize, luma);
+        break;
+    default:
+        break;
+    }
+
+    if (result != 0)
+        return result;
+
+    // Cached path failed (or not resolved yet) - probe all paths again
+    int resolvedPath = DeckLinkAccessPathUnknown;
+    result = ProbeAndCopy(unknown, g, crop, buffer, bufferSize, luma, &resolvedPath);
+
+    if (resolvedPath != session->accessPath)
+    {
+        TRACE(TraceLevelInfo, "[DeckLinkNative] Session %p access path: %s -> %s (%dx%d, rowBytes=%d)\n",
+            session, AccessPathName(session->accessPath), AccessPathName(resolvedPath),
+            g.width, g.height, g.rowBytes);
+        if (session->accessPath != DeckLinkAccessPathUnknown)
+            session->stats.accessPathChanges++;
+        session->accessPath = resolvedPath;
+    }
+
+    // Nothing could be copied: the cached geometry may be what is wrong, so the next frame
+    // reads it again instead of matching a stale rowBytes against the caller's size
+    if (result == 0)
+    {
+        session->geometry = {};
+        session->hasGeometry = false;
+    }
+
+    return result;
+}
+
+// Time a session copy and fold the outcome into the session's stats
+static int CopySessionFrameTimed(DeckLinkCaptureSession* session, void* framePtr, const DeckLinkCropRegion* crop,
+                                 void* buffer, int bufferSize, LumaTarget* luma)
+{
+    LARGE_INTEGER start, end;
+    QueryPerformanceCounter(&start);
+    int result = CopySessionFrame(session, framePtr, crop, buffer, bufferSize, luma);
+    QueryPerformanceCounter(&end);
+
+    RecordCopy(session, result, bufferSize, start.QuadPart, end.QuadPart);
+    return result;
+}
+
+extern "C" {
+
+DECKLINK_API int CopyDeckLinkFrameBytes(void* framePtr, void* buffer, int bufferSize)
+{
+    return CopyFrameBytes(framePtr, nullptr, buffer, bufferSize);
+}
+
+DECKLINK_API void* CreateDeckLinkCaptureSession()
+{
+    DeckLinkCaptureSession* session = new (std::nothrow) DeckLinkCaptureSession();
+    if (session == nullptr)
+        return nullptr;
+
+    session->accessPath = DeckLinkAccessPathUnknown;
+    session->hasGeometry = false;
+    session->hasCrop = false;
+    TRACE(TraceLevelInfo, "[DeckLinkNative] Created capture session %p\n", session);
+    return session;
+}
+
+DECKLINK_API void ResetDeckLinkCaptureSession(void* sessionPtr)
+{
+    DeckLinkCaptureSession* session = reinterpret_cast<DeckLinkCaptureSession*>(sessionPtr);
+    if (session == nullptr)
+        return;
+
+    session->accessPath = DeckLinkAccessPathUnknown;
+    session->hasGeometry = false;
+    session->hasCrop = false;
+}
+
+DECKLINK_API void DestroyDeckLinkCaptureSession(void* sessionPtr)
+{
+    delete reinterpret_cast<DeckLinkCaptureSession*>(sessionPtr);
+}
+
+DECKLINK_API int CopyDeckLinkSessionFrame(void* sessionPtr, void* framePtr, void* buffer, int bufferSize)
+{
+    DeckLinkCaptureSession* session = reinterpret_cast<DeckLinkCaptureSession*>(sessionPtr);
+    if (session == nullptr)
+        return CopyDeckLinkFrameBytes(framePtr, buffer, bufferSize);
+
+    return CopySessionFrameTimed(session, framePtr, nullptr, buffer, bufferSize, nullptr);
+}
+
+DECKLINK_API int CopyDeckLinkSessionFrameCropped(void* sessionPtr, void* framePtr, const DeckLinkCropRegion* crop,
+                                                 void* buffer, int bufferSize)
+{
+    if (crop == nullptr)
+        return CopyDeckLinkSessionFrame(sessionPtr, framePtr, buffer, bufferSize);
+
+    DeckLinkCaptureSession* session = reinterpret_cast<DeckLinkCaptureSession*>(sessionPtr);
+    if (session == nullptr)
+    {
+        // Without a session VANC detection runs on every frame
+        DeckLinkCropRegion frameCrop = *crop;
+        return CopyFrameBytes(framePtr, &frameCrop, buffer, bufferSize);
+    }
+
+    return CopySessionFrameTimed(session, framePtr, crop, buffer, bufferSize, nullptr);
+}
+
+DECKLINK_API int CopyDeckLinkSessionFrameWithLuma(void* sessionPtr, void* framePtr, const DeckLinkCropRegion* crop,
+                                                  void* buffer, int bufferSize,
+                                                  void* luma, int lumaWidth, int lumaHeight, int* lumaWritten)
+{
+    if (lumaWritten != nullptr)
+        *lumaWritten = 0;
+
+    DeckLinkCaptureSession* session = reinterpret_cast<DeckLinkCaptureSession*>(sessionPtr);
+    if (session == nullptr || luma == nullptr || lumaWidth <= 0 || lumaHeight <= 0 || lumaWritten == nullptr)
+        return CopyDeckLinkSessionFrameCropped(sessionPtr, framePtr, crop, buffer, bufferSize);
+
+    LumaTarget target = { (unsigned char*)luma, lumaWidth, lumaHeight, false };
+    int result = CopySessionFrameTimed(session, framePtr, crop, buffer, bufferSize, &target);
+
+    // Fallback copies (chunked Offset280, black-filled holes) do not sample luma
+    *lumaWritten = result == 1 && target.written ? 1 : 0;
+    return result;
+}
+
+DECKLINK_API void MarkDeckLinkSessionCallback(void* sessionPtr, long long timestamp)
+{
+    DeckLinkCaptureSession* session = reinterpret_cast<DeckLinkCaptureSession*>(sessionPtr);
+    if (session == nullptr)
+        return;
+
+    if (session->lastCallbackTime != 0)
+        RecordLatency(&session->stats.frameInterval, timestamp - session->lastCallbackTime);
+    session->lastCallbackTime = timestamp;
+    session->callbackTime = timestamp;
+}
+
+DECKLINK_API int GetDeckLinkCaptureStats(void* sessionPtr, DeckLinkCaptureStats* stats, int statsSize)
+{
+    DeckLinkCaptureSession* session = reinterpret_cast<DeckLinkCaptureSession*>(sessionPtr);
+    if (session == nullptr || stats == nullptr || statsSize != (int)sizeof(DeckLinkCaptureStats))
+        return 0;
+
+    // Counters are written by the capture thread without locking; a snapshot taken
+    // mid-frame can be off by one frame between fields, which is fine for monitoring
+    memcpy(stats, &session->stats, sizeof(DeckLinkCaptureStats));
+    stats->accessPath = session->accessPath;
+    return 1;
+}
+
+DECKLINK_API void ResetDeckLinkCaptureStats(void* sessionPtr)
+{
+    DeckLinkCaptureSession* session = reinterpret_cast<DeckLinkCaptureSession*>(sessionPtr);
+    if (session == nullptr)
+        return;
+
+    memset(&session->stats, 0, sizeof(DeckLinkCaptureStats));
+    session->lastCallbackTime = 0;
+}
+
+DECKLINK_API int GetDeckLinkSessionAccessPath(void* sessionPtr)
+{
+    DeckLinkCaptureSession* session = reinterpret_cast<DeckLinkCaptureSession*>(sessionPtr);
+    return session != nullptr ? session->accessPath : DeckLinkAccessPathUnknown;
+}
+
+DECKLINK_API int SetDeckLinkCopyThreads(int threadCount, unsigned long long affinityMask)
+{
+    int workers = FrameCopyConfigurePool(threadCount, affinityMask);
+    TRACE(TraceLevelInfo, "[DeckLinkNative] Copy pool: requested %d threads, %d workers running, kernel=%d\n",
+        threadCount, workers, GetSimdLevel());
+    return workers;
+}
+
+DECKLINK_API int GetDeckLinkCopyKernel()
+{
+    return GetSimdLevel();
+}
+
+DECKLINK_API int ReadDeckLinkTrace(char* buffer, int bufferSize)
+{
+    return TraceDrain(buffer, bufferSize);
+}
+
+DECKLINK_API long long GetDeckLinkTraceDropped()
+{
+    return TraceDroppedCount();
+}
+
 DECKLINK_API int GetDeckLinkFrameInfo(void* framePtr, int* width, int* height, int* rowBytes, unsigned int* flags)
 {
     if (framePtr == nullptr)
@@ -593,4 +1081,55 @@ DECKLINK_API int GetDeckLinkFrameInfo(void* framePtr, int* width, int* height, i
     }
 }
 
+DECKLINK_API int CopyDeckLinkAudioPacket(void* packetPtr, int bytesPerSampleFrame, void* dst, int dstSize,
+                                         void* dstWrap, int dstWrapSize, long long* packetTime)
+{
+    if (packetTime) *packetTime = 0;
+    if (packetPtr == nullptr || bytesPerSampleFrame <= 0 || dstSize < 0 || dstWrapSize < 0 ||
+        (dst == nullptr && dstSize > 0) || (dstWrap == nullptr && dstWrapSize > 0))
+        return -1;
+
+    IUnknown* unknown = reinterpret_cast<IUnknown*>(packetPtr);
+    void** vtable = *(void***)unknown;
+
+    // IDeckLinkAudioInputPacket vtable: [0-2]=IUnknown, [3]=GetSampleFrameCount,
+    // [4]=GetBytes, [5]=GetPacketTime
+    typedef long (STDMETHODCALLTYPE *GetSampleFrameCountFunc)(void* pThis);
+    typedef HRESULT (STDMETHODCALLTYPE *GetBytesFunc)(void* pThis, void** buffer);
+    typedef HRESULT (STDMETHODCALLTYPE *GetPacketTimeFunc)(void* pThis, long long* packetTime, long long timeScale);
+
+    __try
+    {
+        long frames = ((GetSampleFrameCountFunc)vtable[3])(unknown);
+        void* src = nullptr;
+        HRESULT hr = ((GetBytesFunc)vtable[4])(unknown, &src);
+
+        long long time = 0;
+        if (packetTime && SUCCEEDED(((GetPacketTimeFunc)vtable[5])(unknown, &time, 10000000)))
+            *packetTime = time;
+
+        if (frames <= 0)
+            return 0;
+        if (FAILED(hr) || src == nullptr)
+            return -1;
+
+        long long size = (long long)frames * bytesPerSampleFrame;
+        if (size > (long long)dstSize + dstWrapSize)
+            return -2;
+
+        // The whole packet goes in one pass straight from the driver's buffer
+        int first = size < dstSize ? (int)size : dstSize;
+        if (first > 0)
+            memcpy(dst, src, first);
+        if (size > first)
+            memcpy(dstWrap, (const unsigned char*)src + first, (size_t)(size - first));
+        return (int)frames;
+    }
+    __except(EXCEPTION_EXECUTE_HANDLER)
+    {
+        TRACE(TraceLevelWarning, "[DeckLinkNative] Exception reading audio packet\n");
+        return -1;
+    }
+}
+
 }
@@ -6,10 +6,60 @@
 #define DECKLINK_API __declspec(dllimport)
 #endif
 
+// Buffer access path resolved for a capture session
+enum DeckLinkAccessPath
+{
+    DeckLinkAccessPathUnknown = 0,
+    DeckLinkAccessPathVideoBuffer = 1,  // IDeckLinkVideoBuffer::GetBytes (SDK 15.3)
+    DeckLinkAccessPathLegacy = 2,       // IDeckLinkVideoInputFrame_v14_2_1::GetBytes
+    DeckLinkAccessPathOffset280 = 3     // Raw DMA pointer at object offset 280
+};
+
+// Active picture region of a captured frame. Rows above it (VANC) and bytes before it
+// in each row (HANC) are skipped during the DMA copy, and the destination is tightly
+// packed: height rows of rowBytes. The picture moves up by skipRows and the rows left
+// over at the bottom are filled with black, so the destination size stays rowBytes * height.
+struct DeckLinkCropRegion
+{
+    int skipRows;   // rows to skip at the top; -1 = detect VANC rows on the session's first frame
+    int skipBytes;  // bytes to skip at the start of each source row
+    int rowBytes;   // active bytes per row (destination pitch); 0 = rest of the source row
+};
+
+// Latency histograms use power-of-two microsecond buckets: bucket 0 counts samples
+// under 16 us, bucket i counts [16 << (i-1), 16 << i) us, the last bucket everything above
+#define DECKLINK_LATENCY_BUCKETS 16
+
+struct DeckLinkLatencyHistogram
+{
+    unsigned long long buckets[DECKLINK_LATENCY_BUCKETS];
+    unsigned long long count;
+    unsigned long long totalUs;
+    unsigned long long maxUs;
+};
+
+// Per-session capture counters, updated by the capture thread on every frame
+struct DeckLinkCaptureStats
+{
+    unsigned long long framesGood;          // copies that returned 1
+    unsigned long long framesFailed;        // copies that returned 0
+    unsigned long long framesCorrupt;       // copies that returned -1
+    unsigned long long framesPartial;       // copies that returned -2
+    unsigned long long bytesCopied;         // bytes delivered by good copies
+    unsigned long long framesByPath[4];     // good copies per DeckLinkAccessPath
+    unsigned long long accessPathChanges;
+    int accessPath;                         // DeckLinkAccessPath currently cached
+    int reserved;
+    DeckLinkLatencyHistogram callbackToCopy; // MarkDeckLinkSessionCallback -> copy start
+    DeckLinkLatencyHistogram copy;           // copy start -> copy end
+    DeckLinkLatencyHistogram frameInterval;  // callback -> next callback
+};
+
 extern "C" {
     // Copy frame bytes from a DeckLink video input frame
     // framePtr: Raw COM interface pointer to IDeckLinkVideoInputFrame
-    // buffer: Destination buffer
+    // buffer: Destination buffer. May be a pinned managed array (ring buffer slot);
+    //         the DMA buffer is copied straight into it with no intermediate staging copy.
     // bufferSize: Size of data to copy
     // Returns: 1 if successful, 0 otherwise
     DECKLINK_API int CopyDeckLinkFrameBytes(void* framePtr, void* buffer, int bufferSize);
@@ -17,4 +67,78 @@ extern "C" {
     // Get frame information
     // Returns: 1 if successful, 0 otherwise
     DECKLINK_API int GetDeckLinkFrameInfo(void* framePtr, int* width, int* height, int* rowBytes, unsigned int* flags);
+
+    // Copy the samples of a DeckLink audio input packet into a ring buffer's free space,
+    // which may wrap: dst receives the first dstSize bytes and dstWrap the rest.
+    // packetPtr: Raw COM interface pointer to IDeckLinkAudioInputPacket
+    // bytesPerSampleFrame: channels * bytes per sample, as enabled on the input
+    // packetTime: receives the packet's stream time in 100 ns units (may be null)
+    // Returns: sample frames copied (0 for an empty packet), -1 if the packet could not be
+    //          read, -2 if the packet does not fit (nothing is copied; *packetTime is still set)
+    DECKLINK_API int CopyDeckLinkAudioPacket(void* packetPtr, int bytesPerSampleFrame, void* dst, int dstSize,
+                                             void* dstWrap, int dstWrapSize, long long* packetTime);
+
+    // Create a per-input capture session. The session remembers which buffer-access
+    // path worked and the frame geometry, so per-frame copies skip the probing QIs.
+    // Returns: opaque session handle, or nullptr on allocation failure
+    DECKLINK_API void* CreateDeckLinkCaptureSession();
+
+    // Forget the cached access path and geometry (call after a signal format change)
+    DECKLINK_API void ResetDeckLinkCaptureSession(void* session);
+
+    // Destroy a session created by CreateDeckLinkCaptureSession
+    DECKLINK_API void DestroyDeckLinkCaptureSession(void* session);
+
+    // Copy frame bytes using the session's cached access path, re-probing only if it fails
+    // Returns: same values as CopyDeckLinkFrameBytes (1 = good, 0 = failed, -1 = corrupt)
+    DECKLINK_API int CopyDeckLinkSessionFrame(void* session, void* framePtr, void* buffer, int bufferSize);
+
+    // Copy only the active region of the frame into a tightly packed buffer.
+    // bufferSize must be the cropped size (active rowBytes * frame height).
+    // VANC rows detected for skipRows = -1 are cached until the session is reset.
+    // Returns: 1 = good, 0 = failed, -1 = corrupt, -2 = partial copy (part of the source
+    //          was unreadable and is filled with black; the frame should not be shown)
+    DECKLINK_API int CopyDeckLinkSessionFrameCropped(void* session, void* framePtr, const DeckLinkCropRegion* crop,
+                                                     void* buffer, int bufferSize);
+
+    // Same as CopyDeckLinkSessionFrameCropped (crop may be null for a whole-frame copy), and
+    // also writes the auto-cut detectors' lumaWidth x lumaHeight 8-bit luma plane (same sampling
+    // as ExtractLumaSad on the destination) while the source rows are still in cache.
+    // *lumaWritten is 1 when the plane holds this frame's luma; fallback copies leave it 0,
+    // and the caller extracts luma from the buffer instead.
+    DECKLINK_API int CopyDeckLinkSessionFrameWithLuma(void* session, void* framePtr, const DeckLinkCropRegion* crop,
+                                                      void* buffer, int bufferSize,
+                                                      void* luma, int lumaWidth, int lumaHeight, int* lumaWritten);
+
+    // Record the QueryPerformanceCounter time at which the frame callback was entered.
+    // Call before the session copy so the callback-to-copy and frame-interval histograms fill in.
+    DECKLINK_API void MarkDeckLinkSessionCallback(void* session, long long timestamp);
+
+    // Snapshot the session's counters. statsSize must be sizeof(DeckLinkCaptureStats).
+    // Returns: 1 if successful, 0 otherwise
+    DECKLINK_API int GetDeckLinkCaptureStats(void* session, DeckLinkCaptureStats* stats, int statsSize);
+
+    // Zero the session's counters and histograms
+    DECKLINK_API void ResetDeckLinkCaptureStats(void* session);
+
+    // Returns: DeckLinkAccessPath currently cached by the session
+    DECKLINK_API int GetDeckLinkSessionAccessPath(void* session);
+
+    // Split large (UHD) frame copies across a small pool of copy threads.
+    // threadCount: total threads per copy including the caller (<= 1 disables the pool)
+    // affinityMask: if non-zero, pool threads are pinned to the set bits in order
+    // Returns: number of worker threads running
+    DECKLINK_API int SetDeckLinkCopyThreads(int threadCount, unsigned long long affinityMask);
+
+    // Returns: SIMD level of the copy kernel (0=memcpy, 1=SSE4.1, 2=AVX2, 3=AVX-512)
+    DECKLINK_API int GetDeckLinkCopyKernel();
+
+    // Drain the native trace into buffer as '\n'-terminated lines of
+    // "<level> <microseconds> <threadId> <message>" (level 1=error, 2=warning, 3=info, 4=verbose).
+    // Messages are held in per-thread lock-free rings until drained; poll regularly.
+    // Returns: bytes written (0 when there is nothing pending)
+    DECKLINK_API int ReadDeckLinkTrace(char* buffer, int bufferSize);
+
+    // Returns: trace messages dropped because a ring was full
+    DECKLINK_API long long GetDeckLinkTraceDropped();
 }
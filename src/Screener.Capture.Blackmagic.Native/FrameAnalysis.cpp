@@ -0,0 +1,230 @@
+#define DECKLINK_NATIVE_EXPORTS
+#include "MediaKernels.h"
+#include "FrameAnalysis.h"
+#include "CpuFeatures.h"
+
+#include <immintrin.h>
+#include <stdint.h>
+#include <string.h>
+
+// Studio-range black, for rows the copy black-filled
+static const unsigned char LumaBlack = 16;
+
+// Where each output column's luma sample lives within a source row: the byte offset of
+// the 32-bit word holding it and the shift that brings it to bit 0.
+// UYVY: word = the U Y V Y group, Y at bits 8 (even pixel) or 24 (odd pixel).
+// v210: word = one of the four words of the 6-pixel group, Y at bits 0, 10 or 20.
+static void ComputeLumaColumns(int* offsets, int* shifts, int srcWidth, int dstWidth, int format)
+{
+    for (int dx = 0; dx < dstWidth; dx++)
+    {
+        int srcCol = (int)((long long)dx * srcWidth / dstWidth);
+
+        if (format == LumaFormatV210)
+        {
+            int sample = (srcCol % 6) * 2 + 1;
+            offsets[dx] = (srcCol / 6) * 16 + (sample / 3) * 4;
+            shifts[dx] = 10 * (sample % 3);
+        }
+        else
+        {
+            offsets[dx] = (srcCol / 2) * 4;
+            shifts[dx] = (srcCol & 1) ? 24 : 8;
+        }
+    }
+}
+
+// 10-bit luma rounded to 8 bits, matching FrameAnalyzer.ExtractLumaDownsampledV210
+static inline unsigned char NarrowLuma10(uint32_t y10)
+{
+    uint32_t y8 = (y10 + 2) >> 2;
+    return (unsigned char)(y8 > 255 ? 255 : y8);
+}
+
+static void LumaRowScalar(const unsigned char* row, const int* offsets, const int* shifts,
+                          unsigned char* dst, int count, int format)
+{
+    for (int dx = 0; dx < count; dx++)
+    {
+        uint32_t word = *(const uint32_t*)(row + offsets[dx]);
+        if (format == LumaFormatV210)
+            dst[dx] = NarrowLuma10((word >> shifts[dx]) & 0x3FF);
+        else
+            dst[dx] = (unsigned char)(word >> shifts[dx]);
+    }
+}
+
+// Eight columns per iteration: gather the words, shift each lane's sample down, narrow to bytes
+static void LumaRowAvx2(const unsigned char* row, const int* offsets, const int* shifts,
+                        unsigned char* dst, int count, int format)
+{
+    const bool v210 = format == LumaFormatV210;
+    const __m256i mask = _mm256_set1_epi32(v210 ? 0x3FF : 0xFF);
+    const __m256i round = _mm256_set1_epi32(2);
+    const __m256i max8 = _mm256_set1_epi32(255);
+
+    int dx = 0;
+    for (; dx + 8 <= count; dx += 8)
+    {
+        __m256i index = _mm256_loadu_si256((const __m256i*)(offsets + dx));
+        __m256i shift = _mm256_loadu_si256((const __m256i*)(shifts + dx));
+        __m256i words = _mm256_i32gather_epi32((const int*)row, index, 1);
+        __m256i y = _mm256_and_si256(_mm256_srlv_epi32(words, shift), mask);
+        if (v210)
+            y = _mm256_min_epi32(_mm256_srli_epi32(_mm256_add_epi32(y, round), 2), max8);
+
+        // 32 -> 16 -> 8 bits; each 128-bit lane ends up with its four bytes in the low dword
+        // dst is a byte pointer with no alignment guarantee, so the dwords go through memcpy
+        __m256i packed = _mm256_packus_epi16(_mm256_packus_epi32(y, y), _mm256_setzero_si256());
+        uint32_t lo = (uint32_t)_mm_cvtsi128_si32(_mm256_castsi256_si128(packed));
+        uint32_t hi = (uint32_t)_mm_cvtsi128_si32(_mm256_extracti128_si256(packed, 1));
+        memcpy(dst + dx, &lo, sizeof(lo));
+        memcpy(dst + dx + 4, &hi, sizeof(hi));
+    }
+
+    LumaRowScalar(row, offsets + dx, shifts + dx, dst + dx, count - dx, format);
+}
+
+// Sum of |a - b| over count bytes (PSADBW / VPSADBW)
+static long long SadRowSse2(const unsigned char* a, const unsigned char* b, int count)
+{
+    __m128i acc = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(va, vb));
+    }
+
+    long long sum = _mm_cvtsi128_si64(acc) + _mm_cvtsi128_si64(_mm_unpackhi_epi64(acc, acc));
+    for (; i < count; i++)
+        sum += a[i] > b[i] ? a[i] - b[i] : b[i] - a[i];
+    return sum;
+}
+
+static long long SadRowAvx2(const unsigned char* a, const unsigned char* b, int count)
+{
+    __m256i acc = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 32 <= count; i += 32)
+    {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(va, vb));
+    }
+
+    __m128i acc128 = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    long long sum = _mm_cvtsi128_si64(acc128) + _mm_cvtsi128_si64(_mm_unpackhi_epi64(acc128, acc128));
+    return sum + SadRowSse2(a + i, b + i, count - i);
+}
+
+static inline long long SadRow(const unsigned char* a, const unsigned char* b, int count, bool avx2)
+{
+    return avx2 ? SadRowAvx2(a, b, count) : SadRowSse2(a, b, count);
+}
+
+static bool ValidRoi(int width, int height, int roiLeft, int roiTop, int roiRight, int roiBottom)
+{
+    return roiLeft >= 0 && roiTop >= 0 && roiRight <= width && roiBottom <= height;
+}
+
+// Extract the luma plane row by row; with a reference, fold each row's ROI difference in
+// while the row is still in L1. Arguments are validated by the callers.
+static long long ExtractLumaRows(const unsigned char* src, size_t srcPitch, int srcWidth, int srcHeight, int validRows,
+                                 int format, unsigned char* dst, int dstWidth, int dstHeight,
+                                 const unsigned char* ref, int roiLeft, int roiTop, int roiRight, int roiBottom)
+{
+    alignas(32) int offsets[MaxLumaWidth];
+    alignas(32) int shifts[MaxLumaWidth];
+    ComputeLumaColumns(offsets, shifts, srcWidth, dstWidth, format);
+
+    const bool avx2 = GetSimdLevel() >= SimdLevelAvx2;
+    long long total = 0;
+
+    for (int dy = 0; dy < dstHeight; dy++)
+    {
+        int srcRow = (int)((long long)dy * srcHeight / dstHeight);
+        unsigned char* dstRow = dst + (size_t)dy * dstWidth;
+
+        if (srcRow >= validRows)
+            memset(dstRow, LumaBlack, dstWidth);
+        else if (avx2)
+            LumaRowAvx2(src + (size_t)srcRow * srcPitch, offsets, shifts, dstRow, dstWidth, format);
+        else
+            LumaRowScalar(src + (size_t)srcRow * srcPitch, offsets, shifts, dstRow, dstWidth, format);
+
+        if (ref != nullptr && dy >= roiTop && dy < roiBottom && roiRight > roiLeft)
+            total += SadRow(dstRow + roiLeft, ref + (size_t)dy * dstWidth + roiLeft, roiRight - roiLeft, avx2);
+    }
+
+    if (avx2)
+        _mm256_zeroupper();
+    return total;
+}
+
+bool ExtractLumaPlane(const unsigned char* src, size_t srcPitch, int srcWidth, int srcHeight, int validRows,
+                      int format, unsigned char* dst, int dstWidth, int dstHeight)
+{
+    if (dstWidth <= 0 || dstWidth > MaxLumaWidth || dstHeight <= 0 || srcWidth < 2 || srcHeight <= 0)
+        return false;
+
+    ExtractLumaRows(src, srcPitch, srcWidth, srcHeight, validRows, format, dst, dstWidth, dstHeight,
+                    nullptr, 0, 0, 0, 0);
+    return true;
+}
+
+extern "C" {
+
+MEDIA_KERNELS_API int ExtractLumaSad(const void* src, int srcBufferSize, int srcPitch,
+                                     int srcWidth, int srcHeight, int format,
+                                     void* dstLuma, int dstWidth, int dstHeight,
+                                     const void* reference, int roiLeft, int roiTop, int roiRight, int roiBottom,
+                                     long long* sad)
+{
+    if (src == nullptr || dstLuma == nullptr || srcWidth < 2 || srcHeight <= 0 ||
+        dstWidth <= 0 || dstWidth > MaxLumaWidth || dstHeight <= 0 ||
+        (format != LumaFormatUyvy && format != LumaFormatV210))
+        return -1;
+
+    int rowBytes = format == LumaFormatV210 ? ((srcWidth + 47) / 48) * 128 : ((srcWidth + 1) / 2) * 4;
+    if (srcPitch < rowBytes || (long long)srcPitch * (srcHeight - 1) + rowBytes > srcBufferSize)
+        return -1;
+    if (reference != nullptr && (sad == nullptr || !ValidRoi(dstWidth, dstHeight, roiLeft, roiTop, roiRight, roiBottom)))
+        return -1;
+
+    long long total = ExtractLumaRows((const unsigned char*)src, srcPitch, srcWidth, srcHeight, srcHeight,
+                                      format, (unsigned char*)dstLuma, dstWidth, dstHeight,
+                                      (const unsigned char*)reference, roiLeft, roiTop, roiRight, roiBottom);
+
+    if (sad != nullptr)
+        *sad = total;
+    return 0;
+}
+
+MEDIA_KERNELS_API int ComputeLumaSad(const void* a, const void* b, int width, int height,
+                                     int roiLeft, int roiTop, int roiRight, int roiBottom, long long* sad)
+{
+    if (a == nullptr || b == nullptr || sad == nullptr || width <= 0 || height <= 0 ||
+        !ValidRoi(width, height, roiLeft, roiTop, roiRight, roiBottom))
+        return -1;
+
+    const bool avx2 = GetSimdLevel() >= SimdLevelAvx2;
+    const unsigned char* pa = (const unsigned char*)a;
+    const unsigned char* pb = (const unsigned char*)b;
+    long long total = 0;
+
+    if (roiRight > roiLeft)
+    {
+        for (int y = roiTop; y < roiBottom; y++)
+            total += SadRow(pa + (size_t)y * width + roiLeft, pb + (size_t)y * width + roiLeft, roiRight - roiLeft, avx2);
+    }
+
+    if (avx2)
+        _mm256_zeroupper();
+
+    *sad = total;
+    return 0;
+}
+
+}
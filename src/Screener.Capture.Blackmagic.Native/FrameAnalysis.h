@@ -0,0 +1,15 @@
+#pragma once
+
+#include <stddef.h>
+
+// Widest luma plane the extractor accepts (the column tables live on the stack)
+static const int MaxLumaWidth = 1920;
+
+// Sample a tightly packed dstWidth x dstHeight 8-bit luma plane from a UYVY or v210
+// (LumaFormat) frame, nearest-neighbour, exactly as the ExtractLumaSad export does.
+// Source rows at or past validRows are taken as black (luma 16), matching a copy whose
+// bottom rows were black-filled after cropping VANC. The caller validates the geometry
+// and, for DMA sources, wraps the call in __try.
+// Returns false if dstWidth is out of range.
+bool ExtractLumaPlane(const unsigned char* src, size_t srcPitch, int srcWidth, int srcHeight, int validRows,
+                      int format, unsigned char* dst, int dstWidth, int dstHeight);
@@ -0,0 +1,194 @@
+#define DECKLINK_NATIVE_EXPORTS
+#include "MediaKernels.h"
+#include "CpuFeatures.h"
+
+#include <immintrin.h>
+#include <stdint.h>
+
+// out = (x * (256 - w) + y * w) >> 8 on every byte. With weights summing to 256 each term
+// fits in 16 bits (255 * 256), so the vector paths widen to u16, multiply, add and narrow.
+// Pattern: y is a repeating 4-byte value instead of a second frame (fade to black).
+
+template <bool Pattern>
+static inline unsigned char BlendByte(const unsigned char* x, const unsigned char* y, uint32_t pattern,
+                                      int i, int wx, int wy)
+{
+    int yv = Pattern ? (int)((pattern >> (8 * (i & 3))) & 0xFF) : y[i];
+    return (unsigned char)((x[i] * wx + yv * wy) >> 8);
+}
+
+template <bool Pattern>
+static void BlendScalar(const unsigned char* x, const unsigned char* y, uint32_t pattern,
+                        unsigned char* dst, int start, int length, int wx, int wy)
+{
+    for (int i = start; i < length; i++)
+        dst[i] = BlendByte<Pattern>(x, y, pattern, i, wx, wy);
+}
+
+template <bool Pattern>
+static int BlendSse2(const unsigned char* x, const unsigned char* y, uint32_t pattern,
+                     unsigned char* dst, int length, int wx, int wy)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i vwx = _mm_set1_epi16((short)wx);
+    const __m128i vwy = _mm_set1_epi16((short)wy);
+    const __m128i vpattern = _mm_set1_epi32((int)pattern);
+
+    int i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+        __m128i vx = _mm_loadu_si128((const __m128i*)(x + i));
+        __m128i vy = Pattern ? vpattern : _mm_loadu_si128((const __m128i*)(y + i));
+
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(vx, zero), vwx),
+                                   _mm_mullo_epi16(_mm_unpacklo_epi8(vy, zero), vwy));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(vx, zero), vwx),
+                                   _mm_mullo_epi16(_mm_unpackhi_epi8(vy, zero), vwy));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8)));
+    }
+    return i;
+}
+
+template <bool Pattern>
+static int BlendAvx2(const unsigned char* x, const unsigned char* y, uint32_t pattern,
+                     unsigned char* dst, int length, int wx, int wy)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i vwx = _mm256_set1_epi16((short)wx);
+    const __m256i vwy = _mm256_set1_epi16((short)wy);
+    const __m256i vpattern = _mm256_set1_epi32((int)pattern);
+
+    // unpack and packus both work within 128-bit lanes, so byte order is preserved
+    int i = 0;
+    for (; i + 32 <= length; i += 32)
+    {
+        __m256i vx = _mm256_loadu_si256((const __m256i*)(x + i));
+        __m256i vy = Pattern ? vpattern : _mm256_loadu_si256((const __m256i*)(y + i));
+
+        __m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(vx, zero), vwx),
+                                      _mm256_mullo_epi16(_mm256_unpacklo_epi8(vy, zero), vwy));
+        __m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(vx, zero), vwx),
+                                      _mm256_mullo_epi16(_mm256_unpackhi_epi8(vy, zero), vwy));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_packus_epi16(_mm256_srli_epi16(lo, 8), _mm256_srli_epi16(hi, 8)));
+    }
+
+    _mm256_zeroupper();
+    return i;
+}
+
+template <bool Pattern>
+static void Blend(const unsigned char* x, const unsigned char* y, uint32_t pattern,
+                  unsigned char* dst, int length, int weight)
+{
+    int wy = weight;
+    int wx = 256 - weight;
+
+    int done = GetSimdLevel() >= SimdLevelAvx2
+        ? BlendAvx2<Pattern>(x, y, pattern, dst, length, wx, wy)
+        : BlendSse2<Pattern>(x, y, pattern, dst, length, wx, wy);
+    BlendScalar<Pattern>(x, y, pattern, dst, done, length, wx, wy);
+}
+
+// Premultiplied layer: out = sat(((x * ia') >> 8) + c), with ia' = ia + (ia >> 7) mapping the
+// stored inverse alpha 0..255 onto 0..256 so a transparent byte (ia = 255) keeps x exactly.
+
+static void CompositeRowScalar(unsigned char* dst, const unsigned char* color, const unsigned char* ia,
+                               int start, int length)
+{
+    for (int i = start; i < length; i++)
+    {
+        int v = ((dst[i] * (ia[i] + (ia[i] >> 7))) >> 8) + color[i];
+        dst[i] = (unsigned char)(v > 255 ? 255 : v);
+    }
+}
+
+static int CompositeRowSse2(unsigned char* dst, const unsigned char* color, const unsigned char* ia, int length)
+{
+    const __m128i zero = _mm_setzero_si128();
+
+    int i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+        __m128i vx = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i va = _mm_loadu_si128((const __m128i*)(ia + i));
+
+        __m128i aLo = _mm_unpacklo_epi8(va, zero);
+        __m128i aHi = _mm_unpackhi_epi8(va, zero);
+        aLo = _mm_add_epi16(aLo, _mm_srli_epi16(aLo, 7));
+        aHi = _mm_add_epi16(aHi, _mm_srli_epi16(aHi, 7));
+
+        __m128i lo = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(vx, zero), aLo), 8);
+        __m128i hi = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(vx, zero), aHi), 8);
+        __m128i out = _mm_adds_epu8(_mm_packus_epi16(lo, hi), _mm_loadu_si128((const __m128i*)(color + i)));
+        _mm_storeu_si128((__m128i*)(dst + i), out);
+    }
+    return i;
+}
+
+static int CompositeRowAvx2(unsigned char* dst, const unsigned char* color, const unsigned char* ia, int length)
+{
+    const __m256i zero = _mm256_setzero_si256();
+
+    int i = 0;
+    for (; i + 32 <= length; i += 32)
+    {
+        __m256i vx = _mm256_loadu_si256((const __m256i*)(dst + i));
+        __m256i va = _mm256_loadu_si256((const __m256i*)(ia + i));
+
+        __m256i aLo = _mm256_unpacklo_epi8(va, zero);
+        __m256i aHi = _mm256_unpackhi_epi8(va, zero);
+        aLo = _mm256_add_epi16(aLo, _mm256_srli_epi16(aLo, 7));
+        aHi = _mm256_add_epi16(aHi, _mm256_srli_epi16(aHi, 7));
+
+        __m256i lo = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(vx, zero), aLo), 8);
+        __m256i hi = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(vx, zero), aHi), 8);
+        __m256i out = _mm256_adds_epu8(_mm256_packus_epi16(lo, hi), _mm256_loadu_si256((const __m256i*)(color + i)));
+        _mm256_storeu_si256((__m256i*)(dst + i), out);
+    }
+
+    _mm256_zeroupper();
+    return i;
+}
+
+extern "C" {
+
+MEDIA_KERNELS_API int BlendFrames(const void* a, const void* b, void* dst, int length, int weight)
+{
+    if (a == nullptr || b == nullptr || dst == nullptr || length < 0 || weight < 0 || weight > 256)
+        return -1;
+
+    Blend<false>((const unsigned char*)a, (const unsigned char*)b, 0, (unsigned char*)dst, length, weight);
+    return 0;
+}
+
+MEDIA_KERNELS_API int FadeFrame(const void* src, void* dst, int length, int weight, unsigned int black)
+{
+    if (src == nullptr || dst == nullptr || length < 0 || (length & 3) != 0 || weight < 0 || weight > 256)
+        return -1;
+
+    // weight is the share of src; the rest goes to the black pattern
+    Blend<true>((const unsigned char*)src, nullptr, black, (unsigned char*)dst, length, 256 - weight);
+    return 0;
+}
+
+MEDIA_KERNELS_API int CompositeLayer(void* frame, int framePitch, const void* color,
+                                     const void* inverseAlpha, int layerPitch, int rowBytes, int rows)
+{
+    if (frame == nullptr || color == nullptr || inverseAlpha == nullptr || rowBytes < 0 || rows < 0 ||
+        framePitch < rowBytes || layerPitch < rowBytes)
+        return -1;
+
+    bool avx2 = GetSimdLevel() >= SimdLevelAvx2;
+    for (int y = 0; y < rows; y++)
+    {
+        unsigned char* dst = (unsigned char*)frame + (size_t)y * framePitch;
+        const unsigned char* c = (const unsigned char*)color + (size_t)y * layerPitch;
+        const unsigned char* ia = (const unsigned char*)inverseAlpha + (size_t)y * layerPitch;
+
+        int done = avx2 ? CompositeRowAvx2(dst, c, ia, rowBytes) : CompositeRowSse2(dst, c, ia, rowBytes);
+        CompositeRowScalar(dst, c, ia, done, rowBytes);
+    }
+    return 0;
+}
+
+}
@@ -0,0 +1,418 @@
+#include "FrameCopy.h"
+#include "CpuFeatures.h"
+
+#include <Windows.h>
+#include <immintrin.h>
+#include <string.h>
+
+// Below this size the destination is likely to stay in cache and be consumed
+// soon, so a regular memcpy is the better choice
+static const size_t StreamingThreshold = 256 * 1024;
+
+// Frames at least this large (2160p 8-bit UYVY is ~16.6 MB) are split across the pool
+static const size_t ParallelThreshold = 12 * 1024 * 1024;
+
+// Chunk boundaries are page aligned so workers never share a cache line
+static const size_t ChunkAlignment = 4096;
+
+static const int MaxCopyWorkers = 8;
+
+// ---------------------------------------------------------------------------
+// Kernels
+// ---------------------------------------------------------------------------
+
+// Each kernel copies an unaligned head with memcpy so the destination is aligned
+// for non-temporal stores, streams the bulk, then finishes the tail with memcpy.
+
+static void StreamCopySse41(unsigned char* dst, const unsigned char* src, size_t size)
+{
+    size_t head = (16 - ((uintptr_t)dst & 15)) & 15;
+    memcpy(dst, src, head);
+    dst += head; src += head; size -= head;
+
+    size_t blocks = size / 64;
+    bool srcAligned = ((uintptr_t)src & 15) == 0;
+
+    for (size_t i = 0; i < blocks; i++)
+    {
+        __m128i a, b, c, d;
+        if (srcAligned)
+        {
+            a = _mm_stream_load_si128((__m128i*)(src + 0));
+            b = _mm_stream_load_si128((__m128i*)(src + 16));
+            c = _mm_stream_load_si128((__m128i*)(src + 32));
+            d = _mm_stream_load_si128((__m128i*)(src + 48));
+        }
+        else
+        {
+            a = _mm_loadu_si128((const __m128i*)(src + 0));
+            b = _mm_loadu_si128((const __m128i*)(src + 16));
+            c = _mm_loadu_si128((const __m128i*)(src + 32));
+            d = _mm_loadu_si128((const __m128i*)(src + 48));
+        }
+        _mm_stream_si128((__m128i*)(dst + 0), a);
+        _mm_stream_si128((__m128i*)(dst + 16), b);
+        _mm_stream_si128((__m128i*)(dst + 32), c);
+        _mm_stream_si128((__m128i*)(dst + 48), d);
+        src += 64; dst += 64;
+    }
+
+    _mm_sfence();
+    memcpy(dst, src, size - blocks * 64);
+}
+
+static void StreamCopyAvx2(unsigned char* dst, const unsigned char* src, size_t size)
+{
+    size_t head = (32 - ((uintptr_t)dst & 31)) & 31;
+    memcpy(dst, src, head);
+    dst += head; src += head; size -= head;
+
+    size_t blocks = size / 128;
+    bool srcAligned = ((uintptr_t)src & 31) == 0;
+
+    for (size_t i = 0; i < blocks; i++)
+    {
+        __m256i a, b, c, d;
+        if (srcAligned)
+        {
+            a = _mm256_stream_load_si256((__m256i*)(src + 0));
+            b = _mm256_stream_load_si256((__m256i*)(src + 32));
+            c = _mm256_stream_load_si256((__m256i*)(src + 64));
+            d = _mm256_stream_load_si256((__m256i*)(src + 96));
+        }
+        else
+        {
+            a = _mm256_loadu_si256((const __m256i*)(src + 0));
+            b = _mm256_loadu_si256((const __m256i*)(src + 32));
+            c = _mm256_loadu_si256((const __m256i*)(src + 64));
+            d = _mm256_loadu_si256((const __m256i*)(src + 96));
+        }
+        _mm256_stream_si256((__m256i*)(dst + 0), a);
+        _mm256_stream_si256((__m256i*)(dst + 32), b);
+        _mm256_stream_si256((__m256i*)(dst + 64), c);
+        _mm256_stream_si256((__m256i*)(dst + 96), d);
+        src += 128; dst += 128;
+    }
+
+    _mm_sfence();
+    _mm256_zeroupper();
+    memcpy(dst, src, size - blocks * 128);
+}
+
+static void StreamCopyAvx512(unsigned char* dst, const unsigned char* src, size_t size)
+{
+    size_t head = (64 - ((uintptr_t)dst & 63)) & 63;
+    memcpy(dst, src, head);
+    dst += head; src += head; size -= head;
+
+    size_t blocks = size / 256;
+    bool srcAligned = ((uintptr_t)src & 63) == 0;
+
+    for (size_t i = 0; i < blocks; i++)
+    {
+        __m512i a, b, c, d;
+        if (srcAligned)
+        {
+            a = _mm512_stream_load_si512((void*)(src + 0));
+            b = _mm512_stream_load_si512((void*)(src + 64));
+            c = _mm512_stream_load_si512((void*)(src + 128));
+            d = _mm512_stream_load_si512((void*)(src + 192));
+        }
+        else
+        {
+            a = _mm512_loadu_si512((const void*)(src + 0));
+            b = _mm512_loadu_si512((const void*)(src + 64));
+            c = _mm512_loadu_si512((const void*)(src + 128));
+            d = _mm512_loadu_si512((const void*)(src + 192));
+        }
+        _mm512_stream_si512((__m512i*)(dst + 0), a);
+        _mm512_stream_si512((__m512i*)(dst + 64), b);
+        _mm512_stream_si512((__m512i*)(dst + 128), c);
+        _mm512_stream_si512((__m512i*)(dst + 192), d);
+        src += 256; dst += 256;
+    }
+
+    _mm_sfence();
+    _mm256_zeroupper();
+    memcpy(dst, src, size - blocks * 256);
+}
+
+static void PlainCopy(unsigned char* dst, const unsigned char* src, size_t size)
+{
+    memcpy(dst, src, size);
+}
+
+typedef void (*CopyKernel)(unsigned char* dst, const unsigned char* src, size_t size);
+
+// The kernel is chosen from the total size of the copy, so a strided copy of many
+// short rows still streams when the frame as a whole would not stay in cache
+static CopyKernel SelectKernel(size_t totalSize)
+{
+    if (totalSize < StreamingThreshold)
+        return PlainCopy;
+
+    switch (GetSimdLevel())
+    {
+    case SimdLevelAvx512: return StreamCopyAvx512;
+    case SimdLevelAvx2:   return StreamCopyAvx2;
+    case SimdLevelSse41:  return StreamCopySse41;
+    default:              return PlainCopy;
+    }
+}
+
+void FrameCopyStreaming(void* dst, const void* src, size_t size)
+{
+    SelectKernel(size)((unsigned char*)dst, (const unsigned char*)src, size);
+}
+
+static void StreamCopyRows(unsigned char* dst, const unsigned char* src, size_t srcPitch,
+                           size_t rowBytes, size_t rows)
+{
+    CopyKernel kernel = SelectKernel(rowBytes * rows);
+    for (size_t y = 0; y < rows; y++)
+        kernel(dst + y * rowBytes, src + y * srcPitch, rowBytes);
+}
+
+// ---------------------------------------------------------------------------
+// Worker pool
+// ---------------------------------------------------------------------------
+
+// A chunk is `rows` rows of `size` bytes, read at srcPitch and written tightly packed.
+// Contiguous copies are a single row.
+struct CopyChunk
+{
+    unsigned char* dst;
+    const unsigned char* src;
+    size_t size;
+    size_t rows;
+    size_t srcPitch;
+    volatile LONG faulted;
+};
+
+struct CopyWorker
+{
+    HANDLE thread;
+    HANDLE startEvent;
+    HANDLE doneEvent;
+    CopyChunk chunk;
+};
+
+static SRWLOCK g_poolLock = SRWLOCK_INIT;
+static CopyWorker g_workers[MaxCopyWorkers];
+static int g_workerCount = 0;
+static volatile LONG g_poolStopping = 0;
+
+// SEH must live in a function without C++ unwinding, so keep it separate
+static bool CopyChunkGuarded(CopyChunk* chunk)
+{
+    __try
+    {
+        StreamCopyRows(chunk->dst, chunk->src, chunk->srcPitch, chunk->size, chunk->rows);
+        return true;
+    }
+    __except(EXCEPTION_EXECUTE_HANDLER)
+    {
+        return false;
+    }
+}
+
+static DWORD WINAPI CopyWorkerProc(void* param)
+{
+    CopyWorker* worker = (CopyWorker*)param;
+
+    for (;;)
+    {
+        WaitForSingleObject(worker->startEvent, INFINITE);
+        if (g_poolStopping)
+            break;
+
+        worker->chunk.faulted = CopyChunkGuarded(&worker->chunk) ? 0 : 1;
+        SetEvent(worker->doneEvent);
+    }
+
+    return 0;
+}
+
+static void StopPoolLocked()
+{
+    if (g_workerCount == 0)
+        return;
+
+    InterlockedExchange(&g_poolStopping, 1);
+    for (int i = 0; i < g_workerCount; i++)
+        SetEvent(g_workers[i].startEvent);
+
+    for (int i = 0; i < g_workerCount; i++)
+    {
+        WaitForSingleObject(g_workers[i].thread, INFINITE);
+        CloseHandle(g_workers[i].thread);
+        CloseHandle(g_workers[i].startEvent);
+        CloseHandle(g_workers[i].doneEvent);
+    }
+
+    g_workerCount = 0;
+    InterlockedExchange(&g_poolStopping, 0);
+}
+
+int FrameCopyConfigurePool(int threadCount, unsigned long long affinityMask)
+{
+    AcquireSRWLockExclusive(&g_poolLock);
+
+    StopPoolLocked();
+
+    // The calling thread always copies one chunk itself, so N threads = N-1 workers
+    int workers = threadCount - 1;
+    if (workers > MaxCopyWorkers) workers = MaxCopyWorkers;
+
+    int cpu = 0;
+    for (int i = 0; i < workers; i++)
+    {
+        CopyWorker* w = &g_workers[g_workerCount];
+        w->startEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+        w->doneEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+        w->thread = CreateThread(nullptr, 0, CopyWorkerProc, w, 0, nullptr);
+
+        if (w->startEvent == nullptr || w->doneEvent == nullptr || w->thread == nullptr)
+        {
+            if (w->thread) CloseHandle(w->thread);
+            if (w->startEvent) CloseHandle(w->startEvent);
+            if (w->doneEvent) CloseHandle(w->doneEvent);
+            break;
+        }
+
+        SetThreadPriority(w->thread, THREAD_PRIORITY_HIGHEST);
+
+        if (affinityMask != 0)
+        {
+            while (cpu < 64 && (affinityMask & (1ULL << cpu)) == 0)
+                cpu++;
+            if (cpu < 64)
+            {
+                SetThreadAffinityMask(w->thread, (DWORD_PTR)(1ULL << cpu));
+                cpu++;
+            }
+        }
+
+        g_workerCount++;
+    }
+
+    int running = g_workerCount;
+    ReleaseSRWLockExclusive(&g_poolLock);
+    return running;
+}
+
+bool FrameCopy(void* dst, const void* src, size_t size)
+{
+    if (size < ParallelThreshold || g_workerCount == 0 || !TryAcquireSRWLockExclusive(&g_poolLock))
+    {
+        FrameCopyStreaming(dst, src, size);
+        return true;
+    }
+
+    if (g_workerCount == 0)
+    {
+        ReleaseSRWLockExclusive(&g_poolLock);
+        FrameCopyStreaming(dst, src, size);
+        return true;
+    }
+
+    int parts = g_workerCount + 1;
+    size_t chunkSize = (size / parts + ChunkAlignment - 1) & ~(ChunkAlignment - 1);
+
+    unsigned char* d = (unsigned char*)dst;
+    const unsigned char* s = (const unsigned char*)src;
+    size_t offset = 0;
+
+    HANDLE doneEvents[MaxCopyWorkers];
+    int dispatched = 0;
+
+    for (int i = 0; i < g_workerCount && offset < size; i++)
+    {
+        size_t thisChunk = (offset + chunkSize <= size) ? chunkSize : (size - offset);
+        CopyWorker* w = &g_workers[i];
+        w->chunk.dst = d + offset;
+        w->chunk.src = s + offset;
+        w->chunk.size = thisChunk;
+        w->chunk.rows = 1;
+        w->chunk.srcPitch = thisChunk;
+        w->chunk.faulted = 0;
+        doneEvents[dispatched++] = w->doneEvent;
+        SetEvent(w->startEvent);
+        offset += thisChunk;
+    }
+
+    // The caller's thread takes the remainder
+    CopyChunk own = { d + offset, s + offset, size - offset, 1, size - offset, 0 };
+    bool ok = CopyChunkGuarded(&own);
+
+    if (dispatched > 0)
+        WaitForMultipleObjects(dispatched, doneEvents, TRUE, INFINITE);
+
+    for (int i = 0; i < dispatched; i++)
+    {
+        if (g_workers[i].chunk.faulted)
+            ok = false;
+    }
+
+    ReleaseSRWLockExclusive(&g_poolLock);
+    return ok;
+}
+
+bool FrameCopyRows(void* dst, const void* src, size_t srcPitch, size_t rowBytes, size_t rows)
+{
+    unsigned char* d = (unsigned char*)dst;
+    const unsigned char* s = (const unsigned char*)src;
+
+    if (srcPitch == rowBytes)
+        return FrameCopy(dst, src, rowBytes * rows);
+
+    if (rowBytes * rows < ParallelThreshold || g_workerCount == 0 || !TryAcquireSRWLockExclusive(&g_poolLock))
+    {
+        StreamCopyRows(d, s, srcPitch, rowBytes, rows);
+        return true;
+    }
+
+    if (g_workerCount == 0)
+    {
+        ReleaseSRWLockExclusive(&g_poolLock);
+        StreamCopyRows(d, s, srcPitch, rowBytes, rows);
+        return true;
+    }
+
+    // Split on row boundaries; each part writes a disjoint band of the destination
+    int parts = g_workerCount + 1;
+    size_t rowsPerPart = (rows + parts - 1) / parts;
+    size_t row = 0;
+
+    HANDLE doneEvents[MaxCopyWorkers];
+    int dispatched = 0;
+
+    for (int i = 0; i < g_workerCount && row + rowsPerPart < rows; i++)
+    {
+        CopyWorker* w = &g_workers[i];
+        w->chunk.dst = d + row * rowBytes;
+        w->chunk.src = s + row * srcPitch;
+        w->chunk.size = rowBytes;
+        w->chunk.rows = rowsPerPart;
+        w->chunk.srcPitch = srcPitch;
+        w->chunk.faulted = 0;
+        doneEvents[dispatched++] = w->doneEvent;
+        SetEvent(w->startEvent);
+        row += rowsPerPart;
+    }
+
+    CopyChunk own = { d + row * rowBytes, s + row * srcPitch, rowBytes, rows - row, srcPitch, 0 };
+    bool ok = CopyChunkGuarded(&own);
+
+    if (dispatched > 0)
+        WaitForMultipleObjects(dispatched, doneEvents, TRUE, INFINITE);
+
+    for (int i = 0; i < dispatched; i++)
+    {
+        if (g_workers[i].chunk.faulted)
+            ok = false;
+    }
+
+    ReleaseSRWLockExclusive(&g_poolLock);
+    return ok;
+}
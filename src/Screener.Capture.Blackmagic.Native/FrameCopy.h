@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stddef.h>
+
+// Copy a large frame from (typically write-combined) DMA memory into a destination
+// that will not be read back soon. Uses MOVNTDQA loads and non-temporal stores so
+// the copy does not evict the rest of the process from L3.
+// Faults propagate to the caller (wrap in __try when the source is a DMA buffer).
+void FrameCopyStreaming(void* dst, const void* src, size_t size);
+
+// Copy a frame, splitting it across the worker pool when the pool is configured and
+// the frame is large enough (UHD). Falls back to FrameCopyStreaming on the caller's
+// thread when the pool is disabled or already busy with another input's frame.
+// Returns false if a worker faulted while reading the source; faults on the caller's
+// thread propagate as with FrameCopyStreaming.
+bool FrameCopy(void* dst, const void* src, size_t size);
+
+// Copy `rows` rows of rowBytes each from src (row pitch srcPitch) into a tightly packed
+// dst (row pitch rowBytes), e.g. to drop HANC/padding during the copy. Uses the same
+// kernels and worker pool as FrameCopy, splitting on row boundaries.
+// Returns false if a worker faulted while reading the source.
+bool FrameCopyRows(void* dst, const void* src, size_t srcPitch, size_t rowBytes, size_t rows);
+
+// (Re)configure the copy worker pool. threadCount <= 1 disables it.
+// affinityMask: if non-zero, worker i is pinned to the i-th set bit of the mask.
+// Returns the number of worker threads running.
+int FrameCopyConfigurePool(int threadCount, unsigned long long affinityMask);
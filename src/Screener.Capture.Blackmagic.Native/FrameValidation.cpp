@@ -0,0 +1,204 @@
+#define DECKLINK_NATIVE_EXPORTS
+#include "MediaKernels.h"
+#include "CpuFeatures.h"
+
+#include <immintrin.h>
+#include <stdint.h>
+
+// Number of 4-byte groups sampled per frame
+static const int CorruptionSamples = 2048;
+
+// Per-byte-lane statistics over the sampled 4-byte groups
+struct LaneStats
+{
+    int countFF[4];
+    int64_t sum[4];
+    int64_t sumSquares[4];
+};
+
+// Byte offsets of the sampled groups: rows spread with stride 131, columns with
+// stride 337 (aligned to 4 bytes). Computed incrementally to avoid a modulo per sample.
+static void ComputeSampleOffsets(int* offsets, int width, int height, int rowBytes)
+{
+    int widthBytes = width * 2; // UYVY: 2 bytes per pixel
+    int xRange = widthBytes - 4;
+    int y = 0;
+    int x = 0;
+
+    for (int i = 0; i < CorruptionSamples; i++)
+    {
+        offsets[i] = y * rowBytes + (x & ~3);
+
+        y += 131;
+        while (y >= height) y -= height;
+        x += 337;
+        while (x >= xRange) x -= xRange;
+    }
+}
+
+static void GatherStatsScalar(const unsigned char* p, const int* offsets, LaneStats* stats)
+{
+    for (int i = 0; i < CorruptionSamples; i++)
+    {
+        const unsigned char* g = p + offsets[i];
+        for (int lane = 0; lane < 4; lane++)
+        {
+            int v = g[lane];
+            stats->countFF[lane] += (v == 0xFF);
+            stats->sum[lane] += v;
+            stats->sumSquares[lane] += v * v;
+        }
+    }
+}
+
+static void GatherStatsSse41(const unsigned char* p, const int* offsets, LaneStats* stats)
+{
+    const __m128i byteMask = _mm_set1_epi32(0xFF);
+    __m128i countFF[4], sum[4], sumSquares[4];
+    for (int lane = 0; lane < 4; lane++)
+    {
+        countFF[lane] = _mm_setzero_si128();
+        sum[lane] = _mm_setzero_si128();
+        sumSquares[lane] = _mm_setzero_si128();
+    }
+
+    for (int i = 0; i < CorruptionSamples; i += 4)
+    {
+        __m128i groups = _mm_cvtsi32_si128(*(const int*)(p + offsets[i]));
+        groups = _mm_insert_epi32(groups, *(const int*)(p + offsets[i + 1]), 1);
+        groups = _mm_insert_epi32(groups, *(const int*)(p + offsets[i + 2]), 2);
+        groups = _mm_insert_epi32(groups, *(const int*)(p + offsets[i + 3]), 3);
+
+        for (int lane = 0; lane < 4; lane++)
+        {
+            __m128i v = _mm_and_si128(_mm_srli_epi32(groups, lane * 8), byteMask);
+            sum[lane] = _mm_add_epi32(sum[lane], v);
+            sumSquares[lane] = _mm_add_epi32(sumSquares[lane], _mm_madd_epi16(v, v));
+            countFF[lane] = _mm_sub_epi32(countFF[lane], _mm_cmpeq_epi32(v, byteMask));
+        }
+    }
+
+    for (int lane = 0; lane < 4; lane++)
+    {
+        alignas(16) int c[4], s[4], q[4];
+        _mm_store_si128((__m128i*)c, countFF[lane]);
+        _mm_store_si128((__m128i*)s, sum[lane]);
+        _mm_store_si128((__m128i*)q, sumSquares[lane]);
+        for (int k = 0; k < 4; k++)
+        {
+            stats->countFF[lane] += c[k];
+            stats->sum[lane] += s[k];
+            stats->sumSquares[lane] += q[k];
+        }
+    }
+}
+
+static void GatherStatsAvx2(const unsigned char* p, const int* offsets, LaneStats* stats)
+{
+    const __m256i byteMask = _mm256_set1_epi32(0xFF);
+    __m256i countFF[4], sum[4], sumSquares[4];
+    for (int lane = 0; lane < 4; lane++)
+    {
+        countFF[lane] = _mm256_setzero_si256();
+        sum[lane] = _mm256_setzero_si256();
+        sumSquares[lane] = _mm256_setzero_si256();
+    }
+
+    for (int i = 0; i < CorruptionSamples; i += 8)
+    {
+        __m256i index = _mm256_loadu_si256((const __m256i*)(offsets + i));
+        __m256i groups = _mm256_i32gather_epi32((const int*)p, index, 1);
+
+        for (int lane = 0; lane < 4; lane++)
+        {
+            __m256i v = _mm256_and_si256(_mm256_srli_epi32(groups, lane * 8), byteMask);
+            sum[lane] = _mm256_add_epi32(sum[lane], v);
+            sumSquares[lane] = _mm256_add_epi32(sumSquares[lane], _mm256_madd_epi16(v, v));
+            countFF[lane] = _mm256_sub_epi32(countFF[lane], _mm256_cmpeq_epi32(v, byteMask));
+        }
+    }
+
+    for (int lane = 0; lane < 4; lane++)
+    {
+        alignas(32) int c[8], s[8], q[8];
+        _mm256_store_si256((__m256i*)c, countFF[lane]);
+        _mm256_store_si256((__m256i*)s, sum[lane]);
+        _mm256_store_si256((__m256i*)q, sumSquares[lane]);
+        for (int k = 0; k < 8; k++)
+        {
+            stats->countFF[lane] += c[k];
+            stats->sum[lane] += s[k];
+            stats->sumSquares[lane] += q[k];
+        }
+    }
+
+    _mm256_zeroupper();
+}
+
+// Sample variance from integer sums (same value Welford's method converges to)
+static double LaneVariance(const LaneStats& stats, int lane)
+{
+    const double n = CorruptionSamples;
+    double mean = stats.sum[lane] / n;
+    return ((double)stats.sumSquares[lane] - n * mean * mean) / (n - 1);
+}
+
+static bool ClassifyAsBGRA(const LaneStats& stats)
+{
+    const double n = CorruptionSamples;
+    double p0 = stats.countFF[0] / n;
+    double p1 = stats.countFF[1] / n;
+    double p2 = stats.countFF[2] / n;
+    double p3 = stats.countFF[3] / n;
+
+    double maxOther = (p0 > p1) ? p0 : p1;
+    if (p2 > maxOther) maxOther = p2;
+    double alphaBias = p3 - maxOther;
+
+    double var0 = LaneVariance(stats, 0);
+    double var1 = LaneVariance(stats, 1);
+    double var2 = LaneVariance(stats, 2);
+    double var3 = LaneVariance(stats, 3);
+
+    double varY = var1 + var3;
+    double varUV = var0 + var2;
+
+    // In BGRA, byte 3 (alpha) is typically 0xFF with low variance
+    // In UYVY, all bytes have similar variance patterns
+    bool suspiciousAlpha = (p3 > 0.20 && alphaBias > 0.10) || (p3 > 0.35);
+    bool suspiciousVariance = (var3 < 50.0 && p3 > 0.10) || (varY < varUV * 0.8);
+
+    return suspiciousAlpha || suspiciousVariance;
+}
+
+extern "C" {
+
+MEDIA_KERNELS_API int GetMediaKernelLevel()
+{
+    return GetSimdLevel();
+}
+
+MEDIA_KERNELS_API int DetectCorruptBGRA(const void* buffer, int bufferSize, int width, int height, int rowBytes)
+{
+    if (buffer == nullptr || width < 4 || height <= 0 || rowBytes < width * 2 ||
+        (long long)rowBytes * height > bufferSize)
+        return -1;
+
+    alignas(32) int offsets[CorruptionSamples];
+    ComputeSampleOffsets(offsets, width, height, rowBytes);
+
+    LaneStats stats = {};
+    const unsigned char* p = (const unsigned char*)buffer;
+
+    int level = GetSimdLevel();
+    if (level >= SimdLevelAvx2)
+        GatherStatsAvx2(p, offsets, &stats);
+    else if (level >= SimdLevelSse41)
+        GatherStatsSse41(p, offsets, &stats);
+    else
+        GatherStatsScalar(p, offsets, &stats);
+
+    return ClassifyAsBGRA(stats) ? 1 : 0;
+}
+
+}
@@ -0,0 +1,729 @@
+#define DECKLINK_NATIVE_EXPORTS
+#include "LiveEncoder.h"
+#include "MediaKernels.h"
+#include "TraceLog.h"
+
+#include <Windows.h>
+#include <mfapi.h>
+#include <mfidl.h>
+#include <mftransform.h>
+#include <mferror.h>
+#include <codecapi.h>
+#include <strmif.h>
+#include <wincodec.h>
+#include <string.h>
+#include <deque>
+#include <new>
+#include <vector>
+
+struct LivePacket
+{
+    std::vector<unsigned char> data;
+    long long timestamp;
+    bool keyframe;
+};
+
+struct LiveEncoder
+{
+    LiveEncoderSettings settings;
+    int frameSize;                      // NV12 bytes per output frame
+    long long frameDuration;            // 100 ns units
+    bool mfStarted;
+
+    // H.264
+    IMFTransform* transform;
+    IMFMediaEventGenerator* events;     // async (hardware) transforms only
+    ICodecAPI* codecApi;
+    DWORD inputId;
+    DWORD outputId;
+    bool providesSamples;
+    DWORD outputBufferSize;
+    int inputRequests;                  // METransformNeedInput not yet answered
+    std::vector<unsigned char> sequenceHeader;
+
+    // JPEG
+    IWICImagingFactory* wic;
+    std::vector<unsigned char> nv12;    // scaled frame, range-expanded in place for JPEG
+    unsigned char fullRangeY[256];
+    unsigned char fullRangeC[256];
+
+    std::deque<LivePacket> output;
+    LiveEncoderStats stats;
+};
+
+// A hardware transform that has not asked for input within this long is treated as busy
+static const DWORD InputWaitMs = 20;
+
+template <typename T>
+static void SafeRelease(T*& p)
+{
+    if (p)
+    {
+        p->Release();
+        p = nullptr;
+    }
+}
+
+static long long TicksToMicros(long long ticks)
+{
+    static LARGE_INTEGER frequency = {};
+    if (frequency.QuadPart == 0)
+        QueryPerformanceFrequency(&frequency);
+    return ticks / frequency.QuadPart * 1000000 + ticks % frequency.QuadPart * 1000000 / frequency.QuadPart;
+}
+
+static bool ValidSettings(const LiveEncoderSettings* s)
+{
+    if (!s || s->width < 2 || s->height < 2 || (s->width & 1) || (s->height & 1) ||
+        s->frameRateNum <= 0 || s->frameRateDen <= 0)
+        return false;
+    if (s->divisor != 1 && s->divisor != 2 && s->divisor != 4)
+        return false;
+    if (s->codec == LiveEncoderCodecH264)
+        return s->bitrateKbps > 0;
+    return s->codec == LiveEncoderCodecJpeg && s->jpegQuality >= 1 && s->jpegQuality <= 100;
+}
+
+// COM for the calling thread, balanced per call: callers come from the .NET thread pool
+struct ComScope
+{
+    HRESULT hr;
+    ComScope() : hr(CoInitializeEx(nullptr, COINIT_MULTITHREADED)) {}
+    ~ComScope() { if (SUCCEEDED(hr)) CoUninitialize(); }
+};
+
+static bool ContainsNal(const unsigned char* data, size_t length, int nalType)
+{
+    for (size_t i = 0; i + 3 < length; i++)
+    {
+        if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1 && (data[i + 3] & 0x1F) == nalType)
+            return true;
+    }
+    return false;
+}
+
+// ---------------------------------------------------------------------------
+// H.264 (Media Foundation transform)
+// ---------------------------------------------------------------------------
+
+static void SetCodecValue(ICodecAPI* api, const GUID& property, UINT32 value)
+{
+    VARIANT v;
+    VariantInit(&v);
+    v.vt = VT_UI4;
+    v.ulVal = value;
+    api->SetValue(&property, &v);
+}
+
+static void SetCodecFlag(ICodecAPI* api, const GUID& property, bool value)
+{
+    VARIANT v;
+    VariantInit(&v);
+    v.vt = VT_BOOL;
+    v.boolVal = value ? VARIANT_TRUE : VARIANT_FALSE;
+    api->SetValue(&property, &v);
+}
+
+static HRESULT SetVideoType(IMFMediaType* type, const GUID& subtype, const LiveEncoderSettings& s)
+{
+    HRESULT hr = type->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Video);
+    if (SUCCEEDED(hr)) hr = type->SetGUID(MF_MT_SUBTYPE, subtype);
+    if (SUCCEEDED(hr)) hr = type->SetUINT32(MF_MT_INTERLACE_MODE, MFVideoInterlace_Progressive);
+    if (SUCCEEDED(hr)) hr = MFSetAttributeSize(type, MF_MT_FRAME_SIZE, s.width, s.height);
+    if (SUCCEEDED(hr)) hr = MFSetAttributeRatio(type, MF_MT_FRAME_RATE, s.frameRateNum, s.frameRateDen);
+    if (SUCCEEDED(hr)) hr = MFSetAttributeRatio(type, MF_MT_PIXEL_ASPECT_RATIO, 1, 1);
+    return hr;
+}
+
+// First H.264 encoder MFT that activates; MFT_ENUM_FLAG_SORTANDFILTER puts hardware first
+static HRESULT ActivateH264Transform(LiveEncoder* e)
+{
+    MFT_REGISTER_TYPE_INFO inputType = { MFMediaType_Video, MFVideoFormat_NV12 };
+    MFT_REGISTER_TYPE_INFO outputType = { MFMediaType_Video, MFVideoFormat_H264 };
+    UINT32 flags = MFT_ENUM_FLAG_SYNCMFT | MFT_ENUM_FLAG_SORTANDFILTER;
+    if (e->settings.allowHardware)
+        flags |= MFT_ENUM_FLAG_ASYNCMFT | MFT_ENUM_FLAG_HARDWARE;
+
+    IMFActivate** activates = nullptr;
+    UINT32 count = 0;
+    HRESULT hr = MFTEnumEx(MFT_CATEGORY_VIDEO_ENCODER, flags, &inputType, &outputType, &activates, &count);
+    if (FAILED(hr))
+        return hr;
+
+    hr = count > 0 ? E_FAIL : MF_E_TOPO_CODEC_NOT_FOUND;
+    for (UINT32 i = 0; i < count; i++)
+    {
+        if (!e->transform && SUCCEEDED(hr = activates[i]->ActivateObject(IID_PPV_ARGS(&e->transform))))
+        {
+            UINT32 length = 0;
+            e->stats.hardware = SUCCEEDED(activates[i]->GetStringLength(MFT_ENUM_HARDWARE_URL_Attribute, &length)) ? 1 : 0;
+        }
+        activates[i]->Release();
+    }
+    CoTaskMemFree(activates);
+
+    return e->transform ? S_OK : hr;
+}
+
+static HRESULT ConfigureH264(LiveEncoder* e)
+{
+    const LiveEncoderSettings& s = e->settings;
+
+    HRESULT hr = ActivateH264Transform(e);
+
+    // Hardware encoders are asynchronous: they must be unlocked and are driven by events
+    IMFAttributes* attributes = nullptr;
+    if (SUCCEEDED(hr) && SUCCEEDED(e->transform->GetAttributes(&attributes)))
+    {
+        if (MFGetAttributeUINT32(attributes, MF_TRANSFORM_ASYNC, FALSE))
+        {
+            hr = attributes->SetUINT32(MF_TRANSFORM_ASYNC_UNLOCK, TRUE);
+            if (SUCCEEDED(hr)) hr = e->transform->QueryInterface(IID_PPV_ARGS(&e->events));
+        }
+        attributes->SetUINT32(MF_LOW_LATENCY, TRUE);
+        SafeRelease(attributes);
+    }
+
+    if (SUCCEEDED(hr) && e->transform->GetStreamIDs(1, &e->inputId, 1, &e->outputId) == E_NOTIMPL)
+    {
+        e->inputId = 0;
+        e->outputId = 0;
+    }
+
+    // Rate control before the types, which some vendors read once when the output type is set
+    if (SUCCEEDED(hr) && SUCCEEDED(e->transform->QueryInterface(IID_PPV_ARGS(&e->codecApi))))
+    {
+        int gop = s.gopFrames > 0 ? s.gopFrames : 2 * (s.frameRateNum + s.frameRateDen - 1) / s.frameRateDen;
+        SetCodecValue(e->codecApi, CODECAPI_AVEncCommonRateControlMode, eAVEncCommonRateControlMode_CBR);
+        SetCodecValue(e->codecApi, CODECAPI_AVEncCommonMeanBitRate, (UINT32)s.bitrateKbps * 1000);
+        SetCodecValue(e->codecApi, CODECAPI_AVEncMPVGOPSize, (UINT32)gop);
+        SetCodecValue(e->codecApi, CODECAPI_AVEncMPVDefaultBPictureCount, 0);
+        SetCodecFlag(e->codecApi, CODECAPI_AVLowLatencyMode, true);
+    }
+
+    // Encoders take the output type first. Baseline so every browser decoder accepts it.
+    IMFMediaType* output = nullptr;
+    IMFMediaType* input = nullptr;
+    if (SUCCEEDED(hr)) hr = MFCreateMediaType(&output);
+    if (SUCCEEDED(hr)) hr = SetVideoType(output, MFVideoFormat_H264, s);
+    if (SUCCEEDED(hr)) hr = output->SetUINT32(MF_MT_AVG_BITRATE, (UINT32)s.bitrateKbps * 1000);
+    if (SUCCEEDED(hr)) hr = output->SetUINT32(MF_MT_MPEG2_PROFILE, eAVEncH264VProfile_Base);
+    if (SUCCEEDED(hr)) hr = e->transform->SetOutputType(e->outputId, output, 0);
+
+    if (SUCCEEDED(hr)) hr = MFCreateMediaType(&input);
+    if (SUCCEEDED(hr)) hr = SetVideoType(input, MFVideoFormat_NV12, s);
+    if (SUCCEEDED(hr)) hr = input->SetUINT32(MF_MT_DEFAULT_STRIDE, (UINT32)s.width);
+    if (SUCCEEDED(hr)) hr = e->transform->SetInputType(e->inputId, input, 0);
+
+    MFT_OUTPUT_STREAM_INFO info = {};
+    if (SUCCEEDED(hr)) hr = e->transform->GetOutputStreamInfo(e->outputId, &info);
+    if (SUCCEEDED(hr))
+    {
+        e->providesSamples = (info.dwFlags & (MFT_OUTPUT_STREAM_PROVIDES_SAMPLES | MFT_OUTPUT_STREAM_CAN_PROVIDE_SAMPLES)) != 0;
+        e->outputBufferSize = info.cbSize > 0 ? info.cbSize : (DWORD)e->frameSize;
+    }
+
+    if (SUCCEEDED(hr)) hr = e->transform->ProcessMessage(MFT_MESSAGE_NOTIFY_BEGIN_STREAMING, 0);
+    if (SUCCEEDED(hr)) hr = e->transform->ProcessMessage(MFT_MESSAGE_NOTIFY_START_OF_STREAM, 0);
+
+    SafeRelease(input);
+    SafeRelease(output);
+    return hr;
+}
+
+// SPS/PPS from the negotiated output type, prepended to keyframes that lack them
+static void LoadSequenceHeader(LiveEncoder* e)
+{
+    IMFMediaType* type = nullptr;
+    if (FAILED(e->transform->GetOutputCurrentType(e->outputId, &type)))
+        return;
+
+    UINT32 length = 0;
+    if (SUCCEEDED(type->GetBlobSize(MF_MT_MPEG_SEQUENCE_HEADER, &length)) && length > 0)
+    {
+        e->sequenceHeader.resize(length);
+        if (FAILED(type->GetBlob(MF_MT_MPEG_SEQUENCE_HEADER, e->sequenceHeader.data(), length, nullptr)))
+            e->sequenceHeader.clear();
+    }
+    SafeRelease(type);
+}
+
+// Take one finished frame from the transform. S_OK when a frame was queued,
+// MF_E_TRANSFORM_NEED_MORE_INPUT when there is none yet.
+static HRESULT CollectOutput(LiveEncoder* e)
+{
+    MFT_OUTPUT_DATA_BUFFER out = {};
+    out.dwStreamID = e->outputId;
+
+    HRESULT hr = S_OK;
+    if (!e->providesSamples)
+    {
+        IMFMediaBuffer* buffer = nullptr;
+        hr = MFCreateSample(&out.pSample);
+        if (SUCCEEDED(hr)) hr = MFCreateMemoryBuffer(e->outputBufferSize, &buffer);
+        if (SUCCEEDED(hr)) hr = out.pSample->AddBuffer(buffer);
+        SafeRelease(buffer);
+        if (FAILED(hr))
+        {
+            SafeRelease(out.pSample);
+            return hr;
+        }
+    }
+
+    DWORD status = 0;
+    hr = e->transform->ProcessOutput(0, 1, &out, &status);
+    SafeRelease(out.pEvents);
+
+    if (hr == MF_E_TRANSFORM_STREAM_CHANGE)
+    {
+        // The encoder settled its output format (e.g. SPS known): accept what it offers
+        IMFMediaType* type = nullptr;
+        hr = e->transform->GetOutputAvailableType(e->outputId, 0, &type);
+        if (SUCCEEDED(hr)) hr = e->transform->SetOutputType(e->outputId, type, 0);
+        SafeRelease(type);
+        SafeRelease(out.pSample);
+        e->sequenceHeader.clear();
+        return SUCCEEDED(hr) ? CollectOutput(e) : hr;
+    }
+
+    if (SUCCEEDED(hr) && out.pSample)
+    {
+        IMFMediaBuffer* buffer = nullptr;
+        BYTE* data = nullptr;
+        DWORD length = 0;
+        hr = out.pSample->ConvertToContiguousBuffer(&buffer);
+        if (SUCCEEDED(hr)) hr = buffer->Lock(&data, nullptr, &length);
+        if (SUCCEEDED(hr))
+        {
+            LivePacket packet;
+            packet.keyframe = MFGetAttributeUINT32(out.pSample, MFSampleExtension_CleanPoint, FALSE) != 0 ||
+                              ContainsNal(data, length, 5);
+            if (FAILED(out.pSample->GetSampleTime(&packet.timestamp)))
+                packet.timestamp = 0;
+
+            if (packet.keyframe && !ContainsNal(data, length, 7))
+            {
+                if (e->sequenceHeader.empty())
+                    LoadSequenceHeader(e);
+                packet.data.assign(e->sequenceHeader.begin(), e->sequenceHeader.end());
+            }
+            packet.data.insert(packet.data.end(), data, data + length);
+
+            e->output.push_back(std::move(packet));
+            buffer->Unlock();
+        }
+        SafeRelease(buffer);
+    }
+
+    SafeRelease(out.pSample);
+    return hr;
+}
+
+// Drain the async transform's event queue without blocking
+static HRESULT PumpEvents(LiveEncoder* e)
+{
+    for (;;)
+    {
+        IMFMediaEvent* event = nullptr;
+        HRESULT hr = e->events->GetEvent(MF_EVENT_FLAG_NO_WAIT, &event);
+        if (hr == MF_E_NO_EVENTS_AVAILABLE)
+            return S_OK;
+        if (FAILED(hr))
+            return hr;
+
+        MediaEventType type = MEUnknown;
+        event->GetType(&type);
+        SafeRelease(event);
+
+        if (type == METransformNeedInput)
+            e->inputRequests++;
+        else if (type == METransformHaveOutput && FAILED(hr = CollectOutput(e)))
+            return hr;
+    }
+}
+
+static HRESULT EncodeH264(LiveEncoder* e, long long timestamp, bool forceKeyframe)
+{
+    HRESULT hr = S_OK;
+    if (e->events)
+    {
+        // An async transform says when it wants input
+        ULONGLONG deadline = GetTickCount64() + InputWaitMs;
+        while (SUCCEEDED(hr = PumpEvents(e)) && e->inputRequests == 0 && GetTickCount64() < deadline)
+            Sleep(1);
+        if (FAILED(hr))
+            return hr;
+        if (e->inputRequests == 0)
+            return S_FALSE;
+    }
+
+    IMFSample* sample = nullptr;
+    IMFMediaBuffer* buffer = nullptr;
+    BYTE* dst = nullptr;
+    hr = MFCreateMemoryBuffer((DWORD)e->frameSize, &buffer);
+    if (SUCCEEDED(hr)) hr = buffer->Lock(&dst, nullptr, nullptr);
+    if (SUCCEEDED(hr))
+    {
+        memcpy(dst, e->nv12.data(), e->frameSize);
+        buffer->Unlock();
+        hr = buffer->SetCurrentLength((DWORD)e->frameSize);
+    }
+    if (SUCCEEDED(hr)) hr = MFCreateSample(&sample);
+    if (SUCCEEDED(hr)) hr = sample->AddBuffer(buffer);
+    if (SUCCEEDED(hr)) hr = sample->SetSampleTime(timestamp);
+    if (SUCCEEDED(hr)) hr = sample->SetSampleDuration(e->frameDuration);
+
+    if (SUCCEEDED(hr) && forceKeyframe && e->codecApi)
+        SetCodecValue(e->codecApi, CODECAPI_AVEncVideoForceKeyFrame, 1);
+
+    if (SUCCEEDED(hr))
+    {
+        hr = e->transform->ProcessInput(e->inputId, sample, 0);
+        if (hr == MF_E_NOTACCEPTING && !e->events)
+        {
+            // A sync transform holding output: take it and offer the frame again
+            while (CollectOutput(e) == S_OK) {}
+            hr = e->transform->ProcessInput(e->inputId, sample, 0);
+        }
+        if (hr == MF_E_NOTACCEPTING)
+            hr = S_FALSE;
+    }
+
+    if (hr == S_OK && e->events)
+        e->inputRequests--;
+
+    // A sync transform produces output on demand
+    if (hr == S_OK && !e->events)
+    {
+        HRESULT collected;
+        while ((collected = CollectOutput(e)) == S_OK) {}
+        if (collected != MF_E_TRANSFORM_NEED_MORE_INPUT)
+            hr = collected;
+    }
+
+    SafeRelease(sample);
+    SafeRelease(buffer);
+    return hr;
+}
+
+// ---------------------------------------------------------------------------
+// JPEG (WIC planar encoder)
+// ---------------------------------------------------------------------------
+
+static void BuildRangeTables(LiveEncoder* e)
+{
+    // NV12 from the kernels is studio range; JFIF is full range
+    for (int i = 0; i < 256; i++)
+    {
+        int y = ((i - 16) * 255 + 109) / 219;
+        int c = ((i - 128) * 255 + (i >= 128 ? 112 : -112)) / 224 + 128;
+        e->fullRangeY[i] = (unsigned char)(y < 0 ? 0 : y > 255 ? 255 : y);
+        e->fullRangeC[i] = (unsigned char)(c < 0 ? 0 : c > 255 ? 255 : c);
+    }
+}
+
+static HRESULT WriteProperty(IPropertyBag2* properties, const wchar_t* name, VARIANT* value)
+{
+    PROPBAG2 option = {};
+    option.pstrName = (LPOLESTR)name;
+    return properties->Write(1, &option, value);
+}
+
+static HRESULT EncodeJpeg(LiveEncoder* e, long long timestamp)
+{
+    const LiveEncoderSettings& s = e->settings;
+
+    int lumaSize = s.width * s.height;
+    unsigned char* nv12 = e->nv12.data();
+    for (int i = 0; i < lumaSize; i++)
+        nv12[i] = e->fullRangeY[nv12[i]];
+    for (int i = lumaSize; i < e->frameSize; i++)
+        nv12[i] = e->fullRangeC[nv12[i]];
+
+    IStream* stream = nullptr;
+    IWICBitmapEncoder* encoder = nullptr;
+    IWICBitmapFrameEncode* frame = nullptr;
+    IPropertyBag2* properties = nullptr;
+    IWICPlanarBitmapFrameEncode* planar = nullptr;
+
+    HRESULT hr = CreateStreamOnHGlobal(nullptr, TRUE, &stream);
+    if (SUCCEEDED(hr)) hr = e->wic->CreateEncoder(GUID_ContainerFormatJpeg, nullptr, &encoder);
+    if (SUCCEEDED(hr)) hr = encoder->Initialize(stream, WICBitmapEncoderNoCache);
+    if (SUCCEEDED(hr)) hr = encoder->CreateNewFrame(&frame, &properties);
+    if (SUCCEEDED(hr))
+    {
+        VARIANT value;
+        VariantInit(&value);
+        value.vt = VT_R4;
+        value.fltVal = s.jpegQuality / 100.0f;
+        hr = WriteProperty(properties, L"ImageQuality", &value);
+
+        VariantInit(&value);
+        value.vt = VT_UI1;
+        value.bVal = WICJpegYCrCbSubsampling420;
+        if (SUCCEEDED(hr)) hr = WriteProperty(properties, L"JpegYCrCbSubsampling", &value);
+    }
+    if (SUCCEEDED(hr)) hr = frame->Initialize(properties);
+    if (SUCCEEDED(hr)) hr = frame->SetSize((UINT)s.width, (UINT)s.height);
+    if (SUCCEEDED(hr)) hr = frame->QueryInterface(IID_PPV_ARGS(&planar));
+    if (SUCCEEDED(hr))
+    {
+        WICBitmapPlane planes[2] = {
+            { GUID_WICPixelFormat8bppY, nv12, (UINT)s.width, (UINT)lumaSize },
+            { GUID_WICPixelFormat16bppCbCr, nv12 + lumaSize, (UINT)s.width, (UINT)(e->frameSize - lumaSize) }
+        };
+        hr = planar->WritePixels((UINT)s.height, planes, 2);
+    }
+    if (SUCCEEDED(hr)) hr = frame->Commit();
+    if (SUCCEEDED(hr)) hr = encoder->Commit();
+
+    if (SUCCEEDED(hr))
+    {
+        STATSTG stat = {};
+        HGLOBAL global = nullptr;
+        hr = stream->Stat(&stat, STATFLAG_NONAME);
+        if (SUCCEEDED(hr)) hr = GetHGlobalFromStream(stream, &global);
+        if (SUCCEEDED(hr))
+        {
+            const unsigned char* bytes = (const unsigned char*)GlobalLock(global);
+            if (bytes)
+            {
+                LivePacket packet;
+                packet.data.assign(bytes, bytes + stat.cbSize.LowPart);
+                packet.timestamp = timestamp;
+                packet.keyframe = true;
+                e->output.push_back(std::move(packet));
+                GlobalUnlock(global);
+            }
+            else
+            {
+                hr = E_FAIL;
+            }
+        }
+    }
+
+    SafeRelease(planar);
+    SafeRelease(properties);
+    SafeRelease(frame);
+    SafeRelease(encoder);
+    SafeRelease(stream);
+    return hr;
+}
+
+// ---------------------------------------------------------------------------
+// Exports
+// ---------------------------------------------------------------------------
+
+static void Release(LiveEncoder* e)
+{
+    if (e->transform)
+    {
+        e->transform->ProcessMessage(MFT_MESSAGE_NOTIFY_END_OF_STREAM, 0);
+        e->transform->ProcessMessage(MFT_MESSAGE_NOTIFY_END_STREAMING, 0);
+    }
+
+    // Async transforms hold a reference cycle through their event queue until shut down
+    IMFShutdown* shutdown = nullptr;
+    if (e->transform && SUCCEEDED(e->transform->QueryInterface(IID_PPV_ARGS(&shutdown))))
+    {
+        shutdown->Shutdown();
+        SafeRelease(shutdown);
+    }
+
+    SafeRelease(e->codecApi);
+    SafeRelease(e->events);
+    SafeRelease(e->transform);
+    SafeRelease(e->wic);
+    if (e->mfStarted)
+        MFShutdown();
+    delete e;
+}
+
+extern "C" {
+
+MEDIA_KERNELS_API int IsLiveEncoderAvailable(int codec)
+{
+    ComScope com;
+
+    if (codec == LiveEncoderCodecJpeg)
+    {
+        IWICImagingFactory* factory = nullptr;
+        HRESULT hr = CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&factory));
+        SafeRelease(factory);
+        return SUCCEEDED(hr) ? 1 : 0;
+    }
+
+    if (codec != LiveEncoderCodecH264 || FAILED(MFStartup(MF_VERSION, MFSTARTUP_LITE)))
+        return 0;
+
+    MFT_REGISTER_TYPE_INFO inputType = { MFMediaType_Video, MFVideoFormat_NV12 };
+    MFT_REGISTER_TYPE_INFO outputType = { MFMediaType_Video, MFVideoFormat_H264 };
+    IMFActivate** activates = nullptr;
+    UINT32 count = 0;
+    HRESULT hr = MFTEnumEx(MFT_CATEGORY_VIDEO_ENCODER, MFT_ENUM_FLAG_SYNCMFT | MFT_ENUM_FLAG_ASYNCMFT | MFT_ENUM_FLAG_HARDWARE,
+                           &inputType, &outputType, &activates, &count);
+    if (SUCCEEDED(hr))
+    {
+        for (UINT32 i = 0; i < count; i++)
+            activates[i]->Release();
+        CoTaskMemFree(activates);
+    }
+
+    MFShutdown();
+    return SUCCEEDED(hr) && count > 0 ? 1 : 0;
+}
+
+MEDIA_KERNELS_API void* CreateLiveEncoder(const LiveEncoderSettings* settings, int* error)
+{
+    if (error) *error = 0;
+    if (!ValidSettings(settings))
+    {
+        if (error) *error = E_INVALIDARG;
+        return nullptr;
+    }
+
+    LiveEncoder* e = new (std::nothrow) LiveEncoder();
+    if (!e)
+    {
+        if (error) *error = E_OUTOFMEMORY;
+        return nullptr;
+    }
+
+    e->settings = *settings;
+    e->frameSize = settings->width * settings->height * 3 / 2;
+    e->frameDuration = 10000000LL * settings->frameRateDen / settings->frameRateNum;
+
+    ComScope com;
+    HRESULT hr = S_OK;
+    try
+    {
+        e->nv12.resize(e->frameSize);
+    }
+    catch (const std::bad_alloc&)
+    {
+        hr = E_OUTOFMEMORY;
+    }
+
+    if (SUCCEEDED(hr) && settings->codec == LiveEncoderCodecJpeg)
+    {
+        BuildRangeTables(e);
+        hr = CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&e->wic));
+    }
+    else if (SUCCEEDED(hr))
+    {
+        hr = MFStartup(MF_VERSION, MFSTARTUP_LITE);
+        e->mfStarted = SUCCEEDED(hr);
+        if (SUCCEEDED(hr)) hr = ConfigureH264(e);
+    }
+
+    if (FAILED(hr))
+    {
+        TRACE(TraceLevelError, "CreateLiveEncoder %dx%d codec=%d failed: 0x%08X",
+              settings->width, settings->height, settings->codec, (unsigned)hr);
+        Release(e);
+        if (error) *error = hr;
+        return nullptr;
+    }
+
+    TRACE(TraceLevelInfo, "CreateLiveEncoder %dx%d /%d codec=%d %d kbps q=%d hardware=%d async=%d",
+          settings->width, settings->height, settings->divisor, settings->codec, settings->bitrateKbps,
+          settings->jpegQuality, e->stats.hardware, e->events ? 1 : 0);
+    return e;
+}
+
+MEDIA_KERNELS_API int SendLiveEncoderFrame(void* encoder, const void* src, int srcBufferSize, int srcPitch,
+                                           long long timestamp, int forceKeyframe)
+{
+    LiveEncoder* e = (LiveEncoder*)encoder;
+    if (!e || !src || srcPitch <= 0)
+        return -1;
+
+    const LiveEncoderSettings& s = e->settings;
+    int srcRows = s.height * s.divisor;
+    int activeRowBytes = s.width * s.divisor * 2;
+    if (srcPitch < activeRowBytes || (long long)srcPitch * (srcRows - 1) + activeRowBytes > srcBufferSize)
+        return -1;
+
+    LARGE_INTEGER start, converted, end;
+    QueryPerformanceCounter(&start);
+    unsigned char* nv12 = e->nv12.data();
+    if (ConvertUYVYToNV12Scaled(src, srcPitch, nv12, s.width, nv12 + s.width * s.height, s.width,
+                                s.width, s.height, s.divisor) != 0)
+        return -1;
+    QueryPerformanceCounter(&converted);
+
+    ComScope com;
+    HRESULT hr = s.codec == LiveEncoderCodecJpeg
+        ? EncodeJpeg(e, timestamp)
+        : EncodeH264(e, timestamp, forceKeyframe != 0);
+    QueryPerformanceCounter(&end);
+
+    e->stats.convertUsTotal += (unsigned long long)TicksToMicros(converted.QuadPart - start.QuadPart);
+    e->stats.encodeUsTotal += (unsigned long long)TicksToMicros(end.QuadPart - converted.QuadPart);
+
+    if (FAILED(hr))
+    {
+        e->stats.lastError = hr;
+        return -2;
+    }
+    if (hr == S_FALSE)
+        return 0;
+
+    e->stats.framesIn++;
+    return 1;
+}
+
+MEDIA_KERNELS_API int ReceiveLiveEncoderOutput(void* encoder, void* dst, int dstCapacity,
+                                               int* size, int* keyframe, long long* timestamp)
+{
+    LiveEncoder* e = (LiveEncoder*)encoder;
+    if (!e || !size || dstCapacity < 0 || (!dst && dstCapacity > 0))
+        return -1;
+
+    *size = 0;
+    if (e->events && e->output.empty())
+    {
+        HRESULT hr = PumpEvents(e);
+        if (FAILED(hr))
+            e->stats.lastError = hr;
+    }
+
+    if (e->output.empty())
+        return 0;
+
+    const LivePacket& packet = e->output.front();
+    *size = (int)packet.data.size();
+    if (*size > dstCapacity)
+        return -3;
+
+    memcpy(dst, packet.data.data(), packet.data.size());
+    if (keyframe) *keyframe = packet.keyframe ? 1 : 0;
+    if (timestamp) *timestamp = packet.timestamp;
+
+    e->stats.framesOut++;
+    e->stats.bytesOut += packet.data.size();
+    e->output.pop_front();
+    return 1;
+}
+
+MEDIA_KERNELS_API void DestroyLiveEncoder(void* encoder)
+{
+    LiveEncoder* e = (LiveEncoder*)encoder;
+    if (!e)
+        return;
+
+    ComScope com;
+    Release(e);
+}
+
+MEDIA_KERNELS_API int GetLiveEncoderStats(void* encoder, LiveEncoderStats* stats, int statsSize)
+{
+    LiveEncoder* e = (LiveEncoder*)encoder;
+    if (!e || !stats || statsSize != (int)sizeof(LiveEncoderStats))
+        return 0;
+
+    memcpy(stats, &e->stats, sizeof(LiveEncoderStats));
+    return 1;
+}
+
+} // extern "C"
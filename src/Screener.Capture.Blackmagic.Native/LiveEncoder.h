@@ -0,0 +1,72 @@
+#pragma once
+
+#include "MediaKernels.h"
+
+// In-memory encoder for the live viewer streams (local web viewers, cloud panel). A captured
+// UYVY frame is box-scaled to NV12 by the SIMD kernels and encoded without touching disk:
+// - H.264 through a Media Foundation encoder transform (NVENC, Quick Sync, AMF when present,
+//   Microsoft's software encoder otherwise), emitted as Annex B access units with SPS/PPS on
+//   every keyframe, low-latency CBR, no B-frames;
+// - JPEG through WIC's planar YCbCr encoder, which takes the NV12 planes directly (no RGB
+//   round trip).
+// Send/receive model: SendLiveEncoderFrame submits a frame, ReceiveLiveEncoderOutput returns
+// finished frames one at a time; a hardware encoder may hand a frame back a call later.
+// An encoder is not thread-safe: one caller at a time.
+
+enum LiveEncoderCodec
+{
+    LiveEncoderCodecH264 = 0,
+    LiveEncoderCodecJpeg = 1
+};
+
+struct LiveEncoderSettings
+{
+    int width;              // output size, even
+    int height;
+    int divisor;            // 1, 2 or 4: the source is width * divisor by height * divisor UYVY
+    int frameRateNum;
+    int frameRateDen;
+    int codec;              // LiveEncoderCodec
+    int bitrateKbps;        // H.264 CBR target
+    int gopFrames;          // H.264 keyframe interval; 0 = two seconds
+    int jpegQuality;        // JPEG 1-100
+    int allowHardware;      // H.264: 1 = prefer a hardware encoder MFT
+};
+
+struct LiveEncoderStats
+{
+    unsigned long long framesIn;        // frames accepted by SendLiveEncoderFrame
+    unsigned long long framesOut;       // frames returned by ReceiveLiveEncoderOutput
+    unsigned long long bytesOut;
+    unsigned long long convertUsTotal;  // UYVY -> scaled NV12
+    unsigned long long encodeUsTotal;   // ProcessInput + ProcessOutput, or the WIC encode
+    int hardware;                       // 1 if the H.264 transform is a hardware MFT
+    int lastError;                      // HRESULT of the last failure, 0 if none
+};
+
+extern "C" {
+    // Returns: 1 if the codec can be created on this machine, 0 otherwise
+    MEDIA_KERNELS_API int IsLiveEncoderAvailable(int codec);
+
+    // Returns null on failure with the HRESULT (E_INVALIDARG for bad settings) in *error
+    MEDIA_KERNELS_API void* CreateLiveEncoder(const LiveEncoderSettings* settings, int* error);
+
+    // Scale and encode one frame. timestamp is in 100 ns units. forceKeyframe = 1 asks for an
+    // IDR (e.g. a viewer joined). srcBufferSize must cover the divisor-scaled source area.
+    // Returns: 1 accepted, 0 encoder not ready for input (receive, then retry or drop),
+    //          -1 bad arguments, -2 encode failed (HRESULT in the stats' lastError)
+    MEDIA_KERNELS_API int SendLiveEncoderFrame(void* encoder, const void* src, int srcBufferSize, int srcPitch,
+                                               long long timestamp, int forceKeyframe);
+
+    // Copy the oldest finished frame to dst. *size receives its length, *keyframe 1 for an
+    // IDR / any JPEG, *timestamp the frame's input timestamp.
+    // Returns: 1 frame copied, 0 none ready, -1 bad arguments,
+    //          -3 dst too small (*size = bytes needed; the frame stays queued)
+    MEDIA_KERNELS_API int ReceiveLiveEncoderOutput(void* encoder, void* dst, int dstCapacity,
+                                                   int* size, int* keyframe, long long* timestamp);
+
+    MEDIA_KERNELS_API void DestroyLiveEncoder(void* encoder);
+
+    // Copy the encoder's counters. Returns: 1 on success, 0 on bad arguments
+    MEDIA_KERNELS_API int GetLiveEncoderStats(void* encoder, LiveEncoderStats* stats, int statsSize);
+}
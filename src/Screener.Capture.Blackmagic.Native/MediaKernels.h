@@ -0,0 +1,137 @@
+#pragma once
+
+// General-purpose SIMD media kernels exported from the native DLL.
+// Unlike the DeckLinkFrameHelper.h exports these operate on plain frame buffers,
+// so they can be used from any input path (DeckLink, NDI, SRT, virtual).
+
+#ifdef DECKLINK_NATIVE_EXPORTS
+#define MEDIA_KERNELS_API __declspec(dllexport)
+#else
+#define MEDIA_KERNELS_API __declspec(dllimport)
+#endif
+
+// YUV <-> RGB matrix for the colour converters (studio-range, 8-bit fixed point).
+// Each matrix is a separate template instantiation, so the coefficients are
+// compile-time constants inside the kernels.
+enum ColorMatrix
+{
+    ColorMatrixBt601 = 0,
+    ColorMatrixBt709 = 1
+};
+
+// Source layout for ExtractLumaSad
+enum LumaFormat
+{
+    LumaFormatUyvy = 0,     // 8-bit 4:2:2, rows of width * 2 bytes
+    LumaFormatV210 = 1      // 10-bit 4:2:2, luma rounded to 8 bits
+};
+
+extern "C" {
+    // Returns: SIMD level the kernels dispatch to (0=scalar, 1=SSE4.1, 2=AVX2, 3=AVX-512)
+    MEDIA_KERNELS_API int GetMediaKernelLevel();
+
+    // Check whether a buffer that should hold 8-bit UYVY actually looks like BGRA
+    // (DMA pointer landed on the wrong buffer). Samples 2048 4-byte groups.
+    // buffer: Frame data, bufferSize: bytes available (must cover rowBytes * height)
+    // Returns: 1 if the data looks like BGRA (corrupt), 0 if it looks like UYVY, -1 on bad arguments
+    MEDIA_KERNELS_API int DetectCorruptBGRA(const void* buffer, int bufferSize, int width, int height, int rowBytes);
+
+    // Colour conversion. All converters take pitches in bytes, require an even width,
+    // and dispatch to AVX2 when available (scalar otherwise).
+    // Returns: 0 on success, -1 on bad arguments
+
+    // UYVY (8-bit 4:2:2) -> BGRA
+    MEDIA_KERNELS_API int ConvertUYVYToBGRA(const void* src, int srcPitch, void* dst, int dstPitch,
+                                            int width, int height, int matrix);
+
+    // UYVY -> BGRA at 1/divisor resolution (divisor 2 or 4, nearest-sample decimation).
+    // dstWidth/dstHeight are the output size; source rows are read every divisor rows.
+    MEDIA_KERNELS_API int ConvertUYVYToBGRAScaled(const void* src, int srcPitch, void* dst, int dstPitch,
+                                                  int dstWidth, int dstHeight, int divisor, int matrix);
+
+    // BGRA -> UYVY, chroma from the average of each pixel pair
+    MEDIA_KERNELS_API int ConvertBGRAToUYVY(const void* src, int srcPitch, void* dst, int dstPitch,
+                                            int width, int height, int matrix);
+
+    // UYVY -> NV12 (Y plane + interleaved UV plane, chroma averaged over row pairs)
+    MEDIA_KERNELS_API int ConvertUYVYToNV12(const void* src, int srcPitch,
+                                            void* dstY, int dstYPitch, void* dstUV, int dstUVPitch,
+                                            int width, int height);
+
+    // UYVY -> NV12 at 1/divisor resolution (divisor 1, 2 or 4) with a box filter: each output
+    // sample averages the divisor x divisor source block. dstWidth/dstHeight are the output size;
+    // the source must hold dstWidth * divisor pixels by dstHeight * divisor rows.
+    MEDIA_KERNELS_API int ConvertUYVYToNV12Scaled(const void* src, int srcPitch,
+                                                  void* dstY, int dstYPitch, void* dstUV, int dstUVPitch,
+                                                  int dstWidth, int dstHeight, int divisor);
+
+    // UYVY -> UYVY at half size, each output sample the mean of a 2x2 source block (one level
+    // of the capture preview pyramid). The source must hold dstWidth * 2 by dstHeight * 2 pixels.
+    MEDIA_KERNELS_API int DownscaleUYVYHalf(const void* src, int srcPitch, void* dst, int dstPitch,
+                                            int dstWidth, int dstHeight);
+
+    // NV12 -> UYVY (decoder output to the capture layout). Chroma rows are interpolated
+    // 3:1 between the two nearest 4:2:0 rows.
+    MEDIA_KERNELS_API int ConvertNV12ToUYVY(const void* srcY, int srcYPitch, const void* srcUV, int srcUVPitch,
+                                            void* dst, int dstPitch, int width, int height);
+
+    // v210 (10-bit 4:2:2) -> BGRA. srcPitch must cover the 48-pixel row padding.
+    MEDIA_KERNELS_API int ConvertV210ToBGRA(const void* src, int srcPitch, void* dst, int dstPitch,
+                                            int width, int height, int matrix);
+
+    // v210 -> BGRA at 1/divisor resolution (divisor 2 or 4), same sampling as ConvertUYVYToBGRAScaled.
+    // srcPitch must cover the padded row for dstWidth * divisor source pixels.
+    MEDIA_KERNELS_API int ConvertV210ToBGRAScaled(const void* src, int srcPitch, void* dst, int dstPitch,
+                                                  int dstWidth, int dstHeight, int divisor, int matrix);
+
+    // v210 -> P010 (16-bit Y plane + interleaved UV plane, 10-bit values in the high bits)
+    MEDIA_KERNELS_API int ConvertV210ToP010(const void* src, int srcPitch,
+                                            void* dstY, int dstYPitch, void* dstUV, int dstUVPitch,
+                                            int width, int height);
+
+    // Frame analysis for the auto-cut detectors. Luma planes are tightly packed (pitch = width).
+    // ROIs are half-open pixel rectangles [roiLeft, roiRight) x [roiTop, roiBottom).
+    // Returns: 0 on success, -1 on bad arguments
+
+    // Extract 8-bit luma from a UYVY or v210 frame at dstWidth x dstHeight (dstWidth <= 1920)
+    // by nearest-neighbour sampling (source pixel = dst * src / dst, integer division), and in
+    // the same pass sum |luma - reference| over the ROI into *sad. reference may be null (no SAD).
+    // srcBufferSize must cover srcPitch * (srcHeight - 1) plus one active row.
+    MEDIA_KERNELS_API int ExtractLumaSad(const void* src, int srcBufferSize, int srcPitch,
+                                         int srcWidth, int srcHeight, int format,
+                                         void* dstLuma, int dstWidth, int dstHeight,
+                                         const void* reference, int roiLeft, int roiTop, int roiRight, int roiBottom,
+                                         long long* sad);
+
+    // Sum of absolute differences between two luma planes over the ROI
+    MEDIA_KERNELS_API int ComputeLumaSad(const void* a, const void* b, int width, int height,
+                                         int roiLeft, int roiTop, int roiRight, int roiBottom, long long* sad);
+
+    // Transition blending, byte-wise on any interleaved 8-bit layout (BGRA, UYVY), fixed point:
+    // dst = (x * (256 - w) + y * w) >> 8. dst may alias a source.
+    // Returns: 0 on success, -1 on bad arguments
+
+    // Dissolve: weight (0..256) is the share of b
+    MEDIA_KERNELS_API int BlendFrames(const void* a, const void* b, void* dst, int length, int weight);
+
+    // Fade towards a repeating 4-byte black (0xFF000000 for BGRA, 0x10801080 for UYVY, little
+    // endian). weight (0..256) is the share of src kept. length must be a multiple of 4.
+    MEDIA_KERNELS_API int FadeFrame(const void* src, void* dst, int length, int weight, unsigned int black);
+
+    // Overlay compositing: a pre-rasterised layer in the frame's own 8-bit layout is stored as
+    // premultiplied color bytes plus per-byte inverse alpha (255 = transparent). In place:
+    // frame = sat(((frame * (ia + (ia >> 7))) >> 8) + color) over rows x rowBytes.
+    // Returns: 0 on success, -1 on bad arguments
+    MEDIA_KERNELS_API int CompositeLayer(void* frame, int framePitch, const void* color,
+                                         const void* inverseAlpha, int layerPitch, int rowBytes, int rows);
+
+    // Audio metering in one pass over interleaved little-endian PCM (16- or 32-bit signed,
+    // 1..64 channels); a trailing partial frame is ignored. Each output holds one float per
+    // channel and may be null: rms and peak relative to full scale, and onset = the largest
+    // mean square of any windowFrames window over the block's mean square (1 for a steady
+    // signal, up to frames / windowFrames for an isolated strike, 0 for silence).
+    // windowFrames is rounded up to a multiple of 8 / gcd(channels, 8).
+    // Returns: 0 on success, -1 on bad arguments
+    MEDIA_KERNELS_API int MeasureAudioLevels(const void* samples, int length, int channels, int bitsPerSample,
+                                             int windowFrames, float* rms, float* peak, float* onset);
+}
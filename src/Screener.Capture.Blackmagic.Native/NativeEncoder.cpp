@@ -0,0 +1,660 @@
+#define DECKLINK_NATIVE_EXPORTS
+#include "NativeEncoder.h"
+#include "MediaKernels.h"
+#include "TraceLog.h"
+
+#include <Windows.h>
+#include <mfapi.h>
+#include <mfidl.h>
+#include <mfreadwrite.h>
+#include <mferror.h>
+#include <codecapi.h>
+#include <string.h>
+#include <new>
+#include <vector>
+
+template <typename T>
+static void SafeRelease(T*& p)
+{
+    if (p)
+    {
+        p->Release();
+        p = nullptr;
+    }
+}
+
+// Converted input buffers, recycled instead of allocating a frame-sized buffer per frame.
+// One buffer is shared by every rendition's sample, so it is free again only when the last
+// of those samples is released; each is a tracked sample whose release calls back here.
+// Reference counted, as encoders may still hold samples after their owner is destroyed.
+class InputBufferPool : public IMFAsyncCallback
+{
+public:
+    explicit InputBufferPool(DWORD size) : size_(size) {}
+
+    // A free buffer (or a new one while all are in flight), with the caller's reference
+    IMFMediaBuffer* Acquire()
+    {
+        AcquireSRWLockExclusive(&lock_);
+        for (Entry& entry : entries_)
+        {
+            if (entry.outstanding == 0 && !entry.acquired)
+            {
+                entry.acquired = true;
+                entry.buffer->AddRef();
+                ReleaseSRWLockExclusive(&lock_);
+                return entry.buffer;
+            }
+        }
+        ReleaseSRWLockExclusive(&lock_);
+
+        IMFMediaBuffer* buffer = nullptr;
+        if (FAILED(MFCreateAlignedMemoryBuffer(size_, MF_64_BYTE_ALIGNMENT, &buffer)))
+            return nullptr;
+
+        AcquireSRWLockExclusive(&lock_);
+        Entry entry = { buffer, 0, true };
+        entries_.push_back(entry);
+        buffer->AddRef();
+        ReleaseSRWLockExclusive(&lock_);
+        return buffer;
+    }
+
+    // A sample carrying buffer that will call back when released
+    HRESULT CreateSample(IMFMediaBuffer* buffer, IMFSample** sample)
+    {
+        IMFTrackedSample* tracked = nullptr;
+        HRESULT hr = MFCreateTrackedSample(&tracked);
+        if (FAILED(hr))
+            return hr;
+
+        Track(buffer, 1);
+        AddRef();
+        hr = tracked->SetAllocator(this, buffer);
+        if (FAILED(hr))
+        {
+            Track(buffer, -1);
+            Release();
+        }
+
+        if (SUCCEEDED(hr)) hr = tracked->QueryInterface(IID_PPV_ARGS(sample));
+        if (SUCCEEDED(hr)) hr = (*sample)->AddBuffer(buffer);
+        if (FAILED(hr))
+            SafeRelease(*sample);
+        SafeRelease(tracked);
+        return hr;
+    }
+
+    // The writer's own reference goes back once every sample has been handed out
+    void EndUse(IMFMediaBuffer*& buffer)
+    {
+        AcquireSRWLockExclusive(&lock_);
+        for (Entry& entry : entries_)
+        {
+            if (entry.buffer == buffer)
+                entry.acquired = false;
+        }
+        ReleaseSRWLockExclusive(&lock_);
+        SafeRelease(buffer);
+    }
+
+    STDMETHODIMP QueryInterface(REFIID riid, void** ppv) override
+    {
+        if (!ppv)
+            return E_POINTER;
+        if (riid == __uuidof(IUnknown) || riid == __uuidof(IMFAsyncCallback))
+        {
+            *ppv = static_cast<IMFAsyncCallback*>(this);
+            AddRef();
+            return S_OK;
+        }
+        *ppv = nullptr;
+        return E_NOINTERFACE;
+    }
+
+    STDMETHODIMP_(ULONG) AddRef() override { return InterlockedIncrement(&refs_); }
+
+    STDMETHODIMP_(ULONG) Release() override
+    {
+        ULONG refs = InterlockedDecrement(&refs_);
+        if (refs == 0)
+            delete this;
+        return refs;
+    }
+
+    STDMETHODIMP GetParameters(DWORD*, DWORD*) override { return E_NOTIMPL; }
+
+    // A sample was released: the sample arrives as the result object and is let go for good
+    STDMETHODIMP Invoke(IMFAsyncResult* result) override
+    {
+        IUnknown* state = nullptr;
+        IUnknown* sample = nullptr;
+        if (SUCCEEDED(result->GetState(&state)))
+        {
+            IMFMediaBuffer* buffer = nullptr;
+            if (SUCCEEDED(state->QueryInterface(IID_PPV_ARGS(&buffer))))
+            {
+                Track(buffer, -1);
+                SafeRelease(buffer);
+            }
+            SafeRelease(state);
+        }
+        if (SUCCEEDED(result->GetObject(&sample)))
+            SafeRelease(sample);
+
+        Release();
+        return S_OK;
+    }
+
+private:
+    struct Entry
+    {
+        IMFMediaBuffer* buffer;
+        int outstanding;    // samples still holding the buffer
+        bool acquired;      // being filled and handed out by a write
+    };
+
+    ~InputBufferPool()
+    {
+        for (Entry& entry : entries_)
+            SafeRelease(entry.buffer);
+    }
+
+    void Track(IMFMediaBuffer* buffer, int delta)
+    {
+        AcquireSRWLockExclusive(&lock_);
+        for (Entry& entry : entries_)
+        {
+            if (entry.buffer == buffer)
+                entry.outstanding += delta;
+        }
+        ReleaseSRWLockExclusive(&lock_);
+    }
+
+    volatile LONG refs_ = 1;
+    SRWLOCK lock_ = SRWLOCK_INIT;
+    DWORD size_;
+    std::vector<Entry> entries_;
+};
+
+// The output file's byte stream, passing every write on to a callback as well. Media
+// Foundation's file stream does the I/O; writes are reported at the offset they land on,
+// before an asynchronous write is issued, while the sink still holds its data.
+class TeeByteStream : public IMFByteStream
+{
+public:
+    TeeByteStream(IMFByteStream* inner, NativeEncoderOutputCallback output, void* context)
+        : inner_(inner), output_(output), context_(context)
+    {
+        inner_->AddRef();
+    }
+
+    STDMETHODIMP QueryInterface(REFIID riid, void** ppv) override
+    {
+        if (!ppv)
+            return E_POINTER;
+        if (riid == __uuidof(IUnknown) || riid == __uuidof(IMFByteStream))
+        {
+            *ppv = static_cast<IMFByteStream*>(this);
+            AddRef();
+            return S_OK;
+        }
+        // The sink reads the file stream's attributes (content type) but writes through us
+        if (riid == __uuidof(IMFAttributes))
+            return inner_->QueryInterface(riid, ppv);
+        *ppv = nullptr;
+        return E_NOINTERFACE;
+    }
+
+    STDMETHODIMP_(ULONG) AddRef() override { return InterlockedIncrement(&refs_); }
+
+    STDMETHODIMP_(ULONG) Release() override
+    {
+        ULONG refs = InterlockedDecrement(&refs_);
+        if (refs == 0)
+            delete this;
+        return refs;
+    }
+
+    STDMETHODIMP GetCapabilities(DWORD* capabilities) override { return inner_->GetCapabilities(capabilities); }
+    STDMETHODIMP GetLength(QWORD* length) override { return inner_->GetLength(length); }
+    STDMETHODIMP SetLength(QWORD length) override { return inner_->SetLength(length); }
+    STDMETHODIMP GetCurrentPosition(QWORD* position) override { return inner_->GetCurrentPosition(position); }
+    STDMETHODIMP SetCurrentPosition(QWORD position) override { return inner_->SetCurrentPosition(position); }
+    STDMETHODIMP IsEndOfStream(BOOL* endOfStream) override { return inner_->IsEndOfStream(endOfStream); }
+    STDMETHODIMP Read(BYTE* pb, ULONG cb, ULONG* read) override { return inner_->Read(pb, cb, read); }
+
+    STDMETHODIMP BeginRead(BYTE* pb, ULONG cb, IMFAsyncCallback* callback, IUnknown* state) override
+    {
+        return inner_->BeginRead(pb, cb, callback, state);
+    }
+
+    STDMETHODIMP EndRead(IMFAsyncResult* result, ULONG* read) override { return inner_->EndRead(result, read); }
+
+    STDMETHODIMP Write(const BYTE* pb, ULONG cb, ULONG* written) override
+    {
+        QWORD position = 0;
+        HRESULT hr = inner_->GetCurrentPosition(&position);
+        if (SUCCEEDED(hr)) hr = inner_->Write(pb, cb, written);
+        if (SUCCEEDED(hr))
+            output_(context_, (long long)position, pb, (int)*written);
+        return hr;
+    }
+
+    STDMETHODIMP BeginWrite(const BYTE* pb, ULONG cb, IMFAsyncCallback* callback, IUnknown* state) override
+    {
+        QWORD position = 0;
+        HRESULT hr = inner_->GetCurrentPosition(&position);
+        if (SUCCEEDED(hr))
+            output_(context_, (long long)position, pb, (int)cb);
+        if (SUCCEEDED(hr)) hr = inner_->BeginWrite(pb, cb, callback, state);
+        return hr;
+    }
+
+    STDMETHODIMP EndWrite(IMFAsyncResult* result, ULONG* written) override { return inner_->EndWrite(result, written); }
+
+    STDMETHODIMP Seek(MFBYTESTREAM_SEEK_ORIGIN origin, LONGLONG offset, DWORD flags, QWORD* position) override
+    {
+        return inner_->Seek(origin, offset, flags, position);
+    }
+
+    STDMETHODIMP Flush() override { return inner_->Flush(); }
+    STDMETHODIMP Close() override { return inner_->Close(); }
+
+private:
+    ~TeeByteStream() { SafeRelease(inner_); }
+
+    volatile LONG refs_ = 1;
+    IMFByteStream* inner_;
+    NativeEncoderOutputCallback output_;
+    void* context_;
+};
+
+struct NativeEncoder
+{
+    IMFSinkWriter* writer;
+    InputBufferPool* inputs;    // used when this encoder is first in a write
+    DWORD stream;
+    NativeEncoderSettings settings;
+    int sampleSize;             // NV12 / P010 bytes per frame
+    long long frameDuration;    // 100 ns units
+    long long frameIndex;
+    bool finalized;
+    NativeEncoderStats stats;
+};
+
+static long long TicksToMicros(long long ticks)
+{
+    static LARGE_INTEGER frequency = {};
+    if (frequency.QuadPart == 0)
+        QueryPerformanceFrequency(&frequency);
+    return ticks / frequency.QuadPart * 1000000 + ticks % frequency.QuadPart * 1000000 / frequency.QuadPart;
+}
+
+static int SampleSize(const NativeEncoderSettings& s)
+{
+    // Y plane plus half-height interleaved UV, 1 byte (NV12) or 2 bytes (P010) per sample
+    int bytesPerSample = s.input == NativeEncoderInputV210 ? 2 : 1;
+    return s.width * s.height * 3 / 2 * bytesPerSample;
+}
+
+static bool ValidSettings(const NativeEncoderSettings* s)
+{
+    if (!s || s->width <= 0 || s->height <= 0 || (s->width & 1) || (s->height & 1) ||
+        s->frameRateNum <= 0 || s->frameRateDen <= 0 || s->bitrateKbps <= 0)
+        return false;
+
+    if (s->codec != NativeEncoderCodecH264 && s->codec != NativeEncoderCodecHevc)
+        return false;
+
+    // P010 input needs a 10-bit profile, which MF's H.264 encoders do not have
+    if (s->input == NativeEncoderInputV210)
+        return s->codec == NativeEncoderCodecHevc;
+
+    return s->input == NativeEncoderInputUyvy;
+}
+
+static HRESULT SetVideoType(IMFMediaType* type, const GUID& subtype, const NativeEncoderSettings& s)
+{
+    HRESULT hr = type->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Video);
+    if (SUCCEEDED(hr)) hr = type->SetGUID(MF_MT_SUBTYPE, subtype);
+    if (SUCCEEDED(hr)) hr = type->SetUINT32(MF_MT_INTERLACE_MODE, MFVideoInterlace_Progressive);
+    if (SUCCEEDED(hr)) hr = MFSetAttributeSize(type, MF_MT_FRAME_SIZE, s.width, s.height);
+    if (SUCCEEDED(hr)) hr = MFSetAttributeRatio(type, MF_MT_FRAME_RATE, s.frameRateNum, s.frameRateDen);
+    if (SUCCEEDED(hr)) hr = MFSetAttributeRatio(type, MF_MT_PIXEL_ASPECT_RATIO, 1, 1);
+    return hr;
+}
+
+static HRESULT ConfigureWriter(NativeEncoder* encoder)
+{
+    const NativeEncoderSettings& s = encoder->settings;
+    bool tenBit = s.input == NativeEncoderInputV210;
+
+    IMFMediaType* output = nullptr;
+    IMFMediaType* input = nullptr;
+    IMFAttributes* parameters = nullptr;
+
+    HRESULT hr = MFCreateMediaType(&output);
+    if (SUCCEEDED(hr)) hr = SetVideoType(output, s.codec == NativeEncoderCodecHevc ? MFVideoFormat_HEVC : MFVideoFormat_H264, s);
+    if (SUCCEEDED(hr)) hr = output->SetUINT32(MF_MT_AVG_BITRATE, (UINT32)s.bitrateKbps * 1000);
+    if (SUCCEEDED(hr))
+    {
+        UINT32 profile = s.codec == NativeEncoderCodecHevc
+            ? (tenBit ? eAVEncH265VProfile_Main_420_10 : eAVEncH265VProfile_Main_420_8)
+            : eAVEncH264VProfile_High;
+        hr = output->SetUINT32(MF_MT_MPEG2_PROFILE, profile);
+    }
+    if (SUCCEEDED(hr)) hr = encoder->writer->AddStream(output, &encoder->stream);
+
+    if (SUCCEEDED(hr)) hr = MFCreateMediaType(&input);
+    if (SUCCEEDED(hr)) hr = SetVideoType(input, tenBit ? MFVideoFormat_P010 : MFVideoFormat_NV12, s);
+    if (SUCCEEDED(hr)) hr = input->SetUINT32(MF_MT_DEFAULT_STRIDE, (UINT32)(s.width * (tenBit ? 2 : 1)));
+
+    // Encoder settings go through ICodecAPI; vendors ignore the ones they do not support
+    if (SUCCEEDED(hr)) hr = MFCreateAttributes(&parameters, 4);
+    if (SUCCEEDED(hr))
+    {
+        int gop = s.gopFrames > 0 ? s.gopFrames : (s.frameRateNum + s.frameRateDen - 1) / s.frameRateDen;
+        int peak = s.maxBitrateKbps > 0 ? s.maxBitrateKbps : s.bitrateKbps * 3 / 2;
+        parameters->SetUINT32(CODECAPI_AVEncCommonRateControlMode, eAVEncCommonRateControlMode_PeakConstrainedVBR);
+        parameters->SetUINT32(CODECAPI_AVEncCommonMeanBitRate, (UINT32)s.bitrateKbps * 1000);
+        parameters->SetUINT32(CODECAPI_AVEncCommonMaxBitRate, (UINT32)peak * 1000);
+        parameters->SetUINT32(CODECAPI_AVEncMPVGOPSize, (UINT32)gop);
+        hr = encoder->writer->SetInputMediaType(encoder->stream, input, parameters);
+    }
+
+    if (SUCCEEDED(hr)) hr = encoder->writer->BeginWriting();
+
+    SafeRelease(parameters);
+    SafeRelease(input);
+    SafeRelease(output);
+    return hr;
+}
+
+// Whether MF resolved the stream's encoder to a hardware MFT
+static int UsesHardwareTransform(NativeEncoder* encoder)
+{
+    IMFSinkWriterEx* writerEx = nullptr;
+    if (FAILED(encoder->writer->QueryInterface(IID_PPV_ARGS(&writerEx))))
+        return 0;
+
+    int hardware = 0;
+    GUID category;
+    IMFTransform* transform = nullptr;
+    for (DWORD i = 0; SUCCEEDED(writerEx->GetTransformForStream(encoder->stream, i, &category, &transform)); i++)
+    {
+        if (category == MFT_CATEGORY_VIDEO_ENCODER)
+        {
+            IMFAttributes* attributes = nullptr;
+            UINT32 length = 0;
+            if (SUCCEEDED(transform->GetAttributes(&attributes)) &&
+                SUCCEEDED(attributes->GetStringLength(MFT_ENUM_HARDWARE_URL_Attribute, &length)))
+                hardware = 1;
+            SafeRelease(attributes);
+        }
+        SafeRelease(transform);
+    }
+
+    SafeRelease(writerEx);
+    return hardware;
+}
+
+// Convert src into a pooled buffer in the encoders' shared input format
+static IMFMediaBuffer* CreateInputBuffer(const NativeEncoder* e, const void* src, int srcPitch)
+{
+    const NativeEncoderSettings& s = e->settings;
+    IMFMediaBuffer* buffer = e->inputs->Acquire();
+
+    HRESULT hr = buffer ? S_OK : E_OUTOFMEMORY;
+    if (SUCCEEDED(hr))
+    {
+        BYTE* dst = nullptr;
+        hr = buffer->Lock(&dst, nullptr, nullptr);
+        if (SUCCEEDED(hr))
+        {
+            int result;
+            if (s.input == NativeEncoderInputV210)
+            {
+                int pitch = s.width * 2;
+                result = ConvertV210ToP010(src, srcPitch, dst, pitch, dst + pitch * s.height, pitch, s.width, s.height);
+            }
+            else
+            {
+                result = ConvertUYVYToNV12(src, srcPitch, dst, s.width, dst + s.width * s.height, s.width, s.width, s.height);
+            }
+
+            buffer->Unlock();
+            hr = result == 0 ? buffer->SetCurrentLength(e->sampleSize) : E_FAIL;
+        }
+    }
+
+    if (FAILED(hr) && buffer)
+        e->inputs->EndUse(buffer);
+    return buffer;
+}
+
+extern "C" {
+
+MEDIA_KERNELS_API int IsNativeEncoderAvailable()
+{
+    if (FAILED(MFStartup(MF_VERSION, MFSTARTUP_LITE)))
+        return 0;
+
+    MFT_REGISTER_TYPE_INFO outputType = { MFMediaType_Video, MFVideoFormat_H264 };
+    IMFActivate** activates = nullptr;
+    UINT32 count = 0;
+    HRESULT hr = MFTEnumEx(MFT_CATEGORY_VIDEO_ENCODER, MFT_ENUM_FLAG_SYNCMFT | MFT_ENUM_FLAG_ASYNCMFT | MFT_ENUM_FLAG_HARDWARE,
+                           nullptr, &outputType, &activates, &count);
+    if (SUCCEEDED(hr))
+    {
+        for (UINT32 i = 0; i < count; i++)
+            activates[i]->Release();
+        CoTaskMemFree(activates);
+    }
+
+    MFShutdown();
+    return SUCCEEDED(hr) && count > 0 ? 1 : 0;
+}
+
+MEDIA_KERNELS_API void* CreateNativeEncoder(const wchar_t* path, const NativeEncoderSettings* settings,
+                                            NativeEncoderOutputCallback output, void* outputContext, int* error)
+{
+    if (error) *error = 0;
+    if (!path || !ValidSettings(settings) || (output && !settings->fragmented))
+    {
+        if (error) *error = E_INVALIDARG;
+        return nullptr;
+    }
+
+    HRESULT hr = MFStartup(MF_VERSION, MFSTARTUP_LITE);
+    if (FAILED(hr))
+    {
+        if (error) *error = hr;
+        return nullptr;
+    }
+
+    NativeEncoder* encoder = new (std::nothrow) NativeEncoder();
+    if (!encoder)
+    {
+        MFShutdown();
+        if (error) *error = E_OUTOFMEMORY;
+        return nullptr;
+    }
+
+    encoder->settings = *settings;
+    encoder->sampleSize = SampleSize(*settings);
+    encoder->frameDuration = 10000000LL * settings->frameRateDen / settings->frameRateNum;
+    encoder->inputs = new (std::nothrow) InputBufferPool((DWORD)encoder->sampleSize);
+
+    IMFAttributes* attributes = nullptr;
+    IMFByteStream* file = nullptr;
+    IMFByteStream* tee = nullptr;
+    hr = encoder->inputs ? S_OK : E_OUTOFMEMORY;
+    if (SUCCEEDED(hr)) hr = MFCreateAttributes(&attributes, 3);
+    if (SUCCEEDED(hr)) hr = attributes->SetUINT32(MF_READWRITE_ENABLE_HARDWARE_TRANSFORMS, settings->allowHardware ? TRUE : FALSE);
+    if (SUCCEEDED(hr)) hr = attributes->SetGUID(MF_TRANSCODE_CONTAINERTYPE,
+                                                settings->fragmented ? MFTranscodeContainerType_FMPEG4 : MFTranscodeContainerType_MPEG4);
+    if (output)
+    {
+        // The container comes from the attributes, so the writer needs no URL with a stream
+        if (SUCCEEDED(hr)) hr = MFCreateFile(MF_ACCESSMODE_READWRITE, MF_OPENMODE_DELETE_IF_EXIST, MF_FILEFLAGS_NONE, path, &file);
+        if (SUCCEEDED(hr))
+        {
+            tee = new (std::nothrow) TeeByteStream(file, output, outputContext);
+            hr = tee ? S_OK : E_OUTOFMEMORY;
+        }
+        if (SUCCEEDED(hr)) hr = MFCreateSinkWriterFromURL(nullptr, tee, attributes, &encoder->writer);
+    }
+    else if (SUCCEEDED(hr))
+    {
+        hr = MFCreateSinkWriterFromURL(path, nullptr, attributes, &encoder->writer);
+    }
+    if (SUCCEEDED(hr)) hr = ConfigureWriter(encoder);
+    SafeRelease(tee);
+    SafeRelease(file);
+    SafeRelease(attributes);
+
+    if (FAILED(hr))
+    {
+        TRACE(TraceLevelError, "CreateNativeEncoder %dx%d codec=%d input=%d failed: 0x%08X",
+              settings->width, settings->height, settings->codec, settings->input, (unsigned)hr);
+        SafeRelease(encoder->writer);
+        SafeRelease(encoder->inputs);
+        delete encoder;
+        MFShutdown();
+        if (error) *error = hr;
+        return nullptr;
+    }
+
+    encoder->stats.hardware = UsesHardwareTransform(encoder);
+    TRACE(TraceLevelInfo, "CreateNativeEncoder %dx%d codec=%d input=%d %d kbps hardware=%d output=%d",
+          settings->width, settings->height, settings->codec, settings->input, settings->bitrateKbps, encoder->stats.hardware,
+          output ? 1 : 0);
+    return encoder;
+}
+
+MEDIA_KERNELS_API int WriteNativeEncoderFrame(void* const* encoders, int count,
+                                              const void* src, int srcBufferSize, int srcPitch, int* results)
+{
+    if (!encoders || count <= 0 || !src || srcPitch <= 0 || !encoders[0])
+        return -1;
+
+    const NativeEncoder* first = (const NativeEncoder*)encoders[0];
+    const NativeEncoderSettings& s = first->settings;
+    for (int i = 1; i < count; i++)
+    {
+        const NativeEncoder* e = (const NativeEncoder*)encoders[i];
+        if (!e || e->settings.width != s.width || e->settings.height != s.height || e->settings.input != s.input)
+            return -1;
+    }
+
+    // v210 rows are padded to 48-pixel groups, which the converter reads whole
+    int activeRowBytes = s.input == NativeEncoderInputV210 ? (s.width + 47) / 48 * 128 : s.width * 2;
+    if (srcPitch < activeRowBytes || (long long)srcPitch * (s.height - 1) + activeRowBytes > srcBufferSize)
+        return -1;
+
+    // One conversion for every rendition: encoders only read their input, so the buffer is
+    // shared and each writer gets its own sample (writers queue samples with their timestamps).
+    // The buffer is reused once the encoders have released every sample holding it.
+    LARGE_INTEGER start, converted, end;
+    QueryPerformanceCounter(&start);
+    IMFMediaBuffer* buffer = CreateInputBuffer(first, src, srcPitch);
+    QueryPerformanceCounter(&converted);
+
+    unsigned long long convertUs = (unsigned long long)TicksToMicros(converted.QuadPart - start.QuadPart);
+    int accepted = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        NativeEncoder* e = (NativeEncoder*)encoders[i];
+        if (results)
+            results[i] = 0;
+        if (e->finalized)
+            continue;
+
+        if (!buffer)
+        {
+            e->stats.framesFailed++;
+            e->stats.lastError = E_FAIL;
+            continue;
+        }
+
+        // Each writer has its own timeline, so a rendition added mid-session starts at zero
+        IMFSample* sample = nullptr;
+        HRESULT hr = first->inputs->CreateSample(buffer, &sample);
+        if (SUCCEEDED(hr)) hr = sample->SetSampleTime(e->frameIndex * e->frameDuration);
+        if (SUCCEEDED(hr)) hr = sample->SetSampleDuration(e->frameDuration);
+
+        LARGE_INTEGER writeStart;
+        QueryPerformanceCounter(&writeStart);
+        if (SUCCEEDED(hr)) hr = e->writer->WriteSample(e->stream, sample);
+        QueryPerformanceCounter(&end);
+        SafeRelease(sample);
+
+        unsigned long long writeUs = (unsigned long long)TicksToMicros(end.QuadPart - writeStart.QuadPart);
+        e->stats.convertUsTotal += convertUs;
+        e->stats.writeUsTotal += writeUs;
+        if (writeUs > e->stats.writeUsMax)
+            e->stats.writeUsMax = writeUs;
+
+        if (SUCCEEDED(hr))
+        {
+            e->frameIndex++;
+            e->stats.framesWritten++;
+            accepted++;
+            if (results)
+                results[i] = 1;
+        }
+        else
+        {
+            e->stats.framesFailed++;
+            e->stats.lastError = hr;
+        }
+    }
+
+    if (buffer)
+        first->inputs->EndUse(buffer);
+    return accepted;
+}
+
+MEDIA_KERNELS_API int FinalizeNativeEncoder(void* encoder)
+{
+    NativeEncoder* e = (NativeEncoder*)encoder;
+    if (!e)
+        return E_INVALIDARG;
+    if (e->finalized)
+        return 0;
+
+    e->finalized = true;
+    HRESULT hr = e->writer->Finalize();
+    if (FAILED(hr))
+    {
+        e->stats.lastError = hr;
+        TRACE(TraceLevelError, "FinalizeNativeEncoder failed: 0x%08X", (unsigned)hr);
+    }
+    return SUCCEEDED(hr) ? 0 : hr;
+}
+
+MEDIA_KERNELS_API void DestroyNativeEncoder(void* encoder)
+{
+    NativeEncoder* e = (NativeEncoder*)encoder;
+    if (!e)
+        return;
+
+    SafeRelease(e->writer);
+    SafeRelease(e->inputs);
+    delete e;
+    MFShutdown();
+}
+
+MEDIA_KERNELS_API int GetNativeEncoderStats(void* encoder, NativeEncoderStats* stats, int statsSize)
+{
+    NativeEncoder* e = (NativeEncoder*)encoder;
+    if (!e || !stats || statsSize != (int)sizeof(NativeEncoderStats))
+        return 0;
+
+    memcpy(stats, &e->stats, sizeof(NativeEncoderStats));
+    return 1;
+}
+
+} // extern "C"
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "MediaKernels.h"
+
+// In-process H.264/HEVC encoder on Media Foundation's sink writer. With hardware transforms
+// enabled MF picks the GPU vendor's encoder MFT (NVENC, Quick Sync, AMF), so frames go from
+// the capture ring through one SIMD conversion straight into the encoder, with no external
+// process or pipe. Output is MP4 (optionally fragmented), video only.
+
+// Receives every write the sink writer makes to the output file, at its file offset, on the
+// writer's thread. The data is only valid for the call. Used to remux the fragments into a
+// replay buffer as they are written, without reading the file back.
+typedef void (__cdecl *NativeEncoderOutputCallback)(void* context, long long position, const void* data, int length);
+
+enum NativeEncoderCodec
+{
+    NativeEncoderCodecH264 = 0,
+    NativeEncoderCodecHevc = 1
+};
+
+// Capture layout handed to WriteNativeEncoderFrame; converted to NV12 / P010 natively
+enum NativeEncoderInput
+{
+    NativeEncoderInputUyvy = 0,     // 8-bit 4:2:2 -> NV12
+    NativeEncoderInputV210 = 1      // 10-bit 4:2:2 -> P010 (HEVC Main10 only)
+};
+
+struct NativeEncoderSettings
+{
+    int width;              // even
+    int height;             // even
+    int frameRateNum;
+    int frameRateDen;
+    int codec;              // NativeEncoderCodec
+    int input;              // NativeEncoderInput
+    int bitrateKbps;        // mean bitrate
+    int maxBitrateKbps;     // peak for constrained VBR; 0 = mean * 1.5
+    int gopFrames;          // keyframe interval; 0 = one second
+    int allowHardware;      // 1 = let MF use hardware encoder MFTs, 0 = Microsoft software encoder
+    int fragmented;         // 1 = fragmented MP4 (readable while growing)
+};
+
+struct NativeEncoderStats
+{
+    unsigned long long framesWritten;   // samples accepted by the sink writer
+    unsigned long long framesFailed;    // conversions or WriteSample calls that failed
+    unsigned long long convertUsTotal;  // UYVY/v210 -> NV12/P010 into the sample buffer
+    unsigned long long writeUsTotal;    // WriteSample, including throttling by a busy encoder
+    unsigned long long writeUsMax;
+    int hardware;                       // 1 if the encoder MFT is a hardware transform
+    int lastError;                      // HRESULT of the last failure, 0 if none
+};
+
+extern "C" {
+    // Returns: 1 if Media Foundation and an H.264 encoder transform are present, 0 otherwise
+    MEDIA_KERNELS_API int IsNativeEncoderAvailable();
+
+    // Create an encoder writing to path (UTF-16). output (may be null) sees every write to the
+    // file and needs fragmented MP4, as a plain MP4 has no index until it is finalized.
+    // Returns null on failure with the HRESULT (or E_INVALIDARG for bad settings) in *error.
+    MEDIA_KERNELS_API void* CreateNativeEncoder(const wchar_t* path, const NativeEncoderSettings* settings,
+                                                NativeEncoderOutputCallback output, void* outputContext, int* error);
+
+    // Convert one captured frame once and submit it to every encoder in encoders[0..count).
+    // All encoders must share width, height and input format. Sample times advance by one
+    // frame per call. srcBufferSize must cover srcPitch * (height - 1) plus one active row.
+    // Blocks while an encoder's input queue is full (sink writer throttling).
+    // results (may be null) receives 1 per encoder that accepted the frame, 0 otherwise.
+    // Returns: number of encoders that accepted the frame, -1 on bad arguments
+    MEDIA_KERNELS_API int WriteNativeEncoderFrame(void* const* encoders, int count,
+                                                  const void* src, int srcBufferSize, int srcPitch, int* results);
+
+    // Drain the encoder and write the MP4 index. Returns: 0 on success, the HRESULT otherwise
+    MEDIA_KERNELS_API int FinalizeNativeEncoder(void* encoder);
+
+    // Destroy an encoder created by CreateNativeEncoder (after FinalizeNativeEncoder, or to abandon it)
+    MEDIA_KERNELS_API void DestroyNativeEncoder(void* encoder);
+
+    // Copy the encoder's counters. Returns: 1 on success, 0 on bad arguments
+    MEDIA_KERNELS_API int GetNativeEncoderStats(void* encoder, NativeEncoderStats* stats, int statsSize);
+}
@@ -0,0 +1,1023 @@
+#define DECKLINK_NATIVE_EXPORTS
+#include "SrtReceiver.h"
+#include "MediaKernels.h"
+#include "TraceLog.h"
+
+#include <winsock2.h>
+#include <Windows.h>
+#include <d3d11_4.h>
+#include <mfapi.h>
+#include <mfidl.h>
+#include <mftransform.h>
+#include <mferror.h>
+#include <stdlib.h>
+#include <string.h>
+#include <deque>
+#include <new>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// libsrt
+// ---------------------------------------------------------------------------
+
+// The part of libsrt's C API (srt.h) the listener uses. srt.dll is loaded on first use, so
+// the DLL has no link-time dependency on it and SRT input is simply unavailable without it.
+// srt_startup is called once and never balanced: the library stays loaded with the process.
+typedef int SRTSOCKET;
+
+static const SRTSOCKET SrtInvalidSocket = -1;
+
+// SRT_SOCKOPT
+static const int SrtoRcvSyn = 2;
+static const int SrtoRcvTimeo = 14;
+static const int SrtoLatency = 23;
+static const int SrtoTransType = 50;
+static const int SrttLive = 0;
+
+// SRT_ERRNO: nothing to accept or read yet (non-blocking), or a blocking read timed out
+static const int SrtErrAsyncRcv = 6002;
+static const int SrtErrTimeout = 6003;
+
+// Live mode delivers one message of up to seven 188-byte TS packets per read
+static const int SrtMessageSize = 1500;
+static const int TsPacketSize = 188;
+
+// Blocking reads return this often so ReceiveSrtFrame can honour its timeout
+static const int RecvPollMs = 20;
+
+struct SrtApi
+{
+    int (*startup)();
+    SRTSOCKET (*createSocket)();
+    int (*setSockFlag)(SRTSOCKET, int, const void*, int);
+    int (*bind)(SRTSOCKET, const sockaddr*, int);
+    int (*listen)(SRTSOCKET, int);
+    SRTSOCKET (*accept)(SRTSOCKET, sockaddr*, int*);
+    int (*recvMsg)(SRTSOCKET, char*, int);
+    int (*close)(SRTSOCKET);
+    int (*getLastError)(int*);
+    const char* (*getLastErrorStr)();
+};
+
+static SrtApi g_srt;
+static bool g_srtLoaded;
+static INIT_ONCE g_srtOnce = INIT_ONCE_STATIC_INIT;
+
+template <typename T>
+static bool Resolve(HMODULE module, const char* name, T& function)
+{
+    function = reinterpret_cast<T>(GetProcAddress(module, name));
+    return function != nullptr;
+}
+
+static BOOL CALLBACK LoadSrtApi(PINIT_ONCE, PVOID, PVOID*)
+{
+    HMODULE module = LoadLibraryW(L"srt.dll");
+    if (!module)
+        module = LoadLibraryW(L"libsrt.dll");
+    if (!module)
+    {
+        TRACE(TraceLevelInfo, "SRT receiver: srt.dll not found (error %lu)", GetLastError());
+        return TRUE;
+    }
+
+    bool resolved = Resolve(module, "srt_startup", g_srt.startup) &&
+                    Resolve(module, "srt_create_socket", g_srt.createSocket) &&
+                    Resolve(module, "srt_setsockflag", g_srt.setSockFlag) &&
+                    Resolve(module, "srt_bind", g_srt.bind) &&
+                    Resolve(module, "srt_listen", g_srt.listen) &&
+                    Resolve(module, "srt_accept", g_srt.accept) &&
+                    Resolve(module, "srt_recvmsg", g_srt.recvMsg) &&
+                    Resolve(module, "srt_close", g_srt.close) &&
+                    Resolve(module, "srt_getlasterror", g_srt.getLastError) &&
+                    Resolve(module, "srt_getlasterror_str", g_srt.getLastErrorStr);
+
+    if (!resolved || g_srt.startup() < 0)
+    {
+        TRACE(TraceLevelError, "SRT receiver: srt.dll is missing exports or failed to start");
+        FreeLibrary(module);
+        return TRUE;
+    }
+
+    g_srtLoaded = true;
+    return TRUE;
+}
+
+static bool SrtLoaded()
+{
+    InitOnceExecuteOnce(&g_srtOnce, LoadSrtApi, nullptr, nullptr);
+    return g_srtLoaded;
+}
+
+// ---------------------------------------------------------------------------
+// Receiver
+// ---------------------------------------------------------------------------
+
+struct AccessUnit
+{
+    std::vector<unsigned char> data;
+    long long pts;              // 90 kHz, -1 if the PES had none
+};
+
+// MPEG-TS state for the first video stream of the first program
+struct TsDemuxer
+{
+    int pmtPid;
+    int videoPid;
+    int codec;                  // SrtReceiverCodec
+    int continuity;             // last continuity counter on the video PID, -1 = none yet
+    std::vector<unsigned char> pes;
+    size_t pesExpected;         // PES_packet_length + 6, 0 = unbounded (ends at the next start)
+};
+
+struct SrtReceiver
+{
+    SrtReceiverSettings settings;
+    SRTSOCKET listener;
+    SRTSOCKET connection;
+    bool mfStarted;
+
+    TsDemuxer demux;
+    std::deque<AccessUnit> units;
+    std::vector<unsigned char> message;
+
+    // DXVA
+    ID3D11Device* device;
+    IMFDXGIDeviceManager* deviceManager;
+    UINT resetToken;
+
+    // Decoder
+    IMFTransform* decoder;
+    int decoderCodec;
+    DWORD inputId;
+    DWORD outputId;
+    bool providesSamples;
+    DWORD outputBufferSize;
+    int codedHeight;            // allocated rows: the UV plane starts this many rows in
+    int stride;                 // for buffers without IMF2DBuffer
+    int cropX;
+    int cropY;
+    int width;                  // display aperture
+    int height;
+    int frameRateNum;
+    int frameRateDen;
+    IMFSample* pending;         // decoded, not yet delivered
+    long long firstPts;         // -1 until the first timed access unit
+
+    SrtReceiverStats stats;
+};
+
+template <typename T>
+static void SafeRelease(T*& p)
+{
+    if (p)
+    {
+        p->Release();
+        p = nullptr;
+    }
+}
+
+static long long TicksToMicros(long long ticks)
+{
+    static LARGE_INTEGER frequency = {};
+    if (frequency.QuadPart == 0)
+        QueryPerformanceFrequency(&frequency);
+    return ticks / frequency.QuadPart * 1000000 + ticks % frequency.QuadPart * 1000000 / frequency.QuadPart;
+}
+
+// COM for the calling thread, balanced per call: callers come from the .NET thread pool
+struct ComScope
+{
+    HRESULT hr;
+    ComScope() : hr(CoInitializeEx(nullptr, COINIT_MULTITHREADED)) {}
+    ~ComScope() { if (SUCCEEDED(hr)) CoUninitialize(); }
+};
+
+static int SrtLastError()
+{
+    int error = g_srt.getLastError(nullptr);
+    return error > 0 ? error : 1;
+}
+
+// ---------------------------------------------------------------------------
+// MPEG-TS demux
+// ---------------------------------------------------------------------------
+
+static void ResetDemuxer(TsDemuxer& d)
+{
+    d.pmtPid = -1;
+    d.videoPid = -1;
+    d.codec = SrtReceiverCodecNone;
+    d.continuity = -1;
+    d.pes.clear();
+    d.pesExpected = 0;
+}
+
+// Start of a PSI section in a payload that begins one (pointer_field first)
+static const unsigned char* SectionStart(const unsigned char* payload, int length, int* sectionLength)
+{
+    if (length < 1 || 1 + payload[0] + 3 > length)
+        return nullptr;
+
+    const unsigned char* section = payload + 1 + payload[0];
+    int available = (int)(payload + length - section);
+    *sectionLength = ((section[1] & 0x0F) << 8) | section[2];
+    if (3 + *sectionLength > available)
+        return nullptr;     // spans packets; the tables repeat, wait for a compact copy
+    return section;
+}
+
+static void ParsePat(TsDemuxer& d, const unsigned char* payload, int length)
+{
+    int sectionLength;
+    const unsigned char* s = SectionStart(payload, length, &sectionLength);
+    if (!s || s[0] != 0x00)
+        return;
+
+    // Program entries run from byte 8 to the CRC
+    for (int i = 8; i + 4 <= 3 + sectionLength - 4; i += 4)
+    {
+        int program = (s[i] << 8) | s[i + 1];
+        if (program != 0)
+        {
+            d.pmtPid = ((s[i + 2] & 0x1F) << 8) | s[i + 3];
+            return;
+        }
+    }
+}
+
+static void ParsePmt(TsDemuxer& d, const unsigned char* payload, int length)
+{
+    int sectionLength;
+    const unsigned char* s = SectionStart(payload, length, &sectionLength);
+    if (!s || s[0] != 0x02 || sectionLength < 13)
+        return;
+
+    int end = 3 + sectionLength - 4;
+    int i = 12 + (((s[10] & 0x0F) << 8) | s[11]);
+    while (i + 5 <= end)
+    {
+        int streamType = s[i];
+        int pid = ((s[i + 1] & 0x1F) << 8) | s[i + 2];
+        int codec = streamType == 0x1B ? SrtReceiverCodecH264
+                  : streamType == 0x24 ? SrtReceiverCodecHevc
+                  : SrtReceiverCodecNone;
+        if (codec != SrtReceiverCodecNone)
+        {
+            if (pid != d.videoPid)
+            {
+                d.videoPid = pid;
+                d.continuity = -1;
+                d.pes.clear();
+            }
+            d.codec = codec;
+            return;
+        }
+        i += 5 + (((s[i + 3] & 0x0F) << 8) | s[i + 4]);
+    }
+}
+
+// Queue the buffered PES payload (one access unit) for the decoder
+static void FinishPes(SrtReceiver* r)
+{
+    TsDemuxer& d = r->demux;
+    const std::vector<unsigned char>& p = d.pes;
+
+    if (p.size() >= 9 && p[0] == 0 && p[1] == 0 && p[2] == 1)
+    {
+        size_t start = 9 + (size_t)p[8];
+        if (start < p.size())
+        {
+            AccessUnit unit;
+            unit.pts = -1;
+            if ((p[7] & 0x80) && p.size() >= 14)
+            {
+                unit.pts = ((long long)(p[9] & 0x0E) << 29) | ((long long)p[10] << 22) |
+                           ((long long)(p[11] & 0xFE) << 14) | ((long long)p[12] << 7) | (p[13] >> 1);
+            }
+            unit.data.assign(p.begin() + start, p.end());
+            r->units.push_back(std::move(unit));
+        }
+    }
+
+    d.pes.clear();
+    d.pesExpected = 0;
+}
+
+static void DemuxPacket(SrtReceiver* r, const unsigned char* packet)
+{
+    TsDemuxer& d = r->demux;
+
+    bool unitStart = (packet[1] & 0x40) != 0;
+    int pid = ((packet[1] & 0x1F) << 8) | packet[2];
+    int adaptation = (packet[3] >> 4) & 3;
+    int continuity = packet[3] & 0x0F;
+    if (!(adaptation & 1))
+        return;     // no payload
+
+    int offset = 4;
+    if (adaptation & 2)
+        offset += 1 + packet[4];
+    if (offset >= TsPacketSize)
+        return;
+
+    const unsigned char* payload = packet + offset;
+    int length = TsPacketSize - offset;
+
+    if (pid == 0)
+    {
+        if (unitStart)
+            ParsePat(d, payload, length);
+        return;
+    }
+    if (pid == d.pmtPid)
+    {
+        if (unitStart)
+            ParsePmt(d, payload, length);
+        return;
+    }
+    if (pid != d.videoPid)
+        return;
+
+    if (d.continuity >= 0 && continuity != ((d.continuity + 1) & 0x0F) && continuity != d.continuity)
+        r->stats.continuityErrors++;
+    d.continuity = continuity;
+
+    if (unitStart)
+    {
+        if (!d.pes.empty())
+            FinishPes(r);
+        if (length >= 6 && payload[0] == 0 && payload[1] == 0 && payload[2] == 1)
+        {
+            size_t packetLength = ((size_t)payload[4] << 8) | payload[5];
+            d.pesExpected = packetLength > 0 ? packetLength + 6 : 0;
+        }
+    }
+    else if (d.pes.empty())
+    {
+        return;     // joined mid-PES: wait for the next start
+    }
+
+    d.pes.insert(d.pes.end(), payload, payload + length);
+
+    // A bounded PES is complete without waiting for the next one
+    if (d.pesExpected > 0 && d.pes.size() >= d.pesExpected)
+    {
+        d.pes.resize(d.pesExpected);
+        FinishPes(r);
+    }
+}
+
+static void DemuxMessage(SrtReceiver* r, const unsigned char* data, int length)
+{
+    int i = 0;
+    while (i + TsPacketSize <= length)
+    {
+        if (data[i] != 0x47)
+        {
+            i++;    // resync on the next sync byte
+            continue;
+        }
+        DemuxPacket(r, data + i);
+        i += TsPacketSize;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Decoder (Media Foundation transform, DXVA through a D3D11 device manager)
+// ---------------------------------------------------------------------------
+
+static HRESULT CreateDeviceManager(SrtReceiver* r)
+{
+    UINT flags = D3D11_CREATE_DEVICE_VIDEO_SUPPORT | D3D11_CREATE_DEVICE_BGRA_SUPPORT;
+    HRESULT hr = D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr, flags, nullptr, 0,
+                                   D3D11_SDK_VERSION, &r->device, nullptr, nullptr);
+
+    // The decoder and our Lock2D readback use the immediate context from different calls
+    ID3D11Multithread* multithread = nullptr;
+    if (SUCCEEDED(hr) && SUCCEEDED(r->device->QueryInterface(IID_PPV_ARGS(&multithread))))
+    {
+        multithread->SetMultithreadProtected(TRUE);
+        SafeRelease(multithread);
+    }
+
+    if (SUCCEEDED(hr)) hr = MFCreateDXGIDeviceManager(&r->resetToken, &r->deviceManager);
+    if (SUCCEEDED(hr)) hr = r->deviceManager->ResetDevice(r->device, r->resetToken);
+
+    if (FAILED(hr))
+    {
+        SafeRelease(r->deviceManager);
+        SafeRelease(r->device);
+    }
+    return hr;
+}
+
+static void ReleaseDecoder(SrtReceiver* r)
+{
+    SafeRelease(r->pending);
+    if (r->decoder)
+    {
+        r->decoder->ProcessMessage(MFT_MESSAGE_NOTIFY_END_STREAMING, 0);
+        if (r->deviceManager)
+            r->decoder->ProcessMessage(MFT_MESSAGE_SET_D3D_MANAGER, 0);
+    }
+    SafeRelease(r->decoder);
+    r->decoderCodec = SrtReceiverCodecNone;
+    r->stats.hardware = 0;
+    r->width = 0;
+    r->height = 0;
+}
+
+// Pick NV12 from what the decoder offers and read the frame geometry
+static HRESULT SelectOutputType(SrtReceiver* r)
+{
+    HRESULT hr = S_OK;
+    for (DWORD i = 0; ; i++)
+    {
+        IMFMediaType* type = nullptr;
+        hr = r->decoder->GetOutputAvailableType(r->outputId, i, &type);
+        if (FAILED(hr))
+            return hr;
+
+        GUID subtype = GUID_NULL;
+        if (SUCCEEDED(type->GetGUID(MF_MT_SUBTYPE, &subtype)) && IsEqualGUID(subtype, MFVideoFormat_NV12))
+        {
+            hr = r->decoder->SetOutputType(r->outputId, type, 0);
+            if (SUCCEEDED(hr))
+            {
+                UINT32 codedWidth = 0, codedHeight = 0;
+                MFGetAttributeSize(type, MF_MT_FRAME_SIZE, &codedWidth, &codedHeight);
+                r->codedHeight = (int)codedHeight;
+                r->stride = (int)MFGetAttributeUINT32(type, MF_MT_DEFAULT_STRIDE, codedWidth);
+                r->cropX = 0;
+                r->cropY = 0;
+                r->width = (int)codedWidth;
+                r->height = (int)codedHeight;
+
+                // 1080p is coded as 1088 rows; the aperture says what to show
+                MFVideoArea area = {};
+                if (SUCCEEDED(type->GetBlob(MF_MT_MINIMUM_DISPLAY_APERTURE, (UINT8*)&area, sizeof(area), nullptr)) &&
+                    area.Area.cx > 0 && area.Area.cy > 0)
+                {
+                    r->cropX = area.OffsetX.value & ~1;
+                    r->cropY = area.OffsetY.value & ~1;
+                    r->width = (int)area.Area.cx;
+                    r->height = (int)area.Area.cy;
+                }
+                r->width &= ~1;
+
+                UINT32 rateNum = 0, rateDen = 0;
+                if (FAILED(MFGetAttributeRatio(type, MF_MT_FRAME_RATE, &rateNum, &rateDen)) || rateDen == 0)
+                    rateNum = rateDen = 0;
+                r->frameRateNum = (int)rateNum;
+                r->frameRateDen = (int)rateDen;
+
+                MFT_OUTPUT_STREAM_INFO info = {};
+                hr = r->decoder->GetOutputStreamInfo(r->outputId, &info);
+                if (SUCCEEDED(hr))
+                {
+                    r->providesSamples = (info.dwFlags & (MFT_OUTPUT_STREAM_PROVIDES_SAMPLES | MFT_OUTPUT_STREAM_CAN_PROVIDE_SAMPLES)) != 0;
+                    r->outputBufferSize = info.cbSize;
+                }
+
+                TRACE(TraceLevelInfo, "SRT receiver port %d: decoding %dx%d (coded %ux%u) %u/%u fps hardware=%d",
+                      r->settings.port, r->width, r->height, codedWidth, codedHeight, rateNum, rateDen, r->stats.hardware);
+            }
+            type->Release();
+            return hr;
+        }
+        type->Release();
+    }
+}
+
+static HRESULT CreateDecoder(SrtReceiver* r, int codec)
+{
+    ReleaseDecoder(r);
+
+    MFT_REGISTER_TYPE_INFO inputType = { MFMediaType_Video, codec == SrtReceiverCodecHevc ? MFVideoFormat_HEVC : MFVideoFormat_H264 };
+    MFT_REGISTER_TYPE_INFO outputType = { MFMediaType_Video, MFVideoFormat_NV12 };
+    IMFActivate** activates = nullptr;
+    UINT32 count = 0;
+    HRESULT hr = MFTEnumEx(MFT_CATEGORY_VIDEO_DECODER, MFT_ENUM_FLAG_SYNCMFT | MFT_ENUM_FLAG_SORTANDFILTER,
+                           &inputType, &outputType, &activates, &count);
+    if (FAILED(hr))
+        return hr;
+
+    hr = count > 0 ? E_FAIL : MF_E_TOPO_CODEC_NOT_FOUND;
+    for (UINT32 i = 0; i < count; i++)
+    {
+        if (!r->decoder)
+            hr = activates[i]->ActivateObject(IID_PPV_ARGS(&r->decoder));
+        activates[i]->Release();
+    }
+    CoTaskMemFree(activates);
+    if (!r->decoder)
+        return hr;
+    hr = S_OK;
+
+    // No reordering delay, and DXVA when the decoder and the GPU support it
+    IMFAttributes* attributes = nullptr;
+    if (SUCCEEDED(r->decoder->GetAttributes(&attributes)))
+    {
+        attributes->SetUINT32(MF_LOW_LATENCY, TRUE);
+        if (r->deviceManager && MFGetAttributeUINT32(attributes, MF_SA_D3D11_AWARE, FALSE) &&
+            SUCCEEDED(r->decoder->ProcessMessage(MFT_MESSAGE_SET_D3D_MANAGER, (ULONG_PTR)r->deviceManager)))
+        {
+            r->stats.hardware = 1;
+        }
+        SafeRelease(attributes);
+    }
+
+    if (r->decoder->GetStreamIDs(1, &r->inputId, 1, &r->outputId) == E_NOTIMPL)
+    {
+        r->inputId = 0;
+        r->outputId = 0;
+    }
+
+    IMFMediaType* input = nullptr;
+    hr = MFCreateMediaType(&input);
+    if (SUCCEEDED(hr)) hr = input->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Video);
+    if (SUCCEEDED(hr)) hr = input->SetGUID(MF_MT_SUBTYPE, inputType.guidSubtype);
+    if (SUCCEEDED(hr)) hr = r->decoder->SetInputType(r->inputId, input, 0);
+    SafeRelease(input);
+
+    if (SUCCEEDED(hr)) hr = SelectOutputType(r);
+    if (SUCCEEDED(hr)) hr = r->decoder->ProcessMessage(MFT_MESSAGE_NOTIFY_BEGIN_STREAMING, 0);
+    if (SUCCEEDED(hr)) hr = r->decoder->ProcessMessage(MFT_MESSAGE_NOTIFY_START_OF_STREAM, 0);
+
+    if (FAILED(hr))
+    {
+        ReleaseDecoder(r);
+        return hr;
+    }
+
+    r->decoderCodec = codec;
+    return S_OK;
+}
+
+// Take one decoded frame into r->pending. S_OK when one is pending,
+// MF_E_TRANSFORM_NEED_MORE_INPUT when the decoder has none.
+static HRESULT CollectFrame(SrtReceiver* r)
+{
+    if (r->pending)
+        return S_OK;
+
+    MFT_OUTPUT_DATA_BUFFER out = {};
+    out.dwStreamID = r->outputId;
+
+    HRESULT hr = S_OK;
+    if (!r->providesSamples)
+    {
+        IMFMediaBuffer* buffer = nullptr;
+        hr = MFCreateSample(&out.pSample);
+        if (SUCCEEDED(hr)) hr = MFCreateMemoryBuffer(r->outputBufferSize, &buffer);
+        if (SUCCEEDED(hr)) hr = out.pSample->AddBuffer(buffer);
+        SafeRelease(buffer);
+        if (FAILED(hr))
+        {
+            SafeRelease(out.pSample);
+            return hr;
+        }
+    }
+
+    DWORD status = 0;
+    hr = r->decoder->ProcessOutput(0, 1, &out, &status);
+    SafeRelease(out.pEvents);
+
+    if (hr == MF_E_TRANSFORM_STREAM_CHANGE)
+    {
+        // First SPS, or the resolution changed: renegotiate NV12 at the new size
+        SafeRelease(out.pSample);
+        hr = SelectOutputType(r);
+        return SUCCEEDED(hr) ? CollectFrame(r) : hr;
+    }
+
+    if (SUCCEEDED(hr) && out.pSample)
+    {
+        r->pending = out.pSample;
+        r->stats.framesDecoded++;
+        return S_OK;
+    }
+
+    SafeRelease(out.pSample);
+    return FAILED(hr) ? hr : MF_E_TRANSFORM_NEED_MORE_INPUT;
+}
+
+// Hand the oldest access unit to the decoder. S_FALSE if it is not accepting input yet.
+static HRESULT DecodeUnit(SrtReceiver* r, const AccessUnit& unit)
+{
+    IMFSample* sample = nullptr;
+    IMFMediaBuffer* buffer = nullptr;
+    BYTE* dst = nullptr;
+    HRESULT hr = MFCreateMemoryBuffer((DWORD)unit.data.size(), &buffer);
+    if (SUCCEEDED(hr)) hr = buffer->Lock(&dst, nullptr, nullptr);
+    if (SUCCEEDED(hr))
+    {
+        memcpy(dst, unit.data.data(), unit.data.size());
+        buffer->Unlock();
+        hr = buffer->SetCurrentLength((DWORD)unit.data.size());
+    }
+    if (SUCCEEDED(hr)) hr = MFCreateSample(&sample);
+    if (SUCCEEDED(hr)) hr = sample->AddBuffer(buffer);
+
+    // 90 kHz PTS (33 bits, wrapping) to 100 ns from the first frame
+    if (SUCCEEDED(hr) && unit.pts >= 0)
+    {
+        if (r->firstPts < 0)
+            r->firstPts = unit.pts;
+        long long ticks = (unit.pts - r->firstPts) & ((1LL << 33) - 1);
+        hr = sample->SetSampleTime(ticks * 1000 / 9);
+    }
+
+    if (SUCCEEDED(hr))
+    {
+        hr = r->decoder->ProcessInput(r->inputId, sample, 0);
+        if (hr == MF_E_NOTACCEPTING)
+            hr = S_FALSE;
+    }
+
+    SafeRelease(sample);
+    SafeRelease(buffer);
+    return hr;
+}
+
+// Convert the pending frame into dst. -3 (frame kept) when dst cannot hold it.
+static int DeliverFrame(SrtReceiver* r, void* dst, int dstCapacity, int dstPitch, SrtFrameInfo* info)
+{
+    info->width = r->width;
+    info->height = r->height;
+    info->frameRateNum = r->frameRateNum;
+    info->frameRateDen = r->frameRateDen;
+    info->codec = r->decoderCodec;
+    LONGLONG time = 0;
+    info->timestamp = SUCCEEDED(r->pending->GetSampleTime(&time)) ? time : 0;
+
+    if (!dst || r->width < 2 || r->height <= 0 || dstPitch < r->width * 2 ||
+        (long long)dstPitch * (r->height - 1) + r->width * 2 > dstCapacity)
+        return -3;
+
+    LARGE_INTEGER start, end;
+    QueryPerformanceCounter(&start);
+
+    IMFMediaBuffer* buffer = nullptr;
+    IMF2DBuffer* buffer2d = nullptr;
+    BYTE* data = nullptr;
+    LONG pitch = 0;
+    DWORD length = 0;
+    bool locked2d = false;
+
+    // DXVA samples hold a texture; Lock2D maps it back without an extra contiguous copy
+    HRESULT hr = r->pending->GetBufferByIndex(0, &buffer);
+    if (SUCCEEDED(hr) && SUCCEEDED(buffer->QueryInterface(IID_PPV_ARGS(&buffer2d))) &&
+        SUCCEEDED(buffer2d->Lock2D(&data, &pitch)))
+    {
+        locked2d = true;
+    }
+    else if (SUCCEEDED(hr))
+    {
+        pitch = r->stride;
+        hr = buffer->Lock(&data, nullptr, &length);
+    }
+
+    int result = -2;
+    if (SUCCEEDED(hr) && pitch > 0)
+    {
+        const unsigned char* y = data + (size_t)r->cropY * pitch + r->cropX;
+        const unsigned char* uv = data + (size_t)r->codedHeight * pitch + (size_t)(r->cropY / 2) * pitch + r->cropX;
+        if (locked2d || (size_t)pitch * r->codedHeight * 3 / 2 <= length)
+            result = ConvertNV12ToUYVY(y, pitch, uv, pitch, dst, dstPitch, r->width, r->height) == 0 ? 1 : -2;
+
+        if (locked2d)
+            buffer2d->Unlock2D();
+        else
+            buffer->Unlock();
+    }
+    if (result != 1)
+        r->stats.lastError = FAILED(hr) ? hr : E_UNEXPECTED;
+
+    SafeRelease(buffer2d);
+    SafeRelease(buffer);
+    SafeRelease(r->pending);
+
+    QueryPerformanceCounter(&end);
+    r->stats.convertUsTotal += (unsigned long long)TicksToMicros(end.QuadPart - start.QuadPart);
+    if (result == 1)
+        r->stats.framesDelivered++;
+    return result;
+}
+
+// Back to listening: the next caller starts a new stream
+static void Disconnect(SrtReceiver* r)
+{
+    if (r->connection != SrtInvalidSocket)
+    {
+        g_srt.close(r->connection);
+        r->connection = SrtInvalidSocket;
+    }
+    r->stats.connected = 0;
+
+    ResetDemuxer(r->demux);
+    r->units.clear();
+    SafeRelease(r->pending);
+    if (r->decoder)
+        r->decoder->ProcessMessage(MFT_MESSAGE_COMMAND_FLUSH, 0);
+    r->firstPts = -1;
+}
+
+static bool TryAccept(SrtReceiver* r)
+{
+    sockaddr_storage address = {};
+    int addressLength = sizeof(address);
+    SRTSOCKET socket = g_srt.accept(r->listener, (sockaddr*)&address, &addressLength);
+    if (socket == SrtInvalidSocket)
+    {
+        int error = SrtLastError();
+        if (error != SrtErrAsyncRcv)
+            r->stats.lastError = -error;
+        return false;
+    }
+
+    // The accepted socket inherits the listener's non-blocking mode; reads block briefly instead
+    int blocking = 1;
+    int timeout = RecvPollMs;
+    g_srt.setSockFlag(socket, SrtoRcvSyn, &blocking, sizeof(blocking));
+    g_srt.setSockFlag(socket, SrtoRcvTimeo, &timeout, sizeof(timeout));
+
+    r->connection = socket;
+    r->stats.connected = 1;
+    r->stats.connections++;
+    TRACE(TraceLevelInfo, "SRT receiver port %d: caller connected", r->settings.port);
+    return true;
+}
+
+static void Release(SrtReceiver* r)
+{
+    ReleaseDecoder(r);
+    SafeRelease(r->deviceManager);
+    SafeRelease(r->device);
+
+    if (r->connection != SrtInvalidSocket)
+        g_srt.close(r->connection);
+    if (r->listener != SrtInvalidSocket)
+        g_srt.close(r->listener);
+
+    if (r->mfStarted)
+        MFShutdown();
+    delete r;
+}
+
+// ---------------------------------------------------------------------------
+// Exports
+// ---------------------------------------------------------------------------
+
+extern "C" {
+
+MEDIA_KERNELS_API int IsSrtReceiverAvailable()
+{
+    if (!SrtLoaded())
+        return 0;
+
+    ComScope com;
+    if (FAILED(MFStartup(MF_VERSION, MFSTARTUP_LITE)))
+        return 0;
+
+    MFT_REGISTER_TYPE_INFO inputType = { MFMediaType_Video, MFVideoFormat_H264 };
+    MFT_REGISTER_TYPE_INFO outputType = { MFMediaType_Video, MFVideoFormat_NV12 };
+    IMFActivate** activates = nullptr;
+    UINT32 count = 0;
+    HRESULT hr = MFTEnumEx(MFT_CATEGORY_VIDEO_DECODER, MFT_ENUM_FLAG_SYNCMFT, &inputType, &outputType, &activates, &count);
+    if (SUCCEEDED(hr))
+    {
+        for (UINT32 i = 0; i < count; i++)
+            activates[i]->Release();
+        CoTaskMemFree(activates);
+    }
+
+    MFShutdown();
+    return SUCCEEDED(hr) && count > 0 ? 1 : 0;
+}
+
+MEDIA_KERNELS_API void* CreateSrtReceiver(const SrtReceiverSettings* settings, int* error)
+{
+    if (error) *error = 0;
+    if (!settings || settings->port <= 0 || settings->port > 65535 || settings->latencyMs < 0)
+    {
+        if (error) *error = E_INVALIDARG;
+        return nullptr;
+    }
+    if (!SrtLoaded())
+    {
+        if (error) *error = HRESULT_FROM_WIN32(ERROR_MOD_NOT_FOUND);
+        return nullptr;
+    }
+
+    SrtReceiver* r = new (std::nothrow) SrtReceiver();
+    if (!r)
+    {
+        if (error) *error = E_OUTOFMEMORY;
+        return nullptr;
+    }
+
+    r->settings = *settings;
+    r->listener = SrtInvalidSocket;
+    r->connection = SrtInvalidSocket;
+    r->firstPts = -1;
+    ResetDemuxer(r->demux);
+
+    ComScope com;
+    HRESULT hr = S_OK;
+    try
+    {
+        r->message.resize(SrtMessageSize);
+    }
+    catch (const std::bad_alloc&)
+    {
+        hr = E_OUTOFMEMORY;
+    }
+
+    if (SUCCEEDED(hr))
+    {
+        hr = MFStartup(MF_VERSION, MFSTARTUP_LITE);
+        r->mfStarted = SUCCEEDED(hr);
+    }
+
+    // Without a usable GPU the decoder runs in software
+    if (SUCCEEDED(hr) && settings->allowHardware && FAILED(CreateDeviceManager(r)))
+        TRACE(TraceLevelInfo, "SRT receiver port %d: no D3D11 video device, decoding in software", settings->port);
+
+    // Listener: live transport, the requested latency (inherited by accepted callers), and
+    // non-blocking accept so ReceiveSrtFrame can poll it
+    int srtError = 0;
+    if (SUCCEEDED(hr))
+    {
+        int transType = SrttLive;
+        int latency = settings->latencyMs;
+        int blocking = 0;
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_port = _byteswap_ushort((unsigned short)settings->port);
+
+        r->listener = g_srt.createSocket();
+        if (r->listener == SrtInvalidSocket ||
+            g_srt.setSockFlag(r->listener, SrtoTransType, &transType, sizeof(transType)) < 0 ||
+            g_srt.setSockFlag(r->listener, SrtoLatency, &latency, sizeof(latency)) < 0 ||
+            g_srt.setSockFlag(r->listener, SrtoRcvSyn, &blocking, sizeof(blocking)) < 0 ||
+            g_srt.bind(r->listener, (const sockaddr*)&address, sizeof(address)) < 0 ||
+            g_srt.listen(r->listener, 1) < 0)
+        {
+            srtError = SrtLastError();
+            TRACE(TraceLevelError, "CreateSrtReceiver port %d: %s", settings->port, g_srt.getLastErrorStr());
+        }
+    }
+
+    if (FAILED(hr) || srtError != 0)
+    {
+        if (FAILED(hr))
+            TRACE(TraceLevelError, "CreateSrtReceiver port %d failed: 0x%08X", settings->port, (unsigned)hr);
+        Release(r);
+        if (error) *error = FAILED(hr) ? hr : -srtError;
+        return nullptr;
+    }
+
+    TRACE(TraceLevelInfo, "CreateSrtReceiver listening on port %d latency=%d ms dxva=%d",
+          settings->port, settings->latencyMs, r->deviceManager ? 1 : 0);
+    return r;
+}
+
+MEDIA_KERNELS_API int ReceiveSrtFrame(void* receiver, void* dst, int dstCapacity, int dstPitch,
+                                      int timeoutMs, SrtFrameInfo* info)
+{
+    SrtReceiver* r = (SrtReceiver*)receiver;
+    if (!r || !info || dstCapacity < 0 || (!dst && dstCapacity > 0) || timeoutMs < 0)
+        return -1;
+
+    memset(info, 0, sizeof(SrtFrameInfo));
+    ComScope com;
+    ULONGLONG deadline = GetTickCount64() + (ULONGLONG)timeoutMs;
+
+    for (;;)
+    {
+        if (r->pending)
+            return DeliverFrame(r, dst, dstCapacity, dstPitch, info);
+
+        // Decode what has been demuxed before reading more from the socket
+        if (r->decoder)
+        {
+            LARGE_INTEGER start, end;
+            QueryPerformanceCounter(&start);
+            HRESULT hr = CollectFrame(r);
+            while (hr == MF_E_TRANSFORM_NEED_MORE_INPUT && !r->units.empty())
+            {
+                hr = DecodeUnit(r, r->units.front());
+                if (hr == S_FALSE)
+                {
+                    // Not accepting input: its output has to be drained first
+                    hr = CollectFrame(r);
+                    break;
+                }
+                if (SUCCEEDED(hr))
+                {
+                    r->units.pop_front();
+                    r->stats.accessUnits++;
+                    hr = CollectFrame(r);
+                }
+            }
+            QueryPerformanceCounter(&end);
+            r->stats.decodeUsTotal += (unsigned long long)TicksToMicros(end.QuadPart - start.QuadPart);
+
+            if (hr == S_OK)
+                continue;
+            if (FAILED(hr) && hr != MF_E_TRANSFORM_NEED_MORE_INPUT)
+            {
+                TRACE(TraceLevelError, "SRT receiver port %d: decode failed 0x%08X", r->settings.port, (unsigned)hr);
+                r->stats.lastError = hr;
+                Disconnect(r);
+                return -2;
+            }
+        }
+        else if (!r->units.empty() && r->demux.codec != SrtReceiverCodecNone)
+        {
+            HRESULT hr = CreateDecoder(r, r->demux.codec);
+            if (FAILED(hr))
+            {
+                TRACE(TraceLevelError, "SRT receiver port %d: no decoder for codec %d: 0x%08X",
+                      r->settings.port, r->demux.codec, (unsigned)hr);
+                r->stats.lastError = hr;
+                Disconnect(r);
+                return -2;
+            }
+            continue;
+        }
+
+        // A new PMT may switch codecs mid-connection
+        if (r->decoder && r->demux.codec != SrtReceiverCodecNone && r->demux.codec != r->decoderCodec)
+        {
+            ReleaseDecoder(r);
+            continue;
+        }
+
+        ULONGLONG now = GetTickCount64();
+        if (now >= deadline)
+            return 0;
+
+        if (r->connection == SrtInvalidSocket)
+        {
+            if (!TryAccept(r))
+                Sleep((DWORD)(deadline - now < 10 ? deadline - now : 10));
+            continue;
+        }
+
+        int received = g_srt.recvMsg(r->connection, (char*)r->message.data(), (int)r->message.size());
+        if (received < 0)
+        {
+            int srtError = SrtLastError();
+            if (srtError == SrtErrAsyncRcv || srtError == SrtErrTimeout)
+                continue;
+
+            TRACE(TraceLevelInfo, "SRT receiver port %d: caller disconnected (%s)", r->settings.port, g_srt.getLastErrorStr());
+            r->stats.lastError = -srtError;
+            Disconnect(r);
+            return -2;
+        }
+
+        r->stats.packetsReceived++;
+        r->stats.bytesReceived += (unsigned long long)received;
+        DemuxMessage(r, r->message.data(), received);
+
+        // Units appear before the decoder knows the codec only until the PMT arrives
+        if (r->demux.codec == SrtReceiverCodecNone)
+            r->units.clear();
+    }
+}
+
+MEDIA_KERNELS_API void DiscardSrtFrame(void* receiver)
+{
+    SrtReceiver* r = (SrtReceiver*)receiver;
+    if (!r || !r->pending)
+        return;
+
+    SafeRelease(r->pending);
+    r->stats.framesDiscarded++;
+}
+
+MEDIA_KERNELS_API void DestroySrtReceiver(void* receiver)
+{
+    SrtReceiver* r = (SrtReceiver*)receiver;
+    if (!r)
+        return;
+
+    ComScope com;
+    Release(r);
+}
+
+MEDIA_KERNELS_API int GetSrtReceiverStats(void* receiver, SrtReceiverStats* stats, int statsSize)
+{
+    SrtReceiver* r = (SrtReceiver*)receiver;
+    if (!r || !stats || statsSize != (int)sizeof(SrtReceiverStats))
+        return 0;
+
+    memcpy(stats, &r->stats, sizeof(SrtReceiverStats));
+    return 1;
+}
+
+} // extern "C"
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "MediaKernels.h"
+
+// In-process SRT input: an SRT listener (libsrt, loaded from srt.dll at runtime), an MPEG-TS
+// demuxer for the first H.264 or HEVC program, and a Media Foundation decoder transform that
+// decodes on the GPU through DXVA (D3D11) when the driver supports it. Decoded NV12 is
+// converted once, straight into the caller's frame buffer as UYVY, so a remote camera costs
+// no external process and no raw-video pipe.
+// Pull model: ReceiveSrtFrame runs the socket, demuxer and decoder on the calling thread
+// until a frame is ready or the timeout passes. A receiver is not thread-safe: one caller.
+
+enum SrtReceiverCodec
+{
+    SrtReceiverCodecNone = 0,   // no video stream found yet
+    SrtReceiverCodecH264 = 1,
+    SrtReceiverCodecHevc = 2
+};
+
+struct SrtReceiverSettings
+{
+    int port;               // UDP port to listen on (all interfaces)
+    int latencyMs;          // SRT receiver latency
+    int allowHardware;      // 1 = decode through DXVA when available
+};
+
+// The frame ReceiveSrtFrame delivered, or the one it is holding (-3)
+struct SrtFrameInfo
+{
+    int width;              // display size (decoder padding cropped), even width
+    int height;
+    int frameRateNum;       // from the stream, 0 if it does not say
+    int frameRateDen;
+    long long timestamp;    // presentation time in 100 ns units from the first frame
+    int codec;              // SrtReceiverCodec
+};
+
+struct SrtReceiverStats
+{
+    unsigned long long packetsReceived;     // SRT messages
+    unsigned long long bytesReceived;
+    unsigned long long accessUnits;         // PES packets handed to the decoder
+    unsigned long long framesDecoded;
+    unsigned long long framesDelivered;     // written to a caller's buffer
+    unsigned long long framesDiscarded;
+    unsigned long long continuityErrors;    // TS continuity counter gaps on the video PID
+    unsigned long long decodeUsTotal;       // ProcessInput + ProcessOutput
+    unsigned long long convertUsTotal;      // NV12 -> UYVY into the caller's buffer
+    unsigned long long connections;         // callers accepted
+    int connected;                          // 1 while a caller is connected
+    int hardware;                           // 1 if the decoder runs on DXVA
+    int lastError;                          // HRESULT or -(SRT error code) of the last failure
+};
+
+extern "C" {
+    // Returns: 1 if srt.dll loads and an H.264 decoder transform is present, 0 otherwise
+    MEDIA_KERNELS_API int IsSrtReceiverAvailable();
+
+    // Bind and start listening. Returns null on failure with an HRESULT (E_INVALIDARG for bad
+    // settings) or -(SRT error code) in *error.
+    MEDIA_KERNELS_API void* CreateSrtReceiver(const SrtReceiverSettings* settings, int* error);
+
+    // Wait up to timeoutMs for the next decoded frame and write it to dst as UYVY at dstPitch.
+    // info (required) receives the frame's description.
+    // Returns: 1 frame written, 0 nothing ready within the timeout, -1 bad arguments,
+    //          -2 the caller disconnected or the stream failed (listening again; lastError set),
+    //          -3 dst too small for the frame (info describes it; the frame stays queued)
+    MEDIA_KERNELS_API int ReceiveSrtFrame(void* receiver, void* dst, int dstCapacity, int dstPitch,
+                                          int timeoutMs, SrtFrameInfo* info);
+
+    // Drop the frame a -3 result left queued (no buffer free for it)
+    MEDIA_KERNELS_API void DiscardSrtFrame(void* receiver);
+
+    MEDIA_KERNELS_API void DestroySrtReceiver(void* receiver);
+
+    // Copy the receiver's counters. Returns: 1 on success, 0 on bad arguments
+    MEDIA_KERNELS_API int GetSrtReceiverStats(void* receiver, SrtReceiverStats* stats, int statsSize);
+}
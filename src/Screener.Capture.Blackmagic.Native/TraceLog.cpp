@@ -0,0 +1,182 @@
+#include "TraceLog.h"
+
+#include <Windows.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+// One ring per producer thread. Capture callbacks run on one DeckLink thread per input,
+// so a handful of rings covers every producer. A ring is handed back when its thread exits;
+// threads that find every ring taken share one extra ring behind a lock.
+static const int TraceRingCount = 16;
+
+// Entries per ring (power of two). 256 x 256 bytes = 64 KB per ring.
+static const int TraceRingEntries = 256;
+
+static const int TraceMaxMessage = 240;
+
+struct TraceEntry
+{
+    long long timestamp;        // QueryPerformanceCounter ticks
+    unsigned int threadId;
+    unsigned short level;
+    unsigned short length;
+    char text[TraceMaxMessage];
+};
+
+// head is written only by the owning thread, tail only by the consumer; they sit on
+// separate cache lines so the two sides do not contend. A ring passed to a new thread keeps
+// its head and tail, so entries the old owner left are still drained.
+struct TraceRing
+{
+    __declspec(align(64)) volatile LONG owned;
+    volatile LONG64 head;
+    __declspec(align(64)) volatile LONG64 tail;
+    __declspec(align(64)) TraceEntry entries[TraceRingEntries];
+};
+
+// g_rings[TraceRingCount] is the shared overflow ring; its producers hold g_sharedLock
+static TraceRing g_rings[TraceRingCount + 1];
+static TraceRing* const g_sharedRing = &g_rings[TraceRingCount];
+static volatile LONG64 g_dropped = 0;
+static SRWLOCK g_drainLock = SRWLOCK_INIT;
+static SRWLOCK g_sharedLock = SRWLOCK_INIT;
+
+// Owns the calling thread's ring; the destructor runs at thread exit (DLL_THREAD_DETACH)
+// and frees the ring for the next thread that traces
+struct ThreadRingOwner
+{
+    TraceRing* ring = nullptr;
+
+    ~ThreadRingOwner()
+    {
+        if (ring != nullptr)
+            InterlockedExchange(&ring->owned, 0);
+    }
+};
+
+static thread_local ThreadRingOwner t_owner;
+
+static TraceRing* ThreadRing()
+{
+    // Threads on the shared ring look for a freed one on each call
+    if (t_owner.ring == nullptr)
+    {
+        for (int i = 0; i < TraceRingCount; i++)
+        {
+            if (g_rings[i].owned == 0 && InterlockedCompareExchange(&g_rings[i].owned, 1, 0) == 0)
+            {
+                t_owner.ring = &g_rings[i];
+                break;
+            }
+        }
+    }
+    return t_owner.ring;
+}
+
+void TraceWrite(int level, const char* format, ...)
+{
+    TraceRing* ring = ThreadRing();
+    bool shared = ring == nullptr;
+    if (shared)
+    {
+        ring = g_sharedRing;
+        AcquireSRWLockExclusive(&g_sharedLock);
+    }
+
+    LONG64 head = ring->head;
+    if (head - ring->tail >= TraceRingEntries)
+    {
+        if (shared)
+            ReleaseSRWLockExclusive(&g_sharedLock);
+        InterlockedIncrement64(&g_dropped);
+        return;
+    }
+
+    TraceEntry* entry = &ring->entries[head & (TraceRingEntries - 1)];
+
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(entry->text, sizeof(entry->text), format, args);
+    va_end(args);
+
+    if (length < 0)
+        length = 0;
+    if (length >= (int)sizeof(entry->text))
+        length = (int)sizeof(entry->text) - 1;
+
+    // Messages carry their own trailing newline; the consumer adds one per entry
+    while (length > 0 && (entry->text[length - 1] == '\n' || entry->text[length - 1] == '\r'))
+        length--;
+
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    entry->timestamp = now.QuadPart;
+    entry->threadId = GetCurrentThreadId();
+    entry->level = (unsigned short)level;
+    entry->length = (unsigned short)length;
+
+    // Publish the entry only after it is fully written
+    InterlockedExchange64(&ring->head, head + 1);
+
+    if (shared)
+        ReleaseSRWLockExclusive(&g_sharedLock);
+}
+
+int TraceDrain(char* buffer, int bufferSize)
+{
+    if (buffer == nullptr || bufferSize <= 0)
+        return 0;
+
+    static LARGE_INTEGER frequency = {};
+    if (frequency.QuadPart == 0)
+        QueryPerformanceFrequency(&frequency);
+
+    AcquireSRWLockExclusive(&g_drainLock);
+
+    int written = 0;
+
+    for (;;)
+    {
+        // Merge the per-thread rings by timestamp so lines come out in order
+        TraceRing* oldest = nullptr;
+        for (int i = 0; i <= TraceRingCount; i++)
+        {
+            TraceRing* ring = &g_rings[i];
+            if (ring->tail == ring->head)
+                continue;
+            const TraceEntry& e = ring->entries[ring->tail & (TraceRingEntries - 1)];
+            if (oldest == nullptr || e.timestamp < oldest->entries[oldest->tail & (TraceRingEntries - 1)].timestamp)
+                oldest = ring;
+        }
+
+        if (oldest == nullptr)
+            break;
+
+        const TraceEntry& e = oldest->entries[oldest->tail & (TraceRingEntries - 1)];
+        long long micros = e.timestamp / frequency.QuadPart * 1000000 +
+                           e.timestamp % frequency.QuadPart * 1000000 / frequency.QuadPart;
+
+        char prefix[48];
+        int prefixLength = snprintf(prefix, sizeof(prefix), "%d %lld %u ", e.level, micros, e.threadId);
+        int lineLength = prefixLength + e.length + 1;
+        if (written + lineLength > bufferSize)
+            break;
+
+        memcpy(buffer + written, prefix, prefixLength);
+        memcpy(buffer + written + prefixLength, e.text, e.length);
+        buffer[written + lineLength - 1] = '\n';
+        written += lineLength;
+
+        // Hand the slot back to the producer
+        InterlockedExchange64(&oldest->tail, oldest->tail + 1);
+    }
+
+    ReleaseSRWLockExclusive(&g_drainLock);
+    return written;
+}
+
+long long TraceDroppedCount()
+{
+    return g_dropped;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+// In-memory diagnostic trace for the capture path. Each producer thread writes into
+// its own single-producer/single-consumer ring, so a trace call costs one vsnprintf
+// and a few stores: no locks, no file I/O, no syscalls on the DMA callback thread.
+// Rings are freed at thread exit; beyond 16 live threads, callers share a locked ring.
+// The rings are drained by one consumer (C# through ReadDeckLinkTrace).
+enum TraceLevel
+{
+    TraceLevelError = 1,
+    TraceLevelWarning = 2,
+    TraceLevelInfo = 3,
+    TraceLevelVerbose = 4
+};
+
+// Messages above this level compile away. Debug builds keep the verbose buffer dumps.
+// Override with /DSCREENER_TRACE_LEVEL=<n>.
+#ifndef SCREENER_TRACE_LEVEL
+#ifdef _DEBUG
+#define SCREENER_TRACE_LEVEL 4
+#else
+#define SCREENER_TRACE_LEVEL 3
+#endif
+#endif
+
+#define TRACE(level, ...) \
+    do { if ((level) <= SCREENER_TRACE_LEVEL) TraceWrite((level), __VA_ARGS__); } while (0)
+
+// Format a message into the calling thread's ring (or the shared ring when every ring is
+// owned by another live thread). Drops (and counts) the message if that ring is full.
+void TraceWrite(int level, const char* format, ...);
+
+// Move pending messages, oldest first across all threads, into buffer as lines of
+// "<level> <microseconds> <threadId> <message>\n". Stops before a line that would not fit.
+// Returns the number of bytes written. Safe to call from any thread; callers are serialized.
+int TraceDrain(char* buffer, int bufferSize);
+
+// Messages dropped since the DLL was loaded
+long long TraceDroppedCount();
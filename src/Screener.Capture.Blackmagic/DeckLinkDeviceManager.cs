@@ -1,7 +1,12 @@
+using System.Buffers.Binary;
+using System.Diagnostics;
 using System.Runtime.InteropServices;
 using Microsoft.Extensions.Logging;
 using Screener.Abstractions.Capture;
 using Screener.Capture.Blackmagic.Interop;
+using Screener.Core.Buffers;
+using Screener.Core.Capture;
+using Screener.Core.Native;
 
 namespace Screener.Capture.Blackmagic;
 
@@ -39,10 +44,12 @@ public sealed class DeckLinkDeviceManager : IDeviceManager
     private static IntPtr _decklinkModule = IntPtr.Zero;
 
     private readonly ILogger<DeckLinkDeviceManager> _logger;
+    private readonly NativeTraceReader _nativeTrace;
     private readonly Dictionary<string, DeckLinkCaptureDevice> _devices = new();
     private readonly object _lock = new();
     private bool _disposed;
     private bool _sdkAvailable;
+    private bool _tenBitCapture;
 
     public IReadOnlyList<ICaptureDevice> AvailableDevices
     {
@@ -55,12 +62,31 @@ public sealed class DeckLinkDeviceManager : IDeviceManager
         }
     }
 
+    /// <summary>
+    /// Capture 10-bit v210 instead of 8-bit UYVY on all DeckLink inputs.
+    /// Takes effect the next time each input starts capturing.
+    /// </summary>
+    public bool TenBitCapture
+    {
+        get => _tenBitCapture;
+        set
+        {
+            lock (_lock)
+            {
+                _tenBitCapture = value;
+                foreach (var device in _devices.Values)
+                    device.TenBitCapture = value;
+            }
+        }
+    }
+
     public event EventHandler<DeviceEventArgs>? DeviceArrived;
     public event EventHandler<DeviceEventArgs>? DeviceRemoved;
 
     public DeckLinkDeviceManager(ILogger<DeckLinkDeviceManager> logger)
     {
         _logger = logger;
+        _nativeTrace = new NativeTraceReader(logger);
         _sdkAvailable = CheckSdkAvailable();
     }
 
@@ -264,6 +290,7 @@ public sealed class DeckLinkDeviceManager : IDeviceManager
                                         deckLink,
                                         deckLinkInput,
                                         _logger);
+                                    device.TenBitCapture = _tenBitCapture;
 
                                     _devices[deviceId] = device;
                                     DeviceArrived?.Invoke(this, new DeviceEventArgs { Device = device });
@@ -313,6 +340,7 @@ public sealed class DeckLinkDeviceManager : IDeviceManager
                     "simulated-decklink-1",
                     "DeckLink Mini Recorder (Simulated)",
                     _logger);
+                device.TenBitCapture = _tenBitCapture;
 
                 _devices[device.DeviceId] = device;
                 DeviceArrived?.Invoke(this, new DeviceEventArgs { Device = device });
@@ -364,6 +392,8 @@ public sealed class DeckLinkDeviceManager : IDeviceManager
             }
             _devices.Clear();
         }
+
+        _nativeTrace.Dispose();
     }
 }
 
@@ -391,20 +421,18 @@ public sealed class DeckLinkCaptureDevice : ICaptureDevice, IDeckLinkInputCallba
     private int _audioChannels = 16;
     private BMDDisplayMode _pendingFormatChange = BMDDisplayMode.bmdModeUnknown;
     private bool _formatChangeInProgress = false;
-    private IntPtr _unmanagedBuffer = IntPtr.Zero; // Reusable unmanaged buffer
-    private byte[]? _lastGoodFrameCache; // Cache last successful frame to avoid flashing on partial copies
-    private int _unmanagedBufferSize = 0;
-
-    // Ring buffer for immediate frame capture (avoids DMA buffer recycling issues)
-    private const int RingBufferSlots = 3;
-    private byte[][]? _ringBuffer;
-    private int _ringBufferWriteIndex = 0;
-    private readonly object _ringBufferLock = new();
-
-    // Pooled event buffers to avoid 4MB allocation per frame (reduces GC pressure)
-    private const int EventBufferPoolSize = 3;
-    private byte[][]? _eventBufferPool;
-    private int _eventBufferIndex = 0;
+    // Last complete frame, kept leased in its ring slot to replace corrupt or partial copies
+    // instead of flashing; it is copied only when a bad frame needs it
+    private IDisposable? _lastGoodFrameLease;
+    private byte[]? _lastGoodFrame;
+
+    // Ring buffer for immediate frame capture (avoids DMA buffer recycling issues).
+    // Slots are allocated on the pinned object heap so the native DLL can copy
+    // the DMA buffer straight into them, and are handed to VideoFrameReceived as-is.
+    // Consumers that keep a frame past the handler lease its slot (see FrameRing).
+    private const int RingBufferSlots = 5;
+    private FrameRing? _frameRing;
+    private long _ringFullDrops;
 
     // Native DLL imports for frame data access
     // These bypass COM interop marshaling issues by calling native code directly
@@ -414,6 +442,147 @@ public sealed class DeckLinkCaptureDevice : ICaptureDevice, IDeckLinkInputCallba
     [DllImport("Screener.Capture.Blackmagic.Native.dll", CallingConvention = CallingConvention.Cdecl)]
     private static extern int GetDeckLinkFrameInfo(IntPtr framePtr, out int width, out int height, out int rowBytes, out uint flags);
 
+    // Per-input native capture session: caches the resolved buffer-access path and
+    // frame geometry so each frame costs at most one QueryInterface plus the copy
+    [DllImport("Screener.Capture.Blackmagic.Native.dll", CallingConvention = CallingConvention.Cdecl)]
+    private static extern IntPtr CreateDeckLinkCaptureSession();
+
+    [DllImport("Screener.Capture.Blackmagic.Native.dll", CallingConvention = CallingConvention.Cdecl)]
+    private static extern void ResetDeckLinkCaptureSession(IntPtr session);
+
+    [DllImport("Screener.Capture.Blackmagic.Native.dll", CallingConvention = CallingConvention.Cdecl)]
+    private static extern void DestroyDeckLinkCaptureSession(IntPtr session);
+
+    [DllImport("Screener.Capture.Blackmagic.Native.dll", CallingConvention = CallingConvention.Cdecl)]
+    private static extern int CopyDeckLinkSessionFrame(IntPtr session, IntPtr framePtr, IntPtr buffer, int bufferSize);
+
+    // Active picture region for CopyDeckLinkSessionFrameCropped (mirrors DeckLinkCropRegion)
+    [StructLayout(LayoutKind.Sequential)]
+    private struct DeckLinkCropRegion
+    {
+        public int SkipRows;   // -1 = detect VANC rows natively on the first frame
+        public int SkipBytes;  // HANC bytes at the start of each row
+        public int RowBytes;   // active bytes per row
+    }
+
+    // Copies only the active picture into a tightly packed slot (VANC/HANC never leave the DMA buffer).
+    // Returns 1 = good, 0 = failed, -1 = corrupt, -2 = partial copy
+    [DllImport("Screener.Capture.Blackmagic.Native.dll", CallingConvention = CallingConvention.Cdecl)]
+    private static extern int CopyDeckLinkSessionFrameCropped(IntPtr session, IntPtr framePtr, ref DeckLinkCropRegion crop,
+        IntPtr buffer, int bufferSize);
+
+    // Same copy (crop may be null for a whole-frame copy) that also samples the auto-cut
+    // detectors' luma plane from the source rows; lumaWritten = 0 when the copy fell back
+    [DllImport("Screener.Capture.Blackmagic.Native.dll", CallingConvention = CallingConvention.Cdecl)]
+    private static extern unsafe int CopyDeckLinkSessionFrameWithLuma(IntPtr session, IntPtr framePtr, DeckLinkCropRegion* crop,
+        IntPtr buffer, int bufferSize, IntPtr luma, int lumaWidth, int lumaHeight, out int lumaWritten);
+
+    [DllImport("Screener.Capture.Blackmagic.Native.dll", CallingConvention = CallingConvention.Cdecl)]
+    private static extern int GetDeckLinkSessionAccessPath(IntPtr session);
+
+    // Copies an audio packet into the ring's free space (two regions where it wraps).
+    // Returns sample frames copied, -1 unreadable, -2 does not fit
+    [DllImport("Screener.Capture.Blackmagic.Native.dll", CallingConvention = CallingConvention.Cdecl)]
+    private static extern unsafe int CopyDeckLinkAudioPacket(IntPtr packetPtr, int bytesPerSampleFrame, byte* dst, int dstSize,
+        byte* dstWrap, int dstWrapSize, out long packetTime);
+
+    // Native capture counters (mirror DeckLinkLatencyHistogram / DeckLinkCaptureStats)
+    [StructLayout(LayoutKind.Sequential)]
+    private unsafe struct DeckLinkLatencyHistogram
+    {
+        public fixed ulong Buckets[LatencyHistogram.BucketCount];
+        public ulong Count;
+        public ulong TotalUs;
+        public ulong MaxUs;
+
+        public LatencyHistogram ToHistogram()
+        {
+            var buckets = new long[LatencyHistogram.BucketCount];
+            for (int i = 0; i < buckets.Length; i++)
+                buckets[i] = (long)Buckets[i];
+            return new LatencyHistogram
+            {
+                Buckets = buckets,
+                Count = (long)Count,
+                TotalMicroseconds = (long)TotalUs,
+                MaxMicroseconds = (long)MaxUs
+            };
+        }
+    }
+
+    [StructLayout(LayoutKind.Sequential)]
+    private unsafe struct DeckLinkCaptureStats
+    {
+        public ulong FramesGood;
+        public ulong FramesFailed;
+        public ulong FramesCorrupt;
+        public ulong FramesPartial;
+        public ulong BytesCopied;
+        public fixed ulong FramesByPath[4];
+        public ulong AccessPathChanges;
+        public int AccessPath;
+        public int Reserved;
+        public DeckLinkLatencyHistogram CallbackToCopy;
+        public DeckLinkLatencyHistogram Copy;
+        public DeckLinkLatencyHistogram FrameInterval;
+    }
+
+    [DllImport("Screener.Capture.Blackmagic.Native.dll", CallingConvention = CallingConvention.Cdecl)]
+    private static extern void MarkDeckLinkSessionCallback(IntPtr session, long timestamp);
+
+    [DllImport("Screener.Capture.Blackmagic.Native.dll", CallingConvention = CallingConvention.Cdecl)]
+    private static extern int GetDeckLinkCaptureStats(IntPtr session, out DeckLinkCaptureStats stats, int statsSize);
+
+    [DllImport("Screener.Capture.Blackmagic.Native.dll", CallingConvention = CallingConvention.Cdecl)]
+    private static extern void ResetDeckLinkCaptureStats(IntPtr session);
+
+    private static readonly string[] AccessPathNames = { "Unknown", "VideoBuffer", "Legacy", "Offset280" };
+
+    // Streaming (non-temporal) copy kernel and optional copy thread pool for UHD frames.
+    // The pool is process-wide, so it is configured once by the first UHD input.
+    [DllImport("Screener.Capture.Blackmagic.Native.dll", CallingConvention = CallingConvention.Cdecl)]
+    private static extern int SetDeckLinkCopyThreads(int threadCount, ulong affinityMask);
+
+    [DllImport("Screener.Capture.Blackmagic.Native.dll", CallingConvention = CallingConvention.Cdecl)]
+    private static extern int GetDeckLinkCopyKernel();
+
+    private const int UhdCopyThreads = 4;
+    private static int _copyPoolConfigured;
+
+    private IntPtr _nativeSession = IntPtr.Zero;
+    private readonly object _nativeSessionLock = new();
+
+    // Stages timed on the managed side of the capture callback
+    private readonly LatencyRecorder _ringSlotWait = new();
+    private readonly LatencyRecorder _downstream = new();
+    private long _framesDelivered;
+
+    // Requested detector luma plane, width << 32 | height (0 = off), and whether the
+    // native DLL predates CopyDeckLinkSessionFrameWithLuma
+    private long _analysisLumaSize;
+    private bool _lumaCopyUnavailable;
+
+    // Preview levels consumers subscribed to, built into each ring slot after the copy
+    private readonly PreviewPyramidBuilder _previewPyramid = new();
+
+    // Audio packets are copied by the native DLL straight into a pinned lock-free ring on the
+    // capture thread and raised from a dispatch thread, stamped with the stream time of the
+    // video frame they arrived with. Audio consumers never run on the capture thread, and the
+    // capture thread never waits for them: a full ring drops the packet.
+    private const int AudioSampleRate = 48000;
+    private const int AudioBytesPerSample = 4; // 32-bit audio
+    private const int AudioRingMilliseconds = 1000;
+    private const int AudioDispatchMilliseconds = 100;
+    private AudioRingBuffer? _audioRing;
+    private Thread? _audioDispatchThread;
+    private readonly AutoResetEvent _audioAvailable = new(false);
+    private volatile bool _audioDispatchStopping;
+    private bool _audioCopyUnavailable;
+    private long _audioOverruns;
+
+    // Log a capture statistics summary this often (~10 s at 60 fps)
+    private const int StatisticsLogInterval = 600;
+
     public string DeviceId { get; }
     public string DisplayName { get; }
     public DeviceStatus Status => _status;
@@ -421,6 +590,95 @@ public sealed class DeckLinkCaptureDevice : ICaptureDevice, IDeckLinkInputCallba
     public IReadOnlyList<VideoMode> SupportedVideoModes => _supportedModes;
     public IReadOnlyList<VideoConnector> AvailableConnectors => _availableConnectors;
 
+    /// <summary>
+    /// Capture 10-bit v210 (bmdFormat10BitYUV) instead of 8-bit UYVY.
+    /// Read when capture starts; frames carry PixelFormat.YUV422_10bit when enabled.
+    /// </summary>
+    public bool TenBitCapture { get; set; }
+
+    /// <summary>
+    /// Native copy counters and histograms for this input, combined with the ring slot
+    /// and downstream handler timings measured here.
+    /// </summary>
+    public CaptureStatistics? Statistics
+    {
+        get
+        {
+            var stats = new CaptureStatistics
+            {
+                FramesDelivered = Interlocked.Read(ref _framesDelivered),
+                FramesDroppedRingFull = Interlocked.Read(ref _ringFullDrops),
+                RingSlotWait = _ringSlotWait.Snapshot(),
+                Downstream = _downstream.Snapshot()
+            };
+
+            lock (_nativeSessionLock)
+            {
+                if (_nativeSession == IntPtr.Zero)
+                    return stats;
+
+                try
+                {
+                    int size = Marshal.SizeOf<DeckLinkCaptureStats>();
+                    if (GetDeckLinkCaptureStats(_nativeSession, out var native, size) != 1)
+                        return stats;
+
+                    return stats with
+                    {
+                        FramesCaptured = (long)native.FramesGood,
+                        FramesFailed = (long)native.FramesFailed,
+                        FramesCorrupt = (long)native.FramesCorrupt,
+                        FramesPartial = (long)native.FramesPartial,
+                        BytesCopied = (long)native.BytesCopied,
+                        AccessPath = native.AccessPath >= 0 && native.AccessPath < AccessPathNames.Length
+                            ? AccessPathNames[native.AccessPath] : native.AccessPath.ToString(),
+                        AccessPathChanges = (long)native.AccessPathChanges,
+                        CallbackToCopy = native.CallbackToCopy.ToHistogram(),
+                        Copy = native.Copy.ToHistogram(),
+                        FrameInterval = native.FrameInterval.ToHistogram()
+                    };
+                }
+                catch (Exception ex) when (ex is DllNotFoundException or EntryPointNotFoundException)
+                {
+                    return stats;
+                }
+            }
+        }
+    }
+
+    /// <summary>
+    /// Sample a width x height luma plane for the auto-cut detectors during each frame copy.
+    /// Takes effect on the next frame; zero disables it.
+    /// </summary>
+    public void SetAnalysisLumaSize(int width, int height)
+    {
+        bool enabled = width > 0 && height > 0 && width <= MediaKernels.MaxLumaWidth;
+        Interlocked.Exchange(ref _analysisLumaSize, enabled ? ((long)width << 32) | (uint)height : 0);
+    }
+
+    /// <summary>
+    /// Build the 1/divisor preview level into each frame's ring slot while subscribed.
+    /// 10-bit (v210) frames carry no pyramid.
+    /// </summary>
+    public IDisposable SubscribePreviewLevel(int divisor) => _previewPyramid.Subscribe(divisor);
+
+    /// <summary>
+    /// Zero the capture statistics (native and managed).
+    /// </summary>
+    public void ResetStatistics()
+    {
+        _ringSlotWait.Reset();
+        _downstream.Reset();
+        Interlocked.Exchange(ref _framesDelivered, 0);
+        Interlocked.Exchange(ref _ringFullDrops, 0);
+
+        lock (_nativeSessionLock)
+        {
+            if (_nativeSession != IntPtr.Zero)
+                ResetDeckLinkCaptureStats(_nativeSession);
+        }
+    }
+
     public VideoConnector SelectedConnector
     {
         get => _selectedConnector;
@@ -727,7 +985,11 @@ public sealed class DeckLinkCaptureDevice : ICaptureDevice, IDeckLinkInputCallba
         try
         {
             SetStatus(DeviceStatus.Initializing);
-            _currentMode = mode;
+            // Supported modes are enumerated as 10-bit; report what we actually capture
+            _currentMode = mode with
+            {
+                PixelFormat = TenBitCapture ? PixelFormat.YUV422_10bit : PixelFormat.YUV422_8bit
+            };
             _frameCount = 0;
 
             if (_isSimulated)
@@ -759,10 +1021,36 @@ public sealed class DeckLinkCaptureDevice : ICaptureDevice, IDeckLinkInputCallba
             // Give hardware time to switch connectors
             await Task.Delay(500, ct);
 
+            // Create (or reset) the native capture session for this input
+            if (_nativeSession == IntPtr.Zero)
+            {
+                lock (_nativeSessionLock)
+                {
+                    _nativeSession = CreateDeckLinkCaptureSession();
+                }
+            }
+            else
+            {
+                ResetDeckLinkCaptureSession(_nativeSession);
+            }
+
+            // UHD frames (16-33 MB) are split across a few copy threads so the
+            // DeckLink callback thread isn't stalled for the whole copy
+            if (mode.Width >= 3840 && Interlocked.Exchange(ref _copyPoolConfigured, 1) == 0)
+            {
+                var threads = Math.Clamp(Environment.ProcessorCount / 4, 1, UhdCopyThreads);
+                var workers = SetDeckLinkCopyThreads(threads, 0);
+                _logger.LogInformation("Native frame copy: kernel={Kernel}, {Workers} worker threads",
+                    GetDeckLinkCopyKernel(), workers);
+            }
+
             // Determine the BMD display mode
             var bmdMode = GetBMDDisplayMode(mode);
-            // Use 8-bit YUV (UYVY) - native hardware format for best compatibility
-            _capturePixelFormat = BMDPixelFormat.bmdFormat8BitYUV;
+            // 8-bit YUV (UYVY) is the native hardware format and the default for best
+            // compatibility; 10-bit v210 is opt-in
+            _capturePixelFormat = TenBitCapture
+                ? BMDPixelFormat.bmdFormat10BitYUV
+                : BMDPixelFormat.bmdFormat8BitYUV;
 
             // Enable video input
             _logger.LogInformation("Enabling video input: Mode={Mode}, PixelFormat={PixelFormat}",
@@ -797,6 +1085,10 @@ public sealed class DeckLinkCaptureDevice : ICaptureDevice, IDeckLinkInputCallba
                 _logger.LogWarning("Failed to enable audio input: 0x{ErrorCode:X8}", hr);
                 // Continue without audio
             }
+            else
+            {
+                StartAudioDispatch();
+            }
 
             // Set callback
             hr = _deckLinkInput.SetCallback(this);
@@ -916,12 +1208,21 @@ public sealed class DeckLinkCaptureDevice : ICaptureDevice, IDeckLinkInputCallba
                 _deckLinkInput.DisableAudioInput();
             }
 
+            StopAudioDispatch();
         }
 
+        ReleaseLastGoodFrame();
         _currentMode = null;
         SetStatus(DeviceStatus.Idle);
     }
 
+    private void ReleaseLastGoodFrame()
+    {
+        _lastGoodFrameLease?.Dispose();
+        _lastGoodFrameLease = null;
+        _lastGoodFrame = null;
+    }
+
     // IDeckLinkInputCallback implementation
     public int VideoInputFormatChanged(
         BMDVideoInputFormatChangedEvents notificationEvents,
@@ -946,7 +1247,6 @@ public sealed class DeckLinkCaptureDevice : ICaptureDevice, IDeckLinkInputCallba
                               fieldDominance == BMDFieldDominance.bmdUpperFieldFirst;
 
             // Determine pixel format from what we're actually capturing
-            // _capturePixelFormat is set to bmdFormat8BitYUV, so use YUV422_8bit
             var pixelFormat = _capturePixelFormat == BMDPixelFormat.bmdFormat8BitYUV
                 ? PixelFormat.YUV422_8bit
                 : PixelFormat.YUV422_10bit;
@@ -1005,6 +1305,12 @@ public sealed class DeckLinkCaptureDevice : ICaptureDevice, IDeckLinkInputCallba
             hr = _deckLinkInput.DisableVideoInput();
             _logger.LogDebug("DisableVideoInput result: 0x{HR:X8}", hr);
 
+            // Geometry (and possibly the access path) changes with the display mode
+            if (_nativeSession != IntPtr.Zero)
+            {
+                ResetDeckLinkCaptureSession(_nativeSession);
+            }
+
             // 3. Re-enable video input with the detected format
             // Note: Memory allocator is already set from initial EnableVideoInput call
             hr = _deckLinkInput.EnableVideoInput(
@@ -1041,14 +1347,23 @@ public sealed class DeckLinkCaptureDevice : ICaptureDevice, IDeckLinkInputCallba
     {
         try
         {
+            // Video and the audio delivered with it share the frame's stream time (100 ns units)
+            long streamTime = -1;
+            if (videoFrame != null && videoFrame.GetStreamTime(out var frameTime, out _, TimeSpan.TicksPerSecond) == DeckLinkHResult.S_OK)
+                streamTime = frameTime;
+
             if (videoFrame != null && _currentMode != null)
             {
-                ProcessVideoFrame(videoFrame);
+                // Stamp callback entry so the native stats can split callback -> copy latency
+                if (_nativeSession != IntPtr.Zero)
+                    MarkDeckLinkSessionCallback(_nativeSession, Stopwatch.GetTimestamp());
+
+                ProcessVideoFrame(videoFrame, streamTime);
             }
 
             if (audioPacket != null)
             {
-                ProcessAudioPacket(audioPacket);
+                ProcessAudioPacket(audioPacket, streamTime);
             }
         }
         catch (Exception ex)
@@ -1059,7 +1374,7 @@ public sealed class DeckLinkCaptureDevice : ICaptureDevice, IDeckLinkInputCallba
         return DeckLinkHResult.S_OK;
     }
 
-    private void ProcessVideoFrame(IDeckLinkVideoInputFrame frame)
+    private void ProcessVideoFrame(IDeckLinkVideoInputFrame frame, long streamTime)
     {
         if (_currentMode == null) return;
 
@@ -1084,7 +1399,7 @@ public sealed class DeckLinkCaptureDevice : ICaptureDevice, IDeckLinkInputCallba
 
         // Determine actual pixel format from frame
         // For 8-bit UYVY (bmdFormat8BitYUV): rowBytes = width * 2
-        // For 10-bit YUV (bmdFormat10BitYUV): rowBytes = width * 16/6 (packed format)
+        // For 10-bit YUV (bmdFormat10BitYUV): v210, 6 pixels per 16 bytes, rows padded to 128 bytes
         var actualPixelFormat = bmdPixelFormat switch
         {
             BMDPixelFormat.bmdFormat8BitYUV => PixelFormat.YUV422_8bit,
@@ -1093,9 +1408,10 @@ public sealed class DeckLinkCaptureDevice : ICaptureDevice, IDeckLinkInputCallba
         };
 
         // Calculate expected rowBytes based on pixel format
-        int expectedRowBytes = actualPixelFormat == PixelFormat.YUV422_8bit
-            ? width * 2                    // 8-bit UYVY: 2 bytes per pixel
-            : (width * 16 + 5) / 6;        // 10-bit packed: 16 bits per 6 pixels (roughly 2.67 bytes/pixel)
+        bool isV210 = actualPixelFormat == PixelFormat.YUV422_10bit;
+        int expectedRowBytes = isV210
+            ? MediaKernels.V210RowBytes(width)  // 5120 for 1920 width
+            : width * 2;                        // 8-bit UYVY: 2 bytes per pixel
 
         // Log every 100 frames for debugging
         if (_frameCount % 100 == 0)
@@ -1126,46 +1442,58 @@ public sealed class DeckLinkCaptureDevice : ICaptureDevice, IDeckLinkInputCallba
                 _frameCount, width, height, rowBytes, (uint)flags);
         }
 
-        var frameSize = rowBytes * height;
-
-        // Initialize ring buffer if needed (to avoid DMA buffer recycling issues)
-        // Ring buffer allows us to copy immediately and queue for processing
-        lock (_ringBufferLock)
-        {
-            if (_ringBuffer == null || _ringBuffer[0].Length != frameSize)
-            {
-                _ringBuffer = new byte[RingBufferSlots][];
-                for (int i = 0; i < RingBufferSlots; i++)
-                {
-                    _ringBuffer[i] = new byte[frameSize];
-                }
-                _logger.LogInformation("Initialized ring buffer: {Slots} slots x {Size} bytes", RingBufferSlots, frameSize);
-            }
-        }
-
-        // Get the current write slot
-        byte[] currentSlot;
-        lock (_ringBufferLock)
-        {
-            currentSlot = _ringBuffer![_ringBufferWriteIndex];
-            _ringBufferWriteIndex = (_ringBufferWriteIndex + 1) % RingBufferSlots;
-        }
-
-        // Reuse unmanaged buffer for native copy
-        if (_unmanagedBuffer == IntPtr.Zero || _unmanagedBufferSize != frameSize)
-        {
-            if (_unmanagedBuffer != IntPtr.Zero)
+        // The native copy drops HANC (pitch beyond the active row) and VANC rows on the way
+        // into the slot, so slots are tightly packed at activeRowBytes. If the reported pitch
+        // is too small for the format, copy the frame as-is.
+        int activeRowBytes = isV210 ? MediaKernels.V210RowBytes(width) : width * 2;
+        bool cropFrame = rowBytes >= activeRowBytes;
+        int slotRowBytes = cropFrame ? activeRowBytes : rowBytes;
+        var crop = new DeckLinkCropRegion { SkipRows = -1, SkipBytes = rowBytes - activeRowBytes, RowBytes = activeRowBytes };
+        var frameSize = slotRowBytes * height;
+
+        var lumaSize = Interlocked.Read(ref _analysisLumaSize);
+        int lumaWidth = (int)(lumaSize >> 32);
+        int lumaHeight = (int)(uint)lumaSize;
+        int pyramidLevels = _previewPyramid.Levels;
+        int pyramidSize = cropFrame ? PreviewPyramidBuilder.BufferSize(actualPixelFormat, width, height, pyramidLevels) : 0;
+
+        // Initialize ring buffer if needed (to avoid DMA buffer recycling issues).
+        // Only this callback thread touches _frameRing; consumers holding leases on a
+        // replaced ring keep its slots alive until they dispose them.
+        var ring = _frameRing;
+        if (ring == null || ring.SlotSize != frameSize || ring.LumaSize != lumaWidth * lumaHeight || ring.PyramidSize != pyramidSize)
+        {
+            ring = new FrameRing(RingBufferSlots, frameSize, lumaWidth * lumaHeight, pyramidSize);
+            _frameRing = ring;
+            ReleaseLastGoodFrame();
+            _logger.LogInformation("Initialized pinned ring buffer: {Slots} slots x {Size} bytes, luma {LumaWidth}x{LumaHeight}, preview pyramid {PyramidSize} bytes",
+                RingBufferSlots, frameSize, lumaWidth, lumaHeight, pyramidSize);
+        }
+
+        // Claim the oldest slot no consumer is still reading
+        var slotStart = Stopwatch.GetTimestamp();
+        var currentSlot = ring.TryBeginWrite();
+        _ringSlotWait.RecordSince(slotStart);
+        if (currentSlot == null)
+        {
+            var drops = Interlocked.Increment(ref _ringFullDrops);
+            if (drops <= 5 || drops % 100 == 0)
             {
-                Marshal.FreeHGlobal(_unmanagedBuffer);
+                _logger.LogWarning("Frame {FrameCount}: all {Slots} ring slots leased by consumers, dropping frame ({Drops} total)",
+                    _frameCount, RingBufferSlots, drops);
             }
-            _unmanagedBuffer = Marshal.AllocHGlobal(frameSize);
-            _unmanagedBufferSize = frameSize;
+            return;
         }
 
         // CRITICAL: Copy frame data IMMEDIATELY using native DLL
         // GetBytes was removed from IDeckLinkVideoFrame in SDK 14.3.
         // Native DLL uses IDeckLinkVideoBuffer::GetBytes, legacy v14.2.1 GetBytes, or offset-280 fallback.
+        // The slot is pinned, so the DMA buffer is copied directly into it: one copy per good
+        // frame, plus a copy of the last good slot into this one when the frame is bad.
         bool copySuccess = false;
+        bool usedCachedFrame = false;
+        bool lumaWritten = false;
+        var lumaSlot = ring.ClaimedLuma;
         try
         {
             // Use GetIUnknownForObject to get the raw native IUnknown pointer
@@ -1175,39 +1503,55 @@ public sealed class DeckLinkCaptureDevice : ICaptureDevice, IDeckLinkInputCallba
                 try
                 {
                     // Native DLL copies from DMA buffer using SEH-protected memory access
-                    // Returns: 1 = success, 0 = not enough data, -1 = data looks corrupt (BGRA-like)
-                    int result = CopyDeckLinkFrameBytes(framePtr, _unmanagedBuffer, frameSize);
+                    // Returns: 1 = success, 0 = not enough data, -1 = data looks corrupt (BGRA-like),
+                    // -2 = part of the buffer was unreadable (black-filled)
+                    IntPtr slotPtr = Marshal.UnsafeAddrOfPinnedArrayElement(currentSlot, 0);
+                    int result = lumaSlot != null && _nativeSession != IntPtr.Zero && !_lumaCopyUnavailable
+                        ? CopyFrameWithLuma(framePtr, cropFrame, ref crop, slotPtr, frameSize, lumaSlot, lumaWidth, lumaHeight, out lumaWritten)
+                        : cropFrame
+                            ? CopyDeckLinkSessionFrameCropped(_nativeSession, framePtr, ref crop, slotPtr, frameSize)
+                            : _nativeSession != IntPtr.Zero
+                                ? CopyDeckLinkSessionFrame(_nativeSession, framePtr, slotPtr, frameSize)
+                                : CopyDeckLinkFrameBytes(framePtr, slotPtr, frameSize);
 
                     if (result == 1)
                     {
-                        // Good frame - copy to ring buffer slot
-                        Marshal.Copy(_unmanagedBuffer, currentSlot, 0, frameSize);
+                        // Good frame - already written into the ring buffer slot
                         copySuccess = true;
 
+                        if (_frameCount == 5 && _nativeSession != IntPtr.Zero)
+                        {
+                            _logger.LogInformation("Native capture session resolved access path {Path}",
+                                GetDeckLinkSessionAccessPath(_nativeSession));
+                        }
+
                         if (_frameCount <= 5)
                         {
-                            int midOffset = (height / 2) * rowBytes + (width / 2) * 2;
+                            int midOffset = (height / 2) * slotRowBytes + PixelByteOffset(width / 2, isV210);
                             _logger.LogInformation("Frame {FrameCount}: Copied {Size} bytes. First: {B0:X2}{B1:X2}{B2:X2}{B3:X2}, Mid: {M0:X2}{M1:X2}{M2:X2}{M3:X2}",
                                 _frameCount, frameSize,
                                 currentSlot[0], currentSlot[1], currentSlot[2], currentSlot[3],
                                 currentSlot[midOffset], currentSlot[midOffset + 1], currentSlot[midOffset + 2], currentSlot[midOffset + 3]);
                         }
                     }
-                    else if (result == -1)
+                    else if (result == -1 || result == -2)
                     {
-                        // Corrupt frame detected by native DLL - use cached frame if available
-                        if (_lastGoodFrameCache != null && _lastGoodFrameCache.Length == frameSize)
+                        // Corrupt or partially copied frame - use cached frame if available
+                        var reason = result == -1 ? "Corrupt data" : "Partial copy";
+                        if (_lastGoodFrame != null && _lastGoodFrame.Length == frameSize)
                         {
-                            Buffer.BlockCopy(_lastGoodFrameCache, 0, currentSlot, 0, frameSize);
+                            Buffer.BlockCopy(_lastGoodFrame, 0, currentSlot, 0, frameSize);
                             copySuccess = true;
+                            usedCachedFrame = true;
+                            lumaWritten = false;
                             if (_frameCount <= 20 || _frameCount % 100 == 0)
                             {
-                                _logger.LogWarning("Frame {FrameCount}: Corrupt data detected, using cached frame", _frameCount);
+                                _logger.LogWarning("Frame {FrameCount}: {Reason} detected, using cached frame", _frameCount, reason);
                             }
                         }
                         else if (_frameCount <= 5)
                         {
-                            _logger.LogWarning("Frame {FrameCount}: Corrupt data, no cache available", _frameCount);
+                            _logger.LogWarning("Frame {FrameCount}: {Reason}, no cache available", _frameCount, reason);
                         }
                     }
                     else if (_frameCount <= 5)
@@ -1232,115 +1576,61 @@ public sealed class DeckLinkCaptureDevice : ICaptureDevice, IDeckLinkInputCallba
         // If copy failed, skip frame
         if (!copySuccess)
         {
+            ring.Abandon();
             return;
         }
 
-        // Check multiple points for black fill pattern (indicates partial frame copy)
-        // The native DLL fills failed regions with 0x80, 0x10, 0x80, 0x10
-        bool frameValid = true;
-        int badPoints = 0;
-
-        // Calculate HANC offset: DeckLink may include horizontal blanking at the start of each row
-        int activeVideoBytes = width * 2;  // UYVY: 2 bytes per pixel
-        int hancOffset = rowBytes > activeVideoBytes ? rowBytes - activeVideoBytes : 0;
-
-        // Check points for visual quality - focus on what the user sees
-        // NOTE: End-of-frame region consistently fails due to DMA timing (last 64KB)
-        // so we don't check there - instead we check the visible middle portion
-        int[] checkOffsets = new int[]
-        {
-            // Quadrant centers (visual quality check)
-            (height / 4) * rowBytes + hancOffset + (width / 4) * 2,
-            (height / 4) * rowBytes + hancOffset + (3 * width / 4) * 2,
-            (3 * height / 4) * rowBytes + hancOffset + (width / 4) * 2,
-            (3 * height / 4) * rowBytes + hancOffset + (3 * width / 4) * 2,
-            (height / 2) * rowBytes + hancOffset + (width / 2) * 2,
-            // Additional points spread across the frame (avoid end-of-frame region)
-            (height / 8) * rowBytes + hancOffset + (width / 2) * 2,
-            (3 * height / 8) * rowBytes + hancOffset + (width / 2) * 2,
-            (5 * height / 8) * rowBytes + hancOffset + (width / 2) * 2,
-            (7 * height / 8) * rowBytes + hancOffset + (width / 2) * 2,
-        };
-
-        foreach (int offset in checkOffsets)
+        // Skip first 15 frames to avoid startup instability (DMA buffers settling)
+        // Native DLL shows frames 1-3 fail, and frames 4-5 have incomplete data
+        if (_frameCount <= 15)
         {
-            if (offset >= 0 && offset + 3 < frameSize)
+            if (_frameCount == 15)
             {
-                byte u = currentSlot[offset];
-                byte y0 = currentSlot[offset + 1];
-                byte v = currentSlot[offset + 2];
-                byte y1 = currentSlot[offset + 3];
-
-                // Check for corruption patterns:
-                // 1. Black fill pattern from native DLL (indicates failed copy region)
-                // 2. All-zeros (uninitialized or failed copy)
-                // Note: Y=255 is valid super-white in UYVY, don't reject it
-                // Note: Y<16 can occur in valid dark scenes, only reject if ALL checked points are bad
-                bool isBlackFill = (u == 0x80 && y0 == 0x10 && v == 0x80 && y1 == 0x10);
-                bool isZeros = (u == 0 && y0 == 0 && v == 0 && y1 == 0);
-
-                if (isBlackFill || isZeros)
-                {
-                    badPoints++;
-                }
+                _logger.LogInformation("Startup frames complete, beginning display");
             }
+            ring.Abandon();
+            return;
         }
 
-        // Only reject if majority of check points are bad (avoids rejecting legitimate black scenes)
-        // blackFill = 80 10 80 10 is valid UYVY black, so single point match is not corruption
-        if (badPoints >= 5) // 5 out of 9 points = majority
-        {
-            frameValid = false;
-        }
-
-        if (frameValid)
+        // Copies that did not sample luma (fallback paths, cached frame) extract it from the slot
+        LumaPlane? analysisLuma = null;
+        if (lumaSlot != null)
         {
-            // Update cache with good frame for corrupt frame recovery
-            if (_lastGoodFrameCache == null || _lastGoodFrameCache.Length != frameSize)
+            if (!lumaWritten)
             {
-                _lastGoodFrameCache = new byte[frameSize];
-            }
-            Buffer.BlockCopy(currentSlot, 0, _lastGoodFrameCache, 0, frameSize);
-        }
-        else
-        {
-            // Use cached frame if available
-            if (_lastGoodFrameCache != null && _lastGoodFrameCache.Length == frameSize)
-            {
-                Buffer.BlockCopy(_lastGoodFrameCache, 0, currentSlot, 0, frameSize);
-            }
-            else
-            {
-                // No cache yet, skip frame
-                return;
+                lumaWritten = MediaKernels.TryExtractLumaSad(currentSlot.AsSpan(0, frameSize), slotRowBytes, width, height, isV210,
+                    lumaSlot, lumaWidth, lumaHeight, ReadOnlySpan<byte>.Empty, 0, 0, 0, 0, out _);
             }
+            if (lumaWritten)
+                analysisLuma = new LumaPlane(lumaSlot, lumaWidth, lumaHeight);
         }
 
-        // Skip first 15 frames to avoid startup instability (DMA buffers settling)
-        // Native DLL shows frames 1-3 fail, and frames 4-5 have incomplete data
-        if (_frameCount <= 15)
+        // Preview levels come from the slot too, so they are covered by the same lease
+        PreviewPyramid? pyramid = null;
+        var pyramidSlot = ring.ClaimedPyramid;
+        if (pyramidSlot != null)
         {
-            if (_frameCount == 15)
-            {
-                _logger.LogInformation("Startup frames complete, beginning display");
-            }
-            return;
+            pyramid = PreviewPyramidBuilder.Build(currentSlot.AsSpan(0, frameSize), slotRowBytes, width, height,
+                pyramidSlot, pyramidLevels);
         }
 
-        // Use frame rate from current mode for accurate timestamp
+        // Stream time from the hardware clock, which the audio is stamped from too;
+        // frames counted at the mode's rate if the frame has none
         var frameRate = _currentMode.FrameRate.Value > 0 ? _currentMode.FrameRate.Value : 30.0;
-        var timestamp = TimeSpan.FromSeconds(_frameCount / frameRate);
+        var timestamp = streamTime >= 0 ? TimeSpan.FromTicks(streamTime) : TimeSpan.FromSeconds(_frameCount / frameRate);
+
+        // Publish the slot and hand it to consumers directly; it is not rewritten until
+        // the producer has cycled through the other slots, or later while it is leased
+        var sequence = ring.Publish();
 
-        // Copy to pooled event buffer (avoids 4MB allocation per frame at 60fps)
-        if (_eventBufferPool == null || _eventBufferPool[0].Length != frameSize)
+        // Partial copies are reported by the native DLL (-2), so a frame that made it here
+        // without the cache is complete; lease its slot for corrupt/partial frame recovery.
+        // The leased slot is always the newest, which the producer reaches last anyway.
+        if (!usedCachedFrame)
         {
-            _eventBufferPool = new byte[EventBufferPoolSize][];
-            for (int i = 0; i < EventBufferPoolSize; i++)
-                _eventBufferPool[i] = new byte[frameSize];
+            ReleaseLastGoodFrame();
+            _lastGoodFrameLease = ring.TryLease(sequence, out _lastGoodFrame);
         }
-        var eventBuffer = _eventBufferPool[_eventBufferIndex];
-        _eventBufferIndex = (_eventBufferIndex + 1) % EventBufferPoolSize;
-        Buffer.BlockCopy(currentSlot, 0, eventBuffer, 0, frameSize);
 
         // Create an accurate mode reflecting the actual frame properties
         // This ensures downstream code (like YUV conversion) uses correct pixel format
@@ -1352,60 +1642,233 @@ public sealed class DeckLinkCaptureDevice : ICaptureDevice, IDeckLinkInputCallba
             _currentMode.IsInterlaced,
             _currentMode.DisplayName);
 
+        var deliverStart = Stopwatch.GetTimestamp();
         VideoFrameReceived?.Invoke(this, new VideoFrameEventArgs
         {
-            FrameData = eventBuffer.AsMemory(),
+            FrameData = currentSlot.AsMemory(0, frameSize),
             Mode = actualMode,
             Timestamp = timestamp,
-            FrameNumber = _frameCount
+            FrameNumber = _frameCount,
+            Sequence = sequence,
+            LeaseSource = ring,
+            AnalysisLuma = analysisLuma,
+            Pyramid = pyramid
         });
+        _downstream.RecordSince(deliverStart);
+        Interlocked.Increment(ref _framesDelivered);
+
+        if (_frameCount % StatisticsLogInterval == 0)
+            LogStatistics();
+    }
+
+    private unsafe int CopyFrameWithLuma(IntPtr framePtr, bool cropFrame, ref DeckLinkCropRegion crop, IntPtr slotPtr, int frameSize,
+        byte[] luma, int lumaWidth, int lumaHeight, out bool lumaWritten)
+    {
+        try
+        {
+            int written;
+            int result;
+            fixed (DeckLinkCropRegion* cropPtr = &crop)
+            {
+                result = CopyDeckLinkSessionFrameWithLuma(_nativeSession, framePtr, cropFrame ? cropPtr : null, slotPtr, frameSize,
+                    Marshal.UnsafeAddrOfPinnedArrayElement(luma, 0), lumaWidth, lumaHeight, out written);
+            }
+            lumaWritten = written != 0;
+            return result;
+        }
+        catch (EntryPointNotFoundException)
+        {
+            // Older native DLL: copy without luma from now on and extract it from the slot
+            _lumaCopyUnavailable = true;
+            _logger.LogWarning("Native DLL has no CopyDeckLinkSessionFrameWithLuma, detector luma will be extracted after the copy");
+            lumaWritten = false;
+            return cropFrame
+                ? CopyDeckLinkSessionFrameCropped(_nativeSession, framePtr, ref crop, slotPtr, frameSize)
+                : CopyDeckLinkSessionFrame(_nativeSession, framePtr, slotPtr, frameSize);
+        }
+    }
+
+    private void LogStatistics()
+    {
+        var stats = Statistics;
+        if (stats == null) return;
+
+        _logger.LogInformation(
+            "Capture stats {Device}: captured={Captured} delivered={Delivered} failed={Failed} corrupt={Corrupt} partial={Partial} " +
+            "path={Path} copy avg/p99/max={CopyAvg:F0}/{CopyP99}/{CopyMax}us ({Throughput:F0} MB/s) " +
+            "callback->copy p99={CallbackP99}us interval max={IntervalMax}us ringSlot max={SlotMax}us ringFull={RingFull} downstream p99/max={DownP99}/{DownMax}us",
+            DisplayName, stats.FramesCaptured, stats.FramesDelivered, stats.FramesFailed, stats.FramesCorrupt, stats.FramesPartial,
+            stats.AccessPath, stats.Copy.AverageMicroseconds, stats.Copy.PercentileMicroseconds(0.99), stats.Copy.MaxMicroseconds,
+            stats.CopyThroughputMBps, stats.CallbackToCopy.PercentileMicroseconds(0.99), stats.FrameInterval.MaxMicroseconds,
+            stats.RingSlotWait.MaxMicroseconds, stats.FramesDroppedRingFull, stats.Downstream.PercentileMicroseconds(0.99), stats.Downstream.MaxMicroseconds);
     }
 
     private long _audioPacketCount;
 
-    private void ProcessAudioPacket(IDeckLinkAudioInputPacket packet)
+    private void ProcessAudioPacket(IDeckLinkAudioInputPacket packet, long streamTime)
     {
         _audioPacketCount++;
-        var sampleCount = packet.GetSampleFrameCount();
-        packet.GetBytes(out var bufferPtr);
+
+        var ring = _audioRing;
+        if (ring == null) return;
+
+        int frames = _audioCopyUnavailable
+            ? CopyAudioPacketManaged(packet, ring, out long packetTime)
+            : CopyAudioPacket(packet, ring, out packetTime);
 
         if (_audioPacketCount <= 5 || _audioPacketCount % 500 == 0)
         {
-            _logger.LogInformation("Audio packet {Count}: samples={Samples}, bufferPtr={Ptr}",
-                _audioPacketCount, sampleCount, bufferPtr);
+            _logger.LogInformation("Audio packet {Count}: samples={Samples}, streamTime={StreamTime}, packetTime={PacketTime}",
+                _audioPacketCount, frames, streamTime, packetTime);
         }
 
-        if (bufferPtr == IntPtr.Zero || sampleCount <= 0) return;
+        if (frames == -2)
+        {
+            // The dispatch thread is behind: drop the packet rather than wait for it
+            int dropped = packet.GetSampleFrameCount() * ring.BlockAlign;
+            ring.CommitWrite(0, dropped: dropped);
+            var overruns = Interlocked.Increment(ref _audioOverruns);
+            if (overruns <= 5 || overruns % 100 == 0)
+            {
+                _logger.LogWarning("Audio packet {Count}: ring full, dropped {Bytes} bytes ({Overruns} packets total)",
+                    _audioPacketCount, dropped, overruns);
+            }
+            return;
+        }
+        if (frames <= 0) return;
 
-        var bytesPerSample = 4; // 32-bit audio
-        var bufferSize = sampleCount * _audioChannels * bytesPerSample;
-        var audioBuffer = new byte[bufferSize];
+        ring.CommitWrite(frames * ring.BlockAlign, TimeSpan.FromTicks(streamTime >= 0 ? streamTime : packetTime));
+        _audioAvailable.Set();
+    }
 
-        Marshal.Copy(bufferPtr, audioBuffer, 0, bufferSize);
+    private unsafe int CopyAudioPacket(IDeckLinkAudioInputPacket packet, AudioRingBuffer ring, out long packetTime)
+    {
+        packetTime = 0;
+        IntPtr packetPtr = Marshal.GetIUnknownForObject(packet);
+        try
+        {
+            ring.GetWriteRegions(ring.Capacity, out var first, out var second);
+            fixed (byte* dst = first.Span)
+            fixed (byte* dstWrap = second.Span)
+            {
+                return CopyDeckLinkAudioPacket(packetPtr, ring.BlockAlign, dst, first.Length, dstWrap, second.Length, out packetTime);
+            }
+        }
+        catch (EntryPointNotFoundException)
+        {
+            // Older native DLL: copy through the packet's COM interface from now on
+            _audioCopyUnavailable = true;
+            _logger.LogWarning("Native DLL has no CopyDeckLinkAudioPacket, audio will be copied through COM interop");
+            return CopyAudioPacketManaged(packet, ring, out packetTime);
+        }
+        finally
+        {
+            Marshal.Release(packetPtr);
+        }
+    }
+
+    private static unsafe int CopyAudioPacketManaged(IDeckLinkAudioInputPacket packet, AudioRingBuffer ring, out long packetTime)
+    {
+        var sampleCount = packet.GetSampleFrameCount();
+        packet.GetBytes(out var bufferPtr);
+        if (packet.GetPacketTime(out packetTime, TimeSpan.TicksPerSecond) != DeckLinkHResult.S_OK)
+            packetTime = 0;
 
-        packet.GetPacketTime(out var packetTime, 10000000);
-        var timestamp = TimeSpan.FromTicks(packetTime);
+        if (sampleCount <= 0) return 0;
+        if (bufferPtr == IntPtr.Zero) return -1;
 
-        AudioSamplesReceived?.Invoke(this, new AudioSamplesEventArgs
+        int size = sampleCount * ring.BlockAlign;
+        if (ring.GetWriteRegions(size, out var first, out var second) < size)
+            return -2;
+
+        var source = new ReadOnlySpan<byte>((void*)bufferPtr, size);
+        source[..first.Length].CopyTo(first.Span);
+        source[first.Length..].CopyTo(second.Span);
+        return sampleCount;
+    }
+
+    private void StartAudioDispatch()
+    {
+        StopAudioDispatch();
+
+        int blockAlign = _audioChannels * AudioBytesPerSample;
+        var ring = new AudioRingBuffer(AudioSampleRate * AudioRingMilliseconds / 1000 * blockAlign, AudioSampleRate, blockAlign);
+        var buffer = GC.AllocateUninitializedArray<byte>(AudioSampleRate * AudioDispatchMilliseconds / 1000 * blockAlign);
+
+        _audioDispatchStopping = false;
+        _audioRing = ring;
+        _audioDispatchThread = new Thread(() => AudioDispatchLoop(ring, buffer))
         {
-            SampleData = audioBuffer.AsMemory(),
-            SampleRate = 48000,
-            Channels = _audioChannels,
-            BitsPerSample = 32,
-            Timestamp = timestamp
-        });
+            IsBackground = true,
+            Name = $"DeckLink audio {DisplayName}",
+            Priority = ThreadPriority.AboveNormal
+        };
+        _audioDispatchThread.Start();
+    }
+
+    /// <summary>
+    /// Stop raising audio. Call once streams are stopped, so no callback is writing the ring.
+    /// </summary>
+    private void StopAudioDispatch()
+    {
+        var thread = _audioDispatchThread;
+        if (thread == null) return;
+
+        _audioDispatchStopping = true;
+        _audioAvailable.Set();
+        thread.Join(TimeSpan.FromSeconds(1));
+
+        _audioDispatchThread = null;
+        _audioRing?.Dispose();
+        _audioRing = null;
+    }
+
+    /// <summary>
+    /// Raises AudioSamplesReceived with whatever the capture thread has written, in one
+    /// reused buffer: SampleData is only valid until the handler returns.
+    /// </summary>
+    private void AudioDispatchLoop(AudioRingBuffer ring, byte[] buffer)
+    {
+        while (!_audioDispatchStopping)
+        {
+            _audioAvailable.WaitOne(AudioDispatchMilliseconds);
+
+            int read;
+            while (!_audioDispatchStopping && (read = ring.Read(buffer, out var timestamp)) > 0)
+            {
+                try
+                {
+                    AudioSamplesReceived?.Invoke(this, new AudioSamplesEventArgs
+                    {
+                        SampleData = buffer.AsMemory(0, read),
+                        SampleRate = ring.SampleRate,
+                        Channels = _audioChannels,
+                        BitsPerSample = AudioBytesPerSample * 8,
+                        Timestamp = timestamp
+                    });
+                }
+                catch (Exception ex)
+                {
+                    _logger.LogError(ex, "Error delivering audio samples");
+                }
+            }
+        }
     }
 
+    // Byte offset of pixel x within a row; v210 offsets round down to the 6-pixel group
+    private static int PixelByteOffset(int x, bool isV210) => isV210 ? x / 6 * 16 : x * 2;
+
     private async Task SimulateCaptureAsync(CancellationToken ct)
     {
         if (_currentMode == null) return;
 
         var frameInterval = TimeSpan.FromSeconds(1.0 / _currentMode.FrameRate.Value);
-        var bytesPerPixel = _currentMode.PixelFormat == PixelFormat.YUV422_10bit ? 4 : 2;
-        var rowBytes = _currentMode.Width * bytesPerPixel;
+        var isV210 = _currentMode.PixelFormat == PixelFormat.YUV422_10bit;
+        var rowBytes = isV210 ? MediaKernels.V210RowBytes(_currentMode.Width) : _currentMode.Width * 2;
         var frameSize = rowBytes * _currentMode.Height;
 
         var frameBuffer = new byte[frameSize];
+        var patternBuffer = isV210 ? new byte[_currentMode.Width * 2 * _currentMode.Height] : frameBuffer;
 
         while (!ct.IsCancellationRequested)
         {
@@ -1416,7 +1879,9 @@ public sealed class DeckLinkCaptureDevice : ICaptureDevice, IDeckLinkInputCallba
                 _frameCount++;
                 var timestamp = TimeSpan.FromSeconds(_frameCount / _currentMode.FrameRate.Value);
 
-                GenerateTestPattern(frameBuffer, _currentMode.Width, _currentMode.Height, _frameCount);
+                GenerateTestPattern(patternBuffer, _currentMode.Width, _currentMode.Height, _frameCount);
+                if (isV210)
+                    PackV210(patternBuffer, frameBuffer, _currentMode.Width, _currentMode.Height, rowBytes);
 
                 VideoFrameReceived?.Invoke(this, new VideoFrameEventArgs
                 {
@@ -1481,6 +1946,24 @@ public sealed class DeckLinkCaptureDevice : ICaptureDevice, IDeckLinkInputCallba
         }
     }
 
+    // Pack an 8-bit UYVY frame into v210: three 10-bit samples per little-endian word, same U Y V Y order
+    private static void PackV210(byte[] uyvy, byte[] v210, int width, int height, int rowBytes)
+    {
+        var samples = width * 2;
+        for (int y = 0; y < height; y++)
+        {
+            var src = y * samples;
+            var dst = y * rowBytes;
+            for (int i = 0; i < samples; i += 3)
+            {
+                uint word = 0;
+                for (int k = 0; k < 3 && i + k < samples; k++)
+                    word |= (uint)(uyvy[src + i + k] << 2) << (10 * k);
+                BinaryPrimitives.WriteUInt32LittleEndian(v210.AsSpan(dst + i / 3 * 4), word);
+            }
+        }
+    }
+
     private void SetStatus(DeviceStatus newStatus)
     {
         var oldStatus = _status;
@@ -1522,14 +2005,19 @@ public sealed class DeckLinkCaptureDevice : ICaptureDevice, IDeckLinkInputCallba
             {
                 _logger.LogError(ex, "Error disposing DeckLink device");
             }
-        }
 
-        // Clean up reusable unmanaged buffer
-        if (_unmanagedBuffer != IntPtr.Zero)
-        {
-            Marshal.FreeHGlobal(_unmanagedBuffer);
-            _unmanagedBuffer = IntPtr.Zero;
-            _unmanagedBufferSize = 0;
+            StopAudioDispatch();
+            _audioAvailable.Dispose();
+
+            // Streams are stopped, so no callback can be using the session any more
+            lock (_nativeSessionLock)
+            {
+                if (_nativeSession != IntPtr.Zero)
+                {
+                    DestroyDeckLinkCaptureSession(_nativeSession);
+                    _nativeSession = IntPtr.Zero;
+                }
+            }
         }
 
         SetStatus(DeviceStatus.Disconnected);
@@ -0,0 +1,52 @@
+using System.Diagnostics;
+using Screener.Abstractions.Capture;
+
+namespace Screener.Capture.Blackmagic;
+
+/// <summary>
+/// Managed counterpart of the native DeckLinkLatencyHistogram, for the stages timed in C#
+/// (ring-buffer lock, downstream handlers). Same bucket layout as <see cref="LatencyHistogram"/>.
+/// Written by the capture thread only; snapshots may be read from any thread.
+/// </summary>
+internal sealed class LatencyRecorder
+{
+    private readonly long[] _buckets = new long[LatencyHistogram.BucketCount];
+    private long _count;
+    private long _totalMicroseconds;
+    private long _maxMicroseconds;
+
+    /// <summary>
+    /// Record the time elapsed since a <see cref="Stopwatch.GetTimestamp"/> value.
+    /// </summary>
+    public void RecordSince(long startTimestamp)
+    {
+        var micros = (Stopwatch.GetTimestamp() - startTimestamp) * 1_000_000 / Stopwatch.Frequency;
+        if (micros < 0) micros = 0;
+
+        int bucket = 0;
+        while (bucket < LatencyHistogram.BucketCount - 1 && micros >= LatencyHistogram.BucketUpperBoundMicroseconds(bucket))
+            bucket++;
+
+        _buckets[bucket]++;
+        _count++;
+        _totalMicroseconds += micros;
+        if (micros > _maxMicroseconds)
+            _maxMicroseconds = micros;
+    }
+
+    public LatencyHistogram Snapshot() => new()
+    {
+        Buckets = (long[])_buckets.Clone(),
+        Count = _count,
+        TotalMicroseconds = _totalMicroseconds,
+        MaxMicroseconds = _maxMicroseconds
+    };
+
+    public void Reset()
+    {
+        Array.Clear(_buckets);
+        _count = 0;
+        _totalMicroseconds = 0;
+        _maxMicroseconds = 0;
+    }
+}
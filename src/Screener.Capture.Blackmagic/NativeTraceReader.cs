@@ -0,0 +1,134 @@
+using System.Runtime.InteropServices;
+using Microsoft.Extensions.Logging;
+
+namespace Screener.Capture.Blackmagic;
+
+/// <summary>
+/// Drains the native DLL's in-memory trace into the logger. The native capture path only
+/// formats messages into per-thread lock-free rings; all I/O happens here, on a timer
+/// thread, so diagnostics never stall the DeckLink DMA callback.
+/// </summary>
+internal sealed class NativeTraceReader : IDisposable
+{
+    private static readonly TimeSpan PollInterval = TimeSpan.FromMilliseconds(250);
+    private const int DrainBufferSize = 64 * 1024;
+
+    // Returns bytes written as '\n'-terminated "<level> <microseconds> <threadId> <message>" lines
+    [DllImport("Screener.Capture.Blackmagic.Native.dll", CallingConvention = CallingConvention.Cdecl)]
+    private static extern int ReadDeckLinkTrace(byte[] buffer, int bufferSize);
+
+    [DllImport("Screener.Capture.Blackmagic.Native.dll", CallingConvention = CallingConvention.Cdecl)]
+    private static extern long GetDeckLinkTraceDropped();
+
+    private readonly ILogger _logger;
+    private readonly Timer _pollTimer;
+    private readonly byte[] _buffer = new byte[DrainBufferSize];
+    private readonly object _drainLock = new();
+    private long _reportedDropped;
+    private bool _unavailable;
+    private bool _disposed;
+
+    public NativeTraceReader(ILogger logger)
+    {
+        _logger = logger;
+        _pollTimer = new Timer(OnPollTimerTick, null, PollInterval, PollInterval);
+    }
+
+    private void OnPollTimerTick(object? state)
+    {
+        // Skip the tick if the previous drain is still logging
+        if (!Monitor.TryEnter(_drainLock))
+            return;
+
+        try
+        {
+            Drain();
+        }
+        finally
+        {
+            Monitor.Exit(_drainLock);
+        }
+    }
+
+    private void Drain()
+    {
+        if (_unavailable)
+            return;
+
+        try
+        {
+            int bytes;
+            while ((bytes = ReadDeckLinkTrace(_buffer, _buffer.Length)) > 0)
+            {
+                LogLines(_buffer.AsSpan(0, bytes));
+
+                // A partly filled buffer means the rings are empty
+                if (bytes < _buffer.Length / 2)
+                    break;
+            }
+
+            var dropped = GetDeckLinkTraceDropped();
+            if (dropped != _reportedDropped)
+            {
+                _logger.LogWarning("Native trace dropped {Count} messages (ring full)", dropped - _reportedDropped);
+                _reportedDropped = dropped;
+            }
+        }
+        catch (Exception ex) when (ex is DllNotFoundException or EntryPointNotFoundException)
+        {
+            // Native DLL missing or older than this build - nothing to drain
+            _unavailable = true;
+        }
+    }
+
+    private void LogLines(ReadOnlySpan<byte> text)
+    {
+        while (!text.IsEmpty)
+        {
+            int end = text.IndexOf((byte)'\n');
+            var line = end >= 0 ? text[..end] : text;
+            text = end >= 0 ? text[(end + 1)..] : ReadOnlySpan<byte>.Empty;
+
+            // "<level> <microseconds> <threadId> <message>"
+            int s1 = line.IndexOf((byte)' ');
+            if (s1 <= 0) continue;
+            int s2 = line[(s1 + 1)..].IndexOf((byte)' ');
+            if (s2 < 0) continue;
+            s2 += s1 + 1;
+            int s3 = line[(s2 + 1)..].IndexOf((byte)' ');
+            if (s3 < 0) continue;
+            s3 += s2 + 1;
+
+            var level = (line[0] - (byte)'0') switch
+            {
+                1 => LogLevel.Error,
+                2 => LogLevel.Warning,
+                3 => LogLevel.Information,
+                _ => LogLevel.Debug
+            };
+
+            if (!_logger.IsEnabled(level))
+                continue;
+
+            var micros = System.Text.Encoding.ASCII.GetString(line[(s1 + 1)..s2]);
+            var threadId = System.Text.Encoding.ASCII.GetString(line[(s2 + 1)..s3]);
+            var message = System.Text.Encoding.ASCII.GetString(line[(s3 + 1)..]);
+
+            _logger.Log(level, "{Message} (native thread {ThreadId}, t={Micros}us)", message, threadId, micros);
+        }
+    }
+
+    public void Dispose()
+    {
+        if (_disposed) return;
+        _disposed = true;
+
+        _pollTimer.Dispose();
+
+        // Flush whatever the capture threads wrote since the last tick
+        lock (_drainLock)
+        {
+            Drain();
+        }
+    }
+}
@@ -2,6 +2,8 @@ using System.Runtime.InteropServices;
 using Microsoft.Extensions.Logging;
 using Screener.Abstractions.Capture;
 using Screener.Capture.Ndi.Interop;
+using Screener.Core.Capture;
+using Screener.Core.Native;
 
 namespace Screener.Capture.Ndi;
 
@@ -25,10 +27,15 @@ public sealed class NdiCaptureDevice : ICaptureDevice
     private long _frameCount;
     private bool _disposed;
 
-    // Pooled event buffers to reduce GC pressure (same pattern as DeckLinkCaptureDevice)
-    private const int EventBufferPoolSize = 3;
-    private byte[][]? _eventBufferPool;
-    private int _eventBufferIndex;
+    // Frames are handed to VideoFrameReceived in the SDK's own buffers, held until the last
+    // consumer's lease is released (see NdiFrameRing); more than this many held drops frames
+    private const int FrameRingSlots = 5;
+    private NdiFrameRing? _frameRing;
+    private long _ringFullDrops;
+    private long _suspectFrameCount;
+
+    // Preview levels consumers subscribed to, built into the frame's ring slot
+    private readonly PreviewPyramidBuilder _previewPyramid = new();
 
     public string DeviceId { get; }
     public string DisplayName { get; }
@@ -54,6 +61,11 @@ public sealed class NdiCaptureDevice : ICaptureDevice
     public event EventHandler<AudioSamplesEventArgs>? AudioSamplesReceived;
     public event EventHandler<DeviceStatusChangedEventArgs>? StatusChanged;
 
+    /// <summary>
+    /// Build the 1/divisor preview level with each UYVY frame while subscribed (BGRA frames have none).
+    /// </summary>
+    public IDisposable SubscribePreviewLevel(int divisor) => _previewPyramid.Subscribe(divisor);
+
     public NdiCaptureDevice(string deviceId, string sourceName, string sourceUrl, ILogger logger)
     {
         DeviceId = deviceId;
@@ -123,6 +135,8 @@ public sealed class NdiCaptureDevice : ICaptureDevice
                 return Task.FromResult(false);
             }
 
+            _frameRing = new NdiFrameRing(_recvInstance, FrameRingSlots);
+
             // Start the background receive loop
             _captureCts = CancellationTokenSource.CreateLinkedTokenSource(ct);
             _captureTask = Task.Run(() => ReceiveLoopAsync(_captureCts.Token), _captureCts.Token);
@@ -157,8 +171,9 @@ public sealed class NdiCaptureDevice : ICaptureDevice
                 switch (frameType)
                 {
                     case NdiConstants.NDIlib_frame_type_video:
-                        ProcessVideoFrame(ref videoFrame);
-                        NdiInterop.NDIlib_recv_free_video_v2(_recvInstance, ref videoFrame);
+                        // Frames taken by the ring are freed when their last lease is released
+                        if (!ProcessVideoFrame(ref videoFrame))
+                            NdiInterop.NDIlib_recv_free_video_v2(_recvInstance, ref videoFrame);
                         break;
 
                     case NdiConstants.NDIlib_frame_type_audio:
@@ -190,10 +205,15 @@ public sealed class NdiCaptureDevice : ICaptureDevice
         _logger.LogDebug("NDI receive loop ended for {Source}", _sourceName);
     }
 
-    private void ProcessVideoFrame(ref NDIlib_video_frame_v2_t frame)
+    /// <summary>
+    /// Publish a received frame. Returns true if the frame ring took ownership of it,
+    /// false if the caller still has to free it.
+    /// </summary>
+    private bool ProcessVideoFrame(ref NDIlib_video_frame_v2_t frame)
     {
-        if (frame.p_data == IntPtr.Zero || frame.xres <= 0 || frame.yres <= 0)
-            return;
+        var ring = _frameRing;
+        if (ring == null || frame.p_data == IntPtr.Zero || frame.xres <= 0 || frame.yres <= 0)
+            return false;
 
         _frameCount++;
 
@@ -239,34 +259,66 @@ public sealed class NdiCaptureDevice : ICaptureDevice
                 _frameCount, width, height, stride, frame.FourCC);
         }
 
-        // Allocate or reuse pooled event buffer
-        if (_eventBufferPool == null || _eventBufferPool[0].Length != frameSize)
+        // Sanity-check UYVY frames in the receive buffer before copying; some senders
+        // mislabel BGRA. Sampling is cheap, so only logs (rate limited) on a hit.
+        if (isUyvy && MediaKernels.LooksLikeCorruptBgra(frame.p_data, frameSize, width, height, stride))
         {
-            _eventBufferPool = new byte[EventBufferPoolSize][];
-            for (int i = 0; i < EventBufferPoolSize; i++)
+            _suspectFrameCount++;
+            if (_suspectFrameCount <= 5 || _suspectFrameCount % 300 == 0)
             {
-                _eventBufferPool[i] = new byte[frameSize];
+                _logger.LogWarning("NDI frame {Count} is tagged UYVY but looks like BGRA ({Suspect} suspect frames so far)",
+                    _frameCount, _suspectFrameCount);
             }
-            _logger.LogDebug("Allocated NDI event buffer pool: {Slots} x {Size} bytes", EventBufferPoolSize, frameSize);
         }
 
-        var buffer = _eventBufferPool[_eventBufferIndex];
-        _eventBufferIndex = (_eventBufferIndex + 1) % EventBufferPoolSize;
-
-        // Copy frame data from native memory to managed buffer
-        Marshal.Copy(frame.p_data, buffer, 0, frameSize);
+        // Wrap the SDK's buffer rather than copying it; drop the frame if consumers hold every slot
+        if (!ring.TryBeginWrite(ref frame, frameSize, out var frameData))
+        {
+            var drops = Interlocked.Increment(ref _ringFullDrops);
+            if (drops <= 5 || drops % 100 == 0)
+            {
+                _logger.LogWarning("NDI frame {Count}: all {Slots} frame slots leased by consumers, dropping frame ({Drops} total)",
+                    _frameCount, ring.SlotCount, drops);
+            }
+            return false;
+        }
 
         var timestamp = frame.timecode > 0
             ? TimeSpan.FromTicks(frame.timecode)
             : TimeSpan.FromSeconds(_frameCount / (_currentMode.FrameRate.Value > 0 ? _currentMode.FrameRate.Value : 60.0));
 
-        VideoFrameReceived?.Invoke(this, new VideoFrameEventArgs
+        try
         {
-            FrameData = buffer.AsMemory(),
-            Mode = _currentMode,
-            Timestamp = timestamp,
-            FrameNumber = _frameCount
-        });
+            // Preview levels live in the frame's slot, so they are covered by the same lease
+            PreviewPyramid? pyramid = null;
+            int pyramidLevels = _previewPyramid.Levels;
+            int pyramidSize = PreviewPyramidBuilder.BufferSize(pixelFormat, width, height, pyramidLevels);
+            if (pyramidSize > 0)
+            {
+                pyramid = PreviewPyramidBuilder.Build(frameData.Span, stride, width, height,
+                    ring.ClaimedPyramid(pyramidSize), pyramidLevels);
+            }
+
+            var sequence = ring.Publish();
+
+            VideoFrameReceived?.Invoke(this, new VideoFrameEventArgs
+            {
+                FrameData = frameData,
+                Mode = _currentMode,
+                Timestamp = timestamp,
+                FrameNumber = _frameCount,
+                Sequence = sequence,
+                LeaseSource = ring,
+                Pyramid = pyramid
+            });
+        }
+        finally
+        {
+            // Frees the frame now unless a consumer leased it
+            ring.EndDispatch();
+        }
+
+        return true;
     }
 
     private void ProcessAudioFrame(ref NDIlib_audio_frame_v2_t frame)
@@ -343,12 +395,7 @@ public sealed class NdiCaptureDevice : ICaptureDevice
             catch (OperationCanceledException) { }
         }
 
-        // Destroy the receiver
-        if (_recvInstance != IntPtr.Zero)
-        {
-            try { NdiInterop.NDIlib_recv_destroy(_recvInstance); } catch { }
-            _recvInstance = IntPtr.Zero;
-        }
+        CloseReceiver();
 
         _currentMode = null;
         SetStatus(DeviceStatus.Idle);
@@ -378,12 +425,25 @@ public sealed class NdiCaptureDevice : ICaptureDevice
         _captureCts?.Cancel();
         _captureCts?.Dispose();
 
-        if (_recvInstance != IntPtr.Zero)
+        CloseReceiver();
+
+        SetStatus(DeviceStatus.Disconnected);
+    }
+
+    /// <summary>
+    /// Destroy the receiver, or hand that to the frame ring if consumers still lease frames.
+    /// </summary>
+    private void CloseReceiver()
+    {
+        if (_frameRing != null)
+        {
+            _frameRing.Close();
+            _frameRing = null;
+        }
+        else if (_recvInstance != IntPtr.Zero)
         {
             try { NdiInterop.NDIlib_recv_destroy(_recvInstance); } catch { }
-            _recvInstance = IntPtr.Zero;
         }
-
-        SetStatus(DeviceStatus.Disconnected);
+        _recvInstance = IntPtr.Zero;
     }
 }
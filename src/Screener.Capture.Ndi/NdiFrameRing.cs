@@ -0,0 +1,238 @@
+using System.Buffers;
+using Screener.Abstractions.Capture;
+using Screener.Capture.Ndi.Interop;
+
+namespace Screener.Capture.Ndi;
+
+/// <summary>
+/// Reference-counted hold on the video frames an NDI receiver hands back, so consumers read
+/// the SDK's own buffer instead of a copy. The receive thread <see cref="TryBeginWrite"/>s
+/// each frame into a free slot and <see cref="Publish"/>es it under a new sequence number;
+/// it keeps one reference while VideoFrameReceived runs and consumers that need the bytes
+/// afterwards lease the slot by sequence. Whoever drops the last reference returns the frame
+/// with NDIlib_recv_free_video_v2. When every slot is held the receive thread frees the new
+/// frame itself and drops it, as the DeckLink <c>FrameRing</c> does.
+/// After <see cref="Close"/> the receiver is destroyed once the last frame is returned.
+/// </summary>
+internal sealed class NdiFrameRing : IFrameLeaseSource
+{
+    // Slot state: Freeing while the last reference returns the frame, otherwise the
+    // number of references (0 = empty)
+    private const int Freeing = -1;
+
+    private sealed class Slot
+    {
+        public NDIlib_video_frame_v2_t Frame;
+        public byte[]? Pyramid;
+        public int State;
+        public long Sequence; // 0 = nothing published
+    }
+
+    private sealed class Lease : IDisposable
+    {
+        private NdiFrameRing? _ring;
+        private readonly Slot _slot;
+
+        public Lease(NdiFrameRing ring, Slot slot)
+        {
+            _ring = ring;
+            _slot = slot;
+        }
+
+        public void Dispose() => Interlocked.Exchange(ref _ring, null)?.Release(_slot);
+    }
+
+    private sealed unsafe class NativeFrameMemory : MemoryManager<byte>
+    {
+        private readonly IntPtr _data;
+        private readonly int _length;
+
+        public NativeFrameMemory(IntPtr data, int length)
+        {
+            _data = data;
+            _length = length;
+        }
+
+        public override Span<byte> GetSpan() => new((void*)_data, _length);
+
+        public override MemoryHandle Pin(int elementIndex = 0) => new((byte*)_data + elementIndex);
+
+        public override void Unpin() { }
+
+        protected override void Dispose(bool disposing) { }
+    }
+
+    private readonly Slot[] _slots;
+    private IntPtr _recvInstance;
+    private int _closed;
+    private int _nextWriteIndex;   // producer only
+    private long _lastSequence;    // producer only
+    private Slot? _writing;        // producer only
+    private Slot? _dispatching;    // producer only
+
+    public NdiFrameRing(IntPtr recvInstance, int slotCount)
+    {
+        _recvInstance = recvInstance;
+        _slots = new Slot[slotCount];
+        for (int i = 0; i < slotCount; i++)
+            _slots[i] = new Slot();
+    }
+
+    public int SlotCount => _slots.Length;
+
+    /// <summary>
+    /// Take ownership of a captured frame and wrap its buffer without copying. Returns false
+    /// when every slot is held; the frame then still belongs to the caller.
+    /// Producer thread only.
+    /// </summary>
+    public bool TryBeginWrite(ref NDIlib_video_frame_v2_t frame, int frameSize, out ReadOnlyMemory<byte> frameData)
+    {
+        for (int i = 0; i < _slots.Length; i++)
+        {
+            int index = (_nextWriteIndex + i) % _slots.Length;
+            var slot = _slots[index];
+            if (Interlocked.CompareExchange(ref slot.State, 1, 0) != 0)
+                continue;
+
+            slot.Frame = frame;
+            _nextWriteIndex = (index + 1) % _slots.Length;
+            _writing = slot;
+            frameData = new NativeFrameMemory(frame.p_data, frameSize).Memory;
+            return true;
+        }
+
+        frameData = default;
+        return false;
+    }
+
+    /// <summary>
+    /// Preview pyramid buffer of the claimed slot, reallocated when the size changes.
+    /// </summary>
+    public byte[] ClaimedPyramid(int size)
+    {
+        var slot = _writing ?? throw new InvalidOperationException("No frame claimed");
+        if (slot.Pyramid == null || slot.Pyramid.Length != size)
+            slot.Pyramid = new byte[size];
+        return slot.Pyramid;
+    }
+
+    /// <summary>
+    /// Make the claimed frame leasable. Returns its sequence number. The receive thread keeps
+    /// its reference until <see cref="EndDispatch"/>.
+    /// </summary>
+    public long Publish()
+    {
+        var slot = _writing ?? throw new InvalidOperationException("No frame claimed");
+        _writing = null;
+        _dispatching = slot;
+
+        var sequence = ++_lastSequence;
+        Volatile.Write(ref slot.Sequence, sequence);
+        return sequence;
+    }
+
+    /// <summary>
+    /// Drop the receive thread's reference to the frame it published last (or claimed and
+    /// never published). The frame is freed here unless a consumer still leases it.
+    /// </summary>
+    public void EndDispatch()
+    {
+        var slot = _dispatching ?? _writing;
+        _dispatching = null;
+        _writing = null;
+        if (slot != null)
+            Release(slot);
+    }
+
+    public IDisposable? TryLease(long sequence)
+    {
+        if (sequence <= 0) return null;
+
+        foreach (var slot in _slots)
+        {
+            if (Volatile.Read(ref slot.Sequence) != sequence)
+                continue;
+
+            int state = Volatile.Read(ref slot.State);
+            while (state > 0)
+            {
+                int seen = Interlocked.CompareExchange(ref slot.State, state + 1, state);
+                if (seen == state)
+                {
+                    // The frame may have been freed and the slot refilled between the
+                    // sequence check and the increment
+                    if (Volatile.Read(ref slot.Sequence) == sequence)
+                        return new Lease(this, slot);
+
+                    Release(slot);
+                    return null;
+                }
+                state = seen;
+            }
+
+            return null;
+        }
+
+        return null;
+    }
+
+    /// <summary>
+    /// Stop accepting frames: the receiver is destroyed now if no frame is held, otherwise
+    /// when the last lease is disposed. Call after the receive loop has exited.
+    /// </summary>
+    public void Close()
+    {
+        Interlocked.Exchange(ref _closed, 1);
+        TryDestroyReceiver();
+    }
+
+    private void Release(Slot slot)
+    {
+        int state = Volatile.Read(ref slot.State);
+        while (state > 0)
+        {
+            if (state == 1)
+            {
+                if (Interlocked.CompareExchange(ref slot.State, Freeing, 1) != 1)
+                {
+                    state = Volatile.Read(ref slot.State);
+                    continue;
+                }
+
+                // Readers that raced the last release see the cleared sequence and back out
+                Volatile.Write(ref slot.Sequence, 0);
+                var recvInstance = Volatile.Read(ref _recvInstance);
+                if (recvInstance != IntPtr.Zero)
+                {
+                    try { NdiInterop.NDIlib_recv_free_video_v2(recvInstance, ref slot.Frame); } catch { }
+                }
+                slot.Frame = default;
+                Interlocked.Exchange(ref slot.State, 0);
+
+                if (Volatile.Read(ref _closed) == 1)
+                    TryDestroyReceiver();
+                return;
+            }
+
+            int seen = Interlocked.CompareExchange(ref slot.State, state - 1, state);
+            if (seen == state)
+                return;
+            state = seen;
+        }
+    }
+
+    private void TryDestroyReceiver()
+    {
+        foreach (var slot in _slots)
+        {
+            if (Volatile.Read(ref slot.State) != 0)
+                return;
+        }
+
+        var recvInstance = Interlocked.Exchange(ref _recvInstance, IntPtr.Zero);
+        if (recvInstance != IntPtr.Zero)
+        {
+            try { NdiInterop.NDIlib_recv_destroy(recvInstance); } catch { }
+        }
+    }
+}
@@ -0,0 +1,203 @@
+using System.Runtime.InteropServices;
+using Screener.Core.Native;
+
+namespace Screener.Capture.Srt;
+
+internal enum SrtReceiveResult
+{
+    Frame,
+    Timeout,
+    Disconnected,
+    BufferTooSmall
+}
+
+/// <summary>
+/// Description of the frame <see cref="NativeSrtReceiver.Receive"/> wrote, or the one it is
+/// holding when the buffer was too small.
+/// </summary>
+internal readonly record struct SrtFrameDescription(int Width, int Height, int FrameRateNum, int FrameRateDen, TimeSpan Timestamp);
+
+/// <summary>
+/// In-process SRT listener backed by the native DLL's SRT receiver: libsrt (srt.dll) receives
+/// the MPEG-TS stream, the native demuxer pulls out the H.264 or HEVC stream and a Media
+/// Foundation decoder (DXVA on the GPU when the driver supports it) decodes it; each frame is
+/// converted once from NV12 straight into the caller's buffer as UYVY.
+/// Not thread-safe: one receive loop drives it.
+/// </summary>
+internal sealed class NativeSrtReceiver : IDisposable
+{
+    private const string NativeDll = "Screener.Capture.Blackmagic.Native.dll";
+
+    // Mirrors SrtReceiverSettings / SrtFrameInfo / SrtReceiverStats in SrtReceiver.h
+    [StructLayout(LayoutKind.Sequential)]
+    private struct SrtReceiverSettings
+    {
+        public int Port;
+        public int LatencyMs;
+        public int AllowHardware;
+    }
+
+    [StructLayout(LayoutKind.Sequential)]
+    private struct SrtFrameInfo
+    {
+        public int Width;
+        public int Height;
+        public int FrameRateNum;
+        public int FrameRateDen;
+        public long Timestamp;
+        public int Codec;
+    }
+
+    [StructLayout(LayoutKind.Sequential)]
+    private struct SrtReceiverStats
+    {
+        public ulong PacketsReceived;
+        public ulong BytesReceived;
+        public ulong AccessUnits;
+        public ulong FramesDecoded;
+        public ulong FramesDelivered;
+        public ulong FramesDiscarded;
+        public ulong ContinuityErrors;
+        public ulong DecodeUsTotal;
+        public ulong ConvertUsTotal;
+        public ulong Connections;
+        public int Connected;
+        public int Hardware;
+        public int LastError;
+    }
+
+    [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl)]
+    private static extern int IsSrtReceiverAvailable();
+
+    [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl)]
+    private static extern IntPtr CreateSrtReceiver(ref SrtReceiverSettings settings, out int error);
+
+    [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl)]
+    private static extern int ReceiveSrtFrame(IntPtr receiver, ref byte dst, int dstCapacity, int dstPitch,
+        int timeoutMs, out SrtFrameInfo info);
+
+    [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl)]
+    private static extern void DiscardSrtFrame(IntPtr receiver);
+
+    [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl)]
+    private static extern void DestroySrtReceiver(IntPtr receiver);
+
+    [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl)]
+    private static extern int GetSrtReceiverStats(IntPtr receiver, out SrtReceiverStats stats, int statsSize);
+
+    private static readonly Lazy<bool> _available = new(Probe);
+
+    private IntPtr _handle;
+
+    public int Port { get; }
+
+    private NativeSrtReceiver(IntPtr handle, int port)
+    {
+        _handle = handle;
+        Port = port;
+    }
+
+    /// <summary>True when srt.dll loads and a video decoder transform is present.</summary>
+    public static bool IsAvailable => _available.Value;
+
+    /// <summary>True while the stream is decoded on the GPU through DXVA.</summary>
+    public bool IsHardware => TryGetStats(out var stats) && stats.Hardware == 1;
+
+    /// <summary>TS continuity counter gaps seen on the video stream (lost packets).</summary>
+    public ulong ContinuityErrors => TryGetStats(out var stats) ? stats.ContinuityErrors : 0;
+
+    /// <summary>
+    /// Bind the port and start listening for a caller.
+    /// Throws <see cref="InvalidOperationException"/> with the native error if it cannot be created.
+    /// </summary>
+    public static NativeSrtReceiver Create(int port, int latencyMs)
+    {
+        var settings = new SrtReceiverSettings
+        {
+            Port = port,
+            LatencyMs = latencyMs,
+            AllowHardware = 1
+        };
+
+        var handle = CreateSrtReceiver(ref settings, out int error);
+        if (handle == IntPtr.Zero)
+            throw new InvalidOperationException($"SRT listener on port {port} could not be created: 0x{error:X8}");
+
+        return new NativeSrtReceiver(handle, port);
+    }
+
+    /// <summary>
+    /// Wait up to timeoutMs for the next decoded frame and write it into dst as UYVY rows of
+    /// pitch bytes. On <see cref="SrtReceiveResult.BufferTooSmall"/> the frame stays queued
+    /// (frame describes it) until the next call or <see cref="Discard"/>; an empty dst probes.
+    /// </summary>
+    public SrtReceiveResult Receive(Span<byte> dst, int pitch, int timeoutMs, out SrtFrameDescription frame)
+    {
+        ObjectDisposedException.ThrowIf(_handle == IntPtr.Zero, this);
+
+        int result = ReceiveSrtFrame(_handle, ref MemoryMarshal.GetReference(dst), dst.Length, pitch,
+            timeoutMs, out var info);
+
+        frame = new SrtFrameDescription(info.Width, info.Height, info.FrameRateNum, info.FrameRateDen,
+            TimeSpan.FromTicks(info.Timestamp));
+
+        return result switch
+        {
+            1 => SrtReceiveResult.Frame,
+            0 => SrtReceiveResult.Timeout,
+            -2 => SrtReceiveResult.Disconnected,
+            -3 => SrtReceiveResult.BufferTooSmall,
+            _ => throw new ArgumentException($"Invalid receive buffer ({dst.Length} bytes at pitch {pitch})", nameof(dst))
+        };
+    }
+
+    /// <summary>
+    /// Drop the frame a <see cref="SrtReceiveResult.BufferTooSmall"/> result left queued.
+    /// </summary>
+    public void Discard()
+    {
+        ObjectDisposedException.ThrowIf(_handle == IntPtr.Zero, this);
+        DiscardSrtFrame(_handle);
+    }
+
+    /// <summary>Native HRESULT or -(SRT error code) of the last failure.</summary>
+    public int LastError() => TryGetStats(out var stats) ? stats.LastError : 0;
+
+    private bool TryGetStats(out SrtReceiverStats stats)
+    {
+        if (_handle == IntPtr.Zero)
+        {
+            stats = default;
+            return false;
+        }
+        return GetSrtReceiverStats(_handle, out stats, Marshal.SizeOf<SrtReceiverStats>()) == 1;
+    }
+
+    private static bool Probe()
+    {
+        if (!MediaKernels.IsAvailable)
+            return false;
+
+        try
+        {
+            return IsSrtReceiverAvailable() == 1;
+        }
+        catch (EntryPointNotFoundException)
+        {
+            return false;
+        }
+        catch (DllNotFoundException)
+        {
+            return false;
+        }
+    }
+
+    public void Dispose()
+    {
+        if (_handle != IntPtr.Zero)
+        {
+            DestroySrtReceiver(_handle);
+            _handle = IntPtr.Zero;
+        }
+    }
+}
@@ -1,13 +1,17 @@
 using System.Diagnostics;
 using Microsoft.Extensions.Logging;
 using Screener.Abstractions.Capture;
+using Screener.Core.Buffers;
+using Screener.Core.Capture;
 
 namespace Screener.Capture.Srt;
 
 /// <summary>
-/// Capture device that receives video via SRT protocol using FFmpeg as a listener.
-/// Launches FFmpeg to listen on the configured SRT port, reads raw UYVY frames from stdout,
-/// and fires VideoFrameReceived for each complete frame.
+/// Capture device that receives video via SRT protocol.
+/// When the native SRT receiver is available (srt.dll present) the stream is received, demuxed
+/// and decoded in process, on the GPU where possible, and each frame is written once into a
+/// pooled <see cref="FrameRing"/> slot that consumers lease. Otherwise FFmpeg is launched to
+/// listen on the configured SRT port and raw UYVY frames are read from its stdout.
 /// </summary>
 public sealed class SrtCaptureDevice : ICaptureDevice
 {
@@ -15,6 +19,13 @@ public sealed class SrtCaptureDevice : ICaptureDevice
     private readonly SrtInputConfig _config;
     private readonly List<VideoMode> _supportedModes;
 
+    // Decoded frames go straight into ring slots; consumers that keep a frame lease its slot
+    private const int RingBufferSlots = 5;
+    private const int ReceiveTimeoutMs = 100;
+    private readonly PreviewPyramidBuilder _previewPyramid = new();
+    private NativeSrtReceiver? _nativeReceiver;
+    private long _ringFullDrops;
+
     private Process? _ffmpegProcess;
     private CancellationTokenSource? _cts;
     private Task? _readTask;
@@ -48,6 +59,8 @@ public sealed class SrtCaptureDevice : ICaptureDevice
     public event EventHandler<AudioSamplesEventArgs>? AudioSamplesReceived;
     public event EventHandler<DeviceStatusChangedEventArgs>? StatusChanged;
 
+    public IDisposable SubscribePreviewLevel(int divisor) => _previewPyramid.Subscribe(divisor);
+
     public SrtCaptureDevice(
         string deviceId,
         string displayName,
@@ -87,6 +100,13 @@ public sealed class SrtCaptureDevice : ICaptureDevice
 
             _cts = CancellationTokenSource.CreateLinkedTokenSource(ct);
 
+            if (TryStartNativeReceiver(_cts.Token))
+            {
+                SetStatus(DeviceStatus.Capturing);
+                _logger.LogInformation("SRT capture started on port {Port} (in-process receiver)", _config.Port);
+                return true;
+            }
+
             // Build FFmpeg arguments for SRT listener mode
             // latency is specified in microseconds in the SRT URL
             var latencyUs = _config.LatencyMs * 1000;
@@ -140,6 +160,10 @@ public sealed class SrtCaptureDevice : ICaptureDevice
             catch (OperationCanceledException) { }
         }
 
+        // The receive loop has exited, so nothing is inside the native receiver
+        _nativeReceiver?.Dispose();
+        _nativeReceiver = null;
+
         if (_stderrParseTask != null)
         {
             try { await _stderrParseTask; }
@@ -150,6 +174,175 @@ public sealed class SrtCaptureDevice : ICaptureDevice
         SetStatus(DeviceStatus.Idle);
     }
 
+    /// <summary>
+    /// Bind the in-process SRT listener and start its receive loop. False when the native
+    /// receiver is unavailable or the port cannot be bound, so the FFmpeg listener is used.
+    /// </summary>
+    private bool TryStartNativeReceiver(CancellationToken ct)
+    {
+        if (!NativeSrtReceiver.IsAvailable)
+            return false;
+
+        try
+        {
+            _nativeReceiver = NativeSrtReceiver.Create(_config.Port, _config.LatencyMs);
+        }
+        catch (InvalidOperationException ex)
+        {
+            _logger.LogWarning(ex, "In-process SRT receiver unavailable on port {Port}, falling back to FFmpeg", _config.Port);
+            return false;
+        }
+
+        var receiver = _nativeReceiver;
+        _readTask = Task.Factory.StartNew(() => ReceiveNativeFrames(receiver, ct), ct,
+            TaskCreationOptions.LongRunning, TaskScheduler.Default);
+        return true;
+    }
+
+    /// <summary>
+    /// Pulls decoded frames from the native receiver into ring slots and fires
+    /// VideoFrameReceived for each. The ring is sized from the first frame and rebuilt when
+    /// the stream's resolution changes; callers that disconnect leave the listener waiting
+    /// for the next one.
+    /// </summary>
+    private void ReceiveNativeFrames(NativeSrtReceiver receiver, CancellationToken ct)
+    {
+        FrameRing? ring = null;
+        int width = 0, height = 0;
+        var frameRate = _currentMode?.FrameRate ?? FrameRate.Fps30;
+
+        try
+        {
+            while (!ct.IsCancellationRequested)
+            {
+                // Consumers holding leases on a replaced ring keep its slots alive until they dispose them
+                int pyramidLevels = _previewPyramid.Levels;
+                int pyramidSize = PreviewPyramidBuilder.BufferSize(PixelFormat.YUV422_8bit, width, height, pyramidLevels);
+                if (ring != null && ring.PyramidSize != pyramidSize)
+                    ring = new FrameRing(RingBufferSlots, ring.SlotSize, pyramidSize: pyramidSize);
+
+                byte[]? slot = null;
+                if (ring != null)
+                {
+                    slot = ring.TryBeginWrite();
+                    if (slot == null)
+                    {
+                        // Consumers hold every slot: take the frame off the decoder and drop it
+                        var held = receiver.Receive(Span<byte>.Empty, 0, ReceiveTimeoutMs, out _);
+                        if (held == SrtReceiveResult.BufferTooSmall)
+                        {
+                            receiver.Discard();
+                            var drops = Interlocked.Increment(ref _ringFullDrops);
+                            if (drops <= 5 || drops % 100 == 0)
+                            {
+                                _logger.LogWarning("SRT port {Port}: all {Slots} frame slots leased by consumers, dropping frame ({Drops} total)",
+                                    _config.Port, ring.SlotCount, drops);
+                            }
+                        }
+                        continue;
+                    }
+                }
+
+                var result = receiver.Receive(slot, width * 2, ReceiveTimeoutMs, out var frame);
+                switch (result)
+                {
+                    case SrtReceiveResult.Timeout:
+                        ring?.Abandon();
+                        continue;
+
+                    case SrtReceiveResult.Disconnected:
+                        ring?.Abandon();
+                        _logger.LogWarning("SRT stream on port {Port} ended (0x{Error:X8}), listening for a new caller",
+                            _config.Port, receiver.LastError());
+                        continue;
+
+                    case SrtReceiveResult.BufferTooSmall:
+                        ring?.Abandon();
+                        if (frame.Width <= 0 || frame.Height <= 0)
+                        {
+                            receiver.Discard();
+                            continue;
+                        }
+
+                        // First frame or a new resolution: slots for the stream as it is now
+                        width = frame.Width;
+                        height = frame.Height;
+                        frameRate = frame.FrameRateDen > 0
+                            ? ConvertToFrameRate(frame.FrameRateNum, frame.FrameRateDen)
+                            : _currentMode?.FrameRate ?? FrameRate.Fps30;
+                        ring = new FrameRing(RingBufferSlots, width * 2 * height,
+                            pyramidSize: PreviewPyramidBuilder.BufferSize(PixelFormat.YUV422_8bit, width, height, pyramidLevels));
+
+                        _currentMode = new VideoMode(
+                            width,
+                            height,
+                            frameRate,
+                            PixelFormat.YUV422_8bit,
+                            false,
+                            $"{height}p (SRT)");
+
+                        _logger.LogInformation("SRT stream on port {Port}: {Width}x{Height} @ {FrameRate}, {Decoder} decode",
+                            _config.Port, width, height, frameRate, receiver.IsHardware ? "hardware" : "software");
+                        continue;
+                }
+
+                _frameCount++;
+                var frameData = slot!.AsMemory(0, width * 2 * height);
+
+                // Preview levels live in the frame's slot, so they are covered by the same lease
+                PreviewPyramid? pyramid = null;
+                var pyramidSlot = ring!.ClaimedPyramid;
+                if (pyramidSlot != null)
+                {
+                    pyramid = PreviewPyramidBuilder.Build(frameData.Span, width * 2, width, height,
+                        pyramidSlot, pyramidLevels);
+                }
+
+                var sequence = ring.Publish();
+
+                VideoFrameReceived?.Invoke(this, new VideoFrameEventArgs
+                {
+                    FrameData = frameData,
+                    Mode = _currentMode!,
+                    Timestamp = frame.Timestamp,
+                    FrameNumber = _frameCount,
+                    Sequence = sequence,
+                    LeaseSource = ring,
+                    Pyramid = pyramid
+                });
+
+                if (_frameCount <= 5 || _frameCount % 300 == 0)
+                {
+                    _logger.LogInformation("SRT frame {FrameCount}: {Width}x{Height}, {Errors} TS continuity errors",
+                        _frameCount, width, height, receiver.ContinuityErrors);
+                }
+            }
+        }
+        catch (Exception ex)
+        {
+            _logger.LogError(ex, "Error receiving SRT frames");
+            SetStatus(DeviceStatus.Error);
+        }
+    }
+
+    private static FrameRate ConvertToFrameRate(int numerator, int denominator)
+    {
+        var fps = (double)numerator / denominator;
+
+        return fps switch
+        {
+            >= 59.93 and < 59.95 => FrameRate.Fps59_94,
+            >= 59.99 and <= 60.01 => FrameRate.Fps60,
+            >= 49.99 and <= 50.01 => FrameRate.Fps50,
+            >= 29.96 and < 29.98 => FrameRate.Fps29_97,
+            >= 29.99 and <= 30.01 => FrameRate.Fps30,
+            >= 24.99 and <= 25.01 => FrameRate.Fps25,
+            >= 23.97 and < 23.99 => FrameRate.Fps23_976,
+            >= 23.99 and <= 24.01 => FrameRate.Fps24,
+            _ => new FrameRate(numerator, denominator)
+        };
+    }
+
     /// <summary>
     /// Monitors FFmpeg stderr to auto-detect the incoming stream resolution.
     /// FFmpeg stderr is already being read line-by-line via BeginErrorReadLine in LaunchAsync,
@@ -323,6 +516,16 @@ public sealed class SrtCaptureDevice : ICaptureDevice
         _disposed = true;
 
         _cts?.Cancel();
+
+        // Let the receive loop leave the native receiver before destroying it
+        if (_nativeReceiver != null)
+        {
+            try { _readTask?.Wait(TimeSpan.FromSeconds(2)); }
+            catch (AggregateException) { }
+            _nativeReceiver.Dispose();
+            _nativeReceiver = null;
+        }
+
         _cts?.Dispose();
 
         if (_ffmpegProcess != null)
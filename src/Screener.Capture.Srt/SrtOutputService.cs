@@ -8,8 +8,10 @@ namespace Screener.Capture.Srt;
 /// <summary>
 /// SRT output service that sends raw UYVY video frames via FFmpeg to an SRT destination.
 /// Supports both caller mode (connect to remote) and listener mode (wait for connections).
+/// With a "rendition" parameter it runs no encoder of its own: the shared encode tee muxes that
+/// encode ladder rendition to the SRT URL instead.
 /// </summary>
-public sealed class SrtOutputService : IOutputService
+public sealed class SrtOutputService : ITeeOutput
 {
     private readonly ILogger<SrtOutputService> _logger;
 
@@ -19,11 +21,13 @@ public sealed class SrtOutputService : IOutputService
     private Task? _monitorTask;
     private OutputState _state = OutputState.Stopped;
     private OutputConfiguration? _currentConfig;
+    private TeeTarget? _teeTarget;
 
     public string OutputId => "srt-output";
     public string DisplayName => "SRT Output";
     public OutputState State => _state;
     public OutputConfiguration? CurrentConfig => _currentConfig;
+    public TeeTarget? TeeTarget => _teeTarget;
 
     public event EventHandler<OutputStateChangedEventArgs>? StateChanged;
 
@@ -63,6 +67,16 @@ public sealed class SrtOutputService : IOutputService
                 srtUrl = $"srt://{address}:{port}?mode=caller&latency={latencyUs}";
             }
 
+            var rendition = parameters.GetValueOrDefault("rendition");
+            if (!string.IsNullOrEmpty(rendition))
+            {
+                _teeTarget = new TeeTarget(rendition, "mpegts", srtUrl);
+                SetState(OutputState.Running);
+                _logger.LogInformation("SRT output started from encode ladder rendition {Rendition} -> {Url}",
+                    rendition, srtUrl);
+                return;
+            }
+
             var fps = config.FrameRate > 0 ? config.FrameRate : 30.0;
 
             // Build FFmpeg arguments:
@@ -150,6 +164,7 @@ public sealed class SrtOutputService : IOutputService
         finally
         {
             _currentConfig = null;
+            _teeTarget = null;
             SetState(OutputState.Stopped);
             _logger.LogInformation("SRT output stopped");
         }
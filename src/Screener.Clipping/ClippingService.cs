@@ -1,14 +1,22 @@
+using System.Buffers;
 using System.Diagnostics;
 using Microsoft.Extensions.Logging;
+using Screener.Abstractions.Capture;
 using Screener.Abstractions.Clipping;
 using Screener.Abstractions.Encoding;
 using Screener.Abstractions.Recording;
 using Screener.Abstractions.Timecode;
+using Screener.Core.Buffers;
+using Screener.Core.Recording;
 
 namespace Screener.Clipping;
 
 /// <summary>
 /// Manages live clip marking and extraction during recording.
+/// Clips of a recording in progress are cut from its replay buffer when the range is still
+/// buffered, then from the byte range its frame index points at, and by seeking the recording
+/// file when neither is available. Raw ISO recordings are cut by frame from their fixed-size
+/// frames and encoded, as uncompressed video cannot be stream-copied into MP4.
 /// </summary>
 public sealed class ClippingService : IClippingService
 {
@@ -16,6 +24,7 @@ public sealed class ClippingService : IClippingService
     private readonly List<ClipMarker> _markers = new();
     private readonly List<ClipDefinition> _pendingClips = new();
     private readonly SemaphoreSlim _extractionSemaphore;
+    private readonly ReplayBufferRegistry? _replayBuffers;
     private ClipMarker? _pendingInPoint;
     private string? _activeRecordingPath;
 
@@ -25,10 +34,18 @@ public sealed class ClippingService : IClippingService
     public event EventHandler<ClipMarkerEventArgs>? MarkerAdded;
     public event EventHandler<ClipExtractionProgressEventArgs>? ExtractionProgress;
 
-    public ClippingService(ILogger<ClippingService> logger, int maxConcurrentExtractions = 2)
+    // How long to wait for the encoder to deliver an out point that was just marked
+    private static readonly TimeSpan ReplayCatchUp = TimeSpan.FromSeconds(3);
+
+    // Read size when feeding indexed recording bytes to FFmpeg
+    private const int CopyChunkBytes = 1024 * 1024;
+
+    public ClippingService(ILogger<ClippingService> logger, int maxConcurrentExtractions = 2,
+        ReplayBufferRegistry? replayBuffers = null)
     {
         _logger = logger;
         _extractionSemaphore = new SemaphoreSlim(maxConcurrentExtractions);
+        _replayBuffers = replayBuffers;
     }
 
     /// <summary>
@@ -122,15 +139,17 @@ public sealed class ClippingService : IClippingService
 
             ReportProgress(clip, 0, ClipExtractionStatus.Extracting);
 
+            var input = FindRawRange(clip) ?? await TakeReplaySnapshotAsync(clip, ct) ?? await FindIndexedRangeAsync(clip, ct);
+
             if (options.TranscodePreset == null)
             {
                 // Stream copy (fast)
-                await ExtractWithStreamCopyAsync(clip, outputPath, ct);
+                await ExtractWithStreamCopyAsync(clip, outputPath, input, ct);
             }
             else
             {
                 // Transcode
-                await ExtractWithTranscodeAsync(clip, outputPath, options.TranscodePreset, ct);
+                await ExtractWithTranscodeAsync(clip, outputPath, options.TranscodePreset, input, ct);
             }
 
             ReportProgress(clip, 100, ClipExtractionStatus.Completed, outputPath);
@@ -151,27 +170,206 @@ public sealed class ClippingService : IClippingService
         }
     }
 
-    private async Task ExtractWithStreamCopyAsync(ClipDefinition clip, string outputPath, CancellationToken ct)
+    private async Task ExtractWithStreamCopyAsync(ClipDefinition clip, string outputPath, ClipInput? input, CancellationToken ct)
     {
-        var args = $"-y -ss {clip.InPoint.TotalSeconds:F3} -i \"{clip.SourceFilePath}\" " +
-                   $"-t {clip.Duration.TotalSeconds:F3} -c copy -avoid_negative_ts make_zero \"{outputPath}\"";
+        if (input is { Raw: not null })
+        {
+            // Nothing to copy: a fast near-lossless encode stands in for it. The range
+            // starts on the in point's frame, so no trim at the start.
+            var args = $"-y {input.Raw.DemuxArguments} -i pipe:0 -t {clip.Duration.TotalSeconds:F3} " +
+                       $"-c:v libx264 -preset veryfast -crf 12 -pix_fmt yuv420p -movflags +faststart \"{outputPath}\"";
+
+            await RunFfmpegAsync(args, input.Write, ct);
+            return;
+        }
+
+        if (input is { Format: "mpegts" })
+        {
+            // The snapshot starts on the keyframe at or before the in point, as seeking the
+            // file with -c copy does; only the end needs trimming
+            var args = $"-y -f mpegts -i pipe:0 -t {(clip.OutPoint - input.Start).TotalSeconds:F3} " +
+                       $"-c copy -avoid_negative_ts make_zero -movflags +faststart \"{outputPath}\"";
+
+            await RunFfmpegAsync(args, input.Write, ct);
+            return;
+        }
 
-        await RunFfmpegAsync(args, ct);
+        if (input != null)
+        {
+            // Shift the in point to zero: the frames from the keyframe up to it keep negative
+            // timestamps, which the MP4 muxer hides behind an edit list, so the cut is exact
+            var args = $"-y -itsoffset {-(clip.InPoint - input.Start).TotalSeconds:F3} -f mp4 -i pipe:0 " +
+                       $"-t {clip.Duration.TotalSeconds:F3} -c copy -copypriorss 1 {TimecodeArgument(input)}" +
+                       $"-movflags +faststart \"{outputPath}\"";
+
+            await RunFfmpegAsync(args, input.Write, ct);
+            return;
+        }
+
+        var fileArgs = $"-y -ss {clip.InPoint.TotalSeconds:F3} -i \"{clip.SourceFilePath}\" " +
+                       $"-t {clip.Duration.TotalSeconds:F3} -c copy -avoid_negative_ts make_zero \"{outputPath}\"";
+
+        await RunFfmpegAsync(fileArgs, null, ct);
     }
 
-    private async Task ExtractWithTranscodeAsync(ClipDefinition clip, string outputPath, EncodingPreset preset, CancellationToken ct)
+    private async Task ExtractWithTranscodeAsync(ClipDefinition clip, string outputPath, EncodingPreset preset,
+        ClipInput? input, CancellationToken ct)
     {
         var encoder = preset.VideoCodec == VideoCodec.H264 ? "libx264" : "libx265";
-        var args = $"-y -ss {clip.InPoint.TotalSeconds:F3} -i \"{clip.SourceFilePath}\" " +
+
+        // Decoding makes the in point frame-accurate within the snapshot or indexed range
+        var source = input != null
+            ? $"{(input.Raw?.DemuxArguments ?? $"-f {input.Format}")} -i pipe:0 -ss {(clip.InPoint - input.Start).TotalSeconds:F3}"
+            : $"-ss {clip.InPoint.TotalSeconds:F3} -i \"{clip.SourceFilePath}\"";
+
+        var args = $"-y {source} " +
                    $"-t {clip.Duration.TotalSeconds:F3} " +
                    $"-c:v {encoder} -crf {preset.CrfValue} -preset medium " +
                    $"-c:a aac -b:a {preset.AudioBitrateKbps}k " +
-                   $"-movflags +faststart \"{outputPath}\"";
+                   $"{(input != null ? TimecodeArgument(input) : "")}-movflags +faststart \"{outputPath}\"";
+
+        await RunFfmpegAsync(args, input?.Write, ct);
+    }
+
+    private static string TimecodeArgument(ClipInput input) =>
+        input.Timecode is { } timecode ? $"-timecode {timecode} " : "";
 
-        await RunFfmpegAsync(args, ct);
+    // Frames of a raw ISO recording are fixed-size, so the clip is a byte range that needs no
+    // index: from the in point's frame to the out point's, or what has been written so far
+    private ClipInput? FindRawRange(ClipDefinition clip)
+    {
+        var raw = RawVideoInfo.TryRead(clip.SourceFilePath);
+        if (raw == null)
+            return null;
+
+        long written = new FileInfo(clip.SourceFilePath).Length / raw.FrameSize;
+        long first = Math.Min((long)Math.Floor(clip.InPoint.TotalSeconds * raw.FramesPerSecond), written);
+        long end = Math.Min((long)Math.Ceiling(clip.OutPoint.TotalSeconds * raw.FramesPerSecond), written);
+        if (end <= first)
+            throw new InvalidOperationException($"{clip.SourceFilePath} holds no frames between {clip.InPoint} and {clip.OutPoint}");
+
+        _logger.LogDebug("Cutting {ClipName} from raw frames {First}-{End} of {Path}",
+            clip.Name, first, end, clip.SourceFilePath);
+
+        var path = clip.SourceFilePath;
+        return new ClipInput(raw.PixelFormat == PixelFormat.YUV422_10bit ? "v210" : "rawvideo", raw.FrameTime(first),
+            (stdin, token) => CopyRawFramesAsync(path, first * raw.FrameSize, (end - first) * raw.FrameSize, stdin, token),
+            Raw: raw);
+    }
+
+    private static async Task CopyRawFramesAsync(string path, long offset, long count, Stream destination,
+        CancellationToken ct)
+    {
+        await using var file = new FileStream(path, FileMode.Open, FileAccess.Read,
+            FileShare.ReadWrite | FileShare.Delete, bufferSize: 1, FileOptions.Asynchronous | FileOptions.SequentialScan);
+
+        await CopyBytesAsync(file, offset, count, destination, ct);
     }
 
-    private async Task RunFfmpegAsync(string arguments, CancellationToken ct)
+    // Stream the clip's GOPs out of the recording's replay buffer, waiting briefly for an out
+    // point the encoder has not delivered yet. Null when the file has to be used instead.
+    private async Task<ClipInput?> TakeReplaySnapshotAsync(ClipDefinition clip, CancellationToken ct)
+    {
+        var replay = _replayBuffers?.Find(clip.SourceFilePath);
+        if (replay == null)
+            return null;
+
+        var deadline = DateTime.UtcNow + ReplayCatchUp;
+        while (replay.NewestPosition is { } newest && newest < clip.OutPoint && DateTime.UtcNow < deadline)
+            await Task.Delay(50, ct);
+
+        var snapshot = replay.Snapshot(clip.InPoint, clip.OutPoint);
+        if (snapshot == null)
+        {
+            _logger.LogDebug("Clip {ClipName} is no longer in the replay buffer (oldest {Oldest}); using the recording file",
+                clip.Name, replay.OldestPosition);
+            return null;
+        }
+
+        _logger.LogDebug("Cutting {ClipName} from the replay buffer ({Size} bytes from {Start})",
+            clip.Name, snapshot.Length, snapshot.Start);
+
+        return new ClipInput("mpegts", snapshot.Start, snapshot.CopyToAsync);
+    }
+
+    // Locate the clip's fragments through the recording's frame index, so only the init
+    // segment and the clip's own bytes are read however long the file is. Null when there is
+    // no usable index and FFmpeg has to seek the file.
+    private async Task<ClipInput?> FindIndexedRangeAsync(ClipDefinition clip, CancellationToken ct)
+    {
+        using var index = RecordingIndex.TryOpen(clip.SourceFilePath);
+        if (index == null)
+            return null;
+
+        if (!index.Spliceable)
+        {
+            _logger.LogDebug("Index of {Path} uses absolute offsets; seeking the file", clip.SourceFilePath);
+            return null;
+        }
+
+        // A recording in progress is indexed a fragment behind the encoder
+        var range = index.FindRange(clip.InPoint, clip.OutPoint);
+        if (range == null && string.Equals(clip.SourceFilePath, _activeRecordingPath, StringComparison.OrdinalIgnoreCase))
+        {
+            var deadline = DateTime.UtcNow + ReplayCatchUp;
+            while (range == null && DateTime.UtcNow < deadline)
+            {
+                await Task.Delay(100, ct);
+                range = index.FindRange(clip.InPoint, clip.OutPoint);
+            }
+        }
+
+        if (range == null)
+        {
+            _logger.LogDebug("Clip {ClipName} is not covered by the index of {Path}; seeking the file",
+                clip.Name, clip.SourceFilePath);
+            return null;
+        }
+
+        _logger.LogDebug("Cutting {ClipName} from indexed bytes {Start}-{End} (keyframe at {Keyframe})",
+            clip.Name, range.StartOffset, range.EndOffset, range.KeyframePosition);
+
+        var path = clip.SourceFilePath;
+        return new ClipInput("mp4", range.KeyframePosition,
+            (stdin, token) => CopyIndexedRangeAsync(path, range, stdin, token), range.InTimecode);
+    }
+
+    private static async Task CopyIndexedRangeAsync(string path, RecordingIndexRange range, Stream destination,
+        CancellationToken ct)
+    {
+        await using var file = new FileStream(path, FileMode.Open, FileAccess.Read,
+            FileShare.ReadWrite | FileShare.Delete, bufferSize: 1, FileOptions.Asynchronous | FileOptions.SequentialScan);
+
+        await CopyBytesAsync(file, 0, range.InitLength, destination, ct);
+        await CopyBytesAsync(file, range.StartOffset, range.EndOffset - range.StartOffset, destination, ct);
+    }
+
+    private static async Task CopyBytesAsync(FileStream file, long offset, long count, Stream destination,
+        CancellationToken ct)
+    {
+        var buffer = ArrayPool<byte>.Shared.Rent(CopyChunkBytes);
+        try
+        {
+            while (count > 0)
+            {
+                int read = await RandomAccess.ReadAsync(file.SafeFileHandle,
+                    buffer.AsMemory(0, (int)Math.Min(buffer.Length, count)), offset, ct);
+                if (read == 0)
+                    throw new EndOfStreamException($"Recording ends before indexed offset {offset + count}");
+
+                await destination.WriteAsync(buffer.AsMemory(0, read), ct);
+                offset += read;
+                count -= read;
+            }
+        }
+        finally
+        {
+            ArrayPool<byte>.Shared.Return(buffer);
+        }
+    }
+
+    private async Task RunFfmpegAsync(string arguments, Func<Stream, CancellationToken, Task>? writeInput,
+        CancellationToken ct)
     {
         var psi = new ProcessStartInfo
         {
@@ -179,6 +377,7 @@ public sealed class ClippingService : IClippingService
             Arguments = arguments,
             UseShellExecute = false,
             CreateNoWindow = true,
+            RedirectStandardInput = writeInput != null,
             RedirectStandardError = true
         };
 
@@ -186,7 +385,26 @@ public sealed class ClippingService : IClippingService
         if (process == null)
             throw new InvalidOperationException("Failed to start FFmpeg");
 
-        var stderr = await process.StandardError.ReadToEndAsync(ct);
+        // Read stderr while feeding stdin, or a chatty FFmpeg blocks on a full stderr pipe
+        var stderrTask = process.StandardError.ReadToEndAsync(ct);
+
+        if (writeInput != null)
+        {
+            try
+            {
+                await writeInput(process.StandardInput.BaseStream, ct);
+            }
+            catch (IOException)
+            {
+                // FFmpeg stopped reading (e.g. -t reached); its exit code tells whether that was fine
+            }
+            finally
+            {
+                try { process.StandardInput.Close(); } catch (IOException) { }
+            }
+        }
+
+        var stderr = await stderrTask;
         await process.WaitForExitAsync(ct);
 
         if (process.ExitCode != 0)
@@ -240,4 +458,9 @@ public sealed class ClippingService : IClippingService
         _pendingInPoint = null;
         _pendingClips.Clear();
     }
+
+    // Clip bytes fed to FFmpeg on stdin instead of it opening the recording. Raw frames carry
+    // no header, so their demuxer needs the geometry.
+    private sealed record ClipInput(string Format, TimeSpan Start, Func<Stream, CancellationToken, Task> Write,
+        Smpte12MTimecode? Timecode = null, RawVideoInfo? Raw = null);
 }
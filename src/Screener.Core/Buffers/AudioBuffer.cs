@@ -1,124 +1,214 @@
-using System.Buffers;
-
 namespace Screener.Core.Buffers;
 
 /// <summary>
-/// Circular buffer for audio samples.
+/// Lock-free single-producer/single-consumer circular buffer for interleaved audio samples.
+/// The producer (a capture thread) never blocks or takes a lock: when the consumer falls
+/// behind, the samples that do not fit are dropped and counted in <see cref="DroppedBytes"/>.
+/// Writes can carry the stream time of their first sample; reads report the time of the
+/// first sample they return, counted forward in samples from the nearest stamped write, so
+/// audio stays aligned with video stamped from the same clock.
 /// </summary>
 public sealed class AudioRingBuffer : IDisposable
 {
+    // Timestamp marks waiting to be read; a write that finds them all in use is not stamped
+    // and its time is counted on from the previous mark
+    private const int MarkCount = 64;
+
+    private struct Mark
+    {
+        public long Position;  // byte position of the stamped write
+        public long Ticks;
+    }
+
     private readonly byte[] _buffer;
     private readonly int _capacity;
-    private readonly object _lock = new();
-    private int _writePos;
-    private int _readPos;
-    private int _available;
-    private bool _disposed;
+    private readonly Mark[] _marks = new Mark[MarkCount];
+    private long _written;     // producer only writes
+    private long _read;        // consumer only writes
+    private long _marksWritten; // producer only writes
+    private long _marksRead;    // consumer only writes: index of the mark in use
+    private long _droppedBytes;
+    private volatile bool _disposed;
 
     public int Capacity => _capacity;
-    public int Available
-    {
-        get { lock (_lock) return _available; }
-    }
 
-    public AudioRingBuffer(int capacity)
-    {
-        _capacity = capacity;
-        _buffer = ArrayPool<byte>.Shared.Rent(capacity);
-    }
+    /// <summary>Bytes of one sample frame (all channels); writes and reads are whole frames.</summary>
+    public int BlockAlign { get; }
+
+    public int SampleRate { get; }
+
+    /// <summary>Bytes waiting to be read.</summary>
+    public int Available => (int)(Volatile.Read(ref _written) - Volatile.Read(ref _read));
+
+    /// <summary>Bytes the producer had to drop because the buffer was full.</summary>
+    public long DroppedBytes => Interlocked.Read(ref _droppedBytes);
 
     /// <summary>
-    /// Write audio samples to the buffer.
+    /// Create a buffer of capacity bytes (rounded down to whole sample frames) for audio of
+    /// blockAlign bytes per sample frame at sampleRate.
     /// </summary>
-    public int Write(ReadOnlySpan<byte> data)
+    public AudioRingBuffer(int capacity, int sampleRate = 48000, int blockAlign = 1)
     {
-        if (_disposed) return 0;
+        ArgumentOutOfRangeException.ThrowIfNegativeOrZero(blockAlign);
+        ArgumentOutOfRangeException.ThrowIfNegativeOrZero(sampleRate);
+        ArgumentOutOfRangeException.ThrowIfLessThan(capacity, blockAlign);
 
-        lock (_lock)
-        {
-            var toWrite = Math.Min(data.Length, _capacity - _available);
-            if (toWrite == 0) return 0;
+        BlockAlign = blockAlign;
+        SampleRate = sampleRate;
+        _capacity = capacity / blockAlign * blockAlign;
 
-            var firstChunk = Math.Min(toWrite, _capacity - _writePos);
-            data[..firstChunk].CopyTo(_buffer.AsSpan(_writePos, firstChunk));
+        // Pinned so native code can copy straight into the free space
+        _buffer = GC.AllocateUninitializedArray<byte>(_capacity, pinned: true);
+    }
 
-            if (toWrite > firstChunk)
-            {
-                data[firstChunk..toWrite].CopyTo(_buffer.AsSpan(0, toWrite - firstChunk));
-            }
+    /// <summary>
+    /// Write audio samples to the buffer. Producer thread only.
+    /// Returns the bytes written; the rest did not fit and is dropped.
+    /// </summary>
+    public int Write(ReadOnlySpan<byte> data) => Write(data, null);
+
+    /// <summary>
+    /// Write audio samples whose first sample is at the given stream time. Producer thread only.
+    /// </summary>
+    public int Write(ReadOnlySpan<byte> data, TimeSpan? timestamp)
+    {
+        if (_disposed) return 0;
 
-            _writePos = (_writePos + toWrite) % _capacity;
-            _available += toWrite;
+        var toWrite = GetWriteRegions(data.Length, out var first, out var second);
+        data[..first.Length].CopyTo(first.Span);
+        data.Slice(first.Length, second.Length).CopyTo(second.Span);
 
-            return toWrite;
-        }
+        CommitWrite(toWrite, timestamp, data.Length - toWrite);
+        return toWrite;
     }
 
     /// <summary>
-    /// Read audio samples from the buffer.
+    /// Free space for up to length bytes (whole sample frames) at the write position, split
+    /// in two where it wraps. Fill both regions, then <see cref="CommitWrite"/>. The buffer is
+    /// pinned, so the regions can be handed to native code. Producer thread only.
+    /// Returns the bytes the two regions hold together.
     /// </summary>
-    public int Read(Span<byte> destination)
+    public int GetWriteRegions(int length, out Memory<byte> first, out Memory<byte> second)
     {
-        if (_disposed) return 0;
+        long written = _written;
+        int free = _capacity - (int)(written - Volatile.Read(ref _read));
+        int toWrite = Math.Min(Math.Max(length, 0), free) / BlockAlign * BlockAlign;
+
+        int position = (int)(written % _capacity);
+        int firstLength = Math.Min(toWrite, _capacity - position);
+        first = _buffer.AsMemory(position, firstLength);
+        second = _buffer.AsMemory(0, toWrite - firstLength);
+        return toWrite;
+    }
 
-        lock (_lock)
-        {
-            var toRead = Math.Min(destination.Length, _available);
-            if (toRead == 0) return 0;
+    /// <summary>
+    /// Publish length bytes filled through <see cref="GetWriteRegions"/>, optionally stamped
+    /// with the stream time of their first sample, and count dropped bytes that did not fit.
+    /// Producer thread only.
+    /// </summary>
+    public void CommitWrite(int length, TimeSpan? timestamp = null, int dropped = 0)
+    {
+        if (dropped > 0)
+            Interlocked.Add(ref _droppedBytes, dropped);
+        if (length <= 0 && timestamp == null)
+            return;
 
-            var firstChunk = Math.Min(toRead, _capacity - _readPos);
-            _buffer.AsSpan(_readPos, firstChunk).CopyTo(destination[..firstChunk]);
+        long written = _written;
 
-            if (toRead > firstChunk)
+        // The mark goes out before the bytes it stamps, so a reader never sees them unstamped
+        if (timestamp.HasValue)
+        {
+            long marks = _marksWritten;
+            if (marks - Volatile.Read(ref _marksRead) < MarkCount)
             {
-                _buffer.AsSpan(0, toRead - firstChunk).CopyTo(destination[firstChunk..]);
+                ref var mark = ref _marks[marks % MarkCount];
+                mark.Position = written;
+                mark.Ticks = timestamp.Value.Ticks;
+                Volatile.Write(ref _marksWritten, marks + 1);
             }
+        }
 
-            _readPos = (_readPos + toRead) % _capacity;
-            _available -= toRead;
+        Volatile.Write(ref _written, written + length);
+    }
 
-            return toRead;
-        }
+    /// <summary>
+    /// Read audio samples from the buffer. Consumer thread only.
+    /// </summary>
+    public int Read(Span<byte> destination) => Read(destination, out _);
+
+    /// <summary>
+    /// Read audio samples along with the stream time of the first one. Consumer thread only.
+    /// </summary>
+    public int Read(Span<byte> destination, out TimeSpan timestamp)
+    {
+        int toRead = Peek(destination, out timestamp);
+        if (toRead > 0)
+            Volatile.Write(ref _read, _read + toRead);
+        return toRead;
     }
 
     /// <summary>
-    /// Peek at samples without consuming them.
+    /// Peek at samples without consuming them. Consumer thread only.
     /// </summary>
-    public int Peek(Span<byte> destination)
+    public int Peek(Span<byte> destination) => Peek(destination, out _);
+
+    private int Peek(Span<byte> destination, out TimeSpan timestamp)
     {
+        timestamp = TimeSpan.Zero;
         if (_disposed) return 0;
 
-        lock (_lock)
-        {
-            var toPeek = Math.Min(destination.Length, _available);
-            if (toPeek == 0) return 0;
-
-            var firstChunk = Math.Min(toPeek, _capacity - _readPos);
-            _buffer.AsSpan(_readPos, firstChunk).CopyTo(destination[..firstChunk]);
+        long read = _read;
+        int available = (int)(Volatile.Read(ref _written) - read);
+        var toRead = Math.Min(destination.Length, available) / BlockAlign * BlockAlign;
+        if (toRead == 0) return 0;
 
-            if (toPeek > firstChunk)
-            {
-                _buffer.AsSpan(0, toPeek - firstChunk).CopyTo(destination[firstChunk..]);
-            }
+        int position = (int)(read % _capacity);
+        var firstChunk = Math.Min(toRead, _capacity - position);
+        _buffer.AsSpan(position, firstChunk).CopyTo(destination[..firstChunk]);
 
-            return toPeek;
+        if (toRead > firstChunk)
+        {
+            _buffer.AsSpan(0, toRead - firstChunk).CopyTo(destination[firstChunk..]);
         }
+
+        timestamp = TimestampAt(read);
+        return toRead;
     }
 
+    /// <summary>
+    /// Discard everything written so far. Consumer thread only.
+    /// </summary>
     public void Clear()
     {
-        lock (_lock)
+        Volatile.Write(ref _read, Volatile.Read(ref _written));
+    }
+
+    // Stream time of the sample at a byte position, counted from the latest mark at or before it
+    private TimeSpan TimestampAt(long position)
+    {
+        long marksRead = _marksRead;
+        long marksWritten = Volatile.Read(ref _marksWritten);
+        while (marksRead + 1 < marksWritten && _marks[(marksRead + 1) % MarkCount].Position <= position)
+            marksRead++;
+        Volatile.Write(ref _marksRead, marksRead);
+
+        long basePosition = 0, baseTicks = 0;
+        if (marksRead < marksWritten)
         {
-            _writePos = 0;
-            _readPos = 0;
-            _available = 0;
+            var mark = _marks[marksRead % MarkCount];
+            if (mark.Position <= position)
+            {
+                basePosition = mark.Position;
+                baseTicks = mark.Ticks;
+            }
         }
+
+        long frames = (position - basePosition) / BlockAlign;
+        return TimeSpan.FromTicks(baseTicks + frames * TimeSpan.TicksPerSecond / SampleRate);
     }
 
     public void Dispose()
     {
-        if (_disposed) return;
         _disposed = true;
-        ArrayPool<byte>.Shared.Return(_buffer);
     }
 }
@@ -0,0 +1,177 @@
+using Screener.Abstractions.Capture;
+
+namespace Screener.Core.Buffers;
+
+/// <summary>
+/// Lock-free single-producer/multi-consumer ring of pinned frame slots.
+/// The capture thread claims a slot with <see cref="TryBeginWrite"/>, copies the DMA buffer
+/// (or decodes the received frame) into it and <see cref="Publish"/>es it under a new sequence
+/// number. Consumers that need the bytes after the VideoFrameReceived handler returns lease the
+/// slot by sequence; the producer skips leased slots instead of overwriting them, and drops the
+/// frame if every slot is leased.
+/// Slots can carry a second pinned buffer for the detectors' luma plane, filled during the copy,
+/// and a third for the preview pyramid built from it.
+/// </summary>
+public sealed class FrameRing : IFrameLeaseSource
+{
+    // Slot state: Writing while the producer owns it, otherwise the number of reader leases
+    private const int Writing = -1;
+
+    private sealed class Slot
+    {
+        public readonly byte[] Buffer;
+        public readonly byte[]? Luma;
+        public readonly byte[]? Pyramid;
+        public int State;
+        public long Sequence; // 0 = nothing published
+
+        public Slot(int size, int lumaSize, int pyramidSize)
+        {
+            Buffer = GC.AllocateUninitializedArray<byte>(size, pinned: true);
+            if (lumaSize > 0)
+                Luma = GC.AllocateUninitializedArray<byte>(lumaSize, pinned: true);
+            if (pyramidSize > 0)
+                Pyramid = GC.AllocateUninitializedArray<byte>(pyramidSize, pinned: true);
+        }
+    }
+
+    private sealed class Lease : IDisposable
+    {
+        private Slot? _slot;
+
+        public Lease(Slot slot) => _slot = slot;
+
+        public void Dispose()
+        {
+            var slot = Interlocked.Exchange(ref _slot, null);
+            if (slot != null)
+                Interlocked.Decrement(ref slot.State);
+        }
+    }
+
+    private readonly Slot[] _slots;
+    private int _nextWriteIndex;   // producer only
+    private long _lastSequence;    // producer only
+    private Slot? _writing;        // producer only
+
+    public FrameRing(int slotCount, int slotSize, int lumaSize = 0, int pyramidSize = 0)
+    {
+        _slots = new Slot[slotCount];
+        for (int i = 0; i < slotCount; i++)
+            _slots[i] = new Slot(slotSize, lumaSize, pyramidSize);
+        SlotSize = slotSize;
+        LumaSize = lumaSize;
+        PyramidSize = pyramidSize;
+    }
+
+    public int SlotCount => _slots.Length;
+    public int SlotSize { get; }
+    public int LumaSize { get; }
+    public int PyramidSize { get; }
+
+    /// <summary>
+    /// Luma buffer of the slot returned by the last <see cref="TryBeginWrite"/>, or null if
+    /// nothing is claimed or the ring was created without luma.
+    /// </summary>
+    public byte[]? ClaimedLuma => _writing?.Luma;
+
+    /// <summary>
+    /// Preview pyramid buffer of the claimed slot, or null if nothing is claimed or the ring
+    /// was created without one.
+    /// </summary>
+    public byte[]? ClaimedPyramid => _writing?.Pyramid;
+
+    /// <summary>
+    /// Claim the oldest slot no reader holds. Returns null when every slot is leased.
+    /// Producer thread only; at most one slot is claimed at a time.
+    /// </summary>
+    public byte[]? TryBeginWrite()
+    {
+        // A claim left open by an early return goes back to the pool
+        Abandon();
+
+        for (int i = 0; i < _slots.Length; i++)
+        {
+            int index = (_nextWriteIndex + i) % _slots.Length;
+            var slot = _slots[index];
+            if (Interlocked.CompareExchange(ref slot.State, Writing, 0) != 0)
+                continue;
+
+            // Readers that raced the claim see the cleared sequence and back out
+            Volatile.Write(ref slot.Sequence, 0);
+            _nextWriteIndex = (index + 1) % _slots.Length;
+            _writing = slot;
+            return slot.Buffer;
+        }
+
+        return null;
+    }
+
+    /// <summary>
+    /// Make the claimed slot readable. Returns its sequence number.
+    /// </summary>
+    public long Publish()
+    {
+        var slot = _writing ?? throw new InvalidOperationException("No slot claimed");
+        _writing = null;
+
+        var sequence = ++_lastSequence;
+        Volatile.Write(ref slot.Sequence, sequence);
+        Volatile.Write(ref slot.State, 0);
+        return sequence;
+    }
+
+    /// <summary>
+    /// Release the claimed slot without publishing it (failed copy, startup frames).
+    /// </summary>
+    public void Abandon()
+    {
+        var slot = _writing;
+        if (slot == null) return;
+        _writing = null;
+
+        Volatile.Write(ref slot.State, 0);
+    }
+
+    public IDisposable? TryLease(long sequence) => TryLease(sequence, out _);
+
+    /// <summary>
+    /// Lease a slot like <see cref="TryLease(long)"/> and return the slot's buffer, which stays
+    /// unchanged until the lease is disposed.
+    /// </summary>
+    public IDisposable? TryLease(long sequence, out byte[]? buffer)
+    {
+        buffer = null;
+        if (sequence <= 0) return null;
+
+        foreach (var slot in _slots)
+        {
+            if (Volatile.Read(ref slot.Sequence) != sequence)
+                continue;
+
+            int state = Volatile.Read(ref slot.State);
+            while (state >= 0)
+            {
+                int seen = Interlocked.CompareExchange(ref slot.State, state + 1, state);
+                if (seen == state)
+                {
+                    // The producer may have claimed and republished the slot between the
+                    // sequence check and the increment
+                    if (Volatile.Read(ref slot.Sequence) == sequence)
+                    {
+                        buffer = slot.Buffer;
+                        return new Lease(slot);
+                    }
+
+                    Interlocked.Decrement(ref slot.State);
+                    return null;
+                }
+                state = seen;
+            }
+
+            return null;
+        }
+
+        return null;
+    }
+}
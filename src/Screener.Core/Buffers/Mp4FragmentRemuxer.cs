@@ -0,0 +1,595 @@
+using System.Buffers.Binary;
+using Screener.Abstractions.Clipping;
+
+namespace Screener.Core.Buffers;
+
+/// <summary>
+/// Remuxes a fragmented MP4 (H.264/HEVC, one video track) into MPEG-TS for a replay buffer as
+/// it is written: each moof/mdat pair becomes one PES per sample, Annex B, with the parameter
+/// sets and PAT/PMT repeated at every keyframe. Lets an encoder that only writes MP4 feed the
+/// ring with its own compressed samples. Fed by a single writer.
+/// </summary>
+public sealed class Mp4FragmentRemuxer
+{
+    private const int PacketSize = 188;
+    private const int PmtPid = 0x1000;
+    private const int VideoPid = 0x100;
+    private const long PtsClock = 90_000;
+    private const long PtsMask = (1L << 33) - 1;
+
+    // Decode time zero goes out at one second, so composition offsets never go below zero
+    private const long TimestampOffset = PtsClock;
+
+    // A box this large is not a fragment the encoder wrote; stop rather than buffer it
+    private const long MaxBoxBytes = 256L * 1024 * 1024;
+
+    private static readonly uint[] CrcTable = BuildCrcTable();
+
+    private readonly IReplayBuffer _replay;
+
+    // Bytes not yet consumed, starting at file offset _pendingStart
+    private byte[] _pending = new byte[1024 * 1024];
+    private int _pendingLength;
+    private long _pendingStart;
+
+    // Video track from the moov
+    private uint _trackId;
+    private uint _timescale;
+    private bool _hevc;
+    private int _nalLengthSize;
+    private byte[] _parameterSets = Array.Empty<byte>();   // Annex B
+    private uint _defaultDuration;
+    private uint _defaultSize;
+    private uint _defaultFlags;
+    private long _nextDts;
+
+    // One sample's PES, then its TS packets
+    private byte[] _pes = new byte[256 * 1024];
+    private byte[] _ts = new byte[256 * 1024];
+    private int _patCounter;
+    private int _pmtCounter;
+    private int _videoCounter;
+
+    public Mp4FragmentRemuxer(IReplayBuffer replay)
+    {
+        _replay = replay;
+    }
+
+    /// <summary>
+    /// Bytes written to the MP4 at a file offset. Rewrites of bytes already passed (a sink
+    /// patching its header) are ignored. Throws <see cref="InvalidDataException"/> on a gap
+    /// or a stream it cannot remux, after which the remuxer should not be fed again.
+    /// </summary>
+    public void Write(long position, ReadOnlySpan<byte> data)
+    {
+        long end = _pendingStart + _pendingLength;
+        if (position < end)
+            return;
+        if (position > end)
+            throw new InvalidDataException($"MP4 write at {position} skips past {end}");
+
+        EnsureCapacity(ref _pending, _pendingLength + data.Length, _pendingLength);
+        data.CopyTo(_pending.AsSpan(_pendingLength));
+        _pendingLength += data.Length;
+
+        int consumed = ConsumeBoxes(_pending.AsSpan(0, _pendingLength));
+        if (consumed > 0)
+        {
+            _pending.AsSpan(consumed, _pendingLength - consumed).CopyTo(_pending);
+            _pendingLength -= consumed;
+            _pendingStart += consumed;
+        }
+    }
+
+    // Top-level boxes complete in the buffer; a moof waits for the mdat that follows it
+    private int ConsumeBoxes(ReadOnlySpan<byte> buffer)
+    {
+        int cursor = 0;
+        while (TryReadBox(buffer[cursor..], out uint type, out int header, out long size))
+        {
+            if (size > buffer.Length - cursor)
+                break;
+
+            var box = buffer.Slice(cursor, (int)size);
+            if (type == Fourcc("moof"))
+            {
+                var rest = buffer[(cursor + (int)size)..];
+                if (!TryReadBox(rest, out uint nextType, out int mdatHeader, out long mdatSize) || mdatSize > rest.Length)
+                    break;
+                if (nextType != Fourcc("mdat"))
+                    throw new InvalidDataException("MP4 fragment has no mdat after its moof");
+
+                RemuxFragment(box[header..], _pendingStart + cursor,
+                    rest.Slice(mdatHeader, (int)mdatSize - mdatHeader), _pendingStart + cursor + size + mdatHeader);
+                cursor += (int)(size + mdatSize);
+                continue;
+            }
+
+            if (type == Fourcc("moov"))
+                ParseMoov(box[header..]);
+
+            cursor += (int)size;
+        }
+
+        return cursor;
+    }
+
+    private static bool TryReadBox(ReadOnlySpan<byte> data, out uint type, out int header, out long size)
+    {
+        type = 0;
+        header = 8;
+        size = 0;
+        if (data.Length < 8)
+            return false;
+
+        size = BinaryPrimitives.ReadUInt32BigEndian(data);
+        type = BinaryPrimitives.ReadUInt32BigEndian(data[4..]);
+        if (size == 1)
+        {
+            if (data.Length < 16)
+                return false;
+            size = (long)BinaryPrimitives.ReadUInt64BigEndian(data[8..]);
+            header = 16;
+        }
+
+        // Zero (the box runs to the end of the file) is only used by an unfragmented mdat
+        if (size < header || size > MaxBoxBytes)
+            throw new InvalidDataException($"MP4 box '{FourccName(type)}' has an unusable size {size}");
+        return true;
+    }
+
+    // Children of a container box's body, as (type, body offset, body length)
+    private static List<(uint Type, int Offset, int Length)> Children(ReadOnlySpan<byte> body)
+    {
+        var boxes = new List<(uint, int, int)>();
+        int cursor = 0;
+        while (cursor + 8 <= body.Length && TryReadBox(body[cursor..], out uint type, out int header, out long size))
+        {
+            if (size > body.Length - cursor)
+                break;
+            boxes.Add((type, cursor + header, (int)size - header));
+            cursor += (int)size;
+        }
+        return boxes;
+    }
+
+    private void ParseMoov(ReadOnlySpan<byte> moov)
+    {
+        foreach (var (type, offset, length) in Children(moov))
+        {
+            var body = moov.Slice(offset, length);
+            if (type == Fourcc("trak"))
+                ParseTrak(body);
+            else if (type == Fourcc("mvex"))
+                ParseMvex(body);
+        }
+
+        if (_nalLengthSize == 0)
+            throw new InvalidDataException("MP4 has no H.264 or HEVC track");
+    }
+
+    private void ParseTrak(ReadOnlySpan<byte> trak)
+    {
+        uint trackId = 0;
+        uint timescale = 0;
+        bool video = false;
+
+        foreach (var (type, offset, length) in Children(trak))
+        {
+            var body = trak.Slice(offset, length);
+            if (type == Fourcc("tkhd"))
+            {
+                trackId = BinaryPrimitives.ReadUInt32BigEndian(body[(body[0] == 1 ? 20 : 12)..]);
+                continue;
+            }
+            if (type != Fourcc("mdia"))
+                continue;
+
+            foreach (var (mdiaType, mdiaOffset, mdiaLength) in Children(body))
+            {
+                var mdia = body.Slice(mdiaOffset, mdiaLength);
+                if (mdiaType == Fourcc("mdhd"))
+                    timescale = BinaryPrimitives.ReadUInt32BigEndian(mdia[(mdia[0] == 1 ? 20 : 12)..]);
+                else if (mdiaType == Fourcc("hdlr"))
+                    video = BinaryPrimitives.ReadUInt32BigEndian(mdia[8..]) == Fourcc("vide");
+                else if (mdiaType == Fourcc("minf") && video)
+                    ParseSampleEntry(Find(Find(mdia, "stbl"), "stsd"));
+            }
+        }
+
+        if (video && _nalLengthSize > 0)
+        {
+            _trackId = trackId;
+            _timescale = timescale > 0 ? timescale : throw new InvalidDataException("MP4 video track has no timescale");
+        }
+    }
+
+    private void ParseMvex(ReadOnlySpan<byte> mvex)
+    {
+        foreach (var (type, offset, length) in Children(mvex))
+        {
+            var trex = mvex.Slice(offset, length);
+            if (type != Fourcc("trex") || trex.Length < 24 || BinaryPrimitives.ReadUInt32BigEndian(trex[4..]) != _trackId)
+                continue;
+
+            _defaultDuration = BinaryPrimitives.ReadUInt32BigEndian(trex[12..]);
+            _defaultSize = BinaryPrimitives.ReadUInt32BigEndian(trex[16..]);
+            _defaultFlags = BinaryPrimitives.ReadUInt32BigEndian(trex[20..]);
+        }
+    }
+
+    // First stsd entry: avc1/avc3 with avcC, or hvc1/hev1 with hvcC, after the 78-byte visual entry
+    private void ParseSampleEntry(ReadOnlySpan<byte> stsd)
+    {
+        if (stsd.Length < 16)
+            return;
+
+        var entries = stsd[8..];
+        if (!TryReadBox(entries, out uint type, out int header, out long size) || size > entries.Length)
+            return;
+
+        bool avc = type == Fourcc("avc1") || type == Fourcc("avc3");
+        bool hevc = type == Fourcc("hvc1") || type == Fourcc("hev1");
+        if ((!avc && !hevc) || size < header + 78)
+            return;
+
+        var config = Find(entries.Slice(header + 78, (int)size - header - 78), avc ? "avcC" : "hvcC");
+        var parameterSets = new List<byte>();
+        if (avc && config.Length >= 7)
+        {
+            _nalLengthSize = (config[4] & 0x03) + 1;
+            int cursor = 5;
+            int spsCount = config[cursor++] & 0x1F;
+            cursor = CopyParameterSets(config, cursor, spsCount, parameterSets);
+            if (cursor < config.Length)
+                CopyParameterSets(config, cursor + 1, config[cursor], parameterSets);
+        }
+        else if (hevc && config.Length >= 23)
+        {
+            _nalLengthSize = (config[21] & 0x03) + 1;
+            int cursor = 23;
+            for (int array = 0; array < config[22] && cursor + 3 <= config.Length; array++)
+                cursor = CopyParameterSets(config, cursor + 3, BinaryPrimitives.ReadUInt16BigEndian(config[(cursor + 1)..]), parameterSets);
+        }
+
+        _hevc = hevc;
+        _parameterSets = parameterSets.ToArray();
+    }
+
+    // count length-prefixed (16-bit) NAL units from config[cursor..], as Annex B
+    private static int CopyParameterSets(ReadOnlySpan<byte> config, int cursor, int count, List<byte> annexB)
+    {
+        for (int i = 0; i < count && cursor + 2 <= config.Length; i++)
+        {
+            int length = BinaryPrimitives.ReadUInt16BigEndian(config[cursor..]);
+            cursor += 2;
+            if (cursor + length > config.Length)
+                throw new InvalidDataException("MP4 decoder configuration is truncated");
+
+            annexB.AddRange(StartCode);
+            annexB.AddRange(config.Slice(cursor, length));
+            cursor += length;
+        }
+        return cursor;
+    }
+
+    private static ReadOnlySpan<byte> Find(ReadOnlySpan<byte> body, string type)
+    {
+        uint fourcc = Fourcc(type);
+        foreach (var (childType, offset, length) in Children(body))
+        {
+            if (childType == fourcc)
+                return body.Slice(offset, length);
+        }
+        return ReadOnlySpan<byte>.Empty;
+    }
+
+    // The video traf's samples, in decode order, out of the mdat that follows the moof
+    private void RemuxFragment(ReadOnlySpan<byte> moof, long moofStart, ReadOnlySpan<byte> mdat, long mdatStart)
+    {
+        if (_nalLengthSize == 0)
+            throw new InvalidDataException("MP4 fragment arrived before its moov");
+
+        foreach (var (type, offset, length) in Children(moof))
+        {
+            if (type == Fourcc("traf"))
+                RemuxTraf(moof.Slice(offset, length), moofStart, mdat, mdatStart);
+        }
+    }
+
+    private void RemuxTraf(ReadOnlySpan<byte> traf, long moofStart, ReadOnlySpan<byte> mdat, long mdatStart)
+    {
+        var tfhd = Find(traf, "tfhd");
+        if (tfhd.Length < 8 || BinaryPrimitives.ReadUInt32BigEndian(tfhd[4..]) != _trackId)
+            return;
+
+        uint tfhdFlags = BinaryPrimitives.ReadUInt32BigEndian(tfhd) & 0xFFFFFF;
+        int field = 8;
+        long dataBase = moofStart;
+        uint defaultDuration = _defaultDuration, defaultSize = _defaultSize, defaultFlags = _defaultFlags;
+        if ((tfhdFlags & 0x01) != 0) { dataBase = (long)BinaryPrimitives.ReadUInt64BigEndian(tfhd[field..]); field += 8; }
+        if ((tfhdFlags & 0x02) != 0) field += 4;
+        if ((tfhdFlags & 0x08) != 0) { defaultDuration = BinaryPrimitives.ReadUInt32BigEndian(tfhd[field..]); field += 4; }
+        if ((tfhdFlags & 0x10) != 0) { defaultSize = BinaryPrimitives.ReadUInt32BigEndian(tfhd[field..]); field += 4; }
+        if ((tfhdFlags & 0x20) != 0) defaultFlags = BinaryPrimitives.ReadUInt32BigEndian(tfhd[field..]);
+
+        var tfdt = Find(traf, "tfdt");
+        if (tfdt.Length >= 8)
+        {
+            _nextDts = tfdt[0] == 1
+                ? (long)BinaryPrimitives.ReadUInt64BigEndian(tfdt[4..])
+                : BinaryPrimitives.ReadUInt32BigEndian(tfdt[4..]);
+        }
+
+        long dataCursor = dataBase;
+        foreach (var (type, offset, length) in Children(traf))
+        {
+            if (type != Fourcc("trun"))
+                continue;
+
+            var trun = traf.Slice(offset, length);
+            uint flags = BinaryPrimitives.ReadUInt32BigEndian(trun) & 0xFFFFFF;
+            int count = (int)BinaryPrimitives.ReadUInt32BigEndian(trun[4..]);
+            int cursor = 8;
+            if ((flags & 0x01) != 0) { dataCursor = dataBase + BinaryPrimitives.ReadInt32BigEndian(trun[cursor..]); cursor += 4; }
+            uint? firstFlags = null;
+            if ((flags & 0x04) != 0) { firstFlags = BinaryPrimitives.ReadUInt32BigEndian(trun[cursor..]); cursor += 4; }
+
+            for (int i = 0; i < count; i++)
+            {
+                uint duration = defaultDuration;
+                uint size = defaultSize;
+                uint sampleFlags = i == 0 && firstFlags.HasValue ? firstFlags.Value : defaultFlags;
+                int compositionOffset = 0;
+                if (cursor + 4 * CountBits(flags & 0xF00) > trun.Length)
+                    throw new InvalidDataException("MP4 track run is truncated");
+                if ((flags & 0x100) != 0) { duration = BinaryPrimitives.ReadUInt32BigEndian(trun[cursor..]); cursor += 4; }
+                if ((flags & 0x200) != 0) { size = BinaryPrimitives.ReadUInt32BigEndian(trun[cursor..]); cursor += 4; }
+                if ((flags & 0x400) != 0) { sampleFlags = BinaryPrimitives.ReadUInt32BigEndian(trun[cursor..]); cursor += 4; }
+                if ((flags & 0x800) != 0) { compositionOffset = BinaryPrimitives.ReadInt32BigEndian(trun[cursor..]); cursor += 4; }
+
+                long start = dataCursor - mdatStart;
+                if (start < 0 || start + size > mdat.Length)
+                    throw new InvalidDataException("MP4 sample lies outside its fragment's mdat");
+
+                // sample_is_non_sync_sample clear marks a keyframe
+                bool keyframe = (sampleFlags & 0x10000) == 0;
+                long dts = ToPts(_nextDts);
+                long pts = ToPts(_nextDts + compositionOffset);
+                WriteSample(mdat.Slice((int)start, (int)size), keyframe, pts, dts);
+
+                dataCursor += size;
+                _nextDts += duration;
+            }
+        }
+    }
+
+    private static int CountBits(uint value) => System.Numerics.BitOperations.PopCount(value);
+
+    private long ToPts(long mediaTime) =>
+        (mediaTime * PtsClock / _timescale + TimestampOffset) & PtsMask;
+
+    // One access unit: AUD, parameter sets on a keyframe, then the sample's NAL units, as one PES
+    private void WriteSample(ReadOnlySpan<byte> sample, bool keyframe, long pts, long dts)
+    {
+        int esBound = 19 + 7 + (keyframe ? _parameterSets.Length : 0) + sample.Length + sample.Length / _nalLengthSize * 4;
+        EnsureCapacity(ref _pes, esBound, 0);
+
+        var pes = _pes.AsSpan();
+        bool writeDts = dts != pts;
+        pes[0] = 0; pes[1] = 0; pes[2] = 1; pes[3] = 0xE0;
+        pes[4] = 0; pes[5] = 0;                     // unbounded, as video allows
+        pes[6] = 0x80;
+        pes[7] = (byte)(writeDts ? 0xC0 : 0x80);
+        pes[8] = (byte)(writeDts ? 10 : 5);
+        WriteTimestamp(pes[9..], writeDts ? 0x3 : 0x2, pts);
+        if (writeDts)
+            WriteTimestamp(pes[14..], 0x1, dts);
+        int length = 9 + pes[8];
+
+        length += WriteAccessUnitDelimiter(pes[length..]);
+        if (keyframe)
+        {
+            _parameterSets.CopyTo(pes[length..]);
+            length += _parameterSets.Length;
+        }
+
+        while (sample.Length >= _nalLengthSize)
+        {
+            int nalLength = 0;
+            for (int i = 0; i < _nalLengthSize; i++)
+                nalLength = (nalLength << 8) | sample[i];
+            sample = sample[_nalLengthSize..];
+            if (nalLength > sample.Length)
+                throw new InvalidDataException("MP4 sample has a truncated NAL unit");
+
+            var nal = sample[..nalLength];
+            sample = sample[nalLength..];
+            if (nal.Length == 0 || IsAccessUnitDelimiter(nal[0]))
+                continue;
+
+            StartCode.CopyTo(pes[length..]);
+            nal.CopyTo(pes[(length + StartCode.Length)..]);
+            length += StartCode.Length + nal.Length;
+        }
+
+        Packetize(pes[..length], keyframe, dts);
+    }
+
+    private static ReadOnlySpan<byte> StartCode => new byte[] { 0, 0, 0, 1 };
+
+    private int WriteAccessUnitDelimiter(Span<byte> destination)
+    {
+        StartCode.CopyTo(destination);
+        if (_hevc)
+        {
+            destination[4] = 0x46; destination[5] = 0x01; destination[6] = 0x50;
+            return 7;
+        }
+
+        destination[4] = 0x09; destination[5] = 0xF0;
+        return 6;
+    }
+
+    private bool IsAccessUnitDelimiter(byte header) =>
+        _hevc ? ((header >> 1) & 0x3F) == 35 : (header & 0x1F) == 9;
+
+    private static void WriteTimestamp(Span<byte> destination, int prefix, long timestamp)
+    {
+        destination[0] = (byte)((prefix << 4) | (int)((timestamp >> 29) & 0x0E) | 1);
+        destination[1] = (byte)(timestamp >> 22);
+        destination[2] = (byte)(((timestamp >> 14) & 0xFE) | 1);
+        destination[3] = (byte)(timestamp >> 7);
+        destination[4] = (byte)(((timestamp << 1) & 0xFE) | 1);
+    }
+
+    // PAT/PMT ahead of a keyframe, then the PES with a PCR (and the random access flag the
+    // replay buffer indexes keyframes by) in its first packet
+    private void Packetize(ReadOnlySpan<byte> pes, bool keyframe, long dts)
+    {
+        int packets = (keyframe ? 2 : 0) + pes.Length / (PacketSize - 12) + 2;
+        EnsureCapacity(ref _ts, packets * PacketSize, 0);
+
+        var ts = _ts.AsSpan();
+        int written = 0;
+        if (keyframe)
+        {
+            WritePat(ts[written..]);
+            written += PacketSize;
+            WritePmt(ts[written..]);
+            written += PacketSize;
+        }
+
+        bool first = true;
+        while (pes.Length > 0)
+        {
+            int taken = WritePacket(ts.Slice(written, PacketSize), VideoPid, ref _videoCounter, first,
+                first && keyframe, first ? dts : -1, pes);
+            pes = pes[taken..];
+            written += PacketSize;
+            first = false;
+        }
+
+        _replay.Append(ts[..written]);
+    }
+
+    // One packet of payload; returns the payload bytes it took. Short payloads are padded
+    // with adaptation field stuffing.
+    private static int WritePacket(Span<byte> packet, int pid, ref int counter, bool unitStart, bool randomAccess,
+        long pcr, ReadOnlySpan<byte> payload)
+    {
+        int adaptationContent = pcr >= 0 ? 7 : randomAccess ? 1 : 0;
+        int space = PacketSize - 4 - (adaptationContent > 0 ? 1 + adaptationContent : 0);
+        int take = Math.Min(payload.Length, space);
+        int adaptationTotal = PacketSize - 4 - take;
+
+        packet[0] = 0x47;
+        packet[1] = (byte)((unitStart ? 0x40 : 0) | (pid >> 8));
+        packet[2] = (byte)pid;
+        packet[3] = (byte)((adaptationTotal > 0 ? 0x30 : 0x10) | counter);
+        counter = (counter + 1) & 0x0F;
+
+        if (adaptationTotal > 0)
+        {
+            packet[4] = (byte)(adaptationTotal - 1);
+            if (adaptationTotal > 1)
+            {
+                packet[5] = (byte)((randomAccess ? 0x40 : 0) | (pcr >= 0 ? 0x10 : 0));
+                int stuffing = 6;
+                if (pcr >= 0)
+                {
+                    packet[6] = (byte)(pcr >> 25);
+                    packet[7] = (byte)(pcr >> 17);
+                    packet[8] = (byte)(pcr >> 9);
+                    packet[9] = (byte)(pcr >> 1);
+                    packet[10] = (byte)(((pcr & 1) << 7) | 0x7E);
+                    packet[11] = 0;
+                    stuffing = 12;
+                }
+                packet[stuffing..(4 + adaptationTotal)].Fill(0xFF);
+            }
+        }
+
+        payload[..take].CopyTo(packet[(4 + adaptationTotal)..]);
+        return take;
+    }
+
+    private void WritePat(Span<byte> packet)
+    {
+        Span<byte> section = stackalloc byte[16];
+        section[0] = 0x00;                                      // program_association_section
+        section[1] = 0xB0; section[2] = 13;
+        section[3] = 0x00; section[4] = 0x01;                   // transport_stream_id
+        section[5] = 0xC1; section[6] = 0; section[7] = 0;
+        section[8] = 0x00; section[9] = 0x01;                   // program 1
+        section[10] = (byte)(0xE0 | (PmtPid >> 8)); section[11] = PmtPid & 0xFF;
+        WriteCrc(section, 12);
+        WritePsiPacket(packet, 0, ref _patCounter, section);
+    }
+
+    private void WritePmt(Span<byte> packet)
+    {
+        Span<byte> section = stackalloc byte[21];
+        section[0] = 0x02;                                      // TS_program_map_section
+        section[1] = 0xB0; section[2] = 18;
+        section[3] = 0x00; section[4] = 0x01;                   // program 1
+        section[5] = 0xC1; section[6] = 0; section[7] = 0;
+        section[8] = (byte)(0xE0 | (VideoPid >> 8)); section[9] = VideoPid & 0xFF;    // PCR on the video PID
+        section[10] = 0xF0; section[11] = 0;
+        section[12] = (byte)(_hevc ? 0x24 : 0x1B);
+        section[13] = (byte)(0xE0 | (VideoPid >> 8)); section[14] = VideoPid & 0xFF;
+        section[15] = 0xF0; section[16] = 0;
+        WriteCrc(section, 17);
+        WritePsiPacket(packet, PmtPid, ref _pmtCounter, section);
+    }
+
+    private static void WritePsiPacket(Span<byte> packet, int pid, ref int counter, ReadOnlySpan<byte> section)
+    {
+        packet[0] = 0x47;
+        packet[1] = (byte)(0x40 | (pid >> 8));
+        packet[2] = (byte)pid;
+        packet[3] = (byte)(0x10 | counter);
+        counter = (counter + 1) & 0x0F;
+        packet[4] = 0;                                          // pointer_field
+        section.CopyTo(packet[5..]);
+        packet[(5 + section.Length)..].Fill(0xFF);
+    }
+
+    // CRC-32/MPEG-2 of section[..length], appended after it
+    private static void WriteCrc(Span<byte> section, int length)
+    {
+        uint crc = 0xFFFFFFFF;
+        foreach (byte b in section[..length])
+            crc = (crc << 8) ^ CrcTable[((crc >> 24) ^ b) & 0xFF];
+        BinaryPrimitives.WriteUInt32BigEndian(section[length..], crc);
+    }
+
+    private static uint[] BuildCrcTable()
+    {
+        var table = new uint[256];
+        for (uint i = 0; i < 256; i++)
+        {
+            uint crc = i << 24;
+            for (int bit = 0; bit < 8; bit++)
+                crc = (crc & 0x80000000) != 0 ? (crc << 1) ^ 0x04C11DB7 : crc << 1;
+            table[i] = crc;
+        }
+        return table;
+    }
+
+    private static void EnsureCapacity(ref byte[] buffer, int required, int keep)
+    {
+        if (buffer.Length >= required)
+            return;
+
+        var grown = new byte[Math.Max(required, buffer.Length * 2)];
+        buffer.AsSpan(0, keep).CopyTo(grown);
+        buffer = grown;
+    }
+
+    private static uint Fourcc(string type) =>
+        (uint)(type[0] << 24 | type[1] << 16 | type[2] << 8 | type[3]);
+
+    private static string FourccName(uint type) =>
+        new(new[] { (char)(type >> 24), (char)((type >> 16) & 0xFF), (char)((type >> 8) & 0xFF), (char)(type & 0xFF) });
+}
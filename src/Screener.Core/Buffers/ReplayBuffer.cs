@@ -0,0 +1,394 @@
+using System.Buffers;
+using System.IO.MemoryMappedFiles;
+using Screener.Abstractions.Clipping;
+
+namespace Screener.Core.Buffers;
+
+/// <summary>
+/// Circular buffer of an encoder's MPEG-TS output with a keyframe index. The ring is a
+/// pagefile-backed memory-mapped section, so a long window costs address space and pagefile,
+/// not working set, and never touches the recording drive.
+/// </summary>
+public sealed unsafe class ReplayBuffer : IReplayBuffer, IDisposable
+{
+    private const int PacketSize = 188;
+    private const byte SyncByte = 0x47;
+    private const long PtsClock = 90_000;
+    private const long PtsWrap = 1L << 33;
+
+    // Snapshots are streamed through a pooled buffer this size, below the large object heap
+    internal const int CopyChunkSize = 64 * 1024;
+
+    private readonly MemoryMappedFile _map;
+    private readonly MemoryMappedViewAccessor _view;
+    private readonly byte* _ring;
+    private readonly long _capacity;
+    private readonly object _lock = new();
+
+    // Keyframes still in the ring, oldest first
+    private readonly List<GopEntry> _gops = new();
+
+    // Packet split across Append calls
+    private readonly byte[] _carry = new byte[PacketSize];
+    private int _carryLength;
+
+    // Absolute bytes written; the ring holds [_writeOffset - _capacity, _writeOffset)
+    private long _writeOffset;
+
+    // Latest PAT/PMT, written ahead of every snapshot so it demuxes on its own
+    private byte[]? _pat;
+    private byte[]? _pmt;
+    private int _pmtPid = -1;
+    private int _videoPid = -1;
+
+    // Video PTS, unwrapped past 33 bits; the first one is recording position zero
+    private long _firstPts = -1;
+    private long _lastRawPts = -1;
+    private long _ptsOffset;
+    private long _newestPts = -1;
+    private bool _disposed;
+
+    public TimeSpan Window { get; }
+    public long Capacity => _capacity;
+
+    public ReplayBuffer(TimeSpan window, long capacityBytes)
+    {
+        if (capacityBytes < PacketSize * 1024)
+            throw new ArgumentOutOfRangeException(nameof(capacityBytes));
+
+        Window = window;
+        _capacity = capacityBytes;
+        _map = MemoryMappedFile.CreateNew(null, capacityBytes, MemoryMappedFileAccess.ReadWrite);
+        _view = _map.CreateViewAccessor(0, capacityBytes);
+
+        byte* pointer = null;
+        _view.SafeMemoryMappedViewHandle.AcquirePointer(ref pointer);
+        _ring = pointer + _view.PointerOffset;
+    }
+
+    public TimeSpan? OldestPosition
+    {
+        get
+        {
+            lock (_lock)
+                return _gops.Count > 0 ? ToPosition(_gops[0].Pts) : null;
+        }
+    }
+
+    public TimeSpan? NewestPosition
+    {
+        get
+        {
+            lock (_lock)
+                return _newestPts >= 0 ? ToPosition(_newestPts) : null;
+        }
+    }
+
+    public void Append(ReadOnlySpan<byte> transportStream)
+    {
+        lock (_lock)
+        {
+            if (_disposed) return;
+
+            if (_carryLength > 0)
+            {
+                int take = Math.Min(PacketSize - _carryLength, transportStream.Length);
+                transportStream[..take].CopyTo(_carry.AsSpan(_carryLength));
+                _carryLength += take;
+                transportStream = transportStream[take..];
+
+                if (_carryLength < PacketSize)
+                    return;
+
+                _carryLength = 0;
+                if (_carry[0] == SyncByte)
+                    AddPacket(_carry);
+            }
+
+            while (transportStream.Length >= PacketSize)
+            {
+                if (transportStream[0] != SyncByte)
+                {
+                    // Lost sync (should not happen on a pipe): skip to the next sync byte
+                    int next = transportStream.IndexOf(SyncByte);
+                    if (next < 0)
+                        return;
+                    transportStream = transportStream[next..];
+                    continue;
+                }
+
+                AddPacket(transportStream[..PacketSize]);
+                transportStream = transportStream[PacketSize..];
+            }
+
+            transportStream.CopyTo(_carry);
+            _carryLength = transportStream.Length;
+        }
+    }
+
+    public ReplaySnapshot? Snapshot(TimeSpan inPoint, TimeSpan outPoint)
+    {
+        lock (_lock)
+        {
+            if (_disposed || _gops.Count == 0 || _pat == null || _pmt == null)
+                return null;
+
+            long inPts = _firstPts + (long)(inPoint.TotalSeconds * PtsClock);
+            long outPts = _firstPts + (long)(outPoint.TotalSeconds * PtsClock);
+
+            // The keyframe at or before the in point must still be buffered
+            int first = _gops.FindLastIndex(g => g.Pts <= inPts);
+            if (first < 0)
+                return null;
+
+            int end = _gops.FindIndex(first + 1, g => g.Pts > outPts);
+            long startOffset = _gops[first].Offset;
+            long endOffset = end >= 0 ? _gops[end].Offset : _writeOffset;
+            long endPts = end >= 0 ? _gops[end].Pts : _newestPts;
+
+            if (endOffset <= startOffset)
+                return null;
+
+            return new ReplayRingSnapshot(this, _pat, _pmt, startOffset, endOffset,
+                ToPosition(_gops[first].Pts), ToPosition(endPts));
+        }
+    }
+
+    // Copy ring bytes at an absolute offset, or return false once the ring has moved past them
+    internal bool TryCopyFromRing(long offset, Span<byte> destination)
+    {
+        lock (_lock)
+        {
+            if (_disposed || offset < _writeOffset - _capacity || offset + destination.Length > _writeOffset)
+                return false;
+
+            CopyFromRing(offset, destination);
+            return true;
+        }
+    }
+
+    private void AddPacket(ReadOnlySpan<byte> packet)
+    {
+        int pid = ((packet[1] & 0x1F) << 8) | packet[2];
+        bool unitStart = (packet[1] & 0x40) != 0;
+        int adaptation = (packet[3] >> 4) & 0x3;
+
+        int payload = 4;
+        bool randomAccess = false;
+        if (adaptation is 2 or 3)
+        {
+            int adaptationLength = packet[4];
+            randomAccess = adaptationLength > 0 && (packet[5] & 0x40) != 0;
+            payload = 5 + adaptationLength;
+        }
+
+        bool hasPayload = adaptation is 1 or 3 && payload < PacketSize;
+
+        if (unitStart && hasPayload)
+        {
+            if (pid == 0)
+            {
+                _pat = packet.ToArray();
+                ParsePat(packet[payload..]);
+            }
+            else if (pid == _pmtPid)
+            {
+                _pmt = packet.ToArray();
+                ParsePmt(packet[payload..]);
+            }
+            else if (pid == _videoPid && TryReadPts(packet[payload..], out long rawPts))
+            {
+                long pts = Unwrap(rawPts);
+                if (_firstPts < 0)
+                    _firstPts = pts;
+                _newestPts = Math.Max(_newestPts, pts);
+
+                if (randomAccess)
+                    _gops.Add(new GopEntry(_writeOffset, pts));
+            }
+        }
+
+        // Nothing before the first keyframe can be cut, so it is not kept
+        if (_gops.Count == 0)
+            return;
+
+        WriteToRing(packet);
+        Evict();
+    }
+
+    private void Evict()
+    {
+        // Overwritten by the ring
+        int drop = 0;
+        while (drop < _gops.Count && _gops[drop].Offset < _writeOffset - _capacity)
+            drop++;
+
+        // Older than the window (keeping the keyframe the window starts in)
+        long windowPts = (long)(Window.TotalSeconds * PtsClock);
+        while (drop + 1 < _gops.Count && _newestPts - _gops[drop + 1].Pts >= windowPts)
+            drop++;
+
+        if (drop > 0)
+            _gops.RemoveRange(0, drop);
+    }
+
+    private void WriteToRing(ReadOnlySpan<byte> packet)
+    {
+        long position = _writeOffset % _capacity;
+        int first = (int)Math.Min(packet.Length, _capacity - position);
+        packet[..first].CopyTo(new Span<byte>(_ring + position, first));
+        if (first < packet.Length)
+            packet[first..].CopyTo(new Span<byte>(_ring, packet.Length - first));
+        _writeOffset += packet.Length;
+    }
+
+    private void CopyFromRing(long offset, Span<byte> destination)
+    {
+        while (destination.Length > 0)
+        {
+            long position = offset % _capacity;
+            int chunk = (int)Math.Min(destination.Length, Math.Min(_capacity - position, int.MaxValue));
+            new ReadOnlySpan<byte>(_ring + position, chunk).CopyTo(destination);
+            destination = destination[chunk..];
+            offset += chunk;
+        }
+    }
+
+    private void ParsePat(ReadOnlySpan<byte> payload)
+    {
+        var section = Section(payload);
+        // Program loop after the 8-byte header, minus the CRC
+        for (int i = 8; i + 4 <= section.Length - 4; i += 4)
+        {
+            int program = (section[i] << 8) | section[i + 1];
+            if (program != 0)
+            {
+                _pmtPid = ((section[i + 2] & 0x1F) << 8) | section[i + 3];
+                return;
+            }
+        }
+    }
+
+    private void ParsePmt(ReadOnlySpan<byte> payload)
+    {
+        var section = Section(payload);
+        if (section.Length < 16)
+            return;
+
+        int programInfoLength = ((section[10] & 0x0F) << 8) | section[11];
+        for (int i = 12 + programInfoLength; i + 5 <= section.Length - 4;)
+        {
+            byte streamType = section[i];
+            int pid = ((section[i + 1] & 0x1F) << 8) | section[i + 2];
+            int infoLength = ((section[i + 3] & 0x0F) << 8) | section[i + 4];
+
+            // MPEG-1/2, H.264, HEVC video
+            if (streamType is 0x01 or 0x02 or 0x1B or 0x24)
+            {
+                _videoPid = pid;
+                return;
+            }
+
+            i += 5 + infoLength;
+        }
+    }
+
+    // PSI section from a unit-start payload, trimmed to section_length
+    private static ReadOnlySpan<byte> Section(ReadOnlySpan<byte> payload)
+    {
+        if (payload.Length < 1 || payload.Length < 1 + payload[0] + 3)
+            return ReadOnlySpan<byte>.Empty;
+
+        var section = payload[(1 + payload[0])..];
+        int length = 3 + (((section[1] & 0x0F) << 8) | section[2]);
+        return section[..Math.Min(length, section.Length)];
+    }
+
+    private static bool TryReadPts(ReadOnlySpan<byte> pes, out long pts)
+    {
+        pts = 0;
+        if (pes.Length < 14 || pes[0] != 0 || pes[1] != 0 || pes[2] != 1 || (pes[7] & 0x80) == 0)
+            return false;
+
+        pts = ((long)(pes[9] >> 1) & 0x07) << 30
+            | (long)pes[10] << 22
+            | (long)(pes[11] >> 1) << 15
+            | (long)pes[12] << 7
+            | (long)(pes[13] >> 1);
+        return true;
+    }
+
+    private long Unwrap(long rawPts)
+    {
+        if (_lastRawPts >= 0 && rawPts < _lastRawPts - PtsWrap / 2)
+            _ptsOffset += PtsWrap;
+        _lastRawPts = rawPts;
+        return rawPts + _ptsOffset;
+    }
+
+    private TimeSpan ToPosition(long pts) =>
+        TimeSpan.FromSeconds((double)(pts - _firstPts) / PtsClock);
+
+    public void Dispose()
+    {
+        lock (_lock)
+        {
+            if (_disposed) return;
+            _disposed = true;
+            _gops.Clear();
+        }
+
+        _view.SafeMemoryMappedViewHandle.ReleasePointer();
+        _view.Dispose();
+        _map.Dispose();
+    }
+
+    private readonly record struct GopEntry(long Offset, long Pts);
+}
+
+// A range of a ReplayBuffer ring, read a chunk at a time under its lock while it is written
+// out (outside the buffer's unsafe context, which cannot await).
+// PAT and PMT arrays are replaced, never modified, when new tables arrive.
+internal sealed class ReplayRingSnapshot : ReplaySnapshot
+{
+    private readonly ReplayBuffer _owner;
+    private readonly byte[] _pat;
+    private readonly byte[] _pmt;
+    private readonly long _startOffset;
+    private readonly long _endOffset;
+
+    public ReplayRingSnapshot(ReplayBuffer owner, byte[] pat, byte[] pmt, long startOffset, long endOffset,
+        TimeSpan start, TimeSpan end)
+        : base(start, end, pat.Length + pmt.Length + (endOffset - startOffset))
+    {
+        _owner = owner;
+        _pat = pat;
+        _pmt = pmt;
+        _startOffset = startOffset;
+        _endOffset = endOffset;
+    }
+
+    public override async Task CopyToAsync(Stream destination, CancellationToken ct = default)
+    {
+        await destination.WriteAsync(_pat, ct);
+        await destination.WriteAsync(_pmt, ct);
+
+        var buffer = ArrayPool<byte>.Shared.Rent(ReplayBuffer.CopyChunkSize);
+        try
+        {
+            for (long offset = _startOffset; offset < _endOffset;)
+            {
+                int chunk = (int)Math.Min(ReplayBuffer.CopyChunkSize, _endOffset - offset);
+                if (!_owner.TryCopyFromRing(offset, buffer.AsSpan(0, chunk)))
+                    throw new IOException("Replay buffer overwrote the snapshot before it was read");
+
+                await destination.WriteAsync(buffer.AsMemory(0, chunk), ct);
+                offset += chunk;
+            }
+        }
+        finally
+        {
+            ArrayPool<byte>.Shared.Return(buffer);
+        }
+    }
+}
@@ -0,0 +1,22 @@
+using System.Collections.Concurrent;
+using Screener.Abstractions.Clipping;
+
+namespace Screener.Core.Buffers;
+
+/// <summary>
+/// Replay buffers of the recordings in progress, by output file path. The recorder registers
+/// one per encoded file; clipping looks them up by a clip's source path.
+/// </summary>
+public sealed class ReplayBufferRegistry
+{
+    private readonly ConcurrentDictionary<string, IReplayBuffer> _buffers = new(StringComparer.OrdinalIgnoreCase);
+
+    public void Register(string recordingPath, IReplayBuffer buffer) =>
+        _buffers[Path.GetFullPath(recordingPath)] = buffer;
+
+    public void Unregister(string recordingPath) =>
+        _buffers.TryRemove(Path.GetFullPath(recordingPath), out _);
+
+    public IReplayBuffer? Find(string recordingPath) =>
+        _buffers.TryGetValue(Path.GetFullPath(recordingPath), out var buffer) ? buffer : null;
+}
@@ -0,0 +1,86 @@
+using Screener.Abstractions.Capture;
+
+namespace Screener.Core.Capture;
+
+/// <summary>
+/// 8-bit UYVY copies of a frame at 1/2, 1/4 and 1/8 size, each level the 2x2 box-filtered
+/// half of the one above. Levels are tightly packed (Width * 2 bytes per row), one after
+/// another; a pyramid built for the 1/4 level also holds the 1/2 level.
+/// </summary>
+public sealed class PreviewPyramid : IPreviewPyramid
+{
+    public const int MaxLevels = 3;
+
+    private readonly ReadOnlyMemory<byte> _data;
+
+    public PreviewPyramid(ReadOnlyMemory<byte> data, int sourceWidth, int sourceHeight, int levels)
+    {
+        if (levels is < 1 or > MaxLevels)
+            throw new ArgumentOutOfRangeException(nameof(levels), levels, $"Levels must be 1 to {MaxLevels}");
+        if (data.Length < BufferSize(sourceWidth, sourceHeight, levels))
+            throw new ArgumentException("Buffer is too small for the pyramid", nameof(data));
+
+        _data = data;
+        SourceWidth = sourceWidth;
+        SourceHeight = sourceHeight;
+        Levels = levels;
+    }
+
+    public int SourceWidth { get; }
+    public int SourceHeight { get; }
+
+    /// <summary>Levels present: 1 = 1/2 only, 3 = down to 1/8.</summary>
+    public int Levels { get; }
+
+    /// <summary>
+    /// The 1/divisor level (2, 4 or 8), or null if it was not built for this frame.
+    /// </summary>
+    public VideoFrame? GetLevel(int divisor)
+    {
+        int level = LevelOf(divisor);
+        if (level > Levels)
+            return null;
+
+        int offset = BufferSize(SourceWidth, SourceHeight, level - 1);
+        var (width, height) = LevelSize(SourceWidth, SourceHeight, level);
+        return new VideoFrame(_data.Slice(offset, width * 2 * height), width, height, width * 2, PixelFormat.UYVY);
+    }
+
+    /// <summary>Pyramid level of a divisor: 2 -> 1, 4 -> 2, 8 -> 3.</summary>
+    public static int LevelOf(int divisor) => divisor switch
+    {
+        2 => 1,
+        4 => 2,
+        8 => 3,
+        _ => throw new ArgumentOutOfRangeException(nameof(divisor), divisor, "Divisor must be 2, 4 or 8")
+    };
+
+    /// <summary>Size of a level; widths are rounded down to whole UYVY pixel pairs.</summary>
+    public static (int Width, int Height) LevelSize(int sourceWidth, int sourceHeight, int level) =>
+        ((sourceWidth >> level) & ~1, sourceHeight >> level);
+
+    /// <summary>Bytes holding the first levels of a pyramid (0 for none).</summary>
+    public static int BufferSize(int sourceWidth, int sourceHeight, int levels)
+    {
+        int size = 0;
+        for (int level = 1; level <= levels; level++)
+        {
+            var (width, height) = LevelSize(sourceWidth, sourceHeight, level);
+            size += width * 2 * height;
+        }
+        return size;
+    }
+
+    /// <summary>
+    /// Whether frames of this format and size can carry the given number of levels.
+    /// 10-bit v210 frames have no pyramid.
+    /// </summary>
+    public static bool Supports(PixelFormat format, int sourceWidth, int sourceHeight, int levels)
+    {
+        if (format is not (PixelFormat.UYVY or PixelFormat.YUV422_8bit) || levels is < 1 or > MaxLevels)
+            return false;
+
+        var (width, height) = LevelSize(sourceWidth, sourceHeight, levels);
+        return width >= 2 && height >= 1;
+    }
+}
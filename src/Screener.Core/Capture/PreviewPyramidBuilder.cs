@@ -0,0 +1,104 @@
+using Screener.Abstractions.Capture;
+using Screener.Core.Native;
+
+namespace Screener.Core.Capture;
+
+/// <summary>
+/// Tracks which preview pyramid levels a capture device's consumers have subscribed to and
+/// builds them from each captured frame with the SIMD half-size box filter, so a 1/4 preview
+/// reads the frame once for every consumer instead of once per consumer.
+/// </summary>
+public sealed class PreviewPyramidBuilder
+{
+    private readonly object _lock = new();
+    private readonly int[] _subscribers = new int[PreviewPyramid.MaxLevels];
+    private volatile int _levels;
+
+    /// <summary>Deepest level subscribed to (0 = none): each level is halved from the one above.</summary>
+    public int Levels => _levels;
+
+    /// <summary>
+    /// Build the 1/divisor level (2, 4 or 8) until the result is disposed.
+    /// </summary>
+    public IDisposable Subscribe(int divisor)
+    {
+        int level = PreviewPyramid.LevelOf(divisor);
+        lock (_lock)
+        {
+            _subscribers[level - 1]++;
+            UpdateLevels();
+        }
+        return new Subscription(this, level);
+    }
+
+    /// <summary>
+    /// Bytes a frame of this format and size needs for the given levels, 0 if it gets no pyramid
+    /// (no levels subscribed, v210, or too small).
+    /// </summary>
+    public static int BufferSize(PixelFormat format, int width, int height, int levels) =>
+        levels > 0 && PreviewPyramid.Supports(format, width, height, levels)
+            ? PreviewPyramid.BufferSize(width, height, levels)
+            : 0;
+
+    /// <summary>
+    /// Halve an 8-bit UYVY frame into dst once per level, each level from the one before.
+    /// dst must hold <see cref="PreviewPyramid.BufferSize"/> bytes for the levels.
+    /// </summary>
+    public static PreviewPyramid Build(ReadOnlySpan<byte> frame, int rowBytes, int width, int height, byte[] dst, int levels)
+    {
+        if (levels is < 1 or > PreviewPyramid.MaxLevels)
+            throw new ArgumentOutOfRangeException(nameof(levels), levels, $"Levels must be 1 to {PreviewPyramid.MaxLevels}");
+
+        ReadOnlySpan<byte> src = frame;
+        int srcPitch = rowBytes;
+        int offset = 0;
+        for (int level = 1; level <= levels; level++)
+        {
+            var (levelWidth, levelHeight) = PreviewPyramid.LevelSize(width, height, level);
+            int levelPitch = levelWidth * 2;
+            var levelData = dst.AsSpan(offset, levelPitch * levelHeight);
+
+            MediaKernels.DownscaleUyvyHalf(src, srcPitch, levelData, levelPitch, levelWidth, levelHeight);
+
+            src = levelData;
+            srcPitch = levelPitch;
+            offset += levelData.Length;
+        }
+
+        return new PreviewPyramid(dst.AsMemory(0, offset), width, height, levels);
+    }
+
+    private void UpdateLevels()
+    {
+        int levels = 0;
+        for (int i = 0; i < _subscribers.Length; i++)
+        {
+            if (_subscribers[i] > 0)
+                levels = i + 1;
+        }
+        _levels = levels;
+    }
+
+    private void Unsubscribe(int level)
+    {
+        lock (_lock)
+        {
+            _subscribers[level - 1]--;
+            UpdateLevels();
+        }
+    }
+
+    private sealed class Subscription : IDisposable
+    {
+        private PreviewPyramidBuilder? _owner;
+        private readonly int _level;
+
+        public Subscription(PreviewPyramidBuilder owner, int level)
+        {
+            _owner = owner;
+            _level = level;
+        }
+
+        public void Dispose() => Interlocked.Exchange(ref _owner, null)?.Unsubscribe(_level);
+    }
+}
@@ -0,0 +1,60 @@
+using System.Buffers.Binary;
+
+namespace Screener.Core.Native;
+
+/// <summary>
+/// Managed fallback for the native MeasureAudioLevels kernel, used when
+/// Screener.Capture.Blackmagic.Native.dll is not available or the layout has more channels
+/// than the kernel takes. Windows are rounded the same way, so the scores match.
+/// </summary>
+internal static class AudioLevels
+{
+    public static void Measure(ReadOnlySpan<byte> samples, int channels, int bitsPerSample, int windowFrames,
+        Span<float> rms, Span<float> peak, Span<float> onset)
+    {
+        int bytesPerSample = bitsPerSample / 8;
+        int frames = samples.Length / (channels * bytesPerSample);
+        int runFrames = 8 / Gcd(channels, 8);
+        int window = (windowFrames + runFrames - 1) / runFrames * runFrames;
+        double fullScale = bitsPerSample == 16 ? 32768.0 : 2147483648.0;
+
+        for (int c = 0; c < channels; c++)
+        {
+            double total = 0, windowMax = 0, rawPeak = 0;
+
+            for (int start = 0; start < frames; start += window)
+            {
+                int count = Math.Min(window, frames - start);
+                double windowSum = 0;
+
+                for (int f = start; f < start + count; f++)
+                {
+                    int offset = (f * channels + c) * bytesPerSample;
+                    double v = bitsPerSample == 16
+                        ? BinaryPrimitives.ReadInt16LittleEndian(samples.Slice(offset))
+                        : BinaryPrimitives.ReadInt32LittleEndian(samples.Slice(offset));
+                    windowSum += v * v;
+                    rawPeak = Math.Max(rawPeak, Math.Abs(v));
+                }
+
+                total += windowSum;
+                windowMax = Math.Max(windowMax, windowSum / count);
+            }
+
+            double mean = frames > 0 ? total / frames : 0.0;
+            if (!rms.IsEmpty)
+                rms[c] = (float)(Math.Sqrt(mean) / fullScale);
+            if (!peak.IsEmpty)
+                peak[c] = (float)(rawPeak / fullScale);
+            if (!onset.IsEmpty)
+                onset[c] = mean > 0 ? (float)(windowMax / mean) : 0f;
+        }
+    }
+
+    private static int Gcd(int a, int b)
+    {
+        while (b != 0)
+            (a, b) = (b, a % b);
+        return a;
+    }
+}
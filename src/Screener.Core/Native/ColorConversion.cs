@@ -0,0 +1,258 @@
+namespace Screener.Core.Native;
+
+/// <summary>
+/// Managed fallback for the native colour converters, used when
+/// Screener.Capture.Blackmagic.Native.dll is not available. Produces the same output.
+/// </summary>
+internal static class ColorConversion
+{
+    private readonly record struct Coefficients(
+        int Y, int Rv, int Gu, int Gv, int Bu,
+        int Yr, int Yg, int Yb, int Ur, int Ug, int Ub, int Vr, int Vg, int Vb);
+
+    private static readonly Coefficients Bt601 = new(298, 409, -100, -208, 516, 66, 129, 25, -38, -74, 112, 112, -94, -18);
+    private static readonly Coefficients Bt709 = new(298, 459, -55, -136, 541, 47, 157, 16, -26, -87, 112, 112, -102, -10);
+
+    private static Coefficients For(ColorMatrix matrix) => matrix == ColorMatrix.Bt709 ? Bt709 : Bt601;
+
+    private static byte Clamp(int v) => (byte)(v < 0 ? 0 : v > 255 ? 255 : v);
+
+    private static void UyvyToBgraRow(ReadOnlySpan<byte> src, Span<byte> dst, int width, in Coefficients c)
+    {
+        for (int x = 0, s = 0, d = 0; x + 1 < width; x += 2, s += 4, d += 8)
+        {
+            int u = src[s] - 128;
+            int y0 = src[s + 1] - 16;
+            int v = src[s + 2] - 128;
+            int y1 = src[s + 3] - 16;
+
+            int c0 = y0 < 0 ? 0 : c.Y * y0;
+            int c1 = y1 < 0 ? 0 : c.Y * y1;
+            int r = c.Rv * v + 128;
+            int g = c.Gu * u + c.Gv * v + 128;
+            int b = c.Bu * u + 128;
+
+            dst[d] = Clamp((c0 + b) >> 8);
+            dst[d + 1] = Clamp((c0 + g) >> 8);
+            dst[d + 2] = Clamp((c0 + r) >> 8);
+            dst[d + 3] = 255;
+            dst[d + 4] = Clamp((c1 + b) >> 8);
+            dst[d + 5] = Clamp((c1 + g) >> 8);
+            dst[d + 6] = Clamp((c1 + r) >> 8);
+            dst[d + 7] = 255;
+        }
+    }
+
+    public static void UyvyToBgra(ReadOnlySpan<byte> src, int srcPitch, Span<byte> dst, int dstPitch,
+        int width, int height, ColorMatrix matrix)
+    {
+        var c = For(matrix);
+        for (int y = 0; y < height; y++)
+            UyvyToBgraRow(src[(y * srcPitch)..], dst[(y * dstPitch)..], width, c);
+    }
+
+    public static void UyvyToBgraScaled(ReadOnlySpan<byte> src, int srcPitch, Span<byte> dst, int dstPitch,
+        int dstWidth, int dstHeight, int divisor, ColorMatrix matrix)
+    {
+        var c = For(matrix);
+        for (int y = 0; y < dstHeight; y++)
+            UyvyToBgraScaledRow(src[(y * divisor * srcPitch)..], dst[(y * dstPitch)..], dstWidth, divisor, c);
+    }
+
+    private static void UyvyToBgraScaledRow(ReadOnlySpan<byte> srcRow, Span<byte> dstRow,
+        int dstWidth, int divisor, in Coefficients c)
+    {
+        int half = divisor / 2;
+        Span<byte> decimated = stackalloc byte[4];
+
+        // Nearest sample: U/Y0/V from the first group of each pair, Y1 from the group at divisor/2
+        for (int p = 0; p < dstWidth / 2; p++)
+        {
+            int g0 = p * divisor * 4;
+            int g1 = (p * divisor + half) * 4;
+            decimated[0] = srcRow[g0];
+            decimated[1] = srcRow[g0 + 1];
+            decimated[2] = srcRow[g0 + 2];
+            decimated[3] = srcRow[g1 + 1];
+            UyvyToBgraRow(decimated, dstRow[(p * 8)..], 2, c);
+        }
+    }
+
+    public static void BgraToUyvy(ReadOnlySpan<byte> src, int srcPitch, Span<byte> dst, int dstPitch,
+        int width, int height, ColorMatrix matrix)
+    {
+        var c = For(matrix);
+        for (int y = 0; y < height; y++)
+        {
+            var s = src[(y * srcPitch)..];
+            var d = dst[(y * dstPitch)..];
+
+            for (int x = 0; x + 1 < width; x += 2)
+            {
+                int b0 = s[x * 4], g0 = s[x * 4 + 1], r0 = s[x * 4 + 2];
+                int b1 = s[x * 4 + 4], g1 = s[x * 4 + 5], r1 = s[x * 4 + 6];
+
+                int y0 = ((c.Yr * r0 + c.Yg * g0 + c.Yb * b0 + 128) >> 8) + 16;
+                int y1 = ((c.Yr * r1 + c.Yg * g1 + c.Yb * b1 + 128) >> 8) + 16;
+
+                int r = (r0 + r1) >> 1;
+                int g = (g0 + g1) >> 1;
+                int b = (b0 + b1) >> 1;
+
+                d[x * 2] = Clamp(((c.Ur * r + c.Ug * g + c.Ub * b + 128) >> 8) + 128);
+                d[x * 2 + 1] = Clamp(y0);
+                d[x * 2 + 2] = Clamp(((c.Vr * r + c.Vg * g + c.Vb * b + 128) >> 8) + 128);
+                d[x * 2 + 3] = Clamp(y1);
+            }
+        }
+    }
+
+    public static void UyvyToNv12(ReadOnlySpan<byte> src, int srcPitch, Span<byte> dstY, Span<byte> dstUV,
+        int width, int height)
+    {
+        for (int y = 0; y < height; y += 2)
+        {
+            var a = src[(y * srcPitch)..];
+            bool hasB = y + 1 < height;
+            var b = hasB ? src[((y + 1) * srcPitch)..] : a;
+            var uv = dstUV[(y / 2 * width)..];
+
+            for (int x = 0; x + 1 < width; x += 2)
+            {
+                dstY[y * width + x] = a[x * 2 + 1];
+                dstY[y * width + x + 1] = a[x * 2 + 3];
+
+                if (hasB)
+                {
+                    dstY[(y + 1) * width + x] = b[x * 2 + 1];
+                    dstY[(y + 1) * width + x + 1] = b[x * 2 + 3];
+                    uv[x] = (byte)((a[x * 2] + b[x * 2] + 1) >> 1);
+                    uv[x + 1] = (byte)((a[x * 2 + 2] + b[x * 2 + 2] + 1) >> 1);
+                }
+                else
+                {
+                    uv[x] = a[x * 2];
+                    uv[x + 1] = a[x * 2 + 2];
+                }
+            }
+        }
+    }
+
+    // Same rounding as the native kernel: rows averaged first, then horizontal neighbours
+    public static void UyvyHalf(ReadOnlySpan<byte> src, int srcPitch, Span<byte> dst, int dstPitch,
+        int dstWidth, int dstHeight)
+    {
+        Span<int> v = stackalloc int[8];
+        for (int y = 0; y < dstHeight; y++)
+        {
+            var a = src[(y * 2 * srcPitch)..];
+            var b = src[((y * 2 + 1) * srcPitch)..];
+            var d = dst[(y * dstPitch)..];
+
+            for (int p = 0; p < dstWidth / 2; p++)
+            {
+                int s = p * 8;
+                for (int i = 0; i < 8; i++)
+                    v[i] = (a[s + i] + b[s + i] + 1) >> 1;
+
+                d[p * 4] = (byte)((v[0] + v[4] + 1) >> 1);
+                d[p * 4 + 1] = (byte)((v[1] + v[3] + 1) >> 1);
+                d[p * 4 + 2] = (byte)((v[2] + v[6] + 1) >> 1);
+                d[p * 4 + 3] = (byte)((v[5] + v[7] + 1) >> 1);
+            }
+        }
+    }
+
+    /// <summary>
+    /// Unpack one v210 row into 10-bit samples in U Y V Y order.
+    /// </summary>
+    private static void UnpackV210Row(ReadOnlySpan<byte> src, Span<ushort> samples, int width)
+    {
+        int blocks = (width + 5) / 6;
+        for (int i = 0; i < blocks; i++)
+        {
+            for (int w = 0; w < 4; w++)
+            {
+                int o = i * 16 + w * 4;
+                uint word = (uint)(src[o] | src[o + 1] << 8 | src[o + 2] << 16 | src[o + 3] << 24);
+                samples[i * 12 + w * 3] = (ushort)(word & 0x3FF);
+                samples[i * 12 + w * 3 + 1] = (ushort)((word >> 10) & 0x3FF);
+                samples[i * 12 + w * 3 + 2] = (ushort)((word >> 20) & 0x3FF);
+            }
+        }
+    }
+
+    public static void V210ToBgra(ReadOnlySpan<byte> src, int srcPitch, Span<byte> dst, int dstPitch,
+        int width, int height, ColorMatrix matrix)
+    {
+        var c = For(matrix);
+        var samples = new ushort[(width + 5) / 6 * 12];
+        var uyvy = new byte[width * 2];
+
+        for (int y = 0; y < height; y++)
+        {
+            UnpackV210Row(src[(y * srcPitch)..], samples, width);
+            for (int i = 0; i < uyvy.Length; i++)
+                uyvy[i] = (byte)Math.Min(255, (samples[i] + 2) >> 2);
+            UyvyToBgraRow(uyvy, dst[(y * dstPitch)..], width, c);
+        }
+    }
+
+    public static void V210ToBgraScaled(ReadOnlySpan<byte> src, int srcPitch, Span<byte> dst, int dstPitch,
+        int dstWidth, int dstHeight, int divisor, ColorMatrix matrix)
+    {
+        var c = For(matrix);
+        int srcWidth = dstWidth * divisor;
+        var samples = new ushort[(srcWidth + 5) / 6 * 12];
+        var uyvy = new byte[srcWidth * 2];
+
+        for (int y = 0; y < dstHeight; y++)
+        {
+            UnpackV210Row(src[(y * divisor * srcPitch)..], samples, srcWidth);
+            for (int i = 0; i < uyvy.Length; i++)
+                uyvy[i] = (byte)Math.Min(255, (samples[i] + 2) >> 2);
+            UyvyToBgraScaledRow(uyvy, dst[(y * dstPitch)..], dstWidth, divisor, c);
+        }
+    }
+
+    public static void V210ToP010(ReadOnlySpan<byte> src, int srcPitch, Span<byte> dstY, Span<byte> dstUV,
+        int width, int height)
+    {
+        var a = new ushort[(width + 5) / 6 * 12];
+        var b = new ushort[a.Length];
+
+        static void Write(Span<byte> plane, int index, int value)
+        {
+            ushort v = (ushort)(value << 6);
+            plane[index * 2] = (byte)v;
+            plane[index * 2 + 1] = (byte)(v >> 8);
+        }
+
+        for (int y = 0; y < height; y += 2)
+        {
+            bool hasB = y + 1 < height;
+            UnpackV210Row(src[(y * srcPitch)..], a, width);
+            if (hasB)
+                UnpackV210Row(src[((y + 1) * srcPitch)..], b, width);
+
+            for (int x = 0; x + 1 < width; x += 2)
+            {
+                Write(dstY, y * width + x, a[x * 2 + 1]);
+                Write(dstY, y * width + x + 1, a[x * 2 + 3]);
+
+                if (hasB)
+                {
+                    Write(dstY, (y + 1) * width + x, b[x * 2 + 1]);
+                    Write(dstY, (y + 1) * width + x + 1, b[x * 2 + 3]);
+                    Write(dstUV, y / 2 * width + x, (a[x * 2] + b[x * 2] + 1) >> 1);
+                    Write(dstUV, y / 2 * width + x + 1, (a[x * 2 + 2] + b[x * 2 + 2] + 1) >> 1);
+                }
+                else
+                {
+                    Write(dstUV, y / 2 * width + x, a[x * 2]);
+                    Write(dstUV, y / 2 * width + x + 1, a[x * 2 + 2]);
+                }
+            }
+        }
+    }
+}
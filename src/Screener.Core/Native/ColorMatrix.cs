@@ -0,0 +1,22 @@
+namespace Screener.Core.Native;
+
+/// <summary>
+/// YUV/RGB matrix used by the colour converters in <see cref="MediaKernels"/>.
+/// Values match the native ColorMatrix enum.
+/// </summary>
+public enum ColorMatrix
+{
+    /// <summary>SD (ITU-R BT.601), studio range.</summary>
+    Bt601 = 0,
+
+    /// <summary>HD and UHD (ITU-R BT.709), studio range.</summary>
+    Bt709 = 1
+}
+
+public static class ColorMatrixExtensions
+{
+    /// <summary>
+    /// The conventional matrix for a frame height: BT.709 for HD and above, BT.601 for SD.
+    /// </summary>
+    public static ColorMatrix ForHeight(int height) => height >= 720 ? ColorMatrix.Bt709 : ColorMatrix.Bt601;
+}
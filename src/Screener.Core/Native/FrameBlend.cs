@@ -0,0 +1,97 @@
+using System.Runtime.Intrinsics;
+
+namespace Screener.Core.Native;
+
+/// <summary>
+/// Managed fallback for the native transition blend and overlay kernels, used when
+/// Screener.Capture.Blackmagic.Native.dll is not available. Produces the same output:
+/// dst = (x * (256 - w) + y * w) >> 8 per byte.
+/// </summary>
+internal static class FrameBlend
+{
+    public static void Blend(ReadOnlySpan<byte> a, ReadOnlySpan<byte> b, Span<byte> dst, int weight)
+    {
+        int wx = 256 - weight;
+        int i = 0;
+
+        if (Vector256.IsHardwareAccelerated)
+        {
+            var vwx = Vector256.Create((ushort)wx);
+            var vwy = Vector256.Create((ushort)weight);
+            for (; i + Vector256<byte>.Count <= dst.Length; i += Vector256<byte>.Count)
+            {
+                var vx = Vector256.Create(a.Slice(i, Vector256<byte>.Count));
+                var vy = Vector256.Create(b.Slice(i, Vector256<byte>.Count));
+                BlendVector(vx, vy, vwx, vwy).CopyTo(dst.Slice(i));
+            }
+        }
+
+        for (; i < dst.Length; i++)
+            dst[i] = (byte)((a[i] * wx + b[i] * weight) >> 8);
+    }
+
+    public static void Fade(ReadOnlySpan<byte> src, Span<byte> dst, int weight, uint black)
+    {
+        int wy = 256 - weight;
+        int i = 0;
+
+        if (Vector256.IsHardwareAccelerated)
+        {
+            var vwx = Vector256.Create((ushort)weight);
+            var vwy = Vector256.Create((ushort)wy);
+            var vblack = Vector256.Create(black).AsByte();
+            for (; i + Vector256<byte>.Count <= dst.Length; i += Vector256<byte>.Count)
+            {
+                var vx = Vector256.Create(src.Slice(i, Vector256<byte>.Count));
+                BlendVector(vx, vblack, vwx, vwy).CopyTo(dst.Slice(i));
+            }
+        }
+
+        for (; i < dst.Length; i++)
+            dst[i] = (byte)((src[i] * weight + (int)((black >> (8 * (i & 3))) & 0xFF) * wy) >> 8);
+    }
+
+    public static void Composite(Span<byte> frame, int framePitch, ReadOnlySpan<byte> color,
+        ReadOnlySpan<byte> inverseAlpha, int layerPitch, int rowBytes, int rows)
+    {
+        for (int y = 0; y < rows; y++)
+        {
+            var dst = frame.Slice(y * framePitch, rowBytes);
+            var c = color.Slice(y * layerPitch, rowBytes);
+            var ia = inverseAlpha.Slice(y * layerPitch, rowBytes);
+            int i = 0;
+
+            if (Vector256.IsHardwareAccelerated)
+            {
+                for (; i + Vector256<byte>.Count <= rowBytes; i += Vector256<byte>.Count)
+                {
+                    var (xLo, xHi) = Vector256.Widen(Vector256.Create<byte>(dst.Slice(i, Vector256<byte>.Count)));
+                    var (aLo, aHi) = Vector256.Widen(Vector256.Create(ia.Slice(i, Vector256<byte>.Count)));
+                    aLo += Vector256.ShiftRightLogical(aLo, 7);
+                    aHi += Vector256.ShiftRightLogical(aHi, 7);
+
+                    // Saturating add (rounding can push a premultiplied sum past 255): a wrapped sum is below kept
+                    var kept = Vector256.Narrow(Vector256.ShiftRightLogical(xLo * aLo, 8), Vector256.ShiftRightLogical(xHi * aHi, 8));
+                    var vc = Vector256.Create(c.Slice(i, Vector256<byte>.Count));
+                    var sum = kept + vc;
+                    Vector256.ConditionalSelect(Vector256.LessThan(sum, kept), Vector256<byte>.AllBitsSet, sum).CopyTo(dst.Slice(i));
+                }
+            }
+
+            for (; i < rowBytes; i++)
+            {
+                int v = ((dst[i] * (ia[i] + (ia[i] >> 7))) >> 8) + c[i];
+                dst[i] = (byte)Math.Min(v, 255);
+            }
+        }
+    }
+
+    private static Vector256<byte> BlendVector(Vector256<byte> x, Vector256<byte> y, Vector256<ushort> wx, Vector256<ushort> wy)
+    {
+        var (xLo, xHi) = Vector256.Widen(x);
+        var (yLo, yHi) = Vector256.Widen(y);
+        var lo = Vector256.ShiftRightLogical(xLo * wx + yLo * wy, 8);
+        var hi = Vector256.ShiftRightLogical(xHi * wx + yHi * wy, 8);
+        return Vector256.Narrow(lo, hi);
+    }
+}
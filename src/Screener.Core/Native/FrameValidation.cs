@@ -0,0 +1,65 @@
+namespace Screener.Core.Native;
+
+/// <summary>
+/// Managed fallback for the native frame validation kernels, used when
+/// Screener.Capture.Blackmagic.Native.dll is not available. Produces the same result.
+/// </summary>
+internal static class FrameValidation
+{
+    private const int Samples = 2048;
+
+    public static bool LooksLikeCorruptBgra(ReadOnlySpan<byte> p, int width, int height, int rowBytes)
+    {
+        if (width < 4 || height <= 0 || rowBytes < width * 2 || (long)rowBytes * height > p.Length)
+            return false;
+
+        Span<int> countFF = stackalloc int[4];
+        Span<long> sum = stackalloc long[4];
+        Span<long> sumSquares = stackalloc long[4];
+
+        // Rows spread with stride 131, columns with stride 337 (aligned to 4 bytes)
+        int xRange = width * 2 - 4;
+        int y = 0, x = 0;
+
+        for (int i = 0; i < Samples; i++)
+        {
+            int offset = y * rowBytes + (x & ~3);
+            for (int lane = 0; lane < 4; lane++)
+            {
+                int v = p[offset + lane];
+                if (v == 0xFF) countFF[lane]++;
+                sum[lane] += v;
+                sumSquares[lane] += v * v;
+            }
+
+            y += 131;
+            while (y >= height) y -= height;
+            x += 337;
+            while (x >= xRange) x -= xRange;
+        }
+
+        const double n = Samples;
+        double p0 = countFF[0] / n, p1 = countFF[1] / n, p2 = countFF[2] / n, p3 = countFF[3] / n;
+        double alphaBias = p3 - Math.Max(Math.Max(p0, p1), p2);
+
+        static double Variance(long sum, long sumSquares)
+        {
+            double mean = sum / n;
+            return (sumSquares - n * mean * mean) / (n - 1);
+        }
+
+        double var0 = Variance(sum[0], sumSquares[0]);
+        double var1 = Variance(sum[1], sumSquares[1]);
+        double var2 = Variance(sum[2], sumSquares[2]);
+        double var3 = Variance(sum[3], sumSquares[3]);
+        double varY = var1 + var3;
+        double varUV = var0 + var2;
+
+        // In BGRA, byte 3 (alpha) is typically 0xFF with low variance
+        // In UYVY, all bytes have similar variance patterns
+        bool suspiciousAlpha = (p3 > 0.20 && alphaBias > 0.10) || (p3 > 0.35);
+        bool suspiciousVariance = (var3 < 50.0 && p3 > 0.10) || (varY < varUV * 0.8);
+
+        return suspiciousAlpha || suspiciousVariance;
+    }
+}
@@ -0,0 +1,521 @@
+using System.Runtime.CompilerServices;
+using System.Runtime.InteropServices;
+
+namespace Screener.Core.Native;
+
+/// <summary>
+/// Managed entry points for the SIMD media kernels in Screener.Capture.Blackmagic.Native.dll.
+/// The kernels work on plain frame buffers, so any input path (DeckLink, NDI, SRT) can use them.
+/// When the native DLL is not deployed, <see cref="IsAvailable"/> is false and callers fall back
+/// to their managed implementations.
+/// </summary>
+public static class MediaKernels
+{
+    private const string NativeDll = "Screener.Capture.Blackmagic.Native.dll";
+
+    private static readonly Lazy<int> _simdLevel = new(ProbeSimdLevel);
+
+    /// <summary>
+    /// True if the native kernel DLL could be loaded.
+    /// </summary>
+    public static bool IsAvailable => _simdLevel.Value >= 0;
+
+    /// <summary>
+    /// SIMD level the native kernels dispatch to (0=scalar, 1=SSE4.1, 2=AVX2, 3=AVX-512), or -1 if unavailable.
+    /// </summary>
+    public static int SimdLevel => _simdLevel.Value;
+
+    [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl, EntryPoint = "GetMediaKernelLevel")]
+    private static extern int NativeGetMediaKernelLevel();
+
+    [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl, EntryPoint = "DetectCorruptBGRA")]
+    private static extern int NativeDetectCorruptBGRA(ref byte buffer, int bufferSize, int width, int height, int rowBytes);
+
+    [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl, EntryPoint = "DetectCorruptBGRA")]
+    private static extern int NativeDetectCorruptBGRA(IntPtr buffer, int bufferSize, int width, int height, int rowBytes);
+
+    [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl, EntryPoint = "ConvertUYVYToBGRA")]
+    private static extern int NativeConvertUyvyToBgra(ref byte src, int srcPitch, ref byte dst, int dstPitch, int width, int height, int matrix);
+
+    [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl, EntryPoint = "ConvertUYVYToBGRAScaled")]
+    private static extern int NativeConvertUyvyToBgraScaled(ref byte src, int srcPitch, ref byte dst, int dstPitch, int dstWidth, int dstHeight, int divisor, int matrix);
+
+    [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl, EntryPoint = "ConvertBGRAToUYVY")]
+    private static extern int NativeConvertBgraToUyvy(ref byte src, int srcPitch, ref byte dst, int dstPitch, int width, int height, int matrix);
+
+    [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl, EntryPoint = "ConvertUYVYToNV12")]
+    private static extern int NativeConvertUyvyToNv12(ref byte src, int srcPitch, ref byte dstY, int dstYPitch, ref byte dstUV, int dstUVPitch, int width, int height);
+
+    [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl, EntryPoint = "DownscaleUYVYHalf")]
+    private static extern int NativeDownscaleUyvyHalf(ref byte src, int srcPitch, ref byte dst, int dstPitch, int dstWidth, int dstHeight);
+
+    [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl, EntryPoint = "ConvertV210ToBGRA")]
+    private static extern int NativeConvertV210ToBgra(ref byte src, int srcPitch, ref byte dst, int dstPitch, int width, int height, int matrix);
+
+    [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl, EntryPoint = "ConvertV210ToBGRAScaled")]
+    private static extern int NativeConvertV210ToBgraScaled(ref byte src, int srcPitch, ref byte dst, int dstPitch, int dstWidth, int dstHeight, int divisor, int matrix);
+
+    [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl, EntryPoint = "ConvertV210ToP010")]
+    private static extern int NativeConvertV210ToP010(ref byte src, int srcPitch, ref byte dstY, int dstYPitch, ref byte dstUV, int dstUVPitch, int width, int height);
+
+    [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl, EntryPoint = "ExtractLumaSad")]
+    private static extern int NativeExtractLumaSad(ref byte src, int srcBufferSize, int srcPitch, int srcWidth, int srcHeight, int format,
+        ref byte dstLuma, int dstWidth, int dstHeight, ref byte reference, int roiLeft, int roiTop, int roiRight, int roiBottom, out long sad);
+
+    [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl, EntryPoint = "ComputeLumaSad")]
+    private static extern int NativeComputeLumaSad(ref byte a, ref byte b, int width, int height,
+        int roiLeft, int roiTop, int roiRight, int roiBottom, out long sad);
+
+    [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl, EntryPoint = "BlendFrames")]
+    private static extern int NativeBlendFrames(ref byte a, ref byte b, ref byte dst, int length, int weight);
+
+    [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl, EntryPoint = "FadeFrame")]
+    private static extern int NativeFadeFrame(ref byte src, ref byte dst, int length, int weight, uint black);
+
+    [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl, EntryPoint = "CompositeLayer")]
+    private static extern int NativeCompositeLayer(ref byte frame, int framePitch, ref byte color, ref byte inverseAlpha,
+        int layerPitch, int rowBytes, int rows);
+
+    [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl, EntryPoint = "MeasureAudioLevels")]
+    private static extern int NativeMeasureAudioLevels(ref byte samples, int length, int channels, int bitsPerSample,
+        int windowFrames, ref float rms, ref float peak, ref float onset);
+
+    private static int ProbeSimdLevel()
+    {
+        try
+        {
+            return NativeGetMediaKernelLevel();
+        }
+        catch (DllNotFoundException)
+        {
+            return -1;
+        }
+        catch (EntryPointNotFoundException)
+        {
+            return -1;
+        }
+        catch (BadImageFormatException)
+        {
+            return -1;
+        }
+    }
+
+    /// <summary>
+    /// Check whether a buffer that should contain 8-bit UYVY actually looks like BGRA
+    /// (e.g. a DMA pointer that landed on the wrong buffer). Samples 2048 pixel groups.
+    /// </summary>
+    /// <returns>True if the data looks like BGRA rather than UYVY; false if it looks valid
+    /// or the geometry doesn't fit the buffer.</returns>
+    public static bool LooksLikeCorruptBgra(ReadOnlySpan<byte> frame, int width, int height, int rowBytes)
+    {
+        if (!IsAvailable)
+            return FrameValidation.LooksLikeCorruptBgra(frame, width, height, rowBytes);
+
+        if (frame.IsEmpty)
+            return false;
+
+        return NativeDetectCorruptBGRA(
+            ref MemoryMarshal.GetReference(frame), frame.Length, width, height, rowBytes) == 1;
+    }
+
+    /// <summary>
+    /// Same as <see cref="LooksLikeCorruptBgra(ReadOnlySpan{byte}, int, int, int)"/> for frames that are
+    /// still in native memory (e.g. an NDI receive buffer), avoiding a copy before the check.
+    /// </summary>
+    public static unsafe bool LooksLikeCorruptBgra(IntPtr frame, int frameSize, int width, int height, int rowBytes)
+    {
+        if (frame == IntPtr.Zero || frameSize <= 0)
+            return false;
+
+        if (!IsAvailable)
+            return FrameValidation.LooksLikeCorruptBgra(
+                new ReadOnlySpan<byte>((void*)frame, frameSize), width, height, rowBytes);
+
+        return NativeDetectCorruptBGRA(frame, frameSize, width, height, rowBytes) == 1;
+    }
+
+    /// <summary>
+    /// Convert UYVY (8-bit 4:2:2) to BGRA.
+    /// </summary>
+    public static void ConvertUyvyToBgra(ReadOnlySpan<byte> src, int srcPitch, Span<byte> dst, int dstPitch,
+        int width, int height, ColorMatrix matrix)
+    {
+        CheckWidth(width);
+        CheckPlane(src.Length, srcPitch, width * 2, height, nameof(src));
+        CheckPlane(dst.Length, dstPitch, width * 4, height, nameof(dst));
+
+        if (!IsAvailable)
+        {
+            ColorConversion.UyvyToBgra(src, srcPitch, dst, dstPitch, width, height, matrix);
+            return;
+        }
+
+        NativeConvertUyvyToBgra(ref MemoryMarshal.GetReference(src), srcPitch,
+            ref MemoryMarshal.GetReference(dst), dstPitch, width, height, (int)matrix);
+    }
+
+    /// <summary>
+    /// Convert UYVY to BGRA at 1/divisor resolution (divisor 2 or 4) using nearest-sample
+    /// decimation. Source rows are read every divisor rows.
+    /// </summary>
+    public static void ConvertUyvyToBgraScaled(ReadOnlySpan<byte> src, int srcPitch, Span<byte> dst, int dstPitch,
+        int dstWidth, int dstHeight, int divisor, ColorMatrix matrix)
+    {
+        if (divisor is not (2 or 4))
+            throw new ArgumentOutOfRangeException(nameof(divisor), divisor, "Divisor must be 2 or 4");
+        CheckWidth(dstWidth);
+        if (dstHeight <= 0 || srcPitch < dstWidth * 2 * divisor ||
+            (long)srcPitch * divisor * (dstHeight - 1) + dstWidth * 2 * divisor > src.Length)
+            throw new ArgumentException("Source is too small for the scaled output size", nameof(src));
+        CheckPlane(dst.Length, dstPitch, dstWidth * 4, dstHeight, nameof(dst));
+
+        if (!IsAvailable)
+        {
+            ColorConversion.UyvyToBgraScaled(src, srcPitch, dst, dstPitch, dstWidth, dstHeight, divisor, matrix);
+            return;
+        }
+
+        NativeConvertUyvyToBgraScaled(ref MemoryMarshal.GetReference(src), srcPitch,
+            ref MemoryMarshal.GetReference(dst), dstPitch, dstWidth, dstHeight, divisor, (int)matrix);
+    }
+
+    /// <summary>
+    /// Convert BGRA to UYVY, taking chroma from the average of each pixel pair.
+    /// </summary>
+    public static void ConvertBgraToUyvy(ReadOnlySpan<byte> src, int srcPitch, Span<byte> dst, int dstPitch,
+        int width, int height, ColorMatrix matrix)
+    {
+        CheckWidth(width);
+        CheckPlane(src.Length, srcPitch, width * 4, height, nameof(src));
+        CheckPlane(dst.Length, dstPitch, width * 2, height, nameof(dst));
+
+        if (!IsAvailable)
+        {
+            ColorConversion.BgraToUyvy(src, srcPitch, dst, dstPitch, width, height, matrix);
+            return;
+        }
+
+        NativeConvertBgraToUyvy(ref MemoryMarshal.GetReference(src), srcPitch,
+            ref MemoryMarshal.GetReference(dst), dstPitch, width, height, (int)matrix);
+    }
+
+    /// <summary>
+    /// Convert UYVY to tightly packed NV12 (Y plane followed by the interleaved UV plane),
+    /// averaging chroma over row pairs. dst must hold <see cref="Nv12FrameSize"/> bytes.
+    /// </summary>
+    public static void ConvertUyvyToNv12(ReadOnlySpan<byte> src, int srcPitch, Span<byte> dst, int width, int height)
+    {
+        CheckWidth(width);
+        CheckPlane(src.Length, srcPitch, width * 2, height, nameof(src));
+        if (dst.Length < Nv12FrameSize(width, height))
+            throw new ArgumentException("Destination is too small for an NV12 frame", nameof(dst));
+
+        var dstY = dst[..(width * height)];
+        var dstUV = dst[(width * height)..];
+
+        if (!IsAvailable)
+        {
+            ColorConversion.UyvyToNv12(src, srcPitch, dstY, dstUV, width, height);
+            return;
+        }
+
+        NativeConvertUyvyToNv12(ref MemoryMarshal.GetReference(src), srcPitch,
+            ref MemoryMarshal.GetReference(dstY), width, ref MemoryMarshal.GetReference(dstUV), width, width, height);
+    }
+
+    /// <summary>
+    /// Halve a UYVY frame with a 2x2 box filter (one preview pyramid level). The source must
+    /// hold dstWidth * 2 by dstHeight * 2 pixels.
+    /// </summary>
+    public static void DownscaleUyvyHalf(ReadOnlySpan<byte> src, int srcPitch, Span<byte> dst, int dstPitch,
+        int dstWidth, int dstHeight)
+    {
+        CheckWidth(dstWidth);
+        CheckPlane(src.Length, srcPitch, dstWidth * 4, dstHeight * 2, nameof(src));
+        CheckPlane(dst.Length, dstPitch, dstWidth * 2, dstHeight, nameof(dst));
+
+        if (!IsAvailable)
+        {
+            ColorConversion.UyvyHalf(src, srcPitch, dst, dstPitch, dstWidth, dstHeight);
+            return;
+        }
+
+        NativeDownscaleUyvyHalf(ref MemoryMarshal.GetReference(src), srcPitch,
+            ref MemoryMarshal.GetReference(dst), dstPitch, dstWidth, dstHeight);
+    }
+
+    /// <summary>
+    /// Convert v210 (10-bit 4:2:2) to BGRA. srcPitch must include the 48-pixel row padding.
+    /// </summary>
+    public static void ConvertV210ToBgra(ReadOnlySpan<byte> src, int srcPitch, Span<byte> dst, int dstPitch,
+        int width, int height, ColorMatrix matrix)
+    {
+        CheckWidth(width);
+        CheckPlane(src.Length, srcPitch, V210RowBytes(width), height, nameof(src));
+        CheckPlane(dst.Length, dstPitch, width * 4, height, nameof(dst));
+
+        if (!IsAvailable)
+        {
+            ColorConversion.V210ToBgra(src, srcPitch, dst, dstPitch, width, height, matrix);
+            return;
+        }
+
+        NativeConvertV210ToBgra(ref MemoryMarshal.GetReference(src), srcPitch,
+            ref MemoryMarshal.GetReference(dst), dstPitch, width, height, (int)matrix);
+    }
+
+    /// <summary>
+    /// Convert v210 to BGRA at 1/divisor resolution (divisor 2 or 4), sampled the same way
+    /// as <see cref="ConvertUyvyToBgraScaled"/>. Source rows are read every divisor rows.
+    /// </summary>
+    public static void ConvertV210ToBgraScaled(ReadOnlySpan<byte> src, int srcPitch, Span<byte> dst, int dstPitch,
+        int dstWidth, int dstHeight, int divisor, ColorMatrix matrix)
+    {
+        if (divisor is not (2 or 4))
+            throw new ArgumentOutOfRangeException(nameof(divisor), divisor, "Divisor must be 2 or 4");
+        CheckWidth(dstWidth);
+        int srcRowBytes = V210RowBytes(dstWidth * divisor);
+        if (dstHeight <= 0 || srcPitch < srcRowBytes ||
+            (long)srcPitch * divisor * (dstHeight - 1) + srcRowBytes > src.Length)
+            throw new ArgumentException("Source is too small for the scaled output size", nameof(src));
+        CheckPlane(dst.Length, dstPitch, dstWidth * 4, dstHeight, nameof(dst));
+
+        if (!IsAvailable)
+        {
+            ColorConversion.V210ToBgraScaled(src, srcPitch, dst, dstPitch, dstWidth, dstHeight, divisor, matrix);
+            return;
+        }
+
+        NativeConvertV210ToBgraScaled(ref MemoryMarshal.GetReference(src), srcPitch,
+            ref MemoryMarshal.GetReference(dst), dstPitch, dstWidth, dstHeight, divisor, (int)matrix);
+    }
+
+    /// <summary>
+    /// Convert v210 to tightly packed P010 (16-bit Y plane followed by the interleaved UV plane,
+    /// 10-bit values in the high bits). dst must hold <see cref="P010FrameSize"/> bytes.
+    /// </summary>
+    public static void ConvertV210ToP010(ReadOnlySpan<byte> src, int srcPitch, Span<byte> dst, int width, int height)
+    {
+        CheckWidth(width);
+        CheckPlane(src.Length, srcPitch, V210RowBytes(width), height, nameof(src));
+        if (dst.Length < P010FrameSize(width, height))
+            throw new ArgumentException("Destination is too small for a P010 frame", nameof(dst));
+
+        var dstY = dst[..(width * height * 2)];
+        var dstUV = dst[(width * height * 2)..];
+
+        if (!IsAvailable)
+        {
+            ColorConversion.V210ToP010(src, srcPitch, dstY, dstUV, width, height);
+            return;
+        }
+
+        NativeConvertV210ToP010(ref MemoryMarshal.GetReference(src), srcPitch,
+            ref MemoryMarshal.GetReference(dstY), width * 2, ref MemoryMarshal.GetReference(dstUV), width * 2, width, height);
+    }
+
+    /// <summary>
+    /// Widest luma plane <see cref="TryExtractLumaSad"/> accepts.
+    /// </summary>
+    public const int MaxLumaWidth = 1920;
+
+    /// <summary>
+    /// Extract 8-bit luma from a UYVY or v210 frame into a tightly packed dstWidth x dstHeight
+    /// plane (nearest-neighbour, source pixel = dst * src / dst) and, in the same pass, sum
+    /// |luma - reference| over the pixel ROI [roiLeft, roiRight) x [roiTop, roiBottom).
+    /// Pass an empty reference to skip the SAD.
+    /// </summary>
+    /// <returns>False if the native DLL is unavailable or the frame does not fit the kernel
+    /// (short buffer, plane wider than <see cref="MaxLumaWidth"/>); callers then use their managed path.</returns>
+    public static bool TryExtractLumaSad(ReadOnlySpan<byte> src, int srcPitch, int srcWidth, int srcHeight, bool v210,
+        Span<byte> luma, int dstWidth, int dstHeight, ReadOnlySpan<byte> reference,
+        int roiLeft, int roiTop, int roiRight, int roiBottom, out long sad)
+    {
+        sad = 0;
+        int planeSize = dstWidth * dstHeight;
+        if (!IsAvailable || src.IsEmpty || dstWidth <= 0 || dstWidth > MaxLumaWidth || dstHeight <= 0 ||
+            luma.Length < planeSize || (!reference.IsEmpty && reference.Length < planeSize))
+            return false;
+
+        ref byte referenceRef = ref reference.IsEmpty
+            ? ref Unsafe.NullRef<byte>()
+            : ref MemoryMarshal.GetReference(reference);
+
+        return NativeExtractLumaSad(ref MemoryMarshal.GetReference(src), src.Length, srcPitch, srcWidth, srcHeight, v210 ? 1 : 0,
+            ref MemoryMarshal.GetReference(luma), dstWidth, dstHeight, ref referenceRef,
+            roiLeft, roiTop, roiRight, roiBottom, out sad) == 0;
+    }
+
+    /// <summary>
+    /// Sum of absolute differences between two tightly packed luma planes over the pixel ROI
+    /// [roiLeft, roiRight) x [roiTop, roiBottom).
+    /// </summary>
+    /// <returns>False if the native DLL is unavailable or the arguments do not fit; callers then use their managed path.</returns>
+    public static bool TryComputeLumaSad(ReadOnlySpan<byte> a, ReadOnlySpan<byte> b, int width, int height,
+        int roiLeft, int roiTop, int roiRight, int roiBottom, out long sad)
+    {
+        sad = 0;
+        if (!IsAvailable || width <= 0 || height <= 0 || a.Length < width * height || b.Length < width * height)
+            return false;
+
+        return NativeComputeLumaSad(ref MemoryMarshal.GetReference(a), ref MemoryMarshal.GetReference(b), width, height,
+            roiLeft, roiTop, roiRight, roiBottom, out sad) == 0;
+    }
+
+    /// <summary>
+    /// Repeating 4-byte black for <see cref="FadeFrame"/>: opaque black BGRA.
+    /// </summary>
+    public const uint BgraBlack = 0xFF000000;
+
+    /// <summary>
+    /// Repeating 4-byte black for <see cref="FadeFrame"/>: studio-range UYVY (U=V=128, Y=16).
+    /// </summary>
+    public const uint UyvyBlack = 0x10801080;
+
+    /// <summary>
+    /// Dissolve two frames of any interleaved 8-bit layout (BGRA, UYVY) into dst, byte-wise in
+    /// 8-bit fixed point: dst = (a * (256 - weight) + b * weight) >> 8. dst may be a or b.
+    /// </summary>
+    /// <param name="weight">Share of b, 0 (all a) to 256 (all b).</param>
+    public static void BlendFrames(ReadOnlySpan<byte> a, ReadOnlySpan<byte> b, Span<byte> dst, int weight)
+    {
+        CheckWeight(weight);
+        if (a.Length < dst.Length || b.Length < dst.Length)
+            throw new ArgumentException("Sources must be at least as long as dst", nameof(dst));
+        if (dst.IsEmpty)
+            return;
+
+        if (!IsAvailable)
+        {
+            FrameBlend.Blend(a, b, dst, weight);
+            return;
+        }
+
+        NativeBlendFrames(ref MemoryMarshal.GetReference(a), ref MemoryMarshal.GetReference(b),
+            ref MemoryMarshal.GetReference(dst), dst.Length, weight);
+    }
+
+    /// <summary>
+    /// Fade a frame towards black: dst = (src * weight + black * (256 - weight)) >> 8, where black
+    /// is a repeating 4-byte pixel group (<see cref="BgraBlack"/>, <see cref="UyvyBlack"/>).
+    /// dst may be src; its length must be a multiple of 4.
+    /// </summary>
+    /// <param name="weight">Share of src kept, 0 (black) to 256 (unchanged).</param>
+    public static void FadeFrame(ReadOnlySpan<byte> src, Span<byte> dst, int weight, uint black)
+    {
+        CheckWeight(weight);
+        if (src.Length < dst.Length || (dst.Length & 3) != 0)
+            throw new ArgumentException("dst must be a multiple of 4 bytes and no longer than src", nameof(dst));
+        if (dst.IsEmpty)
+            return;
+
+        if (!IsAvailable)
+        {
+            FrameBlend.Fade(src, dst, weight, black);
+            return;
+        }
+
+        NativeFadeFrame(ref MemoryMarshal.GetReference(src), ref MemoryMarshal.GetReference(dst), dst.Length, weight, black);
+    }
+
+    /// <summary>
+    /// Composite a pre-rasterised overlay layer into frame in place. The layer is in the frame's
+    /// own 8-bit layout as premultiplied color bytes plus per-byte inverse alpha (255 = transparent):
+    /// frame = sat(((frame * (ia + (ia >> 7))) >> 8) + color). frame starts at the layer's top-left byte.
+    /// </summary>
+    public static void CompositeLayer(Span<byte> frame, int framePitch, ReadOnlySpan<byte> color,
+        ReadOnlySpan<byte> inverseAlpha, int layerPitch, int rowBytes, int rows)
+    {
+        if (rows == 0 || rowBytes == 0)
+            return;
+
+        CheckPlane(frame.Length, framePitch, rowBytes, rows, nameof(frame));
+        CheckPlane(color.Length, layerPitch, rowBytes, rows, nameof(color));
+        CheckPlane(inverseAlpha.Length, layerPitch, rowBytes, rows, nameof(inverseAlpha));
+
+        if (!IsAvailable)
+        {
+            FrameBlend.Composite(frame, framePitch, color, inverseAlpha, layerPitch, rowBytes, rows);
+            return;
+        }
+
+        NativeCompositeLayer(ref MemoryMarshal.GetReference(frame), framePitch, ref MemoryMarshal.GetReference(color),
+            ref MemoryMarshal.GetReference(inverseAlpha), layerPitch, rowBytes, rows);
+    }
+
+    /// <summary>
+    /// Most channels the native <see cref="MeasureAudioLevels"/> kernel takes; wider layouts are measured in managed code.
+    /// </summary>
+    public const int MaxAudioChannels = 64;
+
+    /// <summary>
+    /// Meter interleaved little-endian PCM (16- or 32-bit signed) in one pass: per-channel
+    /// RMS and peak relative to full scale, and an onset score = the largest mean square of
+    /// any windowFrames window over the block's mean square (1 for a steady signal, up to
+    /// frames / windowFrames for an isolated strike, 0 for silence). A trailing partial frame
+    /// is ignored. Pass an empty span for any output that is not needed; the others need one
+    /// float per channel. windowFrames is rounded up to a multiple of 8 / gcd(channels, 8).
+    /// </summary>
+    public static void MeasureAudioLevels(ReadOnlySpan<byte> samples, int channels, int bitsPerSample, int windowFrames,
+        Span<float> rms, Span<float> peak, Span<float> onset)
+    {
+        ArgumentOutOfRangeException.ThrowIfNegativeOrZero(channels);
+        ArgumentOutOfRangeException.ThrowIfNegativeOrZero(windowFrames);
+        if (bitsPerSample is not (16 or 32))
+            throw new ArgumentOutOfRangeException(nameof(bitsPerSample), bitsPerSample, "Only 16- and 32-bit PCM is supported");
+        CheckLevels(rms, channels, nameof(rms));
+        CheckLevels(peak, channels, nameof(peak));
+        CheckLevels(onset, channels, nameof(onset));
+
+        if (!IsAvailable || channels > MaxAudioChannels)
+        {
+            AudioLevels.Measure(samples, channels, bitsPerSample, windowFrames, rms, peak, onset);
+            return;
+        }
+
+        NativeMeasureAudioLevels(ref MemoryMarshal.GetReference(samples), samples.Length, channels, bitsPerSample, windowFrames,
+            ref LevelsRef(rms), ref LevelsRef(peak), ref LevelsRef(onset));
+    }
+
+    private static ref float LevelsRef(Span<float> levels) =>
+        ref levels.IsEmpty ? ref Unsafe.NullRef<float>() : ref MemoryMarshal.GetReference(levels);
+
+    private static void CheckLevels(Span<float> levels, int channels, string name)
+    {
+        if (!levels.IsEmpty && levels.Length < channels)
+            throw new ArgumentException($"Needs room for {channels} channels", name);
+    }
+
+    /// <summary>
+    /// Bytes in a tightly packed NV12 frame.
+    /// </summary>
+    public static int Nv12FrameSize(int width, int height) => width * height + width * ((height + 1) / 2);
+
+    /// <summary>
+    /// Bytes in a tightly packed P010 frame.
+    /// </summary>
+    public static int P010FrameSize(int width, int height) => 2 * Nv12FrameSize(width, height);
+
+    /// <summary>
+    /// Minimum v210 row size: rows are padded to 48-pixel (128-byte) groups.
+    /// </summary>
+    public static int V210RowBytes(int width) => (width + 47) / 48 * 128;
+
+    private static void CheckWeight(int weight)
+    {
+        if (weight is < 0 or > 256)
+            throw new ArgumentOutOfRangeException(nameof(weight), weight, "Weight must be between 0 and 256");
+    }
+
+    private static void CheckWidth(int width)
+    {
+        if (width < 2 || (width & 1) != 0)
+            throw new ArgumentOutOfRangeException(nameof(width), width, "Width must be even and at least 2");
+    }
+
+    private static void CheckPlane(int length, int pitch, int rowBytes, int rows, string name)
+    {
+        if (rows <= 0 || pitch < rowBytes || (long)pitch * (rows - 1) + rowBytes > length)
+            throw new ArgumentException($"Buffer is too small for {rows} rows of {rowBytes} bytes at pitch {pitch}", name);
+    }
+}
@@ -8,12 +8,30 @@ namespace Screener.Core.Output;
 /// <summary>
 /// Coordinates frame push to WebSocket streaming + all IOutputService instances.
 /// Replaces direct IStreamingService reference in InputPreviewRenderer.
+/// Outputs routed to an encode ladder rendition (<see cref="ITeeOutput"/>) are fed by one
+/// shared <see cref="IEncodeTee"/> instead of raw frames, so each rendition is encoded once.
 /// </summary>
 public sealed class OutputManager
 {
     private readonly ILogger<OutputManager> _logger;
     private readonly IStreamingService _streamingService;
     private readonly IOutputService[] _outputServices;
+    private readonly IEncodeTee? _encodeTee;
+
+    // Serializes tee restarts, which run off the push path; dirty is set when an output starts or
+    // stops or the ladder changes, and only a change in the resolved targets restarts FFmpeg
+    private readonly SemaphoreSlim _teeGate = new(1, 1);
+    private volatile bool _teeDirty;
+    private volatile VideoMode? _teeMode;
+    private volatile bool _teeWanted;
+    private long _teeRetryTicks;
+    private IReadOnlyList<TeeTarget> _teeTargets = Array.Empty<TeeTarget>();
+    private IReadOnlyList<EncodeRendition> _teeLadder = Array.Empty<EncodeRendition>();
+    private IReadOnlyList<EncodeRendition> _encodeLadder = Array.Empty<EncodeRendition>();
+
+    // A restart waits for in-flight pushes to leave the tee before stopping it
+    private volatile bool _teeRestarting;
+    private int _teePushes;
 
     public IStreamingService StreamingService => _streamingService;
     public IReadOnlyList<IOutputService> OutputServices => _outputServices;
@@ -25,14 +43,33 @@ public sealed class OutputManager
     /// </summary>
     public int? ActiveRendererIndex { get; set; }
 
+    /// <summary>
+    /// Renditions of the program feed that tee-routed outputs can ask for (from settings).
+    /// Renditions with static targets are encoded even when no output is routed to them.
+    /// </summary>
+    public IReadOnlyList<EncodeRendition> EncodeLadder
+    {
+        get => _encodeLadder;
+        set
+        {
+            _encodeLadder = value;
+            _teeDirty = true;
+        }
+    }
+
     public OutputManager(
         ILogger<OutputManager> logger,
         IStreamingService streamingService,
-        IEnumerable<IOutputService> outputServices)
+        IEnumerable<IOutputService> outputServices,
+        IEncodeTee? encodeTee = null)
     {
         _logger = logger;
         _streamingService = streamingService;
         _outputServices = outputServices.ToArray();
+        _encodeTee = encodeTee;
+
+        foreach (var output in _outputServices)
+            output.StateChanged += (_, _) => _teeDirty = true;
     }
 
     /// <summary>
@@ -53,10 +90,29 @@ public sealed class OutputManager
             }
         }
 
+        // One encode per rendition for every output routed through the tee. Starting and stopping
+        // FFmpeg can take seconds, so it happens in the background while frames skip the tee.
+        if (_encodeTee != null)
+        {
+            if (TeeNeedsUpdate(mode))
+                _ = Task.Run(() => UpdateEncodeTeeAsync(mode));
+
+            Interlocked.Increment(ref _teePushes);
+            try
+            {
+                if (_teeWanted && !_teeRestarting && _teeMode == mode && _encodeTee.IsRunning)
+                    await _encodeTee.PushFrameAsync(frameData, timestamp, ct);
+            }
+            finally
+            {
+                Interlocked.Decrement(ref _teePushes);
+            }
+        }
+
         // Push to all active output services
         foreach (var output in _outputServices)
         {
-            if (output.State == OutputState.Running)
+            if (output.State == OutputState.Running && output is not ITeeOutput { TeeTarget: not null })
             {
                 try
                 {
@@ -91,6 +147,98 @@ public sealed class OutputManager
         }
     }
 
+    private bool TeeNeedsUpdate(VideoMode mode)
+    {
+        if (_teeGate.CurrentCount == 0)
+            return false;
+        if (_teeDirty)
+            return true;
+
+        // A tee that failed to start or whose FFmpeg died retries at most every five seconds
+        return _teeWanted
+            && (_teeMode != mode || !_encodeTee!.IsRunning)
+            && Environment.TickCount64 >= Interlocked.Read(ref _teeRetryTicks);
+    }
+
+    // (Re)start the tee for the outputs currently routed to it plus the ladder's static targets.
+    // FFmpeg's tee muxer cannot add or remove outputs on the fly, so a change to the resolved
+    // targets restarts the shared encode; output state changes that leave them alone do not.
+    private async Task UpdateEncodeTeeAsync(VideoMode mode)
+    {
+        if (!await _teeGate.WaitAsync(0))
+            return;
+
+        try
+        {
+            bool retry = _teeWanted && _teeMode == mode && !_teeDirty;
+            _teeDirty = false;
+
+            var ladder = _encodeLadder;
+            var targets = _outputServices
+                .OfType<ITeeOutput>()
+                .Where(o => o.State == OutputState.Running && o.TeeTarget != null)
+                .Select(o => o.TeeTarget!)
+                .ToList();
+            bool wanted = targets.Count > 0 || ladder.Any(r => r.Targets?.Any(t => !string.IsNullOrWhiteSpace(t)) == true);
+
+            bool unchanged = wanted == _teeWanted
+                && targets.SequenceEqual(_teeTargets)
+                && ladder.SequenceEqual(_teeLadder);
+            if (unchanged && (!wanted || (_teeMode == mode && _encodeTee!.IsRunning)))
+                return;
+
+            Interlocked.Exchange(ref _teeRetryTicks, Environment.TickCount64 + 5000);
+            await PauseTeePushesAsync();
+
+            try
+            {
+                if (!wanted)
+                {
+                    if (_teeWanted)
+                        await _encodeTee!.StopAsync();
+                    _teeWanted = false;
+                    _teeMode = null;
+                    _teeTargets = Array.Empty<TeeTarget>();
+                    _teeLadder = Array.Empty<EncodeRendition>();
+                    return;
+                }
+
+                if (retry)
+                    _logger.LogWarning("Encode tee is not running; restarting");
+
+                _teeWanted = true;
+                _teeMode = mode;
+                _teeTargets = targets;
+                _teeLadder = ladder;
+                await _encodeTee!.StartAsync(mode, ladder, targets);
+                _logger.LogInformation("Encode tee feeding {Outputs} output(s) at {Width}x{Height}",
+                    targets.Count, mode.Width, mode.Height);
+            }
+            finally
+            {
+                _teeRestarting = false;
+            }
+        }
+        catch (Exception ex)
+        {
+            _logger.LogError(ex, "Failed to start the encode tee");
+        }
+        finally
+        {
+            _teeGate.Release();
+        }
+    }
+
+    // Stop new pushes into the tee and wait for the ones already inside it (at most a frame
+    // interval each) so StopAsync never disposes the frame writer under a push.
+    private async Task PauseTeePushesAsync()
+    {
+        _teeRestarting = true;
+        Interlocked.MemoryBarrier();
+        while (Volatile.Read(ref _teePushes) > 0)
+            await Task.Delay(1);
+    }
+
     /// <summary>
     /// Get an output service by its ID.
     /// </summary>
@@ -99,6 +99,15 @@ public sealed class DatabaseContext : IAsyncDisposable
                 metadata_json TEXT
             );
 
+            -- Progress of interrupted chunked uploads, keyed by file and destination
+            CREATE TABLE IF NOT EXISTS upload_resume (
+                resume_key TEXT PRIMARY KEY,
+                session_json TEXT NOT NULL,
+                completed_parts TEXT NOT NULL DEFAULT '',
+                bytes_uploaded INTEGER NOT NULL DEFAULT 0,
+                updated_at TEXT NOT NULL
+            );
+
             -- Recordings History
             CREATE TABLE IF NOT EXISTS recordings (
                 id TEXT PRIMARY KEY,
@@ -109,6 +109,8 @@ public static class SettingsKeys
     public const string SelectedVideoMode = "video.selectedVideoMode";
     public const string SelectedPreset = "video.selectedPreset";
     public const string PreferHardwareEncoding = "video.preferHardwareEncoding";
+    public const string TenBitCapture = "video.tenBitCapture";
+    public const string RawIsoRecording = "video.rawIsoRecording";
 
     // Audio
     public const string AudioChannels = "audio.channels";
@@ -147,17 +149,25 @@ public static class SettingsKeys
     public const string SrtOutputLatency = "srt.outputLatency";
     public const string SrtOutputBitrate = "srt.outputBitrate";
     public const string SrtInputs = "srt.inputs";
+    public const string SrtOutputRendition = "srt.outputRendition";
+
+    // Output
+    public const string EncodeLadder = "output.encodeLadder";
 
     // Upload
     public const string AutoUpload = "upload.autoUpload";
     public const string AutoUploadClips = "upload.autoUploadClips";
     public const string MaxConcurrentUploads = "upload.maxConcurrent";
     public const string DefaultUploadProvider = "upload.defaultProvider";
+    public const string MaxUploadBandwidthMbps = "upload.maxBandwidthMbps";
 
     // Golf
     public const string GolfAutoUpload = "golf.autoUpload";
     public const string GolfAutoUploadProvider = "golf.autoUploadProvider";
     public const string GolfAutoUploadRemotePath = "golf.autoUploadRemotePath";
+    public const string GolfExportRenditions = "golf.exportRenditions";
+    public const string GolfExportEncoder = "golf.exportEncoder";
+    public const string GolfExportMaxConcurrent = "golf.exportMaxConcurrent";
 
     // API
     public const string ApiKey = "api.key";
@@ -10,9 +10,20 @@ namespace Screener.Core.Persistence;
 /// </summary>
 public sealed class UploadQueueRepository
 {
+    private const string SelectColumns = """
+        SELECT id, local_file_path AS LocalFilePath, remote_path AS RemotePath, provider_id AS ProviderId,
+               status, priority, bytes_uploaded AS BytesUploaded, total_bytes AS TotalBytes,
+               error_message AS ErrorMessage, retry_count AS RetryCount, created_at AS CreatedAt,
+               started_at AS StartedAt, completed_at AS CompletedAt, metadata_json AS MetadataJson
+        FROM upload_queue
+        """;
+
     private readonly ILogger<UploadQueueRepository> _logger;
     private readonly DatabaseContext _db;
 
+    // Uploads run in parallel but share one SQLite connection
+    private readonly SemaphoreSlim _writeLock = new(1, 1);
+
     public UploadQueueRepository(ILogger<UploadQueueRepository> logger, DatabaseContext db)
     {
         _logger = logger;
@@ -24,7 +35,7 @@ public sealed class UploadQueueRepository
     /// </summary>
     public async Task<IReadOnlyList<QueuedUpload>> GetAllAsync(CancellationToken ct = default)
     {
-        const string sql = "SELECT * FROM upload_queue ORDER BY priority DESC, created_at";
+        const string sql = SelectColumns + " ORDER BY priority DESC, created_at";
 
         var rows = await _db.QueryAsync<UploadRow>(sql);
         return rows.Select(MapToUpload).ToList();
@@ -37,8 +48,8 @@ public sealed class UploadQueueRepository
         UploadStatus status,
         CancellationToken ct = default)
     {
-        const string sql = """
-            SELECT * FROM upload_queue
+        const string sql = SelectColumns + """
+
             WHERE status = @Status
             ORDER BY priority DESC, created_at
             """;
@@ -54,8 +65,8 @@ public sealed class UploadQueueRepository
         int limit = 10,
         CancellationToken ct = default)
     {
-        const string sql = """
-            SELECT * FROM upload_queue
+        const string sql = SelectColumns + """
+
             WHERE status IN ('Pending', 'Paused')
             ORDER BY priority DESC, created_at
             LIMIT @Limit
@@ -70,7 +81,7 @@ public sealed class UploadQueueRepository
     /// </summary>
     public async Task<QueuedUpload?> GetByIdAsync(Guid id, CancellationToken ct = default)
     {
-        const string sql = "SELECT * FROM upload_queue WHERE id = @Id";
+        const string sql = SelectColumns + " WHERE id = @Id";
 
         var row = await _db.QuerySingleOrDefaultAsync<UploadRow>(sql, new { Id = id.ToString() });
         return row != null ? MapToUpload(row) : null;
@@ -93,7 +104,7 @@ public sealed class UploadQueueRepository
             )
             """;
 
-        await _db.ExecuteAsync(sql, MapToRow(upload));
+        await ExecuteAsync(sql, MapToRow(upload));
 
         _logger.LogDebug("Inserted upload: {Id}", upload.Id);
     }
@@ -114,7 +125,7 @@ public sealed class UploadQueueRepository
             WHERE id = @Id
             """;
 
-        await _db.ExecuteAsync(sql, new
+        await ExecuteAsync(sql, new
         {
             Id = upload.Id.ToString(),
             Status = upload.Status.ToString(),
@@ -138,7 +149,7 @@ public sealed class UploadQueueRepository
             WHERE id = @Id
             """;
 
-        await _db.ExecuteAsync(sql, new { Id = id.ToString(), BytesUploaded = bytesUploaded });
+        await ExecuteAsync(sql, new { Id = id.ToString(), BytesUploaded = bytesUploaded });
     }
 
     /// <summary>
@@ -148,7 +159,7 @@ public sealed class UploadQueueRepository
     {
         const string sql = "DELETE FROM upload_queue WHERE id = @Id";
 
-        await _db.ExecuteAsync(sql, new { Id = id.ToString() });
+        await ExecuteAsync(sql, new { Id = id.ToString() });
 
         _logger.LogDebug("Deleted upload: {Id}", id);
     }
@@ -166,7 +177,7 @@ public sealed class UploadQueueRepository
               AND completed_at < @Cutoff
             """;
 
-        var deleted = await _db.ExecuteAsync(sql, new { Cutoff = cutoff.ToString("O") });
+        var deleted = await ExecuteAsync(sql, new { Cutoff = cutoff.ToString("O") });
 
         if (deleted > 0)
         {
@@ -174,6 +185,95 @@ public sealed class UploadQueueRepository
         }
     }
 
+    /// <summary>
+    /// Get saved progress of an interrupted chunked upload.
+    /// </summary>
+    public async Task<UploadResumeState?> GetResumeStateAsync(string resumeKey, CancellationToken ct = default)
+    {
+        const string sql = """
+            SELECT resume_key AS ResumeKey, session_json AS SessionJson, completed_parts AS CompletedParts,
+                   bytes_uploaded AS BytesUploaded, updated_at AS UpdatedAt
+            FROM upload_resume
+            WHERE resume_key = @ResumeKey
+            """;
+
+        var row = await _db.QuerySingleOrDefaultAsync<ResumeRow>(sql, new { ResumeKey = resumeKey });
+        if (row == null)
+            return null;
+
+        var parts = row.CompletedParts
+            .Split(',', StringSplitOptions.RemoveEmptyEntries)
+            .Select(int.Parse)
+            .ToArray();
+
+        return new UploadResumeState(row.ResumeKey, row.SessionJson, parts, row.BytesUploaded,
+            DateTimeOffset.Parse(row.UpdatedAt));
+    }
+
+    /// <summary>
+    /// Save progress of a chunked upload, replacing any earlier state for it.
+    /// </summary>
+    public async Task SaveResumeStateAsync(UploadResumeState state, CancellationToken ct = default)
+    {
+        const string sql = """
+            INSERT OR REPLACE INTO upload_resume (
+                resume_key, session_json, completed_parts, bytes_uploaded, updated_at
+            ) VALUES (
+                @ResumeKey, @SessionJson, @CompletedParts, @BytesUploaded, @UpdatedAt
+            )
+            """;
+
+        await ExecuteAsync(sql, new
+        {
+            state.ResumeKey,
+            state.SessionJson,
+            CompletedParts = string.Join(',', state.CompletedParts),
+            state.BytesUploaded,
+            UpdatedAt = state.UpdatedAt.ToString("O")
+        });
+    }
+
+    /// <summary>
+    /// Delete saved progress of a chunked upload.
+    /// </summary>
+    public async Task DeleteResumeStateAsync(string resumeKey, CancellationToken ct = default)
+    {
+        const string sql = "DELETE FROM upload_resume WHERE resume_key = @ResumeKey";
+
+        await ExecuteAsync(sql, new { ResumeKey = resumeKey });
+    }
+
+    /// <summary>
+    /// Delete saved progress not touched within the specified age; the remote sessions it
+    /// refers to will have expired.
+    /// </summary>
+    public async Task DeleteStaleResumeStatesAsync(TimeSpan age, CancellationToken ct = default)
+    {
+        var cutoff = DateTimeOffset.UtcNow - age;
+
+        const string sql = "DELETE FROM upload_resume WHERE updated_at < @Cutoff";
+
+        var deleted = await ExecuteAsync(sql, new { Cutoff = cutoff.ToString("O") });
+
+        if (deleted > 0)
+        {
+            _logger.LogInformation("Deleted {Count} stale upload resume states", deleted);
+        }
+    }
+
+    private async Task<int> ExecuteAsync(string sql, object param)
+    {
+        await _writeLock.WaitAsync();
+        try
+        {
+            return await _db.ExecuteAsync(sql, param);
+        }
+        finally
+        {
+            _writeLock.Release();
+        }
+    }
+
     private static QueuedUpload MapToUpload(UploadRow row)
     {
         UploadMetadata? metadata = null;
@@ -241,6 +341,15 @@ public sealed class UploadQueueRepository
         public string? CompletedAt { get; set; }
         public string? MetadataJson { get; set; }
     }
+
+    private class ResumeRow
+    {
+        public string ResumeKey { get; set; } = string.Empty;
+        public string SessionJson { get; set; } = string.Empty;
+        public string CompletedParts { get; set; } = string.Empty;
+        public long BytesUploaded { get; set; }
+        public string UpdatedAt { get; set; } = string.Empty;
+    }
 }
 
 /// <summary>
@@ -278,3 +387,13 @@ public class QueuedUpload
 
     public double ProgressPercent => TotalBytes > 0 ? 100.0 * BytesUploaded / TotalBytes : 0;
 }
+
+/// <summary>
+/// Saved progress of a chunked upload: the provider's session and the parts already sent.
+/// </summary>
+public record UploadResumeState(
+    string ResumeKey,
+    string SessionJson,
+    IReadOnlyCollection<int> CompletedParts,
+    long BytesUploaded,
+    DateTimeOffset UpdatedAt);
@@ -0,0 +1,64 @@
+using System.Text.Json;
+using Screener.Abstractions.Capture;
+
+namespace Screener.Core.Recording;
+
+/// <summary>
+/// Sidecar written next to a raw ISO recording (<c>recording.uyvy.json</c>): the geometry
+/// FFmpeg needs to demux the headerless frames, and the fixed frame size that turns a time
+/// range into a byte range.
+/// </summary>
+public sealed record RawVideoInfo(
+    int Width,
+    int Height,
+    PixelFormat PixelFormat,
+    int FrameRateNumerator,
+    int FrameRateDenominator,
+    int RowBytes)
+{
+    public const string Extension = ".json";
+
+    public long FrameSize => (long)RowBytes * Height;
+
+    public double FramesPerSecond => (double)FrameRateNumerator / FrameRateDenominator;
+
+    /// <summary>
+    /// FFmpeg input options for the file or its bytes on a pipe, up to (not including) -i.
+    /// v210 has its own raw demuxer; UYVY goes through rawvideo.
+    /// </summary>
+    public string DemuxArguments => PixelFormat == PixelFormat.YUV422_10bit
+        ? $"-f v210 -video_size {Width}x{Height} -framerate {FrameRateNumerator}/{FrameRateDenominator}"
+        : $"-f rawvideo -pixel_format uyvy422 -video_size {Width}x{Height} -framerate {FrameRateNumerator}/{FrameRateDenominator}";
+
+    /// <summary>Recording position of a frame.</summary>
+    public TimeSpan FrameTime(long frame) =>
+        TimeSpan.FromSeconds((double)frame * FrameRateDenominator / FrameRateNumerator);
+
+    public static string PathFor(string recordingPath) => recordingPath + Extension;
+
+    public void Write(string recordingPath) =>
+        File.WriteAllText(PathFor(recordingPath), JsonSerializer.Serialize(this));
+
+    /// <summary>
+    /// The sidecar of a raw recording, or null when the file is not one (or the sidecar is
+    /// missing or unreadable).
+    /// </summary>
+    public static RawVideoInfo? TryRead(string recordingPath)
+    {
+        var path = PathFor(recordingPath);
+        if (!File.Exists(path))
+            return null;
+
+        try
+        {
+            var info = JsonSerializer.Deserialize<RawVideoInfo>(File.ReadAllText(path));
+            return info is { Width: > 0, Height: > 0, RowBytes: > 0, FrameRateNumerator: > 0, FrameRateDenominator: > 0 }
+                ? info
+                : null;
+        }
+        catch (Exception ex) when (ex is IOException or JsonException or UnauthorizedAccessException)
+        {
+            return null;
+        }
+    }
+}
@@ -0,0 +1,330 @@
+using System.Buffers.Binary;
+using System.Runtime.InteropServices;
+using Screener.Abstractions.Capture;
+using Screener.Abstractions.Timecode;
+
+namespace Screener.Core.Recording;
+
+/// <summary>
+/// One video frame of a fragmented MP4 recording, in decode order.
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+public struct RecordingIndexEntry
+{
+    /// <summary>Presentation time in <see cref="RecordingIndex.Timescale"/> units.</summary>
+    public long Pts;
+
+    /// <summary>Byte offset of the frame's data in the recording.</summary>
+    public long Offset;
+
+    /// <summary>Byte offset of the moof box of the fragment holding the frame.</summary>
+    public long FragmentOffset;
+
+    public int Size;
+
+    /// <summary>Packed SMPTE timecode (see <see cref="RecordingIndex.PackTimecode"/>), or <see cref="RecordingIndex.NoTimecode"/>.</summary>
+    public uint Timecode;
+
+    public int Flags;
+
+    public readonly bool IsKeyframe => (Flags & RecordingIndex.KeyframeFlag) != 0;
+    public readonly bool IsFragmentStart => (Flags & RecordingIndex.FragmentStartFlag) != 0;
+}
+
+/// <summary>
+/// Byte range of a recording that holds a clip: the init segment (ftyp + moov) followed by
+/// whole fragments from the keyframe at or before the in point to past the out point.
+/// </summary>
+/// <param name="KeyframePosition">Recording position of the first frame in the range.</param>
+/// <param name="InTimecode">Timecode of the first frame at or after the in point, if recorded.</param>
+public sealed record RecordingIndexRange(
+    long InitLength,
+    long StartOffset,
+    long EndOffset,
+    TimeSpan KeyframePosition,
+    Smpte12MTimecode? InTimecode);
+
+/// <summary>
+/// Sidecar index written next to a fragmented MP4 as it records (<c>recording.mp4.idx</c>):
+/// a 64-byte header, then one fixed-size <see cref="RecordingIndexEntry"/> per video frame.
+/// Lets clipping find the bytes of a range without FFmpeg scanning the whole file.
+/// </summary>
+public sealed class RecordingIndex : IDisposable
+{
+    public const string Extension = ".idx";
+    public const int HeaderSize = 64;
+    public const int KeyframeFlag = 1;
+    public const int FragmentStartFlag = 2;
+    public const uint NoTimecode = uint.MaxValue;
+
+    // Header flag: every fragment addresses its data relative to its moof, so fragments can be
+    // cut out of the file and appended to the init segment
+    public const int SpliceableFlag = 1;
+
+    private static ReadOnlySpan<byte> Magic => "SCRIDX01"u8;
+    private const int Version = 1;
+    private static readonly int EntrySize = Marshal.SizeOf<RecordingIndexEntry>();
+
+    // Entries read per round trip when scanning a clip's frames
+    private const int ScanChunk = 256;
+
+    private readonly FileStream _stream;
+
+    public int Timescale { get; }
+    public FrameRate FrameRate { get; }
+    public long InitLength { get; }
+    public bool Spliceable { get; }
+    public long Count => (_stream.Length - HeaderSize) / EntrySize;
+
+    private RecordingIndex(FileStream stream, int timescale, FrameRate frameRate, long initLength, bool spliceable)
+    {
+        _stream = stream;
+        Timescale = timescale;
+        FrameRate = frameRate;
+        InitLength = initLength;
+        Spliceable = spliceable;
+    }
+
+    public static string PathFor(string recordingPath) => recordingPath + Extension;
+
+    /// <summary>
+    /// Open the index of a recording (which may still be growing). Null when there is none or
+    /// it is not a version this build reads.
+    /// </summary>
+    public static RecordingIndex? TryOpen(string recordingPath)
+    {
+        var path = PathFor(recordingPath);
+        if (!File.Exists(path))
+            return null;
+
+        FileStream? stream = null;
+        try
+        {
+            stream = new FileStream(path, FileMode.Open, FileAccess.Read, FileShare.ReadWrite | FileShare.Delete,
+                bufferSize: 1, FileOptions.RandomAccess);
+
+            Span<byte> header = stackalloc byte[HeaderSize];
+            if (stream.Length < HeaderSize || RandomAccess.Read(stream.SafeFileHandle, header, 0) < HeaderSize ||
+                !header[..8].SequenceEqual(Magic) || BinaryPrimitives.ReadInt32LittleEndian(header[8..]) != Version)
+            {
+                stream.Dispose();
+                return null;
+            }
+
+            int timescale = BinaryPrimitives.ReadInt32LittleEndian(header[12..]);
+            var frameRate = new FrameRate(
+                BinaryPrimitives.ReadInt32LittleEndian(header[16..]),
+                BinaryPrimitives.ReadInt32LittleEndian(header[20..]));
+            long initLength = BinaryPrimitives.ReadInt64LittleEndian(header[24..]);
+            int flags = BinaryPrimitives.ReadInt32LittleEndian(header[32..]);
+
+            if (timescale <= 0 || initLength <= 0)
+            {
+                stream.Dispose();
+                return null;
+            }
+
+            return new RecordingIndex(stream, timescale, frameRate, initLength, (flags & SpliceableFlag) != 0);
+        }
+        catch (IOException)
+        {
+            stream?.Dispose();
+            return null;
+        }
+    }
+
+    internal static void WriteHeader(Span<byte> header, int timescale, FrameRate frameRate, long initLength, int flags)
+    {
+        header.Clear();
+        Magic.CopyTo(header);
+        BinaryPrimitives.WriteInt32LittleEndian(header[8..], Version);
+        BinaryPrimitives.WriteInt32LittleEndian(header[12..], timescale);
+        BinaryPrimitives.WriteInt32LittleEndian(header[16..], frameRate.Numerator);
+        BinaryPrimitives.WriteInt32LittleEndian(header[20..], frameRate.Denominator);
+        BinaryPrimitives.WriteInt64LittleEndian(header[24..], initLength);
+        BinaryPrimitives.WriteInt32LittleEndian(header[32..], flags);
+    }
+
+    public static uint PackTimecode(Smpte12MTimecode tc) =>
+        (uint)(tc.Hours << 24 | tc.Minutes << 16 | tc.Seconds << 8 | tc.Frames) | (tc.DropFrame ? 0x80000000u : 0);
+
+    public static Smpte12MTimecode? UnpackTimecode(uint packed) =>
+        packed == NoTimecode
+            ? null
+            : new Smpte12MTimecode((int)(packed >> 24) & 0x7F, (int)(packed >> 16) & 0xFF,
+                (int)(packed >> 8) & 0xFF, (int)packed & 0xFF, (packed & 0x80000000u) != 0);
+
+    /// <summary>
+    /// Read entries starting at index first; returns how many were read.
+    /// </summary>
+    public int ReadEntries(long first, Span<RecordingIndexEntry> destination)
+    {
+        long count = Math.Min(destination.Length, Count - first);
+        if (count <= 0)
+            return 0;
+
+        var bytes = MemoryMarshal.AsBytes(destination[..(int)count]);
+        int read = RandomAccess.Read(_stream.SafeFileHandle, bytes, HeaderSize + first * EntrySize);
+        return read / EntrySize;
+    }
+
+    /// <summary>
+    /// Find the bytes covering [inPoint, outPoint] (recording positions). Null if the out
+    /// point is not indexed yet or the index has no usable fragment start before the in point.
+    /// </summary>
+    public RecordingIndexRange? FindRange(TimeSpan inPoint, TimeSpan outPoint)
+    {
+        long count = Count;
+        if (count == 0)
+            return null;
+
+        Span<RecordingIndexEntry> one = stackalloc RecordingIndexEntry[1];
+        ReadEntries(0, one);
+        long zero = one[0].Pts;
+        long inPts = zero + (long)(inPoint.TotalSeconds * Timescale);
+        long outPts = zero + (long)(outPoint.TotalSeconds * Timescale);
+
+        // PTS is sorted apart from B-frame reordering, which the backward scan absorbs
+        long lo = 0, hi = count - 1;
+        while (lo < hi)
+        {
+            long mid = lo + (hi - lo + 1) / 2;
+            ReadEntries(mid, one);
+            if (one[0].Pts <= inPts)
+                lo = mid;
+            else
+                hi = mid - 1;
+        }
+
+        var chunk = new RecordingIndexEntry[ScanChunk];
+
+        // Back to the nearest fragment that starts on a keyframe at or before the in point
+        long start = -1;
+        RecordingIndexEntry key = default;
+        for (long end = lo + 1; end > 0 && start < 0; end -= ScanChunk)
+        {
+            long first = Math.Max(0, end - ScanChunk);
+            int read = ReadEntries(first, chunk.AsSpan(0, (int)(end - first)));
+            for (int i = read - 1; i >= 0; i--)
+            {
+                if (chunk[i].IsKeyframe && chunk[i].IsFragmentStart && chunk[i].Pts <= inPts)
+                {
+                    start = first + i;
+                    key = chunk[i];
+                    break;
+                }
+            }
+        }
+
+        if (start < 0)
+            return null;
+
+        // Forward to the first keyframe fragment presented after the out point
+        long endOffset = -1;
+        long lastEnd = 0;
+        long inFramePts = long.MaxValue;
+        uint inTimecode = NoTimecode;
+        for (long next = start; next < count && endOffset < 0; next += ScanChunk)
+        {
+            int read = ReadEntries(next, chunk);
+            for (int i = 0; i < read; i++)
+            {
+                ref var entry = ref chunk[i];
+                if (next + i > start && entry.IsKeyframe && entry.IsFragmentStart && entry.Pts > outPts)
+                {
+                    endOffset = entry.FragmentOffset;
+                    break;
+                }
+
+                if (entry.Pts >= inPts && entry.Pts < inFramePts)
+                {
+                    inFramePts = entry.Pts;
+                    inTimecode = entry.Timecode;
+                }
+
+                lastEnd = Math.Max(lastEnd, entry.Offset + entry.Size);
+            }
+        }
+
+        if (endOffset < 0)
+        {
+            // The whole indexed tail, but only once it reaches the out point
+            ReadEntries(count - 1, one);
+            if (one[0].Pts < outPts)
+                return null;
+            endOffset = lastEnd;
+        }
+
+        return new RecordingIndexRange(
+            InitLength,
+            key.FragmentOffset,
+            endOffset,
+            TimeSpan.FromSeconds((double)(key.Pts - zero) / Timescale),
+            UnpackTimecode(inTimecode));
+    }
+
+    public void Dispose() => _stream.Dispose();
+}
+
+/// <summary>
+/// Appends entries to a recording's sidecar index; flushed per fragment so a reader sees
+/// whole fragments only.
+/// </summary>
+public sealed class RecordingIndexWriter : IDisposable
+{
+    private readonly FileStream _stream;
+    private readonly int _timescale;
+    private readonly FrameRate _frameRate;
+    private readonly long _initLength;
+    private int _flags;
+
+    public string Path { get; }
+    public long EntriesWritten { get; private set; }
+
+    public RecordingIndexWriter(string recordingPath, int timescale, FrameRate frameRate, long initLength, bool spliceable)
+    {
+        Path = RecordingIndex.PathFor(recordingPath);
+        _timescale = timescale;
+        _frameRate = frameRate;
+        _initLength = initLength;
+        _flags = spliceable ? RecordingIndex.SpliceableFlag : 0;
+
+        _stream = new FileStream(Path, FileMode.Create, FileAccess.Write, FileShare.Read | FileShare.Delete);
+        WriteHeader();
+    }
+
+    public void Append(ReadOnlySpan<RecordingIndexEntry> entries)
+    {
+        if (entries.IsEmpty)
+            return;
+
+        _stream.Write(MemoryMarshal.AsBytes(entries));
+        _stream.Flush();
+        EntriesWritten += entries.Length;
+    }
+
+    /// <summary>
+    /// Record that a fragment addresses its data absolutely, so clips must be cut from the file.
+    /// </summary>
+    public void MarkNotSpliceable()
+    {
+        if ((_flags & RecordingIndex.SpliceableFlag) == 0)
+            return;
+
+        _flags &= ~RecordingIndex.SpliceableFlag;
+        long position = _stream.Position;
+        _stream.Position = 0;
+        WriteHeader();
+        _stream.Position = position;
+    }
+
+    private void WriteHeader()
+    {
+        Span<byte> header = stackalloc byte[RecordingIndex.HeaderSize];
+        RecordingIndex.WriteHeader(header, _timescale, _frameRate, _initLength, _flags);
+        _stream.Write(header);
+        _stream.Flush();
+    }
+
+    public void Dispose() => _stream.Dispose();
+}
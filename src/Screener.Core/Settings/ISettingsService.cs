@@ -11,6 +11,10 @@ public class AppSettings
     public VideoConnector SelectedConnector { get; set; } = VideoConnector.SDI;
     public string DefaultRecordingPath { get; set; } = string.Empty;
     public bool PreferHardwareEncoding { get; set; } = true;
+    public bool EnableTenBitCapture { get; set; }
+
+    /// <summary>Record multi-input ISOs as uncompressed frames instead of encoding them.</summary>
+    public bool RecordRawIsos { get; set; }
 
     // Streaming
     public bool EnableStreaming { get; set; }
@@ -34,6 +38,15 @@ public class AppSettings
     public int SrtOutputLatency { get; set; } = 120;
     public int SrtOutputBitrate { get; set; } = 5000;
     public string SrtInputsJson { get; set; } = "[]";
+
+    /// <summary>Encode ladder rendition the SRT output is tee'd from; empty = its own encoder.</summary>
+    public string SrtOutputRendition { get; set; } = string.Empty;
+
+    // Encode ladder: JSON array of EncodeRendition, each encoded once for every output routed to it
+    public string EncodeLadderJson { get; set; } = DefaultEncodeLadderJson;
+
+    public const string DefaultEncodeLadderJson =
+        """[{"Name":"program","Width":1920,"Height":1080,"BitrateKbps":6000},{"Name":"stream","Width":1280,"Height":720,"BitrateKbps":2500}]""";
 }
 
 /// <summary>
@@ -24,6 +24,8 @@ public sealed class SettingsService : ISettingsService
         var connectorValue = await _repository.GetAsync(SettingsKeys.SelectedConnector, 1, ct); // Default to SDI (1)
         var recordingPath = await _repository.GetAsync<string>(SettingsKeys.DefaultRecordingPath, ct);
         var preferHardware = await _repository.GetAsync(SettingsKeys.PreferHardwareEncoding, true, ct);
+        var tenBitCapture = await _repository.GetAsync(SettingsKeys.TenBitCapture, false, ct);
+        var rawIsoRecording = await _repository.GetAsync(SettingsKeys.RawIsoRecording, false, ct);
 
         // Streaming
         var enableStreaming = await _repository.GetAsync(SettingsKeys.EnableStreaming, false, ct);
@@ -47,6 +49,10 @@ public sealed class SettingsService : ISettingsService
         var srtOutputLatency = await _repository.GetAsync(SettingsKeys.SrtOutputLatency, 120, ct);
         var srtOutputBitrate = await _repository.GetAsync(SettingsKeys.SrtOutputBitrate, 5000, ct);
         var srtInputsJson = await _repository.GetAsync<string>(SettingsKeys.SrtInputs, ct);
+        var srtOutputRendition = await _repository.GetAsync<string>(SettingsKeys.SrtOutputRendition, ct);
+
+        // Output
+        var encodeLadderJson = await _repository.GetAsync<string>(SettingsKeys.EncodeLadder, ct);
 
         return new AppSettings
         {
@@ -54,6 +60,8 @@ public sealed class SettingsService : ISettingsService
             SelectedConnector = (VideoConnector)connectorValue,
             DefaultRecordingPath = recordingPath ?? Environment.GetFolderPath(Environment.SpecialFolder.MyVideos),
             PreferHardwareEncoding = preferHardware,
+            EnableTenBitCapture = tenBitCapture,
+            RecordRawIsos = rawIsoRecording,
             EnableStreaming = enableStreaming,
             StreamingPort = streamingPort,
             MaxViewers = maxViewers,
@@ -70,7 +78,9 @@ public sealed class SettingsService : ISettingsService
             SrtOutputPort = srtOutputPort,
             SrtOutputLatency = srtOutputLatency,
             SrtOutputBitrate = srtOutputBitrate,
-            SrtInputsJson = srtInputsJson ?? "[]"
+            SrtInputsJson = srtInputsJson ?? "[]",
+            SrtOutputRendition = srtOutputRendition ?? string.Empty,
+            EncodeLadderJson = encodeLadderJson ?? AppSettings.DefaultEncodeLadderJson
         };
     }
 
@@ -80,6 +90,8 @@ public sealed class SettingsService : ISettingsService
         await _repository.SetAsync(SettingsKeys.SelectedConnector, (int)settings.SelectedConnector, ct);
         await _repository.SetAsync(SettingsKeys.DefaultRecordingPath, settings.DefaultRecordingPath, ct);
         await _repository.SetAsync(SettingsKeys.PreferHardwareEncoding, settings.PreferHardwareEncoding, ct);
+        await _repository.SetAsync(SettingsKeys.TenBitCapture, settings.EnableTenBitCapture, ct);
+        await _repository.SetAsync(SettingsKeys.RawIsoRecording, settings.RecordRawIsos, ct);
 
         // Streaming
         await _repository.SetAsync(SettingsKeys.EnableStreaming, settings.EnableStreaming, ct);
@@ -103,6 +115,10 @@ public sealed class SettingsService : ISettingsService
         await _repository.SetAsync(SettingsKeys.SrtOutputLatency, settings.SrtOutputLatency, ct);
         await _repository.SetAsync(SettingsKeys.SrtOutputBitrate, settings.SrtOutputBitrate, ct);
         await _repository.SetAsync(SettingsKeys.SrtInputs, settings.SrtInputsJson, ct);
+        await _repository.SetAsync(SettingsKeys.SrtOutputRendition, settings.SrtOutputRendition, ct);
+
+        // Output
+        await _repository.SetAsync(SettingsKeys.EncodeLadder, settings.EncodeLadderJson, ct);
 
         _logger.LogInformation("Settings saved");
     }
@@ -0,0 +1,82 @@
+using Microsoft.Extensions.Logging;
+using Screener.Abstractions.Encoding;
+
+namespace Screener.Encoding.Pipelines;
+
+/// <summary>
+/// Picks the encoder when the session is initialized, as only the configuration says whether
+/// the in-process engine can take it: <see cref="NativeEncodingPipeline"/> for H.264/HEVC when
+/// it is available, <see cref="EncodingPipeline"/> (FFmpeg) for everything else. Both engines
+/// feed a session's replay buffer, so it does not affect the choice.
+/// </summary>
+public sealed class AutoEncodingPipeline : IEncodingPipeline
+{
+    private readonly Func<NativeEncodingPipeline> _nativeFactory;
+    private readonly Func<EncodingPipeline> _ffmpegFactory;
+    private readonly ILogger<AutoEncodingPipeline> _logger;
+    private IEncodingPipeline? _inner;
+
+    public AutoEncodingPipeline(
+        Func<NativeEncodingPipeline> nativeFactory,
+        Func<EncodingPipeline> ffmpegFactory,
+        ILogger<AutoEncodingPipeline> logger)
+    {
+        _nativeFactory = nativeFactory;
+        _ffmpegFactory = ffmpegFactory;
+        _logger = logger;
+    }
+
+    /// <summary>
+    /// The engine chosen by <see cref="InitializeAsync"/>, or null before it.
+    /// </summary>
+    public IEncodingPipeline? Inner => _inner;
+
+    public EncodingState State => _inner?.State ?? EncodingState.Idle;
+    public EncodingPreset CurrentPreset => _inner?.CurrentPreset ?? EncodingPreset.Medium;
+    public EncodingStatistics Statistics => _inner?.Statistics ?? new EncodingStatistics();
+
+    public event EventHandler<EncodingProgressEventArgs>? Progress;
+    public event EventHandler<EncodingErrorEventArgs>? Error;
+    public event EventHandler<EncodingBackpressureEventArgs>? Backpressure;
+
+    /// <summary>
+    /// The engine a configuration runs on, given whether the native engine can encode it. An
+    /// explicit <see cref="EncodingConfiguration.Engine"/> wins; a replay buffer plays no part.
+    /// </summary>
+    public static EncoderEngine ResolveEngine(EncodingConfiguration config, bool canEncodeNatively) =>
+        config.Engine switch
+        {
+            EncoderEngine.Auto => canEncodeNatively ? EncoderEngine.Native : EncoderEngine.Ffmpeg,
+            var engine => engine
+        };
+
+    public async Task InitializeAsync(EncodingConfiguration config, CancellationToken ct = default)
+    {
+        if (_inner != null)
+            throw new InvalidOperationException($"Cannot initialize in state {_inner.State}");
+
+        bool native = ResolveEngine(config, NativeEncodingPipeline.CanEncode(config)) == EncoderEngine.Native;
+
+        _inner = native ? _nativeFactory() : _ffmpegFactory();
+        _inner.Progress += (_, e) => Progress?.Invoke(this, e);
+        _inner.Error += (_, e) => Error?.Invoke(this, e);
+        _inner.Backpressure += (_, e) => Backpressure?.Invoke(this, e);
+
+        _logger.LogInformation("Encoding {Output} with the {Engine} engine",
+            config.OutputPath, native ? "native" : "FFmpeg");
+
+        await _inner.InitializeAsync(config, ct);
+    }
+
+    public Task<bool> WriteVideoFrameAsync(ReadOnlyMemory<byte> frame, TimeSpan pts, CancellationToken ct = default) =>
+        _inner?.WriteVideoFrameAsync(frame, pts, ct) ?? Task.FromResult(false);
+
+    public Task<bool> WriteAudioSamplesAsync(ReadOnlyMemory<byte> samples, TimeSpan pts, CancellationToken ct = default) =>
+        _inner?.WriteAudioSamplesAsync(samples, pts, ct) ?? Task.FromResult(false);
+
+    public Task FinalizeAsync(CancellationToken ct = default) =>
+        _inner?.FinalizeAsync(ct) ?? Task.CompletedTask;
+
+    public ValueTask DisposeAsync() =>
+        _inner?.DisposeAsync() ?? ValueTask.CompletedTask;
+}
@@ -0,0 +1,393 @@
+using System.Diagnostics;
+using System.IO.Pipes;
+using Microsoft.Extensions.Logging;
+using Screener.Abstractions.Capture;
+using Screener.Abstractions.Encoding;
+using Screener.Abstractions.Output;
+using Screener.Core.Native;
+using Screener.Encoding.Codecs;
+
+namespace Screener.Encoding.Pipelines;
+
+/// <summary>
+/// Encodes the program feed once per rendition in a single FFmpeg process and fans the packets
+/// out with the tee muxer, so SRT, RTMP and a program recording fed from the same rendition
+/// share one encoder session instead of each running their own.
+/// </summary>
+public sealed class EncodeTee : IEncodeTee
+{
+    private readonly ILogger<EncodeTee> _logger;
+    private readonly HardwareAccelerator _hwAccel;
+    private readonly object _frameLock = new();
+
+    private Process? _ffmpegProcess;
+    private NamedPipeServerStream? _videoPipe;
+    private string? _videoPipePath;
+    private Stream? _videoInputStream;
+    private FramePipeWriter? _frameWriter;
+    private VideoMode? _mode;
+    private bool _convertToNv12;
+    private int _frameSize;
+    private TimeSpan _stallBudget;
+
+    private long _framesPushed;
+    private long _droppedFrames;
+    private bool _inBackpressure;
+
+    // Raw frames queued ahead of FFmpeg; fewer than a recording because this feeds live outputs
+    private const int QueueBytes = 64 * 1024 * 1024;
+    private const int MaxPipeBufferBytes = 32 * 1024 * 1024;
+
+    public EncodeTee(ILogger<EncodeTee> logger, HardwareAccelerator hwAccel)
+    {
+        _logger = logger;
+        _hwAccel = hwAccel;
+    }
+
+    public bool IsRunning => _ffmpegProcess is { HasExited: false } && _frameWriter?.Fault == null;
+    public long FramesPushed => Interlocked.Read(ref _framesPushed);
+    public long DroppedFrames => Interlocked.Read(ref _droppedFrames);
+
+    public async Task StartAsync(VideoMode mode, IReadOnlyList<EncodeRendition> ladder, IReadOnlyList<TeeTarget> targets, CancellationToken ct = default)
+    {
+        if (_ffmpegProcess != null)
+            await StopAsync(ct);
+
+        var renditions = ResolveRenditions(ladder, targets);
+        if (renditions.Count == 0)
+        {
+            _logger.LogInformation("No encode ladder rendition has a target; nothing to encode");
+            return;
+        }
+
+        _mode = mode;
+        bool isV210 = mode.PixelFormat == PixelFormat.YUV422_10bit;
+        _convertToNv12 = !isV210 && IsUyvy(mode.PixelFormat) && MediaKernels.IsAvailable && mode.Width % 2 == 0;
+        _frameSize = _convertToNv12 ? MediaKernels.Nv12FrameSize(mode.Width, mode.Height) : EncodingPipeline.EstimateFrameSize(mode);
+
+        try
+        {
+            if (OperatingSystem.IsWindows())
+            {
+                var pipeName = $"screener-tee-{Guid.NewGuid():N}";
+                _videoPipePath = $@"\\.\pipe\{pipeName}";
+                _videoPipe = new NamedPipeServerStream(pipeName, PipeDirection.Out, 1, PipeTransmissionMode.Byte,
+                    PipeOptions.Asynchronous, inBufferSize: 0, outBufferSize: Math.Min(_frameSize, MaxPipeBufferBytes));
+            }
+
+            var arguments = BuildArguments(mode, renditions);
+            _logger.LogInformation("Starting encode tee: {Renditions} rendition(s), {Targets} target(s): {Args}",
+                renditions.Count, renditions.Sum(r => r.Slaves.Count), arguments);
+
+            _ffmpegProcess = new Process
+            {
+                StartInfo = new ProcessStartInfo
+                {
+                    FileName = EncodingPipeline.FindFfmpegPath(),
+                    Arguments = arguments,
+                    UseShellExecute = false,
+                    CreateNoWindow = true,
+                    RedirectStandardInput = _videoPipe == null,
+                    RedirectStandardError = true
+                },
+                EnableRaisingEvents = true
+            };
+
+            _ffmpegProcess.ErrorDataReceived += OnFfmpegErrorData;
+            _ffmpegProcess.Start();
+            _ffmpegProcess.BeginErrorReadLine();
+
+            if (_videoPipe != null)
+            {
+                using var connectTimeout = CancellationTokenSource.CreateLinkedTokenSource(ct);
+                connectTimeout.CancelAfter(TimeSpan.FromSeconds(10));
+                try
+                {
+                    await _videoPipe.WaitForConnectionAsync(connectTimeout.Token);
+                }
+                catch (OperationCanceledException) when (!ct.IsCancellationRequested)
+                {
+                    throw new TimeoutException("FFmpeg did not open the video pipe");
+                }
+
+                _videoInputStream = _videoPipe;
+            }
+            else
+            {
+                _videoInputStream = _ffmpegProcess.StandardInput.BaseStream;
+            }
+
+            int capacity = Math.Clamp(QueueBytes / _frameSize, 2, 8);
+            _frameWriter = new FramePipeWriter(_videoInputStream, _frameSize, capacity, _logger);
+            _stallBudget = TimeSpan.FromSeconds(1.0 / mode.FrameRate.Value);
+        }
+        catch (Exception ex)
+        {
+            _logger.LogError(ex, "Failed to start encode tee");
+            await DisposeAsync();
+            throw;
+        }
+    }
+
+    public async Task<bool> PushFrameAsync(ReadOnlyMemory<byte> frameData, TimeSpan timestamp, CancellationToken ct = default)
+    {
+        var writer = _frameWriter;
+        var mode = _mode;
+        if (writer == null || mode == null)
+            return false;
+
+        try
+        {
+            // Live outputs would rather skip a frame than add latency: wait at most one frame interval
+            if (!writer.HasSpace && !await writer.WaitForSpaceAsync(_stallBudget, ct))
+            {
+                Interlocked.Increment(ref _droppedFrames);
+                if (!_inBackpressure)
+                {
+                    _inBackpressure = true;
+                    _logger.LogWarning("Encode tee is falling behind ({Queued}/{Capacity} frames queued); dropping frames",
+                        writer.QueuedFrames, writer.Capacity);
+                }
+                return false;
+            }
+
+            lock (_frameLock)
+            {
+                var frame = writer.Rent(_frameSize);
+                if (_convertToNv12)
+                {
+                    MediaKernels.ConvertUyvyToNv12(frameData.Span, frameData.Length / mode.Height,
+                        frame.Span, mode.Width, mode.Height);
+                }
+                else
+                {
+                    frameData.Span[..Math.Min(frameData.Length, _frameSize)].CopyTo(frame.Span);
+                }
+
+                if (!writer.TryEnqueue(frame))
+                {
+                    Interlocked.Increment(ref _droppedFrames);
+                    return false;
+                }
+            }
+
+            if (_inBackpressure)
+            {
+                _inBackpressure = false;
+                _logger.LogInformation("Encode tee caught up after {Dropped} dropped frames", DroppedFrames);
+            }
+
+            Interlocked.Increment(ref _framesPushed);
+            return true;
+        }
+        catch (IOException ex)
+        {
+            Interlocked.Increment(ref _droppedFrames);
+            _logger.LogDebug(ex, "Encode tee pipe is closed");
+            return false;
+        }
+    }
+
+    public async Task StopAsync(CancellationToken ct = default)
+    {
+        if (_ffmpegProcess == null)
+            return;
+
+        try
+        {
+            if (_frameWriter != null)
+                await _frameWriter.CompleteAsync(ct);
+
+            // Closing the input lets FFmpeg flush every encoder and write the muxer trailers
+            if (_videoInputStream != null)
+                await _videoInputStream.DisposeAsync();
+            _videoInputStream = null;
+
+            if (!await Task.Run(() => _ffmpegProcess.WaitForExit(10000), ct))
+            {
+                _logger.LogWarning("Encode tee FFmpeg did not exit in time; killing it");
+                _ffmpegProcess.Kill();
+            }
+
+            _logger.LogInformation("Encode tee stopped: {Pushed} frames encoded, {Dropped} dropped",
+                FramesPushed, DroppedFrames);
+        }
+        catch (Exception ex)
+        {
+            _logger.LogError(ex, "Error stopping encode tee");
+        }
+        finally
+        {
+            await DisposeAsync();
+        }
+    }
+
+    // Renditions something wants, each with its tee-muxer slaves
+    private List<(EncodeRendition Rendition, List<string> Slaves)> ResolveRenditions(
+        IReadOnlyList<EncodeRendition> ladder, IReadOnlyList<TeeTarget> targets)
+    {
+        var result = new List<(EncodeRendition, List<string>)>();
+
+        foreach (var rendition in ladder)
+        {
+            var routed = targets
+                .Where(t => t.Rendition.Equals(rendition.Name, StringComparison.OrdinalIgnoreCase))
+                .ToList();
+            var staticTargets = rendition.Targets?.Where(t => !string.IsNullOrWhiteSpace(t)).ToList() ?? [];
+            if (routed.Count == 0 && staticTargets.Count == 0)
+                continue;
+
+            if (rendition.Codec != VideoCodec.H264 && rendition.Codec != VideoCodec.H265)
+            {
+                _logger.LogWarning("Encode ladder rendition {Name} uses {Codec}; only H.264/H.265 can be tee'd to live outputs",
+                    rendition.Name, rendition.Codec);
+                continue;
+            }
+
+            var slaves = routed.Select(FormatSlave).ToList();
+            slaves.AddRange(staticTargets);
+
+            result.Add((rendition, slaves));
+        }
+
+        foreach (var target in targets.Where(t => !ladder.Any(r => r.Name.Equals(t.Rendition, StringComparison.OrdinalIgnoreCase))))
+            _logger.LogWarning("Target {Url} asks for rendition {Name}, which is not in the encode ladder", target.Url, target.Rendition);
+
+        return result;
+    }
+
+    // onfail=ignore keeps the other outputs running when one destination drops
+    private static string FormatSlave(TeeTarget target)
+    {
+        var options = string.IsNullOrEmpty(target.Options) ? string.Empty : ":" + target.Options;
+        return $"[f={target.Format}:onfail=ignore{options}]{target.Url.Replace("|", @"\|")}";
+    }
+
+    private string BuildArguments(VideoMode mode, List<(EncodeRendition Rendition, List<string> Slaves)> renditions)
+    {
+        var inputFormat = _convertToNv12 ? "-f rawvideo -pix_fmt nv12"
+            : mode.PixelFormat == PixelFormat.YUV422_10bit ? "-f v210"
+            : mode.PixelFormat is PixelFormat.BGRA or PixelFormat.BGRA8 ? "-f rawvideo -pix_fmt bgra"
+            : "-f rawvideo -pix_fmt uyvy422";
+
+        var args = new List<string>
+        {
+            "-y",
+            inputFormat,
+            $"-s {mode.Width}x{mode.Height}",
+            $"-r {mode.FrameRate.Value:F2}",
+            _videoPipePath != null ? $"-i \"{_videoPipePath}\"" : "-i pipe:0"
+        };
+
+        if (_videoPipePath != null)
+            args.Insert(0, "-nostdin");
+
+        // One decode of the input, split and scaled per rendition inside FFmpeg
+        var encoders = renditions.Select(r => _hwAccel.GetEncoderName(r.Rendition.Codec, HardwareAcceleration.Auto)).ToList();
+        var filter = new List<string> { $"[0:v]split={renditions.Count}" + string.Concat(renditions.Select((_, i) => $"[in{i}]")) };
+        for (int i = 0; i < renditions.Count; i++)
+        {
+            var r = renditions[i].Rendition;
+            var pixelFormat = IsHardwareEncoder(encoders[i]) ? "nv12" : "yuv420p";
+            filter.Add($"[in{i}]scale={r.Width}:{r.Height},format={pixelFormat}[v{i}]");
+        }
+        args.Add($"-filter_complex \"{string.Join(";", filter)}\"");
+
+        for (int i = 0; i < renditions.Count; i++)
+        {
+            var (rendition, slaves) = renditions[i];
+            var encoder = encoders[i];
+            int kbps = rendition.BitrateKbps;
+            int gop = rendition.GopFrames > 0 ? rendition.GopFrames : (int)Math.Round(mode.FrameRate.Value * 2);
+
+            args.Add($"-map \"[v{i}]\"");
+            args.Add($"-c:v {encoder}");
+
+            // Constant bitrate with a one-second-ish buffer: these feed network outputs
+            if (encoder.Contains("nvenc"))
+                args.Add($"-preset p4 -tune ll -rc cbr");
+            else if (encoder.Contains("qsv"))
+                args.Add($"-preset veryfast");
+            else if (encoder.Contains("amf"))
+                args.Add($"-usage lowlatency -rc cbr");
+            else
+                args.Add($"-preset veryfast -tune zerolatency");
+
+            args.Add($"-b:v {kbps}k -maxrate {kbps}k -bufsize {kbps * 2}k");
+            args.Add($"-g {gop}");
+
+            // Containers like MP4/FLV need the parameter sets out of band; MPEG-TS slaves
+            // get them back in-band from FFmpeg's automatic Annex B filter
+            if (slaves.Any(s => !s.StartsWith("[f=mpegts", StringComparison.OrdinalIgnoreCase)))
+                args.Add("-flags:v +global_header");
+
+            args.Add("-an");
+            args.Add($"-f tee \"{string.Join("|", slaves)}\"");
+        }
+
+        return string.Join(" ", args);
+    }
+
+    private static bool IsUyvy(PixelFormat format) =>
+        format == PixelFormat.UYVY || format == PixelFormat.YUV422_8bit;
+
+    private static bool IsHardwareEncoder(string encoder) =>
+        encoder.Contains("nvenc") || encoder.Contains("qsv") || encoder.Contains("amf");
+
+    private void OnFfmpegErrorData(object sender, DataReceivedEventArgs e)
+    {
+        if (string.IsNullOrEmpty(e.Data)) return;
+
+        if (e.Data.Contains("error", StringComparison.OrdinalIgnoreCase) ||
+            e.Data.Contains("Slave", StringComparison.Ordinal))
+            _logger.LogWarning("Encode tee FFmpeg: {Data}", e.Data);
+        else
+            _logger.LogDebug("Encode tee FFmpeg: {Data}", e.Data);
+    }
+
+    public async ValueTask DisposeAsync()
+    {
+        if (_videoInputStream != null)
+        {
+            try
+            {
+                await _videoInputStream.DisposeAsync();
+            }
+            catch { }
+            _videoInputStream = null;
+        }
+
+        if (_videoPipe != null)
+        {
+            try
+            {
+                await _videoPipe.DisposeAsync();
+            }
+            catch { }
+            _videoPipe = null;
+        }
+
+        if (_frameWriter != null)
+        {
+            await _frameWriter.DisposeAsync();
+            _frameWriter = null;
+        }
+
+        if (_ffmpegProcess != null)
+        {
+            if (!_ffmpegProcess.HasExited)
+            {
+                try
+                {
+                    _ffmpegProcess.Kill();
+                }
+                catch { }
+            }
+            _ffmpegProcess.Dispose();
+            _ffmpegProcess = null;
+        }
+
+        _videoPipePath = null;
+        _mode = null;
+    }
+}
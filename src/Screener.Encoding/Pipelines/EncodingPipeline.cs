@@ -2,7 +2,9 @@ using System.Diagnostics;
 using System.IO.Pipes;
 using Microsoft.Extensions.Logging;
 using Screener.Abstractions.Capture;
+using Screener.Abstractions.Clipping;
 using Screener.Abstractions.Encoding;
+using Screener.Core.Native;
 using Screener.Encoding.Codecs;
 
 namespace Screener.Encoding.Pipelines;
@@ -22,6 +24,45 @@ public sealed class EncodingPipeline : IEncodingPipeline
     private CancellationTokenSource? _cts;
     private Task? _monitorTask;
 
+    // Named pipe FFmpeg reads video from (null when it reads stdin)
+    private NamedPipeServerStream? _videoPipe;
+    private string? _videoPipePath;
+
+    // Second tee output: the same packets as MPEG-TS into the replay buffer
+    private NamedPipeServerStream? _replayPipe;
+    private string? _replayPipePath;
+    private Task? _replayTask;
+
+    // Frames are converted straight into pooled queue buffers and written by a background task,
+    // so a slow encoder shows up as a full queue instead of a blocked capture callback
+    private FramePipeWriter? _frameWriter;
+    private readonly object _frameLock = new();
+    private TimeSpan _stallBudget;
+
+    // When set, UYVY frames are converted to NV12 in-process before being piped to FFmpeg
+    private bool _convertToNv12;
+
+    // When set, v210 frames are converted to P010 in-process, keeping all 10 bits
+    private bool _convertToP010;
+
+    // Size of an NV12/P010 frame, 0 when frames are piped as captured
+    private int _convertedFrameSize;
+
+    // When set, the overlay is composited into the queued copy before it is written (or into
+    // _overlayBuffer ahead of conversion): the capture ring slot is shared with preview and
+    // detection, so it is never written
+    private IVideoOverlay? _overlay;
+    private byte[]? _overlayBuffer;
+
+    // Raw video queued ahead of FFmpeg, split into 4..32 frames by frame size
+    private const int QueueBytes = 128 * 1024 * 1024;
+
+    // Named pipe buffer, enough for a 2160p UYVY frame without exhausting nonpaged pool
+    private const int MaxPipeBufferBytes = 32 * 1024 * 1024;
+
+    // Replay pipe reads; a few frames of compressed video
+    private const int ReplayReadBytes = 1024 * 1024;
+
     private EncodingState _state = EncodingState.Idle;
     private EncodingPreset _currentPreset = EncodingPreset.Medium;
     private readonly EncodingStatistics _statistics = new();
@@ -29,6 +70,10 @@ public sealed class EncodingPipeline : IEncodingPipeline
     private long _bytesWritten;
     private DateTime _startTime;
     private int _droppedFrames;
+    private int _backpressureDroppedFrames;
+    private int _stalledFrames;
+    private bool _inBackpressure;
+    private long _lastBackpressureTicks;
 
     public EncodingState State => _state;
     public EncodingPreset CurrentPreset => _currentPreset;
@@ -37,11 +82,16 @@ public sealed class EncodingPipeline : IEncodingPipeline
         FramesEncoded = _framesEncoded,
         BytesWritten = _bytesWritten,
         Duration = _startTime != default ? DateTime.UtcNow - _startTime : TimeSpan.Zero,
-        DroppedFrames = _droppedFrames
+        DroppedFrames = _droppedFrames,
+        BackpressureDroppedFrames = _backpressureDroppedFrames,
+        StalledFrames = _stalledFrames,
+        QueuedFrames = _frameWriter?.QueuedFrames ?? 0,
+        PeakQueuedFrames = _frameWriter?.PeakQueuedFrames ?? 0
     };
 
     public event EventHandler<EncodingProgressEventArgs>? Progress;
     public event EventHandler<EncodingErrorEventArgs>? Error;
+    public event EventHandler<EncodingBackpressureEventArgs>? Backpressure;
 
     public EncodingPipeline(ILogger<EncodingPipeline> logger, HardwareAccelerator hwAccel)
     {
@@ -61,6 +111,42 @@ public sealed class EncodingPipeline : IEncodingPipeline
         try
         {
             var ffmpegPath = FindFfmpegPath();
+
+            // H.264/H.265 are encoded 4:2:0: do the 4:2:2 -> 4:2:0 step with the SIMD
+            // kernels instead of FFmpeg's swscale when the native DLL is available
+            var mode = config.VideoMode;
+            bool isV210 = mode.PixelFormat == PixelFormat.YUV422_10bit;
+            _convertToNv12 = IsFourTwoZeroCodec(config.Preset.VideoCodec) && !isV210 && MediaKernels.IsAvailable && mode.Width % 2 == 0;
+
+            // FFmpeg has no raw v210 pixel format for 4:2:0 encoders, so 10-bit capture is always
+            // packed to P010 here (the managed fallback is slower but produces the same output)
+            _convertToP010 = IsFourTwoZeroCodec(config.Preset.VideoCodec) && isV210 && mode.Width % 2 == 0;
+
+            _convertedFrameSize = _convertToNv12 ? MediaKernels.Nv12FrameSize(mode.Width, mode.Height)
+                : _convertToP010 ? MediaKernels.P010FrameSize(mode.Width, mode.Height)
+                : 0;
+
+            _overlay = config.Overlay != null && config.Overlay.Supports(mode) ? config.Overlay : null;
+            if (config.Overlay != null && _overlay == null)
+                _logger.LogInformation("Overlay does not support {Format} frames; encoding without it", mode.PixelFormat);
+
+            int frameSize = _convertedFrameSize > 0 ? _convertedFrameSize : EstimateFrameSize(mode);
+            if (config.Transport == VideoTransport.NamedPipe && OperatingSystem.IsWindows())
+            {
+                var pipeName = $"screener-video-{Guid.NewGuid():N}";
+                _videoPipePath = $@"\\.\pipe\{pipeName}";
+                _videoPipe = new NamedPipeServerStream(pipeName, PipeDirection.Out, 1, PipeTransmissionMode.Byte,
+                    PipeOptions.Asynchronous, inBufferSize: 0, outBufferSize: Math.Min(frameSize, MaxPipeBufferBytes));
+            }
+
+            if (config.Replay != null && OperatingSystem.IsWindows())
+            {
+                var pipeName = $"screener-replay-{Guid.NewGuid():N}";
+                _replayPipePath = $@"\\.\pipe\{pipeName}";
+                _replayPipe = new NamedPipeServerStream(pipeName, PipeDirection.In, 1, PipeTransmissionMode.Byte,
+                    PipeOptions.Asynchronous, inBufferSize: ReplayReadBytes, outBufferSize: 0);
+            }
+
             var arguments = BuildFfmpegArguments(config);
 
             _logger.LogInformation("Starting FFmpeg with arguments: {Args}", arguments);
@@ -73,7 +159,7 @@ public sealed class EncodingPipeline : IEncodingPipeline
                     Arguments = arguments,
                     UseShellExecute = false,
                     CreateNoWindow = true,
-                    RedirectStandardInput = true,
+                    RedirectStandardInput = _videoPipe == null,
                     RedirectStandardOutput = true,
                     RedirectStandardError = true
                 },
@@ -84,11 +170,36 @@ public sealed class EncodingPipeline : IEncodingPipeline
             _ffmpegProcess.Start();
             _ffmpegProcess.BeginErrorReadLine();
 
-            _videoInputStream = _ffmpegProcess.StandardInput.BaseStream;
+            if (_videoPipe != null)
+            {
+                // FFmpeg opens its inputs before anything else; a process that never connects failed to start
+                using var connectTimeout = CancellationTokenSource.CreateLinkedTokenSource(ct);
+                connectTimeout.CancelAfter(TimeSpan.FromSeconds(10));
+                try
+                {
+                    await _videoPipe.WaitForConnectionAsync(connectTimeout.Token);
+                }
+                catch (OperationCanceledException) when (!ct.IsCancellationRequested)
+                {
+                    throw new TimeoutException("FFmpeg did not open the video pipe");
+                }
+
+                _videoInputStream = _videoPipe;
+            }
+            else
+            {
+                _videoInputStream = _ffmpegProcess.StandardInput.BaseStream;
+            }
+
+            int capacity = Math.Clamp(QueueBytes / frameSize, 4, 32);
+            _frameWriter = new FramePipeWriter(_videoInputStream, frameSize, capacity, _logger);
+            _stallBudget = TimeSpan.FromSeconds(1.0 / mode.FrameRate.Value);
             _startTime = DateTime.UtcNow;
 
             _cts = new CancellationTokenSource();
             _monitorTask = MonitorFfmpegAsync(_cts.Token);
+            if (_replayPipe != null)
+                _replayTask = PumpReplayAsync(_replayPipe, config.Replay!, _cts.Token);
 
             _state = EncodingState.Encoding;
             _logger.LogInformation("Encoding started: {Output}", config.OutputPath);
@@ -109,12 +220,41 @@ public sealed class EncodingPipeline : IEncodingPipeline
 
     public async Task<bool> WriteVideoFrameAsync(ReadOnlyMemory<byte> frame, TimeSpan pts, CancellationToken ct = default)
     {
-        if (_state != EncodingState.Encoding || _videoInputStream == null)
+        var writer = _frameWriter;
+        if (_state != EncodingState.Encoding || writer == null)
             return false;
 
         try
         {
-            await _videoInputStream.WriteAsync(frame, ct);
+            // Give the encoder one frame interval to free a slot before refusing the frame
+            bool stalled = !writer.HasSpace;
+            if (stalled && !await writer.WaitForSpaceAsync(_stallBudget, ct))
+            {
+                OnBackpressure(writer);
+                return false;
+            }
+
+            lock (_frameLock)
+            {
+                var queued = writer.Rent(_convertedFrameSize > 0 ? _convertedFrameSize : frame.Length);
+                FillFrame(frame.Span, queued.Span);
+                if (!writer.TryEnqueue(queued))
+                {
+                    OnBackpressure(writer);
+                    return false;
+                }
+            }
+
+            if (stalled)
+            {
+                Interlocked.Increment(ref _stalledFrames);
+            }
+            else if (_inBackpressure)
+            {
+                _inBackpressure = false;
+                _logger.LogInformation("Encoder caught up after {Dropped} frames were refused", _backpressureDroppedFrames);
+            }
+
             _framesEncoded++;
 
             if (_framesEncoded % 30 == 0)
@@ -132,6 +272,69 @@ public sealed class EncodingPipeline : IEncodingPipeline
         }
     }
 
+    // Copy, composite and convert the captured frame into its queue buffer in one pass
+    private void FillFrame(ReadOnlySpan<byte> source, Span<byte> destination)
+    {
+        var mode = _config!.VideoMode;
+        int rowBytes = source.Length / mode.Height;
+
+        if (_overlay != null)
+        {
+            if (_convertedFrameSize == 0)
+            {
+                source.CopyTo(destination);
+                _overlay.Apply(destination, rowBytes, mode);
+                return;
+            }
+
+            if (_overlayBuffer == null || _overlayBuffer.Length != source.Length)
+                _overlayBuffer = new byte[source.Length];
+
+            source.CopyTo(_overlayBuffer);
+            _overlay.Apply(_overlayBuffer, rowBytes, mode);
+            source = _overlayBuffer;
+        }
+
+        if (_convertToNv12)
+            MediaKernels.ConvertUyvyToNv12(source, rowBytes, destination, mode.Width, mode.Height);
+        else if (_convertToP010)
+            MediaKernels.ConvertV210ToP010(source, rowBytes, destination, mode.Width, mode.Height);
+        else
+            source.CopyTo(destination);
+    }
+
+    private void OnBackpressure(FramePipeWriter writer)
+    {
+        int dropped = Interlocked.Increment(ref _backpressureDroppedFrames);
+
+        if (!_inBackpressure)
+        {
+            _inBackpressure = true;
+            _logger.LogWarning("Encoder is falling behind ({Queued}/{Capacity} frames queued); refusing frames",
+                writer.QueuedFrames, writer.Capacity);
+        }
+
+        // At most once a second while the encoder stays behind
+        long now = Environment.TickCount64;
+        if (now - _lastBackpressureTicks < 1000)
+            return;
+
+        _lastBackpressureTicks = now;
+        Backpressure?.Invoke(this, new EncodingBackpressureEventArgs
+        {
+            QueuedFrames = writer.QueuedFrames,
+            QueueCapacity = writer.Capacity,
+            DroppedFrames = dropped
+        });
+    }
+
+    internal static int EstimateFrameSize(VideoMode mode) => mode.PixelFormat switch
+    {
+        PixelFormat.YUV422_10bit => (mode.Width + 47) / 48 * 128 * mode.Height,
+        PixelFormat.BGRA or PixelFormat.BGRA8 or PixelFormat.RGBA8 => mode.Width * mode.Height * 4,
+        _ => mode.Width * mode.Height * 2
+    };
+
     public async Task<bool> WriteAudioSamplesAsync(ReadOnlyMemory<byte> samples, TimeSpan pts, CancellationToken ct = default)
     {
         // In a real implementation with separate audio pipe
@@ -149,13 +352,18 @@ public sealed class EncodingPipeline : IEncodingPipeline
 
         try
         {
-            // Close input stream to signal end of data
-            if (_videoInputStream != null)
+            // Write out the queue, then close the input to signal end of data
+            if (_frameWriter != null)
+                await _frameWriter.CompleteAsync(ct);
+
+            if (_videoPipe?.IsConnected == true && _frameWriter?.Fault == null)
             {
-                await _videoInputStream.FlushAsync(ct);
-                _videoInputStream.Close();
+                // Closing the server end discards whatever FFmpeg has not read yet
+                await Task.Run(_videoPipe.WaitForPipeDrain, ct);
             }
 
+            _videoInputStream?.Close();
+
             // Wait for FFmpeg to finish
             if (_ffmpegProcess != null)
             {
@@ -168,6 +376,12 @@ public sealed class EncodingPipeline : IEncodingPipeline
                 }
             }
 
+            // FFmpeg has closed the replay pipe by now; let the last packets reach the buffer
+            if (_replayTask != null)
+            {
+                try { await _replayTask.WaitAsync(TimeSpan.FromSeconds(5), ct); } catch { }
+            }
+
             _cts?.Cancel();
             if (_monitorTask != null)
             {
@@ -197,21 +411,41 @@ public sealed class EncodingPipeline : IEncodingPipeline
         var mode = config.VideoMode;
         var preset = config.Preset;
         var encoder = _hwAccel.GetEncoderName(preset.VideoCodec, config.HwAccel);
+        bool isV210 = mode.PixelFormat == PixelFormat.YUV422_10bit;
+
+        // DeckLink format, or converted in-process. ProRes/DNxHD read v210 through FFmpeg's v210 demuxer.
+        var inputFormat = _convertToNv12 ? "-f rawvideo -pix_fmt nv12"
+            : _convertToP010 ? "-f rawvideo -pix_fmt p010le"
+            : isV210 ? "-f v210"
+            : "-f rawvideo -pix_fmt uyvy422";
 
         var args = new List<string>
         {
             "-y", // Overwrite output
-            "-f rawvideo",
-            $"-pix_fmt uyvy422", // DeckLink format
+            inputFormat,
             $"-s {mode.Width}x{mode.Height}",
             $"-r {mode.FrameRate.Value:F2}",
-            "-i pipe:0", // Video from stdin
+            _videoPipePath != null ? $"-i \"{_videoPipePath}\"" : "-i pipe:0",
         };
 
+        // Video comes from the named pipe, so keep FFmpeg from reading keystrokes off stdin
+        if (_videoPipePath != null)
+            args.Insert(0, "-nostdin");
+
         // Video encoding settings
         // Convert 4:2:2 input to 4:2:0 for h264/h265 compatibility (high profile doesn't support 4:2:2)
-        if (preset.VideoCodec == VideoCodec.H264 || preset.VideoCodec == VideoCodec.H265)
+        // Hardware encoders take NV12 directly, so only software encoders need the planar format
+        bool hardwareEncoder = encoder.Contains("nvenc") || encoder.Contains("qsv") || encoder.Contains("amf");
+        bool tenBitHevc = _convertToP010 && preset.VideoCodec == VideoCodec.H265;
+        if (tenBitHevc)
+        {
+            // NVENC/QSV hevc take P010 directly; software x265 wants planar 10-bit
+            if (!encoder.Contains("nvenc") && !encoder.Contains("qsv"))
+                args.Add("-pix_fmt yuv420p10le");
+        }
+        else if (IsFourTwoZeroCodec(preset.VideoCodec) && (!_convertToNv12 || !hardwareEncoder))
         {
+            // 10-bit into H.264 is also reduced to 8-bit 4:2:0 here (High profile is 8-bit only)
             args.Add("-pix_fmt yuv420p");
         }
 
@@ -241,7 +475,7 @@ public sealed class EncodingPipeline : IEncodingPipeline
                 args.Add($"-bufsize {preset.VideoBitrateMbps * 2}M");
             }
 
-            args.Add($"-profile:v {preset.Profile}");
+            args.Add($"-profile:v {(tenBitHevc ? "main10" : preset.Profile)}");
         }
 
         // Audio encoding
@@ -249,20 +483,47 @@ public sealed class EncodingPipeline : IEncodingPipeline
         args.Add($"-b:a {preset.AudioBitrateKbps}k");
 
         // Output format
-        if (config.UseFragmentedMp4)
+        var movflags = config.UseFragmentedMp4 ? "+frag_keyframe+empty_moov+default_base_moof" : "+faststart";
+
+        if (_replayPipePath != null)
         {
-            args.Add("-movflags +frag_keyframe+empty_moov+default_base_moof");
+            // Encode once, mux twice: the recording, and MPEG-TS for the replay buffer. The replay
+            // output may fail on its own without stopping the recording.
+            args.Add("-flags:v +global_header");
+            args.Add($"-f tee \"[f=mp4:movflags={movflags}]{config.OutputPath}|[f=mpegts:onfail=ignore]{_replayPipePath}\"");
         }
         else
         {
-            args.Add("-movflags +faststart");
+            args.Add($"-movflags {movflags}");
+            args.Add($"\"{config.OutputPath}\"");
         }
 
-        args.Add($"\"{config.OutputPath}\"");
-
         return string.Join(" ", args);
     }
 
+    private static bool IsFourTwoZeroCodec(VideoCodec codec) =>
+        codec == VideoCodec.H264 || codec == VideoCodec.H265;
+
+    private async Task PumpReplayAsync(NamedPipeServerStream pipe, IReplayBuffer replay, CancellationToken ct)
+    {
+        try
+        {
+            await pipe.WaitForConnectionAsync(ct);
+
+            var buffer = new byte[ReplayReadBytes];
+            int read;
+            while ((read = await pipe.ReadAsync(buffer, ct)) > 0)
+                replay.Append(buffer.AsSpan(0, read));
+        }
+        catch (OperationCanceledException)
+        {
+        }
+        catch (IOException ex)
+        {
+            _logger.LogWarning(ex, "Replay buffer pipe closed; clips will be cut from the recording file");
+        }
+    }
+
     private void OnFfmpegErrorData(object sender, DataReceivedEventArgs e)
     {
         if (string.IsNullOrEmpty(e.Data)) return;
@@ -316,7 +577,7 @@ public sealed class EncodingPipeline : IEncodingPipeline
         });
     }
 
-    private static string FindFfmpegPath()
+    internal static string FindFfmpegPath()
     {
         // Check common locations
         var paths = new[]
@@ -374,6 +635,19 @@ public sealed class EncodingPipeline : IEncodingPipeline
             catch { }
         }
 
+        if (_replayPipe != null)
+        {
+            try
+            {
+                await _replayPipe.DisposeAsync();
+            }
+            catch { }
+        }
+
+        // After the stream, so a write blocked on a stalled FFmpeg fails instead of hanging
+        if (_frameWriter != null)
+            await _frameWriter.DisposeAsync();
+
         if (_ffmpegProcess != null)
         {
             if (!_ffmpegProcess.HasExited)
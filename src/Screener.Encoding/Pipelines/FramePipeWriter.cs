@@ -0,0 +1,150 @@
+using System.Threading.Channels;
+using Microsoft.Extensions.Logging;
+using Screener.Core.Buffers;
+
+namespace Screener.Encoding.Pipelines;
+
+/// <summary>
+/// Decouples the capture thread from the FFmpeg pipe: frames are copied (or converted) into
+/// pooled buffers, queued, and written by a single background writer. A full queue means the
+/// encoder is behind, which callers see as backpressure rather than a failed write.
+/// </summary>
+internal sealed class FramePipeWriter : IAsyncDisposable
+{
+    private readonly Stream _output;
+    private readonly ILogger _logger;
+    private readonly Channel<PooledFrame> _queue;
+    private readonly VideoFramePool _pool;
+    private readonly Task _drainTask;
+
+    private int _queued;
+    private int _peakQueued;
+    private Exception? _fault;
+
+    public FramePipeWriter(Stream output, int frameSize, int capacity, ILogger logger)
+    {
+        _output = output;
+        _logger = logger;
+        Capacity = capacity;
+
+        // Queued frames plus the one being written and the one being filled
+        _pool = new VideoFramePool(capacity + 2, frameSize);
+        _queue = Channel.CreateBounded<PooledFrame>(new BoundedChannelOptions(capacity)
+        {
+            SingleReader = true,
+            FullMode = BoundedChannelFullMode.Wait
+        });
+
+        _drainTask = Task.Run(DrainAsync);
+    }
+
+    public int Capacity { get; }
+    /// <summary>Frames queued or being written.</summary>
+    public int QueuedFrames => Volatile.Read(ref _queued);
+    public int PeakQueuedFrames => Volatile.Read(ref _peakQueued);
+
+    /// <summary>
+    /// Set when the writer stopped because the pipe failed (FFmpeg exited or the pipe broke).
+    /// </summary>
+    public Exception? Fault => _fault;
+
+    public bool HasSpace => _fault == null && _queue.Reader.Count < Capacity;
+
+    /// <summary>
+    /// Wait up to budget for a free queue slot. False if the queue stayed full; throws if the
+    /// pipe has failed.
+    /// </summary>
+    public async ValueTask<bool> WaitForSpaceAsync(TimeSpan budget, CancellationToken ct)
+    {
+        if (_fault != null)
+            throw new IOException("Frame pipe is closed", _fault);
+
+        if (HasSpace)
+            return true;
+
+        using var timeout = CancellationTokenSource.CreateLinkedTokenSource(ct);
+        timeout.CancelAfter(budget);
+        try
+        {
+            if (await _queue.Writer.WaitToWriteAsync(timeout.Token))
+                return true;
+        }
+        catch (OperationCanceledException) when (!ct.IsCancellationRequested)
+        {
+            return false;
+        }
+
+        throw new IOException("Frame pipe is closed", _fault);
+    }
+
+    public PooledFrame Rent(int size) => _pool.Rent(size);
+
+    /// <summary>
+    /// Queue a filled frame; ownership passes to the writer. False (and the frame is returned
+    /// to the pool) if the queue is full.
+    /// </summary>
+    public bool TryEnqueue(PooledFrame frame)
+    {
+        if (!_queue.Writer.TryWrite(frame))
+        {
+            frame.Dispose();
+            return false;
+        }
+
+        int queued = Interlocked.Increment(ref _queued);
+        int peak;
+        while (queued > (peak = Volatile.Read(ref _peakQueued)) &&
+               Interlocked.CompareExchange(ref _peakQueued, queued, peak) != peak)
+        {
+        }
+
+        return true;
+    }
+
+    /// <summary>
+    /// Write everything still queued and flush the pipe.
+    /// </summary>
+    public async Task CompleteAsync(CancellationToken ct = default)
+    {
+        _queue.Writer.TryComplete();
+        await _drainTask.WaitAsync(ct);
+
+        if (_fault == null)
+            await _output.FlushAsync(ct);
+    }
+
+    private async Task DrainAsync()
+    {
+        await foreach (var frame in _queue.Reader.ReadAllAsync())
+        {
+            try
+            {
+                if (_fault == null)
+                    await _output.WriteAsync(frame.ReadOnlyMemory);
+            }
+            catch (Exception ex)
+            {
+                _fault = ex;
+                _queue.Writer.TryComplete();
+                _logger.LogError(ex, "Frame pipe write failed; {Queued} queued frames discarded", QueuedFrames - 1);
+            }
+            finally
+            {
+                frame.Dispose();
+                Interlocked.Decrement(ref _queued);
+            }
+        }
+    }
+
+    public async ValueTask DisposeAsync()
+    {
+        _queue.Writer.TryComplete();
+        try
+        {
+            await _drainTask;
+        }
+        catch { }
+
+        _pool.Dispose();
+    }
+}
@@ -0,0 +1,563 @@
+using System.Runtime.InteropServices;
+using System.Threading.Channels;
+using Microsoft.Extensions.Logging;
+using Screener.Abstractions.Capture;
+using Screener.Abstractions.Clipping;
+using Screener.Abstractions.Encoding;
+using Screener.Core.Buffers;
+using Screener.Core.Native;
+using Screener.Encoding.Codecs;
+
+namespace Screener.Encoding.Pipelines;
+
+/// <summary>
+/// In-process H.264/HEVC encoding through the native DLL's Media Foundation engine. Frames go
+/// from the capture ring through one SIMD conversion (NV12/P010) straight into the GPU vendor's
+/// encoder (NVENC, Quick Sync, AMF), with no FFmpeg process, probing or pipe. The encoder
+/// runs on its own thread, as each write blocks while the hardware encoder is busy. A replay
+/// buffer is fed by remuxing the fragments the sink writer writes, as they are written.
+/// </summary>
+public sealed class NativeEncodingPipeline : IEncodingPipeline
+{
+    private const string NativeDll = "Screener.Capture.Blackmagic.Native.dll";
+
+    // Frames waiting for the encoder thread. Each holds its caller's capture ring lease, so the
+    // queue stays short; a full queue is reported as backpressure like the FFmpeg pipeline's.
+    private const int QueueCapacity = 2;
+
+    // Mirrors NativeEncoderSettings / NativeEncoderStats in NativeEncoder.h
+    [StructLayout(LayoutKind.Sequential)]
+    private struct NativeEncoderSettings
+    {
+        public int Width;
+        public int Height;
+        public int FrameRateNum;
+        public int FrameRateDen;
+        public int Codec;           // 0 = H.264, 1 = HEVC
+        public int Input;           // 0 = UYVY -> NV12, 1 = v210 -> P010
+        public int BitrateKbps;
+        public int MaxBitrateKbps;  // 0 = mean * 1.5
+        public int GopFrames;       // 0 = one second
+        public int AllowHardware;
+        public int Fragmented;
+    }
+
+    [StructLayout(LayoutKind.Sequential)]
+    private struct NativeEncoderStats
+    {
+        public ulong FramesWritten;
+        public ulong FramesFailed;
+        public ulong ConvertUsTotal;
+        public ulong WriteUsTotal;
+        public ulong WriteUsMax;
+        public int Hardware;
+        public int LastError;
+    }
+
+    [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl)]
+    private static extern int IsNativeEncoderAvailable();
+
+    // Every write to the output file, on the sink writer's thread; data is valid for the call
+    [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+    private delegate void NativeEncoderOutputCallback(IntPtr context, long position, IntPtr data, int length);
+
+    [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Unicode)]
+    private static extern IntPtr CreateNativeEncoder(string path, ref NativeEncoderSettings settings,
+        NativeEncoderOutputCallback? output, IntPtr outputContext, out int error);
+
+    // Returns the number of encoders that accepted the frame (results[i] = 1 each), -1 on bad arguments
+    [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl)]
+    private static extern int WriteNativeEncoderFrame(IntPtr[] encoders, int count, ref byte src, int srcBufferSize, int srcPitch,
+        [Out] int[] results);
+
+    [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl)]
+    private static extern int FinalizeNativeEncoder(IntPtr encoder);
+
+    [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl)]
+    private static extern void DestroyNativeEncoder(IntPtr encoder);
+
+    [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl)]
+    private static extern int GetNativeEncoderStats(IntPtr encoder, out NativeEncoderStats stats, int statsSize);
+
+    private static readonly Lazy<bool> _available = new(ProbeAvailable);
+
+    // The tap is held for as long as the native encoder can call it
+    private sealed record Output(IntPtr Handle, string Path, ReplayTap? Tap);
+
+    private readonly record struct PendingFrame(ReadOnlyMemory<byte> Data, TaskCompletionSource<bool> Done);
+
+    private readonly ILogger<NativeEncodingPipeline> _logger;
+    private readonly HardwareAccelerator _hwAccel;
+    private readonly object _outputLock = new();
+
+    private EncodingConfiguration? _config;
+    private readonly List<Output> _outputs = new();
+    private IntPtr[] _handles = Array.Empty<IntPtr>(); // snapshot passed to the native fan-out
+    private int[] _results = Array.Empty<int>();       // encoder thread only
+    private Channel<PendingFrame>? _queue;
+    private Thread? _encodeThread;
+    private readonly TaskCompletionSource _encodeDone = new(TaskCreationOptions.RunContinuationsAsynchronously);
+    private TimeSpan _stallBudget;
+
+    // Composited into a copy, as in EncodingPipeline: the capture ring slot is shared
+    private IVideoOverlay? _overlay;
+    private byte[]? _overlayBuffer;
+
+    private EncodingState _state = EncodingState.Idle;
+    private EncodingPreset _currentPreset = EncodingPreset.Medium;
+    private readonly EncodingStatistics _statistics = new();
+    private long _framesEncoded;
+    private long _bytesWritten;
+    private DateTime _startTime;
+    private int _droppedFrames;
+    private int _backpressureDroppedFrames;
+    private int _stalledFrames;
+    private long _lastBackpressureTicks;
+
+    public EncodingState State => _state;
+    public EncodingPreset CurrentPreset => _currentPreset;
+    public EncodingStatistics Statistics => _statistics with
+    {
+        FramesEncoded = _framesEncoded,
+        BytesWritten = _bytesWritten,
+        Duration = _startTime != default ? DateTime.UtcNow - _startTime : TimeSpan.Zero,
+        DroppedFrames = _droppedFrames,
+        BackpressureDroppedFrames = _backpressureDroppedFrames,
+        StalledFrames = _stalledFrames,
+        QueuedFrames = _queue?.Reader.Count ?? 0
+    };
+
+    public event EventHandler<EncodingProgressEventArgs>? Progress;
+    public event EventHandler<EncodingErrorEventArgs>? Error;
+    public event EventHandler<EncodingBackpressureEventArgs>? Backpressure;
+
+    public NativeEncodingPipeline(ILogger<NativeEncodingPipeline> logger, HardwareAccelerator hwAccel)
+    {
+        _logger = logger;
+        _hwAccel = hwAccel;
+    }
+
+    /// <summary>
+    /// True if the native DLL is deployed and Media Foundation has an H.264 encoder.
+    /// </summary>
+    public static bool IsAvailable => _available.Value;
+
+    /// <summary>
+    /// Whether the engine can encode this configuration: H.264/HEVC from 8-bit UYVY, or HEVC
+    /// Main10 from v210, at an even frame size. Anything else (ProRes, DNxHD, 10-bit H.264)
+    /// needs the FFmpeg pipeline.
+    /// </summary>
+    public static bool CanEncode(EncodingConfiguration config)
+    {
+        var mode = config.VideoMode;
+        if (!IsAvailable || mode.Width % 2 != 0 || mode.Height % 2 != 0)
+            return false;
+
+        return (config.Preset.VideoCodec, mode.PixelFormat) switch
+        {
+            (VideoCodec.H264 or VideoCodec.H265, PixelFormat.UYVY or PixelFormat.YUV422_8bit) => true,
+            (VideoCodec.H265, PixelFormat.YUV422_10bit) => true,
+            _ => false
+        };
+    }
+
+    public Task InitializeAsync(EncodingConfiguration config, CancellationToken ct = default)
+    {
+        if (_state != EncodingState.Idle)
+            throw new InvalidOperationException($"Cannot initialize in state {_state}");
+        if (!CanEncode(config))
+            throw new NotSupportedException(
+                $"The native encoder cannot encode {config.Preset.VideoCodec} from {config.VideoMode.PixelFormat}");
+
+        _config = config;
+        _currentPreset = config.Preset;
+        _state = EncodingState.Initializing;
+
+        try
+        {
+            // The replay tap remuxes fragments, so a session feeding one is always fragmented
+            AddOutputCore(config.OutputPath, config.Preset, config.HwAccel,
+                config.UseFragmentedMp4 || config.Replay != null, config.Replay);
+
+            _overlay = config.Overlay != null && config.Overlay.Supports(config.VideoMode) ? config.Overlay : null;
+            if (config.Overlay != null && _overlay == null)
+                _logger.LogInformation("Overlay does not support {Format} frames; encoding without it", config.VideoMode.PixelFormat);
+
+            _queue = Channel.CreateBounded<PendingFrame>(new BoundedChannelOptions(QueueCapacity)
+            {
+                SingleReader = true,
+                FullMode = BoundedChannelFullMode.Wait
+            });
+            _encodeThread = new Thread(EncodeLoop)
+            {
+                IsBackground = true,
+                Name = $"Native encoder ({Path.GetFileName(config.OutputPath)})",
+                Priority = ThreadPriority.AboveNormal
+            };
+            _encodeThread.Start();
+            _stallBudget = TimeSpan.FromSeconds(1.0 / config.VideoMode.FrameRate.Value);
+            _startTime = DateTime.UtcNow;
+
+            _state = EncodingState.Encoding;
+            _logger.LogInformation("Native encoding started: {Output}", config.OutputPath);
+        }
+        catch (Exception ex)
+        {
+            _state = EncodingState.Error;
+            _logger.LogError(ex, "Failed to initialize native encoding pipeline");
+            Error?.Invoke(this, new EncodingErrorEventArgs
+            {
+                Message = ex.Message,
+                Exception = ex,
+                IsFatal = true
+            });
+            throw;
+        }
+
+        return Task.CompletedTask;
+    }
+
+    private void AddOutputCore(string outputPath, EncodingPreset preset, HardwareAcceleration hwAccel, bool fragmented,
+        IReplayBuffer? replay = null)
+    {
+        var mode = _config!.VideoMode;
+
+        // Peaks capped as the FFmpeg pipeline caps them: 1.5x the mean on a hardware encoder,
+        // the mean itself in software
+        bool hardware = AllowHardware(hwAccel);
+        var settings = new NativeEncoderSettings
+        {
+            Width = mode.Width,
+            Height = mode.Height,
+            FrameRateNum = mode.FrameRate.Numerator,
+            FrameRateDen = mode.FrameRate.Denominator,
+            Codec = preset.VideoCodec == VideoCodec.H265 ? 1 : 0,
+            Input = mode.PixelFormat == PixelFormat.YUV422_10bit ? 1 : 0,
+            BitrateKbps = preset.VideoBitrateMbps * 1000,
+            MaxBitrateKbps = preset.VideoBitrateMbps * (hardware ? 1500 : 1000),
+            AllowHardware = hardware ? 1 : 0,
+            Fragmented = fragmented ? 1 : 0
+        };
+
+        var tap = replay != null ? new ReplayTap(replay, outputPath, _logger) : null;
+        var handle = CreateNativeEncoder(outputPath, ref settings, tap != null ? tap.OnOutput : null, IntPtr.Zero, out int error);
+        if (handle == IntPtr.Zero)
+            throw new IOException($"Native encoder could not be created for {outputPath} (HRESULT 0x{error:X8})");
+
+        lock (_outputLock)
+        {
+            _outputs.Add(new Output(handle, outputPath, tap));
+            _handles = _outputs.Select(o => o.Handle).ToArray();
+        }
+
+        var stats = ReadStats(handle);
+        _logger.LogInformation("Native encoder for {Output}: {Codec} {Bitrate} Mbps, {Engine}",
+            outputPath, preset.VideoCodec, preset.VideoBitrateMbps, stats.Hardware != 0 ? "hardware" : "software");
+    }
+
+    // Media Foundation picks the first hardware encoder MFT itself; the probe only tells us
+    // whether there is one worth asking for
+    private bool AllowHardware(HardwareAcceleration preference)
+    {
+        if (preference == HardwareAcceleration.Software)
+            return false;
+
+        var probed = _hwAccel.AvailableEncoders;
+        return probed.Count == 0 || probed.Any(a => a is HardwareAcceleration.Nvenc or HardwareAcceleration.Qsv or HardwareAcceleration.Amf);
+    }
+
+    public async Task<bool> WriteVideoFrameAsync(ReadOnlyMemory<byte> frame, TimeSpan pts, CancellationToken ct = default)
+    {
+        var queue = _queue;
+        if (_state != EncodingState.Encoding || queue == null)
+            return false;
+
+        // Completes once the encoders have read the frame, so the caller's lease covers the read
+        var pending = new PendingFrame(frame, new TaskCompletionSource<bool>(TaskCreationOptions.RunContinuationsAsynchronously));
+
+        try
+        {
+            if (!queue.Writer.TryWrite(pending))
+            {
+                if (!await WaitForSpaceAsync(queue, ct) || !queue.Writer.TryWrite(pending))
+                {
+                    OnBackpressure();
+                    return false;
+                }
+
+                Interlocked.Increment(ref _stalledFrames);
+            }
+
+            if (!await pending.Done.Task)
+            {
+                Interlocked.Increment(ref _droppedFrames);
+                return false;
+            }
+
+            _framesEncoded++;
+
+            if (_framesEncoded % 30 == 0)
+            {
+                UpdateProgress();
+            }
+
+            return true;
+        }
+        catch (Exception ex)
+        {
+            Interlocked.Increment(ref _droppedFrames);
+            _logger.LogWarning(ex, "Failed to write video frame {FrameNumber}", _framesEncoded);
+            return false;
+        }
+    }
+
+    private async ValueTask<bool> WaitForSpaceAsync(Channel<PendingFrame> queue, CancellationToken ct)
+    {
+        using var timeout = CancellationTokenSource.CreateLinkedTokenSource(ct);
+        timeout.CancelAfter(_stallBudget);
+        try
+        {
+            return await queue.Writer.WaitToWriteAsync(timeout.Token);
+        }
+        catch (OperationCanceledException) when (!ct.IsCancellationRequested)
+        {
+            return false;
+        }
+    }
+
+    public Task<bool> WriteAudioSamplesAsync(ReadOnlyMemory<byte> samples, TimeSpan pts, CancellationToken ct = default)
+    {
+        // Video only, like the FFmpeg pipeline
+        return Task.FromResult(true);
+    }
+
+    private void EncodeLoop()
+    {
+        var reader = _queue!.Reader;
+        try
+        {
+            // Blocks this thread only; false once the queue is completed and drained
+            while (reader.WaitToReadAsync().AsTask().GetAwaiter().GetResult())
+            {
+                while (reader.TryRead(out var pending))
+                {
+                    bool accepted;
+                    try
+                    {
+                        accepted = EncodeFrame(pending.Data.Span);
+                    }
+                    catch (Exception ex)
+                    {
+                        _logger.LogWarning(ex, "Native encoder rejected frame {FrameNumber}", _framesEncoded);
+                        accepted = false;
+                    }
+
+                    pending.Done.TrySetResult(accepted);
+                }
+            }
+        }
+        finally
+        {
+            _encodeDone.TrySetResult();
+        }
+    }
+
+    // Encoder thread only. WriteNativeEncoderFrame blocks while a hardware encoder is busy.
+    private bool EncodeFrame(ReadOnlySpan<byte> frame)
+    {
+        var mode = _config!.VideoMode;
+        if (frame.Length < mode.Height)
+            throw new ArgumentException("Frame is smaller than the video mode", nameof(frame));
+
+        int rowBytes = frame.Length / mode.Height;
+        if (_overlay != null)
+        {
+            if (_overlayBuffer == null || _overlayBuffer.Length != frame.Length)
+                _overlayBuffer = new byte[frame.Length];
+
+            frame.CopyTo(_overlayBuffer);
+            _overlay.Apply(_overlayBuffer, rowBytes, mode);
+            frame = _overlayBuffer;
+        }
+
+        var handles = Volatile.Read(ref _handles);
+        if (_results.Length != handles.Length)
+            _results = new int[handles.Length];
+
+        int accepted = WriteNativeEncoderFrame(handles, handles.Length,
+            ref MemoryMarshal.GetReference(frame), frame.Length, rowBytes, _results);
+        if (accepted < 0)
+            throw new ArgumentException("Frame does not match the encoder's video mode", nameof(frame));
+
+        // Further outputs keep their own failure counts; the primary output decides the result
+        return _results[0] == 1;
+    }
+
+    private void OnBackpressure()
+    {
+        int dropped = Interlocked.Increment(ref _backpressureDroppedFrames);
+
+        long now = Environment.TickCount64;
+        if (now - _lastBackpressureTicks < 1000)
+            return;
+
+        _lastBackpressureTicks = now;
+        _logger.LogWarning("Native encoder is falling behind; {Dropped} frames refused", dropped);
+        Backpressure?.Invoke(this, new EncodingBackpressureEventArgs
+        {
+            QueuedFrames = _queue?.Reader.Count ?? 0,
+            QueueCapacity = QueueCapacity,
+            DroppedFrames = dropped
+        });
+    }
+
+    public async Task FinalizeAsync(CancellationToken ct = default)
+    {
+        if (_state != EncodingState.Encoding)
+            return;
+
+        _state = EncodingState.Finalizing;
+        _logger.LogInformation("Finalizing native encoding...");
+
+        try
+        {
+            _queue?.Writer.TryComplete();
+            if (_encodeThread != null)
+                await _encodeDone.Task.WaitAsync(ct);
+
+            Output[] outputs;
+            lock (_outputLock)
+            {
+                outputs = _outputs.ToArray();
+            }
+
+            foreach (var output in outputs)
+            {
+                // Drains the encoder and writes the index; can take a moment for a long GOP
+                int hr = await Task.Run(() => FinalizeNativeEncoder(output.Handle), ct);
+                var stats = ReadStats(output.Handle);
+                if (hr != 0)
+                    _logger.LogError("Native encoder failed to finalize {Output} (HRESULT 0x{Error:X8})", output.Path, hr);
+
+                _logger.LogInformation(
+                    "Native encoding completed: {Output}, {Frames} frames ({Failed} failed), convert {Convert:F0} us, write {Write:F0} us avg / {WriteMax} us max",
+                    output.Path, stats.FramesWritten, stats.FramesFailed,
+                    stats.FramesWritten > 0 ? (double)stats.ConvertUsTotal / stats.FramesWritten : 0,
+                    stats.FramesWritten > 0 ? (double)stats.WriteUsTotal / stats.FramesWritten : 0,
+                    stats.WriteUsMax);
+            }
+
+            if (File.Exists(_config?.OutputPath))
+            {
+                _bytesWritten = new FileInfo(_config!.OutputPath).Length;
+            }
+
+            _state = EncodingState.Completed;
+        }
+        catch (Exception ex)
+        {
+            _state = EncodingState.Error;
+            _logger.LogError(ex, "Error finalizing native encoding");
+            throw;
+        }
+    }
+
+    private static NativeEncoderStats ReadStats(IntPtr handle)
+    {
+        GetNativeEncoderStats(handle, out var stats, Marshal.SizeOf<NativeEncoderStats>());
+        return stats;
+    }
+
+    private void UpdateProgress()
+    {
+        if (File.Exists(_config?.OutputPath))
+        {
+            _bytesWritten = new FileInfo(_config!.OutputPath).Length;
+        }
+
+        var duration = DateTime.UtcNow - _startTime;
+        var bitrate = duration.TotalSeconds > 0 ? _bytesWritten * 8 / duration.TotalSeconds / 1_000_000 : 0;
+
+        Progress?.Invoke(this, new EncodingProgressEventArgs
+        {
+            FrameNumber = _framesEncoded,
+            EncodedDuration = TimeSpan.FromSeconds(_framesEncoded / _config!.VideoMode.FrameRate.Value),
+            CurrentBitrateMbps = bitrate,
+            FileSizeBytes = _bytesWritten
+        });
+    }
+
+    private static bool ProbeAvailable()
+    {
+        if (!MediaKernels.IsAvailable)
+            return false;
+
+        try
+        {
+            return IsNativeEncoderAvailable() == 1;
+        }
+        catch (EntryPointNotFoundException)
+        {
+            return false;
+        }
+        catch (DllNotFoundException)
+        {
+            return false;
+        }
+    }
+
+    // Feeds a replay buffer from the sink writer's writes. A stream the remuxer cannot follow
+    // stops the tap for the session; clips then come from the recording file.
+    private sealed class ReplayTap
+    {
+        private readonly Mp4FragmentRemuxer _remuxer;
+        private readonly string _outputPath;
+        private readonly ILogger _logger;
+        private readonly NativeEncoderOutputCallback _callback;
+        private bool _failed;
+
+        public ReplayTap(IReplayBuffer replay, string outputPath, ILogger logger)
+        {
+            _remuxer = new Mp4FragmentRemuxer(replay);
+            _outputPath = outputPath;
+            _logger = logger;
+            _callback = Write;
+        }
+
+        public NativeEncoderOutputCallback OnOutput => _callback;
+
+        // Exceptions must not unwind into the sink writer
+        private unsafe void Write(IntPtr context, long position, IntPtr data, int length)
+        {
+            if (_failed)
+                return;
+
+            try
+            {
+                _remuxer.Write(position, new ReadOnlySpan<byte>((void*)data, length));
+            }
+            catch (Exception ex)
+            {
+                _failed = true;
+                _logger.LogWarning(ex, "Replay buffer stopped for {Output}; clips will be cut from the recording file", _outputPath);
+            }
+        }
+    }
+
+    public async ValueTask DisposeAsync()
+    {
+        _queue?.Writer.TryComplete();
+        if (_encodeThread != null)
+            await _encodeDone.Task;
+
+        lock (_outputLock)
+        {
+            // Abandons any output that was not finalized
+            foreach (var output in _outputs)
+                DestroyNativeEncoder(output.Handle);
+
+            _outputs.Clear();
+            _handles = Array.Empty<IntPtr>();
+        }
+    }
+}
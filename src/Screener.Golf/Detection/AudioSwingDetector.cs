@@ -1,22 +1,35 @@
 using Microsoft.Extensions.Logging;
+using Screener.Core.Native;
 
 namespace Screener.Golf.Detection;
 
 /// <summary>
 /// Detects golf club impact sounds using RMS energy spike detection against an EMA baseline.
-/// Mirrors the SwingDetector pattern but operates on raw PCM audio samples.
+/// Mirrors the SwingDetector pattern but operates on raw PCM audio samples. Levels come from
+/// the one-pass metering kernel, which also scores how transient each block is.
 /// </summary>
 public class AudioSwingDetector
 {
     private readonly ILogger _logger;
     private readonly AutoCutConfiguration _config;
 
+    // Onset window: short enough to isolate a strike within a 10-100 ms packet
+    private const int OnsetWindowFrames = 48;
+
     private double _emaBaseline;
     private bool _emaInitialized;
+    private float[] _rms = Array.Empty<float>();
+    private float[] _onset = Array.Empty<float>();
 
     /// <summary>Last computed RMS level in dB.</summary>
     public double LastRmsDb { get; private set; } = -60.0;
 
+    /// <summary>
+    /// Onset score of the last block, loudest channel: its sharpest short window's energy over
+    /// the block's mean (1 for a steady sound, large for a click in quiet).
+    /// </summary>
+    public double LastOnsetScore { get; private set; }
+
     /// <summary>Current EMA baseline (linear RMS).</summary>
     public double CurrentEma => _emaBaseline;
 
@@ -42,7 +55,7 @@ public class AudioSwingDetector
         if (!_config.AudioEnabled)
             return false;
 
-        double rms = ComputeRms(sampleData, channels, bitsPerSample);
+        double rms = MeasureLevels(sampleData, channels, bitsPerSample);
         double rmsDb = rms > 0 ? 20.0 * Math.Log10(rms) : -60.0;
         LastRmsDb = rmsDb;
 
@@ -77,59 +90,28 @@ public class AudioSwingDetector
     }
 
     /// <summary>
-    /// Compute the RMS energy of interleaved PCM samples, mixing all channels to mono.
+    /// Compute the RMS energy of interleaved PCM samples mixing all channels to mono.
     /// </summary>
     public static double ComputeRms(ReadOnlySpan<byte> sampleData, int channels, int bitsPerSample)
     {
-        int bytesPerSample = bitsPerSample / 8;
-        int frameSize = bytesPerSample * channels;
-
-        if (frameSize == 0 || sampleData.Length < frameSize)
+        if (!CanMeasure(sampleData, channels, bitsPerSample))
             return 0.0;
 
-        int totalFrames = sampleData.Length / frameSize;
-        double sumSquares = 0.0;
-        int sampleCount = 0;
-
-        for (int frame = 0; frame < totalFrames; frame++)
-        {
-            int frameOffset = frame * frameSize;
-
-            for (int ch = 0; ch < channels; ch++)
-            {
-                int offset = frameOffset + ch * bytesPerSample;
-                if (offset + bytesPerSample > sampleData.Length)
-                    break;
-
-                double normalizedSample;
-
-                if (bitsPerSample == 16)
-                {
-                    short sample = (short)(sampleData[offset] | (sampleData[offset + 1] << 8));
-                    normalizedSample = sample / 32768.0;
-                }
-                else if (bitsPerSample == 32)
-                {
-                    int sample = sampleData[offset]
-                               | (sampleData[offset + 1] << 8)
-                               | (sampleData[offset + 2] << 16)
-                               | (sampleData[offset + 3] << 24);
-                    normalizedSample = sample / 2147483648.0;
-                }
-                else
-                {
-                    continue;
-                }
-
-                sumSquares += normalizedSample * normalizedSample;
-                sampleCount++;
-            }
-        }
+        Span<float> rms = channels <= MediaKernels.MaxAudioChannels ? stackalloc float[channels] : new float[channels];
+        MediaKernels.MeasureAudioLevels(sampleData, channels, bitsPerSample, OnsetWindowFrames, rms, default, default);
+        return CombineRms(rms);
+    }
 
-        if (sampleCount == 0)
-            return 0.0;
+    private static bool CanMeasure(ReadOnlySpan<byte> sampleData, int channels, int bitsPerSample) =>
+        channels > 0 && (bitsPerSample == 16 || bitsPerSample == 32) && sampleData.Length >= channels * bitsPerSample / 8;
 
-        return Math.Sqrt(sumSquares / sampleCount);
+    // Mean square over all channels, so every sample weighs the same whatever the layout
+    private static double CombineRms(ReadOnlySpan<float> rms)
+    {
+        double sumSquares = 0.0;
+        foreach (var channelRms in rms)
+            sumSquares += (double)channelRms * channelRms;
+        return Math.Sqrt(sumSquares / rms.Length);
     }
 
     /// <summary>
@@ -140,5 +122,32 @@ public class AudioSwingDetector
         _emaBaseline = 0;
         _emaInitialized = false;
         LastRmsDb = -60.0;
+        LastOnsetScore = 0;
+    }
+
+    // RMS over all channels, plus the onset score of the channel with the most energy
+    private double MeasureLevels(ReadOnlySpan<byte> sampleData, int channels, int bitsPerSample)
+    {
+        LastOnsetScore = 0;
+        if (!CanMeasure(sampleData, channels, bitsPerSample))
+            return 0.0;
+
+        if (_rms.Length != channels)
+        {
+            _rms = new float[channels];
+            _onset = new float[channels];
+        }
+
+        MediaKernels.MeasureAudioLevels(sampleData, channels, bitsPerSample, OnsetWindowFrames, _rms, default, _onset);
+
+        int loudest = 0;
+        for (int ch = 1; ch < channels; ch++)
+        {
+            if (_rms[ch] > _rms[loudest])
+                loudest = ch;
+        }
+        LastOnsetScore = _onset[loudest];
+
+        return CombineRms(_rms);
     }
 }
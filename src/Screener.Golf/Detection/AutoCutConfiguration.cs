@@ -13,11 +13,14 @@ public class AutoCutConfiguration
     /// <summary>Downsampled analysis height. Default 68.</summary>
     public int AnalysisHeight { get; set; } = 68;
 
-    /// <summary>Analyze every Nth frame from the source. Default 4 (15fps from 60fps).</summary>
-    public int FrameSkip { get; set; } = 4;
+    /// <summary>
+    /// Analyze every Nth frame from the source. Default 1 (every frame); the frame counts and
+    /// the EMA below are tuned for 60fps analysis and scale with N.
+    /// </summary>
+    public int FrameSkip { get; set; } = 1;
 
-    /// <summary>EMA smoothing factor (0-1). Lower = smoother baseline. Default 0.05.</summary>
-    public double EmaAlpha { get; set; } = 0.05;
+    /// <summary>EMA smoothing factor (0-1). Lower = smoother baseline. Default 0.0032 (~5s time constant at 60fps).</summary>
+    public double EmaAlpha { get; set; } = 0.0032;
 
     /// <summary>Spike must exceed EMA by this multiplier to trigger swing detection. Default 4.0.</summary>
     public double SwingSpikeMultiplier { get; set; } = 4.0;
@@ -25,8 +28,8 @@ public class AutoCutConfiguration
     /// <summary>Minimum SAD value to consider as a real spike (filters noise). Default 500.</summary>
     public double MinimumSpikeThreshold { get; set; } = 500;
 
-    /// <summary>Compare current frame against the frame from N analysis cycles ago. Default 2.</summary>
-    public int FrameCompareGap { get; set; } = 2;
+    /// <summary>Compare current frame against the frame from N analysis cycles ago. Default 32 (~0.5s at 60fps).</summary>
+    public int FrameCompareGap { get; set; } = 32;
 
     // --- Swing ROI (normalized 0.0-1.0 coordinates) ---
 
@@ -47,11 +50,11 @@ public class AutoCutConfiguration
     /// <summary>Similarity threshold (0-1) for matching the idle reference. Default 0.95.</summary>
     public double IdleSimilarityThreshold { get; set; } = 0.95;
 
-    /// <summary>Number of consecutive idle frames required to confirm reset. Default 3.</summary>
-    public int ConsecutiveIdleFramesRequired { get; set; } = 3;
+    /// <summary>Number of consecutive idle frames required to confirm reset. Default 48 (0.8s at 60fps).</summary>
+    public int ConsecutiveIdleFramesRequired { get; set; } = 48;
 
-    /// <summary>SAD threshold for inter-frame "static" detection. Default 200.</summary>
-    public double StaticSceneThreshold { get; set; } = 200;
+    /// <summary>SAD threshold for "static" detection between consecutive analyzed frames. Default 12.5.</summary>
+    public double StaticSceneThreshold { get; set; } = 12.5;
 
     // --- Audio Swing Detection ---
 
@@ -96,7 +99,7 @@ public class AutoCutConfiguration
         SwingSpikeMultiplier = 3.0,
         MinimumSpikeThreshold = 300,
         IdleSimilarityThreshold = 0.90,
-        ConsecutiveIdleFramesRequired = 2,
+        ConsecutiveIdleFramesRequired = 32,
         AudioSpikeMultiplier = 3.5,
         MinimumAudioThresholdDb = -35,
         AudioEmaAlpha = 0.15
@@ -107,7 +110,7 @@ public class AutoCutConfiguration
         SwingSpikeMultiplier = 6.0,
         MinimumSpikeThreshold = 800,
         IdleSimilarityThreshold = 0.97,
-        ConsecutiveIdleFramesRequired = 4,
+        ConsecutiveIdleFramesRequired = 64,
         AudioSpikeMultiplier = 7.0,
         MinimumAudioThresholdDb = -25,
         AudioEmaAlpha = 0.07
@@ -1,4 +1,5 @@
 using Microsoft.Extensions.Logging;
+using Screener.Abstractions.Capture;
 using Screener.Golf.Models;
 
 namespace Screener.Golf.Detection;
@@ -89,16 +90,19 @@ public class AutoCutService
     /// <summary>
     /// Calibrate the idle reference from the current simulator frame.
     /// </summary>
-    public void CalibrateIdleReference(ReadOnlyMemory<byte> uyvyData, int srcWidth, int srcHeight)
+    public void CalibrateIdleReference(ReadOnlyMemory<byte> uyvyData, int srcWidth, int srcHeight,
+        PixelFormat pixelFormat = PixelFormat.YUV422_8bit, LumaPlane? capturedLuma = null)
     {
-        _resetDetector.CalibrateIdleReference(uyvyData.Span, srcWidth, srcHeight);
+        _resetDetector.CalibrateIdleReference(uyvyData.Span, srcWidth, srcHeight, pixelFormat, capturedLuma);
     }
 
     /// <summary>
     /// Process a frame from Source 1 (golfer camera).
-    /// Call this from the frame callback hook at the configured skip rate.
+    /// Call this from the frame callback hook at the configured skip rate. Pass the frame's
+    /// <see cref="VideoFrameEventArgs.AnalysisLuma"/> to skip re-reading the frame.
     /// </summary>
-    public void ProcessSource1Frame(ReadOnlyMemory<byte> uyvyData, int srcWidth, int srcHeight)
+    public void ProcessSource1Frame(ReadOnlyMemory<byte> uyvyData, int srcWidth, int srcHeight,
+        PixelFormat pixelFormat = PixelFormat.YUV422_8bit, LumaPlane? capturedLuma = null)
     {
         _source1FrameCount++;
 
@@ -107,7 +111,7 @@ public class AutoCutService
 
         if (_state == AutoCutState.WaitingForSwing)
         {
-            bool swingDetected = _swingDetector.ProcessFrame(uyvyData.Span, srcWidth, srcHeight);
+            bool swingDetected = _swingDetector.ProcessFrame(uyvyData.Span, srcWidth, srcHeight, pixelFormat, capturedLuma);
             if (swingDetected)
             {
                 _videoSpikeDetectedAt = DateTimeOffset.UtcNow;
@@ -132,7 +136,8 @@ public class AutoCutService
     /// Process a frame from Source 2 (simulator output).
     /// Call this from the frame callback hook at the configured skip rate.
     /// </summary>
-    public void ProcessSource2Frame(ReadOnlyMemory<byte> uyvyData, int srcWidth, int srcHeight)
+    public void ProcessSource2Frame(ReadOnlyMemory<byte> uyvyData, int srcWidth, int srcHeight,
+        PixelFormat pixelFormat = PixelFormat.YUV422_8bit, LumaPlane? capturedLuma = null)
     {
         _source2FrameCount++;
 
@@ -146,7 +151,7 @@ public class AutoCutService
             // Practice swing detection: if sim stayed idle within timeout, cut back
             if (elapsed.TotalSeconds < _config.PracticeSwingTimeoutSeconds)
             {
-                bool isIdle = _resetDetector.ProcessFrame(uyvyData.Span, srcWidth, srcHeight);
+                bool isIdle = _resetDetector.ProcessFrame(uyvyData.Span, srcWidth, srcHeight, pixelFormat, capturedLuma);
                 if (isIdle)
                 {
                     _logger.LogInformation("Practice swing detected (sim idle within {Timeout}s), cutting back",
@@ -159,7 +164,7 @@ public class AutoCutService
             else
             {
                 // Normal reset detection
-                bool resetDetected = _resetDetector.ProcessFrame(uyvyData.Span, srcWidth, srcHeight);
+                bool resetDetected = _resetDetector.ProcessFrame(uyvyData.Span, srcWidth, srcHeight, pixelFormat, capturedLuma);
                 if (resetDetected)
                 {
                     TransitionTo(AutoCutState.ResetDetected);
@@ -1,8 +1,14 @@
+using System.Buffers.Binary;
+using Screener.Abstractions.Capture;
+using Screener.Core.Native;
+
 namespace Screener.Golf.Detection;
 
 /// <summary>
-/// Static methods for lightweight frame analysis on raw UYVY byte arrays.
+/// Static methods for lightweight frame analysis on raw UYVY or v210 byte arrays.
 /// All operations work on the Y (luma) channel only — zero color-space conversion needed.
+/// The native SIMD kernels (<see cref="MediaKernels"/>) are used when available; the managed
+/// loops here are the fallback and produce identical results.
 /// </summary>
 public static class FrameAnalyzer
 {
@@ -16,26 +22,36 @@ public static class FrameAnalyzer
     /// <param name="dstWidth">Target downsampled width.</param>
     /// <param name="dstHeight">Target downsampled height.</param>
     /// <param name="lumaBuffer">Pre-allocated buffer of size dstWidth * dstHeight.</param>
+    /// <param name="pixelFormat">Frame layout; YUV422_10bit frames are read as v210.</param>
     public static void ExtractLumaDownsampled(
         ReadOnlySpan<byte> uyvyData,
         int srcWidth, int srcHeight,
         int dstWidth, int dstHeight,
-        Span<byte> lumaBuffer)
+        Span<byte> lumaBuffer,
+        PixelFormat pixelFormat = PixelFormat.YUV422_8bit)
     {
+        bool v210 = pixelFormat == PixelFormat.YUV422_10bit;
+        int srcPitch = v210 ? MediaKernels.V210RowBytes(srcWidth) : srcWidth * 2;
+        if (MediaKernels.TryExtractLumaSad(uyvyData, srcPitch, srcWidth, srcHeight, v210,
+                lumaBuffer, dstWidth, dstHeight, ReadOnlySpan<byte>.Empty, 0, 0, 0, 0, out _))
+            return;
+
+        if (v210)
+        {
+            ExtractLumaDownsampledV210(uyvyData, srcWidth, srcHeight, dstWidth, dstHeight, lumaBuffer);
+            return;
+        }
+
         int srcRowBytes = srcWidth * 2; // UYVY = 2 bytes per pixel
-        double xScale = (double)srcWidth / dstWidth;
-        double yScale = (double)srcHeight / dstHeight;
 
         for (int dy = 0; dy < dstHeight; dy++)
         {
-            int srcRow = (int)(dy * yScale);
-            if (srcRow >= srcHeight) srcRow = srcHeight - 1;
+            int srcRow = SourceIndex(dy, srcHeight, dstHeight);
             int srcRowOffset = srcRow * srcRowBytes;
 
             for (int dx = 0; dx < dstWidth; dx++)
             {
-                int srcCol = (int)(dx * xScale);
-                if (srcCol >= srcWidth) srcCol = srcWidth - 1;
+                int srcCol = SourceIndex(dx, srcWidth, dstWidth);
 
                 // In UYVY: U0 Y0 V0 Y1 U2 Y2 V2 Y3 ...
                 // Y is at offset (pixel * 2 + 1) within the 4-byte groups
@@ -50,6 +66,99 @@ public static class FrameAnalyzer
         }
     }
 
+    /// <summary>
+    /// Extract the Y (luma) channel from a v210 frame, downsampled to the target resolution
+    /// and rounded to 8 bits so it compares directly with UYVY luma.
+    /// v210 packs 6 pixels into four 32-bit words of three 10-bit samples (Cb Y Cr Y Cb Y ...),
+    /// so Y of pixel k within a group is sample 2k+1.
+    /// </summary>
+    public static void ExtractLumaDownsampledV210(
+        ReadOnlySpan<byte> v210Data,
+        int srcWidth, int srcHeight,
+        int dstWidth, int dstHeight,
+        Span<byte> lumaBuffer)
+    {
+        int srcRowBytes = MediaKernels.V210RowBytes(srcWidth); // 6 pixels per 16 bytes, 128-byte aligned rows
+
+        for (int dy = 0; dy < dstHeight; dy++)
+        {
+            int srcRow = SourceIndex(dy, srcHeight, dstHeight);
+            int srcRowOffset = srcRow * srcRowBytes;
+
+            for (int dx = 0; dx < dstWidth; dx++)
+            {
+                int srcCol = SourceIndex(dx, srcWidth, dstWidth);
+
+                int sample = (srcCol % 6) * 2 + 1;
+                int byteIndex = srcRowOffset + (srcCol / 6) * 16 + (sample / 3) * 4;
+
+                if (byteIndex + 3 < v210Data.Length)
+                {
+                    uint word = BinaryPrimitives.ReadUInt32LittleEndian(v210Data[byteIndex..]);
+                    int y10 = (int)((word >> (10 * (sample % 3))) & 0x3FF);
+                    lumaBuffer[dy * dstWidth + dx] = (byte)Math.Min(255, (y10 + 2) >> 2);
+                }
+            }
+        }
+    }
+
+    /// <summary>
+    /// Extract downsampled luma (as <see cref="ExtractLumaDownsampled"/>) and compute its SAD
+    /// against a reference luma buffer within a region of interest (as <see cref="ComputeSadInRoi"/>)
+    /// in one pass over the frame. This is the per-frame detector path.
+    /// </summary>
+    /// <param name="reference">Luma buffer to compare against, dstWidth * dstHeight bytes.</param>
+    /// <param name="capturedLuma">Luma the capture device sampled during its frame copy; used
+    /// instead of reading the frame when it matches dstWidth x dstHeight.</param>
+    /// <returns>Normalized SAD (average per pixel in the ROI).</returns>
+    public static double ExtractLumaWithSad(
+        ReadOnlySpan<byte> frameData,
+        int srcWidth, int srcHeight,
+        int dstWidth, int dstHeight,
+        Span<byte> lumaBuffer,
+        ReadOnlySpan<byte> reference,
+        double roiLeft, double roiTop,
+        double roiWidth, double roiHeight,
+        PixelFormat pixelFormat = PixelFormat.YUV422_8bit,
+        LumaPlane? capturedLuma = null)
+    {
+        if (TryCopyCapturedLuma(capturedLuma, dstWidth, dstHeight, lumaBuffer))
+            return ComputeSadInRoi(lumaBuffer, reference, dstWidth, dstHeight, roiLeft, roiTop, roiWidth, roiHeight);
+
+        var (x0, y0, x1, y1) = RoiBounds(dstWidth, dstHeight, roiLeft, roiTop, roiWidth, roiHeight);
+        bool v210 = pixelFormat == PixelFormat.YUV422_10bit;
+        int srcPitch = v210 ? MediaKernels.V210RowBytes(srcWidth) : srcWidth * 2;
+
+        if (x1 > x0 && y1 > y0 &&
+            MediaKernels.TryExtractLumaSad(frameData, srcPitch, srcWidth, srcHeight, v210,
+                lumaBuffer, dstWidth, dstHeight, reference, x0, y0, x1, y1, out long sad))
+        {
+            return (double)sad / ((x1 - x0) * (y1 - y0));
+        }
+
+        ExtractLumaDownsampled(frameData, srcWidth, srcHeight, dstWidth, dstHeight, lumaBuffer, pixelFormat);
+        return ComputeSadInRoi(lumaBuffer, reference, dstWidth, dstHeight, roiLeft, roiTop, roiWidth, roiHeight);
+    }
+
+    /// <summary>
+    /// Copy a device-sampled luma plane into lumaBuffer if it has the requested dimensions.
+    /// </summary>
+    /// <returns>False if there is no plane or it was sampled at another size; the caller then
+    /// extracts luma from the frame.</returns>
+    public static bool TryCopyCapturedLuma(LumaPlane? capturedLuma, int width, int height, Span<byte> lumaBuffer)
+    {
+        if (capturedLuma == null || capturedLuma.Width != width || capturedLuma.Height != height)
+            return false;
+
+        var data = capturedLuma.Data.Span;
+        int count = width * height;
+        if (data.Length < count || lumaBuffer.Length < count)
+            return false;
+
+        data[..count].CopyTo(lumaBuffer);
+        return true;
+    }
+
     /// <summary>
     /// Compute Sum of Absolute Differences between two luma buffers within a region of interest.
     /// </summary>
@@ -69,13 +178,13 @@ public static class FrameAnalyzer
         double roiLeft, double roiTop,
         double roiWidth, double roiHeight)
     {
-        int x0 = (int)(roiLeft * width);
-        int y0 = (int)(roiTop * height);
-        int x1 = Math.Min(width, (int)((roiLeft + roiWidth) * width));
-        int y1 = Math.Min(height, (int)((roiTop + roiHeight) * height));
+        var (x0, y0, x1, y1) = RoiBounds(width, height, roiLeft, roiTop, roiWidth, roiHeight);
 
         if (x1 <= x0 || y1 <= y0) return 0;
 
+        if (MediaKernels.TryComputeLumaSad(frameA, frameB, width, height, x0, y0, x1, y1, out long sad))
+            return (double)sad / ((x1 - x0) * (y1 - y0));
+
         long totalDiff = 0;
         int pixelCount = 0;
 
@@ -103,16 +212,41 @@ public static class FrameAnalyzer
     {
         if (frameA.Length != frameB.Length || frameA.Length == 0) return 0;
 
-        long totalDiff = 0;
         int count = width * height;
 
-        for (int i = 0; i < count; i++)
+        if (!MediaKernels.TryComputeLumaSad(frameA, frameB, width, height, 0, 0, width, height, out long totalDiff))
         {
-            totalDiff += Math.Abs(frameA[i] - frameB[i]);
+            totalDiff = 0;
+            for (int i = 0; i < count; i++)
+            {
+                totalDiff += Math.Abs(frameA[i] - frameB[i]);
+            }
         }
 
         double avgDiff = (double)totalDiff / count;
         // Max possible avg diff is 255; normalize to 0-1 similarity
         return 1.0 - (avgDiff / 255.0);
     }
+
+    /// <summary>
+    /// Nearest-neighbour source index for a destination index, in integer arithmetic so the
+    /// managed and native paths sample exactly the same pixels.
+    /// </summary>
+    private static int SourceIndex(int dst, int srcSize, int dstSize)
+        => (int)((long)dst * srcSize / dstSize);
+
+    /// <summary>
+    /// Convert a normalized ROI to a half-open pixel rectangle clamped to the buffer.
+    /// </summary>
+    private static (int X0, int Y0, int X1, int Y1) RoiBounds(
+        int width, int height,
+        double roiLeft, double roiTop,
+        double roiWidth, double roiHeight)
+    {
+        int x0 = Math.Max(0, (int)(roiLeft * width));
+        int y0 = Math.Max(0, (int)(roiTop * height));
+        int x1 = Math.Min(width, (int)((roiLeft + roiWidth) * width));
+        int y1 = Math.Min(height, (int)((roiTop + roiHeight) * height));
+        return (x0, y0, x1, y1);
+    }
 }
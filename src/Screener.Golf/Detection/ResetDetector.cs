@@ -1,4 +1,5 @@
 using Microsoft.Extensions.Logging;
+using Screener.Abstractions.Capture;
 
 namespace Screener.Golf.Detection;
 
@@ -42,13 +43,17 @@ public class ResetDetector
     /// <summary>
     /// Calibrate by capturing the current simulator frame as the idle reference.
     /// </summary>
-    public void CalibrateIdleReference(ReadOnlySpan<byte> uyvyData, int srcWidth, int srcHeight)
+    public void CalibrateIdleReference(ReadOnlySpan<byte> uyvyData, int srcWidth, int srcHeight,
+        PixelFormat pixelFormat = PixelFormat.YUV422_8bit, LumaPlane? capturedLuma = null)
     {
         _idleReference = new byte[_analysisPixelCount];
-        FrameAnalyzer.ExtractLumaDownsampled(
-            uyvyData, srcWidth, srcHeight,
-            _config.AnalysisWidth, _config.AnalysisHeight,
-            _idleReference);
+        if (!FrameAnalyzer.TryCopyCapturedLuma(capturedLuma, _config.AnalysisWidth, _config.AnalysisHeight, _idleReference))
+        {
+            FrameAnalyzer.ExtractLumaDownsampled(
+                uyvyData, srcWidth, srcHeight,
+                _config.AnalysisWidth, _config.AnalysisHeight,
+                _idleReference, pixelFormat);
+        }
 
         _isCalibrated = true;
         _consecutiveIdleFrames = 0;
@@ -57,26 +62,27 @@ public class ResetDetector
     }
 
     /// <summary>
-    /// Process a raw UYVY frame from Source 2 (simulator).
+    /// Process a raw UYVY frame from Source 2 (simulator). A luma plane sampled by the
+    /// capture device is used instead of reading the frame when it has the analysis size.
     /// </summary>
     /// <returns>True if the simulator has reset to idle.</returns>
-    public bool ProcessFrame(ReadOnlySpan<byte> uyvyData, int srcWidth, int srcHeight)
+    public bool ProcessFrame(ReadOnlySpan<byte> uyvyData, int srcWidth, int srcHeight,
+        PixelFormat pixelFormat = PixelFormat.YUV422_8bit, LumaPlane? capturedLuma = null)
     {
         if (!_isCalibrated || _idleReference == null) return false;
 
         // Swap buffers
         (_currentLuma, _previousLuma) = (_previousLuma, _currentLuma);
 
-        // Extract current frame luma
-        FrameAnalyzer.ExtractLumaDownsampled(
+        // Extract current frame luma and compare it against the idle reference in one pass
+        // (whole-frame SAD; max possible average difference is 255)
+        double idleSad = FrameAnalyzer.ExtractLumaWithSad(
             uyvyData, srcWidth, srcHeight,
             _config.AnalysisWidth, _config.AnalysisHeight,
-            _currentLuma!);
-
-        // Compare against idle reference
-        double similarity = FrameAnalyzer.ComputeSimilarity(
             _currentLuma!, _idleReference,
-            _config.AnalysisWidth, _config.AnalysisHeight);
+            0, 0, 1.0, 1.0,
+            pixelFormat, capturedLuma);
+        double similarity = 1.0 - (idleSad / 255.0);
         LastSimilarity = similarity;
 
         // Check inter-frame difference (is the scene static?)
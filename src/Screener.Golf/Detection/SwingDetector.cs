@@ -1,4 +1,5 @@
 using Microsoft.Extensions.Logging;
+using Screener.Abstractions.Capture;
 
 namespace Screener.Golf.Detection;
 
@@ -43,26 +44,33 @@ public class SwingDetector
     }
 
     /// <summary>
-    /// Process a raw UYVY frame from Source 1. Call every Nth frame (per FrameSkip config).
+    /// Process a raw UYVY frame from Source 1. Call every Nth frame (per FrameSkip config);
+    /// with the native kernel this is cheap enough to run on every frame.
     /// </summary>
     /// <param name="uyvyData">Raw UYVY frame bytes.</param>
     /// <param name="srcWidth">Source width.</param>
     /// <param name="srcHeight">Source height.</param>
+    /// <param name="pixelFormat">Frame layout (UYVY or v210).</param>
+    /// <param name="capturedLuma">Luma sampled by the capture device, if any (see
+    /// <see cref="FrameAnalyzer.TryCopyCapturedLuma"/>).</param>
     /// <returns>True if a swing was detected on this frame.</returns>
-    public bool ProcessFrame(ReadOnlySpan<byte> uyvyData, int srcWidth, int srcHeight)
+    public bool ProcessFrame(ReadOnlySpan<byte> uyvyData, int srcWidth, int srcHeight,
+        PixelFormat pixelFormat = PixelFormat.YUV422_8bit, LumaPlane? capturedLuma = null)
     {
-        // Extract luma into the current history slot
         var currentBuffer = _frameHistory[_frameHistoryIndex]!;
-        FrameAnalyzer.ExtractLumaDownsampled(
-            uyvyData, srcWidth, srcHeight,
-            _config.AnalysisWidth, _config.AnalysisHeight,
-            currentBuffer);
-
         _framesStored = Math.Min(_framesStored + 1, _frameHistory.Length);
 
         // Need at least FrameCompareGap+1 frames before we can compare
         if (_framesStored <= _config.FrameCompareGap)
         {
+            if (!FrameAnalyzer.TryCopyCapturedLuma(capturedLuma, _config.AnalysisWidth, _config.AnalysisHeight, currentBuffer))
+            {
+                FrameAnalyzer.ExtractLumaDownsampled(
+                    uyvyData, srcWidth, srcHeight,
+                    _config.AnalysisWidth, _config.AnalysisHeight,
+                    currentBuffer, pixelFormat);
+            }
+
             _frameHistoryIndex = (_frameHistoryIndex + 1) % _frameHistory.Length;
             return false;
         }
@@ -71,12 +79,14 @@ public class SwingDetector
         int compareIndex = (_frameHistoryIndex - _config.FrameCompareGap + _frameHistory.Length) % _frameHistory.Length;
         var compareBuffer = _frameHistory[compareIndex]!;
 
-        // Compute SAD within the ROI
-        double sad = FrameAnalyzer.ComputeSadInRoi(
-            currentBuffer, compareBuffer,
+        // Extract luma into the current history slot and compute SAD within the ROI in one pass
+        double sad = FrameAnalyzer.ExtractLumaWithSad(
+            uyvyData, srcWidth, srcHeight,
             _config.AnalysisWidth, _config.AnalysisHeight,
+            currentBuffer, compareBuffer,
             _config.RoiLeft, _config.RoiTop,
-            _config.RoiWidth, _config.RoiHeight);
+            _config.RoiWidth, _config.RoiHeight,
+            pixelFormat, capturedLuma);
 
         LastSad = sad;
 
@@ -1,8 +1,10 @@
 using System.IO;
+using System.Threading.Channels;
 using Microsoft.Extensions.Logging;
 using Polly;
 using Polly.Retry;
 using Screener.Abstractions.Clipping;
+using Screener.Abstractions.Upload;
 using Screener.Golf.Models;
 using Screener.Golf.Overlays;
 using Screener.Golf.Persistence;
@@ -12,31 +14,100 @@ namespace Screener.Golf.Export;
 
 /// <summary>
 /// Orchestrates the end-to-end clip export pipeline:
-/// SequenceRecorder → ClippingService → OverlayCompositor.
+/// SequenceRecorder → ClippingService → OverlayCompositor (skipped when the recording
+/// already carries live overlays from <see cref="LiveOverlayCompositor"/>).
 /// </summary>
+/// <remarks>
+/// Exports are pipelined: swings are cut from the recording one at a time (a stream copy,
+/// and the clipping service holds one active recording), then composited and rendered on a
+/// bounded number of concurrent FFmpeg passes, each of which decodes the clip once for the
+/// final clip and every rendition. Each finished file is queued for upload as soon as it is
+/// written, so the next swing is cut and encoded while this one uploads.
+/// </remarks>
 public class ClipExportService
 {
+    // NVENC on consumer GPUs allows a handful of sessions; one pass holds one per video output
+    private const int MaxEncodeSlots = 8;
+    private const int DefaultEncodeSlots = 2;
+
     private readonly IClippingService _clippingService;
     private readonly OverlayCompositor _overlayCompositor;
     private readonly OverlayRepository _overlayRepository;
     private readonly SessionRepository _sessionRepository;
     private readonly GolfSession _golfSession;
+    private readonly IUploadService? _uploadService;
+    private readonly LiveOverlayCompositor? _liveOverlays;
     private readonly ILogger<ClipExportService> _logger;
     private readonly ResiliencePipeline _retryPipeline;
 
+    private readonly Channel<SwingSequence> _pending = Channel.CreateUnbounded<SwingSequence>(
+        new UnboundedChannelOptions { SingleReader = true });
+    private readonly SemaphoreSlim _encodeSlots = new(DefaultEncodeSlots, MaxEncodeSlots);
+    private readonly object _slotLock = new();
+    private int _maxConcurrentEncodes = DefaultEncodeSlots;
+    private Task? _extractionTask;
+
+    /// <summary>Everything known about a swing once its base clip is cut.</summary>
+    private sealed record ExtractedSwing(
+        SwingSequence Sequence,
+        string ClipName,
+        string OutputDirectory,
+        string BasePath,
+        string? GolferName,
+        BurnedInOverlays BurnedIn);
+
     /// <summary>Fired when a clip export completes (success or failure).</summary>
     public event EventHandler<ExportCompletedEventArgs>? ExportCompleted;
 
     /// <summary>Fired when export status changes for progress tracking.</summary>
     public event EventHandler<ExportProgressEventArgs>? ExportProgressChanged;
 
+    /// <summary>Extra outputs rendered next to each final clip.</summary>
+    public ClipRenditions Renditions { get; set; } = ClipRenditions.None;
+
+    /// <summary>FFmpeg H.264 encoder for composited clips and renditions.</summary>
+    public string VideoEncoder { get; set; } = "libx264";
+
+    /// <summary>
+    /// Provider that finished clips and renditions are uploaded to as they are written
+    /// (null to not upload).
+    /// </summary>
+    public string? UploadProviderId { get; set; }
+
+    /// <summary>
+    /// FFmpeg passes allowed to run at once (1 to 8). Lowering it takes effect as running
+    /// passes finish.
+    /// </summary>
+    public int MaxConcurrentEncodes
+    {
+        get => _maxConcurrentEncodes;
+        set
+        {
+            value = Math.Clamp(value, 1, MaxEncodeSlots);
+            lock (_slotLock)
+            {
+                int delta = value - _maxConcurrentEncodes;
+                _maxConcurrentEncodes = value;
+
+                if (delta > 0)
+                    _encodeSlots.Release(delta);
+
+                // Retire slots by taking them for good as they are freed
+                for (int i = 0; i < -delta; i++)
+                    _ = _encodeSlots.WaitAsync();
+            }
+        }
+    }
+
     public ClipExportService(
         IClippingService clippingService,
         OverlayCompositor overlayCompositor,
         OverlayRepository overlayRepository,
         SessionRepository sessionRepository,
         GolfSession golfSession,
-        ILogger<ClipExportService> logger)
+        ILogger<ClipExportService> logger,
+        IUploadService? uploadService = null,
+        LiveOverlayCompositor? liveOverlays = null)
     {
         _clippingService = clippingService;
         _overlayCompositor = overlayCompositor;
@@ -44,6 +115,8 @@ public class ClipExportService
         _sessionRepository = sessionRepository;
         _golfSession = golfSession;
         _logger = logger;
+        _uploadService = uploadService;
+        _liveOverlays = liveOverlays;
 
         _retryPipeline = new ResiliencePipelineBuilder()
             .AddRetry(new RetryStrategyOptions
@@ -68,149 +141,254 @@ public class ClipExportService
     public void WireUp(SequenceRecorder recorder)
     {
         recorder.SequenceCompleted += OnSequenceCompleted;
+        _extractionTask ??= Task.Run(RunExtractionLoopAsync);
     }
 
     private void OnSequenceCompleted(object? sender, SwingSequence sequence)
     {
-        // Run export on background thread to avoid blocking the UI
-        Task.Run(async () =>
+        // Exported on background threads to avoid blocking the UI
+        RaiseProgress(sequence.SequenceNumber, "Queued");
+        _pending.Writer.TryWrite(sequence);
+    }
+
+    private async Task RunExtractionLoopAsync()
+    {
+        await foreach (var sequence in _pending.Reader.ReadAllAsync())
         {
+            ExtractedSwing? extracted;
             try
             {
-                await ExportSequenceAsync(sequence);
+                extracted = await ExtractAsync(sequence);
             }
             catch (Exception ex)
             {
-                _logger.LogError(ex, "Failed to export swing #{Num}", sequence.SequenceNumber);
+                await FailAsync(sequence, ex);
+                continue;
             }
-        });
+
+            if (extracted == null)
+                continue;
+
+            // Rendered in the background so the next swing can be cut meanwhile
+            _ = Task.Run(async () =>
+            {
+                try
+                {
+                    await RenderAsync(extracted);
+                }
+                catch (Exception ex)
+                {
+                    await FailAsync(sequence, ex);
+                }
+            });
+        }
     }
 
-    private async Task ExportSequenceAsync(SwingSequence sequence)
+    private async Task<ExtractedSwing?> ExtractAsync(SwingSequence sequence)
     {
         var session = _golfSession.CurrentSession;
         if (session == null)
         {
             _logger.LogWarning("No active session for export of swing #{Num}", sequence.SequenceNumber);
-            return;
+            return null;
         }
 
         if (string.IsNullOrEmpty(session.Source2RecordingPath))
         {
             _logger.LogWarning("No Source2 recording path set for swing #{Num}", sequence.SequenceNumber);
-            return;
+            return null;
         }
 
         if (!sequence.OutPointTicks.HasValue)
         {
             _logger.LogWarning("Swing #{Num} has no out point, skipping export", sequence.SequenceNumber);
-            return;
+            return null;
         }
 
         var swingNum = sequence.SequenceNumber;
 
-        try
+        // Update status: extracting
+        RaiseProgress(swingNum, "Extracting");
+        await _sessionRepository.UpdateExportStatusAsync(sequence.Id, "extracting");
+
+        // Convert UTC ticks to recording-relative TimeSpan offsets
+        var inOffset = TimeSpan.FromTicks(sequence.InPointTicks - session.StartedAt.UtcTicks);
+        var outOffset = TimeSpan.FromTicks(sequence.OutPointTicks.Value - session.StartedAt.UtcTicks);
+
+        // Clamp to non-negative
+        if (inOffset < TimeSpan.Zero) inOffset = TimeSpan.Zero;
+        if (outOffset < TimeSpan.Zero) outOffset = TimeSpan.Zero;
+
+        // Set active recording to the simulator source
+        _clippingService.SetActiveRecording(session.Source2RecordingPath!);
+
+        // Create clip definition
+        var clipName = $"Swing_{swingNum:D3}_{session.GolferDisplayName ?? "Unknown"}";
+        var clip = await _clippingService.CreateClipAsync(clipName, inOffset, outOffset);
+
+        // Extract base clip with retry
+        var outputDir = Path.Combine(
+            Path.GetDirectoryName(session.Source2RecordingPath)!,
+            "Swings");
+        var options = new ClipExtractionOptions(outputDir, "{name}");
+        int extractAttempt = 0;
+        var basePath = await _retryPipeline.ExecuteAsync(async ct =>
         {
-            // Update status: extracting
-            RaiseProgress(swingNum, "Extracting");
-            await _sessionRepository.UpdateExportStatusAsync(sequence.Id, "extracting");
-
-            // Convert UTC ticks to recording-relative TimeSpan offsets
-            var inOffset = TimeSpan.FromTicks(sequence.InPointTicks - session.StartedAt.UtcTicks);
-            var outOffset = TimeSpan.FromTicks(sequence.OutPointTicks.Value - session.StartedAt.UtcTicks);
-
-            // Clamp to non-negative
-            if (inOffset < TimeSpan.Zero) inOffset = TimeSpan.Zero;
-            if (outOffset < TimeSpan.Zero) outOffset = TimeSpan.Zero;
-
-            // Set active recording to the simulator source
-            _clippingService.SetActiveRecording(session.Source2RecordingPath!);
-
-            // Create clip definition
-            var clipName = $"Swing_{swingNum:D3}_{session.GolferDisplayName ?? "Unknown"}";
-            var clip = await _clippingService.CreateClipAsync(clipName, inOffset, outOffset);
-
-            // Extract base clip with retry
-            var outputDir = Path.Combine(
-                Path.GetDirectoryName(session.Source2RecordingPath)!,
-                "Swings");
-            var options = new ClipExtractionOptions(outputDir, "{name}");
-            int extractAttempt = 0;
-            var basePath = await _retryPipeline.ExecuteAsync(async ct =>
-            {
-                extractAttempt++;
-                if (extractAttempt > 1)
-                    RaiseProgress(swingNum, $"Retrying extraction (attempt {extractAttempt})");
-                return await _clippingService.ExtractClipAsync(clip, options);
-            });
+            extractAttempt++;
+            if (extractAttempt > 1)
+                RaiseProgress(swingNum, $"Retrying extraction (attempt {extractAttempt})");
+            return await _clippingService.ExtractClipAsync(clip, options);
+        });
+
+        _logger.LogInformation("Base clip extracted for swing #{Num}: {Path}", swingNum, basePath);
 
-            _logger.LogInformation("Base clip extracted for swing #{Num}: {Path}", swingNum, basePath);
+        // Layers the live compositor put into every frame of the swing need no second pass
+        var burnedIn = session.Source2HasOverlays && _liveOverlays != null
+            ? _liveOverlays.GetBurnedIn(new DateTimeOffset(sequence.InPointTicks, TimeSpan.Zero),
+                new DateTimeOffset(sequence.OutPointTicks.Value, TimeSpan.Zero))
+            : default;
 
-            // Update status: applying overlays
-            RaiseProgress(swingNum, "Applying Overlays");
+        // The session may move on to the next golfer before this swing is rendered
+        return new ExtractedSwing(sequence, clipName, outputDir, basePath,
+            session.GolferDisplayName, burnedIn);
+    }
 
-            // Load overlay configs
-            var logoBugRecord = await _overlayRepository.GetDefaultAsync("logo_bug");
-            var lowerThirdRecord = await _overlayRepository.GetDefaultAsync("lower_third");
+    private async Task RenderAsync(ExtractedSwing swing)
+    {
+        var sequence = swing.Sequence;
+        var swingNum = sequence.SequenceNumber;
 
-            var logoBug = logoBugRecord?.DeserializeConfig<LogoBugConfig>();
-            var lowerThird = lowerThirdRecord?.DeserializeConfig<LowerThirdConfig>();
+        // Load overlay configs
+        var logoBugRecord = await _overlayRepository.GetDefaultAsync("logo_bug");
+        var lowerThirdRecord = await _overlayRepository.GetDefaultAsync("lower_third");
 
-            // Determine final output path
-            var finalPath = Path.Combine(outputDir, $"{clipName}_final.mp4");
+        // Layers composited live while recording are already in the base clip
+        var logoBug = swing.BurnedIn.Logo ? null : logoBugRecord?.DeserializeConfig<LogoBugConfig>();
+        var lowerThird = swing.BurnedIn.LowerThird ? null : lowerThirdRecord?.DeserializeConfig<LowerThirdConfig>();
 
-            bool hasOverlays = logoBug?.LogoPath != null || lowerThird?.Enabled == true;
+        bool composite = logoBug?.LogoPath != null || lowerThird?.Enabled == true;
+        var renditions = Renditions.Each().ToDictionary(
+            r => r, r => Path.Combine(swing.OutputDirectory, swing.ClipName + r.GetFileSuffix()));
 
-            if (hasOverlays)
+        // Determine final output path
+        var finalPath = composite
+            ? Path.Combine(swing.OutputDirectory, $"{swing.ClipName}_final.mp4")
+            : swing.BasePath;
+
+        // No overlays configured, or burned in live — the base clip is the final clip and can
+        // go up while the renditions render
+        if (!composite)
+            await EnqueueUploadAsync(finalPath);
+
+        if (composite || renditions.Count > 0)
+        {
+            RaiseProgress(swingNum, "Waiting for encoder");
+            await _encodeSlots.WaitAsync();
+            try
             {
-                int overlayAttempt = 0;
+                // Update status: applying overlays
+                RaiseProgress(swingNum, composite ? "Applying Overlays" : "Rendering");
+
+                int renderAttempt = 0;
                 await _retryPipeline.ExecuteAsync(async ct =>
                 {
-                    overlayAttempt++;
-                    if (overlayAttempt > 1)
-                        RaiseProgress(swingNum, $"Retrying overlays (attempt {overlayAttempt})");
-                    await _overlayCompositor.ExportWithOverlaysAsync(
-                        basePath,
-                        finalPath,
-                        session.GolferDisplayName,
-                        logoBug,
-                        lowerThird,
-                        ct);
+                    renderAttempt++;
+                    if (renderAttempt > 1)
+                        RaiseProgress(swingNum, $"Retrying overlays (attempt {renderAttempt})");
+
+                    if (renditions.Count == 0)
+                    {
+                        await _overlayCompositor.ExportWithOverlaysAsync(
+                            swing.BasePath,
+                            finalPath,
+                            swing.GolferName,
+                            logoBug,
+                            lowerThird,
+                            ct);
+                    }
+                    else
+                    {
+                        await _overlayCompositor.ExportRenditionsAsync(
+                            swing.BasePath,
+                            composite ? finalPath : null,
+                            renditions,
+                            composite,
+                            swing.GolferName,
+                            logoBug,
+                            lowerThird,
+                            VideoEncoder,
+                            ct);
+                    }
                 });
             }
-            else
+            finally
             {
-                // No overlays configured — the base clip is the final clip
-                finalPath = basePath;
+                _encodeSlots.Release();
             }
 
-            // Update DB status
-            await _sessionRepository.UpdateExportStatusAsync(sequence.Id, "completed", finalPath);
+            if (composite)
+                await EnqueueUploadAsync(finalPath);
+            foreach (var path in renditions.Values)
+                await EnqueueUploadAsync(path);
+        }
 
-            _logger.LogInformation("Export complete for swing #{Num}: {Path}", swingNum, finalPath);
+        // Update DB status
+        await _sessionRepository.UpdateExportStatusAsync(sequence.Id, "completed", finalPath);
 
-            RaiseProgress(swingNum, "Complete");
-            ExportCompleted?.Invoke(this, new ExportCompletedEventArgs
-            {
-                SwingNumber = swingNum,
-                OutputPath = finalPath,
-                Duration = sequence.Duration,
-                Success = true
-            });
+        _logger.LogInformation("Export complete for swing #{Num}: {Path}", swingNum, finalPath);
+
+        RaiseProgress(swingNum, "Complete");
+        ExportCompleted?.Invoke(this, new ExportCompletedEventArgs
+        {
+            SwingNumber = swingNum,
+            OutputPath = finalPath,
+            Duration = sequence.Duration,
+            Success = true,
+            Renditions = renditions
+        });
+    }
+
+    private async Task EnqueueUploadAsync(string path)
+    {
+        var providerId = UploadProviderId;
+        if (_uploadService == null || providerId == null || !File.Exists(path))
+            return;
+
+        try
+        {
+            await _uploadService.EnqueueAsync(new UploadRequest(
+                path,
+                providerId,
+                $"golf/{Path.GetFileName(path)}"));
+            _logger.LogInformation("Auto-upload enqueued for {Path}", path);
         }
         catch (Exception ex)
         {
-            _logger.LogError(ex, "Export failed for swing #{Num}", swingNum);
-            await _sessionRepository.UpdateExportStatusAsync(sequence.Id, "failed");
+            _logger.LogWarning(ex, "Could not enqueue upload of {Path}", path);
+        }
+    }
 
-            RaiseProgress(swingNum, "Failed");
-            ExportCompleted?.Invoke(this, new ExportCompletedEventArgs
-            {
-                SwingNumber = swingNum,
-                Success = false,
-                ErrorMessage = ex.Message
-            });
+    private async Task FailAsync(SwingSequence sequence, Exception ex)
+    {
+        var swingNum = sequence.SequenceNumber;
+        _logger.LogError(ex, "Export failed for swing #{Num}", swingNum);
+
+        try
+        {
+            await _sessionRepository.UpdateExportStatusAsync(sequence.Id, "failed");
+        }
+        catch (Exception dbEx)
+        {
+            _logger.LogError(dbEx, "Failed to record export failure of swing #{Num}", swingNum);
         }
+
+        RaiseProgress(swingNum, "Failed");
+        ExportCompleted?.Invoke(this, new ExportCompletedEventArgs
+        {
+            SwingNumber = swingNum,
+            Success = false,
+            ErrorMessage = ex.Message
+        });
     }
 
     private void RaiseProgress(int swingNumber, string status)
@@ -230,6 +408,10 @@ public class ExportCompletedEventArgs : EventArgs
     public TimeSpan? Duration { get; init; }
     public bool Success { get; init; }
     public string? ErrorMessage { get; init; }
+
+    /// <summary>Rendition files written next to the final clip.</summary>
+    public IReadOnlyDictionary<ClipRenditions, string> Renditions { get; init; } =
+        new Dictionary<ClipRenditions, string>();
 }
 
 public class ExportProgressEventArgs : EventArgs
@@ -0,0 +1,47 @@
+namespace Screener.Golf.Export;
+
+/// <summary>
+/// Extra outputs rendered from an exported swing in the same FFmpeg pass as the final clip,
+/// so the clip is decoded (and the overlays composited) once for all of them.
+/// </summary>
+[Flags]
+public enum ClipRenditions
+{
+    None = 0,
+
+    /// <summary>9:16 centre crop at 1080x1920 for social feeds.</summary>
+    Vertical = 1,
+
+    /// <summary>1920x1080 copy for sources recorded above HD.</summary>
+    Hd1080 = 2,
+
+    /// <summary>JPEG poster frame.</summary>
+    Thumbnail = 4,
+
+    /// <summary>Short looping preview at 480 px wide.</summary>
+    Gif = 8
+}
+
+public static class ClipRenditionsExtensions
+{
+    private static readonly ClipRenditions[] Singles =
+        [ClipRenditions.Vertical, ClipRenditions.Hd1080, ClipRenditions.Thumbnail, ClipRenditions.Gif];
+
+    /// <summary>
+    /// The individual renditions set in these flags, in output order.
+    /// </summary>
+    public static IEnumerable<ClipRenditions> Each(this ClipRenditions renditions) =>
+        Singles.Where(r => renditions.HasFlag(r));
+
+    /// <summary>
+    /// Appended to the clip name for a single rendition's file.
+    /// </summary>
+    public static string GetFileSuffix(this ClipRenditions rendition) => rendition switch
+    {
+        ClipRenditions.Vertical => "_vertical.mp4",
+        ClipRenditions.Hd1080 => "_1080p.mp4",
+        ClipRenditions.Thumbnail => "_thumb.jpg",
+        ClipRenditions.Gif => "_preview.gif",
+        _ => throw new ArgumentOutOfRangeException(nameof(rendition), rendition, "Not a single rendition")
+    };
+}
@@ -12,6 +12,13 @@ public class GolfSessionInfo
     public DateTimeOffset? EndedAt { get; set; }
     public string? Source1RecordingPath { get; set; }
     public string? Source2RecordingPath { get; set; }
+
+    /// <summary>
+    /// True when the live overlay compositor is attached to the Source2 recording. Which layers
+    /// it burned in, and when, comes from <see cref="Overlays.LiveOverlayCompositor.GetBurnedIn"/>.
+    /// </summary>
+    public bool Source2HasOverlays { get; set; }
+
     public int TotalSwings { get; set; }
     public bool IsActive => EndedAt == null;
 }
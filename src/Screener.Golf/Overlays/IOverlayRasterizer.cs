@@ -0,0 +1,25 @@
+namespace Screener.Golf.Overlays;
+
+/// <summary>
+/// Renders overlay configurations to bitmaps for live compositing. Implemented by the UI,
+/// which owns image decoding and text layout.
+/// </summary>
+public interface IOverlayRasterizer
+{
+    /// <summary>
+    /// Decode and scale the logo (LogoPath, Scale). Null if there is no usable image.
+    /// </summary>
+    OverlayImage? RenderLogo(LogoBugConfig config);
+
+    /// <summary>
+    /// Render the golfer name with the configured font, color and background box. The image's
+    /// top-left corner sits at (X - pad, H - YFromBottom - pad), as drawtext places it, where
+    /// pad is BoxPadding when ShowBox is set and 0 otherwise.
+    /// </summary>
+    OverlayImage? RenderLowerThird(LowerThirdConfig config, string golferName);
+}
+
+/// <summary>
+/// Straight-alpha BGRA pixels, tightly packed (Width * 4 bytes per row).
+/// </summary>
+public sealed record OverlayImage(byte[] Pixels, int Width, int Height);
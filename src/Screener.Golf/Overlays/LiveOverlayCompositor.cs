@@ -0,0 +1,262 @@
+using Microsoft.Extensions.Logging;
+using Screener.Abstractions.Capture;
+using Screener.Abstractions.Encoding;
+using Screener.Golf.Models;
+using Screener.Golf.Persistence;
+using Screener.Golf.Switching;
+
+namespace Screener.Golf.Overlays;
+
+/// <summary>
+/// Burns the logo bug and the active golfer's lower third into frames as they are encoded,
+/// so swing clips cut from the recording are final without an ffmpeg re-encode. Overlays are
+/// rasterised once per configuration and golfer, and pre-converted once per video mode. Which
+/// layers went into the frames is kept by wall-clock time, so an export composites exactly the
+/// layers its range is missing.
+/// </summary>
+public sealed class LiveOverlayCompositor : IVideoOverlay
+{
+    // Frames further apart than this are separate spans: the gap was not composited
+    private static readonly long MaxFrameGapTicks = TimeSpan.FromSeconds(1).Ticks;
+
+    // Spans older than this are forgotten; swings are exported within minutes
+    private static readonly long SpanRetentionTicks = TimeSpan.FromHours(4).Ticks;
+
+    private readonly OverlayRepository _overlayRepository;
+    private readonly IOverlayRasterizer _rasterizer;
+    private readonly GolfSession _golfSession;
+    private readonly ILogger<LiveOverlayCompositor> _logger;
+    private readonly object _lock = new();
+
+    private LogoBugConfig? _logoBug;
+    private LowerThirdConfig? _lowerThird;
+    private OverlayImage? _logo;
+
+    // Rendered lower thirds by golfer, so switching back to a golfer costs nothing
+    private readonly Dictionary<string, OverlayImage?> _lowerThirds = new();
+    private OverlayImage? _activeLowerThird;
+
+    // Bumped whenever the overlay content changes; prepared layers are rebuilt lazily
+    private int _version;
+    private volatile PreparedLayers? _prepared;
+
+    // Burn-in timeline, oldest first. The open span is extended by the encoding thread.
+    private readonly List<BurnSpan> _spans = new();
+    private BurnSpan? _openSpan;
+
+    public LiveOverlayCompositor(
+        OverlayRepository overlayRepository,
+        IOverlayRasterizer rasterizer,
+        GolfSession golfSession,
+        ILogger<LiveOverlayCompositor> logger)
+    {
+        _overlayRepository = overlayRepository;
+        _rasterizer = rasterizer;
+        _golfSession = golfSession;
+        _logger = logger;
+
+        _golfSession.SessionStarted += (_, session) => SetGolfer(session);
+        _golfSession.SessionEnded += (_, _) => SetGolfer(null);
+    }
+
+    /// <summary>
+    /// True when a logo or lower third is loaded.
+    /// </summary>
+    public bool HasContent
+    {
+        get
+        {
+            lock (_lock)
+            {
+                return _logo != null || _activeLowerThird != null;
+            }
+        }
+    }
+
+    /// <summary>
+    /// Reload the default overlay configurations and re-render them. Call before recording
+    /// starts and after overlay settings change.
+    /// </summary>
+    public async Task RefreshAsync()
+    {
+        var logoBug = (await _overlayRepository.GetDefaultAsync("logo_bug"))?.DeserializeConfig<LogoBugConfig>();
+        var lowerThird = (await _overlayRepository.GetDefaultAsync("lower_third"))?.DeserializeConfig<LowerThirdConfig>();
+
+        OverlayImage? logo = null;
+        if (logoBug?.LogoPath != null && File.Exists(logoBug.LogoPath))
+        {
+            try
+            {
+                logo = _rasterizer.RenderLogo(logoBug);
+            }
+            catch (Exception ex)
+            {
+                _logger.LogWarning(ex, "Failed to render logo bug: {Path}", logoBug.LogoPath);
+            }
+        }
+
+        lock (_lock)
+        {
+            _logoBug = logoBug;
+            _lowerThird = lowerThird;
+            _logo = logo;
+            _lowerThirds.Clear();
+        }
+
+        SetGolfer(_golfSession.CurrentSession);
+        _logger.LogInformation("Live overlays loaded (logo: {Logo}, lower third: {LowerThird})",
+            logo != null, lowerThird?.Enabled == true);
+    }
+
+    public bool Supports(VideoMode mode) => OverlayLayer.SupportsFormat(mode.PixelFormat);
+
+    public void Apply(Span<byte> frame, int rowBytes, VideoMode mode)
+    {
+        var prepared = _prepared;
+        if (prepared == null || prepared.Mode != mode || prepared.Version != Volatile.Read(ref _version))
+            prepared = Prepare(mode);
+
+        bool logo = false, lowerThird = false;
+        foreach (var layer in prepared.Layers)
+        {
+            if ((long)(layer.Y + layer.Height - 1) * rowBytes + (layer.X + layer.Width) * layer.BytesPerPixel <= frame.Length)
+            {
+                layer.Apply(frame, rowBytes);
+                logo |= layer == prepared.Logo;
+                lowerThird |= layer == prepared.LowerThird;
+            }
+        }
+
+        RecordApplied(logo, lowerThird);
+    }
+
+    /// <summary>
+    /// The layers burned into every frame composited between from and to. A layer missing from
+    /// any part of the range (not configured yet, failed to render, or no frames composited at
+    /// all) is reported as not burned in, so the export adds it.
+    /// </summary>
+    public BurnedInOverlays GetBurnedIn(DateTimeOffset from, DateTimeOffset to)
+    {
+        long start = from.UtcTicks, end = to.UtcTicks;
+        bool logo = true, lowerThird = true;
+        long covered = start;
+
+        lock (_spans)
+        {
+            foreach (var span in _spans)
+            {
+                long spanEnd = Volatile.Read(ref span.End);
+                if (spanEnd < start || span.Start > end)
+                    continue;
+                if (span.Start - covered > MaxFrameGapTicks)
+                    return default;
+
+                logo &= span.Logo;
+                lowerThird &= span.LowerThird;
+                covered = Math.Max(covered, spanEnd);
+            }
+        }
+
+        return end - covered > MaxFrameGapTicks ? default : new BurnedInOverlays(logo, lowerThird);
+    }
+
+    // Encoding thread: extends the open span, or opens one when the layers change or frames
+    // stopped for a while (recording stopped, overlay detached)
+    private void RecordApplied(bool logo, bool lowerThird)
+    {
+        long now = DateTime.UtcNow.Ticks;
+        var span = _openSpan;
+        if (span != null && span.Logo == logo && span.LowerThird == lowerThird &&
+            now - Volatile.Read(ref span.End) <= MaxFrameGapTicks)
+        {
+            Volatile.Write(ref span.End, now);
+            return;
+        }
+
+        span = new BurnSpan(now, logo, lowerThird);
+        lock (_spans)
+        {
+            _spans.RemoveAll(s => now - Volatile.Read(ref s.End) > SpanRetentionTicks);
+            _spans.Add(span);
+        }
+        _openSpan = span;
+    }
+
+    private void SetGolfer(GolfSessionInfo? session)
+    {
+        var name = session?.IsActive == true ? session.GolferDisplayName : null;
+
+        lock (_lock)
+        {
+            OverlayImage? image = null;
+            if (_lowerThird?.Enabled == true && !string.IsNullOrEmpty(name))
+            {
+                var key = session!.GolferId ?? name;
+                if (!_lowerThirds.TryGetValue(key, out image))
+                {
+                    try
+                    {
+                        image = _rasterizer.RenderLowerThird(_lowerThird, name);
+                    }
+                    catch (Exception ex)
+                    {
+                        _logger.LogWarning(ex, "Failed to render lower third for {Golfer}", name);
+                    }
+                    _lowerThirds[key] = image;
+                }
+            }
+
+            _activeLowerThird = image;
+            _version++;
+        }
+    }
+
+    // Runs on the encoding thread when the content or mode changed: only premultiplication
+    // and color conversion of the (small) overlay rects, rasterising already happened
+    private PreparedLayers Prepare(VideoMode mode)
+    {
+        lock (_lock)
+        {
+            var layers = new List<OverlayLayer>(2);
+            OverlayLayer? logoLayer = null, lowerThirdLayer = null;
+
+            if (_logoBug != null && _logo != null)
+            {
+                var (x, y) = _logoBug.GetPixelPosition(mode.Width, mode.Height, _logo.Width, _logo.Height);
+                logoLayer = OverlayLayer.Create(_logo, x, y, _logoBug.Opacity, mode);
+                if (logoLayer != null)
+                    layers.Add(logoLayer);
+            }
+
+            // Lower third on top, as drawtext follows the logo overlay in the ffmpeg chain
+            if (_lowerThird != null && _activeLowerThird != null)
+            {
+                int pad = _lowerThird.ShowBox ? _lowerThird.BoxPadding : 0;
+                lowerThirdLayer = OverlayLayer.Create(_activeLowerThird, _lowerThird.X - pad,
+                    mode.Height - _lowerThird.YFromBottom - pad, 1.0, mode);
+                if (lowerThirdLayer != null)
+                    layers.Add(lowerThirdLayer);
+            }
+
+            var prepared = new PreparedLayers(mode, _version, layers, logoLayer, lowerThirdLayer);
+            _prepared = prepared;
+            return prepared;
+        }
+    }
+
+    private sealed record PreparedLayers(VideoMode Mode, int Version, List<OverlayLayer> Layers,
+        OverlayLayer? Logo, OverlayLayer? LowerThird);
+
+    private sealed class BurnSpan(long start, bool logo, bool lowerThird)
+    {
+        public readonly long Start = start;
+        public readonly bool Logo = logo;
+        public readonly bool LowerThird = lowerThird;
+        public long End = start;
+    }
+}
+
+/// <summary>
+/// Which live overlay layers a recorded range already carries.
+/// </summary>
+public readonly record struct BurnedInOverlays(bool Logo, bool LowerThird);
@@ -41,6 +41,21 @@ public class LogoBugConfig
             _ => $"x=W-w-{Margin}:y={Margin}"
         };
     }
+
+    /// <summary>
+    /// Top-left pixel position of a width x height logo in a frame, matching <see cref="GetOverlayPosition"/>.
+    /// </summary>
+    public (int X, int Y) GetPixelPosition(int frameWidth, int frameHeight, int width, int height)
+    {
+        return Position switch
+        {
+            LogoPosition.TopLeft => (Margin, Margin),
+            LogoPosition.BottomLeft => (Margin, frameHeight - height - Margin),
+            LogoPosition.BottomRight => (frameWidth - width - Margin, frameHeight - height - Margin),
+            LogoPosition.Custom => ((int)CustomX, (int)CustomY),
+            _ => (frameWidth - width - Margin, Margin)
+        };
+    }
 }
 
 public enum LogoPosition
@@ -1,5 +1,6 @@
 using System.Diagnostics;
 using Microsoft.Extensions.Logging;
+using Screener.Golf.Export;
 
 namespace Screener.Golf.Overlays;
 
@@ -39,7 +40,56 @@ public class OverlayCompositor
         _logger.LogDebug("FFmpeg args: {Args}", args);
 
         Directory.CreateDirectory(Path.GetDirectoryName(outputPath)!);
+        await RunFfmpegAsync(args, "overlay export", ct);
 
+        _logger.LogInformation("Overlay export complete: {Output}", outputPath);
+    }
+
+    /// <summary>
+    /// Export the final clip and its renditions in one FFmpeg pass: the clip is decoded and
+    /// composited once, then split to each output.
+    /// </summary>
+    /// <param name="inputPath">Source clip file path.</param>
+    /// <param name="outputPath">Final clip path, or null when the source is already the final
+    /// clip and only the renditions are wanted.</param>
+    /// <param name="renditions">Output path for each single rendition.</param>
+    /// <param name="compositeOverlays">False when the source already carries the overlays.</param>
+    /// <param name="golferName">Golfer display name for lower third.</param>
+    /// <param name="logoBug">Logo bug configuration (null to skip).</param>
+    /// <param name="lowerThird">Lower third configuration (null to skip).</param>
+    /// <param name="videoEncoder">FFmpeg H.264 encoder (libx264, h264_nvenc, h264_qsv, h264_amf).</param>
+    /// <param name="ct">Cancellation token.</param>
+    public async Task ExportRenditionsAsync(
+        string inputPath,
+        string? outputPath,
+        IReadOnlyDictionary<ClipRenditions, string> renditions,
+        bool compositeOverlays,
+        string? golferName,
+        LogoBugConfig? logoBug,
+        LowerThirdConfig? lowerThird,
+        string videoEncoder = "libx264",
+        CancellationToken ct = default)
+    {
+        var args = BuildRenditionArgs(inputPath, outputPath, renditions, compositeOverlays,
+            golferName, logoBug, lowerThird, videoEncoder);
+
+        _logger.LogInformation("Exporting {Count} rendition(s) of {Input} with {Encoder}",
+            renditions.Count + (outputPath != null ? 1 : 0), inputPath, videoEncoder);
+        _logger.LogDebug("FFmpeg args: {Args}", args);
+
+        foreach (var path in renditions.Values.Append(outputPath))
+        {
+            if (path != null)
+                Directory.CreateDirectory(Path.GetDirectoryName(path)!);
+        }
+
+        await RunFfmpegAsync(args, "rendition export", ct);
+
+        _logger.LogInformation("Rendition export complete: {Input}", inputPath);
+    }
+
+    private async Task RunFfmpegAsync(string args, string operation, CancellationToken ct)
+    {
         var psi = new ProcessStartInfo
         {
             FileName = "ffmpeg",
@@ -58,11 +108,9 @@ public class OverlayCompositor
 
         if (process.ExitCode != 0)
         {
-            _logger.LogError("FFmpeg overlay export failed: {Stderr}", stderr);
-            throw new InvalidOperationException($"FFmpeg overlay export failed: {stderr}");
+            _logger.LogError("FFmpeg {Operation} failed: {Stderr}", operation, stderr);
+            throw new InvalidOperationException($"FFmpeg {operation} failed: {stderr}");
         }
-
-        _logger.LogInformation("Overlay export complete: {Output}", outputPath);
     }
 
     /// <summary>
@@ -75,30 +123,123 @@ public class OverlayCompositor
         LogoBugConfig? logoBug,
         LowerThirdConfig? lowerThird)
     {
-        bool hasLogo = logoBug?.LogoPath != null && File.Exists(logoBug.LogoPath);
-        bool hasLowerThird = lowerThird?.Enabled == true && !string.IsNullOrEmpty(golferName);
+        var inputArgs = $"-y -i \"{inputPath}\"";
+        var filters = new List<string>();
+        string currentStream = "[0:v]";
 
         // No overlays - just stream copy
-        if (!hasLogo && !hasLowerThird)
+        if (!AppendOverlayFilters(filters, ref inputArgs, ref currentStream, golferName, logoBug, lowerThird))
         {
-            return $"-y -i \"{inputPath}\" -c copy \"{outputPath}\"";
+            return $"{inputArgs} -c copy \"{outputPath}\"";
         }
 
+        var filterComplex = string.Join(";", filters);
+
+        return $"{inputArgs} -filter_complex \"{filterComplex}\" -map \"{currentStream}\" -map 0:a? " +
+               $"{VideoEncoderArgs("libx264")} -c:a aac -movflags +faststart \"{outputPath}\"";
+    }
+
+    /// <summary>
+    /// Build the FFmpeg arguments for one pass that writes the final clip and its renditions.
+    /// </summary>
+    internal string BuildRenditionArgs(
+        string inputPath,
+        string? outputPath,
+        IReadOnlyDictionary<ClipRenditions, string> renditions,
+        bool compositeOverlays,
+        string? golferName,
+        LogoBugConfig? logoBug,
+        LowerThirdConfig? lowerThird,
+        string videoEncoder = "libx264")
+    {
+        var inputArgs = $"-y -i \"{inputPath}\"";
         var filters = new List<string>();
         string currentStream = "[0:v]";
-        int inputIndex = 1;
 
-        var inputArgs = $"-y -i \"{inputPath}\"";
+        bool composited = compositeOverlays &&
+            AppendOverlayFilters(filters, ref inputArgs, ref currentStream, golferName, logoBug, lowerThird);
+
+        // Without compositing the final clip is a stream copy and takes no branch of the split
+        var branches = new List<string>();
+        if (outputPath != null && composited)
+            branches.Add("[main]");
+        foreach (var rendition in renditions.Keys)
+            branches.Add($"[{BranchLabel(rendition)}_in]");
+
+        if (branches.Count == 1)
+            filters.Add($"{currentStream}null{branches[0]}");
+        else if (branches.Count > 1)
+            filters.Add($"{currentStream}split={branches.Count}{string.Join("", branches)}");
+
+        var outputs = new List<string>();
+        var encoder = VideoEncoderArgs(videoEncoder);
+
+        if (outputPath != null)
+        {
+            outputs.Add(composited
+                ? $"-map \"[main]\" -map 0:a? {encoder} -c:a aac -movflags +faststart \"{outputPath}\""
+                : $"-map 0:v -map 0:a? -c copy -movflags +faststart \"{outputPath}\"");
+        }
+
+        foreach (var (rendition, path) in renditions)
+        {
+            var label = BranchLabel(rendition);
+            switch (rendition)
+            {
+                case ClipRenditions.Vertical:
+                    filters.Add($"[{label}_in]crop=trunc(ih*9/16/2)*2:ih,scale=1080:1920:flags=lanczos,setsar=1[{label}]");
+                    outputs.Add($"-map \"[{label}]\" -map 0:a? {encoder} -c:a aac -movflags +faststart \"{path}\"");
+                    break;
+
+                case ClipRenditions.Hd1080:
+                    filters.Add($"[{label}_in]scale=-2:1080:flags=lanczos[{label}]");
+                    outputs.Add($"-map \"[{label}]\" -map 0:a? {encoder} -c:a aac -movflags +faststart \"{path}\"");
+                    break;
+
+                case ClipRenditions.Thumbnail:
+                    // Most representative frame of the first 100, not the first frame
+                    filters.Add($"[{label}_in]thumbnail,scale=1280:-2[{label}]");
+                    outputs.Add($"-map \"[{label}]\" -frames:v 1 -q:v 2 -an \"{path}\"");
+                    break;
+
+                case ClipRenditions.Gif:
+                    filters.Add($"[{label}_in]fps=12,scale=480:-2:flags=lanczos,split[{label}_a][{label}_b]");
+                    filters.Add($"[{label}_a]palettegen=stats_mode=diff[{label}_pal]");
+                    filters.Add($"[{label}_b][{label}_pal]paletteuse[{label}]");
+                    outputs.Add($"-map \"[{label}]\" -loop 0 -an \"{path}\"");
+                    break;
+
+                default:
+                    throw new ArgumentException($"Not a single rendition: {rendition}", nameof(renditions));
+            }
+        }
+
+        var filterArgs = filters.Count > 0 ? $" -filter_complex \"{string.Join(";", filters)}\"" : "";
+        return $"{inputArgs}{filterArgs} {string.Join(" ", outputs)}";
+    }
+
+    // Appends the logo bug and lower third to the filter graph; false if neither applies
+    private static bool AppendOverlayFilters(
+        List<string> filters,
+        ref string inputArgs,
+        ref string currentStream,
+        string? golferName,
+        LogoBugConfig? logoBug,
+        LowerThirdConfig? lowerThird)
+    {
+        bool hasLogo = logoBug?.LogoPath != null && File.Exists(logoBug.LogoPath);
+        bool hasLowerThird = lowerThird?.Enabled == true && !string.IsNullOrEmpty(golferName);
+
+        if (!hasLogo && !hasLowerThird)
+            return false;
+
+        int inputIndex = 1;
 
         // Logo bug
         if (hasLogo)
         {
             inputArgs += $" -i \"{logoBug!.LogoPath}\"";
 
-            var scaleFilter = logoBug.Scale != 1.0
-                ? $"[{inputIndex}:v]scale=iw*{logoBug.Scale:F2}:ih*{logoBug.Scale:F2}[logo_scaled];{currentStream}[logo_scaled]"
-                : $"{currentStream}[{inputIndex}:v]";
-
             var overlayPos = logoBug.GetOverlayPosition();
 
             if (logoBug.Scale != 1.0)
@@ -124,9 +265,19 @@ public class OverlayCompositor
             currentStream = outputLabel;
         }
 
-        var filterComplex = string.Join(";", filters);
-
-        return $"{inputArgs} -filter_complex \"{filterComplex}\" -map \"{currentStream}\" -map 0:a? " +
-               $"-c:v libx264 -crf 18 -preset medium -c:a aac -movflags +faststart \"{outputPath}\"";
+        return true;
     }
+
+    private static string BranchLabel(ClipRenditions rendition) => rendition.ToString().ToLowerInvariant();
+
+    /// <summary>
+    /// Quality-matched H.264 settings for a software or GPU encoder.
+    /// </summary>
+    internal static string VideoEncoderArgs(string videoEncoder) => videoEncoder switch
+    {
+        "h264_nvenc" => "-c:v h264_nvenc -preset p5 -rc vbr -cq 19 -b:v 0",
+        "h264_qsv" => "-c:v h264_qsv -preset medium -global_quality 19",
+        "h264_amf" => "-c:v h264_amf -quality quality -rc cqp -qp_i 18 -qp_p 20",
+        _ => "-c:v libx264 -crf 18 -preset medium"
+    };
 }
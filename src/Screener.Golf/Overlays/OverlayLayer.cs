@@ -0,0 +1,164 @@
+using Screener.Abstractions.Capture;
+using Screener.Core.Native;
+
+namespace Screener.Golf.Overlays;
+
+/// <summary>
+/// An overlay image pre-rasterised into a frame's own byte layout (BGRA or UYVY) as
+/// premultiplied color plus per-byte inverse alpha, so compositing it is one
+/// <see cref="MediaKernels.CompositeLayer"/> call per frame.
+/// </summary>
+public sealed class OverlayLayer
+{
+    private readonly byte[] _color;
+    private readonly byte[] _inverseAlpha;
+
+    private OverlayLayer(int x, int y, int width, int height, int bytesPerPixel, byte[] color, byte[] inverseAlpha)
+    {
+        X = x;
+        Y = y;
+        Width = width;
+        Height = height;
+        BytesPerPixel = bytesPerPixel;
+        _color = color;
+        _inverseAlpha = inverseAlpha;
+    }
+
+    /// <summary>Left edge in frame pixels (even for UYVY).</summary>
+    public int X { get; }
+    public int Y { get; }
+    public int Width { get; }
+    public int Height { get; }
+    public int BytesPerPixel { get; }
+    public int RowBytes => Width * BytesPerPixel;
+
+    /// <summary>
+    /// 8-bit interleaved formats the byte-wise kernel handles; 10-bit v210 keeps the ffmpeg export path.
+    /// </summary>
+    public static bool SupportsFormat(PixelFormat format) =>
+        format is PixelFormat.BGRA or PixelFormat.UYVY or PixelFormat.YUV422_8bit;
+
+    /// <summary>
+    /// Prepare image (straight-alpha BGRA) at (x, y) for frames of mode, clipped to the frame.
+    /// Returns null if nothing of it is visible.
+    /// </summary>
+    public static OverlayLayer? Create(OverlayImage image, int x, int y, double opacity, VideoMode mode)
+    {
+        if (!SupportsFormat(mode.PixelFormat))
+            throw new ArgumentException($"Overlays cannot be composited onto {mode.PixelFormat} frames", nameof(mode));
+
+        bool yuv = mode.PixelFormat != PixelFormat.BGRA;
+        int left = Math.Max(x, 0);
+        int top = Math.Max(y, 0);
+        int right = Math.Min(x + image.Width, mode.Width);
+        int bottom = Math.Min(y + image.Height, mode.Height);
+
+        // UYVY pixel pairs share chroma, so the layer covers whole pairs
+        if (yuv)
+        {
+            left &= ~1;
+            right = Math.Min((right + 1) & ~1, mode.Width & ~1);
+        }
+
+        int opacity8 = (int)Math.Round(Math.Clamp(opacity, 0.0, 1.0) * 255);
+        if (right <= left || bottom <= top || opacity8 == 0)
+            return null;
+
+        int width = right - left;
+        int height = bottom - top;
+        var premultiplied = Premultiply(image, x - left, y - top, width, height, opacity8);
+
+        return yuv
+            ? CreateUyvy(premultiplied, left, top, width, height, ColorMatrixExtensions.ForHeight(mode.Height))
+            : CreateBgra(premultiplied, left, top, width, height);
+    }
+
+    /// <summary>
+    /// Composite onto a frame whose rows are rowBytes apart.
+    /// </summary>
+    public void Apply(Span<byte> frame, int rowBytes)
+    {
+        MediaKernels.CompositeLayer(frame[(Y * rowBytes + X * BytesPerPixel)..], rowBytes,
+            _color, _inverseAlpha, RowBytes, RowBytes, Height);
+    }
+
+    // Straight BGRA at offset (imageX, imageY) into the layer rect -> premultiplied BGRA with
+    // opacity applied; pixels outside the image (pair padding) stay transparent
+    private static byte[] Premultiply(OverlayImage image, int imageX, int imageY, int width, int height, int opacity8)
+    {
+        var dst = new byte[width * height * 4];
+        var src = image.Pixels;
+
+        for (int row = 0; row < height; row++)
+        {
+            int sy = row - imageY;
+            if (sy < 0 || sy >= image.Height)
+                continue;
+
+            for (int col = 0; col < width; col++)
+            {
+                int sx = col - imageX;
+                if (sx < 0 || sx >= image.Width)
+                    continue;
+
+                int s = (sy * image.Width + sx) * 4;
+                int d = (row * width + col) * 4;
+                int a = (src[s + 3] * opacity8 + 127) / 255;
+                dst[d] = (byte)((src[s] * a + 127) / 255);
+                dst[d + 1] = (byte)((src[s + 1] * a + 127) / 255);
+                dst[d + 2] = (byte)((src[s + 2] * a + 127) / 255);
+                dst[d + 3] = (byte)a;
+            }
+        }
+
+        return dst;
+    }
+
+    private static OverlayLayer CreateBgra(byte[] premultiplied, int x, int y, int width, int height)
+    {
+        var inverseAlpha = new byte[premultiplied.Length];
+        for (int i = 0; i < premultiplied.Length; i += 4)
+        {
+            byte ia = (byte)(255 - premultiplied[i + 3]);
+            inverseAlpha[i] = ia;
+            inverseAlpha[i + 1] = ia;
+            inverseAlpha[i + 2] = ia;
+            inverseAlpha[i + 3] = ia;
+        }
+
+        return new OverlayLayer(x, y, width, height, 4, premultiplied, inverseAlpha);
+    }
+
+    // Converting premultiplied RGB gives Yp = 16 + k * (a * rgb): the premultiplied studio-range
+    // value a * Y is then Yp - 16 * (1 - a), and likewise for chroma around 128 with the pair's
+    // mean alpha. Chroma comes out alpha-weighted, so transparent neighbours add no fringe.
+    private static OverlayLayer CreateUyvy(byte[] premultiplied, int x, int y, int width, int height, ColorMatrix matrix)
+    {
+        var color = new byte[width * height * 2];
+        var inverseAlpha = new byte[color.Length];
+        MediaKernels.ConvertBgraToUyvy(premultiplied, width * 4, color, width * 2, width, height, matrix);
+
+        for (int p = 0; p < width * height; p += 2)
+        {
+            int a0 = premultiplied[p * 4 + 3];
+            int a1 = premultiplied[p * 4 + 7];
+            int pair = (a0 + a1 + 1) >> 1;
+            int i = p * 2;
+
+            color[i] = Unbias(color[i], 128, pair);
+            color[i + 1] = Unbias(color[i + 1], 16, a0);
+            color[i + 2] = Unbias(color[i + 2], 128, pair);
+            color[i + 3] = Unbias(color[i + 3], 16, a1);
+
+            inverseAlpha[i] = (byte)(255 - pair);
+            inverseAlpha[i + 1] = (byte)(255 - a0);
+            inverseAlpha[i + 2] = (byte)(255 - pair);
+            inverseAlpha[i + 3] = (byte)(255 - a1);
+        }
+
+        return new OverlayLayer(x, y, width, height, 2, color, inverseAlpha);
+    }
+
+    private static byte Unbias(byte value, int bias, int alpha) =>
+        (byte)Math.Clamp(value - (bias * (255 - alpha) + 127) / 255, 0, alpha);
+}
@@ -96,10 +96,13 @@ public class GolfSession
     /// <summary>
     /// Set recording paths for the session.
     /// </summary>
-    public void SetRecordingPaths(string? source1Path, string? source2Path)
+    /// <param name="source2HasOverlays">The live overlay compositor is attached to the Source2
+    /// recording, so exported clips skip the layers it burned in.</param>
+    public void SetRecordingPaths(string? source1Path, string? source2Path, bool source2HasOverlays = false)
     {
         if (_currentSession == null) return;
         _currentSession.Source1RecordingPath = source1Path;
         _currentSession.Source2RecordingPath = source2Path;
+        _currentSession.Source2HasOverlays = source2HasOverlays;
     }
 }
@@ -1,8 +1,12 @@
+using Screener.Abstractions.Capture;
+using Screener.Core.Native;
+
 namespace Screener.Golf.Switching;
 
 /// <summary>
-/// Pure-logic engine that blends two BGRA frames for transitions.
-/// No WPF dependencies — operates entirely on byte arrays.
+/// Pure-logic engine that blends two BGRA (or UYVY) frames for transitions.
+/// No WPF dependencies — operates entirely on byte arrays, with the fixed-point SIMD
+/// kernels in <see cref="MediaKernels"/> writing into a reused output frame.
 ///
 /// Callers feed frames via SetSource(index, data, w, h) using fixed slot indices
 /// (e.g., enabled[0] always feeds slot 0, enabled[1] always feeds slot 1).
@@ -22,6 +26,9 @@ public class TransitionEngine
     // When true:  slot 1 = A (program), slot 0 = B (preview)
     private bool _swapped;
 
+    // Reused transition output, reallocated only when the frame size changes
+    private byte[]? _output;
+
     /// <summary>Active transition type.</summary>
     public TransitionType ActiveTransition { get; private set; } = TransitionType.Cut;
 
@@ -31,6 +38,12 @@ public class TransitionEngine
     /// <summary>Current transition position (0.0 = source A, 1.0 = source B).</summary>
     public double TransitionPosition { get; private set; }
 
+    /// <summary>
+    /// Layout of the source frames: BGRA (default) or UYVY, which is blended as-is with a
+    /// studio-range black for dip-to-black, so YUV sources need no BGRA round-trip.
+    /// </summary>
+    public PixelFormat PixelFormat { get; set; } = PixelFormat.BGRA;
+
     /// <summary>Duration of auto-transitions in milliseconds.</summary>
     public int DurationMs { get; set; } = 1000;
 
@@ -129,7 +142,8 @@ public class TransitionEngine
     }
 
     /// <summary>
-    /// Get the blended program output frame as BGRA byte array.
+    /// Get the blended program output frame. During a transition this is an engine-owned
+    /// buffer that is overwritten by the next call; outside one it is source A itself.
     /// </summary>
     public byte[]? GetProgramFrame()
     {
@@ -143,30 +157,44 @@ public class TransitionEngine
         if (!IsTransitioning || TransitionPosition <= 0)
             return a;
 
-        int length = _width * _height * 4;
-        if (a.Length < length || b.Length < length)
-            return a;
+        int length = FrameLength;
+        if (_output == null || _output.Length != length)
+            _output = GC.AllocateUninitializedArray<byte>(length);
 
-        var output = new byte[length];
-        double t = TransitionPosition;
+        return RenderProgramFrame(_output) ? _output : a;
+    }
+
+    /// <summary>
+    /// Blend the current transition into a caller-provided frame of at least
+    /// width * height * bytes-per-pixel bytes.
+    /// </summary>
+    /// <returns>False if no blend applies (no transition, missing or short sources); output is untouched.</returns>
+    public bool RenderProgramFrame(byte[] output)
+    {
+        var a = SourceA;
+        var b = SourceB;
+        int length = FrameLength;
 
-        int rowBytes = _width * 4;
+        if (a == null || b == null || !IsTransitioning || TransitionPosition <= 0 ||
+            length <= 0 || a.Length < length || b.Length < length || output.Length < length)
+            return false;
+
+        double t = TransitionPosition;
+        int rowBytes = length / Math.Max(1, _height);
 
         switch (ActiveTransition)
         {
             case TransitionType.Dissolve:
                 BlendDissolve(a, b, output, length, t, rowBytes);
-                break;
+                return true;
 
             case TransitionType.DipToBlack:
-                BlendDipToBlack(a, b, output, length, t, rowBytes);
-                break;
+                BlendDipToBlack(a, b, output, length, t, rowBytes, BlackPattern);
+                return true;
 
             default:
-                return a;
+                return false;
         }
-
-        return output;
     }
 
     private void CompleteTransition()
@@ -180,72 +208,63 @@ public class TransitionEngine
         TransitionCompleted?.Invoke(this, EventArgs.Empty);
     }
 
+    private int FrameLength => _width * _height * (IsUyvy ? 2 : 4);
+
+    private bool IsUyvy => PixelFormat is PixelFormat.UYVY or PixelFormat.YUV422_8bit;
+
+    private uint BlackPattern => IsUyvy ? MediaKernels.UyvyBlack : MediaKernels.BgraBlack;
+
+    // 8-bit fixed-point weight for position t; the two weights always sum to 256
+    private static int Weight(double t) => (int)Math.Round(Math.Clamp(t, 0.0, 1.0) * 256);
+
     private static void BlendDissolve(byte[] a, byte[] b, byte[] output, int length, double t, int rowBytes)
     {
-        int invT = (int)((1.0 - t) * 256);
-        int fwdT = (int)(t * 256);
-        int numRows = length / rowBytes;
-
-        Parallel.For(0, numRows, row =>
+        int weight = Weight(t);
+        if (!UseBands(length, rowBytes))
         {
-            int start = row * rowBytes;
-            int end = Math.Min(start + rowBytes, length);
-            for (int i = start; i < end; i++)
-            {
-                output[i] = (byte)((a[i] * invT + b[i] * fwdT) >> 8);
-            }
-        });
+            MediaKernels.BlendFrames(a, b, output.AsSpan(0, length), weight);
+            return;
+        }
+
+        ForEachBand(length, rowBytes, (start, count) =>
+            MediaKernels.BlendFrames(a.AsSpan(start, count), b.AsSpan(start, count), output.AsSpan(start, count), weight));
+    }
 
-        // Handle any remaining bytes
-        int remainder = numRows * rowBytes;
-        for (int i = remainder; i < length; i++)
+    private static void BlendDipToBlack(byte[] a, byte[] b, byte[] output, int length, double t, int rowBytes, uint black)
+    {
+        // First half: fade A to black; second half: fade black to B
+        var source = t <= 0.5 ? a : b;
+        int weight = t <= 0.5 ? Weight(1.0 - (t * 2.0)) : Weight((t - 0.5) * 2.0);
+        if (!UseBands(length, rowBytes))
         {
-            output[i] = (byte)((a[i] * invT + b[i] * fwdT) >> 8);
+            MediaKernels.FadeFrame(source, output.AsSpan(0, length), weight, black);
+            return;
         }
+
+        ForEachBand(length, rowBytes, (start, count) =>
+            MediaKernels.FadeFrame(source.AsSpan(start, count), output.AsSpan(start, count), weight, black));
     }
 
-    private static void BlendDipToBlack(byte[] a, byte[] b, byte[] output, int length, double t, int rowBytes)
+    // The SIMD kernels are memory bound, so preview-sized frames are blended on the calling
+    // thread and only large (UHD) frames are split into whole-row bands across cores
+    private const int ParallelThresholdBytes = 4 * 1024 * 1024;
+    private const int MaxBands = 8;
+
+    private static bool UseBands(int length, int rowBytes) =>
+        length >= ParallelThresholdBytes && Environment.ProcessorCount > 1 && length / rowBytes >= MaxBands;
+
+    private static void ForEachBand(int length, int rowBytes, Action<int, int> blend)
     {
-        int numRows = length / rowBytes;
+        int bands = Math.Min(Environment.ProcessorCount, MaxBands);
+        int rowsPerBand = (length / rowBytes + bands - 1) / bands;
 
-        if (t <= 0.5)
+        Parallel.For(0, bands, band =>
         {
-            // First half: fade A to black
-            double fade = 1.0 - (t * 2.0); // 1.0 -> 0.0
-            int f = (int)(fade * 256);
-
-            Parallel.For(0, numRows, row =>
-            {
-                int start = row * rowBytes;
-                int end = Math.Min(start + rowBytes, length);
-                for (int i = start; i < end; i += 4)
-                {
-                    output[i] = (byte)((a[i] * f) >> 8);         // B
-                    output[i + 1] = (byte)((a[i + 1] * f) >> 8); // G
-                    output[i + 2] = (byte)((a[i + 2] * f) >> 8); // R
-                    output[i + 3] = 255;                          // A
-                }
-            });
-        }
-        else
-        {
-            // Second half: fade black to B
-            double fade = (t - 0.5) * 2.0; // 0.0 -> 1.0
-            int f = (int)(fade * 256);
-
-            Parallel.For(0, numRows, row =>
-            {
-                int start = row * rowBytes;
-                int end = Math.Min(start + rowBytes, length);
-                for (int i = start; i < end; i += 4)
-                {
-                    output[i] = (byte)((b[i] * f) >> 8);         // B
-                    output[i + 1] = (byte)((b[i + 1] * f) >> 8); // G
-                    output[i + 2] = (byte)((b[i + 2] * f) >> 8); // R
-                    output[i + 3] = 255;                          // A
-                }
-            });
-        }
+            int start = band * rowsPerBand * rowBytes;
+            int end = band == bands - 1 ? length : Math.Min(length, start + rowsPerBand * rowBytes);
+            if (end > start)
+                blend(start, end - start);
+        });
     }
 }
 
@@ -1,22 +1,22 @@
-using System.Buffers;
 using Microsoft.Extensions.Logging;
 using Screener.Abstractions.Capture;
+using Screener.Core.Buffers;
+using Screener.Core.Native;
 
 namespace Screener.Preview;
 
 /// <summary>
 /// Manages audio preview output using circular buffer for smooth playback.
-/// Uses WASAPI for low-latency audio output on Windows.
+/// Uses WASAPI for low-latency audio output on Windows. The capture side writes and the
+/// playback loop reads the lock-free <see cref="AudioRingBuffer"/> without waiting on each other.
 /// </summary>
 public sealed class AudioPreviewService : IDisposable
 {
     private readonly ILogger<AudioPreviewService> _logger;
     private readonly object _lock = new();
 
-    private readonly byte[] _circularBuffer;
-    private int _writePosition;
-    private int _readPosition;
-    private int _bufferedSamples;
+    // Replaced when the format changes; the playback loop picks up the new one
+    private volatile AudioRingBuffer _ringBuffer;
 
     private int _sampleRate = 48000;
     private int _channels = 2;
@@ -29,6 +29,7 @@ public sealed class AudioPreviewService : IDisposable
     private Task? _playbackTask;
 
     private const int BufferSizeMs = 200; // 200ms buffer
+    private const int MeterWindowFrames = 48;
 
     /// <summary>
     /// Gets or sets the output volume (0.0 to 1.0).
@@ -63,8 +64,13 @@ public sealed class AudioPreviewService : IDisposable
         _logger = logger;
 
         // Pre-allocate buffer for 48kHz stereo 16-bit
-        var bufferSize = _sampleRate * _channels * (_bitsPerSample / 8) * BufferSizeMs / 1000;
-        _circularBuffer = new byte[bufferSize];
+        _ringBuffer = CreateRingBuffer();
+    }
+
+    private AudioRingBuffer CreateRingBuffer()
+    {
+        var blockAlign = Math.Max(1, _channels * (_bitsPerSample / 8));
+        return new AudioRingBuffer(_sampleRate * blockAlign * BufferSizeMs / 1000, _sampleRate, blockAlign);
     }
 
     /// <summary>
@@ -72,6 +78,10 @@ public sealed class AudioPreviewService : IDisposable
     /// </summary>
     public void Configure(int sampleRate, int channels, int bitsPerSample)
     {
+        // Called for every packet: only a format change takes the lock
+        if (_sampleRate == sampleRate && _channels == channels && _bitsPerSample == bitsPerSample)
+            return;
+
         lock (_lock)
         {
             if (_sampleRate == sampleRate && _channels == channels && _bitsPerSample == bitsPerSample)
@@ -80,6 +90,7 @@ public sealed class AudioPreviewService : IDisposable
             _sampleRate = sampleRate;
             _channels = channels;
             _bitsPerSample = bitsPerSample;
+            _ringBuffer = CreateRingBuffer();
 
             _logger.LogInformation(
                 "Audio preview configured: {SampleRate}Hz, {Channels}ch, {Bits}bit",
@@ -98,12 +109,10 @@ public sealed class AudioPreviewService : IDisposable
         _cts = new CancellationTokenSource();
         _isRunning = true;
 
-        // Reset buffer state
+        // Reset buffer state; nothing writes it until _isRunning is set
         lock (_lock)
         {
-            _writePosition = 0;
-            _readPosition = 0;
-            _bufferedSamples = 0;
+            _ringBuffer = CreateRingBuffer();
         }
 
         _playbackTask = Task.Run(() => PlaybackLoop(_cts.Token), _cts.Token);
@@ -144,7 +153,8 @@ public sealed class AudioPreviewService : IDisposable
         if (!_isRunning || samples.IsEmpty)
             return;
 
-        // Just calculate and report levels (no playback buffering for now)
+        // Samples that do not fit are dropped; playback never holds up the capture side
+        _ringBuffer.Write(samples);
         CalculateAndReportLevels(samples);
     }
 
@@ -166,10 +176,7 @@ public sealed class AudioPreviewService : IDisposable
         // In a full implementation, this would use WASAPI via NAudio or similar
         // For now, we'll just consume the buffer and report levels
 
-        var frameSize = _channels * (_bitsPerSample / 8);
-        var samplesPerCallback = _sampleRate / 100; // 10ms chunks
-        var bytesPerCallback = samplesPerCallback * frameSize;
-        var outputBuffer = new byte[bytesPerCallback];
+        var outputBuffer = Array.Empty<byte>();
 
         while (!ct.IsCancellationRequested)
         {
@@ -177,23 +184,15 @@ public sealed class AudioPreviewService : IDisposable
             {
                 var bytesRead = 0;
 
-                lock (_lock)
+                // 10ms chunks in the current format
+                var ringBuffer = _ringBuffer;
+                var bytesPerCallback = ringBuffer.SampleRate / 100 * ringBuffer.BlockAlign;
+                if (outputBuffer.Length != bytesPerCallback)
+                    outputBuffer = new byte[bytesPerCallback];
+
+                if (ringBuffer.Available >= bytesPerCallback)
                 {
-                    if (_bufferedSamples >= bytesPerCallback)
-                    {
-                        // Read from circular buffer
-                        var firstChunkSize = Math.Min(bytesPerCallback, _circularBuffer.Length - _readPosition);
-                        Array.Copy(_circularBuffer, _readPosition, outputBuffer, 0, firstChunkSize);
-
-                        if (firstChunkSize < bytesPerCallback)
-                        {
-                            Array.Copy(_circularBuffer, 0, outputBuffer, firstChunkSize, bytesPerCallback - firstChunkSize);
-                        }
-
-                        _readPosition = (_readPosition + bytesPerCallback) % _circularBuffer.Length;
-                        _bufferedSamples -= bytesPerCallback;
-                        bytesRead = bytesPerCallback;
-                    }
+                    bytesRead = ringBuffer.Read(outputBuffer);
                 }
 
                 if (bytesRead > 0 && !_isMuted)
@@ -217,44 +216,12 @@ public sealed class AudioPreviewService : IDisposable
         if (_channels < 1 || (_bitsPerSample != 16 && _bitsPerSample != 32))
             return;
 
-        var bytesPerSample = _bitsPerSample / 8;
-        var levels = new float[_channels];
-        var sampleCount = samples.Length / bytesPerSample / _channels;
-
-        if (sampleCount == 0)
+        if (samples.Length < _channels * (_bitsPerSample / 8))
             return;
 
-        for (int ch = 0; ch < _channels; ch++)
-        {
-            float peak = 0;
-
-            for (int i = 0; i < sampleCount; i++)
-            {
-                var offset = (i * _channels + ch) * bytesPerSample;
-
-                float normalized;
-                if (_bitsPerSample == 16)
-                {
-                    if (offset + 1 >= samples.Length)
-                        break;
-                    var sample = (short)(samples[offset] | (samples[offset + 1] << 8));
-                    normalized = Math.Abs(sample / 32768f);
-                }
-                else // 32-bit
-                {
-                    if (offset + 3 >= samples.Length)
-                        break;
-                    var sample = samples[offset] | (samples[offset + 1] << 8) |
-                                 (samples[offset + 2] << 16) | (samples[offset + 3] << 24);
-                    normalized = Math.Abs(sample / 2147483648f);
-                }
-
-                if (normalized > peak)
-                    peak = normalized;
-            }
-
-            levels[ch] = peak;
-        }
+        // Per-channel peaks in one pass with the metering kernel
+        var levels = new float[_channels];
+        MediaKernels.MeasureAudioLevels(samples, _channels, _bitsPerSample, MeterWindowFrames, default, levels, default);
 
         // Convert to dB
         var dbLevels = new float[_channels];
@@ -1,6 +1,7 @@
 using System.Runtime.InteropServices;
 using Microsoft.Extensions.Logging;
 using Screener.Abstractions.Capture;
+using Screener.Core.Native;
 using SharpDX;
 using SharpDX.Direct3D;
 using SharpDX.Direct3D11;
@@ -205,11 +206,8 @@ public sealed class D3DPreviewRenderer : IDisposable
                     break;
 
                 case PixelFormat.UYVY:
-                    ConvertUYVYToBGRA(srcPtr, dest, frame.Width, height, srcPitch, destPitch);
-                    break;
-
                 case PixelFormat.YUV422_10bit:
-                    ConvertYUV422_10bitToBGRA(srcPtr, dest, frame.Width, height, srcPitch, destPitch);
+                    ConvertYuvToBgra(frame, dest, destPitch);
                     break;
 
                 default:
@@ -231,112 +229,31 @@ public sealed class D3DPreviewRenderer : IDisposable
     }
 
     /// <summary>
-    /// Convert UYVY (YUV 4:2:2) to BGRA.
+    /// Convert UYVY or v210 to BGRA with the native SIMD kernels (managed fallback when
+    /// the kernel DLL is not deployed).
     /// </summary>
-    private unsafe void ConvertUYVYToBGRA(byte* src, byte* dest, int width, int height, int srcPitch, int destPitch)
+    private static unsafe void ConvertYuvToBgra(VideoFrame frame, byte* dest, int destPitch)
     {
-        // Calculate HANC offset: DeckLink may include horizontal blanking at the start of each row
-        // Active video is width * 2 bytes; any extra bytes in srcPitch are HANC at the start
-        int activeVideoBytes = width * 2;
-        int hancOffset = srcPitch > activeVideoBytes ? srcPitch - activeVideoBytes : 0;
-
-        for (int y = 0; y < height; y++)
-        {
-            // Start at HANC offset to skip horizontal blanking data at row start
-            var srcRow = src + y * srcPitch + hancOffset;
-            var destRow = dest + y * destPitch;
-
-            for (int x = 0; x < width; x += 2)
-            {
-                // UYVY: U0 Y0 V0 Y1 -> two pixels
-                var u = srcRow[0] - 128;
-                var y0 = srcRow[1];
-                var v = srcRow[2] - 128;
-                var y1 = srcRow[3];
-
-                // First pixel
-                var r0 = Clamp((int)(y0 + 1.402 * v));
-                var g0 = Clamp((int)(y0 - 0.344 * u - 0.714 * v));
-                var b0 = Clamp((int)(y0 + 1.772 * u));
-
-                destRow[0] = (byte)b0;
-                destRow[1] = (byte)g0;
-                destRow[2] = (byte)r0;
-                destRow[3] = 255;
-
-                // Second pixel
-                var r1 = Clamp((int)(y1 + 1.402 * v));
-                var g1 = Clamp((int)(y1 - 0.344 * u - 0.714 * v));
-                var b1 = Clamp((int)(y1 + 1.772 * u));
-
-                destRow[4] = (byte)b1;
-                destRow[5] = (byte)g1;
-                destRow[6] = (byte)r1;
-                destRow[7] = 255;
-
-                srcRow += 4;
-                destRow += 8;
-            }
-        }
-    }
+        var width = frame.Width;
+        var height = frame.Height;
+        var srcPitch = frame.RowBytes;
+        var isV210 = frame.PixelFormat == PixelFormat.YUV422_10bit;
 
-    /// <summary>
-    /// Convert 10-bit YUV 4:2:2 to BGRA.
-    /// </summary>
-    private unsafe void ConvertYUV422_10bitToBGRA(byte* src, byte* dest, int width, int height, int srcPitch, int destPitch)
-    {
-        // v210 format: 3 10-bit samples packed into 4 bytes
-        // Calculate HANC offset: DeckLink may include horizontal blanking at the start of each row
-        // Active video for v210 is approximately (width * 16 + 5) / 6 bytes
-        int activeVideoBytes = (width * 16 + 5) / 6;
+        // DeckLink may include horizontal blanking at the start of each row:
+        // any bytes beyond the active (padded) row are HANC at the start
+        int activeVideoBytes = isV210 ? MediaKernels.V210RowBytes(width) : width * 2;
         int hancOffset = srcPitch > activeVideoBytes ? srcPitch - activeVideoBytes : 0;
 
-        for (int y = 0; y < height; y++)
-        {
-            // Start at HANC offset to skip horizontal blanking data at row start
-            var srcRow = (uint*)(src + y * srcPitch + hancOffset);
-            var destRow = dest + y * destPitch;
-            var destX = 0;
+        var src = frame.Data.Span[hancOffset..];
+        var dst = new Span<byte>(dest, destPitch * height);
+        var matrix = ColorMatrixExtensions.ForHeight(height);
 
-            for (int x = 0; x < width / 6; x++)
-            {
-                // Unpack 6 pixels from 4 32-bit words
-                var w0 = srcRow[0];
-                var w1 = srcRow[1];
-                var w2 = srcRow[2];
-                var w3 = srcRow[3];
-
-                // Extract 10-bit values (simplified - actual v210 unpacking is more complex)
-                var u0 = (int)((w0 >> 0) & 0x3FF) - 512;
-                var y0 = (int)((w0 >> 10) & 0x3FF);
-                var v0 = (int)((w0 >> 20) & 0x3FF) - 512;
-
-                // Scale 10-bit to 8-bit
-                y0 = y0 >> 2;
-                u0 = u0 >> 2;
-                v0 = v0 >> 2;
-
-                // Convert to RGB
-                var r = Clamp(y0 + (int)(1.402 * v0));
-                var g = Clamp(y0 - (int)(0.344 * u0) - (int)(0.714 * v0));
-                var b = Clamp(y0 + (int)(1.772 * u0));
-
-                // Write 6 pixels (simplified - repeating first pixel)
-                for (int i = 0; i < 6 && destX < width; i++, destX++)
-                {
-                    destRow[destX * 4 + 0] = (byte)b;
-                    destRow[destX * 4 + 1] = (byte)g;
-                    destRow[destX * 4 + 2] = (byte)r;
-                    destRow[destX * 4 + 3] = 255;
-                }
-
-                srcRow += 4;
-            }
-        }
+        if (isV210)
+            MediaKernels.ConvertV210ToBgra(src, srcPitch, dst, destPitch, width, height, matrix);
+        else
+            MediaKernels.ConvertUyvyToBgra(src, srcPitch, dst, destPitch, width, height, matrix);
     }
 
-    private static int Clamp(int value) => Math.Max(0, Math.Min(255, value));
-
     /// <summary>
     /// Clear the render target to black.
     /// </summary>
@@ -0,0 +1,271 @@
+using Microsoft.Extensions.Logging;
+using Screener.Abstractions.Capture;
+using Screener.Abstractions.Encoding;
+using Screener.Core.Recording;
+
+namespace Screener.Recording;
+
+/// <summary>
+/// Records an input's frames as captured (UYVY or v210, back to back with no header, described
+/// by a <see cref="RawVideoInfo"/> sidecar) through
+/// <see cref="UnbufferedFileWriter"/> instead of an encoder. Used for raw ISO recordings, where
+/// FFmpeg would only copy the frames and its buffered writes fill the page cache and stall the
+/// array when several inputs record at once. Stands in for the encoding pipeline, so the
+/// recording service drives it like any other.
+/// </summary>
+internal sealed class IsoFrameRecorder : IEncodingPipeline
+{
+    // Queue for about half a second of frames, bounded by memory for UHD v210
+    private const long MaxQueueBytes = 256L * 1024 * 1024;
+    private const int MinQueueFrames = 4;
+
+    private static readonly TimeSpan DefaultPreallocation = TimeSpan.FromMinutes(2);
+
+    // Largest single reservation: a long planned duration must not claim the disk up front,
+    // so the file grows in steps of at most this much as it fills
+    private const long MaxPreallocationStep = 4L * 1024 * 1024 * 1024;
+
+    private readonly ILogger _logger;
+    private readonly TimeSpan _preallocation;
+
+    private EncodingConfiguration? _config;
+    private UnbufferedFileWriter? _writer;
+    private IVideoOverlay? _overlay;
+    private int _frameSize;
+
+    private EncodingState _state = EncodingState.Idle;
+    private EncodingPreset _currentPreset = EncodingPreset.Medium;
+    private readonly EncodingStatistics _statistics = new();
+    private long _framesEncoded;
+    private DateTime _startTime;
+    private int _droppedFrames;
+    private int _backpressureDroppedFrames;
+    private long _lastBackpressureTicks;
+    private bool _faultReported;
+
+    public EncodingState State => _state;
+    public EncodingPreset CurrentPreset => _currentPreset;
+    public EncodingStatistics Statistics => _statistics with
+    {
+        FramesEncoded = _framesEncoded,
+        BytesWritten = _writer?.BytesWritten ?? 0,
+        Duration = _startTime != default ? DateTime.UtcNow - _startTime : TimeSpan.Zero,
+        DroppedFrames = _droppedFrames,
+        BackpressureDroppedFrames = _backpressureDroppedFrames,
+        QueuedFrames = _writer?.QueuedFrames ?? 0,
+        PeakQueuedFrames = _writer?.PeakQueuedFrames ?? 0
+    };
+
+    public event EventHandler<EncodingProgressEventArgs>? Progress;
+    public event EventHandler<EncodingErrorEventArgs>? Error;
+    public event EventHandler<EncodingBackpressureEventArgs>? Backpressure;
+
+    /// <param name="preallocation">Recording time to reserve disk space for at a time
+    /// (the planned duration when known), capped at a few GB per step.</param>
+    public IsoFrameRecorder(ILogger logger, TimeSpan? preallocation = null)
+    {
+        _logger = logger;
+        _preallocation = preallocation is { } p && p > TimeSpan.Zero ? p : DefaultPreallocation;
+    }
+
+    /// <summary>
+    /// File extension for raw frames of this pixel format.
+    /// </summary>
+    public static string GetExtension(PixelFormat format) => format switch
+    {
+        PixelFormat.UYVY or PixelFormat.YUV422_8bit => ".uyvy",
+        PixelFormat.YUV422_10bit => ".v210",
+        _ => ".raw"
+    };
+
+    public Task InitializeAsync(EncodingConfiguration config, CancellationToken ct = default)
+    {
+        if (_state != EncodingState.Idle)
+            throw new InvalidOperationException($"Cannot initialize in state {_state}");
+
+        _config = config;
+        _currentPreset = config.Preset;
+        _state = EncodingState.Initializing;
+
+        try
+        {
+            var mode = config.VideoMode;
+            _frameSize = GetRowBytes(mode) * mode.Height;
+
+            double fps = mode.FrameRate.Value;
+            int capacity = (int)Math.Clamp(Math.Min(Math.Ceiling(fps / 2), MaxQueueBytes / _frameSize),
+                MinQueueFrames, Math.Max(MinQueueFrames, fps));
+            long preallocate = Math.Min((long)(_frameSize * fps * _preallocation.TotalSeconds), MaxPreallocationStep);
+
+            _writer = new UnbufferedFileWriter(config.OutputPath, _frameSize, capacity, preallocate, _logger);
+
+            // The frames carry no header; clipping reads the geometry from the sidecar
+            new RawVideoInfo(mode.Width, mode.Height, mode.PixelFormat, mode.FrameRate.Numerator,
+                mode.FrameRate.Denominator, GetRowBytes(mode)).Write(config.OutputPath);
+
+            _overlay = config.Overlay != null && config.Overlay.Supports(mode) ? config.Overlay : null;
+            _startTime = DateTime.UtcNow;
+            _state = EncodingState.Encoding;
+
+            _logger.LogInformation(
+                "Raw ISO recording started: {Output}, {Width}x{Height} {Format} at {Rate}, {Queue} frame queue, {Prealloc} MB preallocated",
+                config.OutputPath, mode.Width, mode.Height, mode.PixelFormat, mode.FrameRate, capacity, preallocate / (1024 * 1024));
+        }
+        catch (Exception ex)
+        {
+            _state = EncodingState.Error;
+            _logger.LogError(ex, "Failed to start raw ISO recording to {Output}", config.OutputPath);
+            Error?.Invoke(this, new EncodingErrorEventArgs
+            {
+                Message = ex.Message,
+                Exception = ex,
+                IsFatal = true
+            });
+            throw;
+        }
+
+        return Task.CompletedTask;
+    }
+
+    // Same packing as the capture: UYVY rows of width * 2, v210 rows padded to 48 pixels
+    private static int GetRowBytes(VideoMode mode) => mode.PixelFormat switch
+    {
+        PixelFormat.YUV422_10bit => (mode.Width + 47) / 48 * 128,
+        PixelFormat.UYVY or PixelFormat.YUV422_8bit => mode.Width * 2,
+        _ => mode.Width * 4
+    };
+
+    public Task<bool> WriteVideoFrameAsync(ReadOnlyMemory<byte> frame, TimeSpan pts, CancellationToken ct = default)
+    {
+        var writer = _writer;
+        if (_state != EncodingState.Encoding || writer == null)
+            return Task.FromResult(false);
+
+        if (writer.Fault != null)
+        {
+            ReportFault(writer.Fault);
+            Interlocked.Increment(ref _droppedFrames);
+            return Task.FromResult(false);
+        }
+
+        if (frame.Length != _frameSize)
+        {
+            Interlocked.Increment(ref _droppedFrames);
+            _logger.LogWarning("Frame of {Length} bytes does not match the {Size}-byte raw ISO frame; dropped",
+                frame.Length, _frameSize);
+            return Task.FromResult(false);
+        }
+
+        if (!writer.HasSpace)
+        {
+            OnBackpressure(writer);
+            return Task.FromResult(false);
+        }
+
+        // The copy is the only work on the capture thread; the capture ring slot is free
+        // again when this returns
+        var pooled = writer.Rent(_frameSize);
+        frame.Span.CopyTo(pooled.Span);
+        pooled.Timestamp = pts;
+        pooled.FrameNumber = _framesEncoded;
+        _overlay?.Apply(pooled.Span, _frameSize / _config!.VideoMode.Height, _config.VideoMode);
+
+        if (!writer.TryEnqueue(pooled))
+        {
+            OnBackpressure(writer);
+            return Task.FromResult(false);
+        }
+
+        _framesEncoded++;
+        if (_framesEncoded % 30 == 0)
+            UpdateProgress();
+
+        return Task.FromResult(true);
+    }
+
+    public Task<bool> WriteAudioSamplesAsync(ReadOnlyMemory<byte> samples, TimeSpan pts, CancellationToken ct = default)
+    {
+        // Video only, like the encoding pipelines
+        return Task.FromResult(true);
+    }
+
+    private void OnBackpressure(UnbufferedFileWriter writer)
+    {
+        int dropped = Interlocked.Increment(ref _backpressureDroppedFrames);
+
+        long now = Environment.TickCount64;
+        if (now - _lastBackpressureTicks < 1000)
+            return;
+
+        _lastBackpressureTicks = now;
+        _logger.LogWarning("Raw ISO writer for {Output} is falling behind; {Dropped} frames refused, slowest write {Write:F0} ms",
+            _config?.OutputPath, dropped, writer.MaxWriteTime.TotalMilliseconds);
+        Backpressure?.Invoke(this, new EncodingBackpressureEventArgs
+        {
+            QueuedFrames = writer.QueuedFrames,
+            QueueCapacity = writer.Capacity,
+            DroppedFrames = dropped
+        });
+    }
+
+    private void ReportFault(Exception fault)
+    {
+        if (_faultReported)
+            return;
+
+        _faultReported = true;
+        _state = EncodingState.Error;
+        Error?.Invoke(this, new EncodingErrorEventArgs
+        {
+            Message = $"Raw ISO recording to {_config?.OutputPath} stopped: {fault.Message}",
+            Exception = fault,
+            IsFatal = true
+        });
+    }
+
+    private void UpdateProgress()
+    {
+        long bytes = _writer?.BytesWritten ?? 0;
+        var duration = DateTime.UtcNow - _startTime;
+        var bitrate = duration.TotalSeconds > 0 ? bytes * 8 / duration.TotalSeconds / 1_000_000 : 0;
+
+        Progress?.Invoke(this, new EncodingProgressEventArgs
+        {
+            FrameNumber = _framesEncoded,
+            EncodedDuration = TimeSpan.FromSeconds(_framesEncoded / _config!.VideoMode.FrameRate.Value),
+            CurrentBitrateMbps = bitrate,
+            FileSizeBytes = bytes
+        });
+    }
+
+    public async Task FinalizeAsync(CancellationToken ct = default)
+    {
+        if (_state != EncodingState.Encoding || _writer == null)
+            return;
+
+        _state = EncodingState.Finalizing;
+
+        try
+        {
+            await _writer.CompleteAsync(ct);
+            _state = EncodingState.Completed;
+
+            _logger.LogInformation(
+                "Raw ISO recording completed: {Output}, {Frames} frames, {Size} MB, peak queue {Peak}/{Capacity}, slowest write {Write:F0} ms",
+                _config!.OutputPath, _framesEncoded, _writer.BytesWritten / (1024 * 1024),
+                _writer.PeakQueuedFrames, _writer.Capacity, _writer.MaxWriteTime.TotalMilliseconds);
+        }
+        catch (Exception ex)
+        {
+            _state = EncodingState.Error;
+            _logger.LogError(ex, "Error finalizing raw ISO recording");
+            throw;
+        }
+    }
+
+    public async ValueTask DisposeAsync()
+    {
+        if (_writer != null)
+            await _writer.DisposeAsync();
+    }
+}
@@ -0,0 +1,452 @@
+using System.Buffers.Binary;
+using System.Numerics;
+using System.Runtime.InteropServices;
+using Microsoft.Extensions.Logging;
+using Screener.Abstractions.Capture;
+using Screener.Abstractions.Timecode;
+using Screener.Core.Recording;
+
+namespace Screener.Recording;
+
+/// <summary>
+/// Follows a fragmented MP4 as the encoder writes it and appends each completed fragment's
+/// video frames to the recording's sidecar <see cref="RecordingIndex"/>. Reads only the box
+/// headers, moov and moofs, never the media data.
+/// </summary>
+internal sealed class RecordingIndexer : IAsyncDisposable
+{
+    private static readonly TimeSpan PollInterval = TimeSpan.FromMilliseconds(500);
+
+    // Largest moov/moof read into memory; anything bigger is not an fMP4 this recorder wrote
+    private const int MaxHeaderBoxSize = 16 * 1024 * 1024;
+
+    // trun/tfhd sample_flags: sample_is_non_sync_sample
+    private const uint NonSyncSample = 0x0001_0000;
+
+    private readonly string _recordingPath;
+    private readonly FrameRate _frameRate;
+    private readonly Smpte12MTimecode? _startTimecode;
+    private readonly ILogger _logger;
+    private readonly CancellationTokenSource _cts = new();
+    private readonly List<RecordingIndexEntry> _pending = new();
+    private Task? _task;
+
+    private FileStream? _file;
+    private RecordingIndexWriter? _writer;
+    private long _position;
+    private bool _failed;
+
+    // Video track, from moov
+    private uint _trackId;
+    private int _timescale;
+    private SampleDefaults _trex;
+
+    private long _nextDecodeTime;
+    private long _firstPts = long.MinValue;
+
+    public RecordingIndexer(string recordingPath, FrameRate frameRate, Smpte12MTimecode? startTimecode, ILogger logger)
+    {
+        _recordingPath = recordingPath;
+        _frameRate = frameRate;
+        _startTimecode = startTimecode;
+        _logger = logger;
+    }
+
+    public long FramesIndexed => _writer?.EntriesWritten ?? 0;
+
+    public void Start() => _task = Task.Run(() => RunAsync(_cts.Token));
+
+    /// <summary>
+    /// Index whatever the finalized file holds past the last poll, then close the index.
+    /// </summary>
+    public async Task CompleteAsync()
+    {
+        _cts.Cancel();
+        if (_task != null)
+            await _task;
+
+        Poll(final: true);
+        Close();
+
+        _logger.LogDebug("Indexed {Frames} frames of {Path}", FramesIndexed, _recordingPath);
+    }
+
+    private async Task RunAsync(CancellationToken ct)
+    {
+        try
+        {
+            while (!ct.IsCancellationRequested && !_failed)
+            {
+                await Task.Delay(PollInterval, ct);
+                Poll(final: false);
+            }
+        }
+        catch (OperationCanceledException)
+        {
+        }
+    }
+
+    private void Poll(bool final)
+    {
+        if (_failed)
+            return;
+
+        try
+        {
+            _file ??= File.Exists(_recordingPath)
+                ? new FileStream(_recordingPath, FileMode.Open, FileAccess.Read,
+                    FileShare.ReadWrite | FileShare.Delete, bufferSize: 1, FileOptions.RandomAccess)
+                : null;
+            if (_file == null)
+                return;
+
+            ReadBoxes(_file.Length, final);
+        }
+        catch (IOException ex)
+        {
+            // Transient while the encoder holds the file; next poll retries
+            _logger.LogDebug(ex, "Index poll of {Path} failed", _recordingPath);
+        }
+        catch (InvalidDataException ex)
+        {
+            _logger.LogWarning("Not indexing {Path}: {Reason}. Clips will seek the file instead",
+                _recordingPath, ex.Message);
+            _failed = true;
+            Close();
+            TryDelete(RecordingIndex.PathFor(_recordingPath));
+        }
+    }
+
+    private void ReadBoxes(long length, bool final)
+    {
+        Span<byte> header = stackalloc byte[16];
+
+        // Only boxes the encoder has finished writing are consumed
+        while (_position + 8 <= length)
+        {
+            int headerRead = RandomAccess.Read(_file!.SafeFileHandle, header, _position);
+            if (headerRead < 8)
+                return;
+
+            long size = BinaryPrimitives.ReadUInt32BigEndian(header);
+            uint type = BinaryPrimitives.ReadUInt32BigEndian(header[4..]);
+            int headerSize = 8;
+
+            if (size == 1)
+            {
+                if (headerRead < 16)
+                    return;
+                size = (long)BinaryPrimitives.ReadUInt64BigEndian(header[8..]);
+                headerSize = 16;
+            }
+            else if (size == 0)
+            {
+                // To end of file: only final once the encoder has closed it
+                if (!final)
+                    return;
+                size = length - _position;
+            }
+
+            if (size < headerSize)
+                throw new InvalidDataException($"bad box size {size} at {_position}");
+            if (_position + size > length)
+                return;
+
+            switch (type)
+            {
+                case Moov:
+                    ParseMoov(ReadBox(size, headerSize));
+                    break;
+
+                case Moof:
+                    if (_timescale == 0)
+                        throw new InvalidDataException("fragment before a video track");
+                    _writer ??= new RecordingIndexWriter(_recordingPath, _timescale, _frameRate, _position, spliceable: true);
+                    ParseMoof(ReadBox(size, headerSize), _position);
+                    break;
+
+                case Mdat:
+                    // The pending fragment's samples are on disk now
+                    _writer?.Append(CollectionsMarshal.AsSpan(_pending));
+                    _pending.Clear();
+                    break;
+            }
+
+            _position += size;
+        }
+    }
+
+    private byte[] ReadBox(long size, int headerSize)
+    {
+        if (size > MaxHeaderBoxSize)
+            throw new InvalidDataException($"{size}-byte header box");
+
+        var payload = new byte[size - headerSize];
+        RandomAccess.Read(_file!.SafeFileHandle, payload, _position + headerSize);
+        return payload;
+    }
+
+    private void ParseMoov(ReadOnlySpan<byte> moov)
+    {
+        var trex = new Dictionary<uint, SampleDefaults>();
+
+        foreach (var (type, body) in Children(moov))
+        {
+            if (type == Trak && _timescale == 0 && TryParseVideoTrak(body, out var trackId, out var timescale))
+            {
+                _trackId = trackId;
+                _timescale = timescale;
+            }
+            else if (type == Mvex)
+            {
+                foreach (var (childType, child) in Children(body))
+                {
+                    // version/flags, track_ID, sample_description_index, duration, size, flags
+                    if (childType == Trex && child.Length >= 24)
+                    {
+                        trex[BinaryPrimitives.ReadUInt32BigEndian(child.AsSpan(4))] = new SampleDefaults(
+                            BinaryPrimitives.ReadUInt32BigEndian(child.AsSpan(12)),
+                            BinaryPrimitives.ReadUInt32BigEndian(child.AsSpan(16)),
+                            BinaryPrimitives.ReadUInt32BigEndian(child.AsSpan(20)));
+                    }
+                }
+            }
+        }
+
+        if (_timescale == 0)
+            throw new InvalidDataException("no video track");
+        trex.TryGetValue(_trackId, out _trex);
+    }
+
+    private static bool TryParseVideoTrak(ReadOnlySpan<byte> trak, out uint trackId, out int timescale)
+    {
+        trackId = 0;
+        timescale = 0;
+        bool video = false;
+
+        foreach (var (type, body) in Children(trak))
+        {
+            if (type == Tkhd && body.Length >= 24)
+            {
+                trackId = BinaryPrimitives.ReadUInt32BigEndian(body.AsSpan(body[0] == 1 ? 20 : 12));
+            }
+            else if (type == Mdia)
+            {
+                foreach (var (childType, child) in Children(body))
+                {
+                    if (childType == Mdhd && child.Length >= 24)
+                        timescale = (int)BinaryPrimitives.ReadUInt32BigEndian(child.AsSpan(child[0] == 1 ? 20 : 12));
+                    else if (childType == Hdlr && child.Length >= 12)
+                        video = BinaryPrimitives.ReadUInt32BigEndian(child.AsSpan(8)) == Vide;
+                }
+            }
+        }
+
+        return video && trackId != 0 && timescale > 0;
+    }
+
+    private void ParseMoof(ReadOnlySpan<byte> moof, long moofOffset)
+    {
+        foreach (var (type, traf) in Children(moof))
+        {
+            if (type != Traf)
+                continue;
+
+            ReadOnlySpan<byte> tfhd = default;
+            foreach (var (childType, child) in Children(traf))
+            {
+                if (childType == Tfhd)
+                    tfhd = child;
+            }
+
+            if (tfhd.Length < 8 || BinaryPrimitives.ReadUInt32BigEndian(tfhd[4..]) != _trackId)
+                continue;
+
+            uint tfhdFlags = BinaryPrimitives.ReadUInt32BigEndian(tfhd) & 0xFFFFFF;
+            var defaults = _trex;
+            long dataBase = moofOffset;
+            int at = 8;
+            if ((tfhdFlags & 0x01) != 0)
+            {
+                // Absolute offsets: the fragment cannot be moved into a clip as-is
+                dataBase = (long)BinaryPrimitives.ReadUInt64BigEndian(tfhd[at..]);
+                at += 8;
+                _writer?.MarkNotSpliceable();
+            }
+            if ((tfhdFlags & 0x02) != 0) at += 4;
+            if ((tfhdFlags & 0x08) != 0) { defaults = defaults with { Duration = BinaryPrimitives.ReadUInt32BigEndian(tfhd[at..]) }; at += 4; }
+            if ((tfhdFlags & 0x10) != 0) { defaults = defaults with { Size = BinaryPrimitives.ReadUInt32BigEndian(tfhd[at..]) }; at += 4; }
+            if ((tfhdFlags & 0x20) != 0) defaults = defaults with { Flags = BinaryPrimitives.ReadUInt32BigEndian(tfhd[at..]) };
+
+            long decodeTime = _nextDecodeTime;
+            long dataCursor = dataBase;
+            bool fragmentStart = true;
+
+            foreach (var (childType, child) in Children(traf))
+            {
+                if (childType == Tfdt && child.Length >= 8)
+                {
+                    decodeTime = child[0] == 1 && child.Length >= 12
+                        ? (long)BinaryPrimitives.ReadUInt64BigEndian(child.AsSpan(4))
+                        : BinaryPrimitives.ReadUInt32BigEndian(child.AsSpan(4));
+                }
+                else if (childType == Trun)
+                {
+                    ParseTrun(child, defaults, moofOffset, dataBase, ref dataCursor, ref decodeTime, ref fragmentStart);
+                }
+            }
+
+            _nextDecodeTime = decodeTime;
+        }
+    }
+
+    private void ParseTrun(ReadOnlySpan<byte> trun, SampleDefaults defaults, long moofOffset, long dataBase,
+        ref long dataCursor, ref long decodeTime, ref bool fragmentStart)
+    {
+        if (trun.Length < 8)
+            throw new InvalidDataException("short trun");
+
+        bool signedOffsets = trun[0] == 1;
+        uint flags = BinaryPrimitives.ReadUInt32BigEndian(trun) & 0xFFFFFF;
+        uint count = BinaryPrimitives.ReadUInt32BigEndian(trun[4..]);
+        int at = 8;
+
+        if ((flags & 0x001) != 0)
+        {
+            dataCursor = dataBase + BinaryPrimitives.ReadInt32BigEndian(trun[at..]);
+            at += 4;
+        }
+
+        uint? firstFlags = null;
+        if ((flags & 0x004) != 0)
+        {
+            firstFlags = BinaryPrimitives.ReadUInt32BigEndian(trun[at..]);
+            at += 4;
+        }
+
+        int perSample = 4 * BitOperations.PopCount(flags & 0xF00);
+        if (trun.Length < at + (long)count * perSample)
+            throw new InvalidDataException("truncated trun");
+
+        for (uint i = 0; i < count; i++)
+        {
+            uint duration = defaults.Duration, size = defaults.Size, sampleFlags = defaults.Flags;
+            long compositionOffset = 0;
+
+            if ((flags & 0x100) != 0) { duration = BinaryPrimitives.ReadUInt32BigEndian(trun[at..]); at += 4; }
+            if ((flags & 0x200) != 0) { size = BinaryPrimitives.ReadUInt32BigEndian(trun[at..]); at += 4; }
+            if ((flags & 0x400) != 0) { sampleFlags = BinaryPrimitives.ReadUInt32BigEndian(trun[at..]); at += 4; }
+            if ((flags & 0x800) != 0)
+            {
+                compositionOffset = signedOffsets
+                    ? BinaryPrimitives.ReadInt32BigEndian(trun[at..])
+                    : BinaryPrimitives.ReadUInt32BigEndian(trun[at..]);
+                at += 4;
+            }
+
+            if (i == 0 && firstFlags.HasValue)
+                sampleFlags = firstFlags.Value;
+
+            long pts = decodeTime + compositionOffset;
+            if (_firstPts == long.MinValue)
+                _firstPts = pts;
+
+            int entryFlags = (sampleFlags & NonSyncSample) == 0 ? RecordingIndex.KeyframeFlag : 0;
+            if (fragmentStart)
+                entryFlags |= RecordingIndex.FragmentStartFlag;
+
+            _pending.Add(new RecordingIndexEntry
+            {
+                Pts = pts,
+                Offset = dataCursor,
+                FragmentOffset = moofOffset,
+                Size = (int)size,
+                Timecode = TimecodeAt(pts),
+                Flags = entryFlags
+            });
+
+            fragmentStart = false;
+            dataCursor += size;
+            decodeTime += duration;
+        }
+    }
+
+    // Start timecode plus whole frames presented since the first frame
+    private uint TimecodeAt(long pts)
+    {
+        if (_startTimecode is not { } start || _frameRate.Value <= 0)
+            return RecordingIndex.NoTimecode;
+
+        long frames = (long)Math.Round((double)(pts - _firstPts) / _timescale * _frameRate.Value);
+        return RecordingIndex.PackTimecode(Smpte12MTimecode.FromTotalFrames(
+            start.ToTotalFrames(_frameRate) + Math.Max(0, frames), _frameRate, start.DropFrame));
+    }
+
+    private static List<(uint Type, byte[] Body)> Children(ReadOnlySpan<byte> container)
+    {
+        var children = new List<(uint, byte[])>();
+        int at = 0;
+        while (at + 8 <= container.Length)
+        {
+            long size = BinaryPrimitives.ReadUInt32BigEndian(container[at..]);
+            uint type = BinaryPrimitives.ReadUInt32BigEndian(container[(at + 4)..]);
+            int headerSize = 8;
+            if (size == 1 && at + 16 <= container.Length)
+            {
+                size = (long)BinaryPrimitives.ReadUInt64BigEndian(container[(at + 8)..]);
+                headerSize = 16;
+            }
+            else if (size == 0)
+            {
+                size = container.Length - at;
+            }
+
+            if (size < headerSize || at + size > container.Length)
+                throw new InvalidDataException("box overruns its parent");
+
+            children.Add((type, container.Slice(at + headerSize, (int)size - headerSize).ToArray()));
+            at += (int)size;
+        }
+        return children;
+    }
+
+    private void Close()
+    {
+        _writer?.Dispose();
+        _writer = null;
+        _file?.Dispose();
+        _file = null;
+    }
+
+    private static void TryDelete(string path)
+    {
+        try
+        {
+            File.Delete(path);
+        }
+        catch (IOException)
+        {
+        }
+        catch (UnauthorizedAccessException)
+        {
+        }
+    }
+
+    public async ValueTask DisposeAsync()
+    {
+        _cts.Cancel();
+        if (_task != null)
+            await _task;
+        Close();
+        _cts.Dispose();
+    }
+
+    // Box types (big-endian four-character codes)
+    private const uint Moov = 0x6D6F6F76, Moof = 0x6D6F6F66, Mdat = 0x6D646174;
+    private const uint Trak = 0x7472616B, Tkhd = 0x746B6864, Mdia = 0x6D646961;
+    private const uint Mdhd = 0x6D646864, Hdlr = 0x68646C72, Vide = 0x76696465;
+    private const uint Mvex = 0x6D766578, Trex = 0x74726578, Traf = 0x74726166;
+    private const uint Tfhd = 0x74666864, Tfdt = 0x74666474, Trun = 0x7472756E;
+
+    private readonly record struct SampleDefaults(uint Duration, uint Size, uint Flags);
+}
@@ -17,6 +17,12 @@ public sealed class RecordingService : IRecordingService, IDisposable
     private readonly IDeviceManager _deviceManager;
     private readonly Func<IEncodingPipeline> _pipelineFactory;
     private readonly ITimecodeService _timecodeService;
+    private readonly ReplayBufferRegistry? _replayBuffers;
+
+    // Replay window per recording when RecordingOptions.ReplayWindow is null (zero disables)
+    private static readonly TimeSpan DefaultReplayWindow = TimeSpan.FromMinutes(2);
+    private const long MinReplayBytes = 64L * 1024 * 1024;
+    private const long MaxReplayBytes = 1024L * 1024 * 1024;
 
     // Multi-input support
     private readonly List<ActiveInputRecording> _activeInputs = new();
@@ -29,6 +35,8 @@ public sealed class RecordingService : IRecordingService, IDisposable
     // For single-input backward compatibility
     private ICaptureDevice? _captureDevice;
     private IEncodingPipeline? _encodingPipeline;
+    private ReplayBuffer? _replayBuffer;
+    private RecordingIndexer? _indexer;
 
     public RecordingState State => _state;
     public RecordingSession? CurrentSession => _currentSession;
@@ -40,12 +48,14 @@ public sealed class RecordingService : IRecordingService, IDisposable
         ILogger<RecordingService> logger,
         IDeviceManager deviceManager,
         Func<IEncodingPipeline> pipelineFactory,
-        ITimecodeService timecodeService)
+        ITimecodeService timecodeService,
+        ReplayBufferRegistry? replayBuffers = null)
     {
         _logger = logger;
         _deviceManager = deviceManager;
         _pipelineFactory = pipelineFactory;
         _timecodeService = timecodeService;
+        _replayBuffers = replayBuffers;
     }
 
     public async Task<RecordingSession> StartRecordingAsync(RecordingOptions options, CancellationToken ct = default)
@@ -126,35 +136,59 @@ public sealed class RecordingService : IRecordingService, IDisposable
                     }
 
                     // Generate filename with input suffix
-                    var inputFilename = baseFilename + inputConfig.FilenameSuffix + ".mp4";
+                    var inputFilename = baseFilename + inputConfig.FilenameSuffix +
+                        (options.RawIsoInputs ? IsoFrameRecorder.GetExtension(mode.PixelFormat) : ".mp4");
                     var inputPath = Path.Combine(options.OutputDirectory, inputFilename);
 
-                    // Create encoding pipeline (capture is already running via preview)
-                    var pipeline = _pipelineFactory();
-                    await pipeline.InitializeAsync(new EncodingConfiguration(
-                        inputPath,
-                        mode,
-                        new AudioFormat(48000, 16, 32),
-                        options.Preset,
-                        HardwareAcceleration.Auto,
-                        UseFragmentedMp4: true
-                    ), ct);
-
+                    // Create encoding pipeline (capture is already running via preview). Raw ISOs
+                    // skip the encoder and write the captured frames with unbuffered I/O.
+                    var pipeline = options.RawIsoInputs
+                        ? new IsoFrameRecorder(_logger, options.MaxDuration)
+                        : _pipelineFactory();
+                    var inputNumber = inputConfig.InputIndex + 1;
+                    pipeline.Backpressure += (_, e) => _logger.LogWarning(
+                        "Input {Index} encoder is behind: {Queued}/{Capacity} frames queued, {Dropped} refused",
+                        inputNumber, e.QueuedFrames, e.QueueCapacity, e.DroppedFrames);
+                    var replay = options.RawIsoInputs ? null : CreateReplayBuffer(inputPath, options, mode);
                     var activeInput = new ActiveInputRecording
                     {
                         Config = inputConfig,
                         Device = device,
                         Pipeline = pipeline,
-                        FilePath = inputPath
+                        FilePath = inputPath,
+                        Replay = replay
                     };
 
+                    try
+                    {
+                        await pipeline.InitializeAsync(new EncodingConfiguration(
+                            inputPath,
+                            mode,
+                            new AudioFormat(48000, 16, 32),
+                            options.Preset,
+                            HardwareAcceleration.Auto,
+                            UseFragmentedMp4: true,
+                            Overlay: inputConfig.Overlay,
+                            Replay: replay
+                        ), ct);
+                    }
+                    catch
+                    {
+                        ReleaseReplayBuffer(inputPath, replay);
+                        throw;
+                    }
+
+                    // A raw file is indexed by its frame size
+                    if (!options.RawIsoInputs)
+                        activeInput.Indexer = StartIndexer(inputPath, mode);
                     _activeInputs.Add(activeInput);
 
                     // Track in session
                     _currentSession.InputSessions.Add(new InputRecordingSession
                     {
                         Input = inputConfig,
-                        FilePath = inputPath
+                        FilePath = inputPath,
+                        HasOverlay = inputConfig.Overlay?.Supports(mode) == true
                     });
 
                     _logger.LogInformation("Started recording input {Index} ({Device}) to {FilePath}",
@@ -180,14 +214,20 @@ public sealed class RecordingService : IRecordingService, IDisposable
                     ?? _captureDevice.SupportedVideoModes.First();
 
                 _encodingPipeline = _pipelineFactory();
+                _encodingPipeline.Backpressure += (_, e) => _logger.LogWarning(
+                    "Encoder is behind: {Queued}/{Capacity} frames queued, {Dropped} refused",
+                    e.QueuedFrames, e.QueueCapacity, e.DroppedFrames);
+                _replayBuffer = CreateReplayBuffer(_currentSession.FilePath, options, mode);
                 await _encodingPipeline.InitializeAsync(new EncodingConfiguration(
                     _currentSession.FilePath,
                     mode,
                     new AudioFormat(48000, 16, 32),
                     options.Preset,
                     HardwareAcceleration.Auto,
-                    UseFragmentedMp4: true
+                    UseFragmentedMp4: true,
+                    Replay: _replayBuffer
                 ), ct);
+                _indexer = StartIndexer(_currentSession.FilePath, mode);
 
                 _logger.LogInformation("Recording started: {FilePath}", _currentSession.FilePath);
             }
@@ -206,6 +246,12 @@ public sealed class RecordingService : IRecordingService, IDisposable
         {
             _logger.LogError(ex, "Failed to start recording");
             await CleanupActiveInputsAsync();
+            if (_currentSession != null)
+                ReleaseReplayBuffer(_currentSession.FilePath, _replayBuffer);
+            _replayBuffer = null;
+            if (_indexer != null)
+                await _indexer.DisposeAsync();
+            _indexer = null;
             SetState(RecordingState.Stopped);
             throw;
         }
@@ -223,10 +269,72 @@ public sealed class RecordingService : IRecordingService, IDisposable
             {
                 _logger.LogWarning(ex, "Error cleaning up input {Index}", input.Config.InputIndex);
             }
+            ReleaseReplayBuffer(input.FilePath, input.Replay);
+            if (input.Indexer != null)
+                await input.Indexer.DisposeAsync();
         }
         _activeInputs.Clear();
     }
 
+    // Ring sized for the window at the preset's peak rate (1.5x mean, as the encoders are
+    // configured) plus audio and TS overhead. MPEG-TS cannot carry ProRes/DNxHD.
+    private ReplayBuffer? CreateReplayBuffer(string recordingPath, RecordingOptions options, VideoMode mode)
+    {
+        var window = options.ReplayWindow ?? DefaultReplayWindow;
+        if (_replayBuffers == null || window <= TimeSpan.Zero ||
+            options.Preset.VideoCodec is not (VideoCodec.H264 or VideoCodec.H265))
+            return null;
+
+        long bytesPerSecond = (long)(options.Preset.VideoBitrateMbps * 1.5 * 125_000) + 64_000;
+        long capacity = Math.Clamp((long)(bytesPerSecond * window.TotalSeconds * 1.1), MinReplayBytes, MaxReplayBytes);
+
+        try
+        {
+            var buffer = new ReplayBuffer(window, capacity);
+            _replayBuffers.Register(recordingPath, buffer);
+            return buffer;
+        }
+        catch (Exception ex) when (ex is IOException or UnauthorizedAccessException)
+        {
+            _logger.LogWarning(ex, "Could not reserve a {Size} MB replay buffer; clips will be cut from {Path}",
+                capacity / (1024 * 1024), recordingPath);
+            return null;
+        }
+    }
+
+    private void ReleaseReplayBuffer(string recordingPath, ReplayBuffer? buffer)
+    {
+        if (buffer == null)
+            return;
+
+        _replayBuffers?.Unregister(recordingPath);
+        buffer.Dispose();
+    }
+
+    // Frame index written next to the file as it grows (fragmented MP4 only), so clips can be
+    // cut by byte range instead of FFmpeg seeking the whole recording
+    private RecordingIndexer StartIndexer(string recordingPath, VideoMode mode)
+    {
+        var indexer = new RecordingIndexer(recordingPath, mode.FrameRate, _currentSession?.StartTimecode, _logger);
+        indexer.Start();
+        return indexer;
+    }
+
+    private async Task CompleteIndexerAsync(RecordingIndexer? indexer)
+    {
+        if (indexer == null)
+            return;
+
+        try
+        {
+            await indexer.CompleteAsync();
+        }
+        catch (Exception ex)
+        {
+            _logger.LogWarning(ex, "Could not finish the frame index of a recording");
+        }
+    }
+
     private async Task RunMultiInputRecordingLoopAsync(CancellationToken ct)
     {
         // Set up handlers for each input
@@ -238,10 +346,15 @@ public sealed class RecordingService : IRecordingService, IDisposable
             {
                 if (_state == RecordingState.Paused) return;
 
+                // The frame is copied into the encoder queue before the write returns, but the write
+                // can wait for queue space: hold the slot, or copy the frame if no lease is free
+                using var hold = e.Retain(out var frame);
                 try
                 {
-                    await localInput.Pipeline.WriteVideoFrameAsync(e.FrameData, e.Timestamp, ct);
-                    localInput.FramesRecorded++;
+                    if (await localInput.Pipeline.WriteVideoFrameAsync(frame, e.Timestamp, ct))
+                        localInput.FramesRecorded++;
+                    else
+                        localInput.DroppedFrames++;
                 }
                 catch (Exception ex)
                 {
@@ -373,17 +486,34 @@ public sealed class RecordingService : IRecordingService, IDisposable
                     {
                         _logger.LogError(ex, "Error stopping input {Index}", input.Config.InputIndex);
                     }
+                    finally
+                    {
+                        ReleaseReplayBuffer(input.FilePath, input.Replay);
+                        await CompleteIndexerAsync(input.Indexer);
+                    }
                 }
                 _activeInputs.Clear();
             }
             else
             {
                 // Single-input cleanup (don't stop capture - preview manages device lifecycle)
-                if (_encodingPipeline != null)
+                try
+                {
+                    if (_encodingPipeline != null)
+                    {
+                        await _encodingPipeline.FinalizeAsync();
+                        await _encodingPipeline.DisposeAsync();
+                    }
+                }
+                finally
                 {
-                    await _encodingPipeline.FinalizeAsync();
-                    await _encodingPipeline.DisposeAsync();
+                    await CompleteIndexerAsync(_indexer);
+                    _indexer = null;
                 }
+
+                if (_currentSession != null)
+                    ReleaseReplayBuffer(_currentSession.FilePath, _replayBuffer);
+                _replayBuffer = null;
             }
 
             if (_currentSession != null)
@@ -464,9 +594,16 @@ public sealed class RecordingService : IRecordingService, IDisposable
         {
             if (_state == RecordingState.Paused) return;
 
+            // Held (or copied) across the write, which can wait for queue space
+            using var hold = e.Retain(out var frame);
             try
             {
-                await _encodingPipeline.WriteVideoFrameAsync(e.FrameData, e.Timestamp, ct);
+                if (!await _encodingPipeline.WriteVideoFrameAsync(frame, e.Timestamp, ct))
+                {
+                    droppedFrames++;
+                    return;
+                }
+
                 framesRecorded++;
 
                 // Update progress every second
@@ -616,6 +753,8 @@ internal class ActiveInputRecording
     public required ICaptureDevice Device { get; init; }
     public required IEncodingPipeline Pipeline { get; init; }
     public required string FilePath { get; init; }
+    public ReplayBuffer? Replay { get; init; }
+    public RecordingIndexer? Indexer { get; set; }
     public long FramesRecorded { get; set; }
     public int DroppedFrames { get; set; }
     public EventHandler<VideoFrameEventArgs>? VideoHandler { get; set; }
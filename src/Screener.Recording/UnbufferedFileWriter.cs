@@ -0,0 +1,363 @@
+using System.Runtime.InteropServices;
+using Microsoft.Extensions.Logging;
+using Microsoft.Win32.SafeHandles;
+using Screener.Core.Buffers;
+
+namespace Screener.Recording;
+
+/// <summary>
+/// Writes a stream of pooled frames to one file with FILE_FLAG_NO_BUFFERING from a dedicated
+/// thread. Frames are packed into sector-aligned staging blocks and each full block goes out as
+/// one overlapped write while the next fills, so several ISOs recording at full rate do not
+/// push gigabytes through the page cache. Queued frames are counted; a full queue refuses the
+/// frame rather than dropping an older one.
+/// <para>
+/// NTFS runs a write past the file's valid data length synchronously, as it zero-fills up to
+/// it first, so the writes only overlap once that length covers the reservation. The writer
+/// moves it with SetFileValidData when the process can enable SeManageVolumePrivilege (an
+/// elevated or service account); otherwise the blocks are written one at a time, still
+/// unbuffered. Until the file is trimmed to its frames on completion (or after a crash), the
+/// reservation past them can hold stale disk contents, which is what the privilege guards.
+/// </para>
+/// </summary>
+internal sealed class UnbufferedFileWriter : IAsyncDisposable
+{
+    // CreateFile flag not in FileOptions; .NET passes it through
+    private const FileOptions NoBuffering = (FileOptions)0x20000000;
+
+    // Offsets, lengths and buffer addresses must be multiples of the volume sector size for
+    // unbuffered I/O. 4 KB covers 512e and 4Kn drives alike.
+    private const int SectorSize = 4096;
+    private const int BlockSize = 8 * 1024 * 1024;
+    private const int BlocksInFlight = 4;
+
+    private const int ErrorNotAllRightsAssigned = 1300;
+    private const int SePrivilegeEnabled = 2;
+    private const int TokenAdjustPrivileges = 0x20;
+    private const int TokenQuery = 0x8;
+
+    [StructLayout(LayoutKind.Sequential, Pack = 4)]
+    private struct TokenPrivileges
+    {
+        public int PrivilegeCount;
+        public long Luid;
+        public int Attributes;
+    }
+
+    [DllImport("kernel32.dll", SetLastError = true)]
+    private static extern bool SetFileValidData(SafeFileHandle file, long validDataLength);
+
+    [DllImport("kernel32.dll")]
+    private static extern IntPtr GetCurrentProcess();
+
+    [DllImport("kernel32.dll", SetLastError = true)]
+    private static extern bool CloseHandle(IntPtr handle);
+
+    [DllImport("advapi32.dll", SetLastError = true)]
+    private static extern bool OpenProcessToken(IntPtr process, int access, out IntPtr token);
+
+    [DllImport("advapi32.dll", SetLastError = true, CharSet = CharSet.Unicode)]
+    private static extern bool LookupPrivilegeValue(string? system, string name, out long luid);
+
+    [DllImport("advapi32.dll", SetLastError = true)]
+    private static extern bool AdjustTokenPrivileges(IntPtr token, bool disableAll, ref TokenPrivileges state,
+        int length, IntPtr previous, IntPtr returnLength);
+
+    // Enabled once per process; false when the account does not hold the privilege
+    private static readonly Lazy<bool> _canSetValidData = new(EnableManageVolumePrivilege);
+
+    private sealed class Block
+    {
+        private readonly byte[] _array;
+        private readonly int _offset;
+
+        public Block()
+        {
+            // Pinned so the aligned window never moves under an overlapped write
+            _array = GC.AllocateUninitializedArray<byte>(BlockSize + SectorSize, pinned: true);
+            long address = Marshal.UnsafeAddrOfPinnedArrayElement(_array, 0);
+            _offset = (int)((SectorSize - address % SectorSize) % SectorSize);
+        }
+
+        public Memory<byte> Memory => _array.AsMemory(_offset, BlockSize);
+        public int Filled;
+        public ValueTask Pending;
+    }
+
+    private readonly string _path;
+    private readonly ILogger _logger;
+    private readonly FrameRingBuffer _ring;
+    private readonly SafeFileHandle _handle;
+    private readonly long _preallocateBytes;
+    private readonly Block[] _blocks;
+    private readonly Thread _thread;
+    private readonly CancellationTokenSource _stop = new();
+    private readonly TaskCompletionSource _done = new(TaskCreationOptions.RunContinuationsAsynchronously);
+
+    private int _current;
+    private long _fileOffset;       // where the current block will be written (sector-aligned)
+    private long _allocated;
+    private long _bytesWritten;     // frame bytes accepted into the file
+    private int _peakQueued;
+    private long _maxWriteTicks;
+    private volatile bool _completing;
+    private bool _extendValidData;
+    private Exception? _fault;
+
+    /// <param name="preallocateBytes">Space reserved up front, and the step the file grows by
+    /// when it fills, so the file is laid out in a few large extents.</param>
+    public UnbufferedFileWriter(string path, int frameSize, int capacity, long preallocateBytes, ILogger logger)
+    {
+        _path = path;
+        _logger = logger;
+        Capacity = capacity;
+        _preallocateBytes = Math.Max(RoundUp(preallocateBytes), BlockSize);
+
+        _handle = File.OpenHandle(path, FileMode.Create, FileAccess.Write, FileShare.Read,
+            FileOptions.Asynchronous | NoBuffering, _preallocateBytes);
+        _allocated = _preallocateBytes;
+        _extendValidData = _canSetValidData.Value;
+        ExtendValidData();
+
+        _ring = new FrameRingBuffer(capacity, frameSize);
+        _blocks = new Block[BlocksInFlight];
+        for (int i = 0; i < _blocks.Length; i++)
+            _blocks[i] = new Block();
+
+        _thread = new Thread(WriterLoop)
+        {
+            IsBackground = true,
+            Name = $"Unbuffered writer ({Path.GetFileName(path)})",
+            Priority = ThreadPriority.AboveNormal
+        };
+        _thread.Start();
+    }
+
+    public int Capacity { get; }
+    /// <summary>Frames waiting to be copied into a staging block.</summary>
+    public int QueuedFrames => _ring.Count;
+    public int PeakQueuedFrames => Volatile.Read(ref _peakQueued);
+    public long BytesWritten => Interlocked.Read(ref _bytesWritten);
+
+    /// <summary>Slowest single block write so far.</summary>
+    public TimeSpan MaxWriteTime => TimeSpan.FromTicks(Interlocked.Read(ref _maxWriteTicks));
+
+    /// <summary>
+    /// Set when the writer stopped because a write failed (disk full, volume gone).
+    /// </summary>
+    public Exception? Fault => _fault;
+
+    public bool HasSpace => _fault == null && !_completing && _ring.Count < Capacity;
+
+    public PooledFrame Rent(int size) => _ring.RentFrame(size);
+
+    /// <summary>
+    /// Queue a filled frame; ownership passes to the writer. False (and the frame is returned
+    /// to the pool) if the queue is full or the writer has stopped. Single producer.
+    /// </summary>
+    public bool TryEnqueue(PooledFrame frame)
+    {
+        if (!HasSpace)
+        {
+            frame.Dispose();
+            return false;
+        }
+
+        _ring.Publish(frame);
+
+        int queued = _ring.Count;
+        if (queued > _peakQueued)
+            Volatile.Write(ref _peakQueued, queued);
+
+        return true;
+    }
+
+    /// <summary>
+    /// Write everything still queued, pad the last sector and trim the file to the frames
+    /// written. Throws the write fault, if any.
+    /// </summary>
+    public async Task CompleteAsync(CancellationToken ct = default)
+    {
+        _completing = true;
+        _stop.Cancel();
+        await _done.Task.WaitAsync(ct);
+
+        if (_fault != null)
+            throw new IOException($"Writing {_path} failed", _fault);
+    }
+
+    private void WriterLoop()
+    {
+        try
+        {
+            while (true)
+            {
+                // Null once stopped; whatever is left is drained below
+                var frame = _ring.DequeueAsync(_stop.Token).GetAwaiter().GetResult();
+                if (frame == null)
+                {
+                    if (_stop.IsCancellationRequested)
+                        break;
+                    continue;
+                }
+
+                WriteFrame(frame);
+            }
+
+            while (_ring.TryDequeue(out var frame))
+                WriteFrame(frame!);
+
+            Finish();
+        }
+        catch (Exception ex)
+        {
+            _fault = ex;
+            _logger.LogError(ex, "Unbuffered write to {Path} failed; {Queued} queued frames discarded", _path, _ring.Count);
+
+            while (_ring.TryDequeue(out var frame))
+                frame!.Dispose();
+        }
+        finally
+        {
+            _done.TrySetResult();
+        }
+    }
+
+    private void WriteFrame(PooledFrame frame)
+    {
+        try
+        {
+            if (_fault != null)
+                return;
+
+            var data = frame.Span;
+            while (!data.IsEmpty)
+            {
+                var block = _blocks[_current];
+                int count = Math.Min(data.Length, BlockSize - block.Filled);
+                data.Slice(0, count).CopyTo(block.Memory.Span.Slice(block.Filled));
+                block.Filled += count;
+                data = data.Slice(count);
+
+                if (block.Filled == BlockSize)
+                    Submit(block, BlockSize);
+            }
+
+            Interlocked.Add(ref _bytesWritten, frame.Length);
+        }
+        finally
+        {
+            frame.Dispose();
+        }
+    }
+
+    // Start the block's write and move to the next block, waiting for that one's previous
+    // write if every block is still in flight
+    private void Submit(Block block, int length)
+    {
+        if (_fileOffset + length > _allocated)
+        {
+            // Extend in large steps so the writes stay inside the file and NTFS keeps the
+            // extents contiguous; trimmed back in Finish
+            _allocated += _preallocateBytes;
+            RandomAccess.SetLength(_handle, _allocated);
+            ExtendValidData();
+        }
+
+        long started = Environment.TickCount64;
+        block.Pending = TimeWrite(RandomAccess.WriteAsync(_handle, block.Memory.Slice(0, length), _fileOffset), started);
+        _fileOffset += length;
+
+        _current = (_current + 1) % _blocks.Length;
+        var next = _blocks[_current];
+        next.Pending.GetAwaiter().GetResult();
+        next.Pending = default;
+        next.Filled = 0;
+    }
+
+    private async ValueTask TimeWrite(ValueTask write, long started)
+    {
+        await write.ConfigureAwait(false);
+
+        long ticks = TimeSpan.FromMilliseconds(Environment.TickCount64 - started).Ticks;
+        long max;
+        while (ticks > (max = Interlocked.Read(ref _maxWriteTicks)) &&
+               Interlocked.CompareExchange(ref _maxWriteTicks, ticks, max) != max)
+        {
+        }
+    }
+
+    private void Finish()
+    {
+        var tail = _blocks[_current];
+        if (tail.Filled > 0)
+        {
+            // Zero-pad the last write to a whole sector; the padding is cut off below
+            int length = (int)RoundUp(tail.Filled);
+            tail.Memory.Span.Slice(tail.Filled, length - tail.Filled).Clear();
+            Submit(tail, length);
+        }
+
+        foreach (var block in _blocks)
+        {
+            block.Pending.GetAwaiter().GetResult();
+            block.Pending = default;
+        }
+
+        // End of file needs no alignment, so the file ends at the last frame byte
+        RandomAccess.SetLength(_handle, BytesWritten);
+    }
+
+    // Lets the writes into the reservation run overlapped instead of behind NTFS's zero-fill
+    private void ExtendValidData()
+    {
+        if (!_extendValidData)
+            return;
+
+        if (!SetFileValidData(_handle, _allocated))
+        {
+            // E.g. a volume that is not NTFS; the writes still work, serialized
+            _extendValidData = false;
+            _logger.LogDebug("SetFileValidData failed for {Path} (error {Error}); writes will not overlap",
+                _path, Marshal.GetLastWin32Error());
+        }
+    }
+
+    private static bool EnableManageVolumePrivilege()
+    {
+        if (!OperatingSystem.IsWindows() ||
+            !OpenProcessToken(GetCurrentProcess(), TokenAdjustPrivileges | TokenQuery, out var token))
+            return false;
+
+        try
+        {
+            if (!LookupPrivilegeValue(null, "SeManageVolumePrivilege", out long luid))
+                return false;
+
+            var privileges = new TokenPrivileges { PrivilegeCount = 1, Luid = luid, Attributes = SePrivilegeEnabled };
+            return AdjustTokenPrivileges(token, false, ref privileges, 0, IntPtr.Zero, IntPtr.Zero) &&
+                   Marshal.GetLastWin32Error() != ErrorNotAllRightsAssigned;
+        }
+        finally
+        {
+            CloseHandle(token);
+        }
+    }
+
+    private static long RoundUp(long bytes) => (bytes + SectorSize - 1) / SectorSize * SectorSize;
+
+    public async ValueTask DisposeAsync()
+    {
+        _completing = true;
+        _stop.Cancel();
+        try
+        {
+            await _done.Task;
+        }
+        catch { }
+
+        _handle.Dispose();
+        _ring.Dispose();
+        _stop.Dispose();
+    }
+}
@@ -0,0 +1,202 @@
+using System.Runtime.InteropServices;
+using Screener.Core.Native;
+
+namespace Screener.Streaming;
+
+internal enum LiveStreamCodec
+{
+    H264 = 0,
+    Jpeg = 1
+}
+
+/// <summary>
+/// One encoded preview frame: an H.264 Annex B access unit (SPS/PPS ahead of every IDR) or a JPEG.
+/// </summary>
+internal readonly record struct LiveStreamPacket(byte[] Data, bool Keyframe, TimeSpan Timestamp);
+
+/// <summary>
+/// In-memory encoder for the preview streams, backed by the native DLL's live encoder: the
+/// captured UYVY frame is box-scaled to NV12 by the SIMD kernels and encoded by a Media
+/// Foundation H.264 transform (the GPU's encoder when there is one) or WIC's planar JPEG
+/// encoder, with no RGB bitmap in between. Not thread-safe: one encode loop drives it.
+/// </summary>
+internal sealed class LiveStreamEncoder : IDisposable
+{
+    private const string NativeDll = "Screener.Capture.Blackmagic.Native.dll";
+
+    // Mirrors LiveEncoderSettings / LiveEncoderStats in LiveEncoder.h
+    [StructLayout(LayoutKind.Sequential)]
+    private struct LiveEncoderSettings
+    {
+        public int Width;
+        public int Height;
+        public int Divisor;         // 1, 2 or 4
+        public int FrameRateNum;
+        public int FrameRateDen;
+        public int Codec;           // 0 = H.264, 1 = JPEG
+        public int BitrateKbps;
+        public int GopFrames;       // 0 = two seconds
+        public int JpegQuality;
+        public int AllowHardware;
+    }
+
+    [StructLayout(LayoutKind.Sequential)]
+    private struct LiveEncoderStats
+    {
+        public ulong FramesIn;
+        public ulong FramesOut;
+        public ulong BytesOut;
+        public ulong ConvertUsTotal;
+        public ulong EncodeUsTotal;
+        public int Hardware;
+        public int LastError;
+    }
+
+    [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl)]
+    private static extern int IsLiveEncoderAvailable(int codec);
+
+    [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl)]
+    private static extern IntPtr CreateLiveEncoder(ref LiveEncoderSettings settings, out int error);
+
+    [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl)]
+    private static extern int SendLiveEncoderFrame(IntPtr encoder, ref byte src, int srcBufferSize, int srcPitch,
+        long timestamp, int forceKeyframe);
+
+    [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl)]
+    private static extern int ReceiveLiveEncoderOutput(IntPtr encoder, ref byte dst, int dstCapacity,
+        out int size, out int keyframe, out long timestamp);
+
+    [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl)]
+    private static extern void DestroyLiveEncoder(IntPtr encoder);
+
+    [DllImport(NativeDll, CallingConvention = CallingConvention.Cdecl)]
+    private static extern int GetLiveEncoderStats(IntPtr encoder, out LiveEncoderStats stats, int statsSize);
+
+    private static readonly Lazy<bool> _h264Available = new(() => Probe(LiveStreamCodec.H264));
+    private static readonly Lazy<bool> _jpegAvailable = new(() => Probe(LiveStreamCodec.Jpeg));
+
+    private IntPtr _handle;
+    private byte[] _receiveBuffer = new byte[256 * 1024];
+
+    public LiveStreamCodec Codec { get; }
+    public int Width { get; }
+    public int Height { get; }
+    public int Divisor { get; }
+
+    /// <summary>True when the H.264 transform is a hardware (GPU) encoder.</summary>
+    public bool IsHardware { get; }
+
+    private LiveStreamEncoder(IntPtr handle, LiveStreamCodec codec, int width, int height, int divisor)
+    {
+        _handle = handle;
+        Codec = codec;
+        Width = width;
+        Height = height;
+        Divisor = divisor;
+        IsHardware = GetLiveEncoderStats(handle, out var stats, Marshal.SizeOf<LiveEncoderStats>()) == 1 && stats.Hardware == 1;
+    }
+
+    public static bool IsAvailable(LiveStreamCodec codec) =>
+        codec == LiveStreamCodec.H264 ? _h264Available.Value : _jpegAvailable.Value;
+
+    /// <summary>
+    /// Create an encoder for width x height output from a source divisor times larger.
+    /// Throws <see cref="InvalidOperationException"/> with the native HRESULT if it cannot be created.
+    /// </summary>
+    public static LiveStreamEncoder Create(LiveStreamCodec codec, int width, int height, int divisor,
+        int frameRate, int bitrateKbps, int jpegQuality)
+    {
+        var settings = new LiveEncoderSettings
+        {
+            Width = width,
+            Height = height,
+            Divisor = divisor,
+            FrameRateNum = frameRate,
+            FrameRateDen = 1,
+            Codec = (int)codec,
+            BitrateKbps = bitrateKbps,
+            JpegQuality = jpegQuality,
+            AllowHardware = 1
+        };
+
+        var handle = CreateLiveEncoder(ref settings, out int error);
+        if (handle == IntPtr.Zero)
+            throw new InvalidOperationException($"Live {codec} encoder ({width}x{height}) could not be created: 0x{error:X8}");
+
+        return new LiveStreamEncoder(handle, codec, width, height, divisor);
+    }
+
+    /// <summary>
+    /// Scale and encode one source frame. False when the encoder is not ready for input (the
+    /// frame is dropped); the output it has finished is still waiting in <see cref="TryReceive"/>.
+    /// </summary>
+    public bool Encode(ReadOnlySpan<byte> frame, int srcPitch, TimeSpan timestamp, bool forceKeyframe)
+    {
+        ObjectDisposedException.ThrowIf(_handle == IntPtr.Zero, this);
+
+        int result = SendLiveEncoderFrame(_handle, ref MemoryMarshal.GetReference(frame), frame.Length, srcPitch,
+            timestamp.Ticks, forceKeyframe ? 1 : 0);
+
+        return result switch
+        {
+            1 => true,
+            0 => false,
+            -1 => throw new ArgumentException($"Frame does not cover {Width * Divisor}x{Height * Divisor} at pitch {srcPitch}", nameof(frame)),
+            _ => throw new InvalidOperationException($"Live {Codec} encode failed: 0x{LastError():X8}")
+        };
+    }
+
+    public bool TryReceive(out LiveStreamPacket packet)
+    {
+        ObjectDisposedException.ThrowIf(_handle == IntPtr.Zero, this);
+
+        int result;
+        int size, keyframe;
+        long timestamp;
+        while ((result = ReceiveLiveEncoderOutput(_handle, ref _receiveBuffer[0], _receiveBuffer.Length,
+                   out size, out keyframe, out timestamp)) == -3)
+        {
+            _receiveBuffer = new byte[Math.Max(size, _receiveBuffer.Length * 2)];
+        }
+
+        if (result != 1)
+        {
+            packet = default;
+            return false;
+        }
+
+        packet = new LiveStreamPacket(_receiveBuffer.AsSpan(0, size).ToArray(), keyframe == 1, TimeSpan.FromTicks(timestamp));
+        return true;
+    }
+
+    private int LastError() =>
+        GetLiveEncoderStats(_handle, out var stats, Marshal.SizeOf<LiveEncoderStats>()) == 1 ? stats.LastError : 0;
+
+    private static bool Probe(LiveStreamCodec codec)
+    {
+        if (!MediaKernels.IsAvailable)
+            return false;
+
+        try
+        {
+            return IsLiveEncoderAvailable((int)codec) == 1;
+        }
+        catch (EntryPointNotFoundException)
+        {
+            return false;
+        }
+        catch (DllNotFoundException)
+        {
+            return false;
+        }
+    }
+
+    public void Dispose()
+    {
+        if (_handle != IntPtr.Zero)
+        {
+            DestroyLiveEncoder(_handle);
+            _handle = IntPtr.Zero;
+        }
+    }
+}
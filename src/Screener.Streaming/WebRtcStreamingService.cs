@@ -12,7 +12,11 @@ using Screener.Abstractions.Scheduling;
 using Screener.Abstractions.Streaming;
 using Screener.Core.Persistence;
 using Screener.Golf.Models;
+using Screener.Golf.Overlays;
 using Screener.Golf.Persistence;
+using CapturePixelFormat = Screener.Abstractions.Capture.PixelFormat;
+using FrameRate = Screener.Abstractions.Capture.FrameRate;
+using VideoMode = Screener.Abstractions.Capture.VideoMode;
 
 namespace Screener.Streaming;
 
@@ -182,6 +186,7 @@ public sealed class WebRtcStreamingService : IStreamingService
 
             _state = StreamingState.Running;
             _startedAt = DateTimeOffset.UtcNow;
+            StartEncodeLoop();
 
             _logger.LogInformation("WebRTC streaming started at {Uri}", SignalingUri);
         }
@@ -207,6 +212,7 @@ public sealed class WebRtcStreamingService : IStreamingService
 
         // Mark streaming as stopped but keep HTTP listener running for API relay
         _state = StreamingState.Stopped;
+        await StopEncodeLoopAsync();
 
         _logger.LogInformation("WebRTC streaming stopped (listener remains active)");
     }
@@ -220,6 +226,7 @@ public sealed class WebRtcStreamingService : IStreamingService
         _listenerRunning = false;
 
         _cts?.Cancel();
+        await StopEncodeLoopAsync();
 
         foreach (var viewer in _viewers.Values)
         {
@@ -259,181 +266,447 @@ public sealed class WebRtcStreamingService : IStreamingService
     private float _overlayFontSize = 32;
     private string _overlayFontFamily = "Arial";
 
-    // UYVY→JPEG encoding state
-    private int _streamWidth;
-    private int _streamHeight;
-    private volatile bool _encoding;
-
-    public async Task PushFrameAsync(ReadOnlyMemory<byte> frameData, TimeSpan timestamp, CancellationToken ct = default)
+    // Preview encoding. PushFrameAsync copies only the frames due at the stream's frame rate
+    // into the pending slot; the encode loop takes the newest one, so a slow encode or viewer
+    // drops frames instead of holding up capture.
+    private const int SourceWidth = 1920;
+    private const int SourceHeight = 1080;
+    private const int JpegQuality = 60;
+
+    private static readonly VideoMode SourceMode =
+        new(SourceWidth, SourceHeight, new FrameRate(30, 1), CapturePixelFormat.UYVY, false, "Preview source");
+
+    private readonly object _frameLock = new();
+    private readonly SemaphoreSlim _frameReady = new(0, 1);
+    private byte[] _pendingFrame = Array.Empty<byte>();
+    private byte[] _encodeFrame = Array.Empty<byte>();
+    private int _pendingLength;
+    private TimeSpan _pendingTimestamp;
+    private long _nextFrameDue;
+    private CancellationTokenSource? _encodeCts;
+    private Task? _encodeTask;
+
+    // Owned by the encode loop
+    private LiveStreamEncoder? _h264Encoder;
+    private LiveStreamEncoder? _jpegEncoder;
+    private StreamQualitySettings? _encoderQuality;
+    private bool _nativeJpegFailed;
+    private volatile bool _h264Failed;
+    private volatile bool _keyframeRequested;
+    private LowerThirdLayer? _lowerThirdLayer;
+
+    private sealed record LowerThirdLayer(string Text, float X, float Y, OverlayLayer? Layer);
+
+    private bool CanStreamH264 => !_h264Failed && LiveStreamEncoder.IsAvailable(LiveStreamCodec.H264);
+
+    public Task PushFrameAsync(ReadOnlyMemory<byte> frameData, TimeSpan timestamp, CancellationToken ct = default)
     {
-        bool hasLocalViewers = _state == StreamingState.Running && !_viewers.IsEmpty && _config != null;
+        var config = _config;
+        bool hasLocalViewers = _state == StreamingState.Running && !_viewers.IsEmpty && config != null;
         bool hasPanelRelay = _state == StreamingState.Running && _panelRelay?.IsConnected == true;
 
-        if (!hasLocalViewers && !hasPanelRelay)
+        if (config == null || (!hasLocalViewers && !hasPanelRelay))
+            return Task.CompletedTask;
+
+        // Pace on capture time; a jump back (new source) restarts the schedule
+        long now = timestamp.Ticks;
+        long interval = TimeSpan.TicksPerSecond / Math.Max(1, config.Quality.MaxFrameRate);
+        long due = _nextFrameDue;
+        if (now < due && due - now <= interval)
+            return Task.CompletedTask;
+        _nextFrameDue = now >= due && now - due < interval ? due + interval : now + interval;
+
+        lock (_frameLock)
+        {
+            if (_pendingFrame.Length < frameData.Length)
+                _pendingFrame = new byte[frameData.Length];
+            frameData.Span.CopyTo(_pendingFrame);
+            _pendingLength = frameData.Length;
+            _pendingTimestamp = timestamp;
+        }
+
+        if (_frameReady.CurrentCount == 0)
+        {
+            try { _frameReady.Release(); } catch (SemaphoreFullException) { }
+        }
+
+        return Task.CompletedTask;
+    }
+
+    private void StartEncodeLoop()
+    {
+        if (_encodeTask != null)
             return;
 
-        // Skip if still encoding the previous frame
-        if (_encoding)
+        _nextFrameDue = 0;
+        _encodeCts = new CancellationTokenSource();
+        _encodeTask = Task.Run(() => EncodeLoopAsync(_encodeCts.Token));
+    }
+
+    private async Task StopEncodeLoopAsync()
+    {
+        if (_encodeTask == null)
             return;
-        _encoding = true;
 
+        _encodeCts?.Cancel();
+        try { await _encodeTask; } catch { }
+
+        _encodeCts?.Dispose();
+        _encodeCts = null;
+        _encodeTask = null;
+    }
+
+    private async Task EncodeLoopAsync(CancellationToken ct)
+    {
         try
         {
-            var quality = _config.Quality;
-            // Source is 1920x1080 UYVY; compute target size
-            int srcWidth = 1920;
-            int srcHeight = 1080;
-            int srcRowBytes = frameData.Length / srcHeight;
-            if (srcRowBytes < srcWidth * 2)
+            while (!ct.IsCancellationRequested)
             {
-                _encoding = false;
-                return;
-            }
-
-            int dstWidth = quality.MaxWidth;
-            int dstHeight = quality.MaxHeight;
-            int divisor = Math.Max(1, srcWidth / dstWidth);
-            dstWidth = srcWidth / divisor;
-            dstHeight = srcHeight / divisor;
-
-            byte[]? jpegBytes = null;
+                await _frameReady.WaitAsync(ct);
 
-            await Task.Run(() =>
-            {
-                var srcBytes = frameData.Span;
-                using var bmp = new Bitmap(dstWidth, dstHeight, PixelFormat.Format24bppRgb);
-                var bmpData = bmp.LockBits(new Rectangle(0, 0, dstWidth, dstHeight),
-                    ImageLockMode.WriteOnly, PixelFormat.Format24bppRgb);
+                int length;
+                TimeSpan timestamp;
+                lock (_frameLock)
+                {
+                    (_pendingFrame, _encodeFrame) = (_encodeFrame, _pendingFrame);
+                    length = _pendingLength;
+                    timestamp = _pendingTimestamp;
+                }
 
                 try
                 {
-                    int dstStride = bmpData.Stride;
-                    unsafe
-                    {
-                        byte* dstPtr = (byte*)bmpData.Scan0;
-
-                        for (int dstRow = 0; dstRow < dstHeight; dstRow++)
-                        {
-                            int srcRow = dstRow * divisor;
-                            int srcRowStart = srcRow * srcRowBytes;
-                            int dstRowStart = dstRow * dstStride;
-
-                            for (int dstCol = 0; dstCol < dstWidth - 1; dstCol += 2)
-                            {
-                                int srcCol = dstCol * divisor;
-                                int uyvyIndex = srcRowStart + srcCol * 2;
-
-                                if (uyvyIndex + 3 >= srcBytes.Length) break;
-
-                                int u = srcBytes[uyvyIndex];
-                                int y0 = srcBytes[uyvyIndex + 1];
-                                int v = srcBytes[uyvyIndex + 2];
-                                int y1 = srcBytes[uyvyIndex + 3];
-
-                                // YUV→RGB (BT.601)
-                                int c0 = 298 * (y0 - 16);
-                                int c1 = 298 * (y1 - 16);
-                                int d = u - 128;
-                                int e = v - 128;
-
-                                int r0 = (c0 + 409 * e + 128) >> 8;
-                                int g0 = (c0 - 100 * d - 208 * e + 128) >> 8;
-                                int b0 = (c0 + 516 * d + 128) >> 8;
-
-                                int r1 = (c1 + 409 * e + 128) >> 8;
-                                int g1 = (c1 - 100 * d - 208 * e + 128) >> 8;
-                                int b1 = (c1 + 516 * d + 128) >> 8;
-
-                                int idx0 = dstRowStart + dstCol * 3;
-                                dstPtr[idx0] = (byte)Math.Clamp(b0, 0, 255);
-                                dstPtr[idx0 + 1] = (byte)Math.Clamp(g0, 0, 255);
-                                dstPtr[idx0 + 2] = (byte)Math.Clamp(r0, 0, 255);
-
-                                int idx1 = idx0 + 3;
-                                dstPtr[idx1] = (byte)Math.Clamp(b1, 0, 255);
-                                dstPtr[idx1 + 1] = (byte)Math.Clamp(g1, 0, 255);
-                                dstPtr[idx1 + 2] = (byte)Math.Clamp(r1, 0, 255);
-                            }
-                        }
-                    }
+                    await EncodeAndSendAsync(_encodeFrame.AsMemory(0, length), timestamp, ct);
                 }
-                finally
+                catch (Exception ex) when (ex is not OperationCanceledException)
                 {
-                    bmp.UnlockBits(bmpData);
+                    _logger.LogDebug(ex, "Error encoding/sending frame");
                 }
+            }
+        }
+        catch (OperationCanceledException)
+        {
+        }
+        finally
+        {
+            DisposeEncoders();
+        }
+    }
+
+    private async Task EncodeAndSendAsync(Memory<byte> frame, TimeSpan timestamp, CancellationToken ct)
+    {
+        var config = _config;
+        if (config == null)
+            return;
+
+        // Source is 1920x1080 UYVY
+        int srcRowBytes = frame.Length / SourceHeight;
+        if (srcRowBytes < SourceWidth * 2)
+            return;
+
+        if (_encoderQuality != config.Quality)
+        {
+            DisposeEncoders();
+            _encoderQuality = config.Quality;
+        }
+
+        // Lower third goes into the source frame, so every encoding below carries it
+        ApplyLowerThird(frame.Span, srcRowBytes);
+
+        bool panelRelay = _panelRelay?.IsConnected == true;
+        bool jpegViewers = false, h264Viewers = false;
+        foreach (var viewer in _viewers.Values)
+        {
+            if (viewer.UsesH264)
+                h264Viewers = true;
+            else
+                jpegViewers = true;
+        }
+
+        var sendTasks = new List<Task>();
 
-                // Composite lower third overlay if KEY is active
-                if (_overlayLowerThirdVisible && !string.IsNullOrEmpty(_overlayLowerThirdText))
+        if (h264Viewers)
+        {
+            foreach (var packet in EncodeH264(frame.Span, srcRowBytes, config.Quality, timestamp))
+            {
+                foreach (var viewer in _viewers.Values)
                 {
-                    float scaleX = (float)dstWidth / 1920f;
-                    float scaleY = (float)dstHeight / 1080f;
-                    float x = _overlayLowerThirdX * scaleX;
-                    float y = _overlayLowerThirdY * scaleY;
-                    float fontSize = _overlayFontSize * scaleY;
-
-                    using var g = Graphics.FromImage(bmp);
-                    g.TextRenderingHint = System.Drawing.Text.TextRenderingHint.AntiAlias;
-                    g.SmoothingMode = System.Drawing.Drawing2D.SmoothingMode.AntiAlias;
-
-                    using var font = new Font(_overlayFontFamily, Math.Max(8, fontSize), FontStyle.Bold);
-                    var textSize = g.MeasureString(_overlayLowerThirdText, font);
-
-                    // Background box (semi-transparent black)
-                    float pad = 8 * scaleY;
-                    using var boxBrush = new SolidBrush(Color.FromArgb(153, 0, 0, 0));
-                    g.FillRectangle(boxBrush, x - pad, y - pad,
-                        textSize.Width + 2 * pad, textSize.Height + 2 * pad);
-
-                    // Text
-                    using var textBrush = new SolidBrush(Color.White);
-                    g.DrawString(_overlayLowerThirdText, font, textBrush, x, y);
+                    if (!viewer.UsesH264 || (viewer.AwaitingKeyframe && !packet.Keyframe))
+                        continue;
+
+                    viewer.AwaitingKeyframe = false;
+                    sendTasks.Add(viewer.SendAsync(packet.Data, WebSocketMessageType.Binary, ct));
+                    viewer.FrameCount++;
                 }
+            }
+        }
 
-                // Encode to JPEG
-                using var ms = new MemoryStream();
-                var jpegEncoder = ImageCodecInfo.GetImageEncoders()
-                    .First(c => c.FormatID == ImageFormat.Jpeg.Guid);
-                var encoderParams = new EncoderParameters(1);
-                encoderParams.Param[0] = new EncoderParameter(System.Drawing.Imaging.Encoder.Quality, 60L);
-                bmp.Save(ms, jpegEncoder, encoderParams);
-                jpegBytes = ms.ToArray();
-            }, ct);
-
-            if (jpegBytes == null || jpegBytes.Length == 0)
+        if (jpegViewers || panelRelay)
+        {
+            var jpegBytes = EncodeJpeg(frame.Span, srcRowBytes, config.Quality, timestamp);
+            if (jpegBytes != null && jpegBytes.Length > 0)
             {
-                _encoding = false;
-                return;
+                // Send to panel relay (cloud push)
+                if (panelRelay)
+                    _ = _panelRelay!.SendFrameAsync(jpegBytes);
+
+                foreach (var viewer in _viewers.Values)
+                {
+                    if (viewer.UsesH264)
+                        continue;
+
+                    sendTasks.Add(viewer.SendAsync(jpegBytes, WebSocketMessageType.Binary, ct));
+                    viewer.FrameCount++;
+                }
             }
+        }
+
+        if (sendTasks.Count > 0)
+            await Task.WhenAll(sendTasks);
+    }
 
-            // Send to panel relay (cloud push)
-            if (_panelRelay?.IsConnected == true)
+    // Output size for the quality's width cap. The native scaler halves or quarters; the
+    // GDI+ fallback point-samples any integer divisor.
+    private static (int Width, int Height, int Divisor) PreviewSize(StreamQualitySettings quality, bool native)
+    {
+        int divisor = Math.Max(1, SourceWidth / Math.Max(1, quality.MaxWidth));
+        if (native)
+            divisor = divisor <= 1 ? 1 : divisor == 2 ? 2 : 4;
+        return (SourceWidth / divisor & ~1, SourceHeight / divisor & ~1, divisor);
+    }
+
+    // Constrained baseline at level 3.1, or 4.0 above 720p
+    private static string H264CodecString(int width, int height) =>
+        width * height > 1280 * 720 ? "avc1.42E028" : "avc1.42E01F";
+
+    private List<LiveStreamPacket> EncodeH264(ReadOnlySpan<byte> frame, int srcRowBytes, StreamQualitySettings quality, TimeSpan timestamp)
+    {
+        var packets = new List<LiveStreamPacket>(1);
+        if (!CanStreamH264)
+        {
+            FallBackToJpegViewers();
+            return packets;
+        }
+
+        try
+        {
+            if (_h264Encoder == null)
             {
-                _ = _panelRelay.SendFrameAsync(jpegBytes);
+                var (width, height, divisor) = PreviewSize(quality, native: true);
+                _h264Encoder = LiveStreamEncoder.Create(LiveStreamCodec.H264, width, height, divisor,
+                    quality.MaxFrameRate, quality.MaxBitrateKbps, JpegQuality);
+                _keyframeRequested = true;
+                _logger.LogInformation("Preview H.264 encoder started: {Width}x{Height} @ {Bitrate} kbps ({Kind})",
+                    width, height, quality.MaxBitrateKbps, _h264Encoder.IsHardware ? "hardware" : "software");
             }
 
-            // Send to all connected local viewers
-            var sendTasks = new List<Task>();
-            foreach (var viewer in _viewers.Values)
+            bool keyframe = _keyframeRequested;
+            if (_h264Encoder.Encode(frame, srcRowBytes, timestamp, keyframe))
+                _keyframeRequested = false;
+
+            while (_h264Encoder.TryReceive(out var packet))
+                packets.Add(packet);
+        }
+        catch (Exception ex) when (ex is InvalidOperationException or ArgumentException)
+        {
+            _logger.LogWarning(ex, "Preview H.264 encoding failed; viewers fall back to JPEG");
+            _h264Failed = true;
+            _h264Encoder?.Dispose();
+            _h264Encoder = null;
+            FallBackToJpegViewers();
+        }
+
+        return packets;
+    }
+
+    private void FallBackToJpegViewers()
+    {
+        foreach (var viewer in _viewers.Values)
+            viewer.UsesH264 = false;
+    }
+
+    private byte[]? EncodeJpeg(ReadOnlySpan<byte> frame, int srcRowBytes, StreamQualitySettings quality, TimeSpan timestamp)
+    {
+        if (!_nativeJpegFailed && LiveStreamEncoder.IsAvailable(LiveStreamCodec.Jpeg))
+        {
+            try
             {
-                if (viewer.WebSocket.State == WebSocketState.Open)
+                if (_jpegEncoder == null)
                 {
-                    sendTasks.Add(viewer.WebSocket.SendAsync(
-                        jpegBytes, WebSocketMessageType.Binary, true, ct));
-                    viewer.FrameCount++;
+                    var (width, height, divisor) = PreviewSize(quality, native: true);
+                    _jpegEncoder = LiveStreamEncoder.Create(LiveStreamCodec.Jpeg, width, height, divisor,
+                        quality.MaxFrameRate, quality.MaxBitrateKbps, JpegQuality);
                 }
+
+                return _jpegEncoder.Encode(frame, srcRowBytes, timestamp, forceKeyframe: false) &&
+                       _jpegEncoder.TryReceive(out var packet)
+                    ? packet.Data
+                    : null;
             }
+            catch (Exception ex) when (ex is InvalidOperationException or ArgumentException)
+            {
+                _logger.LogWarning(ex, "Native preview JPEG encoding failed; using GDI+");
+                _nativeJpegFailed = true;
+                _jpegEncoder?.Dispose();
+                _jpegEncoder = null;
+            }
+        }
+
+        return EncodeJpegGdi(frame, srcRowBytes, quality);
+    }
+
+    // Fallback when the native DLL is not deployed: point-sampled UYVY→RGB and GDI+ JPEG
+    private static byte[] EncodeJpegGdi(ReadOnlySpan<byte> srcBytes, int srcRowBytes, StreamQualitySettings quality)
+    {
+        var (dstWidth, dstHeight, divisor) = PreviewSize(quality, native: false);
+
+        using var bmp = new Bitmap(dstWidth, dstHeight, PixelFormat.Format24bppRgb);
+        var bmpData = bmp.LockBits(new Rectangle(0, 0, dstWidth, dstHeight),
+            ImageLockMode.WriteOnly, PixelFormat.Format24bppRgb);
+
+        try
+        {
+            int dstStride = bmpData.Stride;
+            unsafe
+            {
+                byte* dstPtr = (byte*)bmpData.Scan0;
 
-            if (sendTasks.Count > 0)
-                await Task.WhenAll(sendTasks);
+                for (int dstRow = 0; dstRow < dstHeight; dstRow++)
+                {
+                    int srcRow = dstRow * divisor;
+                    int srcRowStart = srcRow * srcRowBytes;
+                    int dstRowStart = dstRow * dstStride;
+
+                    for (int dstCol = 0; dstCol < dstWidth - 1; dstCol += 2)
+                    {
+                        int srcCol = dstCol * divisor;
+                        int uyvyIndex = srcRowStart + srcCol * 2;
+
+                        if (uyvyIndex + 3 >= srcBytes.Length) break;
+
+                        int u = srcBytes[uyvyIndex];
+                        int y0 = srcBytes[uyvyIndex + 1];
+                        int v = srcBytes[uyvyIndex + 2];
+                        int y1 = srcBytes[uyvyIndex + 3];
+
+                        // YUV→RGB (BT.601)
+                        int c0 = 298 * (y0 - 16);
+                        int c1 = 298 * (y1 - 16);
+                        int d = u - 128;
+                        int e = v - 128;
+
+                        int r0 = (c0 + 409 * e + 128) >> 8;
+                        int g0 = (c0 - 100 * d - 208 * e + 128) >> 8;
+                        int b0 = (c0 + 516 * d + 128) >> 8;
+
+                        int r1 = (c1 + 409 * e + 128) >> 8;
+                        int g1 = (c1 - 100 * d - 208 * e + 128) >> 8;
+                        int b1 = (c1 + 516 * d + 128) >> 8;
+
+                        int idx0 = dstRowStart + dstCol * 3;
+                        dstPtr[idx0] = (byte)Math.Clamp(b0, 0, 255);
+                        dstPtr[idx0 + 1] = (byte)Math.Clamp(g0, 0, 255);
+                        dstPtr[idx0 + 2] = (byte)Math.Clamp(r0, 0, 255);
+
+                        int idx1 = idx0 + 3;
+                        dstPtr[idx1] = (byte)Math.Clamp(b1, 0, 255);
+                        dstPtr[idx1 + 1] = (byte)Math.Clamp(g1, 0, 255);
+                        dstPtr[idx1 + 2] = (byte)Math.Clamp(r1, 0, 255);
+                    }
+                }
+            }
         }
-        catch (Exception ex)
+        finally
         {
-            _logger.LogDebug(ex, "Error encoding/sending frame");
+            bmp.UnlockBits(bmpData);
+        }
+
+        // Encode to JPEG
+        using var ms = new MemoryStream();
+        var jpegEncoder = ImageCodecInfo.GetImageEncoders()
+            .First(c => c.FormatID == ImageFormat.Jpeg.Guid);
+        var encoderParams = new EncoderParameters(1);
+        encoderParams.Param[0] = new EncoderParameter(System.Drawing.Imaging.Encoder.Quality, (long)JpegQuality);
+        bmp.Save(ms, jpegEncoder, encoderParams);
+        return ms.ToArray();
+    }
+
+    // Composite the lower third (if KEY is active) into the UYVY source. Rasterised with GDI+
+    // only when the text or position changes.
+    private void ApplyLowerThird(Span<byte> frame, int rowBytes)
+    {
+        var text = _overlayLowerThirdText;
+        if (!_overlayLowerThirdVisible || string.IsNullOrEmpty(text))
+            return;
+
+        float x = _overlayLowerThirdX, y = _overlayLowerThirdY;
+        var cached = _lowerThirdLayer;
+        if (cached == null || cached.Text != text || cached.X != x || cached.Y != y)
+        {
+            cached = new LowerThirdLayer(text, x, y, RenderLowerThird(text, x, y));
+            _lowerThirdLayer = cached;
+        }
+
+        var layer = cached.Layer;
+        if (layer != null &&
+            (long)(layer.Y + layer.Height - 1) * rowBytes + (layer.X + layer.Width) * layer.BytesPerPixel <= frame.Length)
+        {
+            layer.Apply(frame, rowBytes);
+        }
+    }
+
+    // Semi-transparent black box with white text, at (x, y) in 1920x1080 space
+    private OverlayLayer? RenderLowerThird(string text, float x, float y)
+    {
+        const float pad = 8;
+        using var font = new Font(_overlayFontFamily, _overlayFontSize, FontStyle.Bold);
+
+        SizeF textSize;
+        using (var probe = new Bitmap(1, 1))
+        using (var measure = Graphics.FromImage(probe))
+        {
+            textSize = measure.MeasureString(text, font);
+        }
+
+        int width = (int)Math.Ceiling(textSize.Width + 2 * pad);
+        int height = (int)Math.Ceiling(textSize.Height + 2 * pad);
+
+        using var bmp = new Bitmap(width, height, PixelFormat.Format32bppArgb);
+        using (var g = Graphics.FromImage(bmp))
+        {
+            g.TextRenderingHint = System.Drawing.Text.TextRenderingHint.AntiAlias;
+            g.SmoothingMode = System.Drawing.Drawing2D.SmoothingMode.AntiAlias;
+            g.Clear(Color.Transparent);
+
+            using var boxBrush = new SolidBrush(Color.FromArgb(153, 0, 0, 0));
+            g.FillRectangle(boxBrush, 0, 0, width, height);
+
+            using var textBrush = new SolidBrush(Color.White);
+            g.DrawString(text, font, textBrush, pad, pad);
+        }
+
+        // Format32bppArgb is straight-alpha BGRA in memory, as OverlayLayer expects
+        var pixels = new byte[width * height * 4];
+        var data = bmp.LockBits(new Rectangle(0, 0, width, height), ImageLockMode.ReadOnly, PixelFormat.Format32bppArgb);
+        try
+        {
+            for (int row = 0; row < height; row++)
+                Marshal.Copy(data.Scan0 + row * data.Stride, pixels, row * width * 4, width * 4);
         }
         finally
         {
-            _encoding = false;
+            bmp.UnlockBits(data);
         }
+
+        return OverlayLayer.Create(new OverlayImage(pixels, width, height),
+            (int)Math.Round(x - pad), (int)Math.Round(y - pad), 1.0, SourceMode);
+    }
+
+    private void DisposeEncoders()
+    {
+        _h264Encoder?.Dispose();
+        _h264Encoder = null;
+        _jpegEncoder?.Dispose();
+        _jpegEncoder = null;
     }
 
     public byte[] GenerateConnectionQrCode()
@@ -1074,7 +1347,7 @@ public sealed class WebRtcStreamingService : IStreamingService
             // 4. Handle ICE candidate exchange
 
             // For now, send a simple handshake
-            await SendJsonAsync(webSocket, new { type = "hello", viewerId, maxBitrate = _config?.Quality.MaxBitrateKbps }, ct);
+            await SendJsonAsync(viewer, new { type = "hello", viewerId, maxBitrate = _config?.Quality.MaxBitrateKbps }, ct);
 
             // Listen for messages
             var buffer = new byte[4096];
@@ -1129,6 +1402,26 @@ public sealed class WebRtcStreamingService : IStreamingService
                 case "ice-candidate":
                     _logger.LogDebug("Received ICE candidate from {ViewerId}", viewer.Id);
                     break;
+
+                case "codecs":
+                    // The viewer page offers H.264 when the browser has WebCodecs; JPEG otherwise
+                    bool h264 = doc.RootElement.TryGetProperty("h264", out var offered) &&
+                                offered.ValueKind == JsonValueKind.True;
+                    var quality = _config?.Quality;
+                    if (h264 && quality != null && CanStreamH264)
+                    {
+                        var (width, height, _) = PreviewSize(quality, native: true);
+                        await SendJsonAsync(viewer, new { type = "video", codec = H264CodecString(width, height), width, height }, ct);
+                        viewer.AwaitingKeyframe = true;
+                        viewer.UsesH264 = true;
+                        _keyframeRequested = true;
+                    }
+                    else
+                    {
+                        viewer.UsesH264 = false;
+                    }
+                    _logger.LogDebug("Viewer {ViewerId} receives {Codec}", viewer.Id, viewer.UsesH264 ? "H.264" : "JPEG");
+                    break;
             }
         }
         catch (Exception ex)
@@ -1137,11 +1430,11 @@ public sealed class WebRtcStreamingService : IStreamingService
         }
     }
 
-    private async Task SendJsonAsync(WebSocket webSocket, object message, CancellationToken ct)
+    private static async Task SendJsonAsync(ViewerSession viewer, object message, CancellationToken ct)
     {
         var json = JsonSerializer.Serialize(message);
         var bytes = Encoding.UTF8.GetBytes(json);
-        await webSocket.SendAsync(bytes, WebSocketMessageType.Text, true, ct);
+        await viewer.SendAsync(bytes, WebSocketMessageType.Text, ct);
     }
 
     private bool ValidateAccessToken(HttpListenerContext context)
@@ -1184,13 +1477,14 @@ public sealed class WebRtcStreamingService : IStreamingService
                 }
                 body.hide-ui { cursor: none; }
 
-                #frame {
+                #frame, #video {
                     width: 100vw;
                     height: 100vh;
                     object-fit: contain;
                     background: transparent;
                     display: block;
                 }
+                #frame[hidden], #video[hidden] { display: none; }
 
                 .overlay {
                     position: fixed;
@@ -1280,6 +1574,7 @@ public sealed class WebRtcStreamingService : IStreamingService
             </div>
 
             <img id="frame" alt="Stream"/>
+            <canvas id="video" hidden></canvas>
 
             <div id="info" class="overlay">
                 <div><span class="label">Resolution </span><span class="value" id="res">—</span></div>
@@ -1292,6 +1587,8 @@ public sealed class WebRtcStreamingService : IStreamingService
 
             <script>
                 const frame = document.getElementById('frame');
+                const video = document.getElementById('video');
+                const videoCtx = video.getContext('2d');
                 const dot = document.getElementById('dot');
                 const statusText = document.getElementById('statusText');
                 const resEl = document.getElementById('res');
@@ -1304,6 +1601,7 @@ public sealed class WebRtcStreamingService : IStreamingService
                 let ws, reconnectTimer, objectUrl = null;
                 let frameCount = 0, lastFpsTime = performance.now(), currentFps = 0;
                 let connectedTime = null, viewerId = null;
+                let decoder = null, awaitingKey = true;
                 let hideTimer = null;
 
                 // Auto-hide UI after 3s of inactivity
@@ -1325,6 +1623,7 @@ public sealed class WebRtcStreamingService : IStreamingService
                     }
                 }
                 frame.addEventListener('click', toggleFullscreen);
+                video.addEventListener('click', toggleFullscreen);
                 document.addEventListener('keydown', (e) => {
                     if (e.key === 'f' || e.key === 'F') toggleFullscreen();
                 });
@@ -1348,9 +1647,74 @@ public sealed class WebRtcStreamingService : IStreamingService
                 // Hide hint after 5s
                 setTimeout(() => { hintEl.style.opacity = '0'; }, 5000);
 
+                // H.264 through WebCodecs where the browser has it (secure contexts only);
+                // the server sends JPEG otherwise, and still may while switching over
+                const h264Probe = 'avc1.42E028';
+                async function offerCodecs() {
+                    let h264 = false;
+                    if ('VideoDecoder' in window) {
+                        try {
+                            h264 = (await VideoDecoder.isConfigSupported({ codec: h264Probe })).supported === true;
+                        } catch {}
+                    }
+                    if (ws.readyState === WebSocket.OPEN) ws.send(JSON.stringify({ type: 'codecs', h264 }));
+                }
+
+                function configureDecoder(msg) {
+                    if (decoder) { try { decoder.close(); } catch {} }
+                    awaitingKey = true;
+                    decoder = new VideoDecoder({
+                        output: (videoFrame) => {
+                            if (video.width !== videoFrame.displayWidth || video.height !== videoFrame.displayHeight) {
+                                video.width = videoFrame.displayWidth;
+                                video.height = videoFrame.displayHeight;
+                            }
+                            videoCtx.drawImage(videoFrame, 0, 0);
+                            videoFrame.close();
+                        },
+                        error: () => {
+                            decoder = null;
+                            if (ws.readyState === WebSocket.OPEN) ws.send(JSON.stringify({ type: 'codecs', h264: false }));
+                        }
+                    });
+                    decoder.configure({ codec: msg.codec, codedWidth: msg.width, codedHeight: msg.height, optimizeForLatency: true });
+                }
+
+                // Annex B: the first VCL NAL unit decides (5 = IDR slice)
+                function isKeyframe(bytes) {
+                    for (let i = 0; i + 3 < bytes.length; i++) {
+                        if (bytes[i] === 0 && bytes[i + 1] === 0 && bytes[i + 2] === 1) {
+                            const type = bytes[i + 3] & 0x1F;
+                            if (type === 5) return true;
+                            if (type === 1) return false;
+                        }
+                    }
+                    return false;
+                }
+
+                function showSurface(el, width, height) {
+                    frame.hidden = el !== frame;
+                    video.hidden = el !== video;
+                    if (width > 0) resEl.textContent = `${width} x ${height}`;
+
+                    if (dot.className !== 'status-dot live') {
+                        statusText.textContent = 'LIVE';
+                        dot.className = 'status-dot live';
+                    }
+
+                    frameCount++;
+                    const now = performance.now();
+                    if (now - lastFpsTime >= 1000) {
+                        currentFps = (frameCount * 1000 / (now - lastFpsTime)).toFixed(1);
+                        fpsEl.textContent = currentFps;
+                        frameCount = 0;
+                        lastFpsTime = now;
+                    }
+                }
+
                 function connect() {
                     ws = new WebSocket(wsUrl);
-                    ws.binaryType = 'blob';
+                    ws.binaryType = 'arraybuffer';
 
                     ws.onopen = () => {
                         statusText.textContent = 'Connected';
@@ -1359,6 +1723,7 @@ public sealed class WebRtcStreamingService : IStreamingService
                     };
 
                     ws.onclose = () => {
+                        if (decoder) { try { decoder.close(); } catch {} decoder = null; }
                         statusText.textContent = 'Reconnecting...';
                         dot.className = 'status-dot connecting';
                         reconnectTimer = setTimeout(connect, 3000);
@@ -1370,35 +1735,38 @@ public sealed class WebRtcStreamingService : IStreamingService
                     };
 
                     ws.onmessage = (e) => {
-                        if (e.data instanceof Blob) {
-                            if (objectUrl) URL.revokeObjectURL(objectUrl);
-                            objectUrl = URL.createObjectURL(e.data);
-                            frame.src = objectUrl;
-
-                            if (dot.className !== 'status-dot live') {
-                                statusText.textContent = 'LIVE';
-                                dot.className = 'status-dot live';
-                            }
-
-                            frameCount++;
-                            const now = performance.now();
-                            if (now - lastFpsTime >= 1000) {
-                                currentFps = (frameCount * 1000 / (now - lastFpsTime)).toFixed(1);
-                                fpsEl.textContent = currentFps;
-                                frameCount = 0;
-                                lastFpsTime = now;
+                        if (e.data instanceof ArrayBuffer) {
+                            const bytes = new Uint8Array(e.data);
+
+                            // JPEG (FF D8)
+                            if (bytes[0] === 0xFF && bytes[1] === 0xD8) {
+                                if (objectUrl) URL.revokeObjectURL(objectUrl);
+                                objectUrl = URL.createObjectURL(new Blob([bytes], { type: 'image/jpeg' }));
+                                frame.src = objectUrl;
+                                showSurface(frame, frame.naturalWidth, frame.naturalHeight);
+                                return;
                             }
 
-                            // Update resolution from image natural size
-                            if (frame.naturalWidth > 0) {
-                                resEl.textContent = `${frame.naturalWidth} x ${frame.naturalHeight}`;
-                            }
+                            // H.264 access unit
+                            if (!decoder || decoder.state !== 'configured') return;
+                            const key = isKeyframe(bytes);
+                            if (awaitingKey && !key) return;
+                            awaitingKey = false;
+                            decoder.decode(new EncodedVideoChunk({
+                                type: key ? 'key' : 'delta',
+                                timestamp: Math.round(performance.now() * 1000),
+                                data: bytes
+                            }));
+                            showSurface(video, video.width, video.height);
                         } else {
                             try {
                                 const msg = JSON.parse(e.data);
                                 if (msg.type === 'hello') {
                                     viewerId = msg.viewerId;
                                     viewerEl.textContent = msg.viewerId;
+                                    offerCodecs();
+                                } else if (msg.type === 'video') {
+                                    configureDecoder(msg);
                                 }
                             } catch {}
                         }
@@ -1492,6 +1860,15 @@ internal class ViewerSession
     public DateTimeOffset ConnectedAt { get; }
     public long FrameCount { get; set; }
 
+    /// <summary>Set once the viewer page decodes H.264 (WebCodecs); it gets JPEG otherwise.</summary>
+    public bool UsesH264 { get; set; }
+
+    /// <summary>An H.264 viewer is sent nothing until the next IDR frame.</summary>
+    public bool AwaitingKeyframe { get; set; }
+
+    // A WebSocket allows one send at a time; frames and signaling replies come from different tasks
+    private readonly SemaphoreSlim _sendLock = new(1, 1);
+
     public ViewerSession(string id, string remoteAddress, WebSocket webSocket)
     {
         Id = id;
@@ -1506,6 +1883,20 @@ internal class ViewerSession
         ConnectedAt,
         new StreamQualitySettings(1920, 1080, 30, 4000));
 
+    public async Task SendAsync(ReadOnlyMemory<byte> data, WebSocketMessageType type, CancellationToken ct)
+    {
+        await _sendLock.WaitAsync(ct);
+        try
+        {
+            if (WebSocket.State == WebSocketState.Open)
+                await WebSocket.SendAsync(data, type, true, ct);
+        }
+        finally
+        {
+            _sendLock.Release();
+        }
+    }
+
     public async Task DisconnectAsync()
     {
         if (WebSocket.State == WebSocketState.Open)
@@ -16,6 +16,7 @@ using Screener.Capture.Ndi;
 using Screener.Capture.Srt;
 using Screener.Capture.Virtual;
 using Screener.Clipping;
+using Screener.Core.Buffers;
 using Screener.Core.Capture;
 using Screener.Core.Output;
 using Screener.Encoding.Codecs;
@@ -25,6 +26,7 @@ using Screener.Scheduling;
 using Screener.Streaming;
 using Screener.Timecode;
 using Screener.Timecode.Providers;
+using Screener.UI.Overlays;
 using Screener.UI.ViewModels;
 using Screener.UI.Views;
 using Screener.Upload;
@@ -95,6 +97,9 @@ public partial class App : Application
             var db = _host.Services.GetRequiredService<DatabaseContext>();
             await db.InitializeAsync();
 
+            // Pick up uploads the last run left unfinished
+            await _host.Services.GetRequiredService<UploadService>().RestoreQueueAsync();
+
             // Initialize hardware detection
             var hwAccel = _host.Services.GetRequiredService<HardwareAccelerator>();
             _ = hwAccel.ProbeEncodersAsync();
@@ -152,7 +157,12 @@ public partial class App : Application
             }));
 
         // Encoding
-        services.AddTransient<IEncodingPipeline, EncodingPipeline>();
+        // In-process hardware encoder for H.264/HEVC, FFmpeg for the rest (chosen per session)
+        services.AddTransient<EncodingPipeline>();
+        services.AddTransient<NativeEncodingPipeline>();
+        services.AddSingleton<Func<EncodingPipeline>>(sp => () => sp.GetRequiredService<EncodingPipeline>());
+        services.AddSingleton<Func<NativeEncodingPipeline>>(sp => () => sp.GetRequiredService<NativeEncodingPipeline>());
+        services.AddTransient<IEncodingPipeline, AutoEncodingPipeline>();
         services.AddSingleton<Func<IEncodingPipeline>>(sp => () => sp.GetRequiredService<IEncodingPipeline>());
 
         // Timecode Providers
@@ -162,6 +172,8 @@ public partial class App : Application
         services.AddSingleton<ITimecodeService, TimecodeService>();
 
         // Recording
+        // Rolling MPEG-TS window per recording, so clips are cut from memory
+        services.AddSingleton<ReplayBufferRegistry>();
         services.AddSingleton<IRecordingService, RecordingService>();
         services.AddSingleton<FilenameGenerator>();
         services.AddSingleton<DriveManager>();
@@ -177,9 +189,13 @@ public partial class App : Application
         services.AddSingleton<SrtOutputService>();
         services.AddSingleton<IOutputService>(sp => sp.GetRequiredService<NdiOutputService>());
         services.AddSingleton<IOutputService>(sp => sp.GetRequiredService<SrtOutputService>());
+        // One encode per ladder rendition, muxed to every output routed to it
+        services.AddSingleton<IEncodeTee, EncodeTee>();
         services.AddSingleton<OutputManager>();
 
         // Upload Providers
+        // One budget shared by every provider and job
+        services.AddSingleton<BandwidthLimiter>();
         services.AddSingleton<ICloudStorageProvider, S3StorageProvider>();
         services.AddSingleton<ICloudStorageProvider, AzureBlobProvider>();
         services.AddSingleton<ICloudStorageProvider, Screener.Upload.Providers.DropboxProvider>();
@@ -189,8 +205,9 @@ public partial class App : Application
         services.AddSingleton<ICloudStorageProvider, Screener.Upload.Providers.FtpSftpProvider>();
         services.AddSingleton<ICloudStorageProvider, Screener.Upload.Providers.S3CompatibleProvider>();
         services.AddSingleton<CredentialStore>();
-        services.AddSingleton<IUploadService, UploadService>();
-        services.AddHostedService(sp => (UploadService)sp.GetRequiredService<IUploadService>());
+        services.AddSingleton<UploadService>();
+        services.AddSingleton<IUploadService>(sp => sp.GetRequiredService<UploadService>());
+        services.AddHostedService(sp => sp.GetRequiredService<UploadService>());
 
         // Scheduling
         services.AddSingleton<ISchedulingService, SchedulingService>();
@@ -204,6 +221,8 @@ public partial class App : Application
         services.AddSingleton<SessionRepository>();
         services.AddSingleton<OverlayRepository>();
         services.AddSingleton<OverlayCompositor>();
+        services.AddSingleton<IOverlayRasterizer, WpfOverlayRasterizer>();
+        services.AddSingleton<LiveOverlayCompositor>();
         services.AddSingleton<ClipExportService>();
         services.AddSingleton<TransitionEngine>();
 
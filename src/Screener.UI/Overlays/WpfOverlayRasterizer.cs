@@ -0,0 +1,121 @@
+using System.Globalization;
+using System.Windows;
+using System.Windows.Media;
+using System.Windows.Media.Imaging;
+using Screener.Golf.Overlays;
+
+namespace Screener.UI.Overlays;
+
+/// <summary>
+/// Renders overlay configurations with WPF imaging and text layout for live compositing.
+/// Rendering happens at 96 DPI so one DIP is one video pixel, matching ffmpeg's pixel units.
+/// </summary>
+public sealed class WpfOverlayRasterizer : IOverlayRasterizer
+{
+    public OverlayImage? RenderLogo(LogoBugConfig config)
+    {
+        if (string.IsNullOrEmpty(config.LogoPath) || !System.IO.File.Exists(config.LogoPath))
+            return null;
+
+        return OnUiThread(() =>
+        {
+            var bitmap = new BitmapImage();
+            bitmap.BeginInit();
+            bitmap.UriSource = new Uri(config.LogoPath);
+            bitmap.CacheOption = BitmapCacheOption.OnLoad;
+            bitmap.EndInit();
+            bitmap.Freeze();
+
+            BitmapSource source = bitmap;
+            double scale = Math.Clamp(config.Scale, 0.1, 2.0);
+            if (scale != 1.0)
+                source = new TransformedBitmap(source, new ScaleTransform(scale, scale));
+
+            return ToOverlayImage(source);
+        });
+    }
+
+    public OverlayImage? RenderLowerThird(LowerThirdConfig config, string golferName)
+    {
+        if (string.IsNullOrEmpty(golferName))
+            return null;
+
+        return OnUiThread(() =>
+        {
+            var text = new FormattedText(
+                golferName,
+                CultureInfo.InvariantCulture,
+                FlowDirection.LeftToRight,
+                new Typeface(string.IsNullOrEmpty(config.FontFamily) ? "Arial" : config.FontFamily),
+                config.FontSize,
+                new SolidColorBrush(ParseColor(config.FontColor, Colors.White)),
+                pixelsPerDip: 1.0);
+
+            int pad = config.ShowBox ? config.BoxPadding : 0;
+            int width = (int)Math.Ceiling(text.WidthIncludingTrailingWhitespace) + pad * 2;
+            int height = (int)Math.Ceiling(text.Height) + pad * 2;
+            if (width <= 0 || height <= 0)
+                return null;
+
+            var visual = new DrawingVisual();
+            using (var dc = visual.RenderOpen())
+            {
+                if (config.ShowBox)
+                    dc.DrawRectangle(new SolidColorBrush(ParseColor(config.BoxColor, Color.FromArgb(153, 0, 0, 0))), null,
+                        new Rect(0, 0, width, height));
+                dc.DrawText(text, new Point(pad, pad));
+            }
+
+            var target = new RenderTargetBitmap(width, height, 96, 96, PixelFormats.Pbgra32);
+            target.Render(visual);
+            target.Freeze();
+            return ToOverlayImage(target);
+        });
+    }
+
+    /// <summary>
+    /// Parse an ffmpeg color ("white", "0xFFFFFF", "black@0.6").
+    /// </summary>
+    internal static Color ParseColor(string? value, Color fallback)
+    {
+        if (string.IsNullOrWhiteSpace(value))
+            return fallback;
+
+        var parts = value.Split('@', 2);
+        var name = parts[0].Trim();
+        if (name.StartsWith("0x", StringComparison.OrdinalIgnoreCase))
+            name = "#" + name[2..];
+
+        Color color;
+        try
+        {
+            color = (Color)ColorConverter.ConvertFromString(name);
+        }
+        catch (Exception ex) when (ex is FormatException or NotSupportedException)
+        {
+            return fallback;
+        }
+
+        if (parts.Length == 2 && double.TryParse(parts[1], NumberStyles.Float, CultureInfo.InvariantCulture, out var alpha))
+            color.A = (byte)Math.Round(Math.Clamp(alpha, 0.0, 1.0) * 255);
+
+        return color;
+    }
+
+    // Straight-alpha BGRA, as OverlayLayer premultiplies itself
+    private static OverlayImage ToOverlayImage(BitmapSource source)
+    {
+        var bgra = new FormatConvertedBitmap(source, PixelFormats.Bgra32, null, 0);
+        int width = bgra.PixelWidth;
+        int height = bgra.PixelHeight;
+        var pixels = new byte[width * height * 4];
+        bgra.CopyPixels(pixels, width * 4, 0);
+        return new OverlayImage(pixels, width, height);
+    }
+
+    private static T OnUiThread<T>(Func<T> render)
+    {
+        var dispatcher = Application.Current?.Dispatcher;
+        return dispatcher == null || dispatcher.CheckAccess() ? render() : dispatcher.Invoke(render);
+    }
+}
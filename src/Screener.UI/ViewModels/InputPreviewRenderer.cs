@@ -1,16 +1,18 @@
-using System.Runtime.InteropServices;
 using System.Threading;
 using System.Windows;
 using System.Windows.Media;
 using System.Windows.Media.Imaging;
 using Screener.Abstractions.Capture;
+using Screener.Core.Native;
 using Screener.Core.Output;
+using CapturePixelFormat = Screener.Abstractions.Capture.PixelFormat;
 
 namespace Screener.UI.ViewModels;
 
 /// <summary>
 /// Lightweight per-input frame renderer. Subscribes to a capture device's video frames
-/// and produces a WriteableBitmap preview at half or quarter resolution.
+/// and produces a WriteableBitmap preview at half or quarter resolution, from the device's
+/// box-filtered preview pyramid when it builds one and by subsampling the frame otherwise.
 /// Reuses the static YUV->RGB lookup tables from YuvConversion.
 /// </summary>
 public class InputPreviewRenderer : IDisposable
@@ -35,15 +37,19 @@ public class InputPreviewRenderer : IDisposable
     // Frame rate limiting
     private long _callbackCount;
 
-    // Resolution divisor (2 = half 960x540, 4 = quarter 480x270)
+    // Resolution divisor (2 = half 960x540, 4 = quarter 480x270), and the device's
+    // pyramid level at that size (frames built by the capture layer, once per device)
     private int _resDivisor = 2;
+    private IDisposable? _previewLevelSubscription;
 
     // Output
     private OutputManager? _outputManager;
     private bool _isSelectedForStreaming;
 
     // Golf auto-cut frame analysis callback
-    private Action<ReadOnlyMemory<byte>, int, int>? _frameAnalysisCallback;
+    private Action<ReadOnlyMemory<byte>, int, int, CapturePixelFormat, LumaPlane?>? _frameAnalysisCallback;
+    private int _analysisLumaWidth;
+    private int _analysisLumaHeight;
 
     // BGRA frame callback for TransitionEngine
     private Action<byte[], int, int>? _bgraFrameCallback;
@@ -71,12 +77,18 @@ public class InputPreviewRenderer : IDisposable
     }
 
     /// <summary>
-    /// Set a callback that receives raw UYVY frame data for analysis (e.g., auto-cut detection).
-    /// The callback receives (frameData, width, height).
+    /// Set a callback that receives raw UYVY or v210 frame data for analysis (e.g., auto-cut detection).
+    /// The callback receives (frameData, width, height, pixelFormat, analysisLuma). With a luma size,
+    /// the device is asked to sample a luma plane of that size during its frame copy; analysisLuma
+    /// is null when it could not.
     /// </summary>
-    public void SetFrameAnalysisCallback(Action<ReadOnlyMemory<byte>, int, int>? callback)
+    public void SetFrameAnalysisCallback(Action<ReadOnlyMemory<byte>, int, int, CapturePixelFormat, LumaPlane?>? callback,
+        int lumaWidth = 0, int lumaHeight = 0)
     {
         _frameAnalysisCallback = callback;
+        _analysisLumaWidth = callback != null ? lumaWidth : 0;
+        _analysisLumaHeight = callback != null ? lumaHeight : 0;
+        _device?.SetAnalysisLumaSize(_analysisLumaWidth, _analysisLumaHeight);
     }
 
     /// <summary>
@@ -107,6 +119,8 @@ public class InputPreviewRenderer : IDisposable
         if (_device == null) return;
 
         _device.SelectedConnector = connector;
+        _device.SetAnalysisLumaSize(_analysisLumaWidth, _analysisLumaHeight);
+        _previewLevelSubscription = _device.SubscribePreviewLevel(_resDivisor);
         _device.VideoFrameReceived += OnVideoFrameReceived;
         _device.StatusChanged += OnStatusChanged;
 
@@ -130,6 +144,9 @@ public class InputPreviewRenderer : IDisposable
         {
             _device.VideoFrameReceived -= OnVideoFrameReceived;
             _device.StatusChanged -= OnStatusChanged;
+            _device.SetAnalysisLumaSize(0, 0);
+            _previewLevelSubscription?.Dispose();
+            _previewLevelSubscription = null;
             await _device.StopCaptureAsync();
             _device = null;
         }
@@ -199,15 +216,17 @@ public class InputPreviewRenderer : IDisposable
         // Push frames to all outputs (~15fps = every 4th callback from 60fps source)
         if (_isSelectedForStreaming && _outputManager != null && _callbackCount % 4 == 0)
         {
-            _ = _outputManager.PushFrameToAllAsync(e.FrameData, e.Mode, e.Timestamp);
+            // The push can restart the tee; never let it read a frame it could not lease
+            var hold = e.Retain(out var frame);
+            _ = PushFrameToOutputsAsync(frame, e.Mode, e.Timestamp, hold);
         }
 
-        // Golf auto-cut frame analysis hook (~15fps = every 4th callback)
-        if (_frameAnalysisCallback != null && _callbackCount % 4 == 0)
+        // Golf auto-cut frame analysis hook: every frame, AutoCutService applies FrameSkip
+        if (_frameAnalysisCallback != null)
         {
             try
             {
-                _frameAnalysisCallback(e.FrameData, e.Mode.Width, e.Mode.Height);
+                _frameAnalysisCallback(e.FrameData, e.Mode.Width, e.Mode.Height, e.Mode.PixelFormat, e.AnalysisLuma);
             }
             catch
             {
@@ -232,20 +251,16 @@ public class InputPreviewRenderer : IDisposable
 
             // Reinitialize if format changed
             if (e.Mode.Width / _resDivisor != _previewWidth || e.Mode.Height / _resDivisor != _previewHeight)
-            {
-                YuvConversion.ResetVancDetection();
                 InitializePreviewBitmap(e.Mode.Width, e.Mode.Height);
-            }
 
+            bool isV210 = e.Mode.PixelFormat == CapturePixelFormat.YUV422_10bit;
             int srcRowBytes = e.FrameData.Length / e.Mode.Height;
-            if (srcRowBytes < e.Mode.Width * 2) return;
+            if (srcRowBytes < (isV210 ? MediaKernels.V210RowBytes(e.Mode.Width) : e.Mode.Width * 2)) return;
 
-            if (!MemoryMarshal.TryGetArray(e.FrameData, out var segment) || segment.Array == null)
-                return;
-            var frameBytes = segment.Array;
-
-            // Ensure VANC geometry is detected (shared static state)
-            YuvConversion.EnsureVancDetected(frameBytes, srcRowBytes, e.Mode.Height);
+            // A pyramid level is already filtered down to the preview size. NDI frames are
+            // the SDK's native buffers, so the frame is read as memory rather than an array.
+            var level = e.Pyramid?.GetLevel(_resDivisor);
+            var frameData = e.FrameData;
 
             int prevW = _previewWidth;
             int prevH = _previewHeight;
@@ -256,6 +271,11 @@ public class InputPreviewRenderer : IDisposable
             if (_rgbBufferB == null || _rgbBufferB.Length != rgbSize)
                 _rgbBufferB = new byte[rgbSize];
 
+            // Hold the capture slot while the conversion reads it on the thread pool
+            var lease = e.TryLease();
+            if (lease == null && e.LeaseSource != null)
+                return;
+
             _conversionInProgress = true;
             var rgbArray = _currentRgbBuffer == 0 ? _rgbBufferA : _rgbBufferB;
             _currentRgbBuffer = 1 - _currentRgbBuffer;
@@ -269,19 +289,14 @@ public class InputPreviewRenderer : IDisposable
             {
                 try
                 {
-                    ConvertYuv422Scaled(frameBytes, rgbArray, frameWidth, frameHeight,
-                        prevW, prevH, localSrcRowBytes, localDiv);
-
-                    // Clear bottom rows if effectiveHeight < dstHeight due to VANC
-                    int vancRows = Math.Max(0, YuvConversion.DetectedVancRows);
-                    int effectiveHeight = Math.Min(prevH, (frameHeight - vancRows) / localDiv);
-                    if (effectiveHeight < prevH)
-                    {
-                        int clearStart = effectiveHeight * prevW * 4;
-                        int clearEnd = prevH * prevW * 4;
-                        if (clearStart < clearEnd)
-                            Array.Clear(rgbArray, clearStart, clearEnd - clearStart);
-                    }
+                    if (level != null)
+                        ConvertPyramidLevel(level, rgbArray, prevW, prevH, frameHeight);
+                    else if (isV210)
+                        ConvertV210Scaled(frameData, rgbArray, frameWidth, frameHeight,
+                            prevW, prevH, localSrcRowBytes, localDiv);
+                    else
+                        ConvertYuv422Scaled(frameData, rgbArray, frameWidth, frameHeight,
+                            prevW, prevH, localSrcRowBytes, localDiv);
 
                     _conversionInProgress = false;
 
@@ -297,6 +312,10 @@ public class InputPreviewRenderer : IDisposable
                 {
                     _conversionInProgress = false;
                 }
+                finally
+                {
+                    lease?.Dispose();
+                }
             });
         }
         catch
@@ -305,33 +324,94 @@ public class InputPreviewRenderer : IDisposable
         }
     }
 
+    private async Task PushFrameToOutputsAsync(ReadOnlyMemory<byte> frame, VideoMode mode, TimeSpan timestamp, IDisposable? hold)
+    {
+        try
+        {
+            await _outputManager!.PushFrameToAllAsync(frame, mode, timestamp);
+        }
+        catch
+        {
+            // Output errors are logged by OutputManager
+        }
+        finally
+        {
+            hold?.Dispose();
+        }
+    }
+
     private void OnStatusChanged(object? sender, DeviceStatusChangedEventArgs e)
     {
         if (e.NewStatus == DeviceStatus.Error || e.NewStatus == DeviceStatus.Disconnected)
             _input.HasSignal = false;
     }
 
+    /// <summary>
+    /// Convert a UYVY preview pyramid level to BGRA one to one. Levels round odd widths down
+    /// to a pixel pair, so the last preview column may be left as it was.
+    /// </summary>
+    internal static void ConvertPyramidLevel(VideoFrame level, byte[] rgb, int dstWidth, int dstHeight, int srcHeight)
+    {
+        int outWidth = Math.Min(dstWidth, level.Width) & ~1;
+        int outHeight = Math.Min(dstHeight, level.Height);
+        if (outWidth < 2 || outHeight <= 0) return;
+
+        MediaKernels.ConvertUyvyToBgra(level.Data.Span, level.RowBytes, rgb, dstWidth * 4, outWidth, outHeight,
+            ColorMatrixExtensions.ForHeight(srcHeight));
+    }
+
+    /// <summary>
+    /// Convert v210 to BGRA at 1/divisor resolution (divisor 2 or 4).
+    /// Any pitch beyond the padded v210 row is treated as HANC and skipped.
+    /// </summary>
+    internal static void ConvertV210Scaled(ReadOnlyMemory<byte> v210, byte[] rgb,
+        int srcWidth, int srcHeight, int dstWidth, int dstHeight,
+        int srcRowBytes, int divisor)
+    {
+        if (divisor is not (2 or 4)) return;
+
+        int hancBytes = srcRowBytes - MediaKernels.V210RowBytes(srcWidth);
+        int outWidth = Math.Min(dstWidth, srcWidth / divisor) & ~1;
+        int outHeight = Math.Min(dstHeight, srcHeight / divisor);
+        if (hancBytes < 0 || outWidth < 2 || outHeight <= 0) return;
+
+        MediaKernels.ConvertV210ToBgraScaled(
+            v210.Span.Slice(hancBytes), srcRowBytes, rgb, dstWidth * 4, outWidth, outHeight, divisor,
+            ColorMatrixExtensions.ForHeight(srcHeight));
+    }
+
     /// <summary>
     /// Convert UYVY to BGRA at 1/divisor resolution.
     /// divisor=2: half-res (960x540), divisor=4: quarter-res (480x270).
-    /// Reuses the static YUV->RGB lookup tables from YuvConversion.
+    /// Uses the native SIMD converter when available; otherwise falls back to the
+    /// static BT.601 lookup tables from YuvConversion.
+    /// DeckLink frames arrive with VANC/HANC already cropped by the native copy.
     /// </summary>
-    internal static void ConvertYuv422Scaled(byte[] yuv, byte[] rgb,
+    internal static void ConvertYuv422Scaled(ReadOnlyMemory<byte> yuv, byte[] rgb,
         int srcWidth, int srcHeight, int dstWidth, int dstHeight,
         int srcRowBytes, int divisor)
     {
         int destRowBytes = dstWidth * 4;
-        int vancRows = Math.Max(0, YuvConversion.DetectedVancRows);
-        int hancBytes = YuvConversion.DetectedHancBytes;
-        int effectiveHeight = Math.Min(dstHeight, (srcHeight - vancRows) / divisor);
+        int effectiveHeight = Math.Min(dstHeight, srcHeight / divisor);
 
         // Bytes per dest pixel pair in source: divisor UYVY groups x 4 bytes each
         int srcBytesPerDstPair = divisor * 4;
         // Y1 sample offset: pick Y from the group at divisor/2
         int y1Offset = (divisor / 2) * 4 + 1;
 
-        int availableSrcBytes = srcRowBytes - hancBytes;
-        int maxDstPairs = Math.Min(dstWidth / 2, Math.Max(0, (availableSrcBytes - y1Offset - 1) / srcBytesPerDstPair));
+        int maxDstPairs = Math.Min(dstWidth / 2, Math.Max(0, (srcRowBytes - y1Offset - 1) / srcBytesPerDstPair));
+
+        if (MediaKernels.IsAvailable && (divisor == 2 || divisor == 4))
+        {
+            if (effectiveHeight > 0 && maxDstPairs > 0)
+            {
+                MediaKernels.ConvertUyvyToBgraScaled(
+                    yuv.Span, srcRowBytes,
+                    rgb, destRowBytes, maxDstPairs * 2, effectiveHeight, divisor,
+                    ColorMatrixExtensions.ForHeight(srcHeight));
+            }
+            return;
+        }
 
         // Cache table references for inner loop performance
         var ytoc = YuvConversion.YtoC;
@@ -344,9 +424,9 @@ public class InputPreviewRenderer : IDisposable
 
         Parallel.For(0, effectiveHeight, dstRow =>
         {
+            var src = yuv.Span;
             int rgbRowStart = dstRow * destRowBytes;
-            int srcRow = (dstRow * divisor) + vancRows;
-            int yuvRowStart = srcRow * srcRowBytes + hancBytes;
+            int yuvRowStart = dstRow * divisor * srcRowBytes;
             int rgbIndex = rgbRowStart;
 
             for (int dstPair = 0; dstPair < maxDstPairs; dstPair++)
@@ -354,10 +434,10 @@ public class InputPreviewRenderer : IDisposable
                 int yuvIndex = yuvRowStart + dstPair * srcBytesPerDstPair;
 
                 // UYVY format: U Y V Y
-                int u = yuv[yuvIndex];
-                int y0 = yuv[yuvIndex + 1];
-                int v = yuv[yuvIndex + 2];
-                int y1 = yuv[yuvIndex + y1Offset];
+                int u = src[yuvIndex];
+                int y0 = src[yuvIndex + 1];
+                int v = src[yuvIndex + 2];
+                int y1 = src[yuvIndex + y1Offset];
 
                 int c0 = ytoc[y0];
                 int c1 = ytoc[y1];
@@ -21,11 +21,13 @@ using Screener.Core.Settings;
 using Screener.Golf.Detection;
 using Screener.Golf.Export;
 using Screener.Golf.Models;
+using Screener.Golf.Overlays;
 using Screener.Golf.Persistence;
 using Screener.Golf.Switching;
 using Screener.Preview;
 using Screener.Scheduling;
 using Screener.Streaming;
+using Screener.Capture.Blackmagic;
 using Screener.Capture.Virtual;
 using Screener.UI.Views;
 
@@ -568,6 +570,11 @@ public partial class MainViewModel : ObservableObject
             _previewRenderers.Clear();
             EnabledInputs.Clear();
 
+            // DeckLink bit depth is read when each input starts, so apply it before restarting
+            var settings = await _settingsService.GetSettingsAsync();
+            if (_serviceProvider.GetService<DeckLinkDeviceManager>() is { } deckLinkManager)
+                deckLinkManager.TenBitCapture = settings.EnableTenBitCapture;
+
             var enabled = InputConfiguration.Inputs.Where(i => i.IsEnabled).ToList();
             if (enabled.Count == 0)
             {
@@ -972,12 +979,16 @@ public partial class MainViewModel : ObservableObject
                 return;
             }
 
+            enabledInputs = await AttachLiveOverlaysAsync(enabledInputs);
+            var settings = await _settingsService.GetSettingsAsync();
+
             var options = new RecordingOptions(
                 OutputDirectory: outputDir,
                 FilenameTemplate: filenameTemplate,
                 Preset: SelectedPreset,
                 Name: string.IsNullOrWhiteSpace(RecordingName) ? null : RecordingName,
-                Inputs: enabledInputs);
+                Inputs: enabledInputs,
+                RawIsoInputs: settings.RecordRawIsos);
 
             _logger.LogInformation("Starting recording with {InputCount} input(s)", enabledInputs.Count);
             await _recordingService.StartRecordingAsync(options);
@@ -990,6 +1001,36 @@ public partial class MainViewModel : ObservableObject
         }
     }
 
+    /// <summary>
+    /// Burn the logo bug and lower third into the simulator feed as it is recorded, so swing
+    /// clips need no overlay re-encode on export.
+    /// </summary>
+    private async Task<List<Abstractions.Recording.InputConfiguration>> AttachLiveOverlaysAsync(
+        List<Abstractions.Recording.InputConfiguration> inputs)
+    {
+        var simInput = InputConfiguration.GetInputByGolfRole(InputRole.SimulatorOutput);
+        if (simInput == null || _serviceProvider.GetService<LiveOverlayCompositor>() is not { } liveOverlays)
+            return inputs;
+
+        try
+        {
+            await liveOverlays.RefreshAsync();
+        }
+        catch (Exception ex)
+        {
+            _logger.LogWarning(ex, "Failed to load live overlays; recording the simulator feed clean");
+            return inputs;
+        }
+
+        // An empty compositor would only cost a frame copy each; exports add the overlays instead
+        if (!liveOverlays.HasContent)
+            return inputs;
+
+        return inputs
+            .Select(i => i.DeviceId == simInput.DeviceId ? i with { Overlay = liveOverlays } : i)
+            .ToList();
+    }
+
     [RelayCommand]
     private async Task StopRecordingAsync()
     {
@@ -1193,7 +1234,8 @@ public partial class MainViewModel : ObservableObject
                     Preset: schedule.Preset,
                     Name: schedule.Name,
                     MaxDuration: schedule.Duration,
-                    Inputs: inputs);
+                    Inputs: inputs,
+                    RawIsoInputs: (await _settingsService.GetSettingsAsync()).RecordRawIsos);
 
                 await _recordingService.StartRecordingAsync(options);
 
@@ -1747,17 +1789,28 @@ public partial class MainViewModel : ObservableObject
             if (srtOutput == null) return;
 
             var settings = await _settingsService.GetSettingsAsync();
-            var config = new OutputConfiguration(
-                "SRT Output",
-                1920, 1080, 29.97,
-                new Dictionary<string, string>
-                {
-                    ["mode"] = settings.SrtOutputMode,
-                    ["address"] = settings.SrtOutputAddress,
-                    ["port"] = settings.SrtOutputPort.ToString(),
-                    ["latency"] = settings.SrtOutputLatency.ToString(),
-                    ["bitrate"] = settings.SrtOutputBitrate.ToString()
-                });
+            var parameters = new Dictionary<string, string>
+            {
+                ["mode"] = settings.SrtOutputMode,
+                ["address"] = settings.SrtOutputAddress,
+                ["port"] = settings.SrtOutputPort.ToString(),
+                ["latency"] = settings.SrtOutputLatency.ToString(),
+                ["bitrate"] = settings.SrtOutputBitrate.ToString()
+            };
+
+            // Share an encode ladder rendition with the other tee'd outputs instead of encoding separately
+            var ladder = EncodeRendition.ParseLadder(settings.EncodeLadderJson);
+            _outputManager.EncodeLadder = ladder;
+            if (!string.IsNullOrEmpty(settings.SrtOutputRendition))
+            {
+                if (ladder.Any(r => r.Name.Equals(settings.SrtOutputRendition, StringComparison.OrdinalIgnoreCase)))
+                    parameters["rendition"] = settings.SrtOutputRendition;
+                else
+                    _logger.LogWarning("SRT output rendition {Rendition} is not in the encode ladder; encoding separately",
+                        settings.SrtOutputRendition);
+            }
+
+            var config = new OutputConfiguration("SRT Output", 1920, 1080, 29.97, parameters);
 
             await srtOutput.StartAsync(config);
             SrtOutputStatus = $"SRT: {settings.SrtOutputMode} {settings.SrtOutputAddress}:{settings.SrtOutputPort}";
@@ -1913,15 +1966,16 @@ public partial class MainViewModel : ObservableObject
             var src1Path = golferInput != null
                 ? inputSessions.FirstOrDefault(s => s.Input.DeviceId == golferInput.DeviceId)?.FilePath
                 : null;
-            var src2Path = simInput != null
-                ? inputSessions.FirstOrDefault(s => s.Input.DeviceId == simInput.DeviceId)?.FilePath
+            var src2Session = simInput != null
+                ? inputSessions.FirstOrDefault(s => s.Input.DeviceId == simInput.DeviceId)
                 : null;
+            var src2Path = src2Session?.FilePath;
 
             // Fallback to single-session path if no multi-input sessions
             if (src2Path == null && inputSessions.Count == 0)
                 src2Path = _recordingService.CurrentSession.FilePath;
 
-            _golfSession.SetRecordingPaths(src1Path, src2Path);
+            _golfSession.SetRecordingPaths(src1Path, src2Path, src2Session?.HasOverlay == true);
         }
 
         IsSessionActive = true;
@@ -1984,15 +2038,18 @@ public partial class MainViewModel : ObservableObject
         var golferInput = InputConfiguration.GetInputByGolfRole(InputRole.GolferCamera);
         var simInput = InputConfiguration.GetInputByGolfRole(InputRole.SimulatorOutput);
 
+        // Capture devices sample the detectors' luma plane during the frame copy
+        var analysisConfig = _autoCutService.Configuration;
+
         if (golferInput?.PreviewRenderer != null)
         {
-            golferInput.PreviewRenderer.SetFrameAnalysisCallback((data, w, h) =>
+            golferInput.PreviewRenderer.SetFrameAnalysisCallback((data, w, h, format, luma) =>
             {
-                _autoCutService.ProcessSource1Frame(data, w, h);
+                _autoCutService.ProcessSource1Frame(data, w, h, format, luma);
                 // Update motion level for diagnostic display
                 Application.Current?.Dispatcher.BeginInvoke(() =>
                     MotionLevel = _autoCutService.SwingDetector.LastSad);
-            });
+            }, analysisConfig.AnalysisWidth, analysisConfig.AnalysisHeight);
 
             // Wire BGRA callback for TransitionEngine (golfer = slot 0)
             golferInput.PreviewRenderer.SetBgraFrameCallback((bgra, w, h) =>
@@ -2022,18 +2079,18 @@ public partial class MainViewModel : ObservableObject
 
         if (simInput?.PreviewRenderer != null)
         {
-            simInput.PreviewRenderer.SetFrameAnalysisCallback((data, w, h) =>
+            simInput.PreviewRenderer.SetFrameAnalysisCallback((data, w, h, format, luma) =>
             {
                 // Handle calibration
                 if (_calibrateOnNextFrame)
                 {
                     _calibrateOnNextFrame = false;
-                    _autoCutService.CalibrateIdleReference(data, w, h);
+                    _autoCutService.CalibrateIdleReference(data, w, h, format, luma);
                     Application.Current?.Dispatcher.BeginInvoke(() => IsIdleCalibrated = true);
                 }
 
-                _autoCutService.ProcessSource2Frame(data, w, h);
-            });
+                _autoCutService.ProcessSource2Frame(data, w, h, format, luma);
+            }, analysisConfig.AnalysisWidth, analysisConfig.AnalysisHeight);
 
             // Wire BGRA callback for TransitionEngine (simulator = slot 1)
             simInput.PreviewRenderer.SetBgraFrameCallback((bgra, w, h) =>
@@ -2227,17 +2284,6 @@ public partial class MainViewModel : ObservableObject
                     CreatedAt = DateTime.Now
                 });
             }
-
-            // Auto-upload completed export
-            if (e.Success && AutoUploadEnabled && SelectedUploadProviderId != null && e.OutputPath != null)
-            {
-                var remotePath = $"golf/{System.IO.Path.GetFileName(e.OutputPath)}";
-                _ = _uploadService.EnqueueAsync(new UploadRequest(
-                    e.OutputPath,
-                    SelectedUploadProviderId,
-                    remotePath));
-                _logger.LogInformation("Auto-upload enqueued for {Path}", e.OutputPath);
-            }
         });
     }
 
@@ -2282,6 +2328,12 @@ public partial class MainViewModel : ObservableObject
             AutoUploadEnabled = await _settingsService.GetAsync(SettingsKeys.GolfAutoUpload, false);
             SelectedUploadProviderId = await _settingsService.GetAsync<string?>(SettingsKeys.GolfAutoUploadProvider, null);
 
+            _clipExportService.Renditions = await _settingsService.GetAsync(SettingsKeys.GolfExportRenditions, ClipRenditions.None);
+            _clipExportService.VideoEncoder =
+                await _settingsService.GetAsync<string?>(SettingsKeys.GolfExportEncoder, null) ?? "libx264";
+            _clipExportService.MaxConcurrentEncodes =
+                await _settingsService.GetAsync<int?>(SettingsKeys.GolfExportMaxConcurrent, null) ?? 2;
+
             AvailableUploadProviders.Clear();
             foreach (var provider in _uploadService.GetProviders().Where(p => p.IsConfigured))
             {
@@ -2301,12 +2353,19 @@ public partial class MainViewModel : ObservableObject
     partial void OnAutoUploadEnabledChanged(bool value)
     {
         _ = _settingsService.SetAsync(SettingsKeys.GolfAutoUpload, value);
+        UpdateExportUploadProvider();
     }
 
     partial void OnSelectedUploadProviderIdChanged(string? value)
     {
         if (value != null)
             _ = _settingsService.SetAsync(SettingsKeys.GolfAutoUploadProvider, value);
+        UpdateExportUploadProvider();
+    }
+
+    private void UpdateExportUploadProvider()
+    {
+        _clipExportService.UploadProviderId = AutoUploadEnabled ? SelectedUploadProviderId : null;
     }
 
     [RelayCommand]
@@ -60,6 +60,12 @@ public partial class SettingsViewModel : ObservableObject
     [ObservableProperty]
     private bool _preferHardwareEncoding = true;
 
+    [ObservableProperty]
+    private bool _enableTenBitCapture;
+
+    [ObservableProperty]
+    private bool _recordRawIsos;
+
     // Audio Settings
     [ObservableProperty]
     private ObservableCollection<string> _audioChannelOptions = new() { "2 (Stereo)", "4", "8", "16" };
@@ -180,6 +186,12 @@ public partial class SettingsViewModel : ObservableObject
     [ObservableProperty]
     private int _srtOutputBitrate = 5000;
 
+    [ObservableProperty]
+    private string _srtOutputRendition = string.Empty;
+
+    // Encode ladder has no editor yet; kept so saving other settings does not reset it
+    private string _encodeLadderJson = AppSettings.DefaultEncodeLadderJson;
+
     // Cloud Storage Settings
     [ObservableProperty]
     private ObservableCollection<CloudProviderInfo> _cloudProviders = new();
@@ -251,6 +263,8 @@ public partial class SettingsViewModel : ObservableObject
 
             DefaultRecordingPath = settings.DefaultRecordingPath;
             PreferHardwareEncoding = settings.PreferHardwareEncoding;
+            EnableTenBitCapture = settings.EnableTenBitCapture;
+            RecordRawIsos = settings.RecordRawIsos;
 
             // Streaming
             EnableStreaming = settings.EnableStreaming;
@@ -273,6 +287,8 @@ public partial class SettingsViewModel : ObservableObject
             SrtOutputPort = settings.SrtOutputPort;
             SrtOutputLatency = settings.SrtOutputLatency;
             SrtOutputBitrate = settings.SrtOutputBitrate;
+            SrtOutputRendition = settings.SrtOutputRendition;
+            _encodeLadderJson = settings.EncodeLadderJson;
 
             // SRT Inputs
             try
@@ -490,6 +506,8 @@ public partial class SettingsViewModel : ObservableObject
         DefaultRecordingPath = Environment.GetFolderPath(Environment.SpecialFolder.MyVideos);
         FilenameTemplate = "{date}_{time}_{device}_{preset}";
         PreferHardwareEncoding = true;
+        EnableTenBitCapture = false;
+        RecordRawIsos = false;
         EnableAudioPreview = true;
         UseNtpTime = true;
         NtpServer = "pool.ntp.org";
@@ -510,6 +528,8 @@ public partial class SettingsViewModel : ObservableObject
         SrtOutputPort = 9000;
         SrtOutputLatency = 120;
         SrtOutputBitrate = 5000;
+        SrtOutputRendition = string.Empty;
+        _encodeLadderJson = AppSettings.DefaultEncodeLadderJson;
         SrtInputs.Clear();
 
         _logger.LogInformation("Settings reset to defaults");
@@ -554,6 +574,8 @@ public partial class SettingsViewModel : ObservableObject
                 SelectedConnector = SelectedInput?.Connector ?? VideoConnector.SDI,
                 DefaultRecordingPath = DefaultRecordingPath,
                 PreferHardwareEncoding = PreferHardwareEncoding,
+                EnableTenBitCapture = EnableTenBitCapture,
+                RecordRawIsos = RecordRawIsos,
                 EnableStreaming = EnableStreaming,
                 StreamingPort = StreamingPort,
                 MaxViewers = MaxViewers,
@@ -570,7 +592,9 @@ public partial class SettingsViewModel : ObservableObject
                 SrtOutputPort = SrtOutputPort,
                 SrtOutputLatency = SrtOutputLatency,
                 SrtOutputBitrate = SrtOutputBitrate,
-                SrtInputsJson = srtInputsJson
+                SrtInputsJson = srtInputsJson,
+                SrtOutputRendition = SrtOutputRendition.Trim(),
+                EncodeLadderJson = _encodeLadderJson
             };
 
             await _settingsService.SaveSettingsAsync(settings);
@@ -1,7 +1,7 @@
 namespace Screener.UI.ViewModels;
 
 /// <summary>
-/// Pre-computed YUV-to-RGB lookup tables and VANC/HANC geometry detection.
+/// Pre-computed YUV-to-RGB lookup tables.
 /// Shared by all preview renderers (InputPreviewRenderer).
 /// </summary>
 internal static class YuvConversion
@@ -34,50 +34,4 @@ internal static class YuvConversion
             ClampTable[i] = (byte)(v < 0 ? 0 : v > 255 ? 255 : v);
         }
     }
-
-    // Auto-detection of VANC rows (vertical) and HANC offset (horizontal).
-    // Detected once on the first valid frame, reset on format change.
-    private static int _detectedVancRows = -1; // -1 = not yet detected
-    private static int _detectedHancBytes = 0;  // horizontal byte offset per row
-    private static readonly object _vancDetectionLock = new();
-
-    internal static int DetectedVancRows => _detectedVancRows;
-    internal static int DetectedHancBytes => _detectedHancBytes;
-
-    /// <summary>
-    /// Ensures VANC geometry has been detected. Called by InputPreviewRenderer on first frame.
-    /// </summary>
-    internal static void EnsureVancDetected(byte[] frameData, int srcRowBytes, int height)
-    {
-        if (_detectedVancRows >= 0) return;
-        lock (_vancDetectionLock)
-        {
-            if (_detectedVancRows >= 0) return;
-            int maxScan = Math.Min(120, height);
-            int firstVideoRow = 0;
-            for (int row = 0; row < maxScan; row++)
-            {
-                int rowStart = row * srcRowBytes;
-                if (rowStart + 4 >= frameData.Length) break;
-                byte b0 = frameData[rowStart];
-                byte b1 = frameData[rowStart + 1];
-                byte b2 = frameData[rowStart + 2];
-                byte b3 = frameData[rowStart + 3];
-                bool isAnc = (b0 == 0x00 && b1 == 0x02 && b2 == 0x01 && b3 == 0x20);
-                bool isZero = (b0 == 0x00 && b1 == 0x00 && b2 == 0x00 && b3 == 0x00);
-                if (!isAnc && !isZero) { firstVideoRow = row; break; }
-                firstVideoRow = row + 1;
-            }
-            _detectedVancRows = firstVideoRow;
-        }
-    }
-
-    internal static void ResetVancDetection()
-    {
-        lock (_vancDetectionLock)
-        {
-            _detectedVancRows = -1;
-            _detectedHancBytes = 0;
-        }
-    }
 }
@@ -0,0 +1,67 @@
+namespace Screener.Upload;
+
+/// <summary>
+/// Token bucket shared by every upload, so parallel parts and concurrent jobs together stay
+/// under the configured uplink budget (for example to leave room for a live stream).
+/// </summary>
+public sealed class BandwidthLimiter
+{
+    // Burst allowance: how far ahead of the rate a sender may get after being idle
+    private static readonly TimeSpan Burst = TimeSpan.FromMilliseconds(250);
+
+    private readonly object _lock = new();
+    private long _bytesPerSecond;
+    private double _tokens;
+    private long _lastRefillTicks = Environment.TickCount64;
+
+    /// <summary>
+    /// Upload budget in bytes per second across all uploads; 0 for unlimited.
+    /// </summary>
+    public long BytesPerSecond
+    {
+        get => Interlocked.Read(ref _bytesPerSecond);
+        set
+        {
+            lock (_lock)
+            {
+                _bytesPerSecond = Math.Max(0, value);
+                _tokens = 0;
+                _lastRefillTicks = Environment.TickCount64;
+            }
+        }
+    }
+
+    public bool IsLimited => BytesPerSecond > 0;
+
+    /// <summary>
+    /// Wait until count bytes may be sent. Returns at once when unlimited.
+    /// </summary>
+    public async ValueTask WaitAsync(int count, CancellationToken ct = default)
+    {
+        while (true)
+        {
+            TimeSpan wait;
+            lock (_lock)
+            {
+                if (_bytesPerSecond <= 0)
+                    return;
+
+                long now = Environment.TickCount64;
+                double burst = _bytesPerSecond * Burst.TotalSeconds;
+                _tokens = Math.Min(burst, _tokens + (now - _lastRefillTicks) * _bytesPerSecond / 1000.0);
+                _lastRefillTicks = now;
+
+                // Requests larger than the burst go into debt rather than waiting forever
+                if (_tokens >= Math.Min(count, burst))
+                {
+                    _tokens -= count;
+                    return;
+                }
+
+                wait = TimeSpan.FromSeconds((Math.Min(count, burst) - _tokens) / _bytesPerSecond);
+            }
+
+            await Task.Delay(wait < TimeSpan.FromMilliseconds(1) ? TimeSpan.FromMilliseconds(1) : wait, ct);
+        }
+    }
+}
@@ -0,0 +1,461 @@
+using System.Buffers;
+using System.Collections.Concurrent;
+using System.Net.Http.Headers;
+using System.Runtime.ExceptionServices;
+using System.Threading.Channels;
+using Microsoft.Extensions.Logging;
+using Polly;
+using Polly.Retry;
+using Screener.Abstractions.Upload;
+using Screener.Core.Persistence;
+
+namespace Screener.Upload;
+
+/// <summary>
+/// How a provider wants a file cut up and sent.
+/// </summary>
+public sealed record ChunkedUploadOptions
+{
+    /// <summary>Bytes per part; the last part takes the remainder.</summary>
+    public required long ChunkSize { get; init; }
+
+    /// <summary>Parts in flight at once. 1 sends the parts strictly in order.</summary>
+    public int MaxConcurrentParts { get; init; } = 1;
+
+    /// <summary>Key the progress is saved under so an interrupted upload can carry on; null to not save it.</summary>
+    public string? ResumeKey { get; init; }
+
+    /// <summary>Provider state needed to carry on (session id, part URLs), saved with the progress.</summary>
+    public string? SessionJson { get; init; }
+
+    /// <summary>Parts already sent by an earlier attempt; skipped.</summary>
+    public IReadOnlyCollection<int>? CompletedParts { get; init; }
+}
+
+/// <summary>
+/// One part of a file being uploaded, read into a pooled buffer. Valid only until the send
+/// delegate returns.
+/// </summary>
+public sealed class UploadChunk
+{
+    private readonly byte[] _buffer;
+    private readonly BandwidthLimiter? _limiter;
+    private readonly Action<long> _onSent;
+    private long _sent;
+
+    internal UploadChunk(int index, long offset, byte[] buffer, int length, BandwidthLimiter? limiter, Action<long> onSent)
+    {
+        Index = index;
+        Offset = offset;
+        Length = length;
+        _buffer = buffer;
+        _limiter = limiter;
+        _onSent = onSent;
+    }
+
+    public int Index { get; }
+    public long Offset { get; }
+    public int Length { get; }
+
+    /// <summary>
+    /// The part's bytes, unpaced. Prefer <see cref="OpenRead"/> so the bandwidth limit holds.
+    /// </summary>
+    public ReadOnlyMemory<byte> Data => _buffer.AsMemory(0, Length);
+
+    internal byte[] Buffer => _buffer;
+    internal long Sent => Interlocked.Read(ref _sent);
+
+    /// <summary>
+    /// Stream over the part that is paced by the bandwidth limit and reports progress as it
+    /// is read. Open a new one for each attempt.
+    /// </summary>
+    public Stream OpenRead() =>
+        new ThrottledStream(new MemoryStream(_buffer, 0, Length, writable: false), _limiter, OnRead);
+
+    /// <summary>
+    /// Request body over <see cref="OpenRead"/>.
+    /// </summary>
+    public HttpContent CreateContent(string contentType = "application/octet-stream")
+    {
+        var content = new StreamContent(OpenRead());
+        content.Headers.ContentType = new MediaTypeHeaderValue(contentType);
+        content.Headers.ContentLength = Length;
+        return content;
+    }
+
+    private void OnRead(int count)
+    {
+        Interlocked.Add(ref _sent, count);
+        _onSent(count);
+    }
+
+    // Forget what a failed attempt sent; returns it so the total can be taken back
+    internal long ResetAttempt() => Interlocked.Exchange(ref _sent, 0);
+}
+
+/// <summary>
+/// Upload engine shared by the chunked providers. Reads the file with positional reads into
+/// pooled buffers one part ahead of the senders, sends up to the provider's limit of parts at
+/// once, retries a failed part on its own, paces everything through the shared
+/// <see cref="BandwidthLimiter"/>, and saves which parts are done so a restarted upload skips
+/// them.
+/// </summary>
+public sealed class ChunkedUploader
+{
+    private const int ReadAheadParts = 1;
+    private static readonly TimeSpan ProgressInterval = TimeSpan.FromMilliseconds(250);
+
+    private readonly ILogger _logger;
+    private readonly BandwidthLimiter? _limiter;
+    private readonly UploadQueueRepository? _resumeStore;
+    private readonly ResiliencePipeline _partRetry;
+
+    public ChunkedUploader(ILogger logger, BandwidthLimiter? limiter = null, UploadQueueRepository? resumeStore = null)
+    {
+        _logger = logger;
+        _limiter = limiter;
+        _resumeStore = resumeStore;
+
+        _partRetry = new ResiliencePipelineBuilder()
+            .AddRetry(new RetryStrategyOptions
+            {
+                MaxRetryAttempts = 3,
+                BackoffType = DelayBackoffType.Exponential,
+                Delay = TimeSpan.FromSeconds(1),
+                ShouldHandle = new PredicateBuilder().Handle<Exception>(ex => ex is not OperationCanceledException || ex is TaskCanceledException),
+                OnRetry = args =>
+                {
+                    _logger.LogWarning(args.Outcome.Exception, "Retrying upload part (attempt {Attempt}) after {Delay}s",
+                        args.AttemptNumber + 1, args.RetryDelay.TotalSeconds);
+                    return ValueTask.CompletedTask;
+                }
+            })
+            .Build();
+    }
+
+    public BandwidthLimiter? Limiter => _limiter;
+
+    public static int GetPartCount(long fileLength, long chunkSize) =>
+        fileLength == 0 ? 1 : (int)((fileLength + chunkSize - 1) / chunkSize);
+
+    /// <summary>
+    /// Resume key for a file going to a destination. Changes if the file is rewritten, so stale
+    /// progress is never applied to different bytes.
+    /// </summary>
+    public static string GetResumeKey(string providerId, string localFilePath, string remotePath)
+    {
+        var info = new FileInfo(localFilePath);
+        return $"{providerId}|{info.FullName}|{remotePath}|{info.Length}|{info.LastWriteTimeUtc.Ticks}";
+    }
+
+    /// <summary>
+    /// Saved progress for an interrupted upload, or null.
+    /// </summary>
+    public async Task<UploadResumeState?> LoadResumeAsync(string resumeKey, CancellationToken ct = default)
+    {
+        if (_resumeStore == null)
+            return null;
+
+        try
+        {
+            return await _resumeStore.GetResumeStateAsync(resumeKey, ct);
+        }
+        catch (Exception ex)
+        {
+            // No database yet, or unreadable: upload from the start
+            _logger.LogDebug(ex, "Could not load upload resume state");
+            return null;
+        }
+    }
+
+    /// <summary>
+    /// Record that an upload has started, for providers whose remote end keeps the progress
+    /// itself (a partly written file) but need to know it is theirs to carry on.
+    /// </summary>
+    public async Task SaveSessionAsync(string resumeKey, string sessionJson, CancellationToken ct = default)
+    {
+        if (_resumeStore == null)
+            return;
+
+        try
+        {
+            await _resumeStore.SaveResumeStateAsync(
+                new UploadResumeState(resumeKey, sessionJson, [], 0, DateTimeOffset.UtcNow), ct);
+        }
+        catch (Exception ex) when (ex is not OperationCanceledException)
+        {
+            _logger.LogDebug(ex, "Could not save upload resume state");
+        }
+    }
+
+    /// <summary>
+    /// Drop saved progress once the upload is committed, or when it can no longer be resumed.
+    /// </summary>
+    public async Task ForgetResumeAsync(string resumeKey, CancellationToken ct = default)
+    {
+        if (_resumeStore == null)
+            return;
+
+        try
+        {
+            await _resumeStore.DeleteResumeStateAsync(resumeKey, ct);
+        }
+        catch (Exception ex)
+        {
+            _logger.LogDebug(ex, "Could not delete upload resume state");
+        }
+    }
+
+    /// <summary>
+    /// Send every part of the file not already done through sendPart.
+    /// </summary>
+    /// <param name="sendPart">Sends one part; throws on failure. Called concurrently when
+    /// more than one part may be in flight.</param>
+    /// <returns>Size of the file.</returns>
+    public async Task<long> UploadAsync(
+        string localFilePath,
+        ChunkedUploadOptions options,
+        Func<UploadChunk, CancellationToken, Task> sendPart,
+        IProgress<UploadProgress>? progress,
+        CancellationToken ct)
+    {
+        if (options.ChunkSize <= 0 || options.ChunkSize > Array.MaxLength)
+            throw new ArgumentOutOfRangeException(nameof(options), options.ChunkSize, "Chunk size out of range");
+
+        using var handle = File.OpenHandle(localFilePath, FileMode.Open, FileAccess.Read, FileShare.Read,
+            FileOptions.Asynchronous | FileOptions.SequentialScan);
+
+        long length = RandomAccess.GetLength(handle);
+        int partCount = GetPartCount(length, options.ChunkSize);
+
+        var completed = new ConcurrentDictionary<int, bool>(
+            (options.CompletedParts ?? []).Where(i => i >= 0 && i < partCount).Select(i => KeyValuePair.Create(i, true)));
+        long resumedBytes = completed.Keys.Sum(i => PartLength(i, length, options.ChunkSize));
+
+        var tracker = new ProgressTracker(progress, length, resumedBytes);
+        var pending = Enumerable.Range(0, partCount).Where(i => !completed.ContainsKey(i)).ToList();
+
+        if (resumedBytes > 0)
+        {
+            _logger.LogInformation("Resuming upload of {File}: {Done}/{Total} parts already sent",
+                Path.GetFileName(localFilePath), completed.Count, partCount);
+        }
+
+        int workers = Math.Clamp(options.MaxConcurrentParts, 1, Math.Max(1, pending.Count));
+        var parts = Channel.CreateBounded<UploadChunk>(new BoundedChannelOptions(ReadAheadParts)
+        {
+            SingleWriter = true,
+            SingleReader = workers == 1
+        });
+
+        var saveLock = new SemaphoreSlim(1, 1);
+        using var cts = CancellationTokenSource.CreateLinkedTokenSource(ct);
+
+        var tasks = new List<Task> { ReadPartsAsync(handle, length, options.ChunkSize, pending, tracker, parts.Writer, cts) };
+        for (int i = 0; i < workers; i++)
+            tasks.Add(SendPartsAsync(parts.Reader, sendPart, options, completed, length, tracker, saveLock, cts));
+
+        try
+        {
+            await Task.WhenAll(tasks);
+        }
+        catch
+        {
+            // Report the part that failed, not the cancellations it caused
+            var fault = tasks.Where(t => t.IsFaulted)
+                .Select(t => t.Exception!.InnerException!)
+                .FirstOrDefault(e => e is not OperationCanceledException);
+            if (fault != null)
+                ExceptionDispatchInfo.Throw(fault);
+            throw;
+        }
+        finally
+        {
+            while (parts.Reader.TryRead(out var left))
+                ArrayPool<byte>.Shared.Return(left.Buffer);
+            saveLock.Dispose();
+        }
+
+        tracker.Report(force: true);
+        return length;
+    }
+
+    private async Task ReadPartsAsync(
+        Microsoft.Win32.SafeHandles.SafeFileHandle handle,
+        long length,
+        long chunkSize,
+        IReadOnlyList<int> pending,
+        ProgressTracker tracker,
+        ChannelWriter<UploadChunk> writer,
+        CancellationTokenSource cts)
+    {
+        Exception? error = null;
+        try
+        {
+            foreach (int index in pending)
+            {
+                long offset = index * chunkSize;
+                int partLength = (int)PartLength(index, length, chunkSize);
+                var buffer = ArrayPool<byte>.Shared.Rent(Math.Max(partLength, 1));
+
+                try
+                {
+                    int filled = 0;
+                    while (filled < partLength)
+                    {
+                        int read = await RandomAccess.ReadAsync(handle, buffer.AsMemory(filled, partLength - filled),
+                            offset + filled, cts.Token);
+                        if (read == 0)
+                            throw new IOException("File shrank while it was being uploaded");
+                        filled += read;
+                    }
+
+                    await writer.WriteAsync(new UploadChunk(index, offset, buffer, partLength, _limiter, tracker.Add), cts.Token);
+                }
+                catch
+                {
+                    ArrayPool<byte>.Shared.Return(buffer);
+                    throw;
+                }
+            }
+        }
+        catch (Exception ex)
+        {
+            error = ex;
+            cts.Cancel();
+            throw;
+        }
+        finally
+        {
+            writer.TryComplete(error);
+        }
+    }
+
+    private async Task SendPartsAsync(
+        ChannelReader<UploadChunk> reader,
+        Func<UploadChunk, CancellationToken, Task> sendPart,
+        ChunkedUploadOptions options,
+        ConcurrentDictionary<int, bool> completed,
+        long length,
+        ProgressTracker tracker,
+        SemaphoreSlim saveLock,
+        CancellationTokenSource cts)
+    {
+        try
+        {
+            await foreach (var chunk in reader.ReadAllAsync(cts.Token))
+            {
+                try
+                {
+                    await _partRetry.ExecuteAsync(async token =>
+                    {
+                        tracker.Add(-chunk.ResetAttempt());
+                        await sendPart(chunk, token);
+                    }, cts.Token);
+
+                    // Count bytes the provider sent without going through OpenRead
+                    tracker.Add(chunk.Length - chunk.Sent);
+                }
+                finally
+                {
+                    ArrayPool<byte>.Shared.Return(chunk.Buffer);
+                }
+
+                completed[chunk.Index] = true;
+                tracker.Report(force: false);
+
+                if (options.ResumeKey != null)
+                    await SaveResumeAsync(options, completed, length, saveLock, cts.Token);
+            }
+        }
+        catch
+        {
+            cts.Cancel();
+            throw;
+        }
+    }
+
+    private async Task SaveResumeAsync(
+        ChunkedUploadOptions options,
+        ConcurrentDictionary<int, bool> completed,
+        long length,
+        SemaphoreSlim saveLock,
+        CancellationToken ct)
+    {
+        if (_resumeStore == null)
+            return;
+
+        // Serialized so an older snapshot never lands after a newer one
+        await saveLock.WaitAsync(ct);
+        try
+        {
+            var done = completed.Keys.Order().ToArray();
+            await _resumeStore.SaveResumeStateAsync(new UploadResumeState(
+                options.ResumeKey!,
+                options.SessionJson ?? "{}",
+                done,
+                done.Sum(i => PartLength(i, length, options.ChunkSize)),
+                DateTimeOffset.UtcNow), ct);
+        }
+        catch (Exception ex) when (ex is not OperationCanceledException)
+        {
+            // Losing resume state only costs a re-send; never fail the upload over it
+            _logger.LogDebug(ex, "Could not save upload resume state");
+        }
+        finally
+        {
+            saveLock.Release();
+        }
+    }
+
+    private static long PartLength(int index, long length, long chunkSize) =>
+        Math.Min(chunkSize, length - index * chunkSize);
+
+    private sealed class ProgressTracker
+    {
+        private readonly IProgress<UploadProgress>? _progress;
+        private readonly long _total;
+        private readonly long _resumed;
+        private readonly DateTime _startTime = DateTime.UtcNow;
+        private long _transferred;
+        private long _lastReportTicks;
+
+        public ProgressTracker(IProgress<UploadProgress>? progress, long total, long resumed)
+        {
+            _progress = progress;
+            _total = total;
+            _resumed = resumed;
+            _transferred = resumed;
+        }
+
+        public void Add(long count)
+        {
+            if (count == 0)
+                return;
+
+            Interlocked.Add(ref _transferred, count);
+            Report(force: false);
+        }
+
+        public void Report(bool force)
+        {
+            if (_progress == null)
+                return;
+
+            long now = Environment.TickCount64;
+            long last = Interlocked.Read(ref _lastReportTicks);
+            if (!force && (now - last < ProgressInterval.TotalMilliseconds ||
+                           Interlocked.CompareExchange(ref _lastReportTicks, now, last) != last))
+                return;
+
+            long transferred = Math.Clamp(Interlocked.Read(ref _transferred), 0, _total);
+            var elapsed = DateTime.UtcNow - _startTime;
+            _progress.Report(new UploadProgress(
+                transferred,
+                _total,
+                _total > 0 ? 100.0 * transferred / _total : 100,
+                elapsed,
+                elapsed.TotalSeconds > 0 ? (long)((transferred - _resumed) / elapsed.TotalSeconds) : 0));
+        }
+    }
+}
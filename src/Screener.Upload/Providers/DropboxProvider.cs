@@ -1,7 +1,9 @@
+using System.Text.Json;
 using Dropbox.Api;
 using Dropbox.Api.Files;
 using Microsoft.Extensions.Logging;
 using Screener.Abstractions.Upload;
+using Screener.Core.Persistence;
 
 namespace Screener.Upload.Providers;
 
@@ -11,18 +13,23 @@ namespace Screener.Upload.Providers;
 public sealed class DropboxProvider : ICloudStorageProvider
 {
     private readonly ILogger<DropboxProvider> _logger;
+    private readonly ChunkedUploader _uploader;
     private DropboxClient? _client;
     private string _basePath = string.Empty;
 
-    private const int ChunkSize = 150 * 1024 * 1024; // 150MB chunks
+    private const int ChunkSize = 64 * 1024 * 1024; // 64MB chunks (multiple of 4MB, under the 150MB append limit)
 
     public string ProviderId => "dropbox";
     public string DisplayName => "Dropbox";
     public bool IsConfigured => _client != null;
 
-    public DropboxProvider(ILogger<DropboxProvider> logger)
+    public DropboxProvider(
+        ILogger<DropboxProvider> logger,
+        BandwidthLimiter? bandwidth = null,
+        UploadQueueRepository? resumeStore = null)
     {
         _logger = logger;
+        _uploader = new ChunkedUploader(logger, bandwidth, resumeStore);
     }
 
     public Task InitializeAsync(ProviderCredentials credentials, CancellationToken ct = default)
@@ -81,24 +88,20 @@ public sealed class DropboxProvider : ICloudStorageProvider
                 : _basePath.TrimEnd('/') + "/" + remotePath.TrimStart('/');
 
             var fileInfo = new FileInfo(localFilePath);
-            var startTime = DateTime.UtcNow;
-
-            await using var fileStream = File.OpenRead(localFilePath);
-
-            FileMetadata result;
 
             if (fileInfo.Length <= ChunkSize)
             {
                 // Simple upload for small files
-                result = await _client.Files.UploadAsync(
+                await using var body = new ThrottledStream(File.OpenRead(localFilePath), _uploader.Limiter);
+                await _client.Files.UploadAsync(
                     fullPath,
                     WriteMode.Overwrite.Instance,
-                    body: fileStream);
+                    body: body);
             }
             else
             {
                 // Chunked upload for large files
-                result = await UploadLargeFileAsync(fileStream, fileInfo.Length, fullPath, startTime, progress, ct);
+                await UploadLargeFileAsync(localFilePath, fullPath, progress, ct);
             }
 
             _logger.LogInformation("Uploaded to Dropbox: {Path}", fullPath);
@@ -113,69 +116,60 @@ public sealed class DropboxProvider : ICloudStorageProvider
     }
 
     private async Task<FileMetadata> UploadLargeFileAsync(
-        FileStream fileStream,
-        long fileSize,
+        string localFilePath,
         string remotePath,
-        DateTime startTime,
         IProgress<UploadProgress>? progress,
         CancellationToken ct)
     {
-        var buffer = new byte[ChunkSize];
-        long uploadedBytes = 0;
-        string? sessionId = null;
+        var resumeKey = ChunkedUploader.GetResumeKey(ProviderId, localFilePath, remotePath);
 
-        // Start upload session
-        var bytesRead = await fileStream.ReadAsync(buffer, ct);
-        using (var memStream = new MemoryStream(buffer, 0, bytesRead))
+        // Carry on with the session an interrupted upload opened
+        var resume = await _uploader.LoadResumeAsync(resumeKey, ct);
+        var sessionId = resume != null ? JsonSerializer.Deserialize<DropboxSession>(resume.SessionJson)?.SessionId : null;
+        var completedParts = sessionId != null ? resume!.CompletedParts : null;
+
+        if (sessionId == null)
         {
-            var sessionStart = await _client!.Files.UploadSessionStartAsync(body: memStream);
+            // Start upload session
+            using var empty = new MemoryStream();
+            var sessionStart = await _client!.Files.UploadSessionStartAsync(body: empty);
             sessionId = sessionStart.SessionId;
-            uploadedBytes = bytesRead;
         }
 
-        ReportProgress(progress, uploadedBytes, fileSize, startTime);
-
-        // Upload chunks
-        while ((bytesRead = await fileStream.ReadAsync(buffer, ct)) > 0)
+        var options = new ChunkedUploadOptions
         {
-            ct.ThrowIfCancellationRequested();
-
-            var cursor = new UploadSessionCursor(sessionId, (ulong)uploadedBytes);
+            ChunkSize = ChunkSize,
+            MaxConcurrentParts = 1, // appends must arrive in offset order
+            ResumeKey = resumeKey,
+            SessionJson = JsonSerializer.Serialize(new DropboxSession { SessionId = sessionId }),
+            CompletedParts = completedParts
+        };
 
-            if (fileStream.Position == fileStream.Length)
-            {
-                // Last chunk - finish session
-                using var memStream = new MemoryStream(buffer, 0, bytesRead);
-                var commit = new CommitInfo(remotePath, WriteMode.Overwrite.Instance);
-
-                return await _client.Files.UploadSessionFinishAsync(cursor, commit, body: memStream);
-            }
-            else
+        try
+        {
+            // Upload chunks; the next one is read while this one is sent
+            var fileSize = await _uploader.UploadAsync(localFilePath, options, async (chunk, token) =>
             {
-                // Append chunk
-                using var memStream = new MemoryStream(buffer, 0, bytesRead);
-                await _client.Files.UploadSessionAppendV2Async(cursor, body: memStream);
-            }
-
-            uploadedBytes += bytesRead;
-            ReportProgress(progress, uploadedBytes, fileSize, startTime);
+                await using var body = chunk.OpenRead();
+                var cursor = new UploadSessionCursor(sessionId, (ulong)chunk.Offset);
+                await _client!.Files.UploadSessionAppendV2Async(cursor, body: body);
+            }, progress, ct);
+
+            // Finish session
+            using var finishBody = new MemoryStream();
+            var commit = new CommitInfo(remotePath, WriteMode.Overwrite.Instance);
+            var result = await _client!.Files.UploadSessionFinishAsync(
+                new UploadSessionCursor(sessionId, (ulong)fileSize), commit, body: finishBody);
+
+            await _uploader.ForgetResumeAsync(resumeKey, CancellationToken.None);
+            return result;
+        }
+        catch (Exception ex) when (completedParts != null && ex is not OperationCanceledException)
+        {
+            // The session may have expired or lost its place; the next attempt starts a new one
+            await _uploader.ForgetResumeAsync(resumeKey, CancellationToken.None);
+            throw;
         }
-
-        // Should not reach here normally
-        throw new InvalidOperationException("Upload session did not complete properly");
-    }
-
-    private static void ReportProgress(IProgress<UploadProgress>? progress, long uploadedBytes, long totalBytes, DateTime startTime)
-    {
-        if (progress == null) return;
-
-        var elapsed = DateTime.UtcNow - startTime;
-        progress.Report(new UploadProgress(
-            uploadedBytes,
-            totalBytes,
-            100.0 * uploadedBytes / totalBytes,
-            elapsed,
-            elapsed.TotalSeconds > 0 ? (long)(uploadedBytes / elapsed.TotalSeconds) : 0));
     }
 
     public async Task<IReadOnlyList<StorageDestination>> ListDestinationsAsync(
@@ -218,4 +212,10 @@ public sealed class DropboxProvider : ICloudStorageProvider
         _client = null;
         return ValueTask.CompletedTask;
     }
+
+    // Saved with the resume state
+    private class DropboxSession
+    {
+        public string SessionId { get; set; } = string.Empty;
+    }
 }
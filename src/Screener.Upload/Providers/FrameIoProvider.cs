@@ -4,6 +4,7 @@ using System.Text.Json;
 using System.Text.Json.Serialization;
 using Microsoft.Extensions.Logging;
 using Screener.Abstractions.Upload;
+using Screener.Core.Persistence;
 
 namespace Screener.Upload.Providers;
 
@@ -14,21 +15,28 @@ public sealed class FrameIoProvider : ICloudStorageProvider
 {
     private readonly ILogger<FrameIoProvider> _logger;
     private readonly HttpClient _httpClient;
+    private readonly HttpClient _uploadClient;
+    private readonly ChunkedUploader _uploader;
 
     private string _accessToken = string.Empty;
     private string _rootAssetId = string.Empty;
 
     private const string ApiBaseUrl = "https://api.frame.io/v2";
-    private const int ChunkSize = 25 * 1024 * 1024; // 25MB chunks (Frame.io recommended)
+    private const int MaxParallelParts = 4;
 
     public string ProviderId => "frame-io";
     public string DisplayName => "Frame.io";
     public bool IsConfigured => !string.IsNullOrEmpty(_accessToken);
 
-    public FrameIoProvider(ILogger<FrameIoProvider> logger)
+    public FrameIoProvider(
+        ILogger<FrameIoProvider> logger,
+        BandwidthLimiter? bandwidth = null,
+        UploadQueueRepository? resumeStore = null)
     {
         _logger = logger;
         _httpClient = new HttpClient();
+        _uploadClient = new HttpClient { Timeout = TimeSpan.FromMinutes(30) };
+        _uploader = new ChunkedUploader(logger, bandwidth, resumeStore);
     }
 
     public Task InitializeAsync(ProviderCredentials credentials, CancellationToken ct = default)
@@ -84,87 +92,100 @@ public sealed class FrameIoProvider : ICloudStorageProvider
         if (string.IsNullOrEmpty(_accessToken))
             return new UploadResult(false, null, null, "Provider not initialized");
 
+        string? resumeKey = null;
+        bool resumed = false;
+
         try
         {
             var fileInfo = new FileInfo(localFilePath);
             var fileName = Path.GetFileName(remotePath);
-            var startTime = DateTime.UtcNow;
+            resumeKey = ChunkedUploader.GetResumeKey(ProviderId, localFilePath, remotePath);
+
+            // Carry on with the asset an interrupted upload created, while its URLs last
+            var resume = await _uploader.LoadResumeAsync(resumeKey, ct);
+            var session = resume != null ? JsonSerializer.Deserialize<FrameIoSession>(resume.SessionJson) : null;
+            if (session?.UploadUrls is not { Length: > 0 })
+                session = null;
+            var completedParts = session != null ? resume!.CompletedParts : null;
 
-            // Create asset (file placeholder)
-            var createRequest = new
+            if (session == null)
             {
-                name = fileName,
-                type = "file",
-                filetype = GetMimeType(localFilePath),
-                filesize = fileInfo.Length
-            };
+                // Create asset (file placeholder)
+                var createRequest = new
+                {
+                    name = fileName,
+                    type = "file",
+                    filetype = GetMimeType(localFilePath),
+                    filesize = fileInfo.Length
+                };
 
-            var createResponse = await _httpClient.PostAsJsonAsync(
-                $"{ApiBaseUrl}/assets/{_rootAssetId}/children",
-                createRequest,
-                ct);
+                var createResponse = await _httpClient.PostAsJsonAsync(
+                    $"{ApiBaseUrl}/assets/{_rootAssetId}/children",
+                    createRequest,
+                    ct);
 
-            createResponse.EnsureSuccessStatusCode();
+                createResponse.EnsureSuccessStatusCode();
 
-            var asset = await createResponse.Content.ReadFromJsonAsync<FrameIoAsset>(cancellationToken: ct);
+                var asset = await createResponse.Content.ReadFromJsonAsync<FrameIoAsset>(cancellationToken: ct);
 
-            if (asset?.UploadUrls == null || asset.UploadUrls.Length == 0)
-            {
-                throw new Exception("No upload URLs provided by Frame.io");
-            }
+                if (asset?.Id == null || asset.UploadUrls == null || asset.UploadUrls.Length == 0)
+                {
+                    throw new Exception("No upload URLs provided by Frame.io");
+                }
 
-            _logger.LogDebug("Created Frame.io asset: {AssetId}", asset.Id);
+                session = new FrameIoSession { AssetId = asset.Id, UploadUrls = asset.UploadUrls };
+                _logger.LogDebug("Created Frame.io asset: {AssetId}", asset.Id);
+            }
 
-            // Upload file in chunks
-            await using var fileStream = File.OpenRead(localFilePath);
-            long uploadedBytes = 0;
-            var chunkIndex = 0;
+            var assetId = session.AssetId;
+            resumed = completedParts != null;
 
-            foreach (var uploadUrl in asset.UploadUrls)
+            // Frame.io sizes the parts itself: one URL per equal slice of the file
+            var urls = session.UploadUrls!;
+            var options = new ChunkedUploadOptions
             {
-                ct.ThrowIfCancellationRequested();
-
-                var bytesToRead = (int)Math.Min(ChunkSize, fileInfo.Length - uploadedBytes);
-                var buffer = new byte[bytesToRead];
-                var bytesRead = await fileStream.ReadAsync(buffer.AsMemory(0, bytesToRead), ct);
+                ChunkSize = Math.Max(1, (fileInfo.Length + urls.Length - 1) / urls.Length),
+                MaxConcurrentParts = MaxParallelParts,
+                ResumeKey = resumeKey,
+                SessionJson = JsonSerializer.Serialize(session),
+                CompletedParts = completedParts
+            };
 
-                using var content = new ByteArrayContent(buffer, 0, bytesRead);
-                content.Headers.ContentType = new MediaTypeHeaderValue("application/octet-stream");
+            await _uploader.UploadAsync(localFilePath, options, async (chunk, token) =>
+            {
+                using var content = chunk.CreateContent(GetMimeType(localFilePath));
+                content.Headers.Add("x-amz-acl", "private");
 
-                var uploadResponse = await _httpClient.PutAsync(uploadUrl, content, ct);
+                // Presigned S3 URLs: no bearer token
+                using var request = new HttpRequestMessage(HttpMethod.Put, urls[chunk.Index]) { Content = content };
+                using var uploadResponse = await _uploadClient.SendAsync(request, token);
                 uploadResponse.EnsureSuccessStatusCode();
 
-                uploadedBytes += bytesRead;
-                chunkIndex++;
-
-                var elapsed = DateTime.UtcNow - startTime;
-                progress?.Report(new UploadProgress(
-                    uploadedBytes,
-                    fileInfo.Length,
-                    100.0 * uploadedBytes / fileInfo.Length,
-                    elapsed,
-                    elapsed.TotalSeconds > 0 ? (long)(uploadedBytes / elapsed.TotalSeconds) : 0));
-
-                _logger.LogDebug("Uploaded chunk {Index}/{Total}", chunkIndex, asset.UploadUrls.Length);
-            }
+                _logger.LogDebug("Uploaded chunk {Index}/{Total}", chunk.Index + 1, urls.Length);
+            }, progress, ct);
 
             // Complete the upload
             var completeResponse = await _httpClient.PostAsync(
-                $"{ApiBaseUrl}/assets/{asset.Id}/uploaded",
+                $"{ApiBaseUrl}/assets/{assetId}/uploaded",
                 null,
                 ct);
 
             completeResponse.EnsureSuccessStatusCode();
+            await _uploader.ForgetResumeAsync(resumeKey, CancellationToken.None);
 
-            _logger.LogInformation("Uploaded to Frame.io: {FileName} ({AssetId})", fileName, asset.Id);
+            _logger.LogInformation("Uploaded to Frame.io: {FileName} ({AssetId})", fileName, assetId);
 
             // Construct the web URL
-            var webUrl = $"https://app.frame.io/player/{asset.Id}";
+            var webUrl = $"https://app.frame.io/player/{assetId}";
 
-            return new UploadResult(true, asset.Id, webUrl);
+            return new UploadResult(true, assetId, webUrl);
         }
         catch (Exception ex)
         {
+            // The part URLs may have expired; the next attempt starts a fresh asset
+            if (resumed && ex is not OperationCanceledException)
+                await _uploader.ForgetResumeAsync(resumeKey!, CancellationToken.None);
+
             _logger.LogError(ex, "Frame.io upload failed");
             return new UploadResult(false, null, null, ex.Message);
         }
@@ -229,6 +250,7 @@ public sealed class FrameIoProvider : ICloudStorageProvider
     public ValueTask DisposeAsync()
     {
         _httpClient.Dispose();
+        _uploadClient.Dispose();
         return ValueTask.CompletedTask;
     }
 
@@ -255,4 +277,11 @@ public sealed class FrameIoProvider : ICloudStorageProvider
         [JsonPropertyName("upload_urls")]
         public string[]? UploadUrls { get; set; }
     }
+
+    // Saved with the resume state
+    private class FrameIoSession
+    {
+        public string AssetId { get; set; } = string.Empty;
+        public string[]? UploadUrls { get; set; }
+    }
 }
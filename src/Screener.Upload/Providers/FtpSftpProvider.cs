@@ -1,8 +1,10 @@
+using System.Buffers;
 using FluentFTP;
 using Microsoft.Extensions.Logging;
 using Renci.SshNet;
 using Renci.SshNet.Sftp;
 using Screener.Abstractions.Upload;
+using Screener.Core.Persistence;
 
 namespace Screener.Upload.Providers;
 
@@ -12,6 +14,10 @@ namespace Screener.Upload.Providers;
 public sealed class FtpSftpProvider : ICloudStorageProvider
 {
     private readonly ILogger<FtpSftpProvider> _logger;
+    private readonly ChunkedUploader _uploader;
+
+    // Large writes keep the SSH channel full; SSH.NET splits them into packets itself
+    private const int BufferSize = 1024 * 1024;
 
     private string _host = string.Empty;
     private int _port;
@@ -29,9 +35,13 @@ public sealed class FtpSftpProvider : ICloudStorageProvider
     public string DisplayName => _useSftp ? "SFTP" : "FTP";
     public bool IsConfigured => !string.IsNullOrEmpty(_host);
 
-    public FtpSftpProvider(ILogger<FtpSftpProvider> logger)
+    public FtpSftpProvider(
+        ILogger<FtpSftpProvider> logger,
+        BandwidthLimiter? bandwidth = null,
+        UploadQueueRepository? resumeStore = null)
     {
         _logger = logger;
+        _uploader = new ChunkedUploader(logger, bandwidth, resumeStore);
     }
 
     public Task InitializeAsync(ProviderCredentials credentials, CancellationToken ct = default)
@@ -169,30 +179,64 @@ public sealed class FtpSftpProvider : ICloudStorageProvider
                 EnsureSftpDirectoryExists(client, directory);
             }
 
-            await using var fileStream = File.OpenRead(localFilePath);
+            // A partial file left by an upload this app started is carried on from its end
+            var resumeKey = ChunkedUploader.GetResumeKey(ProviderId, localFilePath, remotePath);
+            long offset = 0;
+            if (await _uploader.LoadResumeAsync(resumeKey, ct) != null && client.Exists(remotePath))
+            {
+                var remoteSize = client.GetAttributes(remotePath).Size;
+                if (remoteSize <= fileSize)
+                    offset = remoteSize;
+            }
+            else
+            {
+                await _uploader.SaveSessionAsync(resumeKey, "{}", ct);
+            }
 
-            // Use SFTP upload with progress
-            long uploadedBytes = 0;
-            var buffer = new byte[32 * 1024]; // 32KB buffer
+            await using var fileStream = new FileStream(localFilePath, FileMode.Open, FileAccess.Read, FileShare.Read,
+                1, FileOptions.Asynchronous | FileOptions.SequentialScan);
+            fileStream.Position = offset;
 
-            using var remoteStream = client.Create(remotePath);
+            // Use SFTP upload with progress
+            long uploadedBytes = offset;
+            var buffer = ArrayPool<byte>.Shared.Rent(BufferSize);
 
-            int bytesRead;
-            while ((bytesRead = await fileStream.ReadAsync(buffer, ct)) > 0)
+            try
             {
-                ct.ThrowIfCancellationRequested();
+                using var remoteStream = offset > 0
+                    ? client.Open(remotePath, FileMode.Open, FileAccess.Write)
+                    : client.Create(remotePath);
+                remoteStream.Position = offset;
 
-                await remoteStream.WriteAsync(buffer.AsMemory(0, bytesRead), ct);
-                uploadedBytes += bytesRead;
+                if (offset > 0)
+                    _logger.LogInformation("Resuming SFTP upload of {Path} at {Offset} bytes", remotePath, offset);
 
-                var elapsed = DateTime.UtcNow - startTime;
-                progress?.Report(new UploadProgress(
-                    uploadedBytes,
-                    fileSize,
-                    100.0 * uploadedBytes / fileSize,
-                    elapsed,
-                    elapsed.TotalSeconds > 0 ? (long)(uploadedBytes / elapsed.TotalSeconds) : 0));
+                int bytesRead;
+                while ((bytesRead = await fileStream.ReadAsync(buffer, ct)) > 0)
+                {
+                    ct.ThrowIfCancellationRequested();
+
+                    if (_uploader.Limiter != null)
+                        await _uploader.Limiter.WaitAsync(bytesRead, ct);
+
+                    await remoteStream.WriteAsync(buffer.AsMemory(0, bytesRead), ct);
+                    uploadedBytes += bytesRead;
+
+                    var elapsed = DateTime.UtcNow - startTime;
+                    progress?.Report(new UploadProgress(
+                        uploadedBytes,
+                        fileSize,
+                        100.0 * uploadedBytes / fileSize,
+                        elapsed,
+                        elapsed.TotalSeconds > 0 ? (long)((uploadedBytes - offset) / elapsed.TotalSeconds) : 0));
+                }
             }
+            finally
+            {
+                ArrayPool<byte>.Shared.Return(buffer);
+            }
+
+            await _uploader.ForgetResumeAsync(resumeKey, CancellationToken.None);
         }
         finally
         {
@@ -233,7 +277,22 @@ public sealed class FtpSftpProvider : ICloudStorageProvider
                     elapsed.TotalSeconds > 0 ? (long)(uploadedBytes / elapsed.TotalSeconds) : 0));
             });
 
-            await client.UploadFile(localFilePath, remotePath, FtpRemoteExists.Overwrite, true, FtpVerify.None, ftpProgress, ct);
+            // FluentFTP resumes from the remote file's size when the upload was ours
+            var resumeKey = ChunkedUploader.GetResumeKey(ProviderId, localFilePath, remotePath);
+            var existsMode = FtpRemoteExists.Overwrite;
+            if (await _uploader.LoadResumeAsync(resumeKey, ct) != null)
+                existsMode = FtpRemoteExists.Resume;
+            else
+                await _uploader.SaveSessionAsync(resumeKey, "{}", ct);
+
+            // Streamed through the bandwidth limit rather than letting FluentFTP open the file
+            await using var fileStream = new ThrottledStream(
+                new FileStream(localFilePath, FileMode.Open, FileAccess.Read, FileShare.Read,
+                    BufferSize, FileOptions.Asynchronous | FileOptions.SequentialScan),
+                _uploader.Limiter);
+
+            await client.UploadStream(fileStream, remotePath, existsMode, true, ftpProgress, ct);
+            await _uploader.ForgetResumeAsync(resumeKey, CancellationToken.None);
         }
         finally
         {
@@ -0,0 +1,84 @@
+namespace Screener.Upload;
+
+/// <summary>
+/// Read-only stream that paces reads through a <see cref="BandwidthLimiter"/> and reports the
+/// bytes handed out, for SDKs and HTTP content that pull the upload body themselves. Reads are
+/// cut into small slices so progress and the rate stay smooth within a large part.
+/// </summary>
+public sealed class ThrottledStream : Stream
+{
+    private const int SliceSize = 64 * 1024;
+
+    private readonly Stream _inner;
+    private readonly BandwidthLimiter? _limiter;
+    private readonly Action<int>? _onRead;
+    private readonly bool _leaveOpen;
+
+    public ThrottledStream(Stream inner, BandwidthLimiter? limiter, Action<int>? onRead = null, bool leaveOpen = false)
+    {
+        _inner = inner;
+        _limiter = limiter;
+        _onRead = onRead;
+        _leaveOpen = leaveOpen;
+    }
+
+    public override bool CanRead => true;
+    public override bool CanSeek => _inner.CanSeek;
+    public override bool CanWrite => false;
+    public override long Length => _inner.Length;
+
+    public override long Position
+    {
+        get => _inner.Position;
+        set => _inner.Position = value;
+    }
+
+    public override int Read(byte[] buffer, int offset, int count) => Read(buffer.AsSpan(offset, count));
+
+    public override int Read(Span<byte> buffer)
+    {
+        buffer = buffer.Slice(0, Math.Min(buffer.Length, SliceSize));
+        if (_limiter?.IsLimited == true)
+            _limiter.WaitAsync(buffer.Length).AsTask().GetAwaiter().GetResult();
+
+        int read = _inner.Read(buffer);
+        if (read > 0)
+            _onRead?.Invoke(read);
+        return read;
+    }
+
+    public override Task<int> ReadAsync(byte[] buffer, int offset, int count, CancellationToken cancellationToken) =>
+        ReadAsync(buffer.AsMemory(offset, count), cancellationToken).AsTask();
+
+    public override async ValueTask<int> ReadAsync(Memory<byte> buffer, CancellationToken cancellationToken = default)
+    {
+        buffer = buffer.Slice(0, Math.Min(buffer.Length, SliceSize));
+        if (_limiter != null)
+            await _limiter.WaitAsync(buffer.Length, cancellationToken);
+
+        int read = await _inner.ReadAsync(buffer, cancellationToken);
+        if (read > 0)
+            _onRead?.Invoke(read);
+        return read;
+    }
+
+    public override long Seek(long offset, SeekOrigin origin) => _inner.Seek(offset, origin);
+
+    public override void Flush() { }
+    public override void SetLength(long value) => throw new NotSupportedException();
+    public override void Write(byte[] buffer, int offset, int count) => throw new NotSupportedException();
+
+    protected override void Dispose(bool disposing)
+    {
+        if (disposing && !_leaveOpen)
+            _inner.Dispose();
+        base.Dispose(disposing);
+    }
+
+    public override async ValueTask DisposeAsync()
+    {
+        if (!_leaveOpen)
+            await _inner.DisposeAsync();
+        await base.DisposeAsync();
+    }
+}
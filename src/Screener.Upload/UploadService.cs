@@ -1,7 +1,9 @@
 using System.Collections.Concurrent;
+using System.Threading.Channels;
 using Microsoft.Extensions.Hosting;
 using Microsoft.Extensions.Logging;
 using Screener.Abstractions.Upload;
+using Screener.Core.Persistence;
 
 namespace Screener.Upload;
 
@@ -18,8 +20,18 @@ public sealed class UploadService : IUploadService, IHostedService, IDisposable
     private readonly SemaphoreSlim _uploadSemaphore;
     private readonly object _lock = new();
 
+    // Job changes are written to the database in order by one loop
+    private static readonly TimeSpan ProgressSaveInterval = TimeSpan.FromSeconds(5);
+    private readonly UploadQueueRepository? _repository;
+    private readonly BandwidthLimiter? _bandwidth;
+    private readonly SettingsRepository? _settings;
+    private readonly Channel<(UploadJob Job, bool IsNew)> _persistQueue =
+        Channel.CreateUnbounded<(UploadJob, bool)>(new UnboundedChannelOptions { SingleReader = true });
+    private readonly ConcurrentDictionary<Guid, DateTimeOffset> _startedAt = new();
+
     private CancellationTokenSource? _cts;
     private Task[]? _workerTasks;
+    private Task? _persistTask;
     private int _concurrentUploads = 2;
 
     public IReadOnlyList<UploadJob> Jobs
@@ -39,12 +51,31 @@ public sealed class UploadService : IUploadService, IHostedService, IDisposable
     public UploadService(
         ILogger<UploadService> logger,
         IEnumerable<ICloudStorageProvider> providers,
-        int concurrentUploads = 2)
+        int concurrentUploads = 2,
+        UploadQueueRepository? repository = null,
+        BandwidthLimiter? bandwidth = null,
+        SettingsRepository? settings = null)
     {
         _logger = logger;
         _providers = providers.ToDictionary(p => p.ProviderId, StringComparer.OrdinalIgnoreCase);
         _concurrentUploads = concurrentUploads;
         _uploadSemaphore = new SemaphoreSlim(concurrentUploads);
+        _repository = repository;
+        _bandwidth = bandwidth;
+        _settings = settings;
+    }
+
+    /// <summary>
+    /// Upload budget across all jobs in megabits per second; 0 for unlimited.
+    /// </summary>
+    public double MaxBandwidthMbps
+    {
+        get => (_bandwidth?.BytesPerSecond ?? 0) * 8 / 1_000_000.0;
+        set
+        {
+            if (_bandwidth != null)
+                _bandwidth.BytesPerSecond = (long)(Math.Max(0, value) * 1_000_000 / 8);
+        }
     }
 
     public Task StartAsync(CancellationToken cancellationToken)
@@ -54,6 +85,7 @@ public sealed class UploadService : IUploadService, IHostedService, IDisposable
         _workerTasks = Enumerable.Range(0, _concurrentUploads)
             .Select(_ => ProcessUploadsAsync(_cts.Token))
             .ToArray();
+        _persistTask = PersistJobsAsync();
 
         _logger.LogInformation("Upload service started with {WorkerCount} workers", _concurrentUploads);
 
@@ -69,6 +101,12 @@ public sealed class UploadService : IUploadService, IHostedService, IDisposable
             await Task.WhenAll(_workerTasks);
         }
 
+        _persistQueue.Writer.TryComplete();
+        if (_persistTask != null)
+        {
+            await _persistTask;
+        }
+
         _logger.LogInformation("Upload service stopped");
     }
 
@@ -98,6 +136,7 @@ public sealed class UploadService : IUploadService, IHostedService, IDisposable
             _allJobs.Add(job);
         }
 
+        _persistQueue.Writer.TryWrite((job, true));
         _queue.Enqueue(job);
 
         _logger.LogInformation("Upload job enqueued: {JobId} - {FileName}",
@@ -204,6 +243,7 @@ public sealed class UploadService : IUploadService, IHostedService, IDisposable
 
         try
         {
+            long lastSaveTicks = Environment.TickCount64;
             var progress = new Progress<UploadProgress>(p =>
             {
                 JobProgress?.Invoke(this, new UploadJobProgressEventArgs
@@ -219,6 +259,12 @@ public sealed class UploadService : IUploadService, IHostedService, IDisposable
                     if (idx >= 0)
                     {
                         _allJobs[idx] = _allJobs[idx] with { UploadedBytes = p.BytesTransferred };
+
+                        if (Environment.TickCount64 - lastSaveTicks >= ProgressSaveInterval.TotalMilliseconds)
+                        {
+                            lastSaveTicks = Environment.TickCount64;
+                            _persistQueue.Writer.TryWrite((_allJobs[idx], false));
+                        }
                     }
                 }
             });
@@ -271,6 +317,128 @@ public sealed class UploadService : IUploadService, IHostedService, IDisposable
         }
     }
 
+    /// <summary>
+    /// Reload jobs left unfinished by the last run and apply the saved bandwidth limit. Call
+    /// once the database is open; chunked uploads pick up from their saved parts.
+    /// </summary>
+    public async Task RestoreQueueAsync(CancellationToken ct = default)
+    {
+        try
+        {
+            if (_settings != null)
+            {
+                MaxBandwidthMbps = await _settings.GetAsync<double?>(SettingsKeys.MaxUploadBandwidthMbps, null, ct) ?? 0;
+            }
+
+            if (_repository == null)
+                return;
+
+            await _repository.DeleteOldCompletedAsync(TimeSpan.FromDays(30), ct);
+            await _repository.DeleteStaleResumeStatesAsync(TimeSpan.FromDays(7), ct);
+
+            // Uploading means the app closed mid-upload
+            var saved = (await _repository.GetPendingAsync(int.MaxValue, ct))
+                .Concat(await _repository.GetByStatusAsync(UploadStatus.Uploading, ct))
+                .ToList();
+
+            int restored = 0;
+            foreach (var upload in saved)
+            {
+                if (!File.Exists(upload.LocalFilePath))
+                {
+                    _logger.LogWarning("Dropping saved upload {JobId}: {File} no longer exists", upload.Id, upload.LocalFilePath);
+                    upload.Status = UploadStatus.Failed;
+                    upload.ErrorMessage = "File not found";
+                    await _repository.UpdateAsync(upload, ct);
+                    continue;
+                }
+
+                var job = new UploadJob(
+                    upload.Id,
+                    upload.LocalFilePath,
+                    upload.ProviderId,
+                    upload.RemotePath,
+                    upload.Metadata,
+                    upload.Status == UploadStatus.Paused ? UploadJobStatus.Paused : UploadJobStatus.Queued,
+                    (UploadPriority)upload.Priority,
+                    upload.TotalBytes,
+                    upload.BytesUploaded,
+                    upload.RetryCount,
+                    upload.ErrorMessage,
+                    upload.CreatedAt,
+                    null);
+
+                lock (_lock)
+                {
+                    if (_allJobs.Any(j => j.Id == job.Id))
+                        continue;
+                    _allJobs.Add(job);
+                }
+
+                if (job.Status == UploadJobStatus.Queued)
+                    _queue.Enqueue(job);
+                restored++;
+            }
+
+            if (restored > 0)
+            {
+                _logger.LogInformation("Restored {Count} unfinished upload(s)", restored);
+            }
+        }
+        catch (Exception ex)
+        {
+            _logger.LogError(ex, "Failed to restore the upload queue");
+        }
+    }
+
+    private async Task PersistJobsAsync()
+    {
+        await foreach (var (job, isNew) in _persistQueue.Reader.ReadAllAsync())
+        {
+            if (_repository == null)
+                continue;
+
+            try
+            {
+                var upload = ToQueuedUpload(job);
+                if (isNew)
+                    await _repository.InsertAsync(upload);
+                else
+                    await _repository.UpdateAsync(upload);
+            }
+            catch (Exception ex)
+            {
+                _logger.LogWarning(ex, "Failed to save upload job {JobId}", job.Id);
+            }
+        }
+    }
+
+    private QueuedUpload ToQueuedUpload(UploadJob job) => new()
+    {
+        Id = job.Id,
+        LocalFilePath = job.LocalFilePath,
+        RemotePath = job.RemotePath,
+        ProviderId = job.ProviderId,
+        Status = job.Status switch
+        {
+            UploadJobStatus.Queued => UploadStatus.Pending,
+            UploadJobStatus.Uploading => UploadStatus.Uploading,
+            UploadJobStatus.Paused => UploadStatus.Paused,
+            UploadJobStatus.Completed => UploadStatus.Completed,
+            UploadJobStatus.Failed => UploadStatus.Failed,
+            _ => UploadStatus.Cancelled
+        },
+        Priority = (int)job.Priority,
+        BytesUploaded = job.UploadedBytes,
+        TotalBytes = job.TotalBytes,
+        ErrorMessage = job.ErrorMessage,
+        RetryCount = job.RetryCount,
+        CreatedAt = job.CreatedAt,
+        StartedAt = _startedAt.TryGetValue(job.Id, out var started) ? started : null,
+        CompletedAt = job.CompletedAt,
+        Metadata = job.Metadata
+    };
+
     private void UpdateJobStatus(Guid jobId, UploadJobStatus status, string? errorMessage = null)
     {
         lock (_lock)
@@ -280,6 +448,9 @@ public sealed class UploadService : IUploadService, IHostedService, IDisposable
             {
                 var oldStatus = _allJobs[idx].Status;
                 _allJobs[idx] = _allJobs[idx] with { Status = status, ErrorMessage = errorMessage };
+                if (status == UploadJobStatus.Uploading)
+                    _startedAt.TryAdd(jobId, DateTimeOffset.UtcNow);
+                _persistQueue.Writer.TryWrite((_allJobs[idx], false));
 
                 JobStatusChanged?.Invoke(this, new UploadJobStatusChangedEventArgs
                 {
@@ -298,6 +469,7 @@ public sealed class UploadService : IUploadService, IHostedService, IDisposable
             if (idx >= 0)
             {
                 _allJobs[idx] = job;
+                _persistQueue.Writer.TryWrite((job, false));
             }
         }
     }
@@ -310,6 +482,7 @@ public sealed class UploadService : IUploadService, IHostedService, IDisposable
             if (idx >= 0)
             {
                 _allJobs[idx] = _allJobs[idx] with { CompletedAt = completedAt };
+                _persistQueue.Writer.TryWrite((_allJobs[idx], false));
             }
         }
     }
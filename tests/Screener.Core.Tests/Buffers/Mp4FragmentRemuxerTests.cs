@@ -0,0 +1,151 @@
+using System.Buffers.Binary;
+using System.Text;
+using Screener.Core.Buffers;
+
+namespace Screener.Core.Tests.Buffers;
+
+public class Mp4FragmentRemuxerTests
+{
+    private const int PacketSize = 188;
+    private const uint Timescale = 90_000;
+    private const uint FrameDuration = 3_000;   // 30 fps
+    private const int FramesPerGop = 30;
+    private const long MinimumCapacity = PacketSize * 1024;
+
+    private static readonly byte[] Sps = [0x67, 0x64, 0x00, 0x28, 0xAC, 0xD9, 0x40];
+    private static readonly byte[] Pps = [0x68, 0xEB, 0xE3, 0xCB];
+
+    private static byte[] Box(string type, params byte[][] body)
+    {
+        int length = 8 + body.Sum(b => b.Length);
+        var box = new byte[length];
+        BinaryPrimitives.WriteUInt32BigEndian(box, (uint)length);
+        Encoding.ASCII.GetBytes(type).CopyTo(box, 4);
+        int at = 8;
+        foreach (var part in body)
+        {
+            part.CopyTo(box, at);
+            at += part.Length;
+        }
+        return box;
+    }
+
+    private static byte[] U32(params uint[] values)
+    {
+        var bytes = new byte[values.Length * 4];
+        for (int i = 0; i < values.Length; i++)
+            BinaryPrimitives.WriteUInt32BigEndian(bytes.AsSpan(i * 4), values[i]);
+        return bytes;
+    }
+
+    // ftyp and a moov with one H.264 track (id 1), as Media Foundation's fragmented sink writes them
+    private static byte[] MakeHeader()
+    {
+        byte[] avcC = [1, 0x64, 0x00, 0x28, 0xFF, 0xE1, 0, (byte)Sps.Length, .. Sps, 1, 0, (byte)Pps.Length, .. Pps];
+        var avc1 = Box("avc1", new byte[78], Box("avcC", avcC));
+        var stsd = Box("stsd", U32(0, 1), avc1);
+        var mdia = Box("mdia",
+            Box("mdhd", U32(0, 0, 0, Timescale, 0, 0)),
+            Box("hdlr", U32(0, 0), Encoding.ASCII.GetBytes("vide"), new byte[13]),
+            Box("minf", Box("stbl", stsd)));
+        var trak = Box("trak", Box("tkhd", U32(0, 0, 0, 1, 0)), mdia);
+        // trex defaults: non-sync samples
+        var mvex = Box("mvex", Box("trex", U32(0, 1, 1, FrameDuration, 0, 0x10000)));
+
+        return [.. Box("ftyp", Encoding.ASCII.GetBytes("isom"), U32(0)), .. Box("moov", trak, mvex)];
+    }
+
+    // One GOP: moof (base is the moof, first sample a keyframe) and its mdat of one-NAL samples
+    private static byte[] MakeFragment(int gop)
+    {
+        var samples = new List<byte[]>();
+        for (int i = 0; i < FramesPerGop; i++)
+        {
+            byte[] nal = [(byte)(i == 0 ? 0x65 : 0x41), (byte)gop, (byte)i, 0x80, 0x40];
+            samples.Add([.. U32((uint)nal.Length), .. nal]);
+        }
+
+        byte[] Moof(int dataOffset)
+        {
+            var run = new List<byte>(U32(0x000305, (uint)samples.Count, (uint)dataOffset, 0));
+            foreach (var sample in samples)
+                run.AddRange(U32(FrameDuration, (uint)sample.Length));
+
+            var traf = Box("traf",
+                Box("tfhd", U32(0x020000, 1)),
+                Box("tfdt", [1, 0, 0, 0, .. BitConverter.GetBytes(BinaryPrimitives.ReverseEndianness((ulong)(gop * FramesPerGop * FrameDuration)))]),
+                Box("trun", run.ToArray()));
+            return Box("moof", Box("mfhd", U32(0, (uint)gop + 1)), traf);
+        }
+
+        int moofLength = Moof(0).Length;
+        return [.. Moof(moofLength + 8), .. Box("mdat", samples.SelectMany(s => s).ToArray())];
+    }
+
+    private static byte[] MakeFile(int gops)
+    {
+        var file = new List<byte>(MakeHeader());
+        for (int gop = 0; gop < gops; gop++)
+            file.AddRange(MakeFragment(gop));
+        return file.ToArray();
+    }
+
+    // In chunks, as the sink writer issues its writes
+    private static void WriteInChunks(Mp4FragmentRemuxer remuxer, byte[] file, int chunk)
+    {
+        for (int at = 0; at < file.Length; at += chunk)
+            remuxer.Write(at, file.AsSpan(at, Math.Min(chunk, file.Length - at)));
+    }
+
+    [Fact]
+    public async Task NativeH264Session_KeepsItsReplayBuffer()
+    {
+        using var buffer = new ReplayBuffer(TimeSpan.FromMinutes(2), MinimumCapacity);
+        var remuxer = new Mp4FragmentRemuxer(buffer);
+
+        WriteInChunks(remuxer, MakeFile(gops: 2), chunk: 100);
+
+        Assert.Equal(TimeSpan.Zero, buffer.OldestPosition);
+        Assert.Equal((2 * FramesPerGop - 1) / 30.0, buffer.NewestPosition!.Value.TotalSeconds, 3);
+
+        var snapshot = buffer.Snapshot(TimeSpan.FromSeconds(1.2), TimeSpan.FromSeconds(1.5));
+        Assert.NotNull(snapshot);
+        Assert.Equal(TimeSpan.FromSeconds(1), snapshot.Start);
+
+        using var output = new MemoryStream();
+        await snapshot.CopyToAsync(output);
+        var data = output.ToArray();
+
+        // PAT first, every packet in sync, and the keyframe carrying its parameter sets in Annex B
+        Assert.Equal(0, data.Length % PacketSize);
+        Assert.All(data.Chunk(PacketSize), packet => Assert.Equal(0x47, packet[0]));
+        Assert.Equal(0, ((data[1] & 0x1F) << 8) | data[2]);
+        Assert.True(data.AsSpan().IndexOf((byte[])[0, 0, 0, 1, .. Sps]) > 0);
+        Assert.True(data.AsSpan().IndexOf((byte[])[0, 0, 0, 1, 0x65, 1, 0]) > 0);
+    }
+
+    [Fact]
+    public void Write_IgnoresRewritesOfBytesAlreadyPassed()
+    {
+        using var buffer = new ReplayBuffer(TimeSpan.FromMinutes(2), MinimumCapacity);
+        var remuxer = new Mp4FragmentRemuxer(buffer);
+        var file = MakeFile(gops: 2);
+
+        remuxer.Write(0, file);
+        remuxer.Write(0, MakeHeader());
+
+        Assert.Equal((2 * FramesPerGop - 1) / 30.0, buffer.NewestPosition!.Value.TotalSeconds, 3);
+    }
+
+    [Fact]
+    public void Write_Throws_OnAGap()
+    {
+        using var buffer = new ReplayBuffer(TimeSpan.FromMinutes(2), MinimumCapacity);
+        var remuxer = new Mp4FragmentRemuxer(buffer);
+        var header = MakeHeader();
+
+        remuxer.Write(0, header);
+
+        Assert.Throws<InvalidDataException>(() => remuxer.Write(header.Length + 10, MakeFragment(0)));
+    }
+}
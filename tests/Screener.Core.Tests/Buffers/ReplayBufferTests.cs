@@ -0,0 +1,190 @@
+using Screener.Core.Buffers;
+
+namespace Screener.Core.Tests.Buffers;
+
+public class ReplayBufferTests
+{
+    private const int PacketSize = 188;
+    private const int PmtPid = 0x100;
+    private const int VideoPid = 0x101;
+    private const long PtsClock = 90_000;
+    private const long PtsWrap = 1L << 33;
+    private const long MinimumCapacity = PacketSize * 1024;
+
+    private static byte[] MakePat()
+    {
+        var packet = NewPacket(0, unitStart: true);
+        // pointer, table_id, section_length = 13, tsid, version, section numbers
+        byte[] section = [0x00, 0x00, 0xB0, 13, 0x00, 0x01, 0xC1, 0x00, 0x00,
+            // program 1 -> PMT PID
+            0x00, 0x01, 0xE0 | (PmtPid >> 8), PmtPid & 0xFF,
+            0, 0, 0, 0];
+        section.CopyTo(packet, 4);
+        return packet;
+    }
+
+    private static byte[] MakePmt()
+    {
+        var packet = NewPacket(PmtPid, unitStart: true);
+        // pointer, table_id 2, section_length = 18, program, version, section numbers,
+        // PCR PID, program_info_length 0
+        byte[] section = [0x00, 0x02, 0xB0, 18, 0x00, 0x01, 0xC1, 0x00, 0x00,
+            0xE0 | (VideoPid >> 8), VideoPid & 0xFF, 0xF0, 0x00,
+            // H.264 on the video PID, no ES info
+            0x1B, 0xE0 | (VideoPid >> 8), VideoPid & 0xFF, 0xF0, 0x00,
+            0, 0, 0, 0];
+        section.CopyTo(packet, 4);
+        return packet;
+    }
+
+    // First packet of a video PES carrying a 33-bit PTS; keyframes set random_access_indicator
+    private static byte[] MakeVideoStart(long pts, bool keyframe)
+    {
+        var packet = NewPacket(VideoPid, unitStart: true);
+        int payload = 4;
+        if (keyframe)
+        {
+            packet[3] = 0x30;
+            packet[4] = 1;
+            packet[5] = 0x40;
+            payload = 6;
+        }
+
+        pts &= PtsWrap - 1;
+        byte[] pes = [0x00, 0x00, 0x01, 0xE0, 0x00, 0x00, 0x80, 0x80, 0x05,
+            (byte)(0x21 | ((pts >> 29) & 0x0E)),
+            (byte)(pts >> 22),
+            (byte)(((pts >> 14) & 0xFE) | 1),
+            (byte)(pts >> 7),
+            (byte)(((pts << 1) & 0xFE) | 1)];
+        pes.CopyTo(packet, payload);
+        return packet;
+    }
+
+    private static byte[] NewPacket(int pid, bool unitStart)
+    {
+        var packet = new byte[PacketSize];
+        Array.Fill(packet, (byte)0xFF);
+        packet[0] = 0x47;
+        packet[1] = (byte)((unitStart ? 0x40 : 0) | (pid >> 8));
+        packet[2] = (byte)pid;
+        packet[3] = 0x10;
+        return packet;
+    }
+
+    // One keyframe per second starting at firstPts, each GOP padded with body packets
+    private static void AppendGops(ReplayBuffer buffer, long firstPts, int gops, int bodyPackets = 0, bool tables = true)
+    {
+        if (tables)
+        {
+            buffer.Append(MakePat());
+            buffer.Append(MakePmt());
+        }
+
+        for (int gop = 0; gop < gops; gop++)
+        {
+            long pts = firstPts + gop * PtsClock;
+            buffer.Append(MakeVideoStart(pts, keyframe: true));
+            for (int i = 0; i < bodyPackets; i++)
+                buffer.Append(NewPacket(VideoPid, unitStart: false));
+            buffer.Append(MakeVideoStart(pts + PtsClock / 2, keyframe: false));
+        }
+    }
+
+    [Fact]
+    public async Task Snapshot_StartsAtKeyframeBeforeInPoint_WithPatAndPmtFirst()
+    {
+        using var buffer = new ReplayBuffer(TimeSpan.FromMinutes(1), MinimumCapacity);
+        AppendGops(buffer, 900_000, gops: 4);
+
+        var snapshot = buffer.Snapshot(TimeSpan.FromSeconds(1.2), TimeSpan.FromSeconds(2.1));
+
+        Assert.NotNull(snapshot);
+        Assert.Equal(TimeSpan.FromSeconds(1), snapshot.Start);
+        Assert.Equal(TimeSpan.FromSeconds(3), snapshot.End);
+
+        using var output = new MemoryStream();
+        await snapshot.CopyToAsync(output);
+        var data = output.ToArray();
+
+        // PAT, PMT, then GOPs 1 and 2 (keyframe and one more frame each)
+        Assert.Equal(snapshot.Length, data.Length);
+        Assert.Equal(6 * PacketSize, data.Length);
+        Assert.Equal(MakePat(), data[..PacketSize]);
+        Assert.Equal(MakePmt(), data[PacketSize..(2 * PacketSize)]);
+        Assert.Equal(MakeVideoStart(900_000 + PtsClock, keyframe: true), data[(2 * PacketSize)..(3 * PacketSize)]);
+    }
+
+    [Fact]
+    public void Snapshot_SplitPacketsAcrossAppends_AreReassembled()
+    {
+        using var buffer = new ReplayBuffer(TimeSpan.FromMinutes(1), MinimumCapacity);
+        var stream = new MemoryStream();
+        stream.Write(MakePat());
+        stream.Write(MakePmt());
+        for (int gop = 0; gop < 3; gop++)
+            stream.Write(MakeVideoStart(gop * PtsClock, keyframe: true));
+
+        var bytes = stream.ToArray();
+        for (int at = 0; at < bytes.Length; at += 100)
+            buffer.Append(bytes.AsSpan(at, Math.Min(100, bytes.Length - at)));
+
+        Assert.Equal(TimeSpan.Zero, buffer.OldestPosition);
+        Assert.Equal(TimeSpan.FromSeconds(2), buffer.NewestPosition);
+    }
+
+    [Fact]
+    public void Pts_IsUnwrappedPast33Bits()
+    {
+        using var buffer = new ReplayBuffer(TimeSpan.FromMinutes(1), MinimumCapacity);
+
+        // Keyframes one second before, at, and one second after the 33-bit wrap
+        AppendGops(buffer, PtsWrap - PtsClock, gops: 3);
+
+        Assert.Equal(TimeSpan.Zero, buffer.OldestPosition);
+        Assert.Equal(TimeSpan.FromSeconds(2.5), buffer.NewestPosition);
+
+        var snapshot = buffer.Snapshot(TimeSpan.FromSeconds(1.5), TimeSpan.FromSeconds(1.6));
+        Assert.NotNull(snapshot);
+        Assert.Equal(TimeSpan.FromSeconds(1), snapshot.Start);
+        Assert.Equal(TimeSpan.FromSeconds(2), snapshot.End);
+    }
+
+    [Fact]
+    public void Evict_DropsGopsOlderThanWindow_KeepingTheKeyframeItStartsIn()
+    {
+        using var buffer = new ReplayBuffer(TimeSpan.FromSeconds(2), MinimumCapacity);
+        AppendGops(buffer, 0, gops: 6);
+
+        // Newest packet is at 5.5s, so the window starts at 3.5s, inside the GOP keyed at 3s
+        Assert.Equal(TimeSpan.FromSeconds(3), buffer.OldestPosition);
+        Assert.Null(buffer.Snapshot(TimeSpan.FromSeconds(2.5), TimeSpan.FromSeconds(4)));
+        Assert.NotNull(buffer.Snapshot(TimeSpan.FromSeconds(3.5), TimeSpan.FromSeconds(4)));
+    }
+
+    [Fact]
+    public void Evict_DropsGopsOverwrittenByTheRing()
+    {
+        using var buffer = new ReplayBuffer(TimeSpan.FromHours(1), MinimumCapacity);
+
+        // 402 packets per GOP; three of them cannot fit in 1024 packets
+        AppendGops(buffer, 0, gops: 3, bodyPackets: 400);
+
+        Assert.Equal(TimeSpan.FromSeconds(1), buffer.OldestPosition);
+        Assert.Null(buffer.Snapshot(TimeSpan.FromSeconds(0.5), TimeSpan.FromSeconds(1.5)));
+    }
+
+    [Fact]
+    public async Task CopyToAsync_Throws_WhenTheRingOverwroteTheSnapshot()
+    {
+        using var buffer = new ReplayBuffer(TimeSpan.FromHours(1), MinimumCapacity);
+        AppendGops(buffer, 0, gops: 2, bodyPackets: 400);
+
+        var snapshot = buffer.Snapshot(TimeSpan.Zero, TimeSpan.FromSeconds(0.5));
+        Assert.NotNull(snapshot);
+
+        AppendGops(buffer, 2 * PtsClock, gops: 1, bodyPackets: 400, tables: false);
+
+        await Assert.ThrowsAsync<IOException>(() => snapshot.CopyToAsync(Stream.Null));
+    }
+}
@@ -0,0 +1,177 @@
+using Screener.Abstractions.Capture;
+using Screener.Abstractions.Timecode;
+using Screener.Core.Recording;
+
+namespace Screener.Core.Tests.Recording;
+
+public class RecordingIndexTests : IDisposable
+{
+    private const int Timescale = 90_000;
+    private const int FrameDuration = 3_000; // 30fps
+    private const int FramesPerFragment = 6;
+    private const long InitLength = 1_000;
+    private const long FragmentSize = 10_000;
+    private const int FrameSize = 1_000;
+
+    // Decode order of the frames in each fragment: I P B B P B
+    private static readonly int[] DecodeOrder = [0, 3, 1, 2, 5, 4];
+
+    private static readonly FrameRate Fps30 = new(30, 1);
+
+    private readonly string _directory;
+    private readonly string _recordingPath;
+
+    public RecordingIndexTests()
+    {
+        _directory = Path.Combine(Path.GetTempPath(), "screener-index-" + Guid.NewGuid().ToString("N"));
+        Directory.CreateDirectory(_directory);
+        _recordingPath = Path.Combine(_directory, "recording.mp4");
+    }
+
+    public void Dispose()
+    {
+        try
+        {
+            Directory.Delete(_directory, recursive: true);
+        }
+        catch (IOException)
+        {
+        }
+    }
+
+    private static TimeSpan Frames(double frames) => TimeSpan.FromSeconds(frames / 30);
+
+    private static Smpte12MTimecode TimecodeOf(int frame) => new(1, 0, frame / 30, frame % 30);
+
+    // One fragment per keyframe, frames stored in decode order with B-frames after their P
+    private void WriteIndex(int fragments, bool spliceable = true)
+    {
+        using var writer = new RecordingIndexWriter(_recordingPath, Timescale, Fps30, InitLength, spliceable);
+        var entries = new RecordingIndexEntry[FramesPerFragment];
+
+        for (int fragment = 0; fragment < fragments; fragment++)
+        {
+            long moof = InitLength + fragment * FragmentSize;
+            for (int i = 0; i < FramesPerFragment; i++)
+            {
+                int frame = fragment * FramesPerFragment + DecodeOrder[i];
+                entries[i] = new RecordingIndexEntry
+                {
+                    Pts = (long)frame * FrameDuration,
+                    Offset = moof + 100 + i * FrameSize,
+                    FragmentOffset = moof,
+                    Size = FrameSize,
+                    Timecode = RecordingIndex.PackTimecode(TimecodeOf(frame)),
+                    Flags = i == 0 ? RecordingIndex.KeyframeFlag | RecordingIndex.FragmentStartFlag : 0
+                };
+            }
+            writer.Append(entries);
+        }
+    }
+
+    [Fact]
+    public void TryOpen_ReadsHeaderAndEntries()
+    {
+        WriteIndex(fragments: 2);
+
+        using var index = RecordingIndex.TryOpen(_recordingPath);
+
+        Assert.NotNull(index);
+        Assert.Equal(Timescale, index.Timescale);
+        Assert.Equal(Fps30, index.FrameRate);
+        Assert.Equal(InitLength, index.InitLength);
+        Assert.True(index.Spliceable);
+        Assert.Equal(12, index.Count);
+    }
+
+    [Fact]
+    public void TryOpen_ReturnsNull_WithoutAnIndex()
+    {
+        Assert.Null(RecordingIndex.TryOpen(_recordingPath));
+    }
+
+    [Fact]
+    public void FindRange_CoversWholeFragmentsFromTheKeyframeBeforeTheInPoint()
+    {
+        WriteIndex(fragments: 5);
+        using var index = RecordingIndex.TryOpen(_recordingPath)!;
+
+        // In during fragment 1 (frames 6-11), out during fragment 2 (frames 12-17)
+        var range = index.FindRange(Frames(8.5), Frames(13.5));
+
+        Assert.NotNull(range);
+        Assert.Equal(InitLength, range.InitLength);
+        Assert.Equal(InitLength + FragmentSize, range.StartOffset);
+        Assert.Equal(InitLength + 3 * FragmentSize, range.EndOffset);
+        Assert.Equal(Frames(6), range.KeyframePosition);
+    }
+
+    [Fact]
+    public void FindRange_InTimecode_IsTheFirstFramePresentedAfterTheInPoint_NotTheFirstDecoded()
+    {
+        WriteIndex(fragments: 3);
+        using var index = RecordingIndex.TryOpen(_recordingPath)!;
+
+        // Fragment 1 decodes frame 9 (P) before frame 7 (B); frame 7 is presented first
+        var range = index.FindRange(Frames(6.5), Frames(7.5));
+
+        Assert.NotNull(range);
+        Assert.Equal(TimecodeOf(7), range.InTimecode);
+    }
+
+    [Fact]
+    public void FindRange_OutPointInTheLastFragment_EndsAtTheLastFrameOnDisk()
+    {
+        WriteIndex(fragments: 3);
+        using var index = RecordingIndex.TryOpen(_recordingPath)!;
+
+        var range = index.FindRange(Frames(12.5), Frames(15.5));
+
+        Assert.NotNull(range);
+        Assert.Equal(InitLength + 2 * FragmentSize, range.StartOffset);
+        Assert.Equal(InitLength + 2 * FragmentSize + 100 + FramesPerFragment * FrameSize, range.EndOffset);
+    }
+
+    [Fact]
+    public void FindRange_ReturnsNull_UntilTheOutPointIsIndexed()
+    {
+        WriteIndex(fragments: 3);
+        using var index = RecordingIndex.TryOpen(_recordingPath)!;
+
+        Assert.Null(index.FindRange(Frames(12.5), Frames(20.5)));
+    }
+
+    [Fact]
+    public void MarkNotSpliceable_ClearsTheHeaderFlag_AndKeepsEntries()
+    {
+        using (var writer = new RecordingIndexWriter(_recordingPath, Timescale, Fps30, InitLength, spliceable: true))
+        {
+            writer.Append([new RecordingIndexEntry { Pts = 0, Offset = InitLength + 100, FragmentOffset = InitLength,
+                Size = FrameSize, Timecode = RecordingIndex.NoTimecode,
+                Flags = RecordingIndex.KeyframeFlag | RecordingIndex.FragmentStartFlag }]);
+            writer.MarkNotSpliceable();
+            writer.Append([new RecordingIndexEntry { Pts = FrameDuration, Offset = InitLength + 100 + FrameSize,
+                FragmentOffset = InitLength, Size = FrameSize, Timecode = RecordingIndex.NoTimecode }]);
+        }
+
+        using var index = RecordingIndex.TryOpen(_recordingPath);
+
+        Assert.NotNull(index);
+        Assert.False(index.Spliceable);
+        Assert.Equal(2, index.Count);
+
+        Span<RecordingIndexEntry> entries = new RecordingIndexEntry[2];
+        Assert.Equal(2, index.ReadEntries(0, entries));
+        Assert.True(entries[0].IsKeyframe);
+        Assert.Equal(FrameDuration, entries[1].Pts);
+    }
+
+    [Fact]
+    public void PackTimecode_RoundTrips()
+    {
+        var timecode = new Smpte12MTimecode(10, 59, 58, 29, DropFrame: true);
+
+        Assert.Equal(timecode, RecordingIndex.UnpackTimecode(RecordingIndex.PackTimecode(timecode)));
+        Assert.Null(RecordingIndex.UnpackTimecode(RecordingIndex.NoTimecode));
+    }
+}
@@ -0,0 +1,37 @@
+using Screener.Abstractions.Capture;
+using Screener.Abstractions.Encoding;
+using Screener.Core.Buffers;
+using Screener.Encoding.Pipelines;
+
+namespace Screener.Encoding.Tests.Pipelines;
+
+public class AutoEncodingPipelineTests
+{
+    private static readonly VideoMode Hd1080 = new(1920, 1080, FrameRate.Fps59_94, PixelFormat.UYVY, false, "1080p59.94");
+
+    private static EncodingConfiguration Recording(EncoderEngine engine = EncoderEngine.Auto, ReplayBuffer? replay = null) =>
+        new("recording.mp4", Hd1080, new AudioFormat(48000, 16, 32), EncodingPreset.Medium, Engine: engine, Replay: replay);
+
+    [Fact]
+    public void ResolveEngine_NativeCapableH264Session_KeepsItsReplayBuffer_OnTheNativeEngine()
+    {
+        using var replay = new ReplayBuffer(TimeSpan.FromMinutes(2), 188 * 1024);
+        var config = Recording(replay: replay);
+
+        Assert.Equal(EncoderEngine.Native, AutoEncodingPipeline.ResolveEngine(config, canEncodeNatively: true));
+    }
+
+    [Fact]
+    public void ResolveEngine_FallsBackToFfmpeg_WhenTheNativeEngineCannotEncode()
+    {
+        Assert.Equal(EncoderEngine.Ffmpeg, AutoEncodingPipeline.ResolveEngine(Recording(), canEncodeNatively: false));
+    }
+
+    [Theory]
+    [InlineData(EncoderEngine.Ffmpeg, true)]
+    [InlineData(EncoderEngine.Native, false)]
+    public void ResolveEngine_ExplicitEngine_Wins(EncoderEngine engine, bool canEncodeNatively)
+    {
+        Assert.Equal(engine, AutoEncodingPipeline.ResolveEngine(Recording(engine), canEncodeNatively));
+    }
+}
@@ -11,13 +11,13 @@ public class AutoCutConfigurationTests
 
         Assert.Equal(120, config.AnalysisWidth);
         Assert.Equal(68, config.AnalysisHeight);
-        Assert.Equal(4, config.FrameSkip);
-        Assert.Equal(0.05, config.EmaAlpha);
+        Assert.Equal(1, config.FrameSkip);
+        Assert.Equal(0.0032, config.EmaAlpha);
         Assert.Equal(4.0, config.SwingSpikeMultiplier);
         Assert.Equal(500, config.MinimumSpikeThreshold);
-        Assert.Equal(2, config.FrameCompareGap);
+        Assert.Equal(32, config.FrameCompareGap);
         Assert.Equal(0.95, config.IdleSimilarityThreshold);
-        Assert.Equal(3, config.ConsecutiveIdleFramesRequired);
+        Assert.Equal(48, config.ConsecutiveIdleFramesRequired);
         Assert.Equal(30, config.MaxSimulatorDurationSeconds);
     }
 
@@ -52,7 +52,7 @@ public class AutoCutConfigurationTests
         Assert.Equal(3.0, config.SwingSpikeMultiplier);
         Assert.Equal(300, config.MinimumSpikeThreshold);
         Assert.Equal(0.90, config.IdleSimilarityThreshold);
-        Assert.Equal(2, config.ConsecutiveIdleFramesRequired);
+        Assert.Equal(32, config.ConsecutiveIdleFramesRequired);
     }
 
     [Fact]
@@ -63,7 +63,7 @@ public class AutoCutConfigurationTests
         Assert.Equal(6.0, config.SwingSpikeMultiplier);
         Assert.Equal(800, config.MinimumSpikeThreshold);
         Assert.Equal(0.97, config.IdleSimilarityThreshold);
-        Assert.Equal(4, config.ConsecutiveIdleFramesRequired);
+        Assert.Equal(64, config.ConsecutiveIdleFramesRequired);
     }
 
     [Fact]
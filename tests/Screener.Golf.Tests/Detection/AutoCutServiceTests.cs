@@ -256,4 +256,36 @@ public class AutoCutServiceTests
         // The detector should not have detected anything with stable frames
         Assert.Equal(AutoCutState.WaitingForSwing, service.State);
     }
+
+    [Fact]
+    public void ProcessSource1Frame_Defaults_AnalyzeEveryFrame()
+    {
+        // The preview hook hands the auto-cut every frame of a 60fps input, and the defaults
+        // analyze each one, comparing it with the frame FrameCompareGap (32) frames back
+        var defaultTiming = new AutoCutConfiguration
+        {
+            AnalysisWidth = 4,
+            AnalysisHeight = 4,
+            MinimumSpikeThreshold = 10,
+            RoiLeft = 0, RoiTop = 0, RoiWidth = 1.0, RoiHeight = 1.0,
+        };
+        var service = new AutoCutService(NullLogger<AutoCutService>.Instance, defaultTiming);
+        int cuts = 0;
+        service.CutTriggered += (_, _) => cuts++;
+
+        var still = MakeFrame(128);
+        var moved = MakeFrame(250);
+        service.CalibrateIdleReference(still, SrcWidth, SrcHeight);
+        service.Enable();
+
+        // 32 frames fill the history, then frame 33's zero SAD seeds the EMA
+        for (int i = 1; i <= 33; i++)
+            service.ProcessSource1Frame(still, SrcWidth, SrcHeight);
+        Assert.Equal(0, cuts);
+
+        // The first moving frame cuts
+        service.ProcessSource1Frame(moved, SrcWidth, SrcHeight);
+        Assert.Equal(1, cuts);
+        Assert.Equal(AutoCutState.FollowingShot, service.State);
+    }
 }
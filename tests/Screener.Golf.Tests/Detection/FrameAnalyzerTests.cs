@@ -1,3 +1,5 @@
+using System.Buffers.Binary;
+using Screener.Abstractions.Capture;
 using Screener.Golf.Detection;
 
 namespace Screener.Golf.Tests.Detection;
@@ -67,6 +69,98 @@ public class FrameAnalyzerTests
         Assert.True(luma[0] < srcWidth * srcHeight);
     }
 
+    [Fact]
+    public void ExtractLumaDownsampled_ExtractsYChannel_FromV210Data()
+    {
+        // Arrange: 6x2 v210 frame. One 16-byte group holds 6 pixels as four words of
+        // three 10-bit samples: Cb0 Y0 Cr0 | Y1 Cb2 Y2 | Cr2 Y3 Cb4 | Y4 Cr4 Y5
+        int srcWidth = 6;
+        int srcHeight = 2;
+        int rowBytes = 128; // v210 rows are padded to 48 pixels
+
+        var v210 = new byte[rowBytes * srcHeight];
+        for (int row = 0; row < srcHeight; row++)
+        {
+            // Y = 10, 20 ... 60 (row 0) and 70 ... 120 (row 1) in 8-bit terms
+            int[] samples = new int[12];
+            for (int i = 0; i < 12; i++)
+                samples[i] = i % 2 == 0 ? 512 : (row * 6 + i / 2 + 1) * 10 * 4;
+
+            for (int w = 0; w < 4; w++)
+            {
+                uint word = (uint)(samples[w * 3] | samples[w * 3 + 1] << 10 | samples[w * 3 + 2] << 20);
+                BinaryPrimitives.WriteUInt32LittleEndian(v210.AsSpan(row * rowBytes + w * 4), word);
+            }
+        }
+
+        var luma = new byte[srcWidth * srcHeight];
+
+        // Act
+        FrameAnalyzer.ExtractLumaDownsampled(v210, srcWidth, srcHeight, srcWidth, srcHeight, luma,
+            PixelFormat.YUV422_10bit);
+
+        // Assert: 10-bit Y rounded to 8 bits, in pixel order
+        for (int i = 0; i < luma.Length; i++)
+            Assert.Equal((i + 1) * 10, luma[i]);
+    }
+
+    [Fact]
+    public void ExtractLumaWithSad_MatchesSeparateExtractAndSad()
+    {
+        // 64x36 source -> 16x9 analysis plane, ROI covering the middle
+        int srcWidth = 64, srcHeight = 36;
+        int dstWidth = 16, dstHeight = 9;
+
+        var uyvy = new byte[srcWidth * srcHeight * 2];
+        new Random(7).NextBytes(uyvy);
+        var reference = new byte[dstWidth * dstHeight];
+        new Random(8).NextBytes(reference);
+
+        var expectedLuma = new byte[dstWidth * dstHeight];
+        FrameAnalyzer.ExtractLumaDownsampled(uyvy, srcWidth, srcHeight, dstWidth, dstHeight, expectedLuma);
+        double expectedSad = FrameAnalyzer.ComputeSadInRoi(
+            expectedLuma, reference, dstWidth, dstHeight,
+            0.2, 0.1, 0.6, 0.8);
+
+        var luma = new byte[dstWidth * dstHeight];
+        double sad = FrameAnalyzer.ExtractLumaWithSad(
+            uyvy, srcWidth, srcHeight, dstWidth, dstHeight,
+            luma, reference,
+            0.2, 0.1, 0.6, 0.8);
+
+        Assert.Equal(expectedLuma, luma);
+        Assert.Equal(expectedSad, sad);
+        Assert.True(sad > 0);
+    }
+
+    [Fact]
+    public void ExtractLumaWithSad_UsesCapturedLumaOfMatchingSize()
+    {
+        int dstWidth = 16, dstHeight = 9;
+        var captured = new byte[dstWidth * dstHeight];
+        new Random(9).NextBytes(captured);
+        var reference = new byte[dstWidth * dstHeight];
+
+        // The frame is black; only the captured plane can produce this SAD
+        var uyvy = new byte[64 * 36 * 2];
+        double expectedSad = FrameAnalyzer.ComputeSadInRoi(captured, reference, dstWidth, dstHeight, 0, 0, 1.0, 1.0);
+
+        var luma = new byte[dstWidth * dstHeight];
+        double sad = FrameAnalyzer.ExtractLumaWithSad(
+            uyvy, 64, 36, dstWidth, dstHeight, luma, reference,
+            0, 0, 1.0, 1.0, capturedLuma: new LumaPlane(captured, dstWidth, dstHeight));
+
+        Assert.Equal(captured, luma);
+        Assert.Equal(expectedSad, sad);
+
+        // A plane sampled at another size is ignored
+        sad = FrameAnalyzer.ExtractLumaWithSad(
+            uyvy, 64, 36, dstWidth, dstHeight, luma, reference,
+            0, 0, 1.0, 1.0, capturedLuma: new LumaPlane(captured, dstHeight, dstWidth));
+
+        Assert.Equal(0, sad);
+    }
+
     [Fact]
     public void ComputeSadInRoi_IdenticalFrames_ReturnsZero()
     {
@@ -64,4 +64,19 @@ public class LogoBugConfigTests
 
         Assert.Equal("x=50:y=50", result);
     }
+
+    [Theory]
+    [InlineData(LogoPosition.TopLeft, 20, 20)]
+    [InlineData(LogoPosition.TopRight, 1920 - 200 - 20, 20)]
+    [InlineData(LogoPosition.BottomLeft, 20, 1080 - 100 - 20)]
+    [InlineData(LogoPosition.BottomRight, 1920 - 200 - 20, 1080 - 100 - 20)]
+    public void GetPixelPosition_MatchesOverlayExpression(LogoPosition position, int expectedX, int expectedY)
+    {
+        var config = new LogoBugConfig { Position = position, Margin = 20 };
+
+        var (x, y) = config.GetPixelPosition(1920, 1080, 200, 100);
+
+        Assert.Equal(expectedX, x);
+        Assert.Equal(expectedY, y);
+    }
 }
@@ -1,4 +1,5 @@
 using Microsoft.Extensions.Logging.Abstractions;
+using Screener.Golf.Export;
 using Screener.Golf.Overlays;
 
 namespace Screener.Golf.Tests.Overlays;
@@ -193,4 +194,52 @@ public class OverlayCompositorTests
             File.Delete(logoPath);
         }
     }
+
+    [Fact]
+    public void BuildRenditionArgs_SplitsOneDecodeToEveryOutput()
+    {
+        var lowerThird = new LowerThirdConfig { Enabled = true };
+        var renditions = new Dictionary<ClipRenditions, string>
+        {
+            [ClipRenditions.Vertical] = "vertical.mp4",
+            [ClipRenditions.Thumbnail] = "thumb.jpg"
+        };
+
+        var args = _compositor.BuildRenditionArgs(
+            "input.mp4", "final.mp4", renditions, true, "John", null, lowerThird);
+
+        Assert.Single(args.Split(' '), token => token == "-i");
+        Assert.Contains("[final]split=3[main][vertical_in][thumbnail_in]", args);
+        Assert.Contains("scale=1080:1920", args);
+        Assert.Contains("-frames:v 1", args);
+        Assert.EndsWith("\"thumb.jpg\"", args);
+    }
+
+    [Fact]
+    public void BuildRenditionArgs_LiveOverlays_CopiesFinalClip()
+    {
+        var lowerThird = new LowerThirdConfig { Enabled = true };
+        var renditions = new Dictionary<ClipRenditions, string> { [ClipRenditions.Gif] = "preview.gif" };
+
+        var args = _compositor.BuildRenditionArgs(
+            "input.mp4", "final.mp4", renditions, false, "John", null, lowerThird);
+
+        Assert.DoesNotContain("drawtext", args);
+        Assert.Contains("-map 0:v -map 0:a? -c copy", args);
+        Assert.Contains("[0:v]null[gif_in]", args);
+        Assert.Contains("paletteuse", args);
+    }
+
+    [Fact]
+    public void BuildRenditionArgs_RenditionsOnly_HasNoFinalOutput()
+    {
+        var renditions = new Dictionary<ClipRenditions, string> { [ClipRenditions.Hd1080] = "hd.mp4" };
+
+        var args = _compositor.BuildRenditionArgs(
+            "input.mp4", null, renditions, true, null, null, null, "h264_nvenc");
+
+        Assert.DoesNotContain("-c copy", args);
+        Assert.Contains("scale=-2:1080", args);
+        Assert.Contains("-c:v h264_nvenc", args);
+    }
 }
@@ -0,0 +1,70 @@
+using Screener.Abstractions.Capture;
+using Screener.Golf.Overlays;
+
+namespace Screener.Golf.Tests.Overlays;
+
+public class OverlayLayerTests
+{
+    private static readonly VideoMode Uyvy = new(64, 32, FrameRate.Fps30, PixelFormat.YUV422_8bit, false, "test");
+
+    private static OverlayImage Solid(int width, int height, byte b, byte g, byte r, byte a)
+    {
+        var pixels = new byte[width * height * 4];
+        for (int i = 0; i < pixels.Length; i += 4)
+        {
+            pixels[i] = b;
+            pixels[i + 1] = g;
+            pixels[i + 2] = r;
+            pixels[i + 3] = a;
+        }
+        return new OverlayImage(pixels, width, height);
+    }
+
+    private static byte[] GrayUyvy(VideoMode mode)
+    {
+        var frame = new byte[mode.Width * mode.Height * 2];
+        for (int i = 0; i < frame.Length; i += 4)
+        {
+            frame[i] = 128;
+            frame[i + 1] = 100;
+            frame[i + 2] = 128;
+            frame[i + 3] = 100;
+        }
+        return frame;
+    }
+
+    [Fact]
+    public void Create_Uyvy_AlignsToPixelPairs()
+    {
+        var layer = OverlayLayer.Create(Solid(5, 3, 255, 255, 255, 255), 3, 2, 1.0, Uyvy)!;
+
+        Assert.Equal(2, layer.X);
+        Assert.Equal(6, layer.Width);
+        Assert.Equal(3, layer.Height);
+    }
+
+    [Fact]
+    public void Apply_OpaqueWhite_WritesStudioWhiteOnlyInsideImage()
+    {
+        var frame = GrayUyvy(Uyvy);
+        var layer = OverlayLayer.Create(Solid(5, 3, 255, 255, 255, 255), 3, 2, 1.0, Uyvy)!;
+
+        layer.Apply(frame, Uyvy.Width * 2);
+
+        for (int y = 0; y < Uyvy.Height; y++)
+        {
+            for (int x = 0; x < Uyvy.Width; x++)
+            {
+                bool inside = x >= 3 && x < 8 && y >= 2 && y < 5;
+                Assert.Equal(inside ? 235 : 100, frame[y * Uyvy.Width * 2 + x * 2 + 1]);
+            }
+        }
+    }
+
+    [Fact]
+    public void Create_OffFrameOrTransparent_ReturnsNull()
+    {
+        Assert.Null(OverlayLayer.Create(Solid(8, 8, 0, 0, 0, 255), 100, 0, 1.0, Uyvy));
+        Assert.Null(OverlayLayer.Create(Solid(8, 8, 0, 0, 0, 255), 0, 0, 0.0, Uyvy));
+    }
+}
@@ -0,0 +1,82 @@
+using Screener.Abstractions.Capture;
+using Screener.Golf.Switching;
+
+namespace Screener.Golf.Tests.Switching;
+
+public class TransitionEngineTests
+{
+    private const int Width = 8;
+    private const int Height = 4;
+
+    private static byte[] Fill(int length, byte value)
+    {
+        var frame = new byte[length];
+        Array.Fill(frame, value);
+        return frame;
+    }
+
+    [Fact]
+    public void GetProgramFrame_NoTransition_ReturnsSourceA()
+    {
+        var engine = new TransitionEngine();
+        var a = Fill(Width * Height * 4, 10);
+        var b = Fill(Width * Height * 4, 200);
+        engine.SetSources(a, b, Width, Height);
+
+        Assert.Same(a, engine.GetProgramFrame());
+    }
+
+    [Fact]
+    public void Dissolve_Midpoint_AveragesSourcesIntoReusedBuffer()
+    {
+        var engine = new TransitionEngine();
+        engine.SetSources(Fill(Width * Height * 4, 10), Fill(Width * Height * 4, 200), Width, Height);
+        engine.TriggerAutoTransition(TransitionType.Dissolve);
+        engine.SetManualPosition(0.5);
+
+        var first = engine.GetProgramFrame()!;
+        Assert.All(first, v => Assert.Equal(105, v));
+
+        engine.SetManualPosition(0.25);
+        var second = engine.GetProgramFrame()!;
+
+        Assert.Same(first, second);
+        Assert.All(second, v => Assert.Equal((10 * 192 + 200 * 64) >> 8, v));
+    }
+
+    [Fact]
+    public void DipToBlack_Uyvy_FadesToStudioBlack()
+    {
+        var engine = new TransitionEngine { PixelFormat = PixelFormat.UYVY };
+        engine.SetSources(Fill(Width * Height * 2, 235), Fill(Width * Height * 2, 235), Width, Height);
+        engine.TriggerAutoTransition(TransitionType.DipToBlack);
+        engine.SetManualPosition(0.5);
+
+        var frame = engine.GetProgramFrame()!;
+
+        Assert.Equal(Width * Height * 2, frame.Length);
+        for (int i = 0; i < frame.Length; i += 4)
+        {
+            Assert.Equal(0x80, frame[i]);     // U
+            Assert.Equal(0x10, frame[i + 1]); // Y
+            Assert.Equal(0x80, frame[i + 2]); // V
+            Assert.Equal(0x10, frame[i + 3]); // Y
+        }
+    }
+
+    [Fact]
+    public void RenderProgramFrame_WritesIntoCallerBuffer()
+    {
+        var engine = new TransitionEngine();
+        engine.SetSources(Fill(Width * Height * 4, 0), Fill(Width * Height * 4, 255), Width, Height);
+
+        var output = new byte[Width * Height * 4];
+        Assert.False(engine.RenderProgramFrame(output));
+
+        engine.TriggerAutoTransition(TransitionType.Dissolve);
+        engine.SetManualPosition(0.75);
+
+        Assert.True(engine.RenderProgramFrame(output));
+        Assert.All(output, v => Assert.Equal((255 * 192) >> 8, v));
+    }
+}